@@ -0,0 +1,443 @@
+/**
+ * @file bench_arbiter.cpp
+ * @author agent (agent@local)
+ * @brief Checks that the radio arbiter serializes the device, then times command/response exchanges through it.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * The simulated radio counts transactions that overlap one another, which on the si446x's SPI bus would
+ * garble both. A receive side and a transmit side hammer one radio with and without the arbiter; the
+ * arbiter must bring the overlaps to zero.
+ * 
+ * The exchanges run the daemon's event loop and UHF TX thread against a stand-in server and an external far
+ * end that answers an exchange's commands once it has them all, as a half-duplex spacecraft would. BENCH_COMMANDS commands are sent per exchange.
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include "gs_uhf.hpp"
+#include "gs_arbiter.hpp"
+#include "gs_reactor.hpp"
+#include "gs_ring.hpp"
+#include "gs_tx.hpp"
+#include "gs_sar.hpp"
+#include "gs_radio.hpp"
+#include "gs_bench.hpp"
+#include "gs_time.hpp"
+#include "gs_log.hpp"
+#include "meb_debug.hpp"
+
+#define BENCH_RACE_MS 300
+#define BENCH_COMMANDS 8
+#define BENCH_EXCHANGES 10
+#define BENCH_RATE "38400"
+#define BENCH_QUIET_MS 100 // Uplink silence after which the far end answers what it has.
+#define BENCH_MAGIC 0x61726269
+#define BENCH_TIMEOUT_S 10
+
+#define CHECK(cond)                                       \
+    do                                                    \
+    {                                                     \
+        if (!(cond))                                      \
+        {                                                 \
+            dbprintlf(RED_FG "Check failed: %s", #cond); \
+            failures++;                                   \
+        }                                                 \
+    } while (0)
+
+static gs_radio_t *bench_radio(const char *options)
+{
+    gs_sim_config_t config[1];
+    gs_radio_sim_defaults(config);
+    gs_radio_sim_parse(config, options);
+    return gs_radio_sim_create(config);
+}
+
+typedef struct
+{
+    gs_radio_t *radio;
+    bool arbiter; // Through the gs_radio_*() wrappers, or straight to the backend as before.
+    bool done;
+    uint64_t ops;
+} bench_side_t;
+
+static void *bench_rx_side(void *args)
+{
+    bench_side_t *side = (bench_side_t *)args;
+    gs_radio_t *radio = side->radio;
+    while (!__atomic_load_n(&side->done, __ATOMIC_ACQUIRE))
+    {
+        gst_fec_frame_t air[1];
+        gs_radio_info_t info[1];
+        int16_t rssi;
+        if (side->arbiter)
+        {
+            gs_radio_read(radio, air, sizeof(air), &rssi);
+            gs_radio_get_info(radio, info);
+            gs_radio_en_pipe(radio);
+        }
+        else
+        {
+            radio->ops->read(radio, air, sizeof(air), &rssi);
+            radio->ops->get_info(radio, info);
+            radio->ops->en_pipe(radio);
+        }
+        side->ops += 3;
+    }
+    return nullptr;
+}
+
+static void *bench_tx_side(void *args)
+{
+    bench_side_t *side = (bench_side_t *)args;
+    gs_radio_t *radio = side->radio;
+    gst_frame_t frame[1];
+    gs_uhf_frame_build(frame, "arbiter", 7);
+    while (!__atomic_load_n(&side->done, __ATOMIC_ACQUIRE))
+    {
+        if (side->arbiter)
+        {
+            gs_arbiter_tx_begin(radio);
+            for (int i = 0; i < 4; i++)
+            {
+                gs_radio_write(radio, frame, sizeof(gst_frame_t));
+            }
+            gs_arbiter_tx_end(radio);
+        }
+        else
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                radio->ops->write(radio, frame, sizeof(gst_frame_t));
+                radio->ops->en_pipe(radio);
+            }
+        }
+        side->ops += 4;
+
+        // Keep the far end from backing up.
+        gst_fec_frame_t air[1];
+        while (gs_radio_sim_far_recv(radio, air, sizeof(air), 0) > 0)
+            ;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Drives one radio from a receive side and a transmit side at once.
+ * 
+ * @return uint64_t Overlapping transactions the simulated radio saw.
+ */
+static uint64_t bench_race(bool arbiter)
+{
+    gs_radio_t *radio = bench_radio("external,rate=1000000");
+    gs_radio_init(radio);
+    bench_side_t rx = {radio, arbiter, false, 0}, tx = {radio, arbiter, false, 0};
+    pthread_t rx_tid, tx_tid;
+    pthread_create(&rx_tid, NULL, bench_rx_side, &rx);
+    pthread_create(&tx_tid, NULL, bench_tx_side, &tx);
+    usleep(BENCH_RACE_MS * 1000);
+    __atomic_store_n(&rx.done, true, __ATOMIC_RELEASE);
+    __atomic_store_n(&tx.done, true, __ATOMIC_RELEASE);
+    pthread_join(rx_tid, NULL);
+    pthread_join(tx_tid, NULL);
+
+    gs_sim_stats_t stats[1];
+    gs_radio_sim_stats(radio, stats);
+    printf("arbiter: %-18s %llu receive-side and %llu writes in %d ms, %llu overlapping.\n", arbiter ? "with the arbiter:" : "straight to it:",
+           (unsigned long long)rx.ops, (unsigned long long)tx.ops, BENCH_RACE_MS, (unsigned long long)stats->spi_overlaps);
+    gs_radio_destroy(radio);
+    return stats->spi_overlaps;
+}
+
+typedef struct
+{
+    gs_radio_t *radio;
+    int result;
+} bench_try_t;
+
+static void *bench_try_thread(void *args)
+{
+    bench_try_t *attempt = (bench_try_t *)args;
+    gs_radio_info_t info[1];
+    attempt->result = gs_radio_try_get_info(attempt->radio, info);
+    return nullptr;
+}
+
+/**
+ * @brief Asks for the part info from another thread, as the health monitor would.
+ */
+static int bench_try(gs_radio_t *radio)
+{
+    bench_try_t attempt = {radio, 0};
+    pthread_t tid;
+    pthread_create(&tid, NULL, bench_try_thread, &attempt);
+    pthread_join(tid, NULL);
+    return attempt.result;
+}
+
+/**
+ * @brief Walks the burst API: nesting, the health probe standing back, suspending for ACKs.
+ * 
+ * @return int Failed checks.
+ */
+static int check_bursts(void)
+{
+    int failures = 0;
+    gs_radio_t *radio = bench_radio("external,rate=0");
+    gs_radio_init(radio);
+    gst_frame_t frame[1];
+    gs_uhf_frame_build(frame, "burst", 5);
+    gs_arbiter_stats_t stats[1];
+
+    CHECK(bench_try(radio) == 1);
+    gs_arbiter_tx_begin(radio);
+    gs_arbiter_tx_begin(radio);
+    CHECK(gs_radio_write(radio, frame, sizeof(gst_frame_t)) == sizeof(gst_frame_t));
+    gs_arbiter_tx_end(radio);
+    // Still the outer burst's.
+    CHECK(bench_try(radio) == -1);
+    CHECK(gs_radio_write(radio, frame, sizeof(gst_frame_t)) == sizeof(gst_frame_t));
+
+    int depth = gs_arbiter_tx_suspend(radio);
+    CHECK(depth == 1);
+    CHECK(bench_try(radio) == 1);
+    gs_arbiter_tx_resume(radio, depth);
+    CHECK(bench_try(radio) == -1);
+    gs_arbiter_tx_end(radio);
+    CHECK(bench_try(radio) == 1);
+
+    // A burst that wrote nothing never left RX.
+    gs_arbiter_tx_begin(radio);
+    gs_arbiter_tx_end(radio);
+
+    // Outside a burst, a write is a burst of its own.
+    CHECK(gs_radio_write(radio, frame, sizeof(gst_frame_t)) == sizeof(gst_frame_t));
+    gs_arbiter_get_stats(radio, stats);
+    CHECK(stats->bursts == 2 && stats->burst_frames == 3);
+    CHECK(stats->rx_refused == 2);
+
+    gs_radio_destroy(radio);
+    return failures;
+}
+
+typedef struct
+{
+    NetDataClient *server;
+    int replies;
+} bench_server_t;
+
+static void *bench_server_thread(void *args)
+{
+    bench_server_t *server = (bench_server_t *)args;
+    NetFrame *netframe = new NetFrame();
+    cmd_output_t reply[1];
+
+    while (netframe->recvFrame(server->server) >= 0)
+    {
+        if (netframe->getType() == NetType::DATA && netframe->getPayloadSize() == sizeof(cmd_output_t) &&
+            netframe->retrievePayload((unsigned char *)reply, sizeof(cmd_output_t)) >= 0 && *(uint32_t *)reply->data == BENCH_MAGIC)
+        {
+            __atomic_fetch_add(&server->replies, 1, __ATOMIC_RELEASE);
+        }
+    }
+    delete netframe;
+    return nullptr;
+}
+
+typedef struct
+{
+    gs_radio_t *radio;
+    bool done;
+    int commands;
+} bench_far_t;
+
+/**
+ * @brief The spacecraft: takes an exchange's commands off the air, then answers each one. Answering while the
+ * ground station is still transmitting would go unheard.
+ */
+static void *bench_far_thread(void *args)
+{
+    bench_far_t *far = (bench_far_t *)args;
+    gst_fec_frame_t heard[BENCH_COMMANDS];
+    int count = 0;
+    while (!__atomic_load_n(&far->done, __ATOMIC_ACQUIRE))
+    {
+        gst_fec_frame_t air[1];
+        if (count < BENCH_COMMANDS && gs_radio_sim_far_recv(far->radio, air, sizeof(air), count ? BENCH_QUIET_MS : 100) > 0)
+        {
+            if (gs_uhf_validate(&air->frame) == GST_SUCCESS)
+            {
+                heard[count++] = *air;
+                __atomic_fetch_add(&far->commands, 1, __ATOMIC_RELEASE);
+            }
+            continue;
+        }
+        for (int i = 0; i < count; i++)
+        {
+            gs_radio_sim_far_send(far->radio, &heard[i].frame, sizeof(gst_frame_t));
+        }
+        count = 0;
+    }
+    return nullptr;
+}
+
+static void *bench_loop_thread(void *args)
+{
+    gs_uhf_event_loop((global_data_t *)args, false);
+    return nullptr;
+}
+
+/**
+ * @brief Runs BENCH_EXCHANGES exchanges of BENCH_COMMANDS commands and their replies through the daemon's
+ * threads, and reports the bursts they went out in and the turnarounds.
+ * 
+ * @return int 1 if every reply arrived, the commands were batched and the device was never driven twice at once.
+ */
+static int bench_exchanges(void)
+{
+    global_data_t global[1];
+    memset(global, 0x0, sizeof(global_data_t));
+    global->radio = bench_radio("external,rate=" BENCH_RATE);
+    global->uhf_rx_ring = gs_ring_create(UHF_RX_RING_SIZE);
+    global->uhf_tx_queue = gs_tx_queue_create(UHF_TX_QUEUE_SIZE);
+    global->uhf_sar = gs_sar_create(UHF_SAR_MAX_MESSAGE);
+    global->netframe_pool = gs_pool_create("NetFrame", sizeof(NetFrame), NETFRAME_POOL_SIZE);
+    global->payload_pool = gs_pool_create("Payload", NETFRAME_MAX_PAYLOAD_SIZE, PAYLOAD_POOL_SIZE);
+    global->reactor = gs_reactor_create();
+    global->health_ms = 50; // Probing often, to keep the arbiter busy.
+    pthread_mutex_init(&global->net_lock, NULL);
+    int sv[2];
+    if (global->radio == nullptr || global->reactor == nullptr || socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0)
+    {
+        dbprintlf(FATAL "Failed to set up the ground station.");
+        return 0;
+    }
+    global->network_data = new NetDataClient(NetPort::ROOFUHF, SERVER_POLL_RATE);
+    global->network_data->socket = sv[0];
+    global->network_data->connection_ready = true;
+    global->network_data->thread_status = 1;
+    bench_server_t server = {new NetDataClient(NetPort::ROOFUHF, SERVER_POLL_RATE), 0};
+    server.server->socket = sv[1];
+    server.server->connection_ready = true;
+    bench_far_t far = {global->radio, false, 0};
+
+    pthread_t server_tid, loop_tid, tx_tid, far_tid;
+    pthread_create(&server_tid, NULL, bench_server_thread, &server);
+    pthread_create(&loop_tid, NULL, bench_loop_thread, global);
+    pthread_create(&tx_tid, NULL, gs_uhf_tx_thread, global);
+    pthread_create(&far_tid, NULL, bench_far_thread, &far);
+    while (!__atomic_load_n(&global->uhf_ready, __ATOMIC_ACQUIRE))
+    {
+        usleep(1000);
+    }
+
+    uint64_t deadline = gs_time_ns() + BENCH_TIMEOUT_S * NSEC_PER_SEC;
+    uint64_t total_ns = 0, worst_ns = 0;
+    int exchanges = 0;
+    for (; exchanges < BENCH_EXCHANGES && gs_time_ns() < deadline; exchanges++)
+    {
+        int expected = __atomic_load_n(&server.replies, __ATOMIC_ACQUIRE) + BENCH_COMMANDS;
+        uint64_t start = gs_time_ns();
+        for (int i = 0; i < BENCH_COMMANDS; i++)
+        {
+            cmd_input_t command[1];
+            memset(command, 0x0, sizeof(cmd_input_t));
+            command->data_size = 8;
+            ((uint32_t *)command->data)[0] = BENCH_MAGIC;
+            ((uint32_t *)command->data)[1] = exchanges * BENCH_COMMANDS + i;
+            NetFrame netframe((unsigned char *)command, sizeof(cmd_input_t), NetType::DATA, NetVertex::ROOFUHF);
+            netframe.sendFrame(server.server);
+        }
+        while (__atomic_load_n(&server.replies, __ATOMIC_ACQUIRE) < expected && gs_time_ns() < deadline)
+        {
+            usleep(100);
+        }
+        if (__atomic_load_n(&server.replies, __ATOMIC_ACQUIRE) < expected)
+        {
+            break;
+        }
+        uint64_t elapsed = gs_time_ns() - start;
+        total_ns += elapsed;
+        worst_ns = elapsed > worst_ns ? elapsed : worst_ns;
+    }
+
+    gs_reactor_stop(global->reactor);
+    pthread_join(loop_tid, NULL);
+    __atomic_store_n(&global->uhf_done, true, __ATOMIC_RELEASE);
+    __atomic_store_n(&global->network_data->thread_status, 0, __ATOMIC_RELEASE);
+    gs_tx_stop(global->uhf_tx_queue);
+    pthread_join(tx_tid, NULL);
+    __atomic_store_n(&far.done, true, __ATOMIC_RELEASE);
+    pthread_join(far_tid, NULL);
+    shutdown(sv[0], SHUT_RDWR);
+    pthread_join(server_tid, NULL);
+
+    gs_arbiter_stats_t stats[1];
+    gs_arbiter_get_stats(global->radio, stats);
+    gs_sim_stats_t sim[1];
+    gs_radio_sim_stats(global->radio, sim);
+    // Every command and reply on the air back to back, with nothing else in the way.
+    double air_ms = 2.0 * BENCH_COMMANDS * sizeof(gst_frame_t) * 8 * 1000 / atoi(BENCH_RATE);
+    double frames_per_burst = stats->bursts ? (double)stats->burst_frames / stats->bursts : 0;
+    printf("arbiter: %d exchanges of %d commands and replies at " BENCH_RATE " bps: mean %.1f ms, worst %.1f ms (air time %.1f ms).\n", exchanges,
+           BENCH_COMMANDS, exchanges ? total_ns / 1e6 / exchanges : 0.0, worst_ns / 1e6, air_ms);
+    printf("arbiter: %llu bursts of %.2f frames; RX to TX mean %.1f us, max %.1f us; TX to RX mean %.1f us, max %.1f us; %llu overlapping transactions.\n",
+           (unsigned long long)stats->bursts, frames_per_burst, stats->bursts ? stats->rx_to_tx_sum_ns / 1e3 / stats->bursts : 0.0,
+           stats->rx_to_tx_max_ns / 1e3, stats->bursts ? stats->tx_to_rx_sum_ns / 1e3 / stats->bursts : 0.0, stats->tx_to_rx_max_ns / 1e3,
+           (unsigned long long)sim->spi_overlaps);
+    if (exchanges)
+    {
+        gs_bench_report("arbiter", "exchange_mean", total_ns / 1e6 / exchanges, "ms", GS_BENCH_LOWER, 10);
+        gs_bench_report("arbiter", "frames_per_burst", frames_per_burst, "frames", GS_BENCH_HIGHER, 0);
+    }
+
+    close(sv[0]);
+    close(sv[1]);
+    delete server.server;
+    delete global->network_data;
+    gs_reactor_destroy(global->reactor);
+    pthread_mutex_destroy(&global->net_lock);
+    gs_radio_destroy(global->radio);
+    gs_ring_destroy(global->uhf_rx_ring);
+    gs_tx_queue_destroy(global->uhf_tx_queue);
+    gs_sar_destroy(global->uhf_sar);
+    gs_pool_destroy(global->netframe_pool);
+    gs_pool_destroy(global->payload_pool);
+    return exchanges == BENCH_EXCHANGES && sim->spi_overlaps == 0 && frames_per_burst >= 2;
+}
+
+int main(void)
+{
+    // Per-frame debug lines would dominate the run.
+    gs_log_start("/dev/null");
+    int failures = check_bursts();
+    uint64_t raced = bench_race(false);
+    uint64_t arbitrated = bench_race(true);
+    if (raced == 0)
+    {
+        dbprintlf(YELLOW_FG "No overlaps without the arbiter this time; the check below proves less.");
+    }
+    CHECK(arbitrated == 0);
+    if (failures)
+    {
+        dbprintlf(FATAL "%d radio arbiter checks failed.", failures);
+        gs_log_stop();
+        return 1;
+    }
+
+    int ok = bench_exchanges();
+    gs_log_stop();
+    if (!ok)
+    {
+        dbprintlf(FATAL "A reply was lost, the commands were not batched, or the radio was driven twice at once.");
+        return 1;
+    }
+    return 0;
+}
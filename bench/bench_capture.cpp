@@ -0,0 +1,192 @@
+/**
+ * @file bench_capture.cpp
+ * @author agent (agent@local)
+ * @brief Measures appends to the pass capture from several threads, and checks every frame reads back intact.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "gs_capture.hpp"
+#include "gs_bench.hpp"
+#include "gs_time.hpp"
+#include "meb_debug.hpp"
+
+#define CAPTURE_PREFIX "/tmp/bench_capture"
+#define CAPTURE_THREADS 4 // The RX path, the event loop, the TX thread, and one to spare.
+#define CAPTURE_FRAMES 50000 // Per thread.
+#define CAPTURE_LONG_EVERY 16 // Every this many frames is a NetFrame-sized one, spanning several records.
+#define CAPTURE_LONG_LEN 300
+#define CAPTURE_SHORT_LEN 64
+#define CAPTURE_SMALL 100 // Records in the file that is filled to overflowing.
+
+typedef struct
+{
+    int id;
+    uint64_t ns;
+} capture_thread_t;
+
+static size_t frame_fill(uint8_t *buf, int thread, uint32_t seq)
+{
+    size_t len = seq % CAPTURE_LONG_EVERY == 0 ? CAPTURE_LONG_LEN : CAPTURE_SHORT_LEN;
+    memcpy(buf, &seq, sizeof(seq));
+    for (size_t i = sizeof(seq); i < len; i++)
+    {
+        buf[i] = (uint8_t)(thread * 31 + seq + i);
+    }
+    return len;
+}
+
+static void *capture_thread(void *args)
+{
+    capture_thread_t *thread = (capture_thread_t *)args;
+    uint8_t buf[CAPTURE_LONG_LEN];
+    uint64_t start = gs_time_ns();
+    for (uint32_t seq = 0; seq < CAPTURE_FRAMES; seq++)
+    {
+        size_t len = frame_fill(buf, thread->id, seq);
+        gs_capture_frame((gs_capture_kind_t)(GS_CAPTURE_UHF_RX + thread->id % 4), buf, len, -thread->id, thread->id);
+    }
+    thread->ns = gs_time_ns() - start;
+    return nullptr;
+}
+
+/**
+ * @brief Reads a capture back and checks each thread's frames arrived whole and in order.
+ *
+ * @return int 1 if they did.
+ */
+static int capture_verify(const char *path)
+{
+    gs_capture_file_t *file = gs_capture_open(path);
+    if (file == nullptr)
+    {
+        return 0;
+    }
+    uint32_t next[CAPTURE_THREADS] = {0};
+    uint8_t buf[CAPTURE_LONG_LEN], expect[CAPTURE_LONG_LEN];
+    gs_capture_entry_t entry;
+    uint32_t index = 0;
+    int bad = 0;
+    while (gs_capture_next(file, &index, &entry, buf, sizeof(buf)))
+    {
+        int id = entry.result;
+        if (id < 0 || id >= CAPTURE_THREADS || entry.rssi != -id || entry.kind != GS_CAPTURE_UHF_RX + id % 4)
+        {
+            bad++;
+            continue;
+        }
+        size_t len = frame_fill(expect, id, next[id]);
+        if (entry.len != len || memcmp(buf, expect, len) != 0)
+        {
+            bad++;
+        }
+        next[id]++;
+    }
+    gs_capture_close(file);
+
+    int ok = bad == 0;
+    for (int i = 0; i < CAPTURE_THREADS; i++)
+    {
+        ok = ok && next[i] == CAPTURE_FRAMES;
+    }
+    if (!ok)
+    {
+        dbprintlf(FATAL "Capture read back wrong: %d bad frames, thread 0 has %u of %d.", bad, next[0], CAPTURE_FRAMES);
+    }
+    return ok;
+}
+
+int main(void)
+{
+    char path[GS_CAPTURE_PATH_MAX];
+    gs_capture_stats_t stats[1];
+    uint32_t records = CAPTURE_THREADS * CAPTURE_FRAMES * 2;
+
+    // Concurrent appends, then read back.
+    if (!gs_capture_start(CAPTURE_PREFIX, records, 0))
+    {
+        return 1;
+    }
+    gs_capture_path(path);
+    pthread_t tids[CAPTURE_THREADS];
+    capture_thread_t threads[CAPTURE_THREADS];
+    uint64_t start = gs_time_ns();
+    for (int i = 0; i < CAPTURE_THREADS; i++)
+    {
+        threads[i] = {i, 0};
+        pthread_create(&tids[i], NULL, capture_thread, &threads[i]);
+    }
+    uint64_t thread_ns = 0;
+    for (int i = 0; i < CAPTURE_THREADS; i++)
+    {
+        pthread_join(tids[i], NULL);
+        thread_ns += threads[i].ns;
+    }
+    uint64_t wall_ns = gs_time_ns() - start;
+    gs_capture_get_stats(stats);
+    gs_capture_stop();
+
+    int frames = CAPTURE_THREADS * CAPTURE_FRAMES;
+    printf("capture: %d frames (%llu records) from %d threads: %.1f ns/frame per thread, %.2f M frames/s overall.\n",
+           frames, (unsigned long long)stats->records, CAPTURE_THREADS, (double)thread_ns / frames,
+           frames / (wall_ns / 1e3));
+    gs_bench_report("capture", "append", (double)thread_ns / frames, "ns/frame", GS_BENCH_LOWER, 25);
+    int ok = capture_verify(path);
+    unlink(path);
+
+    // A file too small for what is written into it: the excess is dropped and counted, and rotation starts afresh.
+    if (!gs_capture_start(CAPTURE_PREFIX, CAPTURE_SMALL, 0))
+    {
+        return 1;
+    }
+    uint8_t buf[CAPTURE_SHORT_LEN] = {0};
+    for (int i = 0; i < CAPTURE_SMALL + 10; i++)
+    {
+        gs_capture_frame(GS_CAPTURE_NET_TX, buf, sizeof(buf), 0, 0);
+    }
+    gs_capture_path(path);
+    gs_capture_rotate();
+    gs_capture_frame(GS_CAPTURE_NET_TX, buf, sizeof(buf), 0, 0);
+    gs_capture_stats_t after[1];
+    gs_capture_get_stats(after);
+    char rotated[GS_CAPTURE_PATH_MAX];
+    gs_capture_path(rotated);
+    gs_capture_stop();
+
+    int full = 0, fresh = 0;
+    gs_capture_entry_t entry;
+    uint32_t index = 0;
+    gs_capture_file_t *file = gs_capture_open(path);
+    while (file != nullptr && gs_capture_next(file, &index, &entry, buf, sizeof(buf)))
+    {
+        full++;
+    }
+    gs_capture_close(file);
+    index = 0;
+    file = gs_capture_open(rotated);
+    while (file != nullptr && gs_capture_next(file, &index, &entry, buf, sizeof(buf)))
+    {
+        fresh++;
+    }
+    gs_capture_close(file);
+    unlink(path);
+    unlink(rotated);
+
+    uint64_t dropped = after->dropped - stats->dropped;
+    printf("capture: full file kept %d of %d frames, %llu dropped; after rotation %d.\n", full, CAPTURE_SMALL + 10,
+           (unsigned long long)dropped, fresh);
+    if (full != CAPTURE_SMALL || dropped != 10 || fresh != 1 || strcmp(path, rotated) == 0)
+    {
+        dbprintlf(FATAL "Capture overflow or rotation misbehaved.");
+        ok = 0;
+    }
+    return ok ? 0 : 1;
+}
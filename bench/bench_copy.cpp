@@ -0,0 +1,213 @@
+/**
+ * @file bench_copy.cpp
+ * @author agent (agent@local)
+ * @brief Counts the frame bytes copied per downlink and per uplink frame, end to end through the event loop.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * Frames from the simulated spacecraft go to a stand-in server, and commands from the server go to the
+ * spacecraft, through the same event loop and UHF TX thread the daemon runs. Both directions are checked
+ * byte for byte. The copies are what GS_COUNT_DOWNLINK_COPY_BYTES and GS_COUNT_UPLINK_COPY_BYTES record: the
+ * radio's own read and write, and the socket, are not counted; NetFrame's copy of the payload is. Fails if
+ * a frame is lost or altered, or if either path copies a frame more than once.
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include "gs_uhf.hpp"
+#include "gs_reactor.hpp"
+#include "gs_ring.hpp"
+#include "gs_tx.hpp"
+#include "gs_sar.hpp"
+#include "gs_radio.hpp"
+#include "gs_metrics.hpp"
+#include "gs_bench.hpp"
+#include "gs_time.hpp"
+#include "gs_log.hpp"
+#include "meb_debug.hpp"
+
+#define COPY_FRAMES 2000
+#define COPY_TIMEOUT_S 10
+
+typedef struct
+{
+    NetDataClient *server;
+    int received;
+    int bad;
+} copy_server_t;
+
+static void copy_fill(uint8_t *buf, size_t len, int seq)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        buf[i] = (uint8_t)(seq * 7 + i);
+    }
+}
+
+static void *copy_server_thread(void *args)
+{
+    copy_server_t *server = (copy_server_t *)args;
+    NetFrame *netframe = new NetFrame();
+    uint8_t payload[NETFRAME_MAX_PAYLOAD_SIZE], expect[sizeof(cmd_output_t)];
+
+    while (server->received < COPY_FRAMES && netframe->recvFrame(server->server) >= 0)
+    {
+        int size = netframe->getPayloadSize();
+        if (netframe->getType() != NetType::DATA || size < 0 || size > NETFRAME_MAX_PAYLOAD_SIZE || netframe->retrievePayload(payload, size) < 0)
+        {
+            continue;
+        }
+        copy_fill(expect, sizeof(expect), server->received);
+        if (size != sizeof(cmd_output_t) || memcmp(payload, expect, size) != 0)
+        {
+            server->bad++;
+        }
+        __atomic_store_n(&server->received, server->received + 1, __ATOMIC_RELEASE);
+    }
+    delete netframe;
+    return nullptr;
+}
+
+static void *copy_loop_thread(void *args)
+{
+    gs_uhf_event_loop((global_data_t *)args, false);
+    return nullptr;
+}
+
+int main(void)
+{
+    // Per-frame debug lines would dominate the run.
+    gs_log_start("/dev/null");
+    gs_sim_config_t config[1];
+    gs_radio_sim_defaults(config);
+    gs_radio_sim_parse(config, "external,rate=0");
+    global_data_t global[1];
+    memset(global, 0x0, sizeof(global_data_t));
+    global->radio = gs_radio_sim_create(config);
+    global->uhf_rx_ring = gs_ring_create(UHF_RX_RING_SIZE);
+    global->uhf_tx_queue = gs_tx_queue_create(UHF_TX_QUEUE_SIZE);
+    global->uhf_sar = gs_sar_create(UHF_SAR_MAX_MESSAGE);
+    global->netframe_pool = gs_pool_create("NetFrame", sizeof(NetFrame), NETFRAME_POOL_SIZE);
+    global->payload_pool = gs_pool_create("Payload", NETFRAME_MAX_PAYLOAD_SIZE, PAYLOAD_POOL_SIZE);
+    global->reactor = gs_reactor_create();
+    pthread_mutex_init(&global->net_lock, NULL);
+    int sv[2];
+    if (global->radio == nullptr || global->reactor == nullptr || socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0)
+    {
+        dbprintlf(FATAL "Failed to set up the ground station.");
+        return 1;
+    }
+    global->network_data = new NetDataClient(NetPort::ROOFUHF, SERVER_POLL_RATE);
+    global->network_data->socket = sv[0];
+    global->network_data->connection_ready = true;
+    global->network_data->thread_status = 1;
+    copy_server_t server[1] = {{new NetDataClient(NetPort::ROOFUHF, SERVER_POLL_RATE), 0, 0}};
+    server->server->socket = sv[1];
+    server->server->connection_ready = true;
+
+    pthread_t server_tid, loop_tid, tx_tid;
+    pthread_create(&server_tid, NULL, copy_server_thread, server);
+    pthread_create(&loop_tid, NULL, copy_loop_thread, global);
+    pthread_create(&tx_tid, NULL, gs_uhf_tx_thread, global);
+    while (!__atomic_load_n(&global->uhf_ready, __ATOMIC_ACQUIRE))
+    {
+        usleep(1000);
+    }
+
+    // Downlink: one frame in the radio's FIFO at a time, so none is overrun.
+    uint64_t down_before = gs_metrics_counter(GS_COUNT_DOWNLINK_COPY_BYTES);
+    uint64_t deadline = gs_time_ns() + COPY_TIMEOUT_S * NSEC_PER_SEC;
+    gs_sim_stats_t sim[1];
+    for (int i = 0; i < COPY_FRAMES && gs_time_ns() < deadline; i++)
+    {
+        uint8_t payload[sizeof(cmd_output_t)];
+        copy_fill(payload, sizeof(payload), i);
+        gst_frame_t frame[1];
+        gs_uhf_frame_build(frame, payload, sizeof(payload));
+        gs_radio_sim_far_send(global->radio, frame, sizeof(gst_frame_t));
+        gs_radio_sim_stats(global->radio, sim);
+        while (sim->downlink_read < (uint64_t)i + 1 && gs_time_ns() < deadline)
+        {
+            usleep(10);
+            gs_radio_sim_stats(global->radio, sim);
+        }
+    }
+    while (__atomic_load_n(&server->received, __ATOMIC_ACQUIRE) < COPY_FRAMES && gs_time_ns() < deadline)
+    {
+        usleep(1000);
+    }
+    uint64_t down_bytes = gs_metrics_counter(GS_COUNT_DOWNLINK_COPY_BYTES) - down_before;
+
+    // Uplink: commands from the server, each checked as it comes off the air.
+    uint64_t up_before = gs_metrics_counter(GS_COUNT_UPLINK_COPY_BYTES);
+    int uplinked = 0, up_bad = 0;
+    for (int i = 0; i < COPY_FRAMES && gs_time_ns() < deadline; i++)
+    {
+        uint8_t payload[sizeof(cmd_input_t)];
+        copy_fill(payload, sizeof(payload), i);
+        payload[0] = 0;
+        NetFrame netframe(payload, sizeof(payload), NetType::DATA, NetVertex::ROOFUHF);
+        netframe.sendFrame(server->server);
+
+        gst_fec_frame_t air[1];
+        if (gs_radio_sim_far_recv(global->radio, air, sizeof(air), 1000) != sizeof(gst_frame_t))
+        {
+            break;
+        }
+        uplinked++;
+        up_bad += gs_uhf_validate(&air->frame) != GST_SUCCESS || memcmp(air->frame.payload, payload, sizeof(payload)) != 0;
+    }
+    uint64_t up_bytes = gs_metrics_counter(GS_COUNT_UPLINK_COPY_BYTES) - up_before;
+
+    gs_reactor_stop(global->reactor);
+    pthread_join(loop_tid, NULL);
+    __atomic_store_n(&global->uhf_done, true, __ATOMIC_RELEASE);
+    __atomic_store_n(&global->network_data->thread_status, 0, __ATOMIC_RELEASE);
+    gs_tx_stop(global->uhf_tx_queue);
+    pthread_join(tx_tid, NULL);
+    shutdown(sv[0], SHUT_RDWR);
+    pthread_join(server_tid, NULL);
+    gs_log_stop();
+
+    int downlinked = server->received;
+    double down_per = downlinked ? (double)down_bytes / downlinked : 0;
+    double up_per = uplinked ? (double)up_bytes / uplinked : 0;
+    printf("copy: downlink %d/%d frames (%d altered), %.1f bytes copied per %d-byte frame.\n", downlinked, COPY_FRAMES,
+           server->bad, down_per, (int)sizeof(cmd_output_t));
+    printf("copy: uplink   %d/%d frames (%d altered), %.1f bytes copied per %d-byte command.\n", uplinked, COPY_FRAMES,
+           up_bad, up_per, (int)sizeof(cmd_input_t));
+    gs_bench_report("copy", "downlink_bytes", down_per, "bytes/frame", GS_BENCH_LOWER, 0);
+    gs_bench_report("copy", "uplink_bytes", up_per, "bytes/frame", GS_BENCH_LOWER, 0);
+
+    close(sv[0]);
+    close(sv[1]);
+    delete server->server;
+    delete global->network_data;
+    gs_reactor_destroy(global->reactor);
+    gs_radio_destroy(global->radio);
+    gs_ring_destroy(global->uhf_rx_ring);
+    gs_tx_queue_destroy(global->uhf_tx_queue);
+    gs_sar_destroy(global->uhf_sar);
+    gs_pool_destroy(global->netframe_pool);
+    gs_pool_destroy(global->payload_pool);
+    pthread_mutex_destroy(&global->net_lock);
+
+    if (downlinked != COPY_FRAMES || uplinked != COPY_FRAMES || server->bad || up_bad)
+    {
+        dbprintlf(FATAL "Frames lost or altered.");
+        return 1;
+    }
+    if (down_per > GST_MAX_PAYLOAD_SIZE || up_per > GST_MAX_PAYLOAD_SIZE)
+    {
+        dbprintlf(FATAL "A frame is copied more than once on its way through.");
+        return 1;
+    }
+    return 0;
+}
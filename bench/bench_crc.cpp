@@ -0,0 +1,177 @@
+/**
+ * @file bench_crc.cpp
+ * @author agent (agent@local)
+ * @brief Checks every gs_crc16 path bit-for-bit against libsi446x's internal_crc16(), then reports frames/s.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <si446x.h>
+#include "gs_uhf.hpp"
+#include "gs_crc.hpp"
+#include "gs_bench.hpp"
+#include "gs_time.hpp"
+#include "meb_debug.hpp"
+
+#define BENCH_FRAMES 4096 // Working set of frames, fits in L2.
+#define BENCH_ROUNDS 200
+#define EQUIV_TRIALS 20000
+#define EQUIV_MAX_LEN 512
+
+static volatile uint16_t sink;
+
+/**
+ * @brief Compares every supported implementation, and the batch API, with internal_crc16().
+ * 
+ * @return int Number of mismatches.
+ */
+static int check_equivalence(void)
+{
+    static uint8_t buf[EQUIV_MAX_LEN];
+    int mismatches = 0;
+    srand(0x6f35);
+
+    for (int trial = 0; trial < EQUIV_TRIALS; trial++)
+    {
+        int len = trial < EQUIV_MAX_LEN ? trial : rand() % EQUIV_MAX_LEN;
+        for (int i = 0; i < len; i++)
+        {
+            buf[i] = rand();
+        }
+
+        uint16_t ref = internal_crc16(buf, len);
+        for (int impl = GS_CRC_BITWISE; impl < GS_CRC_NUM_IMPL; impl++)
+        {
+            if (!gs_crc16_supported((gs_crc_impl_t)impl))
+            {
+                continue;
+            }
+            uint16_t crc = gs_crc16_impl((gs_crc_impl_t)impl, buf, len);
+            if (crc != ref)
+            {
+                if (mismatches++ < 10)
+                {
+                    dbprintlf(RED_FG "%s: length %d gives 0x%04x, internal_crc16 gives 0x%04x.", gs_crc16_name((gs_crc_impl_t)impl), len, crc, ref);
+                }
+            }
+        }
+    }
+
+    // Batch API over whole GST frames, with a count that is not a multiple of the interleave.
+    static gst_frame_t frames[BENCH_FRAMES + 3];
+    static uint16_t crcs[BENCH_FRAMES + 3];
+    for (size_t i = 0; i < BENCH_FRAMES + 3; i++)
+    {
+        for (int j = 0; j < GST_MAX_PAYLOAD_SIZE; j++)
+        {
+            frames[i].payload[j] = rand();
+        }
+    }
+    gs_crc16_batch(frames[0].payload, sizeof(gst_frame_t), GST_MAX_PAYLOAD_SIZE, BENCH_FRAMES + 3, crcs);
+    for (size_t i = 0; i < BENCH_FRAMES + 3; i++)
+    {
+        if (crcs[i] != internal_crc16(frames[i].payload, GST_MAX_PAYLOAD_SIZE))
+        {
+            if (mismatches++ < 10)
+            {
+                dbprintlf(RED_FG "batch: frame %zu mismatches internal_crc16.", i);
+            }
+        }
+    }
+
+    return mismatches;
+}
+
+static double bench_single(gs_crc_impl_t impl, gst_frame_t *frames)
+{
+    uint16_t acc = 0;
+    uint64_t start = gs_time_ns();
+    for (int round = 0; round < BENCH_ROUNDS; round++)
+    {
+        for (int i = 0; i < BENCH_FRAMES; i++)
+        {
+            acc ^= gs_crc16_impl(impl, frames[i].payload, GST_MAX_PAYLOAD_SIZE);
+        }
+    }
+    uint64_t elapsed = gs_time_ns() - start;
+    sink = acc;
+    return (double)BENCH_FRAMES * BENCH_ROUNDS * NSEC_PER_SEC / elapsed;
+}
+
+static double bench_internal(gst_frame_t *frames)
+{
+    uint16_t acc = 0;
+    uint64_t start = gs_time_ns();
+    for (int round = 0; round < BENCH_ROUNDS; round++)
+    {
+        for (int i = 0; i < BENCH_FRAMES; i++)
+        {
+            acc ^= internal_crc16(frames[i].payload, GST_MAX_PAYLOAD_SIZE);
+        }
+    }
+    uint64_t elapsed = gs_time_ns() - start;
+    sink = acc;
+    return (double)BENCH_FRAMES * BENCH_ROUNDS * NSEC_PER_SEC / elapsed;
+}
+
+static double bench_batch(gst_frame_t *frames)
+{
+    static int results[BENCH_FRAMES];
+    uint64_t start = gs_time_ns();
+    for (int round = 0; round < BENCH_ROUNDS; round++)
+    {
+        gs_uhf_validate_batch(frames, BENCH_FRAMES, results);
+    }
+    uint64_t elapsed = gs_time_ns() - start;
+    sink = results[0];
+    return (double)BENCH_FRAMES * BENCH_ROUNDS * NSEC_PER_SEC / elapsed;
+}
+
+int main(void)
+{
+    int mismatches = check_equivalence();
+    if (mismatches)
+    {
+        dbprintlf(FATAL "%d CRC mismatches against internal_crc16().", mismatches);
+        return 1;
+    }
+    printf("crc16: all implementations bit-exact with internal_crc16().\n");
+
+    static gst_frame_t frames[BENCH_FRAMES];
+    for (int i = 0; i < BENCH_FRAMES; i++)
+    {
+        uint8_t payload[GST_MAX_PAYLOAD_SIZE];
+        for (int j = 0; j < GST_MAX_PAYLOAD_SIZE; j++)
+        {
+            payload[j] = rand();
+        }
+        gs_uhf_frame_build(&frames[i], payload, sizeof(payload));
+    }
+
+    printf("%-16s %14s %10s\n", "path", "frames/s", "ns/frame");
+    double fps = bench_internal(frames);
+    printf("%-16s %14.0f %10.1f\n", "internal_crc16", fps, 1e9 / fps);
+    gs_bench_report("crc", "internal_crc16", fps, "frames/s", GS_BENCH_HIGHER, 0);
+    for (int impl = GS_CRC_BITWISE; impl < GS_CRC_NUM_IMPL; impl++)
+    {
+        if (!gs_crc16_supported((gs_crc_impl_t)impl))
+        {
+            printf("%-16s %14s\n", gs_crc16_name((gs_crc_impl_t)impl), "unsupported");
+            continue;
+        }
+        fps = bench_single((gs_crc_impl_t)impl, frames);
+        printf("%-16s %14.0f %10.1f\n", gs_crc16_name((gs_crc_impl_t)impl), fps, 1e9 / fps);
+        gs_bench_report("crc", gs_crc16_name((gs_crc_impl_t)impl), fps, "frames/s", GS_BENCH_HIGHER, 0);
+    }
+    fps = bench_batch(frames);
+    printf("%-16s %14.0f %10.1f  (validate_batch, %s)\n", "batch", fps, 1e9 / fps, gs_crc16_name(gs_crc16_active()));
+    gs_bench_report("crc", "batch", fps, "frames/s", GS_BENCH_HIGHER, 0);
+
+    return 0;
+}
@@ -0,0 +1,343 @@
+/**
+ * @file bench_diversity.cpp
+ * @author agent (agent@local)
+ * @brief Checks several radios hearing one spacecraft deliver each frame to the server once, and the uplink uses the loudest.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * First the combiner on its own: duplicates inside the window, a repeat outside it, the uplink choice, and
+ * the cost of an offer. Then end to end: DIV_RADIOS simulated radios, each losing DIV_LOSS of the downlink
+ * independently, are read on their own threads through the same event loop and UHF TX thread the daemon
+ * runs. Every frame is put on all of their air at once. Fails if the server sees a frame twice, if more are
+ * lost than DIV_LOSS^DIV_RADIOS allows for, or if a command goes out on any radio but the loudest.
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include "gs_uhf.hpp"
+#include "gs_diversity.hpp"
+#include "gs_reactor.hpp"
+#include "gs_ring.hpp"
+#include "gs_tx.hpp"
+#include "gs_sar.hpp"
+#include "gs_radio.hpp"
+#include "gs_metrics.hpp"
+#include "gs_bench.hpp"
+#include "gs_time.hpp"
+#include "gs_log.hpp"
+#include "meb_debug.hpp"
+
+#define DIV_RADIOS 4
+#define DIV_LOSS 0.2 // Per radio; all four lose a frame 0.16% of the time.
+#define DIV_LOUDEST 2
+#define DIV_FRAMES 2000
+#define DIV_COMMANDS 20
+#define DIV_OFFERS 1000000
+#define DIV_TIMEOUT_S 20
+
+static const int16_t div_rssi[DIV_RADIOS] = {-100, -95, -85, -105};
+
+typedef struct
+{
+    NetDataClient *server;
+    uint8_t seen[DIV_FRAMES];
+    int received;
+    int repeated;
+    int bad;
+} div_server_t;
+
+static void div_fill(gst_frame_t *frame, uint32_t seq)
+{
+    uint8_t payload[sizeof(cmd_output_t)];
+    memcpy(payload, &seq, sizeof(seq));
+    for (size_t i = sizeof(seq); i < sizeof(payload); i++)
+    {
+        payload[i] = (uint8_t)(seq * 13 + i);
+    }
+    gs_uhf_frame_build(frame, payload, sizeof(payload));
+}
+
+static void *div_server_thread(void *args)
+{
+    div_server_t *server = (div_server_t *)args;
+    NetFrame *netframe = new NetFrame();
+    uint8_t payload[NETFRAME_MAX_PAYLOAD_SIZE];
+
+    while (netframe->recvFrame(server->server) >= 0)
+    {
+        int size = netframe->getPayloadSize();
+        if (netframe->getType() != NetType::DATA || size < 0 || size > NETFRAME_MAX_PAYLOAD_SIZE || netframe->retrievePayload(payload, size) < 0)
+        {
+            continue;
+        }
+        uint32_t seq;
+        memcpy(&seq, payload, sizeof(seq));
+        gst_frame_t expect[1];
+        div_fill(expect, seq);
+        if (size != sizeof(cmd_output_t) || seq >= DIV_FRAMES || memcmp(payload, expect->payload, size) != 0)
+        {
+            server->bad++;
+        }
+        else if (server->seen[seq]++)
+        {
+            server->repeated++;
+        }
+        __atomic_store_n(&server->received, server->received + 1, __ATOMIC_RELEASE);
+    }
+    delete netframe;
+    return nullptr;
+}
+
+static void *div_loop_thread(void *args)
+{
+    gs_uhf_event_loop((global_data_t *)args, true);
+    return nullptr;
+}
+
+/**
+ * @brief The combiner without radios.
+ * 
+ * @return int 1 if it behaved.
+ */
+static int div_unit(void)
+{
+    int ok = 1;
+    gs_diversity_t *div = gs_div_create(DIV_RADIOS, UHF_DIVERSITY_WINDOW_MS, UHF_DIVERSITY_STALE_MS);
+    gst_frame_t frame[1], other[1];
+    div_fill(frame, 1);
+    div_fill(other, 2);
+    uint64_t t = 1 * NSEC_PER_SEC;
+
+    ok &= gs_div_offer(div, 0, frame, -100, t) == 1;
+    ok &= gs_div_offer(div, 1, frame, -90, t + 1 * NSEC_PER_MSEC) == 0;
+    ok &= gs_div_offer(div, 2, other, -90, t + 2 * NSEC_PER_MSEC) == 1;
+    // A copy read before the first one, as a slower RX thread can deliver it.
+    ok &= gs_div_offer(div, 3, frame, -95, t - 1 * NSEC_PER_MSEC) == 0;
+    // The same bytes a whole window later were sent again.
+    ok &= gs_div_offer(div, 0, frame, -100, t + (UHF_DIVERSITY_WINDOW_MS + 1) * NSEC_PER_MSEC) == 1;
+    if (!ok)
+    {
+        dbprintlf(FATAL "Duplicates not told apart from new frames.");
+    }
+
+    // Radio 1 has been heard loudest; radio 2 only on one frame at -90.
+    int pick = gs_div_uplink(div, 0xf, t + 1 * NSEC_PER_SEC);
+    int down = gs_div_uplink(div, 0xf & ~(1 << pick), t + 1 * NSEC_PER_SEC);
+    int stale = gs_div_uplink(div, 0x8, t + (UHF_DIVERSITY_STALE_MS + 1000) * NSEC_PER_MSEC);
+    int none = gs_div_uplink(div, 0x0, t + 1 * NSEC_PER_SEC);
+    if (pick != 1 || down != 2 || stale != 3 || none != -1)
+    {
+        dbprintlf(FATAL "Uplink picked radios %d, %d, %d, %d instead of 1, 2, 3, -1.", pick, down, stale, none);
+        ok = 0;
+    }
+    gs_div_destroy(div);
+
+    // Cost per copy, every frame heard by every radio.
+    div = gs_div_create(DIV_RADIOS, UHF_DIVERSITY_WINDOW_MS, UHF_DIVERSITY_STALE_MS);
+    static gst_frame_t frames[64];
+    for (int i = 0; i < 64; i++)
+    {
+        div_fill(&frames[i], i);
+    }
+    int forwarded = 0;
+    uint64_t start = gs_time_ns();
+    for (int i = 0; i < DIV_OFFERS; i++)
+    {
+        // One frame per 53 ms of air time, the copies microseconds apart.
+        int seq = i / DIV_RADIOS;
+        forwarded += gs_div_offer(div, i % DIV_RADIOS, &frames[seq % 64], div_rssi[i % DIV_RADIOS], seq * 53 * NSEC_PER_MSEC + (i % DIV_RADIOS) * NSEC_PER_USEC);
+    }
+    uint64_t ns = gs_time_ns() - start;
+    gs_div_radio_stats_t loudest[1];
+    gs_div_get_stats(div, DIV_LOUDEST, loudest);
+    gs_div_destroy(div);
+    printf("diversity: %d offers from %d radios, %.1f ns each, %d forwarded, radio %d loudest for %llu.\n", DIV_OFFERS,
+           DIV_RADIOS, (double)ns / DIV_OFFERS, forwarded, DIV_LOUDEST, (unsigned long long)loudest->best);
+    gs_bench_report("diversity", "offer", (double)ns / DIV_OFFERS, "ns", GS_BENCH_LOWER, 0);
+    if (forwarded != DIV_OFFERS / DIV_RADIOS || loudest->best < (uint64_t)forwarded - GS_DIV_HISTORY)
+    {
+        dbprintlf(FATAL "Combiner forwarded %d of %d frames.", forwarded, DIV_OFFERS / DIV_RADIOS);
+        ok = 0;
+    }
+    return ok;
+}
+
+int main(void)
+{
+    int ok = div_unit();
+
+    // Per-frame debug lines would dominate the run.
+    gs_log_start("/dev/null");
+    global_data_t global[1];
+    memset(global, 0x0, sizeof(global_data_t));
+    global->num_radios = DIV_RADIOS;
+    for (int i = 0; i < DIV_RADIOS; i++)
+    {
+        char options[64];
+        snprintf(options, sizeof(options), "external,rate=0,loss=%g,rssi=%d,seed=%d", DIV_LOSS, div_rssi[i], i + 1);
+        gs_sim_config_t config[1];
+        gs_radio_sim_defaults(config);
+        gs_radio_sim_parse(config, options);
+        global->radios[i] = {global, i, gs_radio_sim_create(config), gs_ring_create(UHF_RX_RING_SIZE), 0, false};
+        if (global->radios[i].radio == nullptr || global->radios[i].rx_ring == nullptr)
+        {
+            dbprintlf(FATAL "Failed to set up radio %d.", i);
+            return 1;
+        }
+    }
+    global->radio = global->radios[0].radio;
+    global->diversity = gs_div_create(DIV_RADIOS, UHF_DIVERSITY_WINDOW_MS, UHF_DIVERSITY_STALE_MS);
+    global->uhf_rx_ring = gs_ring_create(UHF_RX_RING_SIZE);
+    global->uhf_tx_queue = gs_tx_queue_create(UHF_TX_QUEUE_SIZE);
+    global->uhf_sar = gs_sar_create(UHF_SAR_MAX_MESSAGE);
+    global->netframe_pool = gs_pool_create("NetFrame", sizeof(NetFrame), NETFRAME_POOL_SIZE);
+    global->payload_pool = gs_pool_create("Payload", NETFRAME_MAX_PAYLOAD_SIZE, PAYLOAD_POOL_SIZE);
+    global->reactor = gs_reactor_create();
+    pthread_mutex_init(&global->net_lock, NULL);
+    int sv[2];
+    if (global->diversity == nullptr || global->reactor == nullptr || socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0)
+    {
+        dbprintlf(FATAL "Failed to set up the ground station.");
+        return 1;
+    }
+    global->network_data = new NetDataClient(NetPort::ROOFUHF, SERVER_POLL_RATE);
+    global->network_data->socket = sv[0];
+    global->network_data->connection_ready = true;
+    global->network_data->thread_status = 1;
+    div_server_t *server = (div_server_t *)calloc(1, sizeof(div_server_t));
+    server->server = new NetDataClient(NetPort::ROOFUHF, SERVER_POLL_RATE);
+    server->server->socket = sv[1];
+    server->server->connection_ready = true;
+
+    pthread_t server_tid, loop_tid, tx_tid, rx_tids[DIV_RADIOS];
+    pthread_create(&server_tid, NULL, div_server_thread, server);
+    for (int i = 0; i < DIV_RADIOS; i++)
+    {
+        pthread_create(&rx_tids[i], NULL, gs_uhf_radio_rx_thread, &global->radios[i]);
+    }
+    pthread_create(&loop_tid, NULL, div_loop_thread, global);
+    pthread_create(&tx_tid, NULL, gs_uhf_tx_thread, global);
+    for (int i = 0; i < DIV_RADIOS; i++)
+    {
+        while (!__atomic_load_n(&global->radios[i].ready, __ATOMIC_ACQUIRE))
+        {
+            usleep(1000);
+        }
+    }
+
+    // Downlink: every frame on every radio's air, one at a time so no FIFO is overrun.
+    uint64_t duplicates_before = gs_metrics_counter(GS_COUNT_DIVERSITY_DUPLICATES);
+    uint64_t deadline = gs_time_ns() + DIV_TIMEOUT_S * NSEC_PER_SEC;
+    uint64_t heard = 0, lost = 0;
+    for (int i = 0; i < DIV_FRAMES && gs_time_ns() < deadline; i++)
+    {
+        gst_frame_t frame[1];
+        div_fill(frame, i);
+        for (int r = 0; r < DIV_RADIOS; r++)
+        {
+            gs_radio_sim_far_send(global->radios[r].radio, frame, sizeof(gst_frame_t));
+        }
+        for (int r = 0; r < DIV_RADIOS; r++)
+        {
+            gs_sim_stats_t sim[1];
+            gs_radio_sim_stats(global->radios[r].radio, sim);
+            while (sim->downlink_read + sim->downlink_lost < (uint64_t)i + 1 && gs_time_ns() < deadline)
+            {
+                usleep(10);
+                gs_radio_sim_stats(global->radios[r].radio, sim);
+            }
+        }
+    }
+    for (int r = 0; r < DIV_RADIOS; r++)
+    {
+        gs_sim_stats_t sim[1];
+        gs_radio_sim_stats(global->radios[r].radio, sim);
+        heard += sim->downlink_read;
+        lost += sim->downlink_lost;
+    }
+    // Everything read has been through the merge once the server's count stops moving.
+    int last = -1;
+    while (last != __atomic_load_n(&server->received, __ATOMIC_ACQUIRE) && gs_time_ns() < deadline)
+    {
+        last = __atomic_load_n(&server->received, __ATOMIC_ACQUIRE);
+        usleep(50000);
+    }
+    uint64_t dropped = gs_metrics_counter(GS_COUNT_DIVERSITY_DUPLICATES) - duplicates_before;
+
+    // Uplink: commands from the server, which should all leave on the loudest radio.
+    int on_loudest = 0, elsewhere = 0;
+    for (int i = 0; i < DIV_COMMANDS && gs_time_ns() < deadline; i++)
+    {
+        uint8_t payload[sizeof(cmd_input_t)] = {0};
+        payload[1] = (uint8_t)i;
+        NetFrame netframe(payload, sizeof(payload), NetType::DATA, NetVertex::ROOFUHF);
+        netframe.sendFrame(server->server);
+        gst_fec_frame_t air[1];
+        on_loudest += gs_radio_sim_far_recv(global->radios[DIV_LOUDEST].radio, air, sizeof(air), 200) == sizeof(gst_frame_t);
+        for (int r = 0; r < DIV_RADIOS; r++)
+        {
+            elsewhere += r != DIV_LOUDEST && gs_radio_sim_far_recv(global->radios[r].radio, air, sizeof(air), 0) > 0;
+        }
+    }
+
+    gs_reactor_stop(global->reactor);
+    pthread_join(loop_tid, NULL);
+    __atomic_store_n(&global->uhf_done, true, __ATOMIC_RELEASE);
+    __atomic_store_n(&global->network_data->thread_status, 0, __ATOMIC_RELEASE);
+    gs_tx_stop(global->uhf_tx_queue);
+    pthread_join(tx_tid, NULL);
+    for (int i = 0; i < DIV_RADIOS; i++)
+    {
+        pthread_join(rx_tids[i], NULL);
+    }
+    shutdown(sv[0], SHUT_RDWR);
+    pthread_join(server_tid, NULL);
+    gs_log_stop();
+
+    int missing = DIV_FRAMES - (server->received - server->repeated - server->bad);
+    double single = (double)lost / (DIV_RADIOS * DIV_FRAMES);
+    printf("diversity: %d radios each lost %.1f%% of %d frames; the server got %d (%d missing, %d twice, %d altered), %llu copies dropped.\n",
+           DIV_RADIOS, single * 100, DIV_FRAMES, server->received, missing, server->repeated, server->bad, (unsigned long long)dropped);
+    printf("diversity: %d/%d commands on the loudest radio, %d on others.\n", on_loudest, DIV_COMMANDS, elsewhere);
+
+    // Binomial: DIV_FRAMES * DIV_LOSS^DIV_RADIOS missing on average, 3.2 here; 1% is far outside chance.
+    if (server->repeated || server->bad || missing > DIV_FRAMES / 100 || heard != (uint64_t)server->received + dropped)
+    {
+        dbprintlf(FATAL "Frames forwarded twice, altered or lost (%llu heard, %d forwarded, %llu dropped).", (unsigned long long)heard,
+                  server->received, (unsigned long long)dropped);
+        ok = 0;
+    }
+    // Commands are lost on the air as often as frames, so only where they went is checked.
+    if (on_loudest == 0 || elsewhere)
+    {
+        dbprintlf(FATAL "Uplink not on the loudest radio.");
+        ok = 0;
+    }
+
+    close(sv[0]);
+    close(sv[1]);
+    delete server->server;
+    free(server);
+    delete global->network_data;
+    gs_reactor_destroy(global->reactor);
+    for (int i = 0; i < DIV_RADIOS; i++)
+    {
+        gs_radio_destroy(global->radios[i].radio);
+        gs_ring_destroy(global->radios[i].rx_ring);
+    }
+    gs_div_destroy(global->diversity);
+    gs_ring_destroy(global->uhf_rx_ring);
+    gs_tx_queue_destroy(global->uhf_tx_queue);
+    gs_sar_destroy(global->uhf_sar);
+    gs_pool_destroy(global->netframe_pool);
+    gs_pool_destroy(global->payload_pool);
+    pthread_mutex_destroy(&global->net_lock);
+    return ok ? 0 : 1;
+}
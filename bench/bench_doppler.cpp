@@ -0,0 +1,291 @@
+/**
+ * @file bench_doppler.cpp
+ * @author agent (agent@local)
+ * @brief Checks a pass's Doppler table against SGP4's range, and that retunes following it never land mid-frame.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * The table is built for the highest ISS pass over the station near Lowell, MA in the day after the element
+ * set's epoch (the same set and station as bench_pass), at 437 MHz both ways. Its entries are checked against
+ * the range rate differenced out of SGP4's range, which the table does not use, and against what a pass at
+ * that height should look like. Following the table with gs_doppler_due() must keep the correction within
+ * the tolerance throughout.
+ * 
+ * A simulated radio then follows the table through the middle of the pass, BENCH_SPEED times faster than
+ * real time, while the spacecraft beacons and a transmit side keeps uplinking bursts. Through
+ * gs_doppler_apply() no retune may land on a frame on the air; calling the backend directly, as a control,
+ * some do.
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "gs_doppler.hpp"
+#include "gs_pass.hpp"
+#include "gs_uhf.hpp"
+#include "gs_arbiter.hpp"
+#include "gs_radio.hpp"
+#include "gs_bench.hpp"
+#include "gs_time.hpp"
+#include "meb_debug.hpp"
+
+#define BENCH_FREQ_HZ 437e6
+#define BENCH_TOL_HZ 100
+#define BENCH_DIFF_S 0.05  // Half the step the range is differenced over.
+#define BENCH_SPEED 10     // Pass seconds per wall second, for the simulated radio.
+#define BENCH_WINDOW_S 30  // Pass time either side of the highest point followed on the simulated radio.
+#define BENCH_RATE 9600
+#define BENCH_BUILDS 20
+
+#define CHECK(cond)                                       \
+    do                                                    \
+    {                                                     \
+        if (!(cond))                                      \
+        {                                                 \
+            dbprintlf(RED_FG "Check failed: %s", #cond); \
+            failures++;                                   \
+        }                                                 \
+    } while (0)
+
+static const char *tle_iss[2] = {"1 25544U 98067A   08264.51782528 -.00002182  00000-0 -11606-4 0  2927",
+                                 "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.72125391563537"};
+
+/**
+ * @brief Builds the pass's table and checks it against the differenced range, then follows it.
+ * 
+ * @return int Failed checks.
+ */
+static int check_table(gs_doppler_t *dop, const gs_sgp4_t *sat, const gs_station_t *station, const gs_pass_t *pass)
+{
+    int failures = 0;
+    int count = gs_doppler_build(dop, sat, station, pass->aos, pass->los);
+    CHECK(count == (int)((pass->los - pass->aos) * 1000 / GS_DOPPLER_STEP_MS) + 1);
+    CHECK(dop->start == pass->aos);
+
+    // The same formula with the range rate from the range, so only the range rate is being checked.
+    int32_t worst = 0, highest = 0, rx_tca = 0;
+    for (int i = 0; i < count; i++)
+    {
+        double t = dop->start + i * (GS_DOPPLER_STEP_MS / 1e3);
+        gs_look_t before, after;
+        gs_sgp4_look(sat, station, t - BENCH_DIFF_S, &before);
+        gs_sgp4_look(sat, station, t + BENCH_DIFF_S, &after);
+        int32_t rx_hz, tx_hz;
+        gs_doppler_offsets(dop, (after.range - before.range) / (2 * BENCH_DIFF_S), &rx_hz, &tx_hz);
+        worst = abs(rx_hz - dop->rx_hz[i]) > worst ? abs(rx_hz - dop->rx_hz[i]) : worst;
+        worst = abs(tx_hz - dop->tx_hz[i]) > worst ? abs(tx_hz - dop->tx_hz[i]) : worst;
+        highest = abs(dop->rx_hz[i]) > highest ? abs(dop->rx_hz[i]) : highest;
+        if (fabs(t - pass->tca) < GS_DOPPLER_STEP_MS / 2e3)
+        {
+            rx_tca = dop->rx_hz[i];
+        }
+    }
+    printf("doppler: %d entries, %+d Hz at AOS, %+d Hz at the highest point, %+d Hz at LOS; within %d Hz of the differenced range.\n", count,
+           dop->rx_hz[0], rx_tca, dop->rx_hz[count - 1], worst);
+    CHECK(worst <= 2);
+    // Coming up the downlink is high and the uplink low, by up to ~23 ppm of 437 MHz for a LEO spacecraft.
+    CHECK(dop->rx_hz[0] > 5000 && dop->tx_hz[0] < -5000);
+    CHECK(dop->rx_hz[count - 1] < -5000 && dop->tx_hz[count - 1] > 5000);
+    CHECK(highest < 11000);
+    CHECK(abs(rx_tca) < 1000);
+    // Coming up the downlink's correction is the larger one, by the square of the speed over c.
+    CHECK(dop->rx_hz[0] >= -dop->tx_hz[0] && dop->rx_hz[0] + dop->tx_hz[0] <= 2);
+
+    int32_t rx_hz, tx_hz;
+    CHECK(gs_doppler_lookup(dop, pass->aos - 60, &rx_hz, &tx_hz) && rx_hz == dop->rx_hz[0]);
+    CHECK(!gs_doppler_lookup(dop, pass->los + 1, &rx_hz, &tx_hz));
+
+    // Retuned whenever due, the correction is never out by more than the tolerance.
+    int retunes = 0;
+    int32_t rx_on = 0, tx_on = 0;
+    double due = gs_doppler_due(dop, dop->start, rx_on, tx_on);
+    int32_t off = 0;
+    for (int i = 0; i < count; i++)
+    {
+        double t = dop->start + i * (GS_DOPPLER_STEP_MS / 1e3);
+        if (due != 0 && t >= due)
+        {
+            gs_doppler_lookup(dop, t, &rx_on, &tx_on);
+            due = gs_doppler_due(dop, t, rx_on, tx_on);
+            CHECK(due == 0 || due > t);
+            retunes++;
+        }
+        off = abs(dop->rx_hz[i] - rx_on) > off ? abs(dop->rx_hz[i] - rx_on) : off;
+        off = abs(dop->tx_hz[i] - tx_on) > off ? abs(dop->tx_hz[i] - tx_on) : off;
+    }
+    printf("doppler: followed with %d retunes over %.0f s, never more than %d Hz off.\n", retunes, pass->los - pass->aos, off);
+    CHECK(off <= BENCH_TOL_HZ);
+    // Roughly one per tolerance swept, both ways: never one per entry.
+    CHECK(retunes > 2 * (dop->rx_hz[0] - dop->rx_hz[count - 1]) / BENCH_TOL_HZ / 3 && retunes < count / 4);
+    return failures;
+}
+
+typedef struct
+{
+    gs_radio_t *radio;
+    bool done;
+    uint64_t bursts;
+} bench_tx_t;
+
+static void *bench_tx_side(void *args)
+{
+    bench_tx_t *tx = (bench_tx_t *)args;
+    gst_frame_t frame[1];
+    gs_uhf_frame_build(frame, "doppler", 7);
+    while (!__atomic_load_n(&tx->done, __ATOMIC_ACQUIRE))
+    {
+        gs_arbiter_tx_begin(tx->radio);
+        for (int i = 0; i < 3; i++)
+        {
+            gs_radio_write(tx->radio, frame, sizeof(gst_frame_t));
+        }
+        gs_arbiter_tx_end(tx->radio);
+        tx->bursts++;
+        usleep(150000);
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Follows the table on a simulated radio, which beacons and is uplinked on the while.
+ * 
+ * @param direct Retune straight through the backend, past the arbiter, as a control.
+ * @param late_ms Set to the most a retune was late, wall time.
+ * @return int Failed checks.
+ */
+static int check_sim(gs_doppler_t *dop, const gs_pass_t *pass, bool direct, double *late_ms)
+{
+    int failures = 0;
+    char options[64];
+    snprintf(options, sizeof(options), "rate=%d,beacon=4", BENCH_RATE);
+    gs_sim_config_t config[1];
+    gs_radio_sim_defaults(config);
+    gs_radio_sim_parse(config, options);
+    gs_radio_t *radio = gs_radio_sim_create(config);
+    CHECK(radio != nullptr && gs_radio_init(radio) == 1);
+    if (radio == nullptr)
+    {
+        return failures;
+    }
+
+    // Joined mid-pass on the right frequencies, so lateness is only what the traffic causes.
+    double from = pass->tca - BENCH_WINDOW_S;
+    int32_t rx_hz, tx_hz;
+    gs_doppler_lookup(dop, from, &rx_hz, &tx_hz);
+    CHECK(gs_radio_try_tune(radio, rx_hz, tx_hz) == 1);
+    memset(&dop->stats, 0x0, sizeof(dop->stats));
+    bench_tx_t tx[1] = {{radio, false, 0}};
+    pthread_t tid;
+    pthread_create(&tid, NULL, bench_tx_side, tx);
+    uint64_t start = gs_time_ns();
+    double t = from;
+    int results[4] = {0, 0, 0, 0};
+    while (t < pass->tca + BENCH_WINDOW_S)
+    {
+        double next;
+        if (direct)
+        {
+            gs_doppler_lookup(dop, t, &rx_hz, &tx_hz);
+            radio->ops->tune(radio, rx_hz, tx_hz);
+            next = t + GS_DOPPLER_RETRY_MS / 1e3;
+        }
+        else
+        {
+            results[-gs_doppler_apply(dop, radio, t, &next) + 1]++;
+            next = next != 0 ? next : t + 1;
+        }
+        double wait_s = (next - t) / BENCH_SPEED;
+        if (wait_s > 0)
+        {
+            usleep((useconds_t)(wait_s * 1e6));
+        }
+        t = from + (gs_time_ns() - start) / 1e9 * BENCH_SPEED;
+    }
+    __atomic_store_n(&tx->done, true, __ATOMIC_RELEASE);
+    pthread_join(tid, NULL);
+
+    gs_sim_stats_t sim[1];
+    gs_radio_sim_stats(radio, sim);
+    printf("doppler: %s, %llu retunes over %d s of the pass, %llu refused while a frame arrived, %llu landed mid-frame (%llu bursts, %llu beacons).\n",
+           direct ? "straight to the radio" : "through gs_doppler_apply()", (unsigned long long)sim->retunes, 2 * BENCH_WINDOW_S,
+           (unsigned long long)sim->retunes_busy, (unsigned long long)sim->retunes_mid_frame, (unsigned long long)tx->bursts,
+           (unsigned long long)sim->downlink_sent);
+    CHECK(sim->downlink_sent > 0 && tx->bursts > 0);
+    if (direct)
+    {
+        CHECK(sim->retunes_mid_frame > 0);
+    }
+    else
+    {
+        // Every retune the radio took past the first, and only those, was counted as applied.
+        CHECK(sim->retunes_mid_frame == 0);
+        CHECK(sim->retunes > 1 && sim->retunes == dop->stats.retunes + 1 && (int)dop->stats.retunes == results[0]);
+        CHECK(results[3] == 0);
+        CHECK(radio->rx_offset_hz != 0 || radio->tx_offset_hz != 0);
+        *late_ms = dop->stats.late_max_ns / 1e6 / BENCH_SPEED;
+        printf("doppler: %llu retunes put off, late by %.1f ms on average and %.1f ms at most (wall time).\n",
+               (unsigned long long)dop->stats.deferred, dop->stats.retunes ? dop->stats.late_sum_ns / 1e6 / BENCH_SPEED / dop->stats.retunes : 0.0,
+               *late_ms);
+        // Held off by a burst at most; one is three frames' air time and a little.
+        CHECK(*late_ms < 3 * sizeof(gst_fec_frame_t) * 8 * 1e3 / BENCH_RATE + 100);
+    }
+    gs_radio_destroy(radio);
+    return failures;
+}
+
+int main(void)
+{
+    int failures = 0;
+    gs_station_t station[1] = {{42.6526 * M_PI / 180, -71.3247 * M_PI / 180, 0.03, {0, 0, 0}}};
+    gs_sgp4_station(station);
+    gs_tle_t tle[1];
+    gs_sgp4_t sat[1];
+    gs_tle_parse(nullptr, tle_iss[0], tle_iss[1], tle);
+    gs_sgp4_init(sat, tle);
+
+    gs_pass_t passes[GS_PASS_MAX];
+    int count = gs_pass_find(sat, station, 0, tle->epoch, tle->epoch + 24 * 3600, passes, GS_PASS_MAX, nullptr);
+    CHECK(count > 0);
+    const gs_pass_t *pass = &passes[0];
+    for (int i = 1; i < count; i++)
+    {
+        pass = passes[i].max_el > pass->max_el ? &passes[i] : pass;
+    }
+    printf("doppler: the highest pass reaches %.1f deg, for %.0f s.\n", pass->max_el * 180 / M_PI, pass->los - pass->aos);
+
+    gs_doppler_t *dop = gs_doppler_create(BENCH_FREQ_HZ, BENCH_FREQ_HZ, BENCH_TOL_HZ);
+    CHECK(dop != nullptr);
+    if (dop == nullptr || count == 0)
+    {
+        return 1;
+    }
+    failures += check_table(dop, sat, station, pass);
+
+    double late_ms = 0;
+    failures += check_sim(dop, pass, false, &late_ms);
+    failures += check_sim(dop, pass, true, &late_ms);
+
+    uint64_t start = gs_time_ns();
+    for (int i = 0; i < BENCH_BUILDS; i++)
+    {
+        gs_doppler_build(dop, sat, station, pass->aos - 120, pass->los + 60);
+    }
+    double build_ms = (gs_time_ns() - start) / 1e6 / BENCH_BUILDS;
+    printf("doppler: a pass's table (%d entries) built in %.2f ms.\n", dop->count, build_ms);
+    gs_bench_report("doppler", "build_table", build_ms, "ms/pass", GS_BENCH_LOWER, 0);
+    gs_bench_report("doppler", "retune_late_max", late_ms, "ms", GS_BENCH_LOWER, 50);
+    gs_doppler_destroy(dop);
+
+    if (failures)
+    {
+        dbprintlf(FATAL "%d Doppler checks failed.", failures);
+        return 1;
+    }
+    return 0;
+}
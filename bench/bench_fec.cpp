@@ -0,0 +1,377 @@
+/**
+ * @file bench_fec.cpp
+ * @author agent (agent@local)
+ * @brief Checks the Reed-Solomon codec, times it, and sweeps frame loss against bit-error rate with and without parity.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gs_uhf.hpp"
+#include "gs_fec.hpp"
+#include "gs_radio.hpp"
+#include "gs_bench.hpp"
+#include "gs_time.hpp"
+#include "gs_log.hpp"
+#include "meb_debug.hpp"
+
+#define CHECK_TRIALS 20000
+#define BENCH_FRAMES 4096
+#define BENCH_ROUNDS 50
+#define SWEEP_FRAMES 2000
+
+#define CHECK(cond)                                       \
+    do                                                    \
+    {                                                     \
+        if (!(cond))                                      \
+        {                                                 \
+            dbprintlf(RED_FG "Check failed: %s", #cond); \
+            failures++;                                   \
+        }                                                 \
+    } while (0)
+
+static volatile int sink;
+
+/**
+ * @brief GF(2^8) multiply by shift-and-add, independent of the codec's tables.
+ */
+static uint8_t ref_mul(uint8_t a, uint8_t b)
+{
+    uint8_t p = 0;
+    while (b)
+    {
+        if (b & 0x1)
+        {
+            p ^= a;
+        }
+        a = (a << 1) ^ ((a & 0x80) ? 0x1d : 0);
+        b >>= 1;
+    }
+    return p;
+}
+
+/**
+ * @brief Parity by long division of data(x) * x^16 by the generator, the textbook way.
+ */
+static void ref_encode(const uint8_t *data, size_t len, uint8_t *parity)
+{
+    uint8_t gen[GS_FEC_PARITY + 1] = {1};
+    uint8_t root = 1;
+    for (int i = 0; i < GS_FEC_PARITY; i++)
+    {
+        for (int k = i + 1; k > 0; k--)
+        {
+            gen[k] = gen[k - 1] ^ ref_mul(gen[k], root);
+        }
+        gen[0] = ref_mul(gen[0], root);
+        root = ref_mul(root, 2);
+    }
+
+    uint8_t work[GS_FEC_MAX_BLOCK] = {0};
+    memcpy(work, data, len);
+    for (size_t i = 0; i < len; i++)
+    {
+        uint8_t coef = work[i];
+        for (int k = 0; k <= GS_FEC_PARITY && coef; k++)
+        {
+            work[i + k] ^= ref_mul(coef, gen[GS_FEC_PARITY - k]);
+        }
+    }
+    memcpy(parity, work + len, GS_FEC_PARITY);
+}
+
+/**
+ * @brief Corrupts count distinct bytes of block with non-zero error values.
+ */
+static void corrupt(uint8_t *block, size_t len, int count)
+{
+    bool hit[GS_FEC_MAX_BLOCK] = {false};
+    for (int e = 0; e < count; e++)
+    {
+        size_t pos;
+        do
+        {
+            pos = rand() % len;
+        } while (hit[pos]);
+        hit[pos] = true;
+        block[pos] ^= 1 + rand() % 255;
+    }
+}
+
+static int check_codec(void)
+{
+    int failures = 0;
+    int miscorrected = 0, detected = 0;
+    const size_t lens[] = {sizeof(gst_frame_t), 1, 20, GS_FEC_MAX_BLOCK - GS_FEC_PARITY};
+    srand(0x6f35);
+
+    for (int trial = 0; trial < CHECK_TRIALS; trial++)
+    {
+        size_t len = trial < 4 * (CHECK_TRIALS / 5) ? sizeof(gst_frame_t) : lens[trial % 4];
+        uint8_t block[GS_FEC_MAX_BLOCK], sent[GS_FEC_MAX_BLOCK], ref[GS_FEC_PARITY];
+        for (size_t i = 0; i < len; i++)
+        {
+            block[i] = rand();
+        }
+        gs_fec_encode(block, len, block + len);
+        ref_encode(block, len, ref);
+        CHECK(memcmp(block + len, ref, GS_FEC_PARITY) == 0);
+        memcpy(sent, block, len + GS_FEC_PARITY);
+
+        // Up to GS_FEC_T errors must always be repaired; beyond that the decoder must fail or land on
+        // another codeword, never hand back something that is neither.
+        int errors = trial % (GS_FEC_T + 5);
+        corrupt(block, len + GS_FEC_PARITY, errors);
+        int corrected = gs_fec_decode(block, len + GS_FEC_PARITY);
+        if (errors <= GS_FEC_T)
+        {
+            CHECK(corrected == errors && memcmp(block, sent, len + GS_FEC_PARITY) == 0);
+        }
+        else if (corrected < 0)
+        {
+            detected++;
+        }
+        else
+        {
+            miscorrected++;
+            CHECK(gs_fec_decode(block, len + GS_FEC_PARITY) == 0);
+        }
+    }
+
+    if (!failures)
+    {
+        printf("fec: %d blocks, every pattern of up to %d byte errors corrected; past that %d detected, %d miscorrected.\n",
+               CHECK_TRIALS, GS_FEC_T, detected, miscorrected);
+    }
+    return failures;
+}
+
+/**
+ * @brief Checks which framing gs_uhf_write() picks in each mode, and that AUTO follows the far end.
+ */
+static int check_negotiation(void)
+{
+    int failures = 0;
+    gs_sim_config_t config[1];
+    gs_radio_sim_defaults(config);
+    config->spacecraft = false;
+    config->bitrate = 0;
+    gs_radio_t *radio = gs_radio_sim_create(config);
+    CHECK(radio != nullptr && gs_radio_init(radio) == 1);
+    if (failures)
+    {
+        return failures;
+    }
+
+    bool done = false;
+    uint8_t payload[GST_MAX_PAYLOAD_SIZE] = {0x42};
+    uint8_t air[SIM_MAX_AIR_FRAME];
+    char buf[GST_MAX_PAYLOAD_SIZE];
+    int16_t rssi;
+
+    radio->fec = GS_FEC_OFF;
+    gs_uhf_write(radio, (char *)payload, sizeof(payload), &done);
+    CHECK(gs_radio_sim_far_recv(radio, air, sizeof(air), 1000) == sizeof(gst_frame_t));
+
+    radio->fec = GS_FEC_ON;
+    gs_uhf_write(radio, (char *)payload, sizeof(payload), &done);
+    CHECK(gs_radio_sim_far_recv(radio, air, sizeof(air), 1000) == sizeof(gst_fec_frame_t));
+
+    // AUTO starts legacy, switches once the far end is heard with parity and back when it stops.
+    radio->fec = GS_FEC_AUTO;
+    gs_uhf_write(radio, (char *)payload, sizeof(payload), &done);
+    CHECK(gs_radio_sim_far_recv(radio, air, sizeof(air), 1000) == sizeof(gst_frame_t));
+
+    gst_fec_frame_t fec[1];
+    gs_uhf_frame_build(&fec->frame, payload, sizeof(payload));
+    gs_fec_encode(&fec->frame, sizeof(gst_frame_t), fec->parity);
+    gs_radio_sim_far_send(radio, fec, sizeof(gst_fec_frame_t));
+    CHECK(gs_uhf_read(radio, buf, sizeof(buf), &rssi, &done) == sizeof(gst_fec_frame_t));
+    gs_uhf_write(radio, (char *)payload, sizeof(payload), &done);
+    CHECK(gs_radio_sim_far_recv(radio, air, sizeof(air), 1000) == sizeof(gst_fec_frame_t));
+
+    gs_radio_sim_far_send(radio, &fec->frame, sizeof(gst_frame_t));
+    CHECK(gs_uhf_read(radio, buf, sizeof(buf), &rssi, &done) == sizeof(gst_frame_t));
+    gs_uhf_write(radio, (char *)payload, sizeof(payload), &done);
+    CHECK(gs_radio_sim_far_recv(radio, air, sizeof(air), 1000) == sizeof(gst_frame_t));
+
+    gs_radio_destroy(radio);
+    if (!failures)
+    {
+        printf("fec: off, on and auto framing selection pass.\n");
+    }
+    return failures;
+}
+
+static void bench_codec(void)
+{
+    static gst_fec_frame_t frames[BENCH_FRAMES];
+    for (int i = 0; i < BENCH_FRAMES; i++)
+    {
+        for (int j = 0; j < GST_MAX_PAYLOAD_SIZE; j++)
+        {
+            frames[i].frame.payload[j] = rand();
+        }
+    }
+
+    uint64_t start = gs_time_ns();
+    for (int r = 0; r < BENCH_ROUNDS; r++)
+    {
+        for (int i = 0; i < BENCH_FRAMES; i++)
+        {
+            gs_fec_encode(&frames[i].frame, sizeof(gst_frame_t), frames[i].parity);
+        }
+    }
+    double encode_s = (gs_time_ns() - start) / 1e9;
+
+    printf("%-22s %12s %10s\n", "operation", "frames/s", "MB/s");
+    double n = (double)BENCH_FRAMES * BENCH_ROUNDS;
+    printf("%-22s %12.0f %10.1f\n", "encode", n / encode_s, n * sizeof(gst_frame_t) / encode_s / 1e6);
+    gs_bench_report("fec", "encode", n / encode_s, "frames/s", GS_BENCH_HIGHER, 0);
+
+    static gst_fec_frame_t work[BENCH_FRAMES];
+    const int error_counts[] = {0, 1, 4, GS_FEC_T};
+    for (int e = 0; e < 4; e++)
+    {
+        for (int i = 0; i < BENCH_FRAMES; i++)
+        {
+            work[i] = frames[i];
+            corrupt((uint8_t *)&work[i], sizeof(gst_fec_frame_t), error_counts[e]);
+        }
+        // Decoding repairs in place, so every round after the first would see clean frames; time one
+        // round per corrupted copy instead.
+        double decode_s = 0;
+        int rounds = error_counts[e] ? 5 : BENCH_ROUNDS;
+        for (int r = 0; r < rounds; r++)
+        {
+            static gst_fec_frame_t copy[BENCH_FRAMES];
+            memcpy(copy, work, sizeof(copy));
+            start = gs_time_ns();
+            for (int i = 0; i < BENCH_FRAMES; i++)
+            {
+                sink += gs_fec_decode((uint8_t *)&copy[i], sizeof(gst_fec_frame_t));
+            }
+            decode_s += (gs_time_ns() - start) / 1e9;
+        }
+        char name[32];
+        snprintf(name, sizeof(name), "decode, %d errors", error_counts[e]);
+        n = (double)BENCH_FRAMES * rounds;
+        printf("%-22s %12.0f %10.1f\n", name, n / decode_s, n * sizeof(gst_frame_t) / decode_s / 1e6);
+        snprintf(name, sizeof(name), "decode_%d_errors", error_counts[e]);
+        gs_bench_report("fec", name, n / decode_s, "frames/s", GS_BENCH_HIGHER, 0);
+    }
+}
+
+/**
+ * @brief Sends SWEEP_FRAMES downlink frames through the simulated channel and counts those gs_uhf_read() delivers intact.
+ */
+static int sweep_point(double ber, bool fec, int *delivered, int *corrupted)
+{
+    int failures = 0;
+    gs_sim_config_t config[1];
+    gs_radio_sim_defaults(config);
+    config->spacecraft = false;
+    config->bitrate = 0;
+    config->ber = ber;
+    gs_radio_t *radio = gs_radio_sim_create(config);
+    CHECK(radio != nullptr && gs_radio_init(radio) == 1);
+    if (failures)
+    {
+        return failures;
+    }
+
+    *delivered = *corrupted = 0;
+    bool done = false;
+    for (int i = 0; i < SWEEP_FRAMES; i++)
+    {
+        uint8_t payload[GST_MAX_PAYLOAD_SIZE];
+        for (int j = 0; j < GST_MAX_PAYLOAD_SIZE; j++)
+        {
+            payload[j] = rand();
+        }
+        gst_fec_frame_t out[1];
+        gs_uhf_frame_build(&out->frame, payload, sizeof(payload));
+        gs_fec_encode(&out->frame, sizeof(gst_frame_t), out->parity);
+        gs_radio_sim_far_send(radio, out, fec ? sizeof(gst_fec_frame_t) : sizeof(gst_frame_t));
+
+        char buf[GST_MAX_PAYLOAD_SIZE];
+        int16_t rssi;
+        if (gs_uhf_read(radio, buf, sizeof(buf), &rssi, &done) > 0)
+        {
+            if (memcmp(buf, payload, sizeof(payload)) == 0)
+            {
+                (*delivered)++;
+            }
+            else
+            {
+                // Passed the CRC but is wrong.
+                (*corrupted)++;
+            }
+        }
+    }
+
+    gs_radio_destroy(radio);
+    return failures;
+}
+
+static int sweep(void)
+{
+    int failures = 0;
+    const double bers[] = {1e-5, 1e-4, 5e-4, 1e-3, 2e-3, 5e-3, 1e-2, 2e-2};
+
+    printf("%-8s %10s %10s %12s %12s %8s\n", "BER", "CRC loss", "FEC loss", "CRC goodput", "FEC goodput", "gain");
+    for (size_t b = 0; b < sizeof(bers) / sizeof(bers[0]); b++)
+    {
+        int ok[2], bad[2];
+        failures += sweep_point(bers[b], false, &ok[0], &bad[0]);
+        failures += sweep_point(bers[b], true, &ok[1], &bad[1]);
+        if (failures)
+        {
+            break;
+        }
+        CHECK(bad[1] == 0);
+
+        // Payload bits delivered per bit on the air.
+        double good_crc = (double)ok[0] / SWEEP_FRAMES * GST_MAX_PAYLOAD_SIZE / sizeof(gst_frame_t);
+        double good_fec = (double)ok[1] / SWEEP_FRAMES * GST_MAX_PAYLOAD_SIZE / sizeof(gst_fec_frame_t);
+        char gain[16] = "-";
+        if (good_crc > 0)
+        {
+            snprintf(gain, sizeof(gain), "%.2fx", good_fec / good_crc);
+        }
+        printf("%-8g %9.1f%% %9.1f%% %12.3f %12.3f %8s\n", bers[b], 100.0 * (SWEEP_FRAMES - ok[0]) / SWEEP_FRAMES,
+               100.0 * (SWEEP_FRAMES - ok[1]) / SWEEP_FRAMES, good_crc, good_fec, gain);
+    }
+    return failures;
+}
+
+int main(void)
+{
+    int failures = check_codec();
+    if (failures)
+    {
+        dbprintlf(FATAL "%d FEC codec checks failed.", failures);
+        return 1;
+    }
+
+    // gs_uhf_read() and gs_uhf_write() log every bad frame; keep them out of the results.
+    gs_log_start("/dev/null");
+    failures = check_negotiation();
+    if (!failures)
+    {
+        bench_codec();
+        failures = sweep();
+    }
+    gs_log_stop();
+    if (failures)
+    {
+        dbprintlf(FATAL "%d FEC link checks failed.", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,359 @@
+/**
+ * @file bench_framing.cpp
+ * @author agent (agent@local)
+ * @brief Checks, then times, GST framing through a simulated radio, NetFrame round trips and the server RX dispatch.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * The per-frame work on either side of the radio, each path on its own:
+ *     - GST frames built and validated in memory, then written and read through a simulated radio whose far end
+ *       the benchmark plays (no air time, so what is timed is gs_uhf_write() and gs_uhf_read()).
+ *     - NetFrames constructed in the NetFrame pool, and sent and received over a socket pair.
+ *     - gs_network_rx() dispatching DATA frames from the server: single commands and multi-frame messages queued
+ *       for the TX thread (and taken off the queue again), and NACKs while the radio is down.
+ * Every frame is checked on the way through; fails on a mismatch.
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include "gs_uhf.hpp"
+#include "gs_tx.hpp"
+#include "gs_pool.hpp"
+#include "gs_radio.hpp"
+#include "gs_bench.hpp"
+#include "gs_time.hpp"
+#include "gs_log.hpp"
+#include "meb_debug.hpp"
+
+#define BENCH_FRAMES 4096     // In-memory frames per round.
+#define BENCH_ROUNDS 100
+#define BENCH_RADIO_FRAMES 5000 // Frames each way through the simulated radio.
+#define BENCH_NET_FRAMES 50000  // NetFrames per path.
+#define BENCH_MESSAGE_BYTES 200 // A multi-frame uplink.
+
+#define CHECK(cond)                                       \
+    do                                                    \
+    {                                                     \
+        if (!(cond))                                      \
+        {                                                 \
+            dbprintlf(RED_FG "Check failed: %s", #cond); \
+            failures++;                                   \
+        }                                                 \
+    } while (0)
+
+static volatile int sink;
+
+static void framing_fill(uint8_t *buf, size_t len, int seq)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        buf[i] = (uint8_t)(seq * 13 + i);
+    }
+}
+
+/**
+ * @brief Prints and reports one timed path.
+ */
+static void framing_report(const char *metric, uint64_t elapsed_ns, int frames, double tolerance)
+{
+    double ns = (double)elapsed_ns / frames;
+    printf("%-24s %14.0f %10.1f\n", metric, 1e9 / ns, ns);
+    gs_bench_report("framing", metric, ns, "ns/frame", GS_BENCH_LOWER, tolerance);
+}
+
+/**
+ * @brief gs_uhf_frame_build() and gs_uhf_validate() in memory.
+ */
+static int bench_gst(void)
+{
+    int failures = 0;
+    static gst_frame_t frames[BENCH_FRAMES];
+    static uint8_t payloads[BENCH_FRAMES][GST_MAX_PAYLOAD_SIZE];
+    for (int i = 0; i < BENCH_FRAMES; i++)
+    {
+        framing_fill(payloads[i], GST_MAX_PAYLOAD_SIZE, i);
+    }
+
+    uint64_t start = gs_time_ns();
+    for (int round = 0; round < BENCH_ROUNDS; round++)
+    {
+        for (int i = 0; i < BENCH_FRAMES; i++)
+        {
+            gs_uhf_frame_build(&frames[i], payloads[i], GST_MAX_PAYLOAD_SIZE);
+        }
+    }
+    uint64_t build_ns = gs_time_ns() - start;
+
+    int valid = 0;
+    start = gs_time_ns();
+    for (int round = 0; round < BENCH_ROUNDS; round++)
+    {
+        for (int i = 0; i < BENCH_FRAMES; i++)
+        {
+            valid += gs_uhf_validate(&frames[i]) == GST_SUCCESS;
+        }
+    }
+    uint64_t validate_ns = gs_time_ns() - start;
+    sink = valid;
+    CHECK(valid == BENCH_FRAMES * BENCH_ROUNDS);
+    CHECK(memcmp(frames[BENCH_FRAMES - 1].payload, payloads[BENCH_FRAMES - 1], GST_MAX_PAYLOAD_SIZE) == 0);
+
+    // Each kind of damage is caught.
+    gst_frame_t bad[1];
+    *bad = frames[0];
+    bad->payload[7] ^= 0x10;
+    CHECK(gs_uhf_validate(bad) == -GST_CRC_ERROR);
+    *bad = frames[0];
+    bad->crc1 ^= 1;
+    CHECK(gs_uhf_validate(bad) == -GST_CRC_MISMATCH);
+    *bad = frames[0];
+    bad->guid = 0x1234;
+    CHECK(gs_uhf_validate(bad) == -GST_GUID_ERROR);
+
+    framing_report("gst_build", build_ns, BENCH_FRAMES * BENCH_ROUNDS, 0);
+    framing_report("gst_validate", validate_ns, BENCH_FRAMES * BENCH_ROUNDS, 0);
+    return failures;
+}
+
+/**
+ * @brief gs_uhf_write() and gs_uhf_read() through a simulated radio with no air time.
+ */
+static int bench_radio(void)
+{
+    int failures = 0;
+    gs_sim_config_t config[1];
+    gs_radio_sim_defaults(config);
+    config->spacecraft = false;
+    config->bitrate = 0;
+    gs_radio_t *radio = gs_radio_sim_create(config);
+    CHECK(radio != nullptr && gs_uhf_init(radio) == 1);
+    if (failures)
+    {
+        return failures;
+    }
+
+    bool done = false;
+    uint8_t payload[GST_MAX_PAYLOAD_SIZE];
+    uint8_t air[SIM_MAX_AIR_FRAME];
+    gst_frame_t *frame = (gst_frame_t *)air;
+    int bad = 0;
+    uint64_t start = gs_time_ns();
+    for (int i = 0; i < BENCH_RADIO_FRAMES; i++)
+    {
+        framing_fill(payload, sizeof(payload), i);
+        if (gs_uhf_write(radio, (char *)payload, sizeof(payload), &done) <= 0 ||
+            gs_radio_sim_far_recv(radio, air, sizeof(air), 1000) != sizeof(gst_frame_t) ||
+            gs_uhf_validate(frame) != GST_SUCCESS || memcmp(frame->payload, payload, sizeof(payload)) != 0)
+        {
+            bad++;
+        }
+    }
+    uint64_t write_ns = gs_time_ns() - start;
+    CHECK(bad == 0);
+
+    char buf[GST_MAX_PAYLOAD_SIZE];
+    int16_t rssi;
+    bad = 0;
+    start = gs_time_ns();
+    for (int i = 0; i < BENCH_RADIO_FRAMES; i++)
+    {
+        framing_fill(payload, sizeof(payload), i);
+        gs_uhf_frame_build(frame, payload, sizeof(payload));
+        gs_radio_sim_far_send(radio, frame, sizeof(gst_frame_t));
+        if (gs_uhf_read(radio, buf, sizeof(buf), &rssi, &done) != sizeof(gst_frame_t) || memcmp(buf, payload, sizeof(payload)) != 0)
+        {
+            bad++;
+        }
+    }
+    uint64_t read_ns = gs_time_ns() - start;
+    CHECK(bad == 0);
+
+    // A short command goes out zero-padded; one longer than a frame is refused, never cut short.
+    uint8_t longer[GST_MAX_PAYLOAD_SIZE + 1];
+    memset(longer, 0x5a, sizeof(longer));
+    CHECK(gs_uhf_write(radio, (char *)longer, 5, &done) > 0 && gs_radio_sim_far_recv(radio, air, sizeof(air), 1000) == sizeof(gst_frame_t) &&
+          gs_uhf_validate(frame) == GST_SUCCESS && memcmp(frame->payload, longer, 5) == 0 && frame->payload[5] == 0);
+    CHECK(gs_uhf_write(radio, (char *)longer, sizeof(longer), &done) < 0);
+    CHECK(!gs_uhf_frame_build(frame, longer, sizeof(longer)));
+    gs_radio_destroy(radio);
+
+    // Both include handing the frame across the simulated air, a thread away.
+    framing_report("radio_write", write_ns, BENCH_RADIO_FRAMES, 50);
+    framing_report("radio_read", read_ns, BENCH_RADIO_FRAMES, 50);
+    return failures;
+}
+
+/**
+ * @brief NetFrames built in the pool, and sent and received over a socket pair.
+ */
+static int bench_netframe(NetDataClient *client, NetDataClient *server, gs_pool_t *netframe_pool)
+{
+    int failures = 0;
+    uint8_t payload[sizeof(cmd_output_t)], out[NETFRAME_MAX_PAYLOAD_SIZE];
+    framing_fill(payload, sizeof(payload), 1);
+
+    int bad = 0;
+    uint64_t start = gs_time_ns();
+    for (int i = 0; i < BENCH_NET_FRAMES; i++)
+    {
+        NetFrame *netframe = gs_pool_netframe(netframe_pool, payload, sizeof(payload), NetType::DATA, NetVertex::CLIENT);
+        if (netframe == nullptr || netframe->retrievePayload(out, sizeof(payload)) < 0)
+        {
+            bad++;
+        }
+        gs_pool_netframe_put(netframe_pool, netframe);
+    }
+    uint64_t build_ns = gs_time_ns() - start;
+    CHECK(bad == 0 && memcmp(out, payload, sizeof(payload)) == 0);
+
+    NetFrame *received = new NetFrame();
+    bad = 0;
+    start = gs_time_ns();
+    for (int i = 0; i < BENCH_NET_FRAMES; i++)
+    {
+        payload[0] = (uint8_t)i;
+        NetFrame *netframe = gs_pool_netframe(netframe_pool, payload, sizeof(payload), NetType::DATA, NetVertex::SERVER);
+        if (netframe == nullptr || netframe->sendFrame(client) <= 0 || received->recvFrame(server) < 0 ||
+            received->getType() != NetType::DATA || received->getPayloadSize() != sizeof(payload) ||
+            received->retrievePayload(out, sizeof(out)) < 0 || memcmp(out, payload, sizeof(payload)) != 0)
+        {
+            bad++;
+        }
+        gs_pool_netframe_put(netframe_pool, netframe);
+    }
+    uint64_t round_trip_ns = gs_time_ns() - start;
+    delete received;
+    CHECK(bad == 0);
+
+    framing_report("netframe_build", build_ns, BENCH_NET_FRAMES, 0);
+    framing_report("netframe_round_trip", round_trip_ns, BENCH_NET_FRAMES, 25);
+    return failures;
+}
+
+/**
+ * @brief gs_network_rx() on DATA frames: queued while the radio is up, NACKed while it is down.
+ */
+static int bench_dispatch(global_data_t *global, NetDataClient *server)
+{
+    int failures = 0;
+    uint8_t command[sizeof(cmd_input_t)], message[BENCH_MESSAGE_BYTES];
+    framing_fill(command, sizeof(command), 2);
+    framing_fill(message, sizeof(message), 3);
+    NetFrame *single = new NetFrame(command, sizeof(command), NetType::DATA, NetVertex::ROOFUHF);
+    NetFrame *multi = new NetFrame(message, sizeof(message), NetType::DATA, NetVertex::ROOFUHF);
+    gs_tx_item_t item[1];
+
+    __atomic_store_n(&global->uhf_ready, true, __ATOMIC_RELEASE);
+    int bad = 0;
+    uint64_t start = gs_time_ns();
+    for (int i = 0; i < BENCH_NET_FRAMES; i++)
+    {
+        // The TX thread's side, so the queue never fills.
+        gs_network_rx(global, single, gs_time_ns());
+        if (gs_tx_next(global->uhf_tx_queue, item, 0) != GS_TX_SEND || item->frame == nullptr ||
+            gs_uhf_validate(&item->frame->frame) != GST_SUCCESS || memcmp(item->frame->frame.payload, command, sizeof(command)) != 0)
+        {
+            bad++;
+        }
+        gs_pool_put(global->payload_pool, item->frame);
+        gs_pool_put(global->payload_pool, item->message);
+    }
+    uint64_t single_ns = gs_time_ns() - start;
+    CHECK(bad == 0);
+
+    bad = 0;
+    start = gs_time_ns();
+    for (int i = 0; i < BENCH_NET_FRAMES; i++)
+    {
+        gs_network_rx(global, multi, gs_time_ns());
+        if (gs_tx_next(global->uhf_tx_queue, item, 0) != GS_TX_SEND || item->message == nullptr ||
+            item->len != sizeof(message) || memcmp(item->message, message, sizeof(message)) != 0)
+        {
+            bad++;
+        }
+        gs_pool_put(global->payload_pool, item->frame);
+        gs_pool_put(global->payload_pool, item->message);
+    }
+    uint64_t multi_ns = gs_time_ns() - start;
+    CHECK(bad == 0);
+
+    __atomic_store_n(&global->uhf_ready, false, __ATOMIC_RELEASE);
+    NetFrame *nack = new NetFrame();
+    cs_ack_t code[1];
+    bad = 0;
+    start = gs_time_ns();
+    for (int i = 0; i < BENCH_NET_FRAMES; i++)
+    {
+        gs_network_rx(global, single, gs_time_ns());
+        if (nack->recvFrame(server) < 0 || nack->getType() != NetType::NACK || nack->retrievePayload((unsigned char *)code, sizeof(code)) < 0 ||
+            code->code != NACK_NO_UHF)
+        {
+            bad++;
+        }
+    }
+    uint64_t nack_ns = gs_time_ns() - start;
+    CHECK(bad == 0);
+    delete nack;
+    delete single;
+    delete multi;
+
+    framing_report("dispatch_command", single_ns, BENCH_NET_FRAMES, 25);
+    framing_report("dispatch_message", multi_ns, BENCH_NET_FRAMES, 25);
+    framing_report("dispatch_nack", nack_ns, BENCH_NET_FRAMES, 25);
+    return failures;
+}
+
+int main(void)
+{
+    // gs_uhf_validate() logs every bad frame, and gs_network_rx() every NetFrame.
+    gs_log_start("/dev/null");
+
+    global_data_t global[1];
+    memset(global, 0x0, sizeof(global_data_t));
+    global->uhf_tx_queue = gs_tx_queue_create(UHF_TX_QUEUE_SIZE);
+    global->netframe_pool = gs_pool_create("NetFrame", sizeof(NetFrame), NETFRAME_POOL_SIZE);
+    global->payload_pool = gs_pool_create("Payload", NETFRAME_MAX_PAYLOAD_SIZE, PAYLOAD_POOL_SIZE);
+    pthread_mutex_init(&global->net_lock, NULL);
+    int sv[2];
+    if (global->uhf_tx_queue == nullptr || global->netframe_pool == nullptr || global->payload_pool == nullptr ||
+        socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0)
+    {
+        dbprintlf(FATAL "Failed to set up the ground station.");
+        return 1;
+    }
+    global->network_data = new NetDataClient(NetPort::ROOFUHF, SERVER_POLL_RATE);
+    global->network_data->socket = sv[0];
+    global->network_data->connection_ready = true;
+    NetDataClient *server = new NetDataClient(NetPort::ROOFUHF, SERVER_POLL_RATE);
+    server->socket = sv[1];
+    server->connection_ready = true;
+
+    printf("%-24s %14s %10s\n", "path", "frames/s", "ns/frame");
+    int failures = bench_gst();
+    failures += bench_radio();
+    failures += bench_netframe(global->network_data, server, global->netframe_pool);
+    failures += bench_dispatch(global, server);
+
+    close(sv[0]);
+    close(sv[1]);
+    delete global->network_data;
+    delete server;
+    gs_tx_queue_destroy(global->uhf_tx_queue);
+    gs_pool_destroy(global->netframe_pool);
+    gs_pool_destroy(global->payload_pool);
+    pthread_mutex_destroy(&global->net_lock);
+    gs_log_stop();
+    if (failures)
+    {
+        dbprintlf(FATAL "%d framing checks failed.", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,437 @@
+/**
+ * @file bench_health.cpp
+ * @author agent (agent@local)
+ * @brief Checks the radio health monitor, times the per-frame readiness check it replaces, then crashes a radio under the event loop.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * The simulated radio's part info query is given BENCH_SPI_US of latency, about what the si446x's PART_INFO
+ * command and CTS polling take over SPI; the RX and TX paths used to pay it on every frame.
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include "gs_uhf.hpp"
+#include "gs_health.hpp"
+#include "gs_reactor.hpp"
+#include "gs_ring.hpp"
+#include "gs_tx.hpp"
+#include "gs_sar.hpp"
+#include "gs_radio.hpp"
+#include "gs_bench.hpp"
+#include "gs_time.hpp"
+#include "gs_log.hpp"
+#include "meb_debug.hpp"
+
+#define BENCH_SPI_US "60"
+#define BENCH_CHECKS 20000
+#define BENCH_CYCLES 5000 // Down and up again, under the seqlock reader.
+#define BENCH_FRAMES 1000
+#define BENCH_RATE_HZ 1000
+#define BENCH_HEALTH_MS 100
+#define BENCH_MAGIC 0x6865616c
+#define BENCH_TIMEOUT_S 10
+
+#define CHECK(cond)                                       \
+    do                                                    \
+    {                                                     \
+        if (!(cond))                                      \
+        {                                                 \
+            dbprintlf(RED_FG "Check failed: %s", #cond); \
+            failures++;                                   \
+        }                                                 \
+    } while (0)
+
+static gs_radio_t *bench_radio(const char *options)
+{
+    gs_sim_config_t config[1];
+    gs_radio_sim_defaults(config);
+    gs_radio_sim_parse(config, options);
+    return gs_radio_sim_create(config);
+}
+
+/**
+ * @brief Keeps the lines a crashed and re-initialized radio logs off the terminal while fn runs.
+ */
+static void bench_quiet(void (*fn)(void *), void *arg)
+{
+    fflush(stderr);
+    int saved = dup(STDERR_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDERR_FILENO);
+    fn(arg);
+    fflush(stderr);
+    dup2(saved, STDERR_FILENO);
+    close(null);
+    close(saved);
+}
+
+/**
+ * @brief Walks one radio through init, a healthy probe, a crash and a re-init.
+ * 
+ * @return int Failed checks.
+ */
+static int check_states(void)
+{
+    int failures = 0;
+    gs_radio_t *radio = bench_radio("external,rate=0");
+    gs_health_t *health = &radio->health;
+    gs_health_snapshot_t snap[1];
+
+    // Never initialized: not ready, but not lost either, so gs_uhf_recv() still waits on it.
+    CHECK(!gs_health_ready(health) && !gs_health_lost(health));
+    CHECK(gs_health_probe(radio) == 1);
+    gs_health_get(health, snap);
+    CHECK(snap->probes == 0);
+
+    CHECK(gs_uhf_init(radio) == 1);
+    gs_health_get(health, snap);
+    CHECK(snap->ready && RADIO_PART_VALID(snap->part) && snap->failures == 0 && snap->reinits == 0 && snap->probe_ns != 0);
+    CHECK(gs_health_probe(radio) == 1);
+    gs_health_get(health, snap);
+    CHECK(snap->ready && snap->probes == 1);
+
+    gs_radio_sim_crash(radio);
+    CHECK(gs_health_probe(radio) == 0);
+    gs_health_get(health, snap);
+    CHECK(!snap->ready && !gs_health_ready(health) && gs_health_lost(health) && snap->failures == 1 && snap->part == 0);
+
+    // Down radios are left to their owner, not probed.
+    CHECK(gs_health_probe(radio) == 1);
+    gs_health_get(health, snap);
+    CHECK(snap->probes == 2);
+
+    CHECK(gs_uhf_init(radio) == 1);
+    gs_health_get(health, snap);
+    CHECK(snap->ready && !gs_health_lost(health) && snap->reinits == 1 && snap->failures == 1);
+    CHECK(gs_health_probe(radio) == 1);
+
+    gs_radio_destroy(radio);
+    return failures;
+}
+
+typedef struct
+{
+    gs_radio_t *radio;
+    bool done;
+    uint64_t reads;
+    uint64_t torn;
+} bench_reader_t;
+
+/**
+ * @brief Reads snapshots while bench_cycle() runs, and checks each against the cycle's invariants.
+ * 
+ * The cycle is crash, failed probe, init, healthy probe; so the probes are twice the failures, less one until
+ * the healthy probe, and the radio is ready exactly when it has come back as often as it went down.
+ */
+static void *bench_reader_thread(void *args)
+{
+    bench_reader_t *reader = (bench_reader_t *)args;
+    gs_health_snapshot_t snap[1];
+    while (!__atomic_load_n(&reader->done, __ATOMIC_ACQUIRE))
+    {
+        gs_health_get(&reader->radio->health, snap);
+        int64_t extra = (int64_t)snap->probes - 2 * (int64_t)snap->failures;
+        bool ok = snap->ready == (snap->reinits == snap->failures) && (extra == -1 || (extra == 0 && snap->ready)) &&
+                  snap->ready == RADIO_PART_VALID(snap->part);
+        reader->torn += !ok;
+        reader->reads++;
+    }
+    return nullptr;
+}
+
+static void bench_cycle(void *arg)
+{
+    gs_radio_t *radio = (gs_radio_t *)arg;
+    for (int i = 0; i < BENCH_CYCLES; i++)
+    {
+        gs_radio_sim_crash(radio);
+        gs_health_probe(radio);
+        gs_uhf_init(radio);
+        gs_health_probe(radio);
+    }
+}
+
+/**
+ * @brief Crashes and re-initializes a radio as fast as it goes while another thread reads its health.
+ * 
+ * @return int Failed checks.
+ */
+static int check_seqlock(void)
+{
+    gs_radio_t *radio = bench_radio("external,rate=0");
+    gs_uhf_init(radio);
+    bench_reader_t reader = {radio, false, 0, 0};
+    pthread_t tid;
+    pthread_create(&tid, NULL, bench_reader_thread, &reader);
+    bench_quiet(bench_cycle, radio);
+    __atomic_store_n(&reader.done, true, __ATOMIC_RELEASE);
+    pthread_join(tid, NULL);
+
+    gs_health_snapshot_t snap[1];
+    gs_health_get(&radio->health, snap);
+    printf("health: %d crash and re-init cycles, %llu snapshots read alongside, %llu inconsistent.\n", BENCH_CYCLES,
+           (unsigned long long)reader.reads, (unsigned long long)reader.torn);
+    gs_radio_destroy(radio);
+    return reader.torn != 0 || snap->reinits != BENCH_CYCLES || snap->failures != BENCH_CYCLES;
+}
+
+/**
+ * @brief Times the readiness check each frame used to make against the one it makes now.
+ */
+static void bench_checks(void)
+{
+    const char *options[] = {"external,rate=0", "external,rate=0,spi=" BENCH_SPI_US};
+    const char *names[] = {"get_info, no SPI delay:", "get_info, " BENCH_SPI_US " us SPI:"};
+    double old_ns = 0;
+    for (int c = 0; c < 2; c++)
+    {
+        gs_radio_t *radio = bench_radio(options[c]);
+        gs_uhf_init(radio);
+        int checks = c == 0 ? BENCH_CHECKS * 10 : BENCH_CHECKS;
+        int valid = 0;
+        uint64_t start = gs_time_ns();
+        for (int i = 0; i < checks; i++)
+        {
+            gs_radio_info_t info[1];
+            info->part = 0;
+            valid += gs_radio_get_info(radio, info) && RADIO_PART_VALID(info->part);
+        }
+        old_ns = (double)(gs_time_ns() - start) / checks;
+        printf("health: %-28s %9.1f ns/frame (%d/%d valid).\n", names[c], old_ns, valid, checks);
+        gs_radio_destroy(radio);
+    }
+
+    gs_radio_t *radio = bench_radio("external,rate=0,spi=" BENCH_SPI_US);
+    gs_uhf_init(radio);
+    int checks = BENCH_CHECKS * 1000;
+    volatile int ready = 0;
+    uint64_t start = gs_time_ns();
+    for (int i = 0; i < checks; i++)
+    {
+        ready += gs_health_ready(&radio->health);
+    }
+    double new_ns = (double)(gs_time_ns() - start) / checks;
+    gs_health_snapshot_t snap[1];
+    start = gs_time_ns();
+    for (int i = 0; i < checks; i++)
+    {
+        gs_health_get(&radio->health, snap);
+    }
+    double snap_ns = (double)(gs_time_ns() - start) / checks;
+    printf("health: %-28s %9.2f ns/frame, gs_health_get() %.2f ns; %.1f us saved per frame.\n", "gs_health_ready():", new_ns,
+           snap_ns, (old_ns - new_ns) / 1e3);
+    gs_bench_report("health", "ready", new_ns, "ns/frame", GS_BENCH_LOWER, 0);
+    gs_bench_report("health", "get", snap_ns, "ns", GS_BENCH_LOWER, 0);
+    gs_radio_destroy(radio);
+}
+
+typedef struct
+{
+    NetDataClient *server;
+    int received;
+} bench_server_t;
+
+static void *bench_server_thread(void *args)
+{
+    bench_server_t *server = (bench_server_t *)args;
+    NetFrame *netframe = new NetFrame();
+    unsigned char payload[NETFRAME_MAX_PAYLOAD_SIZE];
+
+    while (netframe->recvFrame(server->server) >= 0)
+    {
+        int size = netframe->getPayloadSize();
+        if (netframe->getType() == NetType::DATA && size >= (int)sizeof(uint32_t) && netframe->retrievePayload(payload, size) >= 0 &&
+            *(uint32_t *)payload == BENCH_MAGIC)
+        {
+            __atomic_fetch_add(&server->received, 1, __ATOMIC_RELEASE);
+        }
+    }
+    delete netframe;
+    return nullptr;
+}
+
+typedef struct
+{
+    global_data_t *global;
+    bool rx_thread;
+} bench_loop_t;
+
+static void *bench_loop_thread(void *args)
+{
+    bench_loop_t *loop = (bench_loop_t *)args;
+    gs_uhf_event_loop(loop->global, loop->rx_thread);
+    return nullptr;
+}
+
+/**
+ * @brief Sends count frames from the far end at BENCH_RATE_HZ, then waits for the server to get every one the radio took.
+ * 
+ * @return int 1 if it did.
+ */
+static int bench_send(global_data_t *global, bench_server_t *server, int count)
+{
+    gs_sim_stats_t sim[1];
+    gs_radio_sim_stats(global->radio, sim);
+    int expected = server->received - (int)sim->downlink_read;
+    uint64_t period = NSEC_PER_SEC / BENCH_RATE_HZ;
+    uint64_t next = gs_time_ns();
+    for (int i = 0; i < count; i++)
+    {
+        struct timespec ts = {(time_t)(next / NSEC_PER_SEC), (long)(next % NSEC_PER_SEC)};
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        uint32_t data[2] = {BENCH_MAGIC, (uint32_t)i};
+        gst_frame_t frame[1];
+        gs_uhf_frame_build(frame, data, sizeof(data));
+        gs_radio_sim_far_send(global->radio, frame, sizeof(gst_frame_t));
+        next += period;
+    }
+    usleep(50000);
+    uint64_t deadline = gs_time_ns() + BENCH_TIMEOUT_S * NSEC_PER_SEC;
+    do
+    {
+        usleep(1000);
+        gs_radio_sim_stats(global->radio, sim);
+    } while (__atomic_load_n(&server->received, __ATOMIC_ACQUIRE) < expected + (int)sim->downlink_read && gs_time_ns() < deadline);
+    return __atomic_load_n(&server->received, __ATOMIC_ACQUIRE) == expected + (int)sim->downlink_read;
+}
+
+/**
+ * @brief Downlinks frames through the event loop, counting the part info queries they cost, then crashes the
+ * radio and times how long it is out of use.
+ * 
+ * @return int 1 if every frame taken off the radio reached the server and the radio came back.
+ */
+static int bench_run(bool rx_thread)
+{
+    global_data_t global[1];
+    memset(global, 0x0, sizeof(global_data_t));
+    global->radio = bench_radio("external,rate=0,spi=" BENCH_SPI_US);
+    global->uhf_rx_ring = gs_ring_create(UHF_RX_RING_SIZE);
+    global->uhf_tx_queue = gs_tx_queue_create(UHF_TX_QUEUE_SIZE);
+    global->uhf_sar = gs_sar_create(UHF_SAR_MAX_MESSAGE);
+    global->netframe_pool = gs_pool_create("NetFrame", sizeof(NetFrame), NETFRAME_POOL_SIZE);
+    global->payload_pool = gs_pool_create("Payload", NETFRAME_MAX_PAYLOAD_SIZE, PAYLOAD_POOL_SIZE);
+    global->reactor = gs_reactor_create();
+    global->health_ms = BENCH_HEALTH_MS;
+    pthread_mutex_init(&global->net_lock, NULL);
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0)
+    {
+        erprintlf(errno);
+        return 0;
+    }
+    global->network_data = new NetDataClient(NetPort::ROOFUHF, SERVER_POLL_RATE);
+    global->network_data->socket = sv[0];
+    global->network_data->connection_ready = true;
+    global->network_data->thread_status = 1;
+    bench_server_t server = {new NetDataClient(NetPort::ROOFUHF, SERVER_POLL_RATE), 0};
+    server.server->socket = sv[1];
+    server.server->connection_ready = true;
+
+    pthread_t loop_tid, rx_tid, server_tid;
+    pthread_create(&server_tid, NULL, bench_server_thread, &server);
+    bench_loop_t loop = {global, rx_thread};
+    pthread_create(&loop_tid, NULL, bench_loop_thread, &loop);
+    if (rx_thread)
+    {
+        pthread_create(&rx_tid, NULL, gs_uhf_rx_thread, global);
+    }
+    while (!__atomic_load_n(&global->uhf_ready, __ATOMIC_ACQUIRE))
+    {
+        usleep(1000);
+    }
+
+    gs_sim_stats_t before[1], after[1];
+    gs_radio_sim_stats(global->radio, before);
+    uint64_t start = gs_time_ns();
+    int ok = bench_send(global, &server, BENCH_FRAMES);
+    double elapsed = (gs_time_ns() - start) / 1e9;
+    gs_radio_sim_stats(global->radio, after);
+    uint64_t frames = after->downlink_read - before->downlink_read;
+    uint64_t queries = after->info_calls - before->info_calls;
+
+    // Down until a probe notices and the owner brings it back.
+    gs_radio_sim_crash(global->radio);
+    uint64_t crash_ns = gs_time_ns();
+    uint64_t deadline = crash_ns + BENCH_TIMEOUT_S * NSEC_PER_SEC;
+    gs_health_snapshot_t snap[1];
+    uint64_t down_ns = 0;
+    do
+    {
+        usleep(1000);
+        gs_health_get(&global->radio->health, snap);
+        if (down_ns == 0 && !snap->ready)
+        {
+            down_ns = gs_time_ns();
+        }
+    } while ((snap->reinits < 1 || !__atomic_load_n(&global->uhf_ready, __ATOMIC_ACQUIRE)) && gs_time_ns() < deadline);
+    uint64_t up_ns = gs_time_ns();
+    bool recovered = snap->reinits == 1 && snap->ready;
+    ok = ok && recovered && bench_send(global, &server, BENCH_FRAMES / 5);
+
+    printf("health: %-26s %llu frames in %.2f s, %llu part info queries (%.3f per frame, %.1f per second), crash noticed after %.0f ms, back up %.0f ms later%s.\n",
+           rx_thread ? "RX thread + ring + loop:" : "inline loop:", (unsigned long long)frames, elapsed, (unsigned long long)queries,
+           frames ? (double)queries / frames : 0.0, queries / elapsed, down_ns ? (down_ns - crash_ns) / 1e6 : 0.0,
+           down_ns ? (up_ns - down_ns) / 1e6 : 0.0, recovered ? "" : " (did not recover)");
+    gs_bench_report("health", rx_thread ? "rx_thread_queries" : "inline_queries", frames ? (double)queries / frames : 0.0, "queries/frame", GS_BENCH_LOWER, 25);
+
+    gs_reactor_stop(global->reactor);
+    pthread_join(loop_tid, NULL);
+    __atomic_store_n(&global->uhf_done, true, __ATOMIC_RELEASE);
+    __atomic_store_n(&global->network_data->thread_status, 0, __ATOMIC_RELEASE);
+    if (rx_thread)
+    {
+        pthread_join(rx_tid, NULL);
+    }
+    shutdown(sv[0], SHUT_RDWR);
+    pthread_join(server_tid, NULL);
+
+    close(sv[0]);
+    close(sv[1]);
+    delete server.server;
+    delete global->network_data;
+    gs_reactor_destroy(global->reactor);
+    pthread_mutex_destroy(&global->net_lock);
+    gs_radio_destroy(global->radio);
+    gs_ring_destroy(global->uhf_rx_ring);
+    gs_tx_queue_destroy(global->uhf_tx_queue);
+    gs_sar_destroy(global->uhf_sar);
+    gs_pool_destroy(global->netframe_pool);
+    gs_pool_destroy(global->payload_pool);
+    // Less than one query per frame, or the hot path is still asking the radio.
+    return ok && queries < frames / 10;
+}
+
+int main(void)
+{
+    int failures = check_states() + check_seqlock();
+    if (failures)
+    {
+        dbprintlf(FATAL "%d radio health checks failed.", failures);
+        return 1;
+    }
+    bench_checks();
+
+    // Per-frame debug lines would dominate the run.
+    gs_log_start("/dev/null");
+    int inline_ok = bench_run(false);
+    int threaded_ok = bench_run(true);
+    gs_log_stop();
+    if (!inline_ok || !threaded_ok)
+    {
+        dbprintlf(FATAL "The radio did not come back, or the downlink still queries it per frame.");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,231 @@
+/**
+ * @file bench_log.cpp
+ * @author agent (agent@local)
+ * @brief Floods the per-frame log lines through dbprintlf() and logprintlf(), and checks the binary log round-trips.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "gs_uhf.hpp"
+#include "gs_log.hpp"
+#include "gs_bench.hpp"
+#include "gs_time.hpp"
+#include "meb_debug.hpp"
+
+#define FLOOD_FRAMES 100000
+#define CHECK_FRAMES 1000
+#define PACED_FRAMES 20000
+#define PACED_RATE 50000 // Frames per second, far beyond what the radio can deliver.
+#define LOG_TEXT_PATH "/tmp/bench_log.txt"
+#define LOG_BIN_PATH "/tmp/bench_log.bin"
+
+/**
+ * @brief The lines the RX and network paths log for every frame, through dbprintlf().
+ * 
+ */
+static void frame_dbprintlf(int seq)
+{
+    dbprintlf(BLUE_BG "Received from UHF.");
+    dbprintlf(BLUE_FG "UHF receive payload has a cmd_output_t.mod value of: %d", seq & 0xff);
+    dbprintlf("Received NetFrame: type 0x%x, origin 0x%x, destination 0x%x, %d bytes, netstat 0x%02x.", 0x1e, 0x0b, 0x0a, 56, 0xc0);
+    dbprintlf(BLUE_FG "Transmitted with value: %d (note: this is not the number of bytes sent).", seq);
+}
+
+/**
+ * @brief The same lines through logprintlf().
+ * 
+ */
+static void frame_logprintlf(int seq)
+{
+    logprintlf(GS_LOG_DEBUG, BLUE_BG "Received from UHF.");
+    logprintlf(GS_LOG_DEBUG, BLUE_FG "UHF receive payload has a cmd_output_t.mod value of: %d", seq & 0xff);
+    logprintlf(GS_LOG_DEBUG, "Received NetFrame: type 0x%x, origin 0x%x, destination 0x%x, %d bytes, netstat 0x%02x.", 0x1e, 0x0b, 0x0a, 56, 0xc0);
+    logprintlf(GS_LOG_DEBUG, BLUE_FG "Transmitted with value: %d (note: this is not the number of bytes sent).", seq);
+}
+
+/**
+ * @brief Points stderr at a file, returns the old stderr.
+ * 
+ */
+static int redirect_stderr(const char *path)
+{
+    fflush(stderr);
+    int saved = dup(STDERR_FILENO);
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    dup2(fd, STDERR_FILENO);
+    close(fd);
+    return saved;
+}
+
+static void restore_stderr(int saved)
+{
+    fflush(stderr);
+    dup2(saved, STDERR_FILENO);
+    close(saved);
+}
+
+/**
+ * @brief Runs the flood, returns caller-side ns per frame; *total_ns includes draining the logger.
+ * A non-zero rate paces the frames, frames per second.
+ * 
+ */
+static double flood(void (*frame)(int), int frames, double *total_ns, int rate = 0)
+{
+    uint64_t start = gs_time_ns();
+    uint64_t caller = 0;
+    for (int i = 0; i < frames; i++)
+    {
+        if (rate)
+        {
+            uint64_t due = start + (uint64_t)i * NSEC_PER_SEC / rate;
+            while (gs_time_ns() < due)
+            {
+            }
+        }
+        uint64_t t0 = gs_time_ns();
+        frame(i);
+        caller += gs_time_ns() - t0;
+    }
+    gs_log_flush();
+    *total_ns = rate ? 0 : (double)(gs_time_ns() - start) / frames;
+    return (double)caller / frames;
+}
+
+/**
+ * @brief Logs CHECK_FRAMES frames to a binary log at a pace the writer keeps up with, decodes it and
+ * compares it with what dbprintlf() printed.
+ * 
+ * @return int 1 if every line matches.
+ */
+static int check_round_trip(void)
+{
+    if (!gs_log_start(LOG_BIN_PATH))
+    {
+        return 0;
+    }
+    for (int i = 0; i < CHECK_FRAMES; i++)
+    {
+        frame_logprintlf(i);
+        if (i % 64 == 63)
+        {
+            gs_log_flush();
+        }
+    }
+    gs_log_stop();
+
+    int saved = redirect_stderr(LOG_TEXT_PATH);
+    for (int i = 0; i < CHECK_FRAMES; i++)
+    {
+        frame_dbprintlf(i);
+    }
+    restore_stderr(saved);
+
+    FILE *bin = fopen(LOG_BIN_PATH, "rb");
+    FILE *decoded = tmpfile();
+    FILE *text = fopen(LOG_TEXT_PATH, "r");
+    if (bin == nullptr || decoded == nullptr || text == nullptr)
+    {
+        return 0;
+    }
+    int records = gs_log_decode(bin, decoded, false);
+    rewind(decoded);
+
+    int mismatches = 0;
+    char a[512], b[512];
+    while (fgets(b, sizeof(b), text) != nullptr)
+    {
+        if (fgets(a, sizeof(a), decoded) == nullptr)
+        {
+            mismatches++;
+            break;
+        }
+        // Decoded lines carry a timestamp, thread and level before the dbprintlf() text; messages differ only
+        // in the call site line and function.
+        const char *msg_a = strstr(a, "] "), *msg_b = strstr(b, "] ");
+        if (msg_a == nullptr || msg_b == nullptr || strcmp(msg_a, msg_b) != 0)
+        {
+            if (mismatches++ < 5)
+            {
+                printf("mismatch:\n  %s  %s", a, b);
+            }
+        }
+    }
+
+    fclose(bin);
+    fclose(decoded);
+    fclose(text);
+    if (records != CHECK_FRAMES * 4 || mismatches)
+    {
+        dbprintlf(FATAL "Decoded %d of %d records, %d mismatches.", records, CHECK_FRAMES * 4, mismatches);
+        return 0;
+    }
+    return 1;
+}
+
+int main(void)
+{
+    if (!check_round_trip())
+    {
+        return 1;
+    }
+    printf("log: %d frames round-trip through the binary log and gs_log_decode().\n", CHECK_FRAMES);
+
+    double caller, total;
+    printf("%-28s %12s %12s %10s\n", "per-frame logging (4 lines)", "caller ns", "total ns", "dropped");
+
+    int saved = redirect_stderr("/dev/null");
+    caller = flood(frame_dbprintlf, FLOOD_FRAMES, &total);
+    restore_stderr(saved);
+    printf("%-28s %12.1f %12.1f %10d\n", "dbprintlf, /dev/null", caller, total, 0);
+    gs_bench_report("log", "dbprintlf_devnull", caller, "ns/frame", GS_BENCH_LOWER, 0);
+
+    saved = redirect_stderr(LOG_TEXT_PATH);
+    caller = flood(frame_dbprintlf, FLOOD_FRAMES, &total);
+    restore_stderr(saved);
+    printf("%-28s %12.1f %12.1f %10d\n", "dbprintlf, file", caller, total, 0);
+    gs_bench_report("log", "dbprintlf_file", caller, "ns/frame", GS_BENCH_LOWER, 25);
+
+    saved = redirect_stderr(LOG_TEXT_PATH);
+    gs_log_start(nullptr);
+    uint64_t dropped = gs_log_dropped();
+    caller = flood(frame_logprintlf, FLOOD_FRAMES, &total);
+    dropped = gs_log_dropped() - dropped;
+    gs_log_stop();
+    restore_stderr(saved);
+    printf("%-28s %12.1f %12.1f %10llu\n", "logprintlf, text to file", caller, total, (unsigned long long)dropped);
+    gs_bench_report("log", "logprintlf_text", caller, "ns/frame", GS_BENCH_LOWER, 0);
+
+    gs_log_start(LOG_BIN_PATH);
+    dropped = gs_log_dropped();
+    caller = flood(frame_logprintlf, FLOOD_FRAMES, &total);
+    dropped = gs_log_dropped() - dropped;
+    gs_log_stop();
+    printf("%-28s %12.1f %12.1f %10llu\n", "logprintlf, binary file", caller, total, (unsigned long long)dropped);
+    gs_bench_report("log", "logprintlf_binary", caller, "ns/frame", GS_BENCH_LOWER, 0);
+
+    // Same again at a fixed frame rate, where the background thread should keep up and drop nothing.
+    saved = redirect_stderr("/dev/null");
+    caller = flood(frame_dbprintlf, PACED_FRAMES, &total, PACED_RATE);
+    restore_stderr(saved);
+    printf("%-28s %12.1f %12s %10d\n", "dbprintlf, paced", caller, "-", 0);
+
+    gs_log_start(LOG_BIN_PATH);
+    dropped = gs_log_dropped();
+    caller = flood(frame_logprintlf, PACED_FRAMES, &total, PACED_RATE);
+    dropped = gs_log_dropped() - dropped;
+    gs_log_stop();
+    printf("%-28s %12.1f %12s %10llu\n", "logprintlf, paced", caller, "-", (unsigned long long)dropped);
+    gs_bench_report("log", "logprintlf_paced", caller, "ns/frame", GS_BENCH_LOWER, 0);
+
+    unlink(LOG_TEXT_PATH);
+    unlink(LOG_BIN_PATH);
+    return 0;
+}
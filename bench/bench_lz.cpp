@@ -0,0 +1,438 @@
+/**
+ * @file bench_lz.cpp
+ * @author agent (agent@local)
+ * @brief Checks uplink compression round-trips and its decisions, measures its ratio and speed on command and file corpora, and uplinks compressed payloads to a simulated spacecraft.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "gs_uhf.hpp"
+#include "gs_lz.hpp"
+#include "gs_sar.hpp"
+#include "gs_radio.hpp"
+#include "gs_bench.hpp"
+#include "gs_time.hpp"
+#include "gs_log.hpp"
+#include "meb_debug.hpp"
+
+#define SPEED_ITERATIONS 2000
+#define LINK_OPTIONS "latency=5000,rate=115200,echo"
+#define LINK_TIMEOUT_S 20
+
+#define CHECK(cond)                                       \
+    do                                                    \
+    {                                                     \
+        if (!(cond))                                      \
+        {                                                 \
+            dbprintlf(RED_FG "Check failed: %s", #cond); \
+            failures++;                                   \
+        }                                                 \
+    } while (0)
+
+typedef struct
+{
+    const char *name;
+    uint8_t data[UHF_SAR_MAX_MESSAGE];
+    size_t len;
+} corpus_t;
+
+enum
+{
+    CORPUS_COMMANDS,
+    CORPUS_SCRIPT,
+    CORPUS_CONFIG,
+    CORPUS_TLE,
+    CORPUS_RANDOM,
+    CORPORA
+};
+
+static corpus_t corpora[CORPORA];
+
+static void corpus_text(corpus_t *corpus, const char *name, const char *text)
+{
+    corpus->name = name;
+    corpus->len = strlen(text);
+    memcpy(corpus->data, text, corpus->len);
+}
+
+/**
+ * @brief What the server uplinks: batched commands, the files it sends up, and bytes that do not compress.
+ */
+static void make_corpora(void)
+{
+    // Four commands back to back, as a batch fits in one NetFrame.
+    corpus_t *commands = &corpora[CORPUS_COMMANDS];
+    commands->name = "commands";
+    for (int i = 0; i < 4; i++)
+    {
+        cmd_input_t cmd[1];
+        memset(cmd, 0x0, sizeof(cmd_input_t));
+        cmd->mod = 0x2 + i % 2;
+        cmd->cmd = 0x10 + i;
+        cmd->data_size = i % 2 ? 4 : 1;
+        memcpy(cmd->data, "\x01\x00\x3c\x00", cmd->data_size);
+        memcpy(commands->data + commands->len, cmd, sizeof(cmd_input_t));
+        commands->len += sizeof(cmd_input_t);
+    }
+
+    corpus_text(&corpora[CORPUS_SCRIPT], "script",
+                "#!/bin/sh\nset -e\nif [ -f \"/home/sh/payload.bin\" ]; then\n    mv /home/sh/payload.bin /home/sh/payload.old\nfi\n"
+                "mkdir -p /home/sh/data\nchmod +x /home/sh/data/run.sh\nsystemctl restart acs\nsystemctl restart eps\necho \"done\" >> /home/sh/log\n");
+    corpus_text(&corpora[CORPUS_CONFIG], "config",
+                "[config]\nbeacon_enabled = true\nbeacon_period_ms = 10000\nxband_enabled = false\nacs_detumble = true\nacs_period_ms = 100\n");
+    corpus_text(&corpora[CORPUS_TLE], "tle",
+                "ISS (ZARYA)\n"
+                "1 25544U 98067A   21244.52009606  .00002021  00000-0  45321-4 0  9991\n"
+                "2 25544  51.6440 335.6178 0003084 316.6432 183.2845 15.48454843300542\n");
+
+    corpus_t *random = &corpora[CORPUS_RANDOM];
+    random->name = "random";
+    random->len = UHF_SAR_MAX_MESSAGE;
+    uint32_t state = 0x2545f491;
+    for (size_t i = 0; i < random->len; i++)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        random->data[i] = (uint8_t)state;
+    }
+}
+
+/**
+ * @brief Runs a message through two SAR endpoints on a lossless virtual channel.
+ */
+static bool sar_pass(gs_sar_t *a, gs_sar_t *b, const uint8_t *msg, size_t len, bool compressed)
+{
+    uint64_t now = NSEC_PER_SEC;
+    if (!gs_sar_send_start(a, msg, len, compressed))
+    {
+        return false;
+    }
+    gs_sar_status_t status = GS_SAR_WAIT;
+    while (status == GS_SAR_SEND || status == GS_SAR_WAIT)
+    {
+        uint8_t payload[GST_MAX_PAYLOAD_SIZE];
+        uint64_t wake_ns = 0;
+        status = gs_sar_send_poll(a, now, payload, &wake_ns);
+        if (status == GS_SAR_SEND)
+        {
+            gs_sar_input(b, payload, now);
+        }
+        else if (status == GS_SAR_WAIT)
+        {
+            now = wake_ns;
+        }
+        if (gs_sar_take_ack(b, payload))
+        {
+            gs_sar_input(a, payload, now);
+        }
+    }
+    return status == GS_SAR_DONE;
+}
+
+static int check_codec(void)
+{
+    int failures = 0;
+    uint8_t packed[2 * UHF_SAR_MAX_MESSAGE], out[UHF_SAR_MAX_MESSAGE];
+
+    // Every corpus through every dictionary, and through the pick of them.
+    for (int c = 0; c < CORPORA; c++)
+    {
+        const corpus_t *corpus = &corpora[c];
+        for (int dict = GS_LZ_DICT_NONE; dict < GS_LZ_DICTS; dict++)
+        {
+            ssize_t size = gs_lz_compress(packed, sizeof(packed), corpus->data, corpus->len, dict);
+            CHECK(size > 0 && size == gs_lz_compress(nullptr, sizeof(packed), corpus->data, corpus->len, dict));
+            CHECK(gs_lz_decompress(out, sizeof(out), packed, size) == (ssize_t)corpus->len && memcmp(out, corpus->data, corpus->len) == 0);
+        }
+        ssize_t size = gs_lz_pack(packed, sizeof(packed), corpus->data, corpus->len);
+        for (int dict = GS_LZ_DICT_NONE; dict < GS_LZ_DICTS; dict++)
+        {
+            CHECK(size <= gs_lz_compress(nullptr, sizeof(packed), corpus->data, corpus->len, dict));
+        }
+        CHECK(gs_lz_decompress(out, sizeof(out), packed, size) == (ssize_t)corpus->len && memcmp(out, corpus->data, corpus->len) == 0);
+    }
+
+    // What the ground station asks for: at least a frame fewer. Random bytes never get there; the rest all do.
+    for (int c = 0; c < CORPORA; c++)
+    {
+        const corpus_t *corpus = &corpora[c];
+        size_t cap = (gs_sar_frames(corpus->len) - 1) * GS_SAR_SEGMENT_SIZE;
+        cap = cap < GST_MAX_PAYLOAD_SIZE ? GST_MAX_PAYLOAD_SIZE : cap;
+        ssize_t size = gs_lz_pack(packed, cap, corpus->data, corpus->len);
+        CHECK(c == CORPUS_RANDOM ? size == 0 : size > 0 && gs_sar_frames(size) < gs_sar_frames(corpus->len));
+    }
+    const corpus_t *commands = &corpora[CORPUS_COMMANDS];
+    ssize_t size = gs_lz_pack(packed, GST_MAX_PAYLOAD_SIZE, commands->data, commands->len);
+    CHECK(size > 0 && size <= GST_MAX_PAYLOAD_SIZE && ((gs_lz_header_t *)packed)->dict == GS_LZ_DICT_CMD);
+
+    // A frame's zero padding after the stream is ignored; anything short, foreign or reaching back too far is not.
+    memset(packed + size, 0x0, GST_MAX_PAYLOAD_SIZE - size);
+    CHECK(gs_lz_decompress(out, sizeof(out), packed, GST_MAX_PAYLOAD_SIZE) == (ssize_t)commands->len);
+    CHECK(gs_lz_decompress(out, sizeof(out), packed, size - 1) < 0);
+    CHECK(gs_lz_decompress(out, commands->len - 1, packed, size) < 0);
+    CHECK(gs_lz_decompress(out, sizeof(out), packed, sizeof(gs_lz_header_t) - 1) < 0);
+    packed[0] = GS_LZ_DICTS;
+    CHECK(gs_lz_decompress(out, sizeof(out), packed, size) < 0);
+    const uint8_t far_back[] = {GS_LZ_DICT_NONE, 4, 0, 0x7f, 0xf0}; // A match 256 back, with nothing behind it.
+    CHECK(gs_lz_decompress(out, sizeof(out), far_back, sizeof(far_back)) < 0);
+    CHECK(gs_lz_compress(packed, sizeof(packed), commands->data, commands->len, GS_LZ_DICTS) < 0);
+    CHECK(gs_lz_compress(packed, sizeof(packed), commands->data, 0, GS_LZ_DICT_NONE) < 0);
+
+    // The receiving end learns from the segments whether a message is compressed.
+    gs_sar_t *a = gs_sar_create(UHF_SAR_MAX_MESSAGE);
+    gs_sar_t *b = gs_sar_create(UHF_SAR_MAX_MESSAGE);
+    const corpus_t *script = &corpora[CORPUS_SCRIPT];
+    size = gs_lz_pack(packed, sizeof(packed), script->data, script->len);
+    for (int compressed = 1; compressed >= 0; compressed--)
+    {
+        const uint8_t *msg = compressed ? packed : script->data;
+        size_t msg_len = compressed ? size : script->len, len = 0;
+        bool flag = !compressed;
+        CHECK(sar_pass(a, b, msg, msg_len, compressed));
+        const uint8_t *got = gs_sar_message(b, &len, &flag);
+        CHECK(flag == (bool)compressed && len == msg_len && memcmp(got, msg, len) == 0);
+    }
+    gs_sar_destroy(a);
+    gs_sar_destroy(b);
+    return failures;
+}
+
+/**
+ * @brief Prints and reports each corpus's compression, and the encoder's and decoder's speed over them all.
+ */
+static void measure(void)
+{
+    static uint8_t packed[CORPORA][2 * UHF_SAR_MAX_MESSAGE];
+    uint8_t scratch[2 * UHF_SAR_MAX_MESSAGE], out[UHF_SAR_MAX_MESSAGE];
+    ssize_t sizes[CORPORA];
+    size_t total = 0;
+    int frames_plain = 0, frames_sent = 0;
+
+    printf("%-10s %6s %6s %7s %6s %8s\n", "corpus", "bytes", "packed", "ratio", "dict", "frames");
+    for (int c = 0; c < CORPORA; c++)
+    {
+        const corpus_t *corpus = &corpora[c];
+        sizes[c] = gs_lz_pack(packed[c], sizeof(packed[c]), corpus->data, corpus->len);
+        double ratio = (double)sizes[c] / corpus->len;
+        // Sent as the ground station would: compressed only if that saves a frame.
+        int plain = gs_sar_frames(corpus->len);
+        int sent = gs_sar_frames(sizes[c]) < plain ? gs_sar_frames(sizes[c]) : plain;
+        frames_plain += plain;
+        frames_sent += sent;
+        total += corpus->len;
+        printf("%-10s %6zu %6zd %6.1f%% %6s %3d -> %d\n", corpus->name, corpus->len, sizes[c], 100 * ratio,
+               gs_lz_dict_name(((gs_lz_header_t *)packed[c])->dict), plain, sent);
+        char metric[GS_BENCH_NAME_MAX];
+        snprintf(metric, sizeof(metric), "ratio_%s", corpus->name);
+        gs_bench_report("lz", metric, ratio, "ratio", GS_BENCH_LOWER, 1);
+    }
+    printf("lz: %d frames instead of %d, %.1f%% fewer.\n", frames_sent, frames_plain, 100.0 * (frames_plain - frames_sent) / frames_plain);
+    gs_bench_report("lz", "frames_saved", 100.0 * (frames_plain - frames_sent) / frames_plain, "%", GS_BENCH_HIGHER, 1);
+
+    // Encoding is what the event loop pays: every dictionary tried, then the best written.
+    uint64_t start = gs_time_ns();
+    for (int i = 0; i < SPEED_ITERATIONS; i++)
+    {
+        for (int c = 0; c < CORPORA; c++)
+        {
+            gs_lz_pack(scratch, sizeof(scratch), corpora[c].data, corpora[c].len);
+        }
+    }
+    double encode_s = (gs_time_ns() - start) / 1e9;
+
+    start = gs_time_ns();
+    for (int i = 0; i < SPEED_ITERATIONS; i++)
+    {
+        for (int c = 0; c < CORPORA; c++)
+        {
+            gs_lz_decompress(out, sizeof(out), packed[c], sizes[c]);
+        }
+    }
+    double decode_s = (gs_time_ns() - start) / 1e9;
+
+    double mb = (double)total * SPEED_ITERATIONS / 1e6;
+    printf("lz: encode %.1f MB/s (%.1f us per payload), decode %.1f MB/s.\n", mb / encode_s,
+           encode_s * 1e6 / SPEED_ITERATIONS / CORPORA, mb / decode_s);
+    gs_bench_report("lz", "encode_speed", mb / encode_s, "MB/s", GS_BENCH_HIGHER, 40);
+    gs_bench_report("lz", "decode_speed", mb / decode_s, "MB/s", GS_BENCH_HIGHER, 40);
+}
+
+typedef struct
+{
+    gs_radio_t *radio;
+    gs_sar_t *sar;
+    bool done;
+    pthread_mutex_t lock;
+    uint8_t received[UHF_SAR_MAX_MESSAGE];
+    size_t received_len;
+    int received_count;
+} link_t;
+
+static void *link_rx_thread(void *args)
+{
+    link_t *link = (link_t *)args;
+    while (!__atomic_load_n(&link->done, __ATOMIC_ACQUIRE))
+    {
+        char buf[GST_MAX_PAYLOAD_SIZE];
+        int16_t rssi = 0;
+        uint16_t guid = 0;
+        if (gs_uhf_read(link->radio, buf, sizeof(buf), &rssi, &link->done, &guid) <= 0 || guid != GST_SAR_GUID)
+        {
+            continue;
+        }
+        if (gs_sar_input(link->sar, (uint8_t *)buf, gs_time_ns()) & GS_SAR_IN_MESSAGE)
+        {
+            size_t len = 0;
+            const uint8_t *msg = gs_sar_message(link->sar, &len);
+            pthread_mutex_lock(&link->lock);
+            memcpy(link->received, msg, len < sizeof(link->received) ? len : sizeof(link->received));
+            link->received_len = len;
+            link->received_count++;
+            pthread_mutex_unlock(&link->lock);
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Sends any waiting ACK and the next segment, or sleeps briefly, as bench_sar's link does.
+ */
+static gs_sar_status_t link_tx_step(link_t *link)
+{
+    bool done = false;
+    uint8_t payload[GST_MAX_PAYLOAD_SIZE];
+    if (gs_sar_take_ack(link->sar, payload))
+    {
+        gs_uhf_write(link->radio, (char *)payload, GST_MAX_PAYLOAD_SIZE, &done, GST_SAR_GUID);
+    }
+
+    uint64_t now = gs_time_ns();
+    uint64_t wake_ns = 0;
+    gs_sar_status_t status = gs_sar_send_poll(link->sar, now, payload, &wake_ns);
+    if (status == GS_SAR_SEND)
+    {
+        gs_uhf_write(link->radio, (char *)payload, GST_MAX_PAYLOAD_SIZE, &done, GST_SAR_GUID);
+    }
+    else if (status == GS_SAR_WAIT || status == GS_SAR_IDLE)
+    {
+        uint64_t limit = now + UHF_SAR_PREEMPT_MS * NSEC_PER_MSEC;
+        gs_sar_wait(link->sar, status == GS_SAR_WAIT && wake_ns < limit ? wake_ns : limit);
+    }
+    return status;
+}
+
+/**
+ * @brief Waits for the spacecraft's echo of an uplink, which it sends back down uncompressed, and checks it.
+ */
+static bool link_echo(link_t *link, int count, const corpus_t *corpus)
+{
+    uint64_t give_up = gs_time_ns() + LINK_TIMEOUT_S * NSEC_PER_SEC;
+    while (__atomic_load_n(&link->received_count, __ATOMIC_ACQUIRE) < count && gs_time_ns() < give_up)
+    {
+        link_tx_step(link);
+    }
+    pthread_mutex_lock(&link->lock);
+    bool match = link->received_count == count && link->received_len == corpus->len &&
+                 memcmp(link->received, corpus->data, corpus->len) == 0;
+    pthread_mutex_unlock(&link->lock);
+    return match;
+}
+
+static int check_link(void)
+{
+    int failures = 0;
+    gs_sim_config_t config[1];
+    gs_radio_sim_defaults(config);
+    gs_radio_sim_parse(config, LINK_OPTIONS);
+
+    link_t link[1];
+    memset(link, 0x0, sizeof(link_t));
+    pthread_mutex_init(&link->lock, NULL);
+    link->radio = gs_radio_sim_create(config);
+    link->sar = gs_sar_create(UHF_SAR_MAX_MESSAGE);
+    if (link->radio == nullptr || link->sar == nullptr || gs_radio_init(link->radio) != 1)
+    {
+        dbprintlf(FATAL "Failed to set up the simulated link.");
+        return 1;
+    }
+    pthread_t rx_tid;
+    pthread_create(&rx_tid, NULL, link_rx_thread, link);
+
+    // The command batch in one GST_LZ_GUID frame.
+    bool done = false;
+    uint8_t frame[GST_MAX_PAYLOAD_SIZE], packed[UHF_SAR_MAX_MESSAGE];
+    const corpus_t *commands = &corpora[CORPUS_COMMANDS];
+    memset(frame, 0x0, sizeof(frame));
+    ssize_t size = gs_lz_pack(frame, sizeof(frame), commands->data, commands->len);
+    CHECK(size > 0);
+    gs_uhf_write(link->radio, (char *)frame, sizeof(frame), &done, GST_LZ_GUID);
+    CHECK(link_echo(link, 1, commands));
+
+    // The script as a compressed multi-frame message.
+    const corpus_t *script = &corpora[CORPUS_SCRIPT];
+    size = gs_lz_pack(packed, sizeof(packed), script->data, script->len);
+    CHECK(size > GST_MAX_PAYLOAD_SIZE && gs_sar_send_start(link->sar, packed, size, true));
+    gs_sar_status_t status;
+    while ((status = link_tx_step(link)) == GS_SAR_SEND || status == GS_SAR_WAIT)
+    {
+    }
+    CHECK(status == GS_SAR_DONE);
+    CHECK(link_echo(link, 2, script));
+
+    // A frame that claims to be compressed but is not is refused, not echoed.
+    memset(frame, 0xa5, sizeof(frame));
+    gs_uhf_write(link->radio, (char *)frame, sizeof(frame), &done, GST_LZ_GUID);
+    gs_sim_stats_t sim[1];
+    uint64_t give_up = gs_time_ns() + LINK_TIMEOUT_S * NSEC_PER_SEC;
+    do
+    {
+        gs_sleep_until_ns(gs_time_ns() + 10 * NSEC_PER_MSEC);
+        gs_radio_sim_stats(link->radio, sim);
+    } while (sim->lz_rejected == 0 && gs_time_ns() < give_up);
+    CHECK(sim->lz_uplinks == 2 && sim->lz_rejected == 1 && sim->sar_uplinks == 1);
+    CHECK(__atomic_load_n(&link->received_count, __ATOMIC_ACQUIRE) == 2);
+
+    __atomic_store_n(&link->done, true, __ATOMIC_RELEASE);
+    pthread_join(rx_tid, NULL);
+    if (!failures)
+    {
+        printf("lz: the simulated spacecraft decoded a compressed frame and a compressed %zd-byte message (%zu plain) and echoed both whole.\n",
+               size, script->len);
+    }
+    gs_radio_destroy(link->radio);
+    gs_sar_destroy(link->sar);
+    pthread_mutex_destroy(&link->lock);
+    return failures;
+}
+
+int main(void)
+{
+    make_corpora();
+    int failures = check_codec();
+    if (failures)
+    {
+        dbprintlf(FATAL "%d compression checks failed.", failures);
+        return 1;
+    }
+    printf("lz: round-trips, dictionary choice, not-worth-it, malformed-input and SAR flag checks pass.\n");
+    measure();
+
+    // Every frame logs a line from gs_uhf_write(); keep them out of the results.
+    gs_log_start("/dev/null");
+    failures = check_link();
+    gs_log_stop();
+    if (failures)
+    {
+        dbprintlf(FATAL "%d compressed uplink checks failed.", failures);
+        return 1;
+    }
+    return 0;
+}
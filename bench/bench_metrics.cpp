@@ -0,0 +1,213 @@
+/**
+ * @file bench_metrics.cpp
+ * @author agent (agent@local)
+ * @brief Checks the latency histograms and the metrics endpoint, then measures the cost of recording.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "gs_uhf.hpp"
+#include "gs_metrics.hpp"
+#include "gs_bench.hpp"
+#include "gs_time.hpp"
+#include "meb_debug.hpp"
+
+#define BENCH_RECORDS 10000000
+#define BENCH_THREADS 4
+#define CHECK_SAMPLES 100000
+#define CHECK_SOCKET "/tmp/bench_metrics.sock"
+
+static volatile uint64_t sink;
+
+/**
+ * @brief Every value must land in a bucket whose range holds it, and the bucket must be within 12.5%.
+ * 
+ * @return int Number of failures.
+ */
+static int check_buckets(void)
+{
+    int failures = 0;
+    srand(0x6f35);
+    for (int i = 0; i < CHECK_SAMPLES; i++)
+    {
+        uint64_t value = i < 1024 ? i : ((uint64_t)rand() << 31 | rand()) >> (rand() % 62);
+        int bucket = gs_metrics_bucket(value);
+        uint64_t low = gs_metrics_bucket_low(bucket);
+        uint64_t high = bucket + 1 < METRICS_HIST_BUCKETS ? gs_metrics_bucket_low(bucket + 1) : UINT64_MAX;
+        if (bucket < 0 || bucket >= METRICS_HIST_BUCKETS || value < low || value >= high || (high - low) > (low / 8 > 1 ? low / 8 : 1))
+        {
+            if (failures++ < 5)
+            {
+                dbprintlf(RED_FG "%llu lands in bucket %d [%llu, %llu).", (unsigned long long)value, bucket, (unsigned long long)low, (unsigned long long)high);
+            }
+        }
+    }
+    return failures;
+}
+
+/**
+ * @brief Records a uniform spread of latencies and checks the quantiles come back within a bucket.
+ * 
+ * @return int Number of failures.
+ */
+static int check_quantiles(void)
+{
+    // 1 us to 10 ms, uniform.
+    for (int i = 0; i < CHECK_SAMPLES; i++)
+    {
+        gs_metrics_record(GS_STAGE_VALIDATE, 1000 + (uint64_t)i * (10000000 - 1000) / CHECK_SAMPLES);
+    }
+
+    int failures = 0;
+    const double quantiles[] = {0.01, 0.5, 0.9, 0.99};
+    for (size_t q = 0; q < sizeof(quantiles) / sizeof(quantiles[0]); q++)
+    {
+        uint64_t count;
+        double expected = 1000 + quantiles[q] * (10000000 - 1000);
+        double got = gs_metrics_quantile(GS_STAGE_VALIDATE, quantiles[q], &count);
+        if (count != CHECK_SAMPLES || got < expected * 0.875 || got > expected * 1.125)
+        {
+            dbprintlf(RED_FG "p%g: %.0f ns, expected %.0f ns (%llu samples).", quantiles[q] * 100, got, expected, (unsigned long long)count);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+/**
+ * @brief Scrapes the endpoint over HTTP and checks the exposition has the validate histogram and error counters.
+ * 
+ * @return int Number of failures.
+ */
+static int check_endpoint(void)
+{
+    gs_metrics_count_gst_error(-GST_CRC_ERROR);
+    gs_metrics_count_gst_error(-GST_CRC_ERROR);
+    gs_metrics_rssi(-90);
+    if (!gs_metrics_start(CHECK_SOCKET))
+    {
+        return 1;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr;
+    memset(&addr, 0x0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, CHECK_SOCKET);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        gs_metrics_stop();
+        return 1;
+    }
+    const char request[] = "GET /metrics HTTP/1.0\r\n\r\n";
+    if (write(fd, request, sizeof(request) - 1) < 0)
+    {
+        close(fd);
+        gs_metrics_stop();
+        return 1;
+    }
+
+    static char response[1 << 20];
+    size_t len = 0;
+    ssize_t n;
+    while ((n = read(fd, response + len, sizeof(response) - 1 - len)) > 0)
+    {
+        len += n;
+    }
+    response[len] = '\0';
+    close(fd);
+    gs_metrics_stop();
+
+    int failures = 0;
+    const char *expected[] = {
+        "HTTP/1.0 200 OK",
+        "roofuhf_uhf_rx_errors_total{code=\"GST_CRC_ERROR\"} 2\n",
+        "roofuhf_stage_latency_seconds_count{stage=\"validate\"} 100000\n",
+        "roofuhf_stage_latency_seconds_bucket{stage=\"validate\",le=\"+Inf\"} 100000\n",
+        "roofuhf_uhf_rx_rssi_dbm_bucket{le=\"-90\"} 1\n",
+    };
+    for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++)
+    {
+        if (strstr(response, expected[i]) == nullptr)
+        {
+            dbprintlf(RED_FG "Scrape is missing: %s", expected[i]);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+static void *bench_thread(void *args)
+{
+    double *ns_per_record = (double *)args;
+    gs_metrics_count(GS_COUNT_UHF_RX_FRAMES); // Allocates this thread's shard outside the timed loop.
+    uint64_t start = gs_time_ns();
+    for (int i = 0; i < BENCH_RECORDS; i++)
+    {
+        gs_metrics_record(GS_STAGE_RADIO_READ, (uint64_t)i * 2654435761u >> 12);
+    }
+    *ns_per_record = (double)(gs_time_ns() - start) / BENCH_RECORDS;
+    return nullptr;
+}
+
+int main(void)
+{
+    int failures = check_buckets() + check_quantiles() + check_endpoint();
+    if (failures)
+    {
+        dbprintlf(FATAL "%d metrics checks failed.", failures);
+        return 1;
+    }
+    printf("metrics: buckets, quantiles and the Prometheus endpoint check out.\n");
+
+    uint64_t start = gs_time_ns();
+    for (int i = 0; i < BENCH_RECORDS; i++)
+    {
+        gs_metrics_count(GS_COUNT_NET_TX_FRAMES);
+    }
+    double count_ns = (double)(gs_time_ns() - start) / BENCH_RECORDS;
+
+    start = gs_time_ns();
+    for (int i = 0; i < BENCH_RECORDS; i++)
+    {
+        sink = gs_time_ns();
+    }
+    double clock_ns = (double)(gs_time_ns() - start) / BENCH_RECORDS;
+
+    double one_thread;
+    bench_thread(&one_thread);
+
+    pthread_t tids[BENCH_THREADS];
+    double per_thread[BENCH_THREADS];
+    for (int i = 0; i < BENCH_THREADS; i++)
+    {
+        pthread_create(&tids[i], NULL, bench_thread, &per_thread[i]);
+    }
+    double worst = 0;
+    for (int i = 0; i < BENCH_THREADS; i++)
+    {
+        pthread_join(tids[i], NULL);
+        worst = per_thread[i] > worst ? per_thread[i] : worst;
+    }
+
+    printf("%-34s %8s\n", "operation", "ns");
+    printf("%-34s %8.1f\n", "gs_metrics_count", count_ns);
+    printf("%-34s %8.1f\n", "gs_metrics_record, 1 thread", one_thread);
+    printf("%-34s %8.1f\n", "gs_metrics_record, 4 threads (worst)", worst);
+    printf("%-34s %8.1f\n", "gs_time_ns (per timestamp)", clock_ns);
+    gs_bench_report("metrics", "count", count_ns, "ns", GS_BENCH_LOWER, 25);
+    gs_bench_report("metrics", "record", one_thread, "ns", GS_BENCH_LOWER, 0);
+    gs_bench_report("metrics", "record_4_threads_worst", worst, "ns", GS_BENCH_LOWER, 25);
+    gs_bench_report("metrics", "time_ns", clock_ns, "ns", GS_BENCH_LOWER, 0);
+    return 0;
+}
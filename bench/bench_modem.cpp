@@ -0,0 +1,487 @@
+/**
+ * @file bench_modem.cpp
+ * @author agent (agent@local)
+ * @brief Checks UHF_CONFIG parsing and the adaptive data rate's rules, that modem switches never land mid-frame,
+ * and what adapting the data rate over a pass gains.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * A simulated radio on an "awgn" channel is switched between two data rates through gs_modem_apply() while
+ * the spacecraft beacons and a transmit side keeps uplinking bursts: no switch may land on a frame on the
+ * air, and each is timed from being asked for to being in effect. Calling the backend directly, as a
+ * control, some do land mid-frame.
+ * 
+ * A pass is then emulated by ramping the RSSI up by BENCH_PASS_DB and back down over BENCH_PASS_S, with the
+ * spacecraft beaconing as much as BENCH_PASS_DUTY of the air allows at whatever rate is in effect. The same pass
+ * runs at the same time on radios held at fixed rates and on one following gs_adapt_window(), judged every
+ * BENCH_WINDOW_MS rather than GS_ADAPT_WINDOW_MS to fit the pass into a few seconds. The adaptive one has to
+ * climb near the highest point, fall back before the end, and bring down more frames than any fixed rate.
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "gs_modem.hpp"
+#include "gs_uhf.hpp"
+#include "gs_arbiter.hpp"
+#include "gs_radio.hpp"
+#include "gs_bench.hpp"
+#include "gs_time.hpp"
+#include "meb_debug.hpp"
+
+#define BENCH_SWITCHES 30
+#define BENCH_LOW_RATE 9600   // The switches alternate between these.
+#define BENCH_HIGH_RATE 19200
+#define BENCH_DIRECT_S 3      // How long the control retunes past the arbiter.
+#define BENCH_PASS_S 20
+#define BENCH_PASS_FLOOR -118 // dBm at the ends of the pass, about what 4800 bps needs.
+#define BENCH_PASS_DB 22      // Rise to the highest point, where 38400 bps closes with room to spare.
+#define BENCH_WINDOW_MS 250
+#define BENCH_STEP_MS 50      // RSSI updates.
+#define BENCH_DUTY 0.5       // Of the air the beacons take, while switching.
+#define BENCH_PASS_DUTY 0.8  // And over the pass, where the spacecraft sends all it can.
+
+#define CHECK(cond)                                       \
+    do                                                    \
+    {                                                     \
+        if (!(cond))                                      \
+        {                                                 \
+            dbprintlf(RED_FG "Check failed: %s", #cond); \
+            failures++;                                   \
+        }                                                 \
+    } while (0)
+
+/**
+ * @brief Checks UHF_CONFIG payloads are taken or refused as they should be.
+ * 
+ * @return int Failed checks.
+ */
+static int check_parse(void)
+{
+    int failures = 0;
+    gs_modem_t modem;
+    int adapt;
+    gs_modem_config_t config = {19200, 9600, 16, 100, GS_ADAPT_ON};
+    CHECK(sizeof(gs_modem_config_t) == 12);
+    CHECK(gs_modem_parse(&config, sizeof(config), &modem, &adapt) == 1);
+    CHECK(modem.bitrate == 19200 && modem.deviation_hz == 9600 && modem.preamble == 16 && modem.power == 100 && adapt == GS_ADAPT_ON);
+    CHECK(gs_modem_parse(&config, sizeof(config) - 1, &modem, &adapt) == 0);
+    CHECK(gs_modem_parse(&config, 4, &modem, &adapt) == 0);
+    CHECK(gs_modem_parse(nullptr, sizeof(config), &modem, &adapt) == 0);
+
+    gs_modem_config_t bad = config;
+    bad.bitrate = GS_MODEM_MIN_BPS - 1;
+    CHECK(gs_modem_parse(&bad, sizeof(bad), &modem, &adapt) == 0);
+    bad = config;
+    bad.bitrate = GS_MODEM_MAX_BPS + 1;
+    CHECK(gs_modem_parse(&bad, sizeof(bad), &modem, &adapt) == 0);
+    bad = config;
+    bad.deviation_hz = GS_MODEM_MAX_DEV_HZ + 1;
+    CHECK(gs_modem_parse(&bad, sizeof(bad), &modem, &adapt) == 0);
+    bad = config;
+    bad.power = GS_MODEM_MAX_POWER + 1;
+    CHECK(gs_modem_parse(&bad, sizeof(bad), &modem, &adapt) == 0);
+    bad = config;
+    bad.adapt = GS_ADAPT_ON + 1;
+    CHECK(gs_modem_parse(&bad, sizeof(bad), &modem, &adapt) == 0);
+
+    // All zeroes asks for nothing, and is fine.
+    gs_modem_config_t none = {0, 0, 0, 0, GS_ADAPT_KEEP};
+    CHECK(gs_modem_parse(&none, sizeof(none), &modem, &adapt) == 1);
+    CHECK(modem.bitrate == 0 && modem.power == 0 && adapt == GS_ADAPT_KEEP);
+
+    // Requests overlay each other, and only a change kicks the event loop.
+    gs_modem_ctl_t *ctl = gs_modem_create(false);
+    CHECK(ctl != nullptr && !gs_modem_active(ctl));
+    if (ctl == nullptr)
+    {
+        return failures;
+    }
+    gs_modem_t power = {0, 0, 0, 100};
+    gs_modem_request(ctl, &power, GS_ADAPT_KEEP, 1);
+    CHECK(ctl->kick && ctl->asked_ns == 1 && gs_modem_active(ctl));
+    ctl->kick = false;
+    gs_modem_request(ctl, &power, GS_ADAPT_KEEP, 2);
+    CHECK(!ctl->kick && ctl->asked_ns == 1);
+    gs_modem_t rate = {9600, 4800, 0, 0};
+    gs_modem_request(ctl, &rate, GS_ADAPT_ON, 3);
+    CHECK(ctl->kick && ctl->adapt && ctl->want.bitrate == 9600 && ctl->want.power == 100);
+    gs_modem_forget(ctl);
+    CHECK(!gs_modem_active(ctl) && ctl->stats.rejected == 1);
+    gs_modem_destroy(ctl);
+    return failures;
+}
+
+/**
+ * @brief Feeds gs_adapt_window() windows of frames.
+ */
+static uint32_t bench_window(gs_adapt_t *adapt, uint32_t bitrate, gs_link_t *link, int good, int bad, int rssi)
+{
+    link->good += good;
+    link->bad += bad;
+    link->rssi_sum += (int64_t)good * rssi;
+    return gs_adapt_window(adapt, bitrate, link);
+}
+
+/**
+ * @brief Checks the adaptive data rate's rules one window at a time.
+ * 
+ * @return int Failed checks.
+ */
+static int check_window(void)
+{
+    int failures = 0;
+    gs_adapt_t adapt[1];
+    gs_link_t link = {0, 0, 0};
+    memset(adapt, 0x0, sizeof(gs_adapt_t));
+    adapt->fresh = true;
+
+    // The first window only starts counting.
+    CHECK(bench_window(adapt, 9600, &link, 20, 0, -80) == 0);
+    // Too many CRC errors, or an RSSI that no longer carries the rate, step down.
+    CHECK(bench_window(adapt, 9600, &link, 16, 4, -80) == 4800);
+    CHECK(bench_window(adapt, 4800, &link, 20, 0, (int)gs_adapt_need_dbm(4800) - 1) == 2400);
+    // Two clean windows with room for the next rate step up, not one.
+    CHECK(bench_window(adapt, 2400, &link, 20, 0, -80) == 0);
+    CHECK(bench_window(adapt, 2400, &link, 20, 0, -80) == 4800);
+    // A window without the room does not count toward it.
+    CHECK(bench_window(adapt, 4800, &link, 20, 0, -80) == 0);
+    CHECK(bench_window(adapt, 4800, &link, 20, 0, (int)gs_adapt_need_dbm(9600)) == 0);
+    CHECK(bench_window(adapt, 4800, &link, 20, 0, -80) == 0);
+    CHECK(bench_window(adapt, 4800, &link, 20, 0, -80) == 9600);
+    // Too few frames are carried into the next window, where the errors among them still count.
+    CHECK(bench_window(adapt, 9600, &link, 2, 2, -80) == 0);
+    CHECK(bench_window(adapt, 9600, &link, 4, 0, -80) == 4800);
+    // Silence steps down, after GS_ADAPT_SILENT_WINDOWS.
+    for (int i = 1; i < GS_ADAPT_SILENT_WINDOWS; i++)
+    {
+        CHECK(bench_window(adapt, 4800, &link, 0, 0, 0) == 0);
+    }
+    CHECK(bench_window(adapt, 4800, &link, 0, 0, 0) == 2400);
+    // Nowhere to go at either end of the ladder; a rate off it steps onto it.
+    CHECK(bench_window(adapt, 1200, &link, 0, 20, 0) == 0);
+    CHECK(bench_window(adapt, 38400, &link, 20, 0, -60) == 0);
+    CHECK(bench_window(adapt, 38400, &link, 20, 0, -60) == 0);
+    CHECK(bench_window(adapt, 7000, &link, 10, 10, -60) == 4800);
+    CHECK(adapt->ups == 2 && adapt->downs == 5);
+
+    // The thresholds follow the noise floor and a 14 dB Eb/N0.
+    CHECK(fabs(gs_adapt_need_dbm(9600) - (GS_ADAPT_N0_DBM_HZ + 10 * log10(9600.0) + GS_ADAPT_EBN0_DB)) < 1e-9);
+    CHECK(gs_adapt_need_dbm(38400) - gs_adapt_need_dbm(1200) > 15 && gs_adapt_need_dbm(38400) - gs_adapt_need_dbm(1200) < 15.1);
+    return failures;
+}
+
+static gs_radio_t *bench_sim(const char *options)
+{
+    gs_sim_config_t config[1];
+    gs_radio_sim_defaults(config);
+    if (!gs_radio_sim_parse(config, options))
+    {
+        return nullptr;
+    }
+    gs_radio_t *radio = gs_radio_sim_create(config);
+    if (radio != nullptr && gs_radio_init(radio) != 1)
+    {
+        gs_radio_destroy(radio);
+        return nullptr;
+    }
+    return radio;
+}
+
+typedef struct
+{
+    gs_radio_t *radio;
+    bool done;
+    uint64_t bursts;
+} bench_tx_t;
+
+static void *bench_tx_side(void *args)
+{
+    bench_tx_t *tx = (bench_tx_t *)args;
+    gst_frame_t frame[1];
+    gs_uhf_frame_build(frame, "modem", 5);
+    while (!__atomic_load_n(&tx->done, __ATOMIC_ACQUIRE))
+    {
+        gs_arbiter_tx_begin(tx->radio);
+        for (int i = 0; i < 3; i++)
+        {
+            gs_radio_write(tx->radio, frame, sizeof(gst_frame_t));
+        }
+        gs_arbiter_tx_end(tx->radio);
+        tx->bursts++;
+        usleep(150000);
+    }
+    return nullptr;
+}
+
+typedef struct
+{
+    gs_radio_t *radio;
+    bool done;
+} bench_rx_t;
+
+/**
+ * @brief Takes frames off the radio as the event loop would, which counts them into the radio's gs_link_t.
+ */
+static void *bench_rx_side(void *args)
+{
+    bench_rx_t *rx = (bench_rx_t *)args;
+    gst_fec_frame_t fec[1];
+    int16_t rssi;
+    while (!__atomic_load_n(&rx->done, __ATOMIC_ACQUIRE))
+    {
+        if (gs_uhf_recv_frame(rx->radio, fec, &rssi, 0) == GST_TOUT)
+        {
+            usleep(1000);
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Brings a radio to the profile asked for as loop_modem_cb() does, retrying every GS_MODEM_RETRY_MS.
+ * 
+ * @return int The last gs_modem_apply().
+ */
+static int bench_apply(gs_modem_ctl_t *ctl, gs_radio_t *radio)
+{
+    int retval;
+    while ((retval = gs_modem_apply(ctl, radio)) == -1)
+    {
+        usleep(GS_MODEM_RETRY_MS * 1000);
+    }
+    if (retval >= 0 && ctl->asked_ns != 0)
+    {
+        gs_modem_settle(ctl, gs_time_ns());
+    }
+    return retval;
+}
+
+/**
+ * @brief Switches a simulated radio back and forth while it beacons and is uplinked on.
+ * 
+ * @param direct Switch straight through the backend, past the arbiter, as a control.
+ * @param switch_ms Set to the longest a switch took, from being asked for.
+ * @return int Failed checks.
+ */
+static int check_switch(bool direct, double *switch_ms)
+{
+    int failures = 0;
+    char options[96];
+    snprintf(options, sizeof(options), "rate=%d,awgn,rssi=-90,beacon=20,duty=%g", BENCH_LOW_RATE, BENCH_DUTY);
+    gs_radio_t *radio = bench_sim(options);
+    gs_modem_ctl_t *ctl = gs_modem_create(false);
+    CHECK(radio != nullptr && ctl != nullptr);
+    if (radio == nullptr || ctl == nullptr)
+    {
+        gs_modem_destroy(ctl);
+        return failures;
+    }
+
+    bench_tx_t tx[1] = {{radio, false, 0}};
+    bench_rx_t rx[1] = {{radio, false}};
+    pthread_t tx_tid, rx_tid;
+    pthread_create(&tx_tid, NULL, bench_tx_side, tx);
+    pthread_create(&rx_tid, NULL, bench_rx_side, rx);
+    int results[4] = {0, 0, 0, 0};
+    if (direct)
+    {
+        uint64_t end = gs_time_ns() + BENCH_DIRECT_S * NSEC_PER_SEC;
+        for (int i = 0; gs_time_ns() < end; i++)
+        {
+            uint32_t rate = i % 2 ? BENCH_LOW_RATE : BENCH_HIGH_RATE;
+            gs_modem_t modem = {rate, rate / 2, SIM_DEFAULT_PREAMBLE, SIM_DEFAULT_POWER};
+            radio->ops->configure(radio, &modem);
+            usleep(GS_MODEM_RETRY_MS * 1000);
+        }
+    }
+    else
+    {
+        for (int i = 0; i < BENCH_SWITCHES; i++)
+        {
+            uint32_t rate = i % 2 ? BENCH_LOW_RATE : BENCH_HIGH_RATE;
+            gs_modem_t modem = {rate, rate / 2, 0, 0};
+            gs_modem_request(ctl, &modem, GS_ADAPT_KEEP, gs_time_ns());
+            results[-bench_apply(ctl, radio) + 1]++;
+            CHECK(radio->modem.bitrate == rate && radio->modem.deviation_hz == rate / 2);
+            // Off the beat of the bursts, so the switches fall all over them.
+            usleep(40000 + (i * 37 % 11) * 10000);
+        }
+    }
+    __atomic_store_n(&tx->done, true, __ATOMIC_RELEASE);
+    __atomic_store_n(&rx->done, true, __ATOMIC_RELEASE);
+    pthread_join(tx_tid, NULL);
+    pthread_join(rx_tid, NULL);
+
+    gs_sim_stats_t sim[1];
+    gs_radio_sim_stats(radio, sim);
+    printf("modem: %s, %llu switches, %llu refused while a frame arrived, %llu landed mid-frame (%llu bursts, %llu beacons).\n",
+           direct ? "straight to the radio" : "through gs_modem_apply()", (unsigned long long)sim->reconfigs,
+           (unsigned long long)sim->reconfigs_busy, (unsigned long long)sim->reconfigs_mid_frame, (unsigned long long)tx->bursts,
+           (unsigned long long)sim->downlink_sent);
+    CHECK(sim->downlink_sent > 0 && tx->bursts > 0);
+    if (direct)
+    {
+        CHECK(sim->reconfigs_mid_frame > 0);
+    }
+    else
+    {
+        CHECK(sim->reconfigs_mid_frame == 0);
+        CHECK(results[0] == BENCH_SWITCHES && (int)sim->reconfigs == BENCH_SWITCHES);
+        CHECK(ctl->stats.switches == BENCH_SWITCHES && ctl->stats.settled == BENCH_SWITCHES);
+        *switch_ms = ctl->stats.switch_max_ns / 1e6;
+        printf("modem: %llu switches put off, in effect %.1f ms on average and %.1f ms at most after being asked for.\n",
+               (unsigned long long)ctl->stats.deferred, ctl->stats.switch_sum_ns / 1e6 / ctl->stats.settled, *switch_ms);
+        // Held off by a burst at most, at the lower rate, and a downlink frame.
+        CHECK(*switch_ms < 4 * sizeof(gst_fec_frame_t) * 8 * 1e3 / BENCH_LOW_RATE + 100);
+    }
+    gs_radio_destroy(radio);
+    gs_modem_destroy(ctl);
+    return failures;
+}
+
+typedef struct
+{
+    uint32_t bitrate; // To start with.
+    bool adapt;       // Or hold it throughout.
+    int failures;
+    uint64_t good;    // Frames brought down.
+    uint32_t top;     // Highest rate in effect.
+    uint32_t end;     // Rate in effect at the end.
+    uint64_t mid_frame;
+} bench_pass_t;
+
+static void *bench_pass_thread(void *args)
+{
+    bench_pass_t *pass = (bench_pass_t *)args;
+    int failures = 0;
+    char options[96];
+    snprintf(options, sizeof(options), "rate=%u,awgn,rssi=%d,beacon=1000,duty=%g", pass->bitrate, BENCH_PASS_FLOOR, BENCH_PASS_DUTY);
+    gs_radio_t *radio = bench_sim(options);
+    gs_modem_ctl_t *ctl = gs_modem_create(pass->adapt);
+    CHECK(radio != nullptr && ctl != nullptr);
+    if (radio == nullptr || ctl == nullptr)
+    {
+        gs_modem_destroy(ctl);
+        pass->failures = failures;
+        return nullptr;
+    }
+
+    bench_rx_t rx[1] = {{radio, false}};
+    pthread_t rx_tid;
+    pthread_create(&rx_tid, NULL, bench_rx_side, rx);
+    pass->top = radio->modem.bitrate;
+    uint64_t start = gs_time_ns();
+    uint64_t next_window = start + BENCH_WINDOW_MS * NSEC_PER_MSEC;
+    for (uint64_t now = start; now < start + BENCH_PASS_S * NSEC_PER_SEC; now = gs_time_ns())
+    {
+        double t = (now - start) / 1e9 / BENCH_PASS_S;
+        gs_radio_sim_set_rssi(radio, (int16_t)lround(BENCH_PASS_FLOOR + BENCH_PASS_DB * sin(M_PI * t)));
+        if (pass->adapt && now >= next_window)
+        {
+            next_window += BENCH_WINDOW_MS * NSEC_PER_MSEC;
+            gs_link_t link = {__atomic_load_n(&radio->link.good, __ATOMIC_RELAXED), __atomic_load_n(&radio->link.bad, __ATOMIC_RELAXED),
+                              __atomic_load_n(&radio->link.rssi_sum, __ATOMIC_RELAXED)};
+            uint32_t bitrate = radio->modem.bitrate;
+            uint32_t to = gs_adapt_window(&ctl->rate, bitrate, &link);
+            if (to != 0)
+            {
+                gs_modem_t step = {to, (uint32_t)((uint64_t)radio->modem.deviation_hz * to / bitrate), 0, 0};
+                gs_modem_request(ctl, &step, GS_ADAPT_KEEP, now);
+                CHECK(bench_apply(ctl, radio) == 1);
+                pass->top = radio->modem.bitrate > pass->top ? radio->modem.bitrate : pass->top;
+            }
+        }
+        usleep(BENCH_STEP_MS * 1000);
+    }
+    __atomic_store_n(&rx->done, true, __ATOMIC_RELEASE);
+    pthread_join(rx_tid, NULL);
+
+    gs_sim_stats_t sim[1];
+    gs_radio_sim_stats(radio, sim);
+    pass->good = __atomic_load_n(&radio->link.good, __ATOMIC_RELAXED);
+    pass->end = radio->modem.bitrate;
+    pass->mid_frame = sim->reconfigs_mid_frame;
+    printf("modem: pass %s %u bps, %llu frames good and %llu bad of %llu sent%s.\n", pass->adapt ? "adapting from" : "held at",
+           pass->bitrate, (unsigned long long)pass->good, (unsigned long long)__atomic_load_n(&radio->link.bad, __ATOMIC_RELAXED),
+           (unsigned long long)sim->downlink_sent, pass->adapt ? "" : ", never adapting");
+    if (pass->adapt)
+    {
+        printf("modem: stepped up %llu and down %llu times, up to %u bps and back to %u bps.\n", (unsigned long long)ctl->rate.ups,
+               (unsigned long long)ctl->rate.downs, pass->top, pass->end);
+    }
+    gs_radio_destroy(radio);
+    gs_modem_destroy(ctl);
+    pass->failures = failures;
+    return nullptr;
+}
+
+/**
+ * @brief Runs the same pass on a radio adapting its data rate and on radios held at fixed ones.
+ * 
+ * @param gain Set to how many times more frames the adaptive one brought down than the best fixed one.
+ * @return int Failed checks.
+ */
+static int check_pass(double *gain)
+{
+    int failures = 0;
+    bench_pass_t passes[] = {
+        {4800, true, 0, 0, 0, 0, 0},
+        {4800, false, 0, 0, 0, 0, 0},
+        {9600, false, 0, 0, 0, 0, 0},
+        {19200, false, 0, 0, 0, 0, 0},
+    };
+    int count = sizeof(passes) / sizeof(passes[0]);
+    pthread_t tids[sizeof(passes) / sizeof(passes[0])];
+    for (int i = 0; i < count; i++)
+    {
+        pthread_create(&tids[i], NULL, bench_pass_thread, &passes[i]);
+    }
+    uint64_t best = 0;
+    for (int i = 0; i < count; i++)
+    {
+        pthread_join(tids[i], NULL);
+        failures += passes[i].failures;
+        best = !passes[i].adapt && passes[i].good > best ? passes[i].good : best;
+    }
+
+    const bench_pass_t *adaptive = &passes[0];
+    // Up to the top of the ladder near the highest point, and back down toward the rate the ends carry.
+    CHECK(adaptive->top >= 19200);
+    CHECK(adaptive->end <= 9600);
+    CHECK(adaptive->mid_frame == 0);
+    *gain = best ? (double)adaptive->good / best : 0;
+    printf("modem: adapting brought down %.2f times the frames of the best fixed rate.\n", *gain);
+    CHECK(*gain > 1);
+    return failures;
+}
+
+int main(void)
+{
+    int failures = 0;
+    failures += check_parse();
+    failures += check_window();
+
+    double switch_ms = 0, unused = 0;
+    failures += check_switch(false, &switch_ms);
+    failures += check_switch(true, &unused);
+
+    double gain = 0;
+    failures += check_pass(&gain);
+
+    gs_bench_report("modem", "switch_max", switch_ms, "ms", GS_BENCH_LOWER, 50);
+    gs_bench_report("modem", "pass_frames_gain", gain, "x", GS_BENCH_HIGHER, 25);
+
+    if (failures)
+    {
+        dbprintlf(FATAL "%d modem checks failed.", failures);
+        return 1;
+    }
+    return 0;
+}
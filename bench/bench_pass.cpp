@@ -0,0 +1,341 @@
+/**
+ * @file bench_pass.cpp
+ * @author agent (agent@local)
+ * @brief Checks SGP4 against the published test vectors and pass prediction against a one-second scan, then times both.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * The vectors are from Vallado et al. (AIAA 2006-6753), tcppver.out. Passes are predicted for an ISS element
+ * set from a station near Lowell, MA, relative to the set's epoch, so the results do not depend on the clock.
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "gs_pass.hpp"
+#include "gs_bench.hpp"
+#include "gs_time.hpp"
+#include "meb_debug.hpp"
+
+#define BENCH_SCAN_S (24 * 3600)
+#define BENCH_PROPAGATIONS 200000
+#define BENCH_PLANS 20
+#define BENCH_TLE_PATH "/tmp/bench_pass.tle"
+
+#define CHECK(cond)                                       \
+    do                                                    \
+    {                                                     \
+        if (!(cond))                                      \
+        {                                                 \
+            dbprintlf(RED_FG "Check failed: %s", #cond); \
+            failures++;                                   \
+        }                                                 \
+    } while (0)
+
+static const char *tle_00005[2] = {"1 00005U 58002B   00179.78495062  .00000023  00000-0  28098-4 0  4753",
+                                   "2 00005  34.2682 348.7242 1859667 331.7664  19.3264 10.82419157413667"};
+static const char *tle_06251[2] = {"1 06251U 62025E   06176.82412014  .00008885  00000-0  12808-3 0  3985",
+                                   "2 06251  58.0579  54.0425 0030035 139.1568 221.1854 15.56387291  6774"};
+static const char *tle_iss[2] = {"1 25544U 98067A   08264.51782528 -.00002182  00000-0 -11606-4 0  2927",
+                                 "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.72125391563537"};
+
+typedef struct
+{
+    const char **tle;
+    double tsince;
+    double r[3];
+    double v[3];
+} bench_vector_t;
+
+static const bench_vector_t vectors[] = {
+    {tle_00005, 0, {7022.46529266, -1400.08296755, 0.03995155}, {1.893841015, 6.405893759, 4.534807250}},
+    {tle_00005, 360, {-7154.03120202, -3783.17682504, -3536.19412294}, {4.741887409, -4.151817765, -2.093935425}},
+    {tle_00005, 720, {-7134.59340119, 6531.68641334, 3260.27186483}, {-4.113793027, -2.911922039, -2.557327851}},
+    {tle_06251, 0, {3988.31022699, 5498.96657235, 0.90055879}, {-3.290032738, 2.357652820, 6.496623475}},
+    {tle_06251, 120, {-3935.69800083, 409.10980837, 5471.33577327}, {-3.374784183, -6.635211043, -1.942056221}},
+};
+
+/**
+ * @brief Propagates the test vectors' element sets and compares, and checks that malformed sets are refused.
+ * 
+ * @return int Failed checks.
+ */
+static int check_sgp4(void)
+{
+    int failures = 0;
+    gs_tle_t tle[1];
+    gs_sgp4_t sat[1];
+    double worst_r = 0, worst_v = 0;
+    for (size_t i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++)
+    {
+        const bench_vector_t *vec = &vectors[i];
+        double r[3], v[3];
+        CHECK(gs_tle_parse(nullptr, vec->tle[0], vec->tle[1], tle));
+        CHECK(gs_sgp4_init(sat, tle));
+        CHECK(gs_sgp4_propagate(sat, vec->tsince, r, v));
+        for (int k = 0; k < 3; k++)
+        {
+            worst_r = fmax(worst_r, fabs(r[k] - vec->r[k]));
+            worst_v = fmax(worst_v, fabs(v[k] - vec->v[k]));
+        }
+    }
+    printf("pass: SGP4 against the test vectors, worst %.2e km, %.2e km/s.\n", worst_r, worst_v);
+    CHECK(worst_r < 1e-5);
+    CHECK(worst_v < 1e-8);
+
+    // One digit off, and the checksum catches it.
+    char line[GS_TLE_LINE_MAX];
+    snprintf(line, sizeof(line), "%s", tle_iss[1]);
+    line[10] = '7';
+    CHECK(!gs_tle_parse(nullptr, tle_iss[0], line, tle));
+    CHECK(!gs_tle_parse(nullptr, tle_iss[1], tle_iss[0], tle));
+    CHECK(!gs_tle_parse(nullptr, "1 25544U", tle_iss[1], tle));
+    CHECK(gs_tle_parse("ISS (ZARYA)", tle_iss[0], tle_iss[1], tle) && tle->catnum == 25544 && strcmp(tle->name, "ISS (ZARYA)") == 0);
+    return failures;
+}
+
+/**
+ * @brief Predicts a day of passes and compares them with a scan of the elevation every second.
+ * 
+ * @return int Failed checks.
+ */
+static int check_passes(const gs_sgp4_t *sat, const gs_station_t *station)
+{
+    int failures = 0;
+    double from = sat->tle.epoch;
+    gs_pass_t passes[GS_PASS_MAX];
+    uint64_t propagations = 0;
+    int count = gs_pass_find(sat, station, 0, from, from + BENCH_SCAN_S, passes, GS_PASS_MAX, &propagations);
+
+    gs_pass_t scan[GS_PASS_MAX];
+    int scanned = 0;
+    gs_look_t look;
+    bool up = gs_sgp4_look(sat, station, from, &look) && look.el >= 0;
+    double highest = 0;
+    for (double t = from + 1; t <= from + BENCH_SCAN_S + 3600 && scanned < GS_PASS_MAX; t += 1)
+    {
+        bool now_up = gs_sgp4_look(sat, station, t, &look) && look.el >= 0;
+        if (now_up && !up)
+        {
+            scan[scanned].aos = t;
+            highest = look.el;
+        }
+        else if (now_up)
+        {
+            highest = fmax(highest, look.el);
+        }
+        else if (up && t > from + 1)
+        {
+            scan[scanned].los = t;
+            scan[scanned++].max_el = highest;
+            if (t > from + BENCH_SCAN_S)
+            {
+                break;
+            }
+        }
+        up = now_up;
+    }
+
+    // Passes too short to be seen at every coarse step may be missed, and that is all that may differ.
+    int matched = 0;
+    double worst = 0, worst_el = 0;
+    for (int i = 0, j = 0; i < scanned; i++)
+    {
+        if (j < count && fabs(passes[j].aos - scan[i].aos) < 2)
+        {
+            worst = fmax(worst, fmax(fabs(passes[j].aos - scan[i].aos), fabs(passes[j].los - scan[i].los)));
+            worst_el = fmax(worst_el, scan[i].max_el - passes[j].max_el);
+            matched++;
+            j++;
+        }
+        else
+        {
+            CHECK(scan[i].los - scan[i].aos < GS_PASS_STEP_S);
+        }
+    }
+    printf("pass: %d passes in %d h (%d in the scan), AOS and LOS within %.2f s, max elevation within %.4f deg; %llu propagations.\n",
+           count, BENCH_SCAN_S / 3600, scanned, worst, worst_el * 180 / M_PI, (unsigned long long)propagations);
+    CHECK(count >= 4);
+    CHECK(matched == count);
+    // The scan rounds to a second either way.
+    CHECK(worst <= 1 + GS_PASS_TOL_S);
+    CHECK(worst_el <= 0.01 * M_PI / 180);
+    for (int i = 0; i < count; i++)
+    {
+        CHECK(passes[i].aos < passes[i].tca && passes[i].tca < passes[i].los);
+        CHECK(i == 0 || passes[i - 1].los < passes[i].aos);
+    }
+
+    // Started mid-pass, the pass is found whole.
+    gs_pass_t mid[1];
+    double t = (passes[0].aos + passes[0].los) / 2;
+    CHECK(gs_pass_find(sat, station, 0, t, t + 60, mid, 1, nullptr) == 1 && fabs(mid->aos - passes[0].aos) < 2 * GS_PASS_TOL_S &&
+          fabs(mid->los - passes[0].los) < 2 * GS_PASS_TOL_S);
+    return failures;
+}
+
+/**
+ * @brief Checks that the plan only predicts what it has not: nothing for a reload of the same set, only the
+ * new stretch as time moves on.
+ * 
+ * @return int Failed checks.
+ */
+static int check_plan(const gs_station_t *station)
+{
+    int failures = 0;
+    FILE *fp = fopen(BENCH_TLE_PATH, "w");
+    if (fp == nullptr)
+    {
+        dbprintlf(RED_FG "Cannot write %s.", BENCH_TLE_PATH);
+        return 1;
+    }
+    fprintf(fp, "%s\n%s\nISS (ZARYA)\n%s\n%s\n", tle_00005[0], tle_00005[1], tle_iss[0], tle_iss[1]);
+    fclose(fp);
+
+    gs_pass_plan_t *plan = gs_pass_plan_create(station, 0, 24 * 3600);
+    CHECK(plan != nullptr);
+    if (plan == nullptr)
+    {
+        return failures;
+    }
+    CHECK(gs_pass_plan_reload(plan, "/nonexistent/bench_pass.tle", 0, 0) < 0);
+    CHECK(!plan->have_sat);
+    CHECK(gs_pass_plan_reload(plan, BENCH_TLE_PATH, 99999, 0) < 0);
+
+    gs_tle_t tle[1];
+    gs_tle_parse(nullptr, tle_iss[0], tle_iss[1], tle);
+    double now = tle->epoch;
+    CHECK(gs_pass_plan_reload(plan, BENCH_TLE_PATH, 25544, now) == 1);
+    CHECK(plan->have_sat && plan->sat.tle.catnum == 25544 && strcmp(plan->sat.tle.name, "ISS (ZARYA)") == 0);
+    int count = plan->count;
+    uint64_t full = plan->stats.propagations;
+
+    // Unchanged file: not even read. Same set again: nothing predicted.
+    CHECK(gs_pass_plan_reload(plan, nullptr, 0, now + 60) == 0);
+    CHECK(gs_pass_plan_set(plan, tle, now + 60) == 0);
+    CHECK(plan->stats.propagations == full && plan->stats.unchanged == 1 && plan->count == count);
+
+    // An hour on: passes that ended drop off, and only the hour at the end of the horizon is predicted.
+    const gs_pass_t *first = gs_pass_plan_next(plan, now);
+    double first_los = first != nullptr ? first->los : 0;
+    gs_pass_plan_update(plan, now + 3600);
+    uint64_t extended = plan->stats.propagations - full;
+    printf("pass: a day predicted with %llu propagations; an hour more with %llu, a reload of the same set with none.\n", (unsigned long long)full,
+           (unsigned long long)extended);
+    CHECK(extended > 0 && extended < full / 8);
+    CHECK(plan->until == now + 3600 + 24 * 3600);
+    CHECK(plan->stats.predictions == 2);
+    const gs_pass_t *next = gs_pass_plan_next(plan, now + 3600);
+    CHECK(next != nullptr && next->los >= now + 3600);
+    CHECK(first_los >= now + 3600 || plan->passes[0].aos > first_los);
+
+    // Against a plan predicted in one go, the extended one has the same passes.
+    gs_pass_t whole[GS_PASS_MAX];
+    int n = gs_pass_find(&plan->sat, &plan->station, 0, now + 3600, plan->until, whole, GS_PASS_MAX, nullptr);
+    CHECK(n == plan->count);
+    for (int i = 0; i < n && i < plan->count; i++)
+    {
+        CHECK(fabs(whole[i].aos - plan->passes[i].aos) < 2 * GS_PASS_TOL_S && fabs(whole[i].los - plan->passes[i].los) < 2 * GS_PASS_TOL_S);
+    }
+
+    // A newer set for the spacecraft re-predicts from now on.
+    gs_tle_t newer = *tle;
+    newer.epoch += 3600;
+    CHECK(gs_pass_plan_set(plan, &newer, now + 3600) == 1);
+    CHECK(plan->stats.loads == 2 && plan->stats.predictions == 3);
+    gs_pass_plan_destroy(plan);
+    unlink(BENCH_TLE_PATH);
+    return failures;
+}
+
+static void *bench_gate_thread(void *args)
+{
+    gs_pass_plan_t *plan = (gs_pass_plan_t *)args;
+    gs_pass_gate_wait(plan);
+    return nullptr;
+}
+
+/**
+ * @brief Checks the gate holds a thread while closed, and lets it go when opened or stopped.
+ * 
+ * @return int Failed checks.
+ */
+static int check_gate(const gs_station_t *station)
+{
+    int failures = 0;
+    gs_pass_plan_t *plan = gs_pass_plan_create(station, 0, 3600);
+    CHECK(gs_pass_gate_open(plan));
+    for (int stop = 0; stop < 2; stop++)
+    {
+        gs_pass_gate_set(plan, false);
+        CHECK(!gs_pass_gate_open(plan));
+        pthread_t tid;
+        pthread_create(&tid, NULL, bench_gate_thread, plan);
+        usleep(20000);
+        CHECK(pthread_tryjoin_np(tid, NULL) != 0);
+        if (stop)
+        {
+            gs_pass_gate_stop(plan);
+        }
+        else
+        {
+            gs_pass_gate_set(plan, true);
+        }
+        pthread_join(tid, NULL);
+    }
+    // Stopped, it no longer blocks.
+    gs_pass_gate_wait(plan);
+    gs_pass_plan_destroy(plan);
+    return failures;
+}
+
+int main(void)
+{
+    int failures = check_sgp4();
+
+    gs_station_t station[1] = {{42.6526 * M_PI / 180, -71.3247 * M_PI / 180, 0.03, {0, 0, 0}}};
+    gs_sgp4_station(station);
+    gs_tle_t tle[1];
+    gs_sgp4_t sat[1];
+    gs_tle_parse(nullptr, tle_iss[0], tle_iss[1], tle);
+    gs_sgp4_init(sat, tle);
+    failures += check_passes(sat, station);
+    failures += check_plan(station);
+    failures += check_gate(station);
+
+    double r[3], v[3];
+    volatile double sink = 0;
+    uint64_t start = gs_time_ns();
+    for (int i = 0; i < BENCH_PROPAGATIONS; i++)
+    {
+        gs_sgp4_propagate(sat, i * 0.01, r, v);
+        sink = sink + r[0];
+    }
+    double per_ns = (double)(gs_time_ns() - start) / BENCH_PROPAGATIONS;
+
+    gs_pass_t passes[GS_PASS_MAX];
+    uint64_t propagations = 0;
+    start = gs_time_ns();
+    for (int i = 0; i < BENCH_PLANS; i++)
+    {
+        gs_pass_find(sat, station, 0, tle->epoch + i * 60, tle->epoch + i * 60 + 24 * 3600, passes, GS_PASS_MAX, &propagations);
+    }
+    double day_ms = (gs_time_ns() - start) / 1e6 / BENCH_PLANS;
+    printf("pass: %.0f ns per propagation, a day of passes in %.2f ms (%llu propagations).\n", per_ns, day_ms,
+           (unsigned long long)(propagations / BENCH_PLANS));
+    gs_bench_report("pass", "propagate", per_ns, "ns/propagation", GS_BENCH_LOWER, 0);
+    gs_bench_report("pass", "predict_day", day_ms, "ms/day", GS_BENCH_LOWER, 0);
+
+    if (failures)
+    {
+        dbprintlf(FATAL "%d pass prediction checks failed.", failures);
+        return 1;
+    }
+    return 0;
+}
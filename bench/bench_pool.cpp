@@ -0,0 +1,172 @@
+/**
+ * @file bench_pool.cpp
+ * @author agent (agent@local)
+ * @brief Checks that the steady-state frame paths make no heap allocations, then compares pooled and heap NetFrames.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gs_uhf.hpp"
+#include "gs_ring.hpp"
+#include "gs_pool.hpp"
+#include "gs_alloc.hpp"
+#include "gs_bench.hpp"
+#include "gs_time.hpp"
+#include "meb_debug.hpp"
+
+#define WARMUP_FRAMES 1000
+#define CHECK_FRAMES 100000
+#define BENCH_FRAMES 1000000
+
+static volatile int sink;
+
+/**
+ * @brief One downlink frame and one uplink frame through every path main.cpp wires up, minus the sockets.
+ * 
+ * UHF RX into the ring, ring to a pooled DATA NetFrame, a pooled empty NetFrame and payload buffer for the
+ * network RX side, and a pooled NACK.
+ * 
+ * @param ring 
+ * @param netframe_pool 
+ * @param payload_pool 
+ * @param seq 
+ * @return int 1 on success, 0 on failure.
+ */
+static int frame_cycle(gs_ring_t *ring, gs_pool_t *netframe_pool, gs_pool_t *payload_pool, int seq)
+{
+    gs_ring_slot_t *slot = gs_ring_reserve(ring);
+    if (slot == nullptr)
+    {
+        return 0;
+    }
+    memset(slot->frame.payload, seq, GST_MAX_PAYLOAD_SIZE);
+    slot->len = sizeof(cmd_output_t);
+    gs_ring_commit(ring);
+
+    slot = gs_ring_peek(ring);
+    NetFrame *data = gs_pool_netframe(netframe_pool, slot->frame.payload, slot->len, NetType::DATA, NetVertex::CLIENT);
+    gs_ring_release(ring);
+
+    NetFrame *rx = gs_pool_netframe(netframe_pool);
+    unsigned char *payload = (unsigned char *)gs_pool_get(payload_pool);
+    if (data == nullptr || rx == nullptr || payload == nullptr || data->retrievePayload(payload, sizeof(cmd_output_t)) < 0)
+    {
+        return 0;
+    }
+    sink = payload[0];
+
+    cs_ack_t nack[1];
+    nack->ack = 0;
+    nack->code = NACK_NO_UHF;
+    NetFrame *nack_frame = gs_pool_netframe(netframe_pool, (unsigned char *)nack, sizeof(nack), NetType::NACK, NetVertex::CLIENT);
+
+    gs_pool_netframe_put(netframe_pool, nack_frame);
+    gs_pool_put(payload_pool, payload);
+    gs_pool_netframe_put(netframe_pool, rx);
+    gs_pool_netframe_put(netframe_pool, data);
+    return nack_frame != nullptr;
+}
+
+/**
+ * @brief Heap allocations so far: operator new's (gs_alloc.hpp), and the blocks either pool had to take from
+ * the heap, which gs_pool_get() counts as misses.
+ */
+static uint64_t heap_allocs(gs_pool_t *netframe_pool, gs_pool_t *payload_pool)
+{
+    gs_pool_stats_t netframe[1], payload[1];
+    gs_pool_get_stats(netframe_pool, netframe);
+    gs_pool_get_stats(payload_pool, payload);
+    return gs_alloc_count() + netframe->misses + payload->misses;
+}
+
+int main(void)
+{
+    gs_ring_t *ring = gs_ring_create(UHF_RX_RING_SIZE);
+    gs_pool_t *netframe_pool = gs_pool_create("NetFrame", sizeof(NetFrame), NETFRAME_POOL_SIZE);
+    gs_pool_t *payload_pool = gs_pool_create("Payload", NETFRAME_MAX_PAYLOAD_SIZE, PAYLOAD_POOL_SIZE);
+    if (ring == nullptr || netframe_pool == nullptr || payload_pool == nullptr)
+    {
+        return 1;
+    }
+
+    for (int i = 0; i < WARMUP_FRAMES; i++)
+    {
+        frame_cycle(ring, netframe_pool, payload_pool, i);
+    }
+
+    uint64_t allocs = heap_allocs(netframe_pool, payload_pool);
+    for (int i = 0; i < CHECK_FRAMES; i++)
+    {
+        if (!frame_cycle(ring, netframe_pool, payload_pool, i))
+        {
+            dbprintlf(FATAL "Frame cycle %d failed.", i);
+            return 1;
+        }
+    }
+    allocs = heap_allocs(netframe_pool, payload_pool) - allocs;
+    if (allocs != 0)
+    {
+        dbprintlf(FATAL "%llu heap allocations over %d frames after warm-up, expected none.", (unsigned long long)allocs, CHECK_FRAMES);
+        return 1;
+    }
+    printf("pool: 0 heap allocations over %d frames after warm-up.\n", CHECK_FRAMES);
+
+    // Back-pressure: a full TX queue, its spare retry slot and every block in flight still come from the pool.
+    const int queued = UHF_TX_QUEUE_SIZE + 1;
+    void *held[queued + PAYLOAD_POOL_IN_FLIGHT];
+    gs_pool_stats_t before[1], after[1];
+    gs_pool_get_stats(payload_pool, before);
+    for (int i = 0; i < queued + PAYLOAD_POOL_IN_FLIGHT; i++)
+    {
+        held[i] = gs_pool_get(payload_pool);
+    }
+    gs_pool_get_stats(payload_pool, after);
+    for (int i = 0; i < queued + PAYLOAD_POOL_IN_FLIGHT; i++)
+    {
+        gs_pool_put(payload_pool, held[i]);
+    }
+    if (after->misses != before->misses)
+    {
+        dbprintlf(FATAL "%llu payload blocks came from the heap with the TX queue full, expected none.", (unsigned long long)(after->misses - before->misses));
+        return 1;
+    }
+    printf("pool: a full TX queue (%d) and %d blocks in flight fit the payload pool.\n", queued, PAYLOAD_POOL_IN_FLIGHT);
+
+    uint8_t payload[GST_MAX_PAYLOAD_SIZE] = {0};
+    uint64_t start = gs_time_ns();
+    for (int i = 0; i < BENCH_FRAMES; i++)
+    {
+        NetFrame *frame = new NetFrame(payload, sizeof(payload), NetType::DATA, NetVertex::CLIENT);
+        sink = frame->getPayloadSize();
+        delete frame;
+    }
+    double heap_ns = (double)(gs_time_ns() - start) / BENCH_FRAMES;
+
+    start = gs_time_ns();
+    for (int i = 0; i < BENCH_FRAMES; i++)
+    {
+        NetFrame *frame = gs_pool_netframe(netframe_pool, payload, sizeof(payload), NetType::DATA, NetVertex::CLIENT);
+        sink = frame->getPayloadSize();
+        gs_pool_netframe_put(netframe_pool, frame);
+    }
+    double pool_ns = (double)(gs_time_ns() - start) / BENCH_FRAMES;
+
+    printf("%-16s %10s\n", "NetFrame", "ns/frame");
+    printf("%-16s %10.1f\n", "new/delete", heap_ns);
+    printf("%-16s %10.1f\n", "pool", pool_ns);
+    gs_bench_report("pool", "netframe_new_delete", heap_ns, "ns/frame", GS_BENCH_LOWER, 0);
+    gs_bench_report("pool", "netframe_pool", pool_ns, "ns/frame", GS_BENCH_LOWER, 0);
+
+    gs_pool_print_stats(netframe_pool);
+    gs_pool_print_stats(payload_pool);
+    gs_pool_destroy(netframe_pool);
+    gs_pool_destroy(payload_pool);
+    gs_ring_destroy(ring);
+    return 0;
+}
@@ -0,0 +1,254 @@
+/**
+ * @file bench_reactor.cpp
+ * @author agent (agent@local)
+ * @brief Measures the downlink path through the event loop: wakeups and context switches per frame, and latency from the far end to the server.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * A simulated spacecraft sends timestamped frames at a fixed rate; a stand-in server on a socketpair reads
+ * them back as NetFrames. The inline mode reads the radio in the event loop; the threaded mode reads it on
+ * gs_uhf_rx_thread() and hands frames to the loop through the RX ring, the way every frame used to cross
+ * from the radio thread to the network writer.
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include "gs_uhf.hpp"
+#include "gs_reactor.hpp"
+#include "gs_ring.hpp"
+#include "gs_tx.hpp"
+#include "gs_sar.hpp"
+#include "gs_radio.hpp"
+#include "gs_bench.hpp"
+#include "gs_time.hpp"
+#include "gs_log.hpp"
+#include "meb_debug.hpp"
+
+#define BENCH_FRAMES 2000
+#define BENCH_RATE_HZ 1000
+#define BENCH_MAGIC 0x6265616d
+#define BENCH_TIMEOUT_S 10
+
+typedef struct __attribute__((packed))
+{
+    uint32_t magic;
+    uint32_t seq;
+    uint64_t send_ns;
+} bench_payload_t;
+
+typedef struct
+{
+    NetDataClient *server; // Far end of the socketpair.
+    uint64_t latency_ns[BENCH_FRAMES];
+    int received;
+} bench_server_t;
+
+static void *bench_server_thread(void *args)
+{
+    bench_server_t *server = (bench_server_t *)args;
+    NetFrame *netframe = new NetFrame();
+    unsigned char payload[NETFRAME_MAX_PAYLOAD_SIZE];
+
+    while (server->received < BENCH_FRAMES && netframe->recvFrame(server->server) >= 0)
+    {
+        uint64_t now = gs_time_ns();
+        int size = netframe->getPayloadSize();
+        if (netframe->getType() != NetType::DATA || size < (int)sizeof(bench_payload_t) || netframe->retrievePayload(payload, size) < 0)
+        {
+            continue;
+        }
+        bench_payload_t *data = (bench_payload_t *)payload;
+        if (data->magic == BENCH_MAGIC)
+        {
+            server->latency_ns[server->received] = now - data->send_ns;
+            __atomic_store_n(&server->received, server->received + 1, __ATOMIC_RELEASE);
+        }
+    }
+    delete netframe;
+    return nullptr;
+}
+
+typedef struct
+{
+    global_data_t *global;
+    bool rx_thread;
+} bench_loop_t;
+
+static void *bench_loop_thread(void *args)
+{
+    bench_loop_t *loop = (bench_loop_t *)args;
+    gs_uhf_event_loop(loop->global, loop->rx_thread);
+    return nullptr;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * @brief Runs BENCH_FRAMES downlinks through one configuration.
+ * 
+ * Frames the radio's FIFO overran on (the reader was not scheduled in time) are reported, not failed:
+ * the si446x has the same two-frame FIFO.
+ * 
+ * @return int 1 if every frame taken off the radio reached the server.
+ */
+static int bench_run(bool rx_thread)
+{
+    gs_sim_config_t config[1];
+    gs_radio_sim_defaults(config);
+    gs_radio_sim_parse(config, "external,rate=0");
+
+    global_data_t global[1];
+    memset(global, 0x0, sizeof(global_data_t));
+    global->radio = gs_radio_sim_create(config);
+    global->uhf_rx_ring = gs_ring_create(UHF_RX_RING_SIZE);
+    global->uhf_tx_queue = gs_tx_queue_create(UHF_TX_QUEUE_SIZE);
+    global->uhf_sar = gs_sar_create(UHF_SAR_MAX_MESSAGE);
+    global->netframe_pool = gs_pool_create("NetFrame", sizeof(NetFrame), NETFRAME_POOL_SIZE);
+    global->payload_pool = gs_pool_create("Payload", NETFRAME_MAX_PAYLOAD_SIZE, PAYLOAD_POOL_SIZE);
+    global->reactor = gs_reactor_create();
+    pthread_mutex_init(&global->net_lock, NULL);
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0)
+    {
+        erprintlf(errno);
+        return 0;
+    }
+    global->network_data = new NetDataClient(NetPort::ROOFUHF, SERVER_POLL_RATE);
+    global->network_data->socket = sv[0];
+    global->network_data->connection_ready = true;
+    global->network_data->thread_status = 1;
+    bench_server_t *server = (bench_server_t *)calloc(1, sizeof(bench_server_t));
+    server->server = new NetDataClient(NetPort::ROOFUHF, SERVER_POLL_RATE);
+    server->server->socket = sv[1];
+    server->server->connection_ready = true;
+
+    pthread_t loop_tid, rx_tid, server_tid;
+    pthread_create(&server_tid, NULL, bench_server_thread, server);
+    bench_loop_t loop = {global, rx_thread};
+    pthread_create(&loop_tid, NULL, bench_loop_thread, &loop);
+    if (rx_thread)
+    {
+        pthread_create(&rx_tid, NULL, gs_uhf_rx_thread, global);
+    }
+    while (!__atomic_load_n(&global->uhf_ready, __ATOMIC_ACQUIRE))
+    {
+        usleep(1000);
+    }
+    usleep(100000);
+
+    gs_reactor_stats_t before[1], after[1];
+    gs_reactor_get_stats(global->reactor, before);
+    uint64_t irq_before = global->radio->irq_stats.wakeups;
+    struct rusage ru_before, ru_after;
+    getrusage(RUSAGE_SELF, &ru_before);
+
+    uint64_t period = NSEC_PER_SEC / BENCH_RATE_HZ;
+    uint64_t next = gs_time_ns();
+    for (int i = 0; i < BENCH_FRAMES; i++)
+    {
+        // One sleep per frame, so the sender adds as few context switches as it can.
+        struct timespec ts = {(time_t)(next / NSEC_PER_SEC), (long)(next % NSEC_PER_SEC)};
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        bench_payload_t data = {BENCH_MAGIC, (uint32_t)i, gs_time_ns()};
+        gst_frame_t frame[1];
+        gs_uhf_frame_build(frame, &data, sizeof(data));
+        gs_radio_sim_far_send(global->radio, frame, sizeof(gst_frame_t));
+        next += period;
+    }
+    // Let the last frames off the air before counting what the radio handed over.
+    usleep(50000);
+    uint64_t deadline = gs_time_ns() + BENCH_TIMEOUT_S * NSEC_PER_SEC;
+    gs_sim_stats_t sim[1];
+    gs_radio_sim_stats(global->radio, sim);
+    while (__atomic_load_n(&server->received, __ATOMIC_ACQUIRE) < (int)sim->downlink_read && gs_time_ns() < deadline)
+    {
+        usleep(1000);
+        gs_radio_sim_stats(global->radio, sim);
+    }
+
+    getrusage(RUSAGE_SELF, &ru_after);
+    gs_reactor_get_stats(global->reactor, after);
+    uint64_t wakeups = after->wakeups - before->wakeups;
+    if (rx_thread)
+    {
+        // The RX thread's IRQ waits, on top of the loop's ring wakeups.
+        wakeups += global->radio->irq_stats.wakeups - irq_before;
+    }
+    long switches = (ru_after.ru_nvcsw - ru_before.ru_nvcsw) + (ru_after.ru_nivcsw - ru_before.ru_nivcsw);
+
+    gs_reactor_stop(global->reactor);
+    pthread_join(loop_tid, NULL);
+    __atomic_store_n(&global->uhf_done, true, __ATOMIC_RELEASE);
+    __atomic_store_n(&global->network_data->thread_status, 0, __ATOMIC_RELEASE);
+    if (rx_thread)
+    {
+        pthread_join(rx_tid, NULL);
+    }
+    shutdown(sv[0], SHUT_RDWR);
+    pthread_join(server_tid, NULL);
+
+    int received = server->received;
+    qsort(server->latency_ns, received, sizeof(uint64_t), cmp_u64);
+    printf("reactor: %-28s %d/%d frames (%d FIFO overruns), %.2f wakeups/frame, %.2f context switches/frame, latency p50 %.1f us, p99 %.1f us.\n",
+           rx_thread ? "RX thread + ring + loop:" : "inline loop:", received, BENCH_FRAMES, BENCH_FRAMES - (int)sim->downlink_read,
+           received ? (double)wakeups / received : 0.0, received ? (double)switches / received : 0.0,
+           received ? server->latency_ns[received / 2] / 1e3 : 0.0, received ? server->latency_ns[received * 99 / 100] / 1e3 : 0.0);
+    if (received)
+    {
+        const char *mode = rx_thread ? "rx_thread" : "inline";
+        char metric[GS_BENCH_NAME_MAX];
+        snprintf(metric, sizeof(metric), "%s_wakeups", mode);
+        gs_bench_report("reactor", metric, (double)wakeups / received, "wakeups/frame", GS_BENCH_LOWER, 25);
+        snprintf(metric, sizeof(metric), "%s_latency_p50", mode);
+        gs_bench_report("reactor", metric, server->latency_ns[received / 2] / 1e3, "us", GS_BENCH_LOWER, 50);
+        snprintf(metric, sizeof(metric), "%s_latency_p99", mode);
+        gs_bench_report("reactor", metric, server->latency_ns[received * 99 / 100] / 1e3, "us", GS_BENCH_LOWER, 200);
+    }
+
+    close(sv[0]);
+    close(sv[1]);
+    delete server->server;
+    free(server);
+    delete global->network_data;
+    gs_reactor_destroy(global->reactor);
+    pthread_mutex_destroy(&global->net_lock);
+    gs_radio_destroy(global->radio);
+    gs_ring_destroy(global->uhf_rx_ring);
+    gs_tx_queue_destroy(global->uhf_tx_queue);
+    gs_sar_destroy(global->uhf_sar);
+    gs_pool_destroy(global->netframe_pool);
+    gs_pool_destroy(global->payload_pool);
+    return received == (int)sim->downlink_read;
+}
+
+int main(void)
+{
+    // Per-frame debug lines would dominate the measurement.
+    gs_log_start("/dev/null");
+    printf("reactor: %d frames at %d Hz from the simulated spacecraft; context switches are process-wide (sender and modem threads included).\n",
+           BENCH_FRAMES, BENCH_RATE_HZ);
+    int inline_ok = bench_run(false);
+    int threaded_ok = bench_run(true);
+    gs_log_stop();
+
+    if (!inline_ok || !threaded_ok)
+    {
+        dbprintlf(FATAL "Frames lost on the downlink path.");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,181 @@
+/**
+ * @file bench_rt.cpp
+ * @author agent (agent@local)
+ * @brief Checks the real-time profile: wakeup latency with and without SCHED_FIFO under a busy CPU, and page faults before and after locking memory.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * A SCHED_OTHER thread spins on the probe's CPU for the whole run, standing in for logging or the network
+ * thread. Wakeup latency is printed and reported, not failed on: how much SCHED_FIFO wins by depends on the
+ * machine. gs_rt_setup() is applied last, since it cannot be undone in this process.
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include "gs_rt.hpp"
+#include "gs_bench.hpp"
+#include "gs_time.hpp"
+#include "gs_log.hpp"
+#include "meb_debug.hpp"
+
+#define BENCH_CPU 0
+#define BENCH_PRIORITY 1 // Lowest SCHED_FIFO priority; still above every SCHED_OTHER thread.
+#define BENCH_INTERVAL_US 500
+#define BENCH_DURATION_MS 2000
+#define BENCH_TOUCH_BYTES (1024 * 1024)
+
+#define CHECK(cond)                                       \
+    do                                                    \
+    {                                                     \
+        if (!(cond))                                      \
+        {                                                 \
+            dbprintlf(RED_FG "Check failed: %s", #cond); \
+            failures++;                                   \
+        }                                                 \
+    } while (0)
+
+/**
+ * @brief Walks the CPU list parser.
+ * 
+ * @return int Failed checks.
+ */
+static int check_parse(void)
+{
+    int failures = 0;
+    cpu_set_t cpus;
+
+    CHECK(gs_rt_parse_cpus("0", &cpus) && CPU_COUNT(&cpus) == 1 && CPU_ISSET(0, &cpus));
+    CHECK(gs_rt_parse_cpus("1,3", &cpus) && CPU_COUNT(&cpus) == 2 && CPU_ISSET(1, &cpus) && CPU_ISSET(3, &cpus));
+    CHECK(gs_rt_parse_cpus("0-2,5", &cpus) && CPU_COUNT(&cpus) == 4 && CPU_ISSET(2, &cpus) && CPU_ISSET(5, &cpus));
+    CHECK(!gs_rt_parse_cpus("", &cpus));
+    CHECK(!gs_rt_parse_cpus("2-1", &cpus));
+    CHECK(!gs_rt_parse_cpus("a", &cpus));
+    CHECK(!gs_rt_parse_cpus("0;1", &cpus));
+    CHECK(!gs_rt_parse_cpus("-1", &cpus));
+    return failures;
+}
+
+static void *bench_spin_thread(void *args)
+{
+    const bool *stop = (const bool *)args;
+    volatile uint64_t spins = 0;
+    while (!__atomic_load_n(stop, __ATOMIC_ACQUIRE))
+    {
+        spins++;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Runs the probe next to a spinning SCHED_OTHER thread.
+ * 
+ * @return int Failed checks, or -1 if the probe could not run with this policy.
+ */
+static int bench_jitter(int priority, gs_rt_jitter_t *jitter)
+{
+    int failures = 0;
+    bool stop = false;
+    pthread_attr_t attr;
+    pthread_t spin_tid;
+    gs_rt_thread_attr(&attr, 0, BENCH_CPU);
+    pthread_create(&spin_tid, &attr, bench_spin_thread, &stop);
+    pthread_attr_destroy(&attr);
+
+    int ok = gs_rt_jitter_run(jitter, priority, BENCH_CPU, BENCH_INTERVAL_US, BENCH_DURATION_MS, nullptr);
+    __atomic_store_n(&stop, true, __ATOMIC_RELEASE);
+    pthread_join(spin_tid, NULL);
+    if (!ok)
+    {
+        return -1;
+    }
+
+    uint64_t counted = jitter->overflow;
+    for (int i = 0; i < GS_RT_HIST_US; i++)
+    {
+        counted += jitter->hist[i];
+    }
+    CHECK(jitter->samples > 0);
+    CHECK(counted == jitter->samples);
+    CHECK(jitter->min_ns <= jitter->max_ns);
+    CHECK(gs_rt_jitter_quantile(jitter, 0.5) <= gs_rt_jitter_quantile(jitter, 0.99));
+    printf("rt: %-12s %6llu wakeups, min %7.1f us, avg %7.1f us, p99 %7.0f us, max %9.1f us.\n", priority ? "SCHED_FIFO:" : "SCHED_OTHER:",
+           (unsigned long long)jitter->samples, jitter->min_ns / 1e3, jitter->samples ? (double)jitter->sum_ns / jitter->samples / 1e3 : 0.0,
+           gs_rt_jitter_quantile(jitter, 0.99) / 1e3, jitter->max_ns / 1e3);
+    return failures;
+}
+
+/**
+ * @brief Counts the page faults taken touching a fresh BENCH_TOUCH_BYTES allocation.
+ */
+static long bench_faults(void)
+{
+    struct rusage before, after;
+    getrusage(RUSAGE_THREAD, &before);
+    uint8_t *block = (uint8_t *)malloc(BENCH_TOUCH_BYTES);
+    for (size_t i = 0; i < BENCH_TOUCH_BYTES; i += 256)
+    {
+        ((volatile uint8_t *)block)[i] = (uint8_t)i;
+    }
+    getrusage(RUSAGE_THREAD, &after);
+    free(block);
+    return after.ru_minflt - before.ru_minflt;
+}
+
+int main(void)
+{
+    gs_log_start("/dev/null");
+    int failures = check_parse();
+
+    printf("rt: probe every %d us for %d ms on CPU %d, with a SCHED_OTHER thread spinning there.\n", BENCH_INTERVAL_US, BENCH_DURATION_MS, BENCH_CPU);
+    gs_rt_jitter_t *jitter = (gs_rt_jitter_t *)malloc(sizeof(gs_rt_jitter_t));
+    int result = bench_jitter(0, jitter);
+    failures += result < 0 ? 1 : result;
+    if (result >= 0)
+    {
+        gs_bench_report("rt", "other_p99", gs_rt_jitter_quantile(jitter, 0.99) / 1e3, "us", GS_BENCH_LOWER, 200);
+    }
+    result = bench_jitter(BENCH_PRIORITY, jitter);
+    if (result < 0)
+    {
+        printf("rt: SCHED_FIFO is not permitted here (needs CAP_SYS_NICE); skipped.\n");
+    }
+    else
+    {
+        failures += result;
+        gs_bench_report("rt", "fifo_p99", gs_rt_jitter_quantile(jitter, 0.99) / 1e3, "us", GS_BENCH_LOWER, 200);
+    }
+    free(jitter);
+
+    long unlocked = bench_faults();
+    gs_rt_config_t config[1];
+    memset(config, 0x0, sizeof(gs_rt_config_t));
+    config->priority = BENCH_PRIORITY;
+    if (gs_rt_setup(config))
+    {
+        CHECK(gs_rt_active());
+        long locked = bench_faults();
+        printf("rt: page faults touching a fresh %d KB block: %ld, %ld with the profile in place.\n", BENCH_TOUCH_BYTES / 1024, unlocked, locked);
+        // The block comes out of the locked, already faulted heap reserve.
+        CHECK(locked < unlocked / 4 + 1);
+        gs_bench_report("rt", "locked_faults", (double)locked, "faults/MB", GS_BENCH_LOWER, 100);
+    }
+    else
+    {
+        printf("rt: memory cannot be locked here (needs CAP_IPC_LOCK or a higher RLIMIT_MEMLOCK); skipped.\n");
+    }
+    gs_log_stop();
+
+    if (failures)
+    {
+        dbprintlf(FATAL "%d real-time profile checks failed.", failures);
+        return 1;
+    }
+    return 0;
+}
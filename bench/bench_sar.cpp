@@ -0,0 +1,339 @@
+/**
+ * @file bench_sar.cpp
+ * @author agent (agent@local)
+ * @brief Checks segmentation, reassembly and selective repeat, then measures multi-frame throughput over a lossy simulated link.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "gs_uhf.hpp"
+#include "gs_sar.hpp"
+#include "gs_radio.hpp"
+#include "gs_bench.hpp"
+#include "gs_time.hpp"
+#include "gs_log.hpp"
+#include "meb_debug.hpp"
+
+#define LINK_MESSAGES 3
+#define LINK_MESSAGE_SIZE 8000
+#define LINK_OPTIONS "loss=0.05,latency=10000,rate=115200,echo"
+#define LINK_TIMEOUT_S 60
+
+#define CHECK(cond)                                       \
+    do                                                    \
+    {                                                     \
+        if (!(cond))                                      \
+        {                                                 \
+            dbprintlf(RED_FG "Check failed: %s", #cond); \
+            failures++;                                   \
+        }                                                 \
+    } while (0)
+
+/**
+ * @brief Runs one message from a to b on a virtual clock, 1 ms per frame each way.
+ * 
+ * drop_data and drop_ack list which transmissions (counted from 1) the channel loses.
+ * 
+ * @return gs_sar_status_t The sender's final status.
+ */
+static gs_sar_status_t virtual_transfer(gs_sar_t *a, gs_sar_t *b, const uint8_t *msg, size_t len,
+                                        const int *drop_data, const int *drop_ack, int *delivered)
+{
+    uint64_t now = NSEC_PER_SEC;
+    int data_sent = 0, acks_sent = 0;
+    gs_sar_status_t status = GS_SAR_WAIT;
+    *delivered = 0;
+
+    if (!gs_sar_send_start(a, msg, len))
+    {
+        return GS_SAR_IDLE;
+    }
+
+    while (status == GS_SAR_WAIT || status == GS_SAR_SEND)
+    {
+        uint8_t payload[GST_MAX_PAYLOAD_SIZE];
+        uint64_t wake_ns = 0;
+        status = gs_sar_send_poll(a, now, payload, &wake_ns);
+        if (status == GS_SAR_SEND)
+        {
+            data_sent++;
+            bool lost = false;
+            for (const int *d = drop_data; *d; d++)
+            {
+                lost |= *d == data_sent || *d < 0;
+            }
+            if (!lost && (gs_sar_input(b, payload, now) & GS_SAR_IN_MESSAGE))
+            {
+                (*delivered)++;
+            }
+        }
+        else if (status == GS_SAR_WAIT)
+        {
+            now = wake_ns;
+        }
+
+        if (gs_sar_take_ack(b, payload))
+        {
+            acks_sent++;
+            bool lost = false;
+            for (const int *d = drop_ack; *d; d++)
+            {
+                lost |= *d == acks_sent;
+            }
+            if (!lost)
+            {
+                gs_sar_input(a, payload, now);
+            }
+        }
+        now += NSEC_PER_MSEC;
+    }
+    return status;
+}
+
+static int check_protocol(void)
+{
+    int failures = 0;
+    uint8_t msg[2000];
+    for (size_t i = 0; i < sizeof(msg); i++)
+    {
+        msg[i] = (i * 131) ^ (i >> 8);
+    }
+
+    gs_sar_t *a = gs_sar_create(sizeof(msg));
+    gs_sar_t *b = gs_sar_create(sizeof(msg));
+    size_t len = 0;
+    int delivered = 0;
+    gs_sar_stats_t stats[1];
+
+    // Clean channel: every segment once, the exact bytes out.
+    const int none[] = {0};
+    CHECK(virtual_transfer(a, b, msg, sizeof(msg), none, none, &delivered) == GS_SAR_DONE);
+    CHECK(delivered == 1 && memcmp(gs_sar_message(b, &len), msg, sizeof(msg)) == 0 && len == sizeof(msg));
+    gs_sar_get_stats(a, stats);
+    CHECK(stats->segments_sent == (sizeof(msg) + GS_SAR_SEGMENT_SIZE - 1) / GS_SAR_SEGMENT_SIZE && stats->retransmits == 0);
+
+    // Lost segments and a lost ACK: only the missing segments are sent again.
+    const int lost_data[] = {4, 11, 12, 0};
+    const int lost_ack[] = {1, 0};
+    CHECK(virtual_transfer(a, b, msg, 777, lost_data, lost_ack, &delivered) == GS_SAR_DONE);
+    CHECK(delivered == 1 && memcmp(gs_sar_message(b, &len), msg, 777) == 0 && len == 777);
+    gs_sar_stats_t before[1];
+    *before = *stats;
+    gs_sar_get_stats(a, stats);
+    CHECK(stats->retransmits - before->retransmits == 3);
+    CHECK(stats->segments_sent - before->segments_sent == (777 + GS_SAR_SEGMENT_SIZE - 1) / GS_SAR_SEGMENT_SIZE + 3);
+
+    // The last segment again after completion is re-ACKed as complete and not delivered twice.
+    uint8_t payload[GST_MAX_PAYLOAD_SIZE];
+    memset(payload, 0x0, sizeof(payload));
+    gs_sar_header_t *hdr = (gs_sar_header_t *)payload;
+    hdr->type = GS_SAR_DATA;
+    hdr->msg_id = a->tx_id;
+    hdr->seq = 0;
+    hdr->total = 777;
+    CHECK(gs_sar_input(b, payload, 0) == GS_SAR_IN_ACK);
+    CHECK(gs_sar_take_ack(b, payload) && ((gs_sar_ack_t *)payload)->cumulative == (777 + GS_SAR_SEGMENT_SIZE - 1) / GS_SAR_SEGMENT_SIZE);
+
+    // Malformed input is refused.
+    memset(payload, 0x0, sizeof(payload));
+    CHECK(gs_sar_input(b, payload, 0) < 0);
+    hdr->type = GS_SAR_DATA;
+    hdr->total = sizeof(msg) + 1;
+    CHECK(gs_sar_input(b, payload, 0) < 0);
+    hdr->total = 100;
+    hdr->seq = 2;
+    CHECK(gs_sar_input(b, payload, 0) < 0);
+    CHECK(!gs_sar_send_start(a, msg, 0));
+    CHECK(!gs_sar_send_start(a, msg, GS_SAR_MAX_MESSAGE + 1));
+
+    // A dead link gives up after GS_SAR_MAX_TRIES.
+    const int lose_all[] = {-1, 0};
+    CHECK(virtual_transfer(a, b, msg, 100, lose_all, none, &delivered) == GS_SAR_FAILED && delivered == 0);
+    gs_sar_get_stats(a, stats);
+    CHECK(stats->messages_failed == 1);
+
+    gs_sar_destroy(a);
+    gs_sar_destroy(b);
+    return failures;
+}
+
+typedef struct
+{
+    gs_radio_t *radio;
+    gs_sar_t *sar;
+    bool done;
+    pthread_mutex_t lock;
+    uint8_t received[LINK_MESSAGE_SIZE];
+    size_t received_len;
+    int received_count;
+} link_t;
+
+static void *link_rx_thread(void *args)
+{
+    link_t *link = (link_t *)args;
+    while (!__atomic_load_n(&link->done, __ATOMIC_ACQUIRE))
+    {
+        char buf[GST_MAX_PAYLOAD_SIZE];
+        int16_t rssi = 0;
+        uint16_t guid = 0;
+        if (gs_uhf_read(link->radio, buf, sizeof(buf), &rssi, &link->done, &guid) <= 0 || guid != GST_SAR_GUID)
+        {
+            continue;
+        }
+        if (gs_sar_input(link->sar, (uint8_t *)buf, gs_time_ns()) & GS_SAR_IN_MESSAGE)
+        {
+            size_t len = 0;
+            const uint8_t *msg = gs_sar_message(link->sar, &len);
+            pthread_mutex_lock(&link->lock);
+            memcpy(link->received, msg, len < sizeof(link->received) ? len : sizeof(link->received));
+            link->received_len = len;
+            link->received_count++;
+            pthread_mutex_unlock(&link->lock);
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Sends any waiting ACK, then the next segment, or sleeps until there may be something to send.
+ * 
+ * The same loop gs_uhf_tx_thread() runs, minus the queue.
+ * 
+ * @return gs_sar_status_t 
+ */
+static gs_sar_status_t link_tx_step(link_t *link)
+{
+    bool done = false;
+    uint8_t payload[GST_MAX_PAYLOAD_SIZE];
+    if (gs_sar_take_ack(link->sar, payload))
+    {
+        gs_uhf_write(link->radio, (char *)payload, GST_MAX_PAYLOAD_SIZE, &done, GST_SAR_GUID);
+    }
+
+    uint64_t now = gs_time_ns();
+    uint64_t wake_ns = 0;
+    gs_sar_status_t status = gs_sar_send_poll(link->sar, now, payload, &wake_ns);
+    if (status == GS_SAR_SEND)
+    {
+        gs_uhf_write(link->radio, (char *)payload, GST_MAX_PAYLOAD_SIZE, &done, GST_SAR_GUID);
+    }
+    else if (status == GS_SAR_WAIT || status == GS_SAR_IDLE)
+    {
+        uint64_t limit = now + UHF_SAR_PREEMPT_MS * NSEC_PER_MSEC;
+        gs_sar_wait(link->sar, status == GS_SAR_WAIT && wake_ns < limit ? wake_ns : limit);
+    }
+    return status;
+}
+
+static int check_link(void)
+{
+    int failures = 0;
+    gs_sim_config_t config[1];
+    gs_radio_sim_defaults(config);
+    gs_radio_sim_parse(config, LINK_OPTIONS);
+
+    link_t link[1];
+    memset(link, 0x0, sizeof(link_t));
+    pthread_mutex_init(&link->lock, NULL);
+    link->radio = gs_radio_sim_create(config);
+    link->sar = gs_sar_create(LINK_MESSAGE_SIZE);
+    if (link->radio == nullptr || link->sar == nullptr || gs_radio_init(link->radio) != 1)
+    {
+        dbprintlf(FATAL "Failed to set up the simulated link.");
+        return 1;
+    }
+
+    pthread_t rx_tid;
+    pthread_create(&rx_tid, NULL, link_rx_thread, link);
+
+    static uint8_t msg[LINK_MESSAGE_SIZE];
+    double up_s = 0, down_s = 0;
+    uint64_t give_up = gs_time_ns() + LINK_TIMEOUT_S * NSEC_PER_SEC;
+    for (int m = 0; m < LINK_MESSAGES && !failures; m++)
+    {
+        for (size_t i = 0; i < sizeof(msg); i++)
+        {
+            msg[i] = (uint8_t)(i * 7 + m * 13);
+        }
+
+        // Up: until every segment is acknowledged.
+        uint64_t start = gs_time_ns();
+        CHECK(gs_sar_send_start(link->sar, msg, sizeof(msg)));
+        gs_sar_status_t status;
+        while ((status = link_tx_step(link)) == GS_SAR_SEND || status == GS_SAR_WAIT)
+        {
+        }
+        CHECK(status == GS_SAR_DONE);
+        uint64_t acked = gs_time_ns();
+        up_s += (acked - start) / 1e9;
+
+        // Down: the spacecraft echoes the reassembled message back, segmented; we ACK it.
+        while (__atomic_load_n(&link->received_count, __ATOMIC_ACQUIRE) == m && gs_time_ns() < give_up)
+        {
+            link_tx_step(link);
+        }
+        down_s += (gs_time_ns() - acked) / 1e9;
+        pthread_mutex_lock(&link->lock);
+        CHECK(link->received_count == m + 1 && link->received_len == sizeof(msg) && memcmp(link->received, msg, sizeof(msg)) == 0);
+        pthread_mutex_unlock(&link->lock);
+    }
+
+    __atomic_store_n(&link->done, true, __ATOMIC_RELEASE);
+    pthread_join(rx_tid, NULL);
+
+    gs_sim_stats_t sim[1];
+    gs_radio_sim_stats(link->radio, sim);
+    gs_sar_stats_t stats[1];
+    gs_sar_get_stats(link->sar, stats);
+    CHECK(sim->sar_uplinks == LINK_MESSAGES);
+
+    if (!failures)
+    {
+        double bits = (double)LINK_MESSAGES * LINK_MESSAGE_SIZE * 8;
+        double ideal = (double)GS_SAR_SEGMENT_SIZE / sizeof(gst_frame_t);
+        printf("sar: %d x %d bytes over \"%s\", %llu/%llu frames lost up/down.\n", LINK_MESSAGES, LINK_MESSAGE_SIZE, LINK_OPTIONS,
+               (unsigned long long)sim->uplink_lost, (unsigned long long)sim->downlink_lost);
+        printf("%-10s %10s %8s %10s\n", "direction", "bps", "of raw", "of ideal");
+        printf("%-10s %10.0f %7.1f%% %9.1f%%\n", "uplink", bits / up_s, 100 * bits / up_s / config->bitrate, 100 * bits / up_s / config->bitrate / ideal);
+        printf("%-10s %10.0f %7.1f%% %9.1f%%\n", "downlink", bits / down_s, 100 * bits / down_s / config->bitrate, 100 * bits / down_s / config->bitrate / ideal);
+        gs_bench_report("sar", "uplink_goodput", bits / up_s, "bps", GS_BENCH_HIGHER, 15);
+        gs_bench_report("sar", "downlink_goodput", bits / down_s, "bps", GS_BENCH_HIGHER, 15);
+        printf("uplink: %llu segments, %llu retransmitted, %llu ACKs in; RTO settled at %u ms.\n",
+               (unsigned long long)stats->segments_sent, (unsigned long long)stats->retransmits,
+               (unsigned long long)stats->acks_received, stats->rto_ms);
+    }
+
+    gs_radio_destroy(link->radio);
+    gs_sar_destroy(link->sar);
+    pthread_mutex_destroy(&link->lock);
+    return failures;
+}
+
+int main(void)
+{
+    int failures = check_protocol();
+    if (failures)
+    {
+        dbprintlf(FATAL "%d SAR protocol checks failed.", failures);
+        return 1;
+    }
+    printf("sar: reassembly, selective repeat, duplicate and malformed-input checks pass.\n");
+
+    // Every segment logs a line from gs_uhf_write(); keep them out of the results.
+    gs_log_start("/dev/null");
+    failures = check_link();
+    gs_log_stop();
+    if (failures)
+    {
+        dbprintlf(FATAL "%d SAR link checks failed.", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,518 @@
+/**
+ * @file bench_spool.cpp
+ * @author agent (agent@local)
+ * @brief Checks the store-and-forward spool across restarts and torn writes, times it, then runs a server outage through the event loop.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * The outage: frames from the simulated spacecraft reach a stand-in server until it drops the connection;
+ * the frames downlinked while it is gone must go to the spool, not the RX ring, and the reconnection attempts
+ * must back off. The ground station is then restarted, as after a crash: the spool is reopened from disk
+ * and drained to a new server connection while live frames keep arriving. Fails unless every frame reaches
+ * the server exactly once and live frames get through while the backlog drains.
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include "gs_uhf.hpp"
+#include "gs_spool.hpp"
+#include "gs_reactor.hpp"
+#include "gs_ring.hpp"
+#include "gs_tx.hpp"
+#include "gs_sar.hpp"
+#include "gs_radio.hpp"
+#include "gs_metrics.hpp"
+#include "gs_bench.hpp"
+#include "gs_time.hpp"
+#include "gs_log.hpp"
+#include "meb_debug.hpp"
+
+#define SPOOL_SEGMENT (128 << 10)
+#define SPOOL_FRAMES 5000
+#define SPOOL_TIMED 200000
+#define OUTAGE_BEFORE 200 // Frames delivered before the server goes away,
+#define OUTAGE_DURING 500 // while it is away,
+#define OUTAGE_AFTER 300  // and while the spool drains after the restart.
+#define OUTAGE_TOTAL (OUTAGE_BEFORE + OUTAGE_DURING + OUTAGE_AFTER)
+#define OUTAGE_TIMEOUT_S 20
+
+static size_t spool_len(int seq)
+{
+    return 4 + (seq * 37) % 250;
+}
+
+static void spool_fill(uint8_t *buf, size_t len, int seq)
+{
+    memcpy(buf, &seq, sizeof(seq));
+    for (size_t i = sizeof(seq); i < len; i++)
+    {
+        buf[i] = (uint8_t)(seq * 7 + i);
+    }
+}
+
+static bool spool_check(gs_spool_t *spool, int seq)
+{
+    uint8_t buf[GS_SPOOL_MAX_RECORD], expect[256];
+    int16_t rssi = 0;
+    size_t len = spool_len(seq);
+    spool_fill(expect, len, seq);
+    return gs_spool_peek(spool, buf, sizeof(buf), &rssi) == (ssize_t)len && memcmp(buf, expect, len) == 0 && rssi == -(seq % 120);
+}
+
+static int spool_files(const char *dir)
+{
+    int n = 0;
+    DIR *d = opendir(dir);
+    struct dirent *entry;
+    while (d != nullptr && (entry = readdir(d)) != nullptr)
+    {
+        n += strstr(entry->d_name, ".spool") != nullptr;
+    }
+    if (d != nullptr)
+    {
+        closedir(d);
+    }
+    return n;
+}
+
+static void spool_clear(const char *dir)
+{
+    DIR *d = opendir(dir);
+    struct dirent *entry;
+    char path[GS_SPOOL_PATH_MAX + 32];
+    while (d != nullptr && (entry = readdir(d)) != nullptr)
+    {
+        if (strstr(entry->d_name, ".spool") != nullptr)
+        {
+            snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+            unlink(path);
+        }
+    }
+    if (d != nullptr)
+    {
+        closedir(d);
+    }
+}
+
+/**
+ * @brief Appends, reopens, drains part, tears the tail, reopens, drains the rest, and fills the spool.
+ */
+static int spool_unit(const char *dir)
+{
+    int failed = 0;
+    uint8_t buf[256];
+
+    gs_spool_t *spool = gs_spool_open(dir, SPOOL_SEGMENT, 64 << 20);
+    for (int i = 0; i < SPOOL_FRAMES; i++)
+    {
+        spool_fill(buf, spool_len(i), i);
+        failed += !gs_spool_append(spool, buf, spool_len(i), -(i % 120));
+    }
+    gs_spool_stats_t stats[1];
+    gs_spool_get_stats(spool, stats);
+    if (failed || stats->frames != SPOOL_FRAMES || stats->segments < 2 || (int)stats->segments != spool_files(dir))
+    {
+        dbprintlf(FATAL "Appended %llu/%d frames into %u segments (%d files).", (unsigned long long)stats->frames, SPOOL_FRAMES,
+                  stats->segments, spool_files(dir));
+        return 0;
+    }
+    gs_spool_close(spool);
+
+    // Everything comes back after a restart, in order; half of it is delivered.
+    spool = gs_spool_open(dir, SPOOL_SEGMENT, 64 << 20);
+    if (spool == nullptr || gs_spool_depth(spool) != SPOOL_FRAMES)
+    {
+        dbprintlf(FATAL "Reopened spool holds %llu/%d frames.", spool ? (unsigned long long)gs_spool_depth(spool) : 0ULL, SPOOL_FRAMES);
+        return 0;
+    }
+    for (int i = 0; i < SPOOL_FRAMES / 2; i++)
+    {
+        failed += !spool_check(spool, i);
+        gs_spool_pop(spool);
+    }
+    gs_spool_get_stats(spool, stats);
+    int files = spool_files(dir);
+    gs_spool_close(spool);
+    if (failed || stats->drained != SPOOL_FRAMES / 2 || files != (int)stats->segments)
+    {
+        dbprintlf(FATAL "%d frames read back wrong, %llu drained, %d files for %u segments.", failed, (unsigned long long)stats->drained,
+                  files, stats->segments);
+        return 0;
+    }
+
+    // A crash halfway through an append leaves part of a record at the end of the newest segment.
+    char path[GS_SPOOL_PATH_MAX + 32];
+    DIR *d = opendir(dir);
+    struct dirent *entry;
+    char newest[256] = "";
+    while ((entry = readdir(d)) != nullptr)
+    {
+        if (strstr(entry->d_name, ".spool") != nullptr && strcmp(entry->d_name, newest) > 0)
+        {
+            snprintf(newest, sizeof(newest), "%s", entry->d_name);
+        }
+    }
+    closedir(d);
+    snprintf(path, sizeof(path), "%s/%s", dir, newest);
+    int fd = open(path, O_WRONLY | O_APPEND);
+    gs_spool_record_t torn = {GS_SPOOL_RECORD_MAGIC, 200, 0, 0, 0};
+    if (fd < 0 || write(fd, &torn, sizeof(torn)) != sizeof(torn) || write(fd, buf, 50) != 50)
+    {
+        dbprintlf(FATAL "Failed to tear %s.", path);
+        return 0;
+    }
+    close(fd);
+
+    spool = gs_spool_open(dir, SPOOL_SEGMENT, 64 << 20);
+    gs_spool_get_stats(spool, stats);
+    if (stats->frames != SPOOL_FRAMES - SPOOL_FRAMES / 2 || stats->corrupt != 1)
+    {
+        dbprintlf(FATAL "After the torn append the spool holds %llu frames (expected %d), %llu corrupt.",
+                  (unsigned long long)stats->frames, SPOOL_FRAMES - SPOOL_FRAMES / 2, (unsigned long long)stats->corrupt);
+        return 0;
+    }
+    // Appends go on after the cut; they are read back after the older frames.
+    spool_fill(buf, spool_len(SPOOL_FRAMES), SPOOL_FRAMES);
+    gs_spool_append(spool, buf, spool_len(SPOOL_FRAMES), -(SPOOL_FRAMES % 120));
+    for (int i = SPOOL_FRAMES / 2; i <= SPOOL_FRAMES; i++)
+    {
+        failed += !spool_check(spool, i);
+        gs_spool_pop(spool);
+    }
+    bool empty = gs_spool_peek(spool, buf, sizeof(buf), nullptr) == 0;
+    gs_spool_close(spool);
+    spool = gs_spool_open(dir, SPOOL_SEGMENT, 64 << 20);
+    empty = empty && gs_spool_depth(spool) == 0;
+    gs_spool_close(spool);
+    if (failed || !empty || spool_files(dir) != 0)
+    {
+        dbprintlf(FATAL "%d frames read back wrong after the torn append; %s, %d files left.", failed, empty ? "empty" : "not empty", spool_files(dir));
+        return 0;
+    }
+
+    // A full spool refuses frames instead of growing.
+    spool = gs_spool_open(dir, SPOOL_SEGMENT, 100 * (sizeof(gs_spool_record_t) + 56));
+    int appended = 0;
+    for (int i = 0; i < 150; i++)
+    {
+        appended += gs_spool_append(spool, buf, 56, 0);
+    }
+    gs_spool_get_stats(spool, stats);
+    while (gs_spool_peek(spool, buf, sizeof(buf), nullptr) > 0)
+    {
+        gs_spool_pop(spool);
+    }
+    gs_spool_close(spool);
+    spool_clear(dir);
+    if (appended != 100 || stats->refused != 50)
+    {
+        dbprintlf(FATAL "A spool with room for 100 frames took %d of 150 and refused %llu.", appended, (unsigned long long)stats->refused);
+        return 0;
+    }
+    return 1;
+}
+
+static void spool_time(const char *dir)
+{
+    uint8_t buf[sizeof(cmd_output_t)];
+    memset(buf, 0x5a, sizeof(buf));
+    gs_spool_t *spool = gs_spool_open(dir, UHF_SPOOL_SEGMENT_BYTES, UHF_SPOOL_MAX_BYTES);
+
+    uint64_t start = gs_time_ns();
+    for (int i = 0; i < SPOOL_TIMED; i++)
+    {
+        gs_spool_append(spool, buf, sizeof(buf), -90);
+    }
+    gs_spool_sync(spool);
+    uint64_t appended = gs_time_ns();
+    for (int i = 0; i < SPOOL_TIMED; i++)
+    {
+        gs_spool_peek(spool, buf, sizeof(buf), nullptr);
+        gs_spool_pop(spool);
+    }
+    gs_spool_sync(spool);
+    uint64_t drained = gs_time_ns();
+    gs_spool_close(spool);
+    spool_clear(dir);
+
+    printf("spool: append %.0f ns/frame (synced), drain %.0f ns/frame, %d-byte frames.\n", (double)(appended - start) / SPOOL_TIMED,
+           (double)(drained - appended) / SPOOL_TIMED, (int)sizeof(buf));
+    // Both end in fsync(), which is up to the disk.
+    gs_bench_report("spool", "append", (double)(appended - start) / SPOOL_TIMED, "ns/frame", GS_BENCH_LOWER, 50);
+    gs_bench_report("spool", "drain", (double)(drained - appended) / SPOOL_TIMED, "ns/frame", GS_BENCH_LOWER, 50);
+}
+
+typedef struct
+{
+    NetDataClient *server;
+    int seen[OUTAGE_TOTAL];
+    int received;
+    int live_during_drain; // OUTAGE_AFTER frames that arrived before the last spooled one.
+    int drained;           // OUTAGE_DURING frames received.
+    int bad;
+} outage_server_t;
+
+static void *outage_server_thread(void *args)
+{
+    outage_server_t *server = (outage_server_t *)args;
+    NetFrame *netframe = new NetFrame();
+    uint8_t payload[NETFRAME_MAX_PAYLOAD_SIZE];
+
+    while (netframe->recvFrame(server->server) >= 0)
+    {
+        int size = netframe->getPayloadSize();
+        if (netframe->getType() != NetType::DATA || size < 0 || size > NETFRAME_MAX_PAYLOAD_SIZE || netframe->retrievePayload(payload, size) < 0)
+        {
+            continue;
+        }
+        int seq;
+        memcpy(&seq, payload, sizeof(seq));
+        uint8_t expect[sizeof(cmd_output_t)];
+        spool_fill(expect, sizeof(expect), seq);
+        if (size != sizeof(cmd_output_t) || seq < 0 || seq >= OUTAGE_TOTAL || memcmp(payload, expect, size) != 0)
+        {
+            server->bad++;
+            continue;
+        }
+        server->seen[seq]++;
+        if (seq >= OUTAGE_BEFORE && seq < OUTAGE_BEFORE + OUTAGE_DURING)
+        {
+            server->drained++;
+        }
+        else if (seq >= OUTAGE_BEFORE + OUTAGE_DURING && server->drained < OUTAGE_DURING)
+        {
+            server->live_during_drain++;
+        }
+        __atomic_store_n(&server->received, server->received + 1, __ATOMIC_RELEASE);
+    }
+    delete netframe;
+    return nullptr;
+}
+
+static void *outage_loop_thread(void *args)
+{
+    gs_uhf_event_loop((global_data_t *)args, false);
+    return nullptr;
+}
+
+/**
+ * @brief Downlinks frames first to last, one at a time so the radio's FIFO never overruns.
+ */
+static void outage_send(global_data_t *global, int first, int last, uint64_t deadline, uint64_t gap_us)
+{
+    gs_sim_stats_t sim[1];
+    gs_radio_sim_stats(global->radio, sim);
+    uint64_t read = sim->downlink_read;
+    for (int i = first; i < last && gs_time_ns() < deadline; i++)
+    {
+        uint8_t payload[sizeof(cmd_output_t)];
+        spool_fill(payload, sizeof(payload), i);
+        gst_frame_t frame[1];
+        gs_uhf_frame_build(frame, payload, sizeof(payload));
+        gs_radio_sim_far_send(global->radio, frame, sizeof(gst_frame_t));
+        while (sim->downlink_read < read + 1 && gs_time_ns() < deadline)
+        {
+            usleep(10);
+            gs_radio_sim_stats(global->radio, sim);
+        }
+        read = sim->downlink_read;
+        usleep(gap_us);
+    }
+}
+
+static bool outage_wait(int *value, int target, uint64_t deadline)
+{
+    while (__atomic_load_n(value, __ATOMIC_ACQUIRE) < target && gs_time_ns() < deadline)
+    {
+        usleep(1000);
+    }
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE) >= target;
+}
+
+static int outage_connect(global_data_t *global, outage_server_t *server, pthread_t *server_tid, int sv[2])
+{
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0)
+    {
+        return 0;
+    }
+    global->network_data->socket = sv[0];
+    global->network_data->connection_ready = true;
+    server->server->socket = sv[1];
+    server->server->connection_ready = true;
+    pthread_create(server_tid, NULL, outage_server_thread, server);
+    return 1;
+}
+
+static int outage_run(const char *dir)
+{
+    gs_sim_config_t config[1];
+    gs_radio_sim_defaults(config);
+    gs_radio_sim_parse(config, "external,rate=0");
+    global_data_t global[1];
+    memset(global, 0x0, sizeof(global_data_t));
+    global->radio = gs_radio_sim_create(config);
+    global->uhf_rx_ring = gs_ring_create(UHF_RX_RING_SIZE);
+    global->uhf_tx_queue = gs_tx_queue_create(UHF_TX_QUEUE_SIZE);
+    global->uhf_sar = gs_sar_create(UHF_SAR_MAX_MESSAGE);
+    global->netframe_pool = gs_pool_create("NetFrame", sizeof(NetFrame), NETFRAME_POOL_SIZE);
+    global->payload_pool = gs_pool_create("Payload", NETFRAME_MAX_PAYLOAD_SIZE, PAYLOAD_POOL_SIZE);
+    global->reactor = gs_reactor_create();
+    global->spool = gs_spool_open(dir, UHF_SPOOL_SEGMENT_BYTES, UHF_SPOOL_MAX_BYTES);
+    pthread_mutex_init(&global->net_lock, NULL);
+    global->network_data = new NetDataClient(NetPort::ROOFUHF, SERVER_POLL_RATE);
+    global->network_data->thread_status = 1;
+    outage_server_t *server = (outage_server_t *)calloc(1, sizeof(outage_server_t));
+    server->server = new NetDataClient(NetPort::ROOFUHF, SERVER_POLL_RATE);
+    int sv[2];
+    pthread_t server_tid, loop_tid, tx_tid;
+    if (global->radio == nullptr || global->reactor == nullptr || global->spool == nullptr || !outage_connect(global, server, &server_tid, sv))
+    {
+        dbprintlf(FATAL "Failed to set up the ground station.");
+        return 0;
+    }
+    pthread_create(&loop_tid, NULL, outage_loop_thread, global);
+    pthread_create(&tx_tid, NULL, gs_uhf_tx_thread, global);
+    while (!__atomic_load_n(&global->uhf_ready, __ATOMIC_ACQUIRE))
+    {
+        usleep(1000);
+    }
+    uint64_t deadline = gs_time_ns() + OUTAGE_TIMEOUT_S * NSEC_PER_SEC;
+
+    // Connected: straight through.
+    outage_send(global, 0, OUTAGE_BEFORE, deadline, 0);
+    bool before = outage_wait(&server->received, OUTAGE_BEFORE, deadline);
+
+    // The server goes away. Its frames pile up in the spool; the ring stays empty.
+    uint64_t failures_before = gs_metrics_counter(GS_COUNT_NET_CONNECT_FAILURES);
+    uint64_t outage_start = gs_time_ns();
+    shutdown(sv[1], SHUT_RDWR);
+    pthread_join(server_tid, NULL);
+    while (__atomic_load_n(&global->network_data->connection_ready, __ATOMIC_ACQUIRE) && gs_time_ns() < deadline)
+    {
+        usleep(1000);
+    }
+    outage_send(global, OUTAGE_BEFORE, OUTAGE_BEFORE + OUTAGE_DURING, deadline, 2000);
+    while (gs_spool_depth(global->spool) < OUTAGE_DURING && gs_time_ns() < deadline)
+    {
+        usleep(1000);
+    }
+    gs_ring_stats_t ring[1];
+    gs_ring_get_stats(global->uhf_rx_ring, ring);
+    double outage_s = (gs_time_ns() - outage_start) / 1e9;
+    uint64_t failures = gs_metrics_counter(GS_COUNT_NET_CONNECT_FAILURES) - failures_before;
+    uint64_t spooled = gs_spool_depth(global->spool);
+
+    // Restart: a new event loop, the spool reopened from disk, a new server.
+    gs_reactor_stop(global->reactor);
+    pthread_join(loop_tid, NULL);
+    gs_reactor_destroy(global->reactor);
+    gs_spool_close(global->spool);
+    close(sv[0]);
+    close(sv[1]);
+    global->reactor = gs_reactor_create();
+    global->spool = gs_spool_open(dir, UHF_SPOOL_SEGMENT_BYTES, UHF_SPOOL_MAX_BYTES);
+    uint64_t reopened = global->spool ? gs_spool_depth(global->spool) : 0;
+    if (global->reactor == nullptr || global->spool == nullptr || !outage_connect(global, server, &server_tid, sv))
+    {
+        dbprintlf(FATAL "Failed to restart the ground station.");
+        return 0;
+    }
+    uint64_t drain_start = gs_time_ns();
+    pthread_create(&loop_tid, NULL, outage_loop_thread, global);
+
+    // Live frames at about the pace of a 9600 bps downlink while the backlog drains.
+    outage_send(global, OUTAGE_BEFORE + OUTAGE_DURING, OUTAGE_TOTAL, deadline, 1000);
+    outage_wait(&server->received, OUTAGE_TOTAL, deadline);
+    while (gs_spool_depth(global->spool) > 0 && gs_time_ns() < deadline)
+    {
+        usleep(1000);
+    }
+    double drain_s = (gs_time_ns() - drain_start) / 1e9;
+
+    gs_reactor_stop(global->reactor);
+    pthread_join(loop_tid, NULL);
+    __atomic_store_n(&global->uhf_done, true, __ATOMIC_RELEASE);
+    __atomic_store_n(&global->network_data->thread_status, 0, __ATOMIC_RELEASE);
+    gs_tx_stop(global->uhf_tx_queue);
+    pthread_join(tx_tid, NULL);
+    shutdown(sv[0], SHUT_RDWR);
+    pthread_join(server_tid, NULL);
+
+    int missing = 0, twice = 0;
+    for (int i = 0; i < OUTAGE_TOTAL; i++)
+    {
+        missing += server->seen[i] == 0;
+        twice += server->seen[i] > 1;
+    }
+    printf("spool: outage of %.1f s spooled %llu frames (RX ring high water %u) with %llu reconnect attempts; reopened with %llu.\n",
+           outage_s, (unsigned long long)spooled, ring->high_water, (unsigned long long)failures, (unsigned long long)reopened);
+    printf("spool: restart delivered %d spooled and %d live frames in %.2f s, %d live before the backlog was done; %d missing, %d twice, %d altered.\n",
+           server->drained, OUTAGE_AFTER, drain_s, server->live_during_drain, missing, twice, server->bad);
+    gs_bench_report("spool", "restart_drain", drain_s, "s", GS_BENCH_LOWER, 25);
+
+    int ok = before && spooled == OUTAGE_DURING && reopened == OUTAGE_DURING && !missing && !twice && !server->bad;
+    if (!ok)
+    {
+        dbprintlf(FATAL "Frames lost, duplicated or altered across the outage.");
+    }
+    // Backoff from UHF_RECONNECT_MIN_MS: a few attempts, not one per event loop wakeup.
+    if (failures < 1 || failures > 2 + outage_s * 1000 / UHF_RECONNECT_MIN_MS)
+    {
+        dbprintlf(FATAL "%llu reconnect attempts in %.1f s.", (unsigned long long)failures, outage_s);
+        ok = 0;
+    }
+    if (server->live_during_drain == 0)
+    {
+        dbprintlf(FATAL "Live frames waited for the whole backlog.");
+        ok = 0;
+    }
+
+    close(sv[0]);
+    close(sv[1]);
+    delete server->server;
+    free(server);
+    delete global->network_data;
+    gs_spool_close(global->spool);
+    spool_clear(dir);
+    gs_reactor_destroy(global->reactor);
+    gs_radio_destroy(global->radio);
+    gs_ring_destroy(global->uhf_rx_ring);
+    gs_tx_queue_destroy(global->uhf_tx_queue);
+    gs_sar_destroy(global->uhf_sar);
+    gs_pool_destroy(global->netframe_pool);
+    gs_pool_destroy(global->payload_pool);
+    pthread_mutex_destroy(&global->net_lock);
+    return ok;
+}
+
+int main(void)
+{
+    // Per-frame debug lines would dominate the run.
+    gs_log_start("/dev/null");
+    char dir[] = "/tmp/bench_spool.XXXXXX";
+    if (mkdtemp(dir) == nullptr)
+    {
+        dbprintlf(FATAL "Failed to create a spool directory.");
+        return 1;
+    }
+
+    int ok = spool_unit(dir);
+    if (ok)
+    {
+        spool_time(dir);
+        ok = outage_run(dir);
+    }
+    spool_clear(dir);
+    rmdir(dir);
+    gs_log_stop();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,238 @@
+/**
+ * @file bench_startup.cpp
+ * @author agent (agent@local)
+ * @brief Times radio bring-up: a cold init against a warm resume, and time to ready while the server is slow to connect.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * The simulated radio takes BENCH_BOOT_MS per cold init, standing in for the si446x's reset, patch and
+ * configuration upload, and fails its first BENCH_FAIL_INITS inits. A slow server is modeled by holding
+ * net_lock, which the event loop's connect attempt takes, for BENCH_CONNECT_MS.
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include "gs_uhf.hpp"
+#include "gs_health.hpp"
+#include "gs_reactor.hpp"
+#include "gs_ring.hpp"
+#include "gs_tx.hpp"
+#include "gs_sar.hpp"
+#include "gs_radio.hpp"
+#include "gs_bench.hpp"
+#include "gs_time.hpp"
+#include "gs_log.hpp"
+#include "meb_debug.hpp"
+
+#define BENCH_BOOT_MS 50
+#define BENCH_FAIL_INITS 3
+#define BENCH_CONNECT_MS 2000
+#define BENCH_OLD_RETRY_MS 5000 // What an init failure used to cost before the next attempt.
+#define BENCH_WARM_CYCLES 5
+#define BENCH_TIMEOUT_S 10
+
+#define CHECK(cond)                                       \
+    do                                                    \
+    {                                                     \
+        if (!(cond))                                      \
+        {                                                 \
+            dbprintlf(RED_FG "Check failed: %s", #cond); \
+            failures++;                                   \
+        }                                                 \
+    } while (0)
+
+#define STR(x) #x
+#define XSTR(x) STR(x)
+
+static gs_radio_t *bench_radio(const char *options)
+{
+    gs_sim_config_t config[1];
+    gs_radio_sim_defaults(config);
+    gs_radio_sim_parse(config, options);
+    return gs_radio_sim_create(config);
+}
+
+/**
+ * @brief Initializes a radio cold, then crashes it and brings it back warm, timing both.
+ * 
+ * @return int Failed checks.
+ */
+static int check_resume(void)
+{
+    int failures = 0;
+    gs_radio_t *radio = bench_radio("external,rate=0,boot=" XSTR(BENCH_BOOT_MS) ",fail=1");
+    gs_sim_stats_t stats[1];
+    gs_health_snapshot_t snap[1];
+
+    // Never up: no resume to try, and a failed cold init is reported as one.
+    CHECK(gs_uhf_init(radio) == 0);
+    gs_radio_sim_stats(radio, stats);
+    CHECK(stats->inits == 1 && stats->resumes == 0 && !gs_health_ready(&radio->health));
+
+    uint64_t start = gs_time_ns();
+    CHECK(gs_uhf_init(radio) == 1);
+    double cold_ms = (gs_time_ns() - start) / 1e6;
+    gs_radio_sim_stats(radio, stats);
+    CHECK(stats->inits == 2 && stats->resumes == 0 && gs_health_ready(&radio->health));
+
+    double warm_ms = 0;
+    for (int i = 0; i < BENCH_WARM_CYCLES; i++)
+    {
+        gs_radio_sim_crash(radio);
+        CHECK(gs_health_probe(radio) == 0);
+        start = gs_time_ns();
+        CHECK(gs_uhf_init(radio) == 1);
+        warm_ms += (gs_time_ns() - start) / 1e6;
+        CHECK(gs_health_probe(radio) == 1);
+    }
+    warm_ms /= BENCH_WARM_CYCLES;
+    gs_radio_sim_stats(radio, stats);
+    gs_health_get(&radio->health, snap);
+    CHECK(stats->inits == 2 && stats->resumes == BENCH_WARM_CYCLES);
+    CHECK(snap->ready && snap->reinits == BENCH_WARM_CYCLES);
+    CHECK(warm_ms < cold_ms);
+
+    printf("startup: cold init %.1f ms (of it %d ms modeled boot), warm resume %.3f ms.\n", cold_ms, BENCH_BOOT_MS, warm_ms);
+    gs_bench_report("startup", "cold_init", cold_ms, "ms", GS_BENCH_LOWER, 25);
+    gs_bench_report("startup", "warm_resume", warm_ms, "ms", GS_BENCH_LOWER, 50);
+    gs_radio_destroy(radio);
+    return failures;
+}
+
+typedef struct
+{
+    global_data_t *global;
+    bool rx_thread;
+} bench_loop_t;
+
+static void *bench_loop_thread(void *args)
+{
+    bench_loop_t *loop = (bench_loop_t *)args;
+    gs_uhf_event_loop(loop->global, loop->rx_thread);
+    return nullptr;
+}
+
+/**
+ * @brief Starts the ground station with a radio that fails its first inits and a server that takes
+ * BENCH_CONNECT_MS to connect, and times when each is up.
+ * 
+ * @return int 1 if the radio was receiving before the server connected, within the backoff's budget.
+ */
+static int bench_run(bool rx_thread)
+{
+    global_data_t global[1];
+    memset(global, 0x0, sizeof(global_data_t));
+    global->radio = bench_radio("external,rate=0,boot=" XSTR(BENCH_BOOT_MS) ",fail=" XSTR(BENCH_FAIL_INITS));
+    global->uhf_rx_ring = gs_ring_create(UHF_RX_RING_SIZE);
+    global->uhf_tx_queue = gs_tx_queue_create(UHF_TX_QUEUE_SIZE);
+    global->uhf_sar = gs_sar_create(UHF_SAR_MAX_MESSAGE);
+    global->netframe_pool = gs_pool_create("NetFrame", sizeof(NetFrame), NETFRAME_POOL_SIZE);
+    global->payload_pool = gs_pool_create("Payload", NETFRAME_MAX_PAYLOAD_SIZE, PAYLOAD_POOL_SIZE);
+    global->reactor = gs_reactor_create();
+    global->health_ms = UHF_HEALTH_INTERVAL_MS;
+    pthread_mutex_init(&global->net_lock, NULL);
+    global->network_data = new NetDataClient(NetPort::ROOFUHF, SERVER_POLL_RATE);
+    global->network_data->thread_status = 1;
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0)
+    {
+        erprintlf(errno);
+        return 0;
+    }
+
+    // The server is slow: the loop's connect attempt waits on net_lock until it is ready.
+    pthread_mutex_lock(&global->net_lock);
+    global->start_ns = gs_time_ns();
+    pthread_t loop_tid, rx_tid;
+    bench_loop_t loop = {global, rx_thread};
+    pthread_create(&loop_tid, NULL, bench_loop_thread, &loop);
+    if (rx_thread)
+    {
+        pthread_create(&rx_tid, NULL, gs_uhf_rx_thread, global);
+    }
+    uint64_t deadline = global->start_ns + BENCH_TIMEOUT_S * NSEC_PER_SEC;
+    while (!__atomic_load_n(&global->uhf_ready, __ATOMIC_ACQUIRE) && gs_time_ns() < deadline &&
+           gs_time_ns() < global->start_ns + BENCH_CONNECT_MS * 1000000ULL)
+    {
+        usleep(1000);
+    }
+    bool ready = __atomic_load_n(&global->uhf_ready, __ATOMIC_ACQUIRE);
+    double ready_ms = (gs_time_ns() - global->start_ns) / 1e6;
+    while (gs_time_ns() < global->start_ns + BENCH_CONNECT_MS * 1000000ULL)
+    {
+        usleep(1000);
+    }
+
+    // Connected; the loop's attempt takes the connection over.
+    global->network_data->socket = sv[0];
+    global->network_data->connection_ready = true;
+    pthread_mutex_unlock(&global->net_lock);
+    double connected_ms = (gs_time_ns() - global->start_ns) / 1e6;
+    while (!__atomic_load_n(&global->uhf_ready, __ATOMIC_ACQUIRE) && gs_time_ns() < deadline)
+    {
+        usleep(1000);
+    }
+
+    gs_sim_stats_t stats[1];
+    gs_radio_sim_stats(global->radio, stats);
+    double old_ms = BENCH_FAIL_INITS * (BENCH_BOOT_MS + BENCH_OLD_RETRY_MS) + BENCH_BOOT_MS + (rx_thread ? 0 : BENCH_CONNECT_MS);
+    printf("startup: %-18s radio ready after %.0f ms and %llu inits, server connected at %.0f ms; a fixed %d ms retry%s would take %.0f ms.\n",
+           rx_thread ? "RX thread + loop:" : "inline loop:", ready_ms, (unsigned long long)stats->inits, connected_ms,
+           BENCH_OLD_RETRY_MS, rx_thread ? "" : " after connecting", old_ms);
+    gs_bench_report("startup", rx_thread ? "rx_thread_ready" : "inline_ready", ready_ms, "ms", GS_BENCH_LOWER, 25);
+
+    gs_reactor_stop(global->reactor);
+    pthread_join(loop_tid, NULL);
+    __atomic_store_n(&global->uhf_done, true, __ATOMIC_RELEASE);
+    __atomic_store_n(&global->network_data->thread_status, 0, __ATOMIC_RELEASE);
+    if (rx_thread)
+    {
+        pthread_join(rx_tid, NULL);
+    }
+
+    close(sv[0]);
+    close(sv[1]);
+    delete global->network_data;
+    gs_reactor_destroy(global->reactor);
+    pthread_mutex_destroy(&global->net_lock);
+    gs_radio_destroy(global->radio);
+    gs_ring_destroy(global->uhf_rx_ring);
+    gs_tx_queue_destroy(global->uhf_tx_queue);
+    gs_sar_destroy(global->uhf_sar);
+    gs_pool_destroy(global->netframe_pool);
+    gs_pool_destroy(global->payload_pool);
+    // Up while the server was still connecting, and after exactly the planned failures.
+    return ready && ready_ms < BENCH_CONNECT_MS && stats->inits == BENCH_FAIL_INITS + 1;
+}
+
+int main(void)
+{
+    // The planned init failures log on every attempt.
+    gs_log_start("/dev/null");
+    int failures = check_resume();
+    if (failures)
+    {
+        dbprintlf(FATAL "%d radio resume checks failed.", failures);
+        gs_log_stop();
+        return 1;
+    }
+
+    int inline_ok = bench_run(false);
+    int threaded_ok = bench_run(true);
+    gs_log_stop();
+    if (!inline_ok || !threaded_ok)
+    {
+        dbprintlf(FATAL "The radio was not up before the server connected, or took more inits than planned.");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,120 @@
+/**
+ * @file bench_tx.cpp
+ * @author agent (agent@local)
+ * @brief Checks the uplink scheduler's ordering, backoff, deadlines and backpressure, then times it.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gs_uhf.hpp"
+#include "gs_tx.hpp"
+#include "gs_bench.hpp"
+#include "gs_time.hpp"
+#include "meb_debug.hpp"
+
+#define BENCH_ITEMS 1000000
+
+#define CHECK(cond)                                       \
+    do                                                    \
+    {                                                     \
+        if (!(cond))                                      \
+        {                                                 \
+            dbprintlf(RED_FG "Check failed: %s", #cond); \
+            failures++;                                   \
+        }                                                 \
+    } while (0)
+
+static int submit(gs_tx_queue_t *queue, uint8_t mod, int data_size)
+{
+    // The queue only holds on to the frame, so every item can share this one.
+    static gst_fec_frame_t air[1];
+    cmd_input_t *cmd = (cmd_input_t *)air->frame.payload;
+    memset(cmd, 0x0, sizeof(cmd_input_t));
+    cmd->mod = mod;
+    cmd->data_size = data_size;
+    gs_uhf_frame_seal(&air->frame, sizeof(cmd_input_t));
+    return gs_tx_submit(queue, air, sizeof(cmd_input_t), gs_tx_classify(queue, cmd, sizeof(cmd_input_t)), gs_time_ns());
+}
+
+static int check_scheduler(void)
+{
+    int failures = 0;
+    gs_tx_item_t item[1];
+    gs_tx_queue_t *queue = gs_tx_queue_create(4);
+    gs_tx_set_safe_mod(queue, 0x0f);
+
+    // Classes come out in priority order, and in submission order within a class.
+    CHECK(submit(queue, 0x01, 40));
+    CHECK(submit(queue, 0x01, 0));
+    CHECK(submit(queue, 0x02, 0));
+    CHECK(submit(queue, 0x0f, 40));
+    CHECK(!submit(queue, 0x01, 0)); // Full: backpressure.
+    uint32_t expect_seq[] = {4, 2, 3, 1};
+    for (int i = 0; i < 4; i++)
+    {
+        CHECK(gs_tx_next(queue, item, 0) == GS_TX_SEND && item->seq == expect_seq[i]);
+    }
+    CHECK(gs_tx_next(queue, item, 10) == GS_TX_NONE);
+
+    // A failed item goes back to the head of its class after a backoff, and nothing overtakes it.
+    CHECK(submit(queue, 0x01, 0));
+    CHECK(submit(queue, 0x01, 0));
+    CHECK(gs_tx_next(queue, item, 0) == GS_TX_SEND && item->seq == 5);
+    item->attempts = 1;
+    uint64_t failed_ns = gs_time_ns();
+    CHECK(gs_tx_retry(queue, item));
+    CHECK(gs_tx_next(queue, item, UHF_TX_BACKOFF_MS / 2) == GS_TX_NONE);
+    CHECK(gs_tx_next(queue, item, UHF_TX_BACKOFF_MS * 2) == GS_TX_SEND && item->seq == 5);
+    CHECK(gs_time_ns() - failed_ns >= UHF_TX_BACKOFF_MS * NSEC_PER_MSEC);
+    item->attempts = UHF_TX_MAX_RETRIES + 1;
+    CHECK(!gs_tx_retry(queue, item)); // Out of retries: the caller NACKs.
+
+    // An item past its deadline comes back as expired, ahead of anything sendable.
+    CHECK(submit(queue, 0x0f, 0));
+    queue->cls[GS_TX_PRIO_COMMAND].items[queue->cls[GS_TX_PRIO_COMMAND].head].deadline_ns = 0;
+    CHECK(gs_tx_next(queue, item, 0) == GS_TX_EXPIRED && item->seq == 6);
+    CHECK(gs_tx_next(queue, item, 0) == GS_TX_SEND && item->seq == 7);
+
+    // Longer than a frame: refused outright rather than cut to fit.
+    gst_fec_frame_t air[1];
+    CHECK(gs_tx_submit(queue, air, GST_MAX_PAYLOAD_SIZE + 1, GS_TX_PRIO_COMMAND, gs_time_ns()) < 0);
+
+    gs_tx_stats_t stats[1];
+    gs_tx_get_stats(queue, stats);
+    CHECK(stats->submitted == 7 && stats->rejected == 1 && stats->expired == 1 && stats->retries == 1 && stats->failed == 1);
+
+    gs_tx_queue_destroy(queue);
+    return failures;
+}
+
+int main(void)
+{
+    int failures = check_scheduler();
+    if (failures)
+    {
+        dbprintlf(FATAL "%d scheduler checks failed.", failures);
+        return 1;
+    }
+    printf("tx: priority, FIFO, backoff, deadline and backpressure checks pass.\n");
+
+    gs_tx_queue_t *queue = gs_tx_queue_create(UHF_TX_QUEUE_SIZE);
+    gs_tx_item_t item[1];
+    uint64_t start = gs_time_ns();
+    for (int i = 0; i < BENCH_ITEMS; i++)
+    {
+        submit(queue, i & 0xff, i % 64);
+        gs_tx_next(queue, item, 0);
+    }
+    double ns = (double)(gs_time_ns() - start) / BENCH_ITEMS;
+    printf("%-24s %8s\n", "operation", "ns");
+    printf("%-24s %8.1f\n", "submit + next", ns);
+    gs_bench_report("tx", "submit_next", ns, "ns", GS_BENCH_LOWER, 0);
+    gs_tx_queue_destroy(queue);
+    return 0;
+}
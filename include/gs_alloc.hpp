@@ -0,0 +1,29 @@
+/**
+ * @file gs_alloc.hpp
+ * @author agent (agent@local)
+ * @brief Process-wide heap allocation counter.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * gs_alloc.cpp replaces the global operator new, so every C++ heap allocation in the process is counted. It is
+ * linked into the benchmarks and tools only (BENCHOBJS in the Makefile), never into the daemon. Pool misses
+ * are not counted here, see gs_pool_stats_t::misses. Used to check that the frame paths stop allocating after
+ * warm-up.
+ * 
+ */
+
+#ifndef GS_ALLOC_HPP
+#define GS_ALLOC_HPP
+
+#include <stdint.h>
+
+/**
+ * @brief Returns the number of heap allocations counted so far.
+ * 
+ * @return uint64_t 
+ */
+uint64_t gs_alloc_count(void);
+
+#endif // GS_ALLOC_HPP
@@ -0,0 +1,182 @@
+/**
+ * @file gs_arbiter.hpp
+ * @author agent (agent@local)
+ * @brief Half-duplex radio arbiter: one SPI transaction at a time, and TX bursts the receive side stands back for.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * The radio is driven from several threads: its receive side (the event loop or an RX thread) reads it and
+ * re-enables pipe mode, the health monitor asks for its part info, and the UHF TX thread writes to it. Each
+ * of those is an SPI transaction with libsi446x, which is not thread-safe, and a write while a frame is
+ * being read off the FIFO loses the frame. Every gs_radio_*() call that touches the device therefore goes
+ * through the radio's arbiter.
+ * 
+ * Receive-side transactions are short and taken one at a time. The TX thread takes the radio for a whole
+ * burst instead, gs_arbiter_tx_begin() to gs_arbiter_tx_end(): everything it has ready goes out back to back
+ * and the radio is put straight back into pipe mode at the end, so it is deaf for one turnaround per burst
+ * rather than per frame. A waiting burst goes ahead of receive-side transactions that have not started yet.
+ * 
+ * Both turnarounds are measured: RX to TX, from a burst being asked for to it getting the radio (an
+ * in-progress read finishing), and TX to RX, from a burst's last write to the radio listening again.
+ * 
+ */
+
+#ifndef GS_ARBITER_HPP
+#define GS_ARBITER_HPP
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sys/types.h>
+
+/**
+ * @brief Arbiter counters, see gs_arbiter_get_stats().
+ * 
+ */
+typedef struct
+{
+    uint64_t rx_ops;          //!< Receive-side transactions: reads, part info, pipe mode, init.
+    uint64_t rx_refused;      //!< Transactions turned away by gs_arbiter_rx_try() because of a burst.
+    uint64_t bursts;          //!< TX bursts that wrote at least one frame.
+    uint64_t burst_frames;    //!< Frames written in them.
+    uint64_t rx_to_tx_sum_ns; //!< A burst asked for to it getting the radio.
+    uint64_t rx_to_tx_max_ns;
+    uint64_t tx_to_rx_sum_ns; //!< A burst's last write to the radio back in pipe mode.
+    uint64_t tx_to_rx_max_ns;
+} gs_arbiter_stats_t;
+
+/**
+ * @brief A radio's arbiter. Lives in gs_radio_t.
+ * 
+ */
+typedef struct
+{
+    pthread_mutex_t lock;  // Guards the fields below, never held across a transaction.
+    pthread_cond_t cond;   // Broadcast whenever the radio is handed back.
+    bool rx_busy;          // A receive-side transaction is in progress.
+    pthread_t rx_owner;    // The thread in it, while rx_busy.
+    int rx_depth;          // Its nested gs_arbiter_rx_begin() calls.
+    bool rx_deferred;      // gs_arbiter_rx_try() turned a transaction away; the burst's end signals efd.
+    int efd;               // Eventfd, see gs_arbiter_fd().
+    bool tx;               // A burst holds the radio.
+    uint32_t tx_waiting;   // Bursts waiting for the radio; receive-side transactions wait behind them.
+    pthread_t owner;       // The thread in the burst, while tx.
+    int depth;             // Its nested gs_arbiter_tx_begin() calls.
+    uint32_t frames;       // Written in the current burst.
+    uint64_t wait_ns;      // The current burst's RX to TX turnaround.
+    uint64_t last_write_ns;
+    gs_arbiter_stats_t stats;
+} gs_arbiter_t;
+
+typedef struct gs_radio gs_radio_t;
+
+/**
+ * @brief Sets up an arbiter, see gs_radio_alloc().
+ * 
+ * @param arbiter 
+ */
+void gs_arbiter_init(gs_arbiter_t *arbiter);
+
+/**
+ * @brief Releases an arbiter, see gs_radio_destroy().
+ * 
+ * @param arbiter 
+ */
+void gs_arbiter_destroy(gs_arbiter_t *arbiter);
+
+/**
+ * @brief Waits for the radio for one receive-side transaction, which is then ended with gs_arbiter_rx_end().
+ * 
+ * Nests, so a caller can hold the radio across several gs_radio_*() calls. Not to be called inside a TX burst.
+ * 
+ * @param radio 
+ */
+void gs_arbiter_rx_begin(gs_radio_t *radio);
+
+/**
+ * @brief gs_arbiter_rx_begin(), unless a burst holds or is waiting for the radio.
+ * 
+ * When it is turned away, gs_arbiter_fd() becomes readable once the burst is over.
+ * 
+ * @param radio 
+ * @return bool True if the transaction may go ahead.
+ */
+bool gs_arbiter_rx_try(gs_radio_t *radio);
+
+/**
+ * @brief A descriptor that becomes readable when a burst that turned a receive-side transaction away is over,
+ * for an event loop that cannot wait out the burst. Cleared by reading it.
+ * 
+ * @param radio 
+ * @return int The descriptor, -1 if it could not be created.
+ */
+int gs_arbiter_fd(gs_radio_t *radio);
+
+/**
+ * @brief Ends a receive-side transaction.
+ * 
+ * @param radio 
+ */
+void gs_arbiter_rx_end(gs_radio_t *radio);
+
+/**
+ * @brief Takes the radio for a TX burst, once the receive-side transaction in progress (if any) is done.
+ * 
+ * Nests: within a burst, only the outermost gs_arbiter_tx_end() hands the radio back.
+ * 
+ * @param radio 
+ */
+void gs_arbiter_tx_begin(gs_radio_t *radio);
+
+/**
+ * @brief Ends a TX burst. The outermost one puts the radio back into pipe mode, if anything was written.
+ * 
+ * @param radio 
+ */
+void gs_arbiter_tx_end(gs_radio_t *radio);
+
+/**
+ * @brief Hands the radio back in the middle of a burst, e.g. to hear ACKs, however deeply nested it is.
+ * 
+ * @param radio 
+ * @return int What gs_arbiter_tx_resume() needs to take the burst up again.
+ */
+int gs_arbiter_tx_suspend(gs_radio_t *radio);
+
+/**
+ * @brief Takes the radio back for a burst gs_arbiter_tx_suspend() handed back.
+ * 
+ * @param radio 
+ * @param depth gs_arbiter_tx_suspend()'s result.
+ */
+void gs_arbiter_tx_resume(gs_radio_t *radio, int depth);
+
+/**
+ * @brief Writes one frame, in the caller's burst or in one of its own.
+ * 
+ * @param radio 
+ * @param buf 
+ * @param len 
+ * @return ssize_t The backend's write result.
+ */
+ssize_t gs_arbiter_write(gs_radio_t *radio, void *buf, ssize_t len);
+
+/**
+ * @brief Copies out a radio's arbiter counters.
+ * 
+ * @param radio 
+ * @param stats 
+ */
+void gs_arbiter_get_stats(gs_radio_t *radio, gs_arbiter_stats_t *stats);
+
+/**
+ * @brief Prints a radio's bursts and turnaround times.
+ * 
+ * @param name e.g. "UHF" or "Radio 1".
+ * @param radio 
+ */
+void gs_arbiter_print_stats(const char *name, gs_radio_t *radio);
+
+#endif // GS_ARBITER_HPP
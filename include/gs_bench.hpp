@@ -0,0 +1,76 @@
+/**
+ * @file gs_bench.hpp
+ * @author agent (agent@local)
+ * @brief Machine-readable benchmark results, compared against a baseline by tools/gs_benchcmp.out.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * A benchmark reports each headline number with gs_bench_report() as well as printing it. When GS_BENCH_JSON
+ * names a file, every result is appended to it as one JSON object per line:
+ * 
+ *     {"bench": "crc", "metric": "table", "value": 1.52e+08, "unit": "frames/s", "better": "higher", "tolerance": 0}
+ * 
+ * so the benchmarks of one `make bench` run, each its own process, end up in one file.
+ * 
+ */
+
+#ifndef GS_BENCH_HPP
+#define GS_BENCH_HPP
+
+#include <stdbool.h>
+
+#define GS_BENCH_ENV "GS_BENCH_JSON"
+#define GS_BENCH_NAME_MAX 64
+#define GS_BENCH_LINE_MAX 512
+
+/**
+ * @brief Which way a metric improves.
+ * 
+ */
+typedef enum
+{
+    GS_BENCH_LOWER,  // Times, latencies, copies.
+    GS_BENCH_HIGHER, // Rates, throughput.
+} gs_bench_better_t;
+
+/**
+ * @brief One result, as read back by gs_bench_parse().
+ * 
+ */
+typedef struct
+{
+    char bench[GS_BENCH_NAME_MAX];
+    char metric[GS_BENCH_NAME_MAX];
+    char unit[GS_BENCH_NAME_MAX];
+    double value;
+    gs_bench_better_t better;
+    double tolerance; // Percent it may worsen by before it counts as a regression, 0 for the comparison's default.
+} gs_bench_result_t;
+
+/**
+ * @brief Records one result in the GS_BENCH_JSON file, if there is one.
+ * 
+ * Names are written as given, so they must not need escaping: letters, digits, '_', '-', '/', '.' and spaces.
+ * 
+ * @param bench e.g. "crc".
+ * @param metric e.g. "table".
+ * @param value 
+ * @param unit e.g. "ns/frame".
+ * @param better 
+ * @param tolerance Percent the metric may worsen by between runs, for noisy ones (threads, the simulated air); 0
+ * for the comparison's default.
+ */
+void gs_bench_report(const char *bench, const char *metric, double value, const char *unit, gs_bench_better_t better, double tolerance);
+
+/**
+ * @brief Parses a line gs_bench_report() wrote.
+ * 
+ * @param line 
+ * @param result 
+ * @return int 1 on success, 0 if the line is not a result.
+ */
+int gs_bench_parse(const char *line, gs_bench_result_t *result);
+
+#endif // GS_BENCH_HPP
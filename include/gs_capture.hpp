@@ -0,0 +1,192 @@
+/**
+ * @file gs_capture.hpp
+ * @author agent (agent@local)
+ * @brief Pass capture: every radio frame and NetFrame appended to a memory-mapped file, for replay.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * A capture file is a gs_capture_header_t followed by fixed-size gs_capture_record_t slots, preallocated and
+ * mapped shared, so appending is a slot claim and a memcpy and the records survive a crash of the process.
+ * A writer claims slots with an atomic add and publishes each one by setting its kind last; readers skip
+ * slots whose kind is still 0. Anything longer than GS_CAPTURE_DATA bytes (NetFrame payloads) continues in
+ * the following slots, flagged GS_CAPTURE_MORE.
+ * 
+ * Files are named <prefix>-<UTC time>-<n>.cap. A new one is started by gs_capture_rotate(), and automatically
+ * when a frame arrives after a gap between passes. Replay them with tools/gs_replay.
+ * 
+ */
+
+#ifndef GS_CAPTURE_HPP
+#define GS_CAPTURE_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define GS_CAPTURE_MAGIC "GSCAP001"
+#define GS_CAPTURE_RECORD_SIZE 128
+#define GS_CAPTURE_DATA (GS_CAPTURE_RECORD_SIZE - 16) // Bytes of frame per record.
+#define GS_CAPTURE_PATH_MAX 256
+
+typedef enum
+{
+    GS_CAPTURE_NONE = 0, // Slot not written (yet).
+    GS_CAPTURE_UHF_RX,   // Raw radio frame as read, before FEC correction; result is the read's GST_ERRORS value.
+    GS_CAPTURE_UHF_TX,   // Radio frame as written; result is GST_SUCCESS or GST_ERROR.
+    GS_CAPTURE_NET_RX,   // NetFrame payload from the server; result is its NetType.
+    GS_CAPTURE_NET_TX,   // NetFrame payload to the server; result is its NetType, negated if the send failed.
+    GS_CAPTURE_KIND_NUM,
+} gs_capture_kind_t;
+
+#define GS_CAPTURE_MORE 0x1 // The frame continues in the next record.
+
+typedef struct
+{
+    char magic[8];
+    uint32_t record_size;
+    uint32_t capacity;      // Record slots after the header.
+    uint32_t count;         // Slots claimed, may exceed capacity once full.
+    uint32_t reserved;
+    uint64_t start_mono_ns; // CLOCK_MONOTONIC and CLOCK_REALTIME when the file was started, to date records.
+    uint64_t start_real_ns;
+    uint8_t pad[GS_CAPTURE_RECORD_SIZE - 40];
+} gs_capture_header_t;
+
+// Naturally aligned, so the kind and count can be accessed atomically in place.
+typedef struct
+{
+    uint64_t ts_ns; // CLOCK_MONOTONIC.
+    uint8_t kind;   // gs_capture_kind_t, written last.
+    uint8_t flags;
+    int16_t rssi;
+    int16_t result;
+    uint16_t len; // Bytes of data in this record.
+    uint8_t data[GS_CAPTURE_DATA];
+} gs_capture_record_t;
+
+static_assert(sizeof(gs_capture_header_t) == GS_CAPTURE_RECORD_SIZE, "capture header must fill one record");
+static_assert(sizeof(gs_capture_record_t) == GS_CAPTURE_RECORD_SIZE, "capture records must be GS_CAPTURE_RECORD_SIZE");
+
+/**
+ * @brief A frame read back by gs_capture_next().
+ * 
+ */
+typedef struct
+{
+    uint64_t ts_ns;
+    gs_capture_kind_t kind;
+    int16_t rssi;
+    int16_t result;
+    uint32_t len; // Whole frame, even if the buffer given to gs_capture_next() was shorter.
+} gs_capture_entry_t;
+
+typedef struct
+{
+    uint64_t records; //!< Records written, all files.
+    uint64_t dropped; //!< Frames that did not fit in their file.
+    uint64_t files;   //!< Files started.
+} gs_capture_stats_t;
+
+/**
+ * @brief Starts capturing to a new file.
+ * 
+ * @param prefix Path prefix of the capture files, e.g. /var/log/roof_uhf/pass.
+ * @param capacity Records per file; frames past it are counted as dropped until the next rotation.
+ * @param pass_gap_s Silence on the downlink after which the next received frame starts a new file, 0 to never.
+ * @return int 1 on success, 0 on failure.
+ */
+int gs_capture_start(const char *prefix, uint32_t capacity, int pass_gap_s);
+
+/**
+ * @brief Closes the current file, trimmed to what was written, and stops capturing.
+ * 
+ */
+void gs_capture_stop(void);
+
+/**
+ * @brief Closes the current file and starts a new one. Safe to call from any thread.
+ * 
+ * @return int 1 on success, 0 if capture is now off.
+ */
+int gs_capture_rotate(void);
+
+/**
+ * @brief Whether frames are being captured.
+ * 
+ * @return bool 
+ */
+bool gs_capture_active(void);
+
+/**
+ * @brief Appends a frame. Safe to call from any thread; does nothing unless capture is on.
+ * 
+ * @param kind 
+ * @param data 
+ * @param len 
+ * @param rssi 0 where it does not apply.
+ * @param result See gs_capture_kind_t.
+ */
+void gs_capture_frame(gs_capture_kind_t kind, const void *data, size_t len, int16_t rssi, int16_t result);
+
+/**
+ * @brief Snapshot of the capture statistics.
+ * 
+ * @param stats 
+ */
+void gs_capture_get_stats(gs_capture_stats_t *stats);
+
+/**
+ * @brief Path of the file being written, empty if capture is off.
+ * 
+ * @param path At least GS_CAPTURE_PATH_MAX bytes.
+ */
+void gs_capture_path(char *path);
+
+typedef struct gs_capture_file gs_capture_file_t;
+
+/**
+ * @brief Opens a capture file for reading. It may still be being written.
+ * 
+ * @param path 
+ * @return gs_capture_file_t* nullptr if it cannot be mapped or is not a capture file.
+ */
+gs_capture_file_t *gs_capture_open(const char *path);
+
+/**
+ * @brief Closes a capture file opened with gs_capture_open().
+ * 
+ * @param file 
+ */
+void gs_capture_close(gs_capture_file_t *file);
+
+/**
+ * @brief The file's header.
+ * 
+ * @param file 
+ * @return const gs_capture_header_t*
+ */
+const gs_capture_header_t *gs_capture_header(gs_capture_file_t *file);
+
+/**
+ * @brief Reads the frame at record *index and moves *index past it. Unwritten slots are skipped.
+ * 
+ * @param file 
+ * @param index Record to start at, 0 for the first.
+ * @param entry 
+ * @param buf Receives up to size bytes of the frame.
+ * @param size 
+ * @return int 1 if a frame was read, 0 at the end of the file.
+ */
+int gs_capture_next(gs_capture_file_t *file, uint32_t *index, gs_capture_entry_t *entry, uint8_t *buf, size_t size);
+
+/**
+ * @brief Name of a gs_capture_kind_t.
+ * 
+ * @param kind 
+ * @return const char*
+ */
+const char *gs_capture_kind_name(gs_capture_kind_t kind);
+
+#endif // GS_CAPTURE_HPP
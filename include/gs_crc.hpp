@@ -0,0 +1,100 @@
+/**
+ * @file gs_crc.hpp
+ * @author agent (agent@local)
+ * @brief CRC-16 used by GST framing, bit-exact with libsi446x's internal_crc16().
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * CRC-16/XMODEM: polynomial 0x1021, initial value 0, not reflected, no final XOR.
+ * 
+ * Several interchangeable implementations are provided. gs_crc16() dispatches to the fastest one the CPU
+ * supports, chosen once at first use.
+ * 
+ */
+
+#ifndef GS_CRC_HPP
+#define GS_CRC_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define GS_CRC16_POLY 0x1021
+
+typedef enum
+{
+    GS_CRC_AUTO = 0, //!< Pick the fastest supported implementation.
+    GS_CRC_BITWISE,  //!< One bit at a time, the reference.
+    GS_CRC_TABLE,    //!< One byte at a time, 256-entry table.
+    GS_CRC_SLICE8,   //!< Eight bytes at a time, 8x256-entry tables.
+    GS_CRC_CLMUL,    //!< Carry-less multiply folding (x86 PCLMULQDQ / ARMv8 PMULL).
+    GS_CRC_NUM_IMPL,
+} gs_crc_impl_t;
+
+/**
+ * @brief Computes the CRC-16 of a buffer with the dispatched implementation.
+ * 
+ * @param buf 
+ * @param len 
+ * @return uint16_t 
+ */
+uint16_t gs_crc16(const void *buf, size_t len);
+
+/**
+ * @brief Computes the CRC-16 of a buffer with a specific implementation.
+ * 
+ * @param impl Falls back to GS_CRC_TABLE if the implementation is not supported on this CPU.
+ * @param buf 
+ * @param len 
+ * @return uint16_t 
+ */
+uint16_t gs_crc16_impl(gs_crc_impl_t impl, const void *buf, size_t len);
+
+/**
+ * @brief Computes the CRC-16 of count equally sized buffers laid out stride bytes apart.
+ * 
+ * Frames are processed several at a time so independent CRC chains overlap in the pipeline, which is
+ * what capture replay and multi-radio ingest need.
+ * 
+ * @param first First byte of the first buffer.
+ * @param stride Distance in bytes between consecutive buffers, e.g. sizeof(gst_frame_t).
+ * @param len Bytes to checksum in each buffer.
+ * @param count Number of buffers.
+ * @param crcs Output, count entries.
+ */
+void gs_crc16_batch(const void *first, size_t stride, size_t len, size_t count, uint16_t *crcs);
+
+/**
+ * @brief Forces the implementation gs_crc16() and gs_crc16_batch() dispatch to.
+ * 
+ * @param impl GS_CRC_AUTO restores automatic selection.
+ * @return int 1 on success, 0 if the implementation is not supported on this CPU.
+ */
+int gs_crc16_select(gs_crc_impl_t impl);
+
+/**
+ * @brief Returns the implementation gs_crc16() currently dispatches to.
+ * 
+ * @return gs_crc_impl_t 
+ */
+gs_crc_impl_t gs_crc16_active(void);
+
+/**
+ * @brief Returns true if the implementation can run on this CPU.
+ * 
+ * @param impl 
+ * @return bool 
+ */
+bool gs_crc16_supported(gs_crc_impl_t impl);
+
+/**
+ * @brief Returns a printable name for an implementation.
+ * 
+ * @param impl 
+ * @return const char*
+ */
+const char *gs_crc16_name(gs_crc_impl_t impl);
+
+#endif // GS_CRC_HPP
@@ -0,0 +1,131 @@
+/**
+ * @file gs_diversity.hpp
+ * @author agent (agent@local)
+ * @brief Receive diversity across several radios: drops the copies of a frame heard on more than one, and picks the uplink radio.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * Every radio listening to the same pass hears the same transmissions, each copy a little earlier or later
+ * than the others. A frame is identified by a hash of its GUID and payload; the first valid copy offered is
+ * the one forwarded, and any identical frame offered from another radio within the window is a duplicate.
+ * The window must stay shorter than one frame's air time (53 ms at 9600 bps), so a spacecraft that sends
+ * the same frame twice in a row is not merged into one. A frame is only offered once its CRC has passed, so
+ * every copy is the same bytes and forwarding the first costs nothing in quality while adding no latency;
+ * which copy was loudest is still recorded, per radio, and is what the uplink choice is made on.
+ * 
+ * gs_div_offer() is called from one thread (the event loop's merge of the radios' RX rings).
+ * gs_div_uplink() may be called from another (the UHF TX thread).
+ * 
+ */
+
+#ifndef GS_DIVERSITY_HPP
+#define GS_DIVERSITY_HPP
+
+#include <stdint.h>
+#include "gs_uhf.hpp"
+
+#define GS_DIV_HISTORY 64 // Distinct frames remembered, far more than can arrive within one window.
+#define GS_DIV_RSSI_SHIFT 3 // Weight of a new frame in a radio's RSSI average, 1/8.
+#define GS_DIV_HYSTERESIS_DB 3 // How much louder another radio must be heard before the uplink moves to it.
+
+/**
+ * @brief One radio's share of the downlink, see gs_div_get_stats().
+ * 
+ */
+typedef struct
+{
+    uint64_t frames;     //!< Valid frames offered from this radio.
+    uint64_t first;      //!< Frames this radio delivered before any other, i.e. the ones forwarded.
+    uint64_t duplicates; //!< Copies of a frame another radio delivered first.
+    uint64_t best;       //!< Frames heard loudest on this radio, once settled (the window has passed).
+    uint64_t only;       //!< Frames no other radio heard, once settled.
+    int16_t rssi;        //!< Average RSSI, dBm.
+    uint64_t last_ns;    //!< Last frame offered, 0 if none.
+} gs_div_radio_stats_t;
+
+typedef struct
+{
+    uint64_t hash;
+    uint64_t rx_ns;     // First copy's arrival.
+    uint32_t radios;    // Bit per radio that delivered a copy.
+    int16_t best_rssi;
+    int8_t best;        // Radio that heard it loudest.
+} gs_div_entry_t;
+
+struct gs_diversity
+{
+    int num_radios;
+    uint64_t window_ns;
+    uint64_t stale_ns;
+    gs_div_entry_t history[GS_DIV_HISTORY]; // Ring, oldest at next once it has wrapped.
+    uint32_t next;
+    uint32_t count;
+    uint32_t unsettled; // Newest entries not yet credited to the stats, see gs_div_radio_stats_t::best.
+    gs_div_radio_stats_t radios[UHF_MAX_RADIOS];
+    int32_t rssi_avg[UHF_MAX_RADIOS]; // 1/16 dBm; with last_ns, read by gs_div_uplink() from another thread.
+    int uplink;                       // Only touched by gs_div_uplink().
+};
+
+typedef struct gs_diversity gs_diversity_t;
+
+/**
+ * @brief Creates a diversity combiner.
+ * 
+ * @param num_radios At most UHF_MAX_RADIOS.
+ * @param window_ms Copies of a frame arriving this far apart are the same transmission.
+ * @param stale_ms A radio that has heard nothing for this long is not chosen for the uplink on its RSSI.
+ * @return gs_diversity_t* nullptr on failure.
+ */
+gs_diversity_t *gs_div_create(int num_radios, uint32_t window_ms, uint32_t stale_ms);
+
+/**
+ * @brief Destroys a diversity combiner.
+ * 
+ * @param div 
+ */
+void gs_div_destroy(gs_diversity_t *div);
+
+/**
+ * @brief Offers a valid frame received on a radio.
+ * 
+ * @param div 
+ * @param radio Index of the radio it came from.
+ * @param frame 
+ * @param rssi 
+ * @param rx_ns When it came off the radio, CLOCK_MONOTONIC. Copies may be offered out of order.
+ * @return int 1 if this is the first copy (forward it), 0 if another radio already delivered it.
+ */
+int gs_div_offer(gs_diversity_t *div, int radio, const gst_frame_t *frame, int16_t rssi, uint64_t rx_ns);
+
+/**
+ * @brief Picks the radio to transmit on: the loudest of the ready radios that have heard the spacecraft
+ * recently, keeping the current one unless another is GS_DIV_HYSTERESIS_DB louder.
+ * 
+ * With no recent downlink to go on, the current radio is kept while it is ready, otherwise the first ready one.
+ * 
+ * @param div 
+ * @param ready Bit per radio that is up.
+ * @param now_ns 
+ * @return int The radio's index, -1 if none is ready.
+ */
+int gs_div_uplink(gs_diversity_t *div, uint32_t ready, uint64_t now_ns);
+
+/**
+ * @brief Gets one radio's statistics. Call from the thread offering frames, or after it has stopped.
+ * 
+ * @param div 
+ * @param radio 
+ * @param stats 
+ */
+void gs_div_get_stats(gs_diversity_t *div, int radio, gs_div_radio_stats_t *stats);
+
+/**
+ * @brief Prints every radio's statistics, see gs_div_get_stats().
+ * 
+ * @param div 
+ */
+void gs_div_print_stats(gs_diversity_t *div);
+
+#endif // GS_DIVERSITY_HPP
@@ -0,0 +1,145 @@
+/**
+ * @file gs_doppler.hpp
+ * @author agent (agent@local)
+ * @brief Doppler pre-compensation: a per-pass table of frequency offsets, and the retunes that follow it.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * At 437 MHz a LEO pass sweeps the carrier by about 10 kHz either way, most of it around the highest point.
+ * Before each pass the table is filled in from SGP4 every GS_DOPPLER_STEP_MS: the offset to receive the
+ * spacecraft's downlink on, and the offset to transmit on so the spacecraft hears the uplink on its frequency.
+ * 
+ * The radio is only retuned once either correction has drifted more than the tolerance from the one in
+ * effect, so most of a pass needs a retune every few seconds and the highest point one every half second or
+ * so. A retune goes through gs_radio_try_tune(): never during a TX burst, and never while a frame is arriving,
+ * since either would lose the frame; it is tried again GS_DOPPLER_RETRY_MS later instead.
+ * 
+ */
+
+#ifndef GS_DOPPLER_HPP
+#define GS_DOPPLER_HPP
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gs_sgp4.hpp"
+
+#define GS_DOPPLER_STEP_MS 100      // Table resolution.
+#define GS_DOPPLER_MAX_S 3600       // Longest stretch one table covers.
+#define GS_DOPPLER_RETRY_MS 10      // Wait before retrying a retune the radio was too busy for.
+#define GS_DOPPLER_C_KM_S 299792.458
+
+typedef struct gs_radio gs_radio_t;
+
+/**
+ * @brief Doppler counters, see gs_doppler_print().
+ * 
+ */
+typedef struct
+{
+    uint64_t tables;      //!< Tables built.
+    uint64_t build_ns;    //!< Time spent building them.
+    uint64_t retunes;     //!< Retunes applied.
+    uint64_t deferred;    //!< Retunes put off because the radio was transmitting or a frame was arriving.
+    uint64_t late_sum_ns; //!< A retune falling due to it being applied.
+    uint64_t late_max_ns;
+} gs_doppler_stats_t;
+
+/**
+ * @brief A pass's Doppler table, see gs_doppler_build().
+ * 
+ */
+typedef struct gs_doppler
+{
+    double downlink_hz; // Nominal frequencies.
+    double uplink_hz;
+    int32_t tol_hz;     // Largest error let through before a retune.
+    double start;       // Unix seconds of the first entry, 0 for no table.
+    int count;
+    int32_t *rx_hz;     // Offset to receive on, per GS_DOPPLER_STEP_MS from start.
+    int32_t *tx_hz;     // Offset to transmit on.
+    gs_doppler_stats_t stats;
+} gs_doppler_t;
+
+/**
+ * @brief Creates an empty Doppler table, with room for GS_DOPPLER_MAX_S.
+ * 
+ * @param downlink_hz The spacecraft's transmit frequency.
+ * @param uplink_hz Its receive frequency.
+ * @param tol_hz Error let through before a retune.
+ * @return gs_doppler_t* nullptr on failure.
+ */
+gs_doppler_t *gs_doppler_create(double downlink_hz, double uplink_hz, int32_t tol_hz);
+
+/**
+ * @brief Destroys a Doppler table.
+ * 
+ * @param dop May be nullptr.
+ */
+void gs_doppler_destroy(gs_doppler_t *dop);
+
+/**
+ * @brief The receive and transmit offsets for a range rate.
+ * 
+ * @param dop 
+ * @param range_rate km/s, positive while the spacecraft moves away.
+ * @param rx_hz 
+ * @param tx_hz 
+ */
+void gs_doppler_offsets(const gs_doppler_t *dop, double range_rate, int32_t *rx_hz, int32_t *tx_hz);
+
+/**
+ * @brief Fills the table in for a stretch of time, usually a pass with some margin either side.
+ * 
+ * @param dop 
+ * @param sat 
+ * @param station Set up with gs_sgp4_station().
+ * @param from Unix seconds.
+ * @param to Unix seconds; the table stops GS_DOPPLER_MAX_S after from.
+ * @return int Entries filled in, 0 on failure (the table is then empty).
+ */
+int gs_doppler_build(gs_doppler_t *dop, const gs_sgp4_t *sat, const gs_station_t *station, double from, double to);
+
+/**
+ * @brief The offsets at a time: the entry at or before it, the first one before the table starts.
+ * 
+ * @param dop 
+ * @param t Unix seconds.
+ * @param rx_hz 
+ * @param tx_hz 
+ * @return bool False past the end of the table (or without one).
+ */
+bool gs_doppler_lookup(const gs_doppler_t *dop, double t, int32_t *rx_hz, int32_t *tx_hz);
+
+/**
+ * @brief When the offsets will have drifted more than the tolerance from a pair in effect.
+ * 
+ * @param dop 
+ * @param t Unix seconds, now.
+ * @param rx_hz In effect.
+ * @param tx_hz 
+ * @return double Unix seconds, t itself if they already have, 0 if not before the end of the table.
+ */
+double gs_doppler_due(const gs_doppler_t *dop, double t, int32_t rx_hz, int32_t tx_hz);
+
+/**
+ * @brief Retunes a radio to the offsets for now, if it is due.
+ * 
+ * @param dop 
+ * @param radio 
+ * @param t Unix seconds, now.
+ * @param next Set to when to call again: the next retune, GS_DOPPLER_RETRY_MS on if the radio was busy, 0 if
+ * not before the end of the table.
+ * @return int 1 if retuned, 0 if not due, -1 if put off, -2 if the radio cannot be retuned.
+ */
+int gs_doppler_apply(gs_doppler_t *dop, gs_radio_t *radio, double t, double *next);
+
+/**
+ * @brief Prints the Doppler counters.
+ * 
+ * @param dop 
+ */
+void gs_doppler_print(const gs_doppler_t *dop);
+
+#endif // GS_DOPPLER_HPP
@@ -0,0 +1,77 @@
+/**
+ * @file gs_fec.hpp
+ * @author agent (agent@local)
+ * @brief Reed-Solomon forward error correction for GST frames.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * RS(255, 239) over GF(2^8) (polynomial 0x11d, generator roots alpha^0 to alpha^15), shortened to the block
+ * being protected: GS_FEC_PARITY parity bytes correct up to GS_FEC_T corrupted bytes anywhere in the block,
+ * parity included. A burst of bit errors inside one byte costs one of those, which suits the si446x's
+ * error patterns at low elevation better than a bit-level code would.
+ * 
+ * The encoder is table-driven and shifts the parity register a word at a time. The decoder checks a block
+ * by re-encoding it, so a clean frame costs about as much as encoding it; the syndromes, Berlekamp-Massey,
+ * Chien search and Forney only run when the parity does not match.
+ * 
+ */
+
+#ifndef GS_FEC_HPP
+#define GS_FEC_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define GS_FEC_PARITY 16 // Parity bytes per block.
+#define GS_FEC_T (GS_FEC_PARITY / 2) // Correctable bytes per block.
+#define GS_FEC_MAX_BLOCK 255 // Data plus parity.
+
+/**
+ * @brief How a link frames its uplink, see gs_radio_t::fec.
+ * 
+ */
+typedef enum
+{
+    GS_FEC_OFF = 0, //!< Legacy CRC-only frames (default).
+    GS_FEC_ON,      //!< Always send frames with Reed-Solomon parity.
+    GS_FEC_AUTO,    //!< Send with parity while the far end is doing so.
+} gs_fec_mode_t;
+
+/**
+ * @brief Computes the parity of a block.
+ * 
+ * @param data 
+ * @param len At most GS_FEC_MAX_BLOCK - GS_FEC_PARITY.
+ * @param parity Output, GS_FEC_PARITY bytes.
+ */
+void gs_fec_encode(const void *data, size_t len, uint8_t *parity);
+
+/**
+ * @brief Corrects a received block in place.
+ * 
+ * @param block Data followed by its GS_FEC_PARITY parity bytes.
+ * @param len Data plus parity, at most GS_FEC_MAX_BLOCK.
+ * @return int Bytes corrected (0 for a clean block), -1 if there were more errors than the code can correct.
+ */
+int gs_fec_decode(uint8_t *block, size_t len);
+
+/**
+ * @brief Parses "off", "on" or "auto".
+ * 
+ * @param str 
+ * @param mode 
+ * @return int 1 on success, 0 if str is not a mode.
+ */
+int gs_fec_mode_parse(const char *str, gs_fec_mode_t *mode);
+
+/**
+ * @brief Returns the name gs_fec_mode_parse() accepts for a mode.
+ * 
+ * @param mode 
+ * @return const char*
+ */
+const char *gs_fec_mode_name(gs_fec_mode_t mode);
+
+#endif // GS_FEC_HPP
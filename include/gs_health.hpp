@@ -0,0 +1,129 @@
+/**
+ * @file gs_health.hpp
+ * @author agent (agent@local)
+ * @brief Radio health monitor: the part info is probed in the background and published for the hot paths to read.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * Asking the radio for its part info costs an SPI round trip, too much to spend on every frame. Instead the
+ * event loop probes each ready radio every global_data_t::health_ms and publishes what it found in the
+ * radio's gs_health_t; the RX and TX paths read gs_health_ready(), one load.
+ * 
+ * A probe fails if the radio does not answer with the part, ID, revision and ROM it reported when it was
+ * initialized (a radio that reset or lost its SPI link answers with something else, or nothing). The radio
+ * is then published as down and the one thread that owns its receive side re-initializes it: its RX thread,
+ * or the event loop when the radio is read inline. The snapshot is a seqlock, so readers never block the
+ * monitor or the owner, nor each other.
+ * 
+ */
+
+#ifndef GS_HEALTH_HPP
+#define GS_HEALTH_HPP
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief What the monitor last found, see gs_health_get().
+ * 
+ */
+typedef struct
+{
+    bool ready;        //!< Initialized and answering as it did at init.
+    uint64_t probe_ns; //!< Last probe or init, CLOCK_MONOTONIC; 0 if never.
+    uint64_t probes;   //!< Probes run.
+    uint32_t failures; //!< Failed probes and inits.
+    uint32_t reinits;  //!< Inits after the first that brought the radio up.
+    uint16_t part;     //!< Part number the last probe or init read.
+} gs_health_snapshot_t;
+
+/**
+ * @brief A radio's published health. Lives in gs_radio_t.
+ * 
+ */
+typedef struct
+{
+    bool ready;                // Also in snap, here for gs_health_ready() to load alone.
+    bool lost;                 // A probe failed and the radio has not been initialized since.
+    uint32_t seq;              // Odd while a writer holds snap.
+    gs_health_snapshot_t snap; // Read with gs_health_get().
+    uint16_t part;             // Answers at the last init, which probes must match.
+    uint16_t id;
+    uint8_t chip_rev;
+    uint8_t rom_id;
+} gs_health_t;
+
+typedef struct gs_radio gs_radio_t;
+typedef struct gs_radio_info gs_radio_info_t;
+
+/**
+ * @brief Whether the radio is up, for the hot paths.
+ * 
+ * @param health 
+ * @return bool 
+ */
+static inline bool gs_health_ready(const gs_health_t *health)
+{
+    return __atomic_load_n(&health->ready, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Whether a probe found the radio down and it is waiting for its owner to re-initialize it.
+ * 
+ * Unlike !gs_health_ready(), false for a radio that was never initialized through gs_uhf_init().
+ * 
+ * @param health 
+ * @return bool 
+ */
+static inline bool gs_health_lost(const gs_health_t *health)
+{
+    return __atomic_load_n(&health->lost, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Whether a radio's part info is what it answered at its last init.
+ * 
+ * @param health 
+ * @param info 
+ * @return bool 
+ */
+bool gs_health_matches(const gs_health_t *health, const gs_radio_info_t *info);
+
+/**
+ * @brief Reads a consistent copy of the radio's health. Lock-free; retries while a writer is mid-update.
+ * 
+ * @param health 
+ * @param snap 
+ */
+void gs_health_get(const gs_health_t *health, gs_health_snapshot_t *snap);
+
+/**
+ * @brief Probes a ready radio's part info. Called by the monitor only.
+ * 
+ * @param radio 
+ * @return int 1 if it is healthy (or not ready, so not probed), 0 if it failed and is now published as down.
+ */
+int gs_health_probe(gs_radio_t *radio);
+
+/**
+ * @brief Records the outcome of initializing a radio, see gs_uhf_init().
+ * 
+ * On success the part info becomes what later probes must match, and the radio is published as ready.
+ * 
+ * @param radio 
+ * @param info The part info read right after the init, nullptr if the init failed.
+ * @return int 1 if the radio is now ready, 0 if not.
+ */
+int gs_health_init(gs_radio_t *radio, const gs_radio_info_t *info);
+
+/**
+ * @brief Prints a radio's health.
+ * 
+ * @param name e.g. "UHF" or "Radio 1".
+ * @param radio 
+ */
+void gs_health_print(const char *name, gs_radio_t *radio);
+
+#endif // GS_HEALTH_HPP
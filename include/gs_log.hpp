@@ -0,0 +1,224 @@
+/**
+ * @file gs_log.hpp
+ * @author agent (agent@local)
+ * @brief Asynchronous binary logger for the hot paths.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * logprintlf() takes the same format strings as dbprintlf(), but the calling thread only copies a timestamp,
+ * a call site id and the raw arguments into its own lock-free buffer. A background thread formats the
+ * records to stderr or writes them, still binary, to a log file that tools/gs_logdecode turns back into text.
+ * 
+ * Levels below GS_LOG_MIN_LEVEL are removed at compile time, e.g. -DGS_LOG_MIN_LEVEL=GS_LOG_INFO.
+ * 
+ * Supported arguments: integers, floating point, C strings (copied, up to GS_LOG_STR_MAX bytes) and pointers.
+ * 
+ */
+
+#ifndef GS_LOG_HPP
+#define GS_LOG_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#define GS_LOG_DEBUG 0
+#define GS_LOG_INFO 1
+#define GS_LOG_WARN 2
+#define GS_LOG_ERROR 3
+#define GS_LOG_FATAL 4
+
+#ifndef GS_LOG_MIN_LEVEL
+#define GS_LOG_MIN_LEVEL GS_LOG_DEBUG
+#endif
+
+#define GS_LOG_BUFFER_SIZE (256 * 1024) // Per-thread record buffer, bytes; a power of two.
+#define GS_LOG_MAX_ARGS 8
+#define GS_LOG_STR_MAX 64 // Longest string argument kept, longer ones are truncated.
+#define GS_LOG_MAX_SITES 4096
+#define GS_LOG_FLUSH_MS 50 // Longest a record waits in its buffer.
+#define GS_LOG_MAGIC "GSLOG001"
+
+/**
+ * @brief One logprintlf() call site, static for the life of the program.
+ * 
+ */
+typedef struct
+{
+    const char *format;
+    const char *file;
+    const char *func;
+    int line;
+    int level;
+    uint32_t id; // Assigned on first use, 0 until then.
+} gs_log_site_t;
+
+typedef enum
+{
+    GS_LOG_ARG_INT = 1,
+    GS_LOG_ARG_UINT,
+    GS_LOG_ARG_DOUBLE,
+    GS_LOG_ARG_STR,
+    GS_LOG_ARG_PTR,
+} gs_log_arg_type_t;
+
+typedef struct
+{
+    uint8_t type; // gs_log_arg_type_t
+    union
+    {
+        int64_t i;
+        uint64_t u;
+        double d;
+        const char *s;
+    };
+} gs_log_arg_t;
+
+/**
+ * @brief Logs a message through the asynchronous logger. Same format and color macros as dbprintlf().
+ * 
+ */
+#define logprintlf(level, format, ...)                                                                \
+    do                                                                                                \
+    {                                                                                                 \
+        if ((level) >= GS_LOG_MIN_LEVEL)                                                              \
+        {                                                                                             \
+            static gs_log_site_t gs_log_site_ = {format, __FILE__, __func__, __LINE__, (level), 0}; \
+            gs_log_emit(&gs_log_site_, ##__VA_ARGS__);                                                \
+        }                                                                                             \
+    } while (0)
+
+static inline gs_log_arg_t gs_log_arg(long long v)
+{
+    gs_log_arg_t a;
+    a.type = GS_LOG_ARG_INT;
+    a.i = v;
+    return a;
+}
+
+static inline gs_log_arg_t gs_log_arg(unsigned long long v)
+{
+    gs_log_arg_t a;
+    a.type = GS_LOG_ARG_UINT;
+    a.u = v;
+    return a;
+}
+
+static inline gs_log_arg_t gs_log_arg(double v)
+{
+    gs_log_arg_t a;
+    a.type = GS_LOG_ARG_DOUBLE;
+    a.d = v;
+    return a;
+}
+
+static inline gs_log_arg_t gs_log_arg(const char *v)
+{
+    gs_log_arg_t a;
+    a.type = GS_LOG_ARG_STR;
+    a.s = v;
+    return a;
+}
+
+static inline gs_log_arg_t gs_log_arg(const void *v)
+{
+    gs_log_arg_t a;
+    a.type = GS_LOG_ARG_PTR;
+    a.u = (uintptr_t)v;
+    return a;
+}
+
+static inline gs_log_arg_t gs_log_arg(int v) { return gs_log_arg((long long)v); }
+static inline gs_log_arg_t gs_log_arg(long v) { return gs_log_arg((long long)v); }
+static inline gs_log_arg_t gs_log_arg(short v) { return gs_log_arg((long long)v); }
+static inline gs_log_arg_t gs_log_arg(signed char v) { return gs_log_arg((long long)v); }
+static inline gs_log_arg_t gs_log_arg(char v) { return gs_log_arg((long long)v); }
+static inline gs_log_arg_t gs_log_arg(bool v) { return gs_log_arg((long long)v); }
+static inline gs_log_arg_t gs_log_arg(unsigned int v) { return gs_log_arg((unsigned long long)v); }
+static inline gs_log_arg_t gs_log_arg(unsigned long v) { return gs_log_arg((unsigned long long)v); }
+static inline gs_log_arg_t gs_log_arg(unsigned short v) { return gs_log_arg((unsigned long long)v); }
+static inline gs_log_arg_t gs_log_arg(unsigned char v) { return gs_log_arg((unsigned long long)v); }
+static inline gs_log_arg_t gs_log_arg(float v) { return gs_log_arg((double)v); }
+static inline gs_log_arg_t gs_log_arg(char *v) { return gs_log_arg((const char *)v); }
+
+/**
+ * @brief Copies one record into the calling thread's buffer. Use logprintlf() instead.
+ * 
+ * @param site 
+ * @param args 
+ * @param nargs 
+ */
+void gs_log_write(gs_log_site_t *site, const gs_log_arg_t *args, int nargs);
+
+template <typename... Args>
+static inline void gs_log_emit(gs_log_site_t *site, Args... args)
+{
+    static_assert(sizeof...(Args) <= GS_LOG_MAX_ARGS, "Too many logprintlf() arguments.");
+    gs_log_arg_t packed[sizeof...(Args) + 1] = {gs_log_arg(args)...};
+    gs_log_write(site, packed, sizeof...(Args));
+}
+
+/**
+ * @brief Starts the background thread.
+ * 
+ * Until this is called, and after gs_log_stop(), records are formatted synchronously to stderr.
+ * 
+ * @param path Binary log file, or nullptr to format records to stderr.
+ * @return int 1 on success, 0 on failure.
+ */
+int gs_log_start(const char *path);
+
+/**
+ * @brief Drains every buffer and stops the background thread.
+ * 
+ */
+void gs_log_stop(void);
+
+/**
+ * @brief Blocks until every record logged before the call has been written out.
+ * 
+ */
+void gs_log_flush(void);
+
+/**
+ * @brief Records dropped because a thread's buffer was full.
+ * 
+ * @return uint64_t 
+ */
+uint64_t gs_log_dropped(void);
+
+/**
+ * @brief Formats a printf-style format string with logged arguments.
+ * 
+ * Shared by the background thread and tools/gs_logdecode.
+ * 
+ * @param out 
+ * @param size 
+ * @param format 
+ * @param args String arguments point at NUL-terminated copies.
+ * @param nargs 
+ * @return int Characters written, excluding the NUL.
+ */
+int gs_log_format(char *out, size_t size, const char *format, const gs_log_arg_t *args, int nargs);
+
+/**
+ * @brief Converts a binary log written by gs_log_start(path) back into text.
+ * 
+ * @param in 
+ * @param out 
+ * @param plain Strip the color escapes.
+ * @return int Number of records decoded, negative if the file is not a log or is corrupt.
+ */
+int gs_log_decode(FILE *in, FILE *out, bool plain);
+
+/**
+ * @brief Printable name of a level.
+ * 
+ * @param level 
+ * @return const char*
+ */
+const char *gs_log_level_name(int level);
+
+#endif // GS_LOG_HPP
@@ -0,0 +1,100 @@
+/**
+ * @file gs_lz.hpp
+ * @author agent (agent@local)
+ * @brief Small-window LZSS compression of uplink payloads, with optional shared dictionaries.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * The format is heatshrink's: a bit stream of literals (a 1 bit, then the byte) and back-references (a 0 bit,
+ * GS_LZ_WINDOW_BITS of distance, GS_LZ_LENGTH_BITS of length) into the last GS_LZ_WINDOW bytes, after a
+ * gs_lz_header_t giving the dictionary and the original length. The decoder needs no memory besides the
+ * buffer it decodes into, or a GS_LZ_WINDOW-byte ring if it streams, so the spacecraft can afford it.
+ * 
+ * A dictionary is history both ends already hold: the encoder may refer back into it from the first byte
+ * on, which is what lets a payload of a few hundred bytes compress at all. They are compiled in, so the
+ * spacecraft's build has to carry the same ones under the same IDs.
+ * 
+ */
+
+#ifndef GS_LZ_HPP
+#define GS_LZ_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#define GS_LZ_WINDOW_BITS 8
+#define GS_LZ_LENGTH_BITS 4
+#define GS_LZ_WINDOW (1 << GS_LZ_WINDOW_BITS)
+#define GS_LZ_MIN_MATCH 2 // Shorter is cheaper as literals.
+#define GS_LZ_MAX_MATCH (GS_LZ_MIN_MATCH + (1 << GS_LZ_LENGTH_BITS) - 1)
+
+#define GS_LZ_DICT_NONE 0
+#define GS_LZ_DICT_CMD 1  // cmd_input_t commands, alone or batched.
+#define GS_LZ_DICT_TEXT 2 // Scripts, configuration files and element sets.
+#define GS_LZ_DICTS 3
+
+/**
+ * @brief Leads every compressed payload, little-endian.
+ * 
+ */
+typedef struct __attribute__((packed))
+{
+    uint8_t dict; // GS_LZ_DICT_*
+    uint16_t len; // Original length.
+} gs_lz_header_t;
+
+/**
+ * @brief Compresses a payload.
+ * 
+ * @param dst Receives the header and the bit stream; nullptr only counts the size.
+ * @param cap Most dst may take. Compression stops as soon as the output would not fit.
+ * @param src 
+ * @param len At most 0xffff bytes.
+ * @param dict GS_LZ_DICT_*
+ * @return ssize_t Compressed size, 0 if it would not fit in cap, -1 on bad arguments.
+ */
+ssize_t gs_lz_compress(void *dst, size_t cap, const void *src, size_t len, int dict);
+
+/**
+ * @brief Compresses a payload with whichever dictionary, or none, makes it smallest.
+ * 
+ * @param dst 
+ * @param cap 
+ * @param src 
+ * @param len 
+ * @return ssize_t Compressed size, 0 if it would not fit in cap with any, -1 on bad arguments.
+ */
+ssize_t gs_lz_pack(void *dst, size_t cap, const void *src, size_t len);
+
+/**
+ * @brief Decompresses a payload.
+ * 
+ * @param dst 
+ * @param cap Most dst may take.
+ * @param src Starts with a gs_lz_header_t.
+ * @param len Bytes at src; anything past the end of the stream (e.g. a frame's padding) is ignored.
+ * @return ssize_t Original length, -1 if malformed, for an unknown dictionary, or too long for cap.
+ */
+ssize_t gs_lz_decompress(void *dst, size_t cap, const void *src, size_t len);
+
+/**
+ * @brief A compiled-in dictionary.
+ * 
+ * @param dict GS_LZ_DICT_*
+ * @param len Set to its length, at most GS_LZ_WINDOW.
+ * @return const uint8_t* nullptr for GS_LZ_DICT_NONE or an unknown ID.
+ */
+const uint8_t *gs_lz_dict(int dict, size_t *len);
+
+/**
+ * @brief A dictionary's name, for logs.
+ * 
+ * @param dict 
+ * @return const char*
+ */
+const char *gs_lz_dict_name(int dict);
+
+#endif // GS_LZ_HPP
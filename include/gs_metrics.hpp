@@ -0,0 +1,284 @@
+/**
+ * @file gs_metrics.hpp
+ * @author agent (agent@local)
+ * @brief Per-stage latency histograms and counters, served in Prometheus text format on a Unix socket.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * Every recording thread owns a shard, so recording is a thread-local lookup and a few plain increments;
+ * shards are only summed when the endpoint is scraped. Latency histograms are log-linear (HDR style):
+ * eight sub-buckets per power of two, so any value is placed within 12.5%.
+ * 
+ * Scrape with e.g.: curl --unix-socket /tmp/roof_uhf_metrics.sock http://localhost/metrics
+ * 
+ */
+
+#ifndef GS_METRICS_HPP
+#define GS_METRICS_HPP
+
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+#define METRICS_SUB_BITS 3
+#define METRICS_SUB_BUCKETS (1 << METRICS_SUB_BITS)
+#define METRICS_HIST_BUCKETS ((64 - METRICS_SUB_BITS + 1) * METRICS_SUB_BUCKETS)
+#define METRICS_RSSI_MIN -160 // dBm, lower readings are clamped.
+#define METRICS_RSSI_BUCKETS 161 // One per dBm, METRICS_RSSI_MIN to 0.
+#define METRICS_MAX_RINGS 12 // uhf_rx and one per radio (UHF_MAX_RADIOS), with room to spare.
+
+typedef enum
+{
+    GS_STAGE_RADIO_READ = 0, //!< The radio read that returned a frame.
+    GS_STAGE_VALIDATE,       //!< GUID/CRC checks.
+    GS_STAGE_ENQUEUE,        //!< gs_uhf_read() returning to the frame being committed to the RX ring.
+    GS_STAGE_NET_SEND,       //!< NetFrame::sendFrame().
+    GS_STAGE_DOWNLINK,       //!< gs_uhf_read() returning to sendFrame() completing, including time queued.
+    GS_STAGE_NET_RECV,       //!< recvFrame() returning to the payload being extracted.
+    GS_STAGE_RADIO_WRITE,    //!< gs_uhf_write(), the command's time on the air.
+    GS_STAGE_UPLINK,         //!< recvFrame() returning to gs_uhf_write() completing.
+    GS_STAGE_TX_QUEUE,       //!< Uplink command queued to its successful transmission starting.
+    GS_STAGE_RX_TO_TX,       //!< A TX burst asked for to it getting the radio, see gs_arbiter.hpp.
+    GS_STAGE_TX_TO_RX,       //!< A TX burst's last write to the radio listening again.
+    GS_STAGE_MODEM_SWITCH,   //!< A modem profile asked for to every ready radio having it, see gs_modem.hpp.
+    GS_STAGE_COMPRESS,       //!< Compressing an uplink payload, or finding it not worth it, see gs_lz.hpp.
+    GS_STAGE_NUM,
+} gs_metric_stage_t;
+
+typedef enum
+{
+    GS_COUNT_UHF_RX_FRAMES = 0,
+    GS_COUNT_UHF_RX_TIMEOUTS,
+    GS_COUNT_GST_ERROR,             //!< GST_ERROR
+    GS_COUNT_GST_PACKET_INCOMPLETE, //!< GST_PACKET_INCOMPLETE
+    GS_COUNT_GST_GUID_ERROR,        //!< GST_GUID_ERROR
+    GS_COUNT_GST_CRC_MISMATCH,      //!< GST_CRC_MISMATCH
+    GS_COUNT_GST_CRC_ERROR,         //!< GST_CRC_ERROR
+    GS_COUNT_UHF_TX_FRAMES,
+    GS_COUNT_UHF_TX_FAILURES,
+    GS_COUNT_NET_TX_FRAMES,
+    GS_COUNT_NET_TX_FAILURES,
+    GS_COUNT_NET_RX_FRAMES,
+    GS_COUNT_TX_QUEUE_FULL,         //!< Uplink commands NACKed because the TX queue was full.
+    GS_COUNT_TX_EXPIRED,            //!< Uplink commands NACKed at their deadline.
+    GS_COUNT_SAR_TX_MESSAGES,       //!< Multi-frame uplinks fully acknowledged.
+    GS_COUNT_SAR_RX_MESSAGES,       //!< Multi-frame downlinks reassembled.
+    GS_COUNT_SAR_RETRANSMITS,       //!< Uplink segments sent again.
+    GS_COUNT_FEC_RX_FRAMES,         //!< Received frames carrying Reed-Solomon parity.
+    GS_COUNT_FEC_CORRECTED_BYTES,   //!< Bytes repaired by the Reed-Solomon decoder.
+    GS_COUNT_FEC_UNCORRECTABLE,     //!< Parity frames with more errors than the code corrects.
+    GS_COUNT_DOWNLINK_COPY_BYTES,   //!< Frame bytes copied between the radio and the server socket, NetFrame's own copy included.
+    GS_COUNT_UPLINK_COPY_BYTES,     //!< Frame bytes copied between the server socket and the radio, NetFrame's own copy included.
+    GS_COUNT_DIVERSITY_DUPLICATES,  //!< Copies of a frame already delivered by another radio, dropped.
+    GS_COUNT_UPLINK_SWITCHES,       //!< Times the uplink moved to a different radio.
+    GS_COUNT_SPOOL_FRAMES,          //!< Downlinked frames written to the spool while the server was unreachable.
+    GS_COUNT_SPOOL_DRAINED,         //!< Spooled frames delivered to the server.
+    GS_COUNT_NET_CONNECT_FAILURES,  //!< Attempts to reconnect to the server that failed.
+    GS_COUNT_RADIO_PROBE_FAILURES,  //!< Health probes that found a radio no longer answering as it did at init.
+    GS_COUNT_RADIO_REINITS,         //!< Radios brought back up after a failed probe or init.
+    GS_COUNT_UHF_TX_BURSTS,         //!< TX bursts, each one RX to TX and back.
+    GS_COUNT_PASS_WAKES,            //!< Radios woken ahead of a pass, see gs_pass.hpp.
+    GS_COUNT_PASS_SLEEPS,           //!< Radios put to sleep after a pass.
+    GS_COUNT_DOPPLER_RETUNES,       //!< Doppler corrections applied, see gs_doppler.hpp.
+    GS_COUNT_DOPPLER_DEFERRED,      //!< Doppler corrections put off while a radio was transmitting or receiving a frame.
+    GS_COUNT_MODEM_SWITCHES,        //!< Modem profiles applied to a radio, see gs_modem.hpp.
+    GS_COUNT_MODEM_DEFERRED,        //!< Modem profile switches put off while a radio was transmitting or receiving a frame.
+    GS_COUNT_RATE_UPS,              //!< Adaptive data rate steps up.
+    GS_COUNT_RATE_DOWNS,            //!< Adaptive data rate steps down.
+    GS_COUNT_LZ_PACKED,             //!< Uplink payloads sent compressed.
+    GS_COUNT_LZ_SKIPPED,            //!< Uplink payloads that would not have saved a frame compressed, sent as they were.
+    GS_COUNT_LZ_SAVED_FRAMES,       //!< Frames compression kept off the air.
+    GS_COUNT_NUM,
+} gs_metric_counter_t;
+
+/**
+ * @brief One thread's metrics. Written only by its thread, read by the endpoint.
+ * 
+ */
+typedef struct gs_metrics_shard
+{
+    uint64_t counters[GS_COUNT_NUM];
+    uint64_t hist[GS_STAGE_NUM][METRICS_HIST_BUCKETS];
+    uint64_t hist_sum_ns[GS_STAGE_NUM];
+    uint64_t rssi[METRICS_RSSI_BUCKETS];
+    struct gs_metrics_shard *next;
+} gs_metrics_shard_t;
+
+extern thread_local gs_metrics_shard_t *gs_metrics_tls;
+
+/**
+ * @brief Allocates and registers the calling thread's shard. Use the recording functions instead.
+ * 
+ * @return gs_metrics_shard_t* nullptr on failure.
+ */
+gs_metrics_shard_t *gs_metrics_shard(void);
+
+static inline void gs_metrics_bump(uint64_t *slot, uint64_t by)
+{
+    // Single writer: a relaxed load-add-store is enough and avoids a locked instruction.
+    __atomic_store_n(slot, __atomic_load_n(slot, __ATOMIC_RELAXED) + by, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Histogram bucket for a value.
+ * 
+ * @param value 
+ * @return int 
+ */
+static inline int gs_metrics_bucket(uint64_t value)
+{
+    if (value < METRICS_SUB_BUCKETS)
+    {
+        return value;
+    }
+    int msb = 63 - __builtin_clzll(value);
+    return (msb - METRICS_SUB_BITS + 1) * METRICS_SUB_BUCKETS + ((value >> (msb - METRICS_SUB_BITS)) & (METRICS_SUB_BUCKETS - 1));
+}
+
+/**
+ * @brief Lowest value that lands in a bucket.
+ * 
+ * @param bucket 
+ * @return uint64_t 
+ */
+static inline uint64_t gs_metrics_bucket_low(int bucket)
+{
+    if (bucket < METRICS_SUB_BUCKETS)
+    {
+        return bucket;
+    }
+    int msb = bucket / METRICS_SUB_BUCKETS + METRICS_SUB_BITS - 1;
+    return (uint64_t)(METRICS_SUB_BUCKETS + bucket % METRICS_SUB_BUCKETS) << (msb - METRICS_SUB_BITS);
+}
+
+/**
+ * @brief Counts an event.
+ * 
+ * @param counter 
+ */
+static inline void gs_metrics_count(gs_metric_counter_t counter)
+{
+    gs_metrics_shard_t *shard = gs_metrics_tls != nullptr ? gs_metrics_tls : gs_metrics_shard();
+    if (shard != nullptr)
+    {
+        gs_metrics_bump(&shard->counters[counter], 1);
+    }
+}
+
+/**
+ * @brief Counts several events at once.
+ * 
+ * @param counter 
+ * @param n 
+ */
+static inline void gs_metrics_add(gs_metric_counter_t counter, uint64_t n)
+{
+    gs_metrics_shard_t *shard = gs_metrics_tls != nullptr ? gs_metrics_tls : gs_metrics_shard();
+    if (shard != nullptr)
+    {
+        gs_metrics_bump(&shard->counters[counter], n);
+    }
+}
+
+/**
+ * @brief Records how long a pipeline stage took.
+ * 
+ * @param stage 
+ * @param ns 
+ */
+static inline void gs_metrics_record(gs_metric_stage_t stage, uint64_t ns)
+{
+    gs_metrics_shard_t *shard = gs_metrics_tls != nullptr ? gs_metrics_tls : gs_metrics_shard();
+    if (shard != nullptr)
+    {
+        gs_metrics_bump(&shard->hist[stage][gs_metrics_bucket(ns)], 1);
+        gs_metrics_bump(&shard->hist_sum_ns[stage], ns);
+    }
+}
+
+/**
+ * @brief Records the RSSI of a received frame.
+ * 
+ * @param rssi dBm.
+ */
+static inline void gs_metrics_rssi(int16_t rssi)
+{
+    gs_metrics_shard_t *shard = gs_metrics_tls != nullptr ? gs_metrics_tls : gs_metrics_shard();
+    if (shard != nullptr)
+    {
+        int bucket = rssi < METRICS_RSSI_MIN ? 0 : rssi > 0 ? METRICS_RSSI_BUCKETS - 1 : rssi - METRICS_RSSI_MIN;
+        gs_metrics_bump(&shard->rssi[bucket], 1);
+    }
+}
+
+/**
+ * @brief Counts a gs_uhf_read() failure by its GST_ERRORS code.
+ * 
+ * @param retval Negative gs_uhf_read() return value.
+ */
+void gs_metrics_count_gst_error(ssize_t retval);
+
+/**
+ * @brief Sum of a counter over every thread.
+ * 
+ * @param counter 
+ * @return uint64_t 
+ */
+uint64_t gs_metrics_counter(gs_metric_counter_t counter);
+
+/**
+ * @brief Estimates a stage's latency quantile over every thread.
+ * 
+ * @param stage 
+ * @param quantile 0 to 1.
+ * @param count Set to the number of samples, may be nullptr.
+ * @return uint64_t Nanoseconds, the midpoint of the bucket holding the quantile; 0 with no samples.
+ */
+uint64_t gs_metrics_quantile(gs_metric_stage_t stage, double quantile, uint64_t *count);
+
+typedef struct gs_ring gs_ring_t;
+
+/**
+ * @brief Exports a ring's depth, high-water mark and overflows as gauges.
+ * 
+ * @param name Label value, must outlive the ring.
+ * @param ring 
+ * @return int 1 on success, 0 if METRICS_MAX_RINGS are already watched.
+ */
+int gs_metrics_watch_ring(const char *name, gs_ring_t *ring);
+
+typedef struct gs_spool gs_spool_t;
+
+/**
+ * @brief Exports the spool's depth (frames, bytes, segments) as gauges.
+ * 
+ * @param spool Must stay open until gs_metrics_stop(), or be unwatched with nullptr.
+ */
+void gs_metrics_watch_spool(gs_spool_t *spool);
+
+/**
+ * @brief Writes every metric in Prometheus text exposition format.
+ * 
+ * @param out 
+ */
+void gs_metrics_render(FILE *out);
+
+/**
+ * @brief Starts serving gs_metrics_render() on a Unix domain socket.
+ * 
+ * Answers HTTP GETs (curl --unix-socket) and plain connections (socat) alike.
+ * 
+ * @param path Socket path; an existing socket file is replaced.
+ * @return int 1 on success, 0 on failure.
+ */
+int gs_metrics_start(const char *path);
+
+/**
+ * @brief Stops the endpoint and removes the socket file.
+ * 
+ */
+void gs_metrics_stop(void);
+
+#endif // GS_METRICS_HPP
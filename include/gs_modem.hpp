@@ -0,0 +1,227 @@
+/**
+ * @file gs_modem.hpp
+ * @author agent (agent@local)
+ * @brief Modem profiles switched live between frames, from UHF_CONFIG frames or the adaptive data rate.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * A profile is the data rate, deviation, preamble length and PA level the radio runs with. The server asks
+ * for one with a UHF_CONFIG frame (gs_modem_config_t), and the event loop brings every ready radio to it
+ * with gs_radio_try_configure(): never during a TX burst or while a frame is arriving, so the switch only
+ * ever falls between frames; a busy radio is tried again GS_MODEM_RETRY_MS later. A radio that has been
+ * re-initialized is back on its own profile, and is switched again within GS_MODEM_RECHECK_MS.
+ * 
+ * With the adaptive data rate on, the station judges the link every GS_ADAPT_WINDOW_MS from the frames the
+ * radios received (gs_link_t): it steps down the GS_ADAPT_RATES ladder when too many fail their CRC, when
+ * the RSSI no longer carries the rate, or when nothing is heard for GS_ADAPT_SILENT_WINDOWS; it steps up
+ * after GS_ADAPT_UP_WINDOWS clean windows with the RSSI to spare for the next rate. The spacecraft has to
+ * follow the same steps, which is the server's business: each step is only a new profile asked for.
+ * 
+ */
+
+#ifndef GS_MODEM_HPP
+#define GS_MODEM_HPP
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+#define GS_MODEM_RETRY_MS 10      // Wait before retrying a switch the radio was too busy for.
+#define GS_MODEM_RECHECK_MS 1000  // Longest between checks that the radios have the profile asked for.
+#define GS_MODEM_MIN_BPS 300      // Data rates a UHF_CONFIG may ask for.
+#define GS_MODEM_MAX_BPS 500000
+#define GS_MODEM_MAX_DEV_HZ 200000
+#define GS_MODEM_MAX_POWER 127    // The si446x's PA_PWR_LVL.
+
+#define GS_ADAPT_WINDOW_MS 2000     // Link quality is judged over this.
+#define GS_ADAPT_MIN_FRAMES 8       // Fewer frames in a window are carried into the next.
+#define GS_ADAPT_DOWN_ERR 0.10      // CRC-error rate that steps the data rate down.
+#define GS_ADAPT_UP_ERR 0.01        // Most a window may have to count toward a step up.
+#define GS_ADAPT_UP_WINDOWS 2       // Such windows in a row before stepping up.
+#define GS_ADAPT_SILENT_WINDOWS 3   // Windows without a frame before stepping down.
+#define GS_ADAPT_N0_DBM_HZ -168     // Receiver noise density: thermal, and a 6 dB noise figure.
+#define GS_ADAPT_EBN0_DB 14         // Eb/N0 a rate needs: about a frame in a thousand lost, 2GFSK without FEC.
+#define GS_ADAPT_MARGIN_DB 3        // Headroom over the next rate's need before stepping up.
+#define GS_ADAPT_RATES 1200, 2400, 4800, 9600, 19200, 38400
+
+typedef struct gs_radio gs_radio_t;
+
+/**
+ * @brief A modem profile. A field left 0 is unknown, or left as it is.
+ * 
+ */
+typedef struct
+{
+    uint32_t bitrate;      // Bits per second.
+    uint32_t deviation_hz; // FSK deviation.
+    uint16_t preamble;     // Bytes.
+    uint8_t power;         // PA level, 1 to GS_MODEM_MAX_POWER.
+} gs_modem_t;
+
+#define GS_ADAPT_KEEP 0 // gs_modem_config_t.adapt: as it is.
+#define GS_ADAPT_OFF 1
+#define GS_ADAPT_ON 2
+
+/**
+ * @brief A UHF_CONFIG frame's payload, little-endian.
+ * 
+ */
+typedef struct __attribute__((packed))
+{
+    uint32_t bitrate; // 0 leaves a field as it is.
+    uint32_t deviation_hz;
+    uint16_t preamble;
+    uint8_t power;
+    uint8_t adapt; // GS_ADAPT_KEEP, GS_ADAPT_OFF or GS_ADAPT_ON.
+} gs_modem_config_t;
+
+/**
+ * @brief What a radio has received, see gs_uhf_recv_frame(). Accessed with __atomic builtins.
+ * 
+ */
+typedef struct
+{
+    uint64_t good;    // Frames that passed their checks.
+    uint64_t bad;     // Frames that did not: CRC or GUID errors, or cut short.
+    int64_t rssi_sum; // dBm, over the good frames.
+} gs_link_t;
+
+/**
+ * @brief The adaptive data rate's state, see gs_adapt_window().
+ * 
+ */
+typedef struct
+{
+    gs_link_t since; // Counters at the start of the window.
+    int clean;       // Windows in a row good enough to step up.
+    int silent;      // Windows in a row without a frame.
+    bool fresh;      // The next window only starts counting: the rate or the radios just changed.
+    uint64_t ups;
+    uint64_t downs;
+} gs_adapt_t;
+
+typedef struct
+{
+    uint64_t configs;   //!< UHF_CONFIG frames taken.
+    uint64_t rejected;  //!< Malformed, or asking for what the radio cannot do.
+    uint64_t switches;  //!< Profiles applied, per radio.
+    uint64_t deferred;  //!< Switches put off because the radio was transmitting or a frame was arriving.
+    uint64_t settled;   //!< Profiles asked for that every ready radio then took, timed below.
+    uint64_t switch_sum_ns;
+    uint64_t switch_max_ns;
+} gs_modem_stats_t;
+
+/**
+ * @brief The profile asked for, and the adaptive data rate. Only the event loop's thread uses it.
+ * 
+ */
+typedef struct gs_modem_ctl
+{
+    gs_modem_t want;   // Fields left 0 stay as each radio has them.
+    uint64_t asked_ns; // When want last changed, until the ready radios all have it; 0 once they do.
+    bool kick;         // want changed since the event loop last looked.
+    bool adapt;
+    gs_adapt_t rate;
+    gs_modem_stats_t stats;
+} gs_modem_ctl_t;
+
+/**
+ * @brief Whether anything is asked of the radios: a profile, or the adaptive data rate.
+ * 
+ * @param ctl 
+ * @return bool 
+ */
+static inline bool gs_modem_active(const gs_modem_ctl_t *ctl)
+{
+    return ctl->adapt || ctl->want.bitrate || ctl->want.deviation_hz || ctl->want.preamble || ctl->want.power;
+}
+
+/**
+ * @brief Creates a modem control asking for nothing.
+ * 
+ * @param adapt Start with the adaptive data rate on.
+ * @return gs_modem_ctl_t* nullptr on failure.
+ */
+gs_modem_ctl_t *gs_modem_create(bool adapt);
+
+/**
+ * @brief Destroys a modem control.
+ * 
+ * @param ctl May be nullptr.
+ */
+void gs_modem_destroy(gs_modem_ctl_t *ctl);
+
+/**
+ * @brief Parses and checks a UHF_CONFIG frame's payload.
+ * 
+ * @param buf 
+ * @param len 
+ * @param modem The fields asked for, 0 for the rest.
+ * @param adapt GS_ADAPT_KEEP, GS_ADAPT_OFF or GS_ADAPT_ON.
+ * @return int 1 on success, 0 if the payload is not a gs_modem_config_t or asks for something out of range.
+ */
+int gs_modem_parse(const void *buf, ssize_t len, gs_modem_t *modem, int *adapt);
+
+/**
+ * @brief Asks for a profile: its nonzero fields replace those asked for before.
+ * 
+ * @param ctl 
+ * @param modem 
+ * @param adapt GS_ADAPT_KEEP, GS_ADAPT_OFF or GS_ADAPT_ON.
+ * @param now_ns When it was asked for, to time the switch.
+ */
+void gs_modem_request(gs_modem_ctl_t *ctl, const gs_modem_t *modem, int adapt, uint64_t now_ns);
+
+/**
+ * @brief Drops the profile asked for and turns the adaptive data rate off, after a radio could not take it.
+ * 
+ * @param ctl 
+ */
+void gs_modem_forget(gs_modem_ctl_t *ctl);
+
+/**
+ * @brief Switches a radio to the profile asked for, if it does not have it.
+ * 
+ * @param ctl 
+ * @param radio 
+ * @return int 1 if switched, 0 if it had it, -1 if put off, -2 if the radio cannot take it.
+ */
+int gs_modem_apply(gs_modem_ctl_t *ctl, gs_radio_t *radio);
+
+/**
+ * @brief Counts a profile the ready radios have all taken, and how long it took since it was asked for.
+ * 
+ * @param ctl 
+ * @param now_ns 
+ * @return uint64_t The switch's latency.
+ */
+uint64_t gs_modem_settle(gs_modem_ctl_t *ctl, uint64_t now_ns);
+
+/**
+ * @brief The RSSI a data rate needs.
+ * 
+ * @param bitrate 
+ * @return double dBm.
+ */
+double gs_adapt_need_dbm(uint32_t bitrate);
+
+/**
+ * @brief Judges a window of the link, and picks the data rate to step to.
+ * 
+ * @param adapt 
+ * @param bitrate The rate in effect.
+ * @param link The receiving radios' counters, summed.
+ * @return uint32_t The rate to switch to, 0 to stay.
+ */
+uint32_t gs_adapt_window(gs_adapt_t *adapt, uint32_t bitrate, const gs_link_t *link);
+
+/**
+ * @brief Prints the modem counters.
+ * 
+ * @param ctl 
+ */
+void gs_modem_print(const gs_modem_ctl_t *ctl);
+
+#endif // GS_MODEM_HPP
@@ -0,0 +1,217 @@
+/**
+ * @file gs_pass.hpp
+ * @author agent (agent@local)
+ * @brief Pass prediction from TLEs, cached between element set updates, and the gate that idles the radio threads between passes.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * A plan holds the spacecraft's passes over the station (AOS to LOS above a minimum elevation) for the next
+ * horizon, predicted with SGP4 (see gs_sgp4.hpp). Predictions are kept and only extended as time moves on:
+ * each update predicts the stretch between the end of the last prediction and the new end of the horizon.
+ * Reloading the TLE file costs nothing unless it changed; a new element set for the spacecraft re-predicts
+ * from the current time on, and keeps the passes that are over.
+ * 
+ * Passes are found by stepping elevation every GS_PASS_STEP_S and bisecting each horizon crossing down to
+ * GS_PASS_TOL_S, so a pass that stays above the minimum elevation for less than a step may be missed; at 0
+ * degrees that is a pass of under 30 s, which is useless anyway.
+ * 
+ * The event loop runs the plan (see gs_uhf_event_loop()); the gate is how it tells the radio threads to
+ * put their radios to sleep and wait for the next pass.
+ * 
+ */
+
+#ifndef GS_PASS_HPP
+#define GS_PASS_HPP
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <pthread.h>
+#include <time.h>
+#include "gs_sgp4.hpp"
+
+#define GS_PASS_MAX 64    // Passes one plan holds, far more than a LEO spacecraft makes in a day.
+#define GS_PASS_STEP_S 30 // Coarse elevation step.
+#define GS_PASS_TOL_S 0.1 // AOS and LOS are refined to this.
+
+/**
+ * @brief One pass over the station. Times are Unix seconds.
+ * 
+ */
+typedef struct
+{
+    double aos;
+    double los;
+    double tca;    // Highest elevation.
+    double max_el; // Radians.
+    double aos_az; // Radians from north.
+    double los_az;
+} gs_pass_t;
+
+typedef struct
+{
+    uint64_t loads;        //!< Element sets taken in.
+    uint64_t unchanged;    //!< Reloads that found the same element set, and predicted nothing.
+    uint64_t predictions;  //!< Stretches predicted.
+    double predicted_s;    //!< Orbit time they covered, in seconds.
+    uint64_t propagations; //!< SGP4 calls.
+} gs_pass_stats_t;
+
+/**
+ * @brief Whether the radio threads may use their radios.
+ * 
+ */
+typedef struct
+{
+    bool open;    // Accessed with __atomic builtins.
+    bool stopped; // Shutdown, nobody waits any more.
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} gs_pass_gate_t;
+
+/**
+ * @brief The spacecraft's predicted passes over the station, see gs_pass_plan_update().
+ * 
+ */
+typedef struct gs_pass_plan
+{
+    gs_station_t station;
+    double min_el; // Radians.
+    double horizon_s;
+    char path[PATH_MAX]; // TLE file, see gs_pass_plan_reload().
+    int catnum;          // Element set to take from it, 0 for the first.
+    struct timespec mtime;
+    bool have_sat;
+    gs_sgp4_t sat;
+    gs_pass_t passes[GS_PASS_MAX]; // In time order.
+    int count;
+    double until; // Predicted up to here, 0 for nothing yet.
+    gs_pass_stats_t stats;
+    gs_pass_gate_t gate;
+} gs_pass_plan_t;
+
+/**
+ * @brief Finds the passes between two times.
+ * 
+ * A pass already in progress at from is included, with its real AOS.
+ * 
+ * @param sat 
+ * @param station 
+ * @param min_el Radians.
+ * @param from Unix seconds.
+ * @param to Unix seconds, passes that begin later are not looked for.
+ * @param passes 
+ * @param max 
+ * @param propagations Incremented by the SGP4 calls made, may be nullptr.
+ * @return int Passes found, at most max.
+ */
+int gs_pass_find(const gs_sgp4_t *sat, const gs_station_t *station, double min_el, double from, double to, gs_pass_t *passes, int max,
+                 uint64_t *propagations);
+
+/**
+ * @brief Creates an empty plan, with its gate open.
+ * 
+ * @param station Geodetic position; the rest is filled in.
+ * @param min_el Radians.
+ * @param horizon_s How far ahead to predict.
+ * @return gs_pass_plan_t* nullptr on failure.
+ */
+gs_pass_plan_t *gs_pass_plan_create(const gs_station_t *station, double min_el, double horizon_s);
+
+/**
+ * @brief Destroys a plan. Nobody may be waiting on its gate.
+ * 
+ * @param plan May be nullptr.
+ */
+void gs_pass_plan_destroy(gs_pass_plan_t *plan);
+
+/**
+ * @brief Takes in an element set: re-predicts from now on if it is not the one the plan already has.
+ * 
+ * @param plan 
+ * @param tle 
+ * @param now Unix seconds.
+ * @return int 1 if the passes changed, 0 if not (the same set, or one SGP4 cannot use).
+ */
+int gs_pass_plan_set(gs_pass_plan_t *plan, const gs_tle_t *tle, double now);
+
+/**
+ * @brief Reads the plan's TLE file if it changed since it was last read, and takes in the spacecraft's element set.
+ * 
+ * The file holds two- or three-line element sets; the one for the plan's catalog number is used, or the first.
+ * 
+ * @param plan 
+ * @param path nullptr for the file already given.
+ * @param catnum With path, the spacecraft's catalog number, 0 for the first element set in the file.
+ * @param now Unix seconds.
+ * @return int 1 if the passes changed, 0 if not, -1 if the file cannot be read or holds no usable element set.
+ */
+int gs_pass_plan_reload(gs_pass_plan_t *plan, const char *path, int catnum, double now);
+
+/**
+ * @brief Forgets the passes that are over, and predicts as far as the horizon from now.
+ * 
+ * @param plan 
+ * @param now Unix seconds.
+ */
+void gs_pass_plan_update(gs_pass_plan_t *plan, double now);
+
+/**
+ * @brief The first pass that has not ended by t.
+ * 
+ * @param plan 
+ * @param t Unix seconds.
+ * @return const gs_pass_t* nullptr if none is predicted.
+ */
+const gs_pass_t *gs_pass_plan_next(const gs_pass_plan_t *plan, double t);
+
+/**
+ * @brief Prints the predicted passes.
+ * 
+ * @param plan 
+ */
+void gs_pass_plan_print(const gs_pass_plan_t *plan);
+
+/**
+ * @brief The current time for the plan, Unix seconds.
+ * 
+ * @return double 
+ */
+double gs_pass_now(void);
+
+/**
+ * @brief Whether the radio threads may use their radios. One load.
+ * 
+ * @param plan 
+ * @return bool 
+ */
+static inline bool gs_pass_gate_open(gs_pass_plan_t *plan)
+{
+    return __atomic_load_n(&plan->gate.open, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Opens or closes the gate, waking the threads waiting on it.
+ * 
+ * @param plan 
+ * @param open 
+ */
+void gs_pass_gate_set(gs_pass_plan_t *plan, bool open);
+
+/**
+ * @brief Blocks while the gate is closed.
+ * 
+ * @param plan 
+ */
+void gs_pass_gate_wait(gs_pass_plan_t *plan);
+
+/**
+ * @brief Releases every thread waiting on the gate for good, for shutdown.
+ * 
+ * @param plan 
+ */
+void gs_pass_gate_stop(gs_pass_plan_t *plan);
+
+#endif // GS_PASS_HPP
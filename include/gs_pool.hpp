@@ -0,0 +1,136 @@
+/**
+ * @file gs_pool.hpp
+ * @author agent (agent@local)
+ * @brief Fixed-capacity block pools for NetFrames and payload buffers.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * Every block is allocated when the pool is created, so borrowing and returning a block in the RX, TX and
+ * NACK paths never touches the heap. If a pool runs dry the block comes from the heap instead and is
+ * counted as a miss, which means the pool is undersized.
+ * 
+ */
+
+#ifndef GS_POOL_HPP
+#define GS_POOL_HPP
+
+#include <stdint.h>
+#include <pthread.h>
+#include "network.hpp"
+
+#define POOL_BLOCK_ALIGN 64
+
+/**
+ * @brief Pool statistics, see gs_pool_get_stats().
+ * 
+ */
+typedef struct
+{
+    uint32_t capacity;
+    uint32_t in_use;     //!< Blocks currently borrowed from the pool.
+    uint32_t high_water; //!< Most blocks ever borrowed at once.
+    uint64_t gets;       //!< Blocks handed out, pooled or not.
+    uint64_t misses;     //!< Blocks that had to come from the heap because the pool was empty.
+} gs_pool_stats_t;
+
+typedef struct
+{
+    const char *name;
+    pthread_mutex_t lock;
+    size_t block_size; // Rounded up to POOL_BLOCK_ALIGN.
+    uint32_t capacity;
+    uint8_t *blocks;   // capacity * block_size bytes.
+    void **free_list;  // Stack of free blocks.
+    uint32_t free_count;
+    uint32_t high_water;
+    uint64_t gets;
+    uint64_t misses;
+} gs_pool_t;
+
+/**
+ * @brief Creates a pool and allocates all of its blocks.
+ * 
+ * @param name Printed with the statistics, must outlive the pool.
+ * @param block_size 
+ * @param capacity 
+ * @return gs_pool_t* nullptr on failure.
+ */
+gs_pool_t *gs_pool_create(const char *name, size_t block_size, uint32_t capacity);
+
+/**
+ * @brief Destroys a pool. Every block must have been returned.
+ * 
+ * @param pool 
+ */
+void gs_pool_destroy(gs_pool_t *pool);
+
+/**
+ * @brief Borrows a block.
+ * 
+ * @param pool 
+ * @return void* nullptr only if the pool is empty and the heap is exhausted.
+ */
+void *gs_pool_get(gs_pool_t *pool);
+
+/**
+ * @brief Returns a block borrowed with gs_pool_get().
+ * 
+ * @param pool 
+ * @param block nullptr is ignored.
+ */
+void gs_pool_put(gs_pool_t *pool, void *block);
+
+/**
+ * @brief Size of the pool's blocks.
+ * 
+ * @param pool 
+ * @return size_t 
+ */
+size_t gs_pool_block_size(gs_pool_t *pool);
+
+/**
+ * @brief Snapshot of the pool's statistics.
+ * 
+ * @param pool 
+ * @param stats 
+ */
+void gs_pool_get_stats(gs_pool_t *pool, gs_pool_stats_t *stats);
+
+/**
+ * @brief Prints the pool's statistics.
+ * 
+ * @param pool 
+ */
+void gs_pool_print_stats(gs_pool_t *pool);
+
+/**
+ * @brief Constructs an empty NetFrame, for recvFrame(), in a block from a pool of sizeof(NetFrame) blocks.
+ * 
+ * @param pool 
+ * @return NetFrame* nullptr on failure.
+ */
+NetFrame *gs_pool_netframe(gs_pool_t *pool);
+
+/**
+ * @brief Constructs an outgoing NetFrame in a block from a pool of sizeof(NetFrame) blocks.
+ * 
+ * @param pool 
+ * @param payload 
+ * @param size 
+ * @param type 
+ * @param destination 
+ * @return NetFrame* nullptr on failure.
+ */
+NetFrame *gs_pool_netframe(gs_pool_t *pool, unsigned char *payload, ssize_t size, NetType type, NetVertex destination);
+
+/**
+ * @brief Destroys a NetFrame from gs_pool_netframe() and returns its block.
+ * 
+ * @param pool 
+ * @param frame nullptr is ignored.
+ */
+void gs_pool_netframe_put(gs_pool_t *pool, NetFrame *frame);
+
+#endif // GS_POOL_HPP
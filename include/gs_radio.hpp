@@ -0,0 +1,461 @@
+/**
+ * @file gs_radio.hpp
+ * @author agent (agent@local)
+ * @brief Radio abstraction layer, lets the UHF code drive either the si446x or a simulated radio.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#ifndef GS_RADIO_HPP
+#define GS_RADIO_HPP
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/types.h>
+#include "gs_fec.hpp"
+#include "gs_health.hpp"
+#include "gs_arbiter.hpp"
+#include "gs_modem.hpp"
+
+#define RADIO_PART_MASK 0x4460
+#define RADIO_PART_VALID(part) (((part) & RADIO_PART_MASK) == RADIO_PART_MASK)
+
+/// Simulated radio defaults ///
+#define SIM_DEFAULT_RSSI -90      // dBm reported for every simulated frame.
+#define SIM_DEFAULT_BITRATE 9600  // bits per second on the simulated air.
+#define SIM_MAX_AIR_FRAME 128     // Largest frame the simulated air will carry.
+#define SIM_RX_FIFO_DEPTH 2       // The si446x holds one packet in its FIFO while the next is on the air.
+#define SIM_DEFAULT_PREAMBLE 8    // Preamble bytes the air time of a frame already stands for.
+#define SIM_DEFAULT_POWER 127     // PA level a simulated radio comes up with.
+#define SIM_N0_DBM_HZ -168        // Noise density of the "awgn" channel: thermal, and a 6 dB noise figure.
+///////////////////////////////
+
+/// si446x nIRQ line (GPIO character device) ///
+#define UHF_IRQ_GPIOCHIP "/dev/gpiochip0"
+#define UHF_IRQ_LINE 25 // BCM25 on the roof UHF Pi, active low.
+#define UHF_IRQ_FALLBACK_US 2000 // Poll interval when the nIRQ line is unavailable.
+////////////////////////////////////////////////
+
+#define UHF_INIT_PROBE_PATH "tools/gs_si446x_probe.out" // Runs si446x_init() for the probe, relative to the daemon's own directory.
+#define UHF_INIT_PROBE_TIMEOUT_MS 5000 // Longest si446x_init() may take in its probe process before it is given up on.
+
+/**
+ * @brief Subset of si446x_info_t the ground station cares about.
+ * 
+ */
+typedef struct gs_radio_info
+{
+    uint8_t chip_rev;
+    uint16_t part;
+    uint16_t id;
+    uint8_t rom_id;
+} gs_radio_info_t;
+
+typedef struct gs_radio gs_radio_t;
+
+/**
+ * @brief Backend operations. Mirrors the libsi446x calls the ground station uses.
+ * 
+ */
+typedef struct
+{
+    const char *name;
+    int (*init)(gs_radio_t *radio);                                         //!< 1 on success, 0 on failure.
+    int (*get_info)(gs_radio_t *radio, gs_radio_info_t *info);              //!< 1 on success, 0 on failure.
+    void (*en_pipe)(gs_radio_t *radio);                                     //!< Enables pipe (continuous RX) mode.
+    ssize_t (*read)(gs_radio_t *radio, void *buf, ssize_t len, int16_t *rssi); //!< Bytes read, 0 if nothing pending.
+    ssize_t (*write)(gs_radio_t *radio, void *buf, ssize_t len);            //!< Bytes written, 0 or negative on failure.
+    int (*sleep)(gs_radio_t *radio);                                        //!< Puts the radio to sleep.
+    void (*destroy)(gs_radio_t *radio);
+    int (*irq_fd)(gs_radio_t *radio);                                       //!< Pollable "frame ready" descriptor, -1 if none.
+    int (*irq_ack)(gs_radio_t *radio, uint64_t *irq_ns);                    //!< Clears the IRQ, 1 if a frame is ready.
+    int (*resume)(gs_radio_t *radio);                                       //!< Re-applies the configuration captured by the last good init, without a reset; nullptr if the backend cannot. 1 on success, 0 on failure.
+    int (*tune)(gs_radio_t *radio, int32_t rx_hz, int32_t tx_hz);           //!< Offsets the receive and transmit frequencies from the configured ones; nullptr if the backend cannot. 1 on success, 0 on failure, -1 (nothing done) while a frame is arriving.
+    int (*configure)(gs_radio_t *radio, const gs_modem_t *modem);           //!< Switches to a modem profile, every field set; nullptr if the backend cannot. 1 on success, 0 if it cannot take that profile, -1 (nothing done) while a frame is arriving.
+} gs_radio_ops_t;
+
+/**
+ * @brief Receive-side interrupt counters, kept per radio.
+ * 
+ * Latency is measured from frame arrival (IRQ timestamp) to gs_uhf_read() handing the payload over.
+ * 
+ */
+typedef struct
+{
+    uint64_t wakeups;       //!< Times the receive wait returned because of an IRQ.
+    uint64_t spurious;      //!< IRQs that did not produce a frame.
+    uint64_t timeouts;      //!< Receive waits that ran out the clock.
+    uint64_t frames;        //!< Frames with a measured arrival-to-handler latency.
+    uint64_t latency_sum_ns;
+    uint64_t latency_min_ns;
+    uint64_t latency_max_ns;
+} gs_radio_irq_stats_t;
+
+struct gs_radio
+{
+    const gs_radio_ops_t *ops;
+    void *priv;             // Backend-private state.
+    int irq_epfd;           // epoll instance waiting on ops->irq_fd().
+    int irq_epfd_watching;  // The descriptor irq_epfd is registered for.
+    gs_radio_irq_stats_t irq_stats;
+    gs_fec_mode_t fec;      // How gs_uhf_write() frames the uplink; either framing is always accepted on receive.
+    bool fec_peer;          // The far end's last frame carried parity (GS_FEC_AUTO follows it). Written by RX, read by TX: __atomic builtins.
+    gs_health_t health;     // Published by the health monitor, see gs_health.hpp.
+    gs_arbiter_t arbiter;   // Every transaction with the device goes through it, see gs_arbiter.hpp.
+    int32_t rx_offset_hz;   // Doppler correction in effect, see gs_radio_try_tune(); an init puts the radio back on 0.
+    int32_t tx_offset_hz;
+    gs_modem_t modem;       // Profile in effect, see gs_radio_try_configure(); an init puts the radio back on the backend's own, fields it does not know left 0.
+    gs_link_t link;         // Frames received, for the adaptive data rate.
+};
+
+/**
+ * @brief Simulated channel ("air") parameters.
+ * 
+ * Impairments are applied in both directions. The simulated spacecraft sits on the far end of the
+ * air and can beacon downlink frames at a fixed rate and/or echo every uplinked frame.
+ * 
+ */
+typedef struct
+{
+    double ber;          //!< Bit-error rate, 0 for a clean channel.
+    double loss;         //!< Probability [0, 1] that a frame is lost outright.
+    uint32_t latency_us; //!< Fixed per-frame latency added on top of the air time.
+    uint32_t bitrate;    //!< Air data rate in bits per second, 0 for unlimited.
+    double beacon_hz;    //!< Downlink frames per second sent by the simulated spacecraft, 0 to disable.
+    bool echo;           //!< Simulated spacecraft echoes every uplinked frame, or reassembled multi-frame message, back down.
+    bool spacecraft;     //!< Run the built-in simulated spacecraft; false exposes the far end for an external driver.
+    bool fec;            //!< Simulated spacecraft sends frames with Reed-Solomon parity (it accepts both framings).
+    int16_t rssi;        //!< RSSI (dBm) reported for received frames.
+    uint32_t seed;       //!< RNG seed for the impairments.
+    uint32_t spi_us;     //!< Time a part info query takes, as the SPI round trip would; 0 for none.
+    uint32_t boot_ms;    //!< Time a cold init takes (reset, patch and configuration upload); a resume skips it.
+    uint32_t fail_inits; //!< Inits that fail before the first that succeeds, as transient SPI errors would.
+    bool awgn;           //!< Bit errors follow from the RSSI and the data rate over SIM_N0_DBM_HZ, instead of ber.
+    double duty;         //!< Most of the air time (0, 1] beacons take at the data rate in effect, slowing them; 0 for no limit.
+} gs_sim_config_t;
+
+/**
+ * @brief Counters kept by the simulated radio.
+ * 
+ */
+typedef struct
+{
+    uint64_t uplink_sent;      //!< Frames written by the ground station.
+    uint64_t uplink_lost;      //!< Uplink frames dropped by the channel.
+    uint64_t downlink_sent;    //!< Frames sent by the far end.
+    uint64_t downlink_lost;    //!< Downlink frames dropped by the channel.
+    uint64_t downlink_read;    //!< Frames handed to the ground station by read().
+    uint64_t bits_flipped;     //!< Total bit errors injected, both directions.
+    uint64_t sar_uplinks;      //!< Multi-frame messages the simulated spacecraft reassembled.
+    uint64_t sar_downlinks;    //!< Multi-frame messages it sent and had acknowledged (echo).
+    uint64_t info_calls;       //!< Part info queries (get_info) made by the ground station.
+    uint64_t inits;            //!< Cold inits attempted, failed ones included.
+    uint64_t resumes;          //!< Warm re-inits (resume).
+    uint64_t spi_overlaps;     //!< Transactions that started while another was in progress, which SPI would garble.
+    uint64_t retunes;          //!< Frequency changes (tune).
+    uint64_t retunes_busy;     //!< Retunes refused because a frame was arriving.
+    uint64_t retunes_mid_frame; //!< Retunes that landed while a frame was on the air anyway, which would lose it.
+    uint64_t reconfigs;        //!< Modem profile switches (configure).
+    uint64_t reconfigs_busy;   //!< Switches refused because a frame was arriving.
+    uint64_t reconfigs_mid_frame; //!< Switches that landed while a frame was on the air anyway.
+    uint64_t lz_uplinks;       //!< Compressed payloads the simulated spacecraft decoded, in one frame or several.
+    uint64_t lz_rejected;      //!< Compressed payloads it could not decode.
+} gs_sim_stats_t;
+
+/**
+ * @brief Allocates a radio for a backend. Only for use by backends.
+ * 
+ * @param ops 
+ * @param priv 
+ * @return gs_radio_t* nullptr on failure.
+ */
+gs_radio_t *gs_radio_alloc(const gs_radio_ops_t *ops, void *priv);
+
+/**
+ * @brief Creates the libsi446x-backed radio.
+ * 
+ * libsi446x keeps a single global device, so only one of these can exist at a time.
+ * 
+ * @return gs_radio_t* nullptr on failure, or if one already exists.
+ */
+gs_radio_t *gs_radio_si446x_create(void);
+
+/**
+ * @brief Fills a simulator configuration with defaults (clean channel, 9600 bps, built-in spacecraft).
+ * 
+ * @param config 
+ */
+void gs_radio_sim_defaults(gs_sim_config_t *config);
+
+/**
+ * @brief Parses a comma-separated option string into a simulator configuration.
+ * 
+ * Accepted keys: ber, loss, latency (us), rate (bps), beacon (Hz), echo, external, rssi, seed, fec, spi (us),
+ * boot (ms), fail (inits), awgn, duty.
+ * e.g. "ber=1e-5,loss=0.01,latency=5000,rate=9600,beacon=10,echo"
+ * 
+ * @param config Must already hold defaults.
+ * @param options 
+ * @return int 1 on success, 0 on an unknown or malformed option.
+ */
+int gs_radio_sim_parse(gs_sim_config_t *config, const char *options);
+
+/**
+ * @brief Creates a simulated radio connected to an in-process "air".
+ * 
+ * @param config 
+ * @return gs_radio_t* nullptr on failure.
+ */
+gs_radio_t *gs_radio_sim_create(const gs_sim_config_t *config);
+
+/**
+ * @brief Returns the far ("spacecraft") end of the simulated air, for external drivers.
+ * 
+ * Frames are exchanged with gs_radio_sim_far_send() and gs_radio_sim_far_recv(). Only valid
+ * when the built-in spacecraft is disabled.
+ * 
+ * @param radio 
+ * @return int The file descriptor, or -1.
+ */
+int gs_radio_sim_far_fd(gs_radio_t *radio);
+
+/**
+ * @brief Sends a frame from the far end toward the ground station, applying channel impairments.
+ * 
+ * @param radio 
+ * @param buf 
+ * @param len 
+ * @return ssize_t len on success (including frames the channel dropped), negative on error.
+ */
+ssize_t gs_radio_sim_far_send(gs_radio_t *radio, const void *buf, ssize_t len);
+
+/**
+ * @brief Receives an uplinked frame at the far end, honoring the simulated latency.
+ * 
+ * @param radio 
+ * @param buf 
+ * @param len 
+ * @param timeout_ms -1 to block.
+ * @return ssize_t Bytes received, 0 on timeout, negative on error.
+ */
+ssize_t gs_radio_sim_far_recv(gs_radio_t *radio, void *buf, ssize_t len, int timeout_ms);
+
+/**
+ * @brief Copies out the simulator's counters.
+ * 
+ * @param radio 
+ * @param stats 
+ * @return int 1 on success, 0 if the radio is not simulated.
+ */
+int gs_radio_sim_stats(gs_radio_t *radio, gs_sim_stats_t *stats);
+
+/**
+ * @brief Makes the simulated radio lose its configuration, as a real one does when it resets or browns out.
+ * 
+ * Until it is initialized again it answers part info queries with part 0 and neither receives nor transmits.
+ * 
+ * @param radio 
+ * @return int 1 on success, 0 if the radio is not simulated.
+ */
+int gs_radio_sim_crash(gs_radio_t *radio);
+
+/**
+ * @brief Changes the RSSI of the frames from here on, as the spacecraft's range and elevation would; with
+ * awgn, the bit errors follow.
+ * 
+ * @param radio 
+ * @param rssi dBm.
+ * @return int 1 on success, 0 if the radio is not simulated.
+ */
+int gs_radio_sim_set_rssi(gs_radio_t *radio, int16_t rssi);
+
+/**
+ * @brief Returns true if the radio is the simulated backend.
+ * 
+ * @param radio 
+ * @return bool 
+ */
+bool gs_radio_is_sim(gs_radio_t *radio);
+
+// Thin wrappers so callers never touch ops directly. Each is one transaction with the device, taken through
+// the radio's arbiter; writes go in the caller's TX burst, or in one of their own.
+
+// Both put the radio back on its configured frequencies and modem profile.
+
+static inline int gs_radio_init(gs_radio_t *radio)
+{
+    gs_arbiter_rx_begin(radio);
+    memset(&radio->modem, 0x0, sizeof(gs_modem_t));
+    int retval = radio->ops->init(radio);
+    radio->rx_offset_hz = 0;
+    radio->tx_offset_hz = 0;
+    gs_arbiter_rx_end(radio);
+    return retval;
+}
+
+static inline int gs_radio_resume(gs_radio_t *radio)
+{
+    if (radio->ops->resume == nullptr)
+    {
+        return 0;
+    }
+    gs_arbiter_rx_begin(radio);
+    memset(&radio->modem, 0x0, sizeof(gs_modem_t));
+    int retval = radio->ops->resume(radio);
+    radio->rx_offset_hz = 0;
+    radio->tx_offset_hz = 0;
+    gs_arbiter_rx_end(radio);
+    return retval;
+}
+
+static inline int gs_radio_get_info(gs_radio_t *radio, gs_radio_info_t *info)
+{
+    gs_arbiter_rx_begin(radio);
+    int retval = radio->ops->get_info(radio, info);
+    gs_arbiter_rx_end(radio);
+    return retval;
+}
+
+/**
+ * @brief gs_radio_get_info(), unless the radio is transmitting.
+ * 
+ * @return int -1 if it is, so nothing was asked.
+ */
+static inline int gs_radio_try_get_info(gs_radio_t *radio, gs_radio_info_t *info)
+{
+    if (!gs_arbiter_rx_try(radio))
+    {
+        return -1;
+    }
+    int retval = radio->ops->get_info(radio, info);
+    gs_arbiter_rx_end(radio);
+    return retval;
+}
+
+/**
+ * @brief Retunes the radio, unless it is transmitting or a frame is arriving: a retune then would lose the frame.
+ * 
+ * @param radio 
+ * @param rx_hz Offset of the receive frequency from the configured one.
+ * @param tx_hz Offset of the transmit frequency.
+ * @return int 1 on success, 0 on failure or if the backend cannot retune, -1 if it was busy (nothing was done).
+ */
+static inline int gs_radio_try_tune(gs_radio_t *radio, int32_t rx_hz, int32_t tx_hz)
+{
+    if (radio->ops->tune == nullptr)
+    {
+        return 0;
+    }
+    if (!gs_arbiter_rx_try(radio))
+    {
+        return -1;
+    }
+    int retval = radio->ops->tune(radio, rx_hz, tx_hz);
+    if (retval == 1)
+    {
+        radio->rx_offset_hz = rx_hz;
+        radio->tx_offset_hz = tx_hz;
+    }
+    gs_arbiter_rx_end(radio);
+    return retval;
+}
+
+/**
+ * @brief Switches the radio's modem profile, unless it is transmitting or a frame is arriving.
+ * 
+ * @param radio 
+ * @param modem Every field set.
+ * @return int 1 on success, 0 if the backend cannot take the profile, -1 if it was busy (nothing was done).
+ */
+static inline int gs_radio_try_configure(gs_radio_t *radio, const gs_modem_t *modem)
+{
+    if (radio->ops->configure == nullptr)
+    {
+        return 0;
+    }
+    if (!gs_arbiter_rx_try(radio))
+    {
+        return -1;
+    }
+    int retval = radio->ops->configure(radio, modem);
+    if (retval == 1)
+    {
+        radio->modem = *modem;
+    }
+    gs_arbiter_rx_end(radio);
+    return retval;
+}
+
+static inline void gs_radio_en_pipe(gs_radio_t *radio)
+{
+    gs_arbiter_rx_begin(radio);
+    radio->ops->en_pipe(radio);
+    gs_arbiter_rx_end(radio);
+}
+
+static inline ssize_t gs_radio_read(gs_radio_t *radio, void *buf, ssize_t len, int16_t *rssi)
+{
+    gs_arbiter_rx_begin(radio);
+    ssize_t retval = radio->ops->read(radio, buf, len, rssi);
+    gs_arbiter_rx_end(radio);
+    return retval;
+}
+
+static inline ssize_t gs_radio_write(gs_radio_t *radio, void *buf, ssize_t len)
+{
+    return gs_arbiter_write(radio, buf, len);
+}
+
+static inline int gs_radio_sleep(gs_radio_t *radio)
+{
+    gs_arbiter_rx_begin(radio);
+    int retval = radio->ops->sleep(radio);
+    gs_arbiter_rx_end(radio);
+    return retval;
+}
+
+/**
+ * @brief Blocks until the radio raises its IRQ or the timeout expires.
+ * 
+ * Waits on the backend's IRQ descriptor with epoll. Backends without one (e.g. the nIRQ line could not be
+ * claimed) fall back to sleeping UHF_IRQ_FALLBACK_US, which costs a wakeup but never spins.
+ * 
+ * @param radio 
+ * @param timeout_ms 
+ * @param irq_ns Set to the IRQ's CLOCK_MONOTONIC timestamp when one fired, otherwise 0.
+ * @return int 1 if a frame should be ready, 0 on timeout or spurious IRQ, negative on error.
+ */
+int gs_radio_irq_wait(gs_radio_t *radio, int timeout_ms, uint64_t *irq_ns);
+
+/**
+ * @brief The backend's IRQ descriptor, for callers that wait on it in their own event loop.
+ * 
+ * @param radio 
+ * @return int -1 if the backend has none (poll every UHF_IRQ_FALLBACK_US instead).
+ */
+static inline int gs_radio_irq_fd(gs_radio_t *radio)
+{
+    return radio->ops->irq_fd(radio);
+}
+
+/**
+ * @brief Clears the IRQ after gs_radio_irq_fd() became readable, and counts the wakeup.
+ * 
+ * @param radio 
+ * @param irq_ns Set to the IRQ's CLOCK_MONOTONIC timestamp, 0 if unknown.
+ * @return int 1 if a frame should be ready, 0 if the IRQ was spurious.
+ */
+int gs_radio_irq_ack(gs_radio_t *radio, uint64_t *irq_ns);
+
+/**
+ * @brief Destroys a radio created by any of the gs_radio_*_create() functions.
+ * 
+ * @param radio 
+ */
+void gs_radio_destroy(gs_radio_t *radio);
+
+#endif // GS_RADIO_HPP
@@ -0,0 +1,168 @@
+/**
+ * @file gs_reactor.hpp
+ * @author agent (agent@local)
+ * @brief Single-threaded epoll event loop: descriptors, timers and signals dispatched to callbacks.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * Everything registered with a reactor runs on the thread in gs_reactor_run(), one callback at a time, so
+ * state only those callbacks touch needs no locking. Callbacks must not block: a callback that sleeps holds
+ * up every other descriptor.
+ * 
+ */
+
+#ifndef GS_REACTOR_HPP
+#define GS_REACTOR_HPP
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <signal.h>
+#include <sys/epoll.h>
+
+#define GS_REACTOR_MAX_HANDLERS 16
+#define GS_REACTOR_MAX_EVENTS 16 // Events taken per epoll_wait().
+
+typedef struct gs_reactor gs_reactor_t;
+
+/**
+ * @brief Called with the epoll events (EPOLLIN, EPOLLERR, ...) that fired on fd, or the signal number for signals.
+ * 
+ */
+typedef void (*gs_reactor_cb_t)(gs_reactor_t *reactor, int fd, uint32_t events, void *arg);
+
+typedef enum
+{
+    GS_REACTOR_FD = 0,
+    GS_REACTOR_TIMER,  // Owned timerfd, read before the callback runs.
+    GS_REACTOR_SIGNAL, // Owned signalfd, the callback gets the signal number as its events.
+} gs_reactor_kind_t;
+
+typedef struct
+{
+    int fd; // -1 when the slot is free.
+    gs_reactor_kind_t kind;
+    gs_reactor_cb_t cb;
+    void *arg;
+    uint64_t removed; // Batch the handler was removed in; the slot is not reused until that batch is done.
+} gs_reactor_handler_t;
+
+typedef struct
+{
+    uint64_t wakeups;    //!< epoll_wait() returns with at least one event.
+    uint64_t events;     //!< Callbacks run.
+    uint64_t busy_ns;    //!< Time spent in callbacks and the idle hook.
+} gs_reactor_stats_t;
+
+struct gs_reactor
+{
+    int epfd;
+    int wake_efd; // Lets gs_reactor_stop() interrupt epoll_wait() from any thread.
+    bool stop;
+    uint64_t batch;
+    gs_reactor_handler_t handlers[GS_REACTOR_MAX_HANDLERS];
+    void (*idle)(gs_reactor_t *reactor, void *arg); // Runs after every batch of callbacks.
+    void *idle_arg;
+    gs_reactor_stats_t stats;
+};
+
+/**
+ * @brief Creates a reactor.
+ * 
+ * @return gs_reactor_t* nullptr on failure.
+ */
+gs_reactor_t *gs_reactor_create(void);
+
+/**
+ * @brief Destroys a reactor. Registered descriptors other than its timers and signal descriptors are not closed.
+ * 
+ * @param reactor 
+ */
+void gs_reactor_destroy(gs_reactor_t *reactor);
+
+/**
+ * @brief Starts dispatching events on a descriptor.
+ * 
+ * @param reactor 
+ * @param fd 
+ * @param events e.g. EPOLLIN.
+ * @param cb 
+ * @param arg 
+ * @return int 1 on success, 0 on failure.
+ */
+int gs_reactor_add(gs_reactor_t *reactor, int fd, uint32_t events, gs_reactor_cb_t cb, void *arg);
+
+/**
+ * @brief Stops dispatching events on a descriptor. Safe to call from a callback, including fd's own.
+ * 
+ * @param reactor 
+ * @param fd 
+ */
+void gs_reactor_del(gs_reactor_t *reactor, int fd);
+
+/**
+ * @brief Creates a timer whose expiries are dispatched to cb. It starts disarmed, see gs_reactor_timer_set().
+ * 
+ * @param reactor 
+ * @param cb 
+ * @param arg 
+ * @return int The timer descriptor, -1 on failure.
+ */
+int gs_reactor_timer(gs_reactor_t *reactor, gs_reactor_cb_t cb, void *arg);
+
+/**
+ * @brief Arms or disarms a timer created by gs_reactor_timer().
+ * 
+ * @param fd 
+ * @param first_us Until the first expiry, 0 to disarm.
+ * @param period_us Between later expiries, 0 for a one-shot.
+ */
+void gs_reactor_timer_set(int fd, uint64_t first_us, uint64_t period_us);
+
+/**
+ * @brief Delivers signals to cb through a signalfd instead of a handler.
+ * 
+ * Blocks the signals in the calling thread; call before creating other threads so they inherit the mask.
+ * 
+ * @param reactor 
+ * @param signals 
+ * @param cb 
+ * @param arg 
+ * @return int The signal descriptor, -1 on failure.
+ */
+int gs_reactor_signals(gs_reactor_t *reactor, const sigset_t *signals, gs_reactor_cb_t cb, void *arg);
+
+/**
+ * @brief Sets a hook that runs after every batch of callbacks, e.g. to flush what they queued.
+ * 
+ * @param reactor 
+ * @param idle 
+ * @param arg 
+ */
+void gs_reactor_set_idle(gs_reactor_t *reactor, void (*idle)(gs_reactor_t *reactor, void *arg), void *arg);
+
+/**
+ * @brief Dispatches events until gs_reactor_stop().
+ * 
+ * @param reactor 
+ * @return int 1 after a stop, 0 if epoll failed.
+ */
+int gs_reactor_run(gs_reactor_t *reactor);
+
+/**
+ * @brief Makes gs_reactor_run() return after the current batch. Safe to call from any thread.
+ * 
+ * @param reactor 
+ */
+void gs_reactor_stop(gs_reactor_t *reactor);
+
+/**
+ * @brief Snapshot of the reactor's statistics.
+ * 
+ * @param reactor 
+ * @param stats 
+ */
+void gs_reactor_get_stats(gs_reactor_t *reactor, gs_reactor_stats_t *stats);
+
+#endif // GS_REACTOR_HPP
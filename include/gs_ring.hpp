@@ -0,0 +1,178 @@
+/**
+ * @file gs_ring.hpp
+ * @author agent (agent@local)
+ * @brief Bounded, lock-free single-producer/single-consumer ring of GST frame slots.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * Decouples the UHF RX thread (producer) from the network writer (consumer) so a stalled or reconnecting
+ * server connection never blocks the radio. The producer and consumer indices live on separate cache lines,
+ * and each side keeps a cached copy of the other's index so the common case touches no shared line.
+ * 
+ */
+
+#ifndef GS_RING_HPP
+#define GS_RING_HPP
+
+#include <stdint.h>
+#include "gs_uhf.hpp"
+
+#define RING_CACHE_LINE 64
+
+/**
+ * @brief One frame in the ring. Written by the producer between reserve and commit, read by the consumer
+ * between peek and release.
+ * 
+ */
+typedef struct alignas(RING_CACHE_LINE)
+{
+    union
+    {
+        gst_fec_frame_t air; // The radio reads into the slot and the frame is sent from it, see gs_uhf_recv_frame().
+        gst_frame_t frame;
+    };
+    uint8_t *message; // A reassembled multi-frame downlink (payload_pool block) to send instead of frame.payload.
+    ssize_t len;      // Valid bytes of frame.payload, or of message.
+    int16_t rssi;
+    uint64_t rx_ns; // When the frame came off the radio, CLOCK_MONOTONIC.
+} gs_ring_slot_t;
+
+/**
+ * @brief Sizing statistics, see gs_ring_get_stats().
+ * 
+ */
+typedef struct
+{
+    uint32_t capacity;
+    uint32_t depth;      //!< Frames currently queued.
+    uint32_t high_water; //!< Deepest the ring has been.
+    uint64_t pushes;     //!< Frames committed.
+    uint64_t pops;       //!< Frames released.
+    uint64_t overflows;  //!< Frames dropped because the ring was full.
+} gs_ring_stats_t;
+
+struct gs_ring
+{
+    // Producer side.
+    alignas(RING_CACHE_LINE) uint64_t head;
+    uint64_t tail_cache;
+    uint64_t overflows;
+    uint32_t high_water;
+
+    // Consumer side.
+    alignas(RING_CACHE_LINE) uint64_t tail;
+    uint64_t head_cache;
+    uint32_t consumer_waiting;
+
+    // Read-only after creation.
+    alignas(RING_CACHE_LINE) uint32_t capacity;
+    uint32_t mask;
+    int efd; // Wakes a consumer blocked in gs_ring_wait().
+    gs_ring_slot_t *slots;
+};
+
+/**
+ * @brief Creates a ring.
+ * 
+ * @param capacity Rounded up to a power of two.
+ * @return gs_ring_t* nullptr on failure.
+ */
+gs_ring_t *gs_ring_create(uint32_t capacity);
+
+/**
+ * @brief Destroys a ring. Neither side may be using it.
+ * 
+ * @param ring 
+ */
+void gs_ring_destroy(gs_ring_t *ring);
+
+/**
+ * @brief Producer: returns the next free slot without publishing it.
+ * 
+ * @param ring 
+ * @return gs_ring_slot_t* nullptr if the ring is full.
+ */
+gs_ring_slot_t *gs_ring_reserve(gs_ring_t *ring);
+
+/**
+ * @brief Producer: publishes the slot returned by the last gs_ring_reserve() and wakes the consumer.
+ * 
+ * @param ring 
+ */
+void gs_ring_commit(gs_ring_t *ring);
+
+/**
+ * @brief Producer: records a frame that was dropped because the ring was full.
+ * 
+ * @param ring 
+ */
+void gs_ring_overflow(gs_ring_t *ring);
+
+/**
+ * @brief Consumer: returns the oldest queued slot without removing it.
+ * 
+ * @param ring 
+ * @return gs_ring_slot_t* nullptr if the ring is empty.
+ */
+gs_ring_slot_t *gs_ring_peek(gs_ring_t *ring);
+
+/**
+ * @brief Consumer: removes the slot returned by the last gs_ring_peek().
+ * 
+ * @param ring 
+ */
+void gs_ring_release(gs_ring_t *ring);
+
+/**
+ * @brief Consumer: blocks until the ring is non-empty or the timeout expires.
+ * 
+ * @param ring 
+ * @param timeout_ms -1 to wait forever.
+ * @return int 1 if a frame is queued, 0 on timeout.
+ */
+int gs_ring_wait(gs_ring_t *ring, int timeout_ms);
+
+/**
+ * @brief Consumer: descriptor that becomes readable when an armed ring receives a frame.
+ * 
+ * For event loops: call gs_ring_arm() before sleeping on it and gs_ring_disarm() after waking.
+ * 
+ * @param ring 
+ * @return int 
+ */
+int gs_ring_fd(gs_ring_t *ring);
+
+/**
+ * @brief Consumer: asks the producer to signal gs_ring_fd() on the next commit.
+ * 
+ * @param ring 
+ * @return int 1 if the consumer should sleep, 0 if frames are already queued (the ring is left disarmed).
+ */
+int gs_ring_arm(gs_ring_t *ring);
+
+/**
+ * @brief Consumer: clears the wakeup descriptor and the armed flag.
+ * 
+ * @param ring 
+ */
+void gs_ring_disarm(gs_ring_t *ring);
+
+/**
+ * @brief Snapshot of the ring's statistics. Safe to call from any thread.
+ * 
+ * @param ring 
+ * @param stats 
+ */
+void gs_ring_get_stats(gs_ring_t *ring, gs_ring_stats_t *stats);
+
+/**
+ * @brief Prints the ring's statistics.
+ * 
+ * @param name 
+ * @param ring 
+ */
+void gs_ring_print_stats(const char *name, gs_ring_t *ring);
+
+#endif // GS_RING_HPP
@@ -0,0 +1,138 @@
+/**
+ * @file gs_rt.hpp
+ * @author agent (agent@local)
+ * @brief Opt-in real-time profile for the radio threads, and a wakeup latency (jitter) probe to check it with.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * The si446x holds two frames in its FIFO; a radio thread that is paged out or preempted for longer than that
+ * takes loses frames. The profile (roof_uhf.out -R <priority>) takes both away:
+ *     - Memory: every page is locked and faulted in up front (mlockall()), the heap is grown by
+ *       GS_RT_HEAP_RESERVE and never handed back, and threads get GS_RT_STACK_BYTES stacks, locked as they are
+ *       mapped, instead of 8 MB ones.
+ *     - Scheduling: the radio threads run SCHED_FIFO at the given priority on their -r CPUs, the TX thread one
+ *       below it on the same CPUs. Everything else (event loop, network, polling, logging, metrics) is kept on
+ *       the housekeeping CPUs (-k).
+ * 
+ * gs_rt_jitter_run() is a cyclictest-style probe: a thread with the radio threads' policy and CPU sleeps to
+ * absolute deadlines and histograms how late it wakes up, which is how late a radio IRQ would be serviced.
+ * 
+ */
+
+#ifndef GS_RT_HPP
+#define GS_RT_HPP
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define GS_RT_STACK_BYTES (256 * 1024)      // Every thread's stack under the profile.
+#define GS_RT_STACK_PREFAULT (64 * 1024)    // Of it touched by each radio thread as it starts.
+#define GS_RT_HEAP_RESERVE (8 * 1024 * 1024) // Heap faulted in, and kept, up front.
+#define GS_RT_HIST_US 1000                  // Jitter histogram: 1 us buckets up to this, then overflow.
+#define GS_RT_JITTER_INTERVAL_US 1000       // Default probe period.
+
+/**
+ * @brief The profile, see gs_rt_setup().
+ * 
+ */
+typedef struct
+{
+    int priority;           // SCHED_FIFO priority of the radio threads, 0 for the profile off.
+    cpu_set_t housekeeping; // CPUs for every other thread.
+    bool isolate;           // housekeeping was given.
+} gs_rt_config_t;
+
+/**
+ * @brief Wakeup latency probe results.
+ * 
+ */
+typedef struct
+{
+    uint32_t interval_us;
+    int priority; // The policy it ran with, 0 for SCHED_OTHER.
+    int cpu;      // -1 for any.
+    uint64_t samples;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    uint64_t sum_ns;
+    uint64_t hist[GS_RT_HIST_US]; // Wakeups late by [i, i + 1) us.
+    uint64_t overflow;            // Later than GS_RT_HIST_US us.
+} gs_rt_jitter_t;
+
+/**
+ * @brief Parses a CPU list, e.g. "0,2-3".
+ * 
+ * @param list 
+ * @param cpus 
+ * @return int 1 on success, 0 if it is malformed or empty.
+ */
+int gs_rt_parse_cpus(const char *list, cpu_set_t *cpus);
+
+/**
+ * @brief Applies the memory side of the profile, and keeps the calling thread (and every thread it starts
+ * from here on) on the housekeeping CPUs. Call from main() before starting any thread; does nothing with
+ * the profile off.
+ * 
+ * @param config 
+ * @return int 1 on success, 0 if the memory could not be locked (the daemon runs on, without the guarantee).
+ */
+int gs_rt_setup(const gs_rt_config_t *config);
+
+/**
+ * @brief Whether gs_rt_setup() put the profile in place.
+ * 
+ * @return bool 
+ */
+bool gs_rt_active(void);
+
+/**
+ * @brief Initializes attributes for a thread that touches the radio.
+ * 
+ * @param attr Destroyed by the caller after pthread_create().
+ * @param priority SCHED_FIFO priority, 0 for the inherited policy.
+ * @param cpu CPU to run on, -1 for the inherited affinity.
+ * @return int 1 on success, 0 on failure (attr is left usable, with defaults).
+ */
+int gs_rt_thread_attr(pthread_attr_t *attr, int priority, int cpu);
+
+/**
+ * @brief Touches GS_RT_STACK_PREFAULT bytes of the calling thread's stack, so its first deep call does not
+ * fault. Called as each radio thread starts; does nothing with the profile off.
+ * 
+ */
+void gs_rt_prefault_stack(void);
+
+/**
+ * @brief Runs the wakeup latency probe on a thread of its own, and waits for it.
+ * 
+ * @param jitter Results.
+ * @param priority SCHED_FIFO priority, 0 for SCHED_OTHER.
+ * @param cpu -1 for any.
+ * @param interval_us Sleep between wakeups, 0 for GS_RT_JITTER_INTERVAL_US.
+ * @param duration_ms 
+ * @param stop Ends the probe early once true, may be nullptr.
+ * @return int 1 on success, 0 if the thread could not be started with that policy.
+ */
+int gs_rt_jitter_run(gs_rt_jitter_t *jitter, int priority, int cpu, uint32_t interval_us, uint32_t duration_ms, const bool *stop);
+
+/**
+ * @brief Estimates a wakeup latency quantile from the histogram.
+ * 
+ * @param jitter 
+ * @param quantile 0 to 1.
+ * @return uint64_t Nanoseconds, the top of the bucket holding the quantile; max_ns past the histogram.
+ */
+uint64_t gs_rt_jitter_quantile(const gs_rt_jitter_t *jitter, double quantile);
+
+/**
+ * @brief Prints the probe's summary and its non-empty histogram buckets.
+ * 
+ * @param jitter 
+ */
+void gs_rt_jitter_print(const gs_rt_jitter_t *jitter);
+
+#endif // GS_RT_HPP
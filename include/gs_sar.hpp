@@ -0,0 +1,245 @@
+/**
+ * @file gs_sar.hpp
+ * @author agent (agent@local)
+ * @brief Segmentation and reassembly of messages larger than one GST frame, with selective-repeat ACKs.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * A message is cut into segments that each fill one GST frame: a small header (message ID, segment number,
+ * total length) followed by up to GS_SAR_SEGMENT_SIZE bytes. Segment frames carry GST_SAR_GUID instead of
+ * GST_GUID so single-frame commands are untouched. The sender keeps up to GS_SAR_WINDOW segments in flight;
+ * the receiver acknowledges with the first missing segment plus a bitmap of what it holds past it, so only
+ * lost segments are sent again. A segment is resent when its retransmission timer runs out, or as soon as an
+ * ACK shows a segment sent after it arrived (the air does not reorder frames).
+ * 
+ * One gs_sar_t is one end of a link and carries both directions. It is not tied to a radio: the caller moves
+ * payloads between it and the air, which is what lets the simulated spacecraft speak the same protocol.
+ * 
+ */
+
+#ifndef GS_SAR_HPP
+#define GS_SAR_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include "gs_uhf.hpp"
+
+#define GS_SAR_WINDOW 32 // Segments in flight, at most the width of gs_sar_ack_t::selective.
+#define GS_SAR_ACK_EVERY 4 // In-order segments received before an ACK is sent unprompted.
+#define GS_SAR_MAX_TRIES 8 // Transmissions of one segment before the message is abandoned.
+#define GS_SAR_RTO_INIT_MS 1000 // Retransmission timeout before the round trip has been measured.
+#define GS_SAR_RTO_MIN_MS 100
+#define GS_SAR_RTO_MAX_MS 10000
+#define GS_SAR_MAX_MESSAGE 0xffff // Limited by gs_sar_header_t::total.
+
+#define GS_SAR_DATA 0xd5
+#define GS_SAR_DATA_LZ 0xd6 // A segment of a message compressed with gs_lz_pack().
+#define GS_SAR_ACK 0xa5
+
+// gs_sar_input() result flags.
+#define GS_SAR_IN_ACK 0x1 // An ACK is waiting in gs_sar_take_ack().
+#define GS_SAR_IN_MESSAGE 0x2 // A message was completed, see gs_sar_message().
+
+typedef struct __attribute__((packed))
+{
+    uint8_t type; // GS_SAR_DATA or GS_SAR_DATA_LZ
+    uint8_t msg_id;
+    uint16_t seq;   // Segment number.
+    uint16_t total; // Message length in bytes.
+} gs_sar_header_t;
+
+#define GS_SAR_SEGMENT_SIZE (GST_MAX_PAYLOAD_SIZE - sizeof(gs_sar_header_t))
+
+/**
+ * @brief Frames a payload takes on the air: one if it fits, its segments otherwise.
+ */
+static inline int gs_sar_frames(size_t len)
+{
+    return len <= GST_MAX_PAYLOAD_SIZE ? 1 : (int)((len + GS_SAR_SEGMENT_SIZE - 1) / GS_SAR_SEGMENT_SIZE);
+}
+
+typedef struct __attribute__((packed))
+{
+    uint8_t type; // GS_SAR_ACK
+    uint8_t msg_id;
+    uint16_t cumulative; // Every segment below this has arrived.
+    uint32_t selective;  // Bit i: segment cumulative + 1 + i has arrived.
+} gs_sar_ack_t;
+
+/**
+ * @brief Result of gs_sar_send_poll().
+ * 
+ */
+typedef enum
+{
+    GS_SAR_IDLE = 0, //!< No message being sent.
+    GS_SAR_SEND,     //!< Transmit the payload now.
+    GS_SAR_WAIT,     //!< Nothing to send before wake_ns or the next ACK, see gs_sar_wait().
+    GS_SAR_DONE,     //!< Every segment was acknowledged.
+    GS_SAR_FAILED,   //!< A segment ran out of tries.
+} gs_sar_status_t;
+
+typedef struct
+{
+    uint64_t messages_sent;     //!< Messages fully acknowledged.
+    uint64_t messages_failed;   //!< Messages abandoned.
+    uint64_t segments_sent;     //!< Including retransmissions.
+    uint64_t retransmits;
+    uint64_t acks_received;
+    uint64_t messages_received; //!< Messages reassembled.
+    uint64_t segments_received;
+    uint64_t duplicates;        //!< Segments received again.
+    uint64_t acks_sent;
+    uint64_t malformed;
+    uint32_t rto_ms;            //!< Current retransmission timeout.
+} gs_sar_stats_t;
+
+struct gs_sar
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond; // CLOCK_MONOTONIC, signalled on every input.
+    uint32_t events;
+
+    // Send side.
+    bool tx_active;
+    const uint8_t *tx_msg; // The caller's, until gs_sar_send_poll() returns GS_SAR_DONE or GS_SAR_FAILED.
+    uint16_t tx_len;
+    uint16_t tx_nseg;
+    uint16_t tx_base; // Oldest unacknowledged segment.
+    uint16_t tx_next; // Next segment never sent.
+    uint8_t tx_id;
+    bool tx_lz;
+    uint64_t tx_sent_ns[GS_SAR_WINDOW]; // Indexed by segment % GS_SAR_WINDOW, 0 = resend now.
+    uint8_t tx_tries[GS_SAR_WINDOW];
+    bool tx_acked[GS_SAR_WINDOW];
+    uint64_t srtt_ns; // Smoothed round trip, 0 until measured.
+    uint64_t rttvar_ns;
+    uint64_t rto_ns;
+
+    // Receive side.
+    uint8_t *rx_buf;
+    uint8_t *rx_have; // One bit per segment.
+    size_t max_message;
+    bool rx_active;
+    uint8_t rx_id;
+    bool rx_lz;
+    uint16_t rx_total;
+    uint16_t rx_nseg;
+    uint16_t rx_count;
+    uint16_t rx_cumulative;
+    uint16_t rx_since_ack;
+    bool rx_done_valid; // The last completed message, re-ACKed if its segments turn up again.
+    uint8_t rx_done_id;
+    uint16_t rx_done_total;
+    uint16_t rx_done_nseg;
+    bool ack_pending;
+    gs_sar_ack_t ack;
+
+    gs_sar_stats_t stats;
+};
+
+/**
+ * @brief Creates one end of a SAR link.
+ * 
+ * @param max_message Largest message that will be reassembled, at most GS_SAR_MAX_MESSAGE.
+ * @return gs_sar_t* nullptr on failure.
+ */
+gs_sar_t *gs_sar_create(size_t max_message);
+
+/**
+ * @brief Destroys a SAR endpoint.
+ * 
+ * @param sar 
+ */
+void gs_sar_destroy(gs_sar_t *sar);
+
+/**
+ * @brief Feeds the payload of a received GST_SAR_GUID frame to the endpoint.
+ * 
+ * Segments go to reassembly, ACKs to the send side. Wakes gs_sar_wait().
+ * 
+ * @param sar 
+ * @param payload GST_MAX_PAYLOAD_SIZE bytes.
+ * @param now_ns CLOCK_MONOTONIC.
+ * @return int GS_SAR_IN_* flags, negative if the payload is malformed.
+ */
+int gs_sar_input(gs_sar_t *sar, const uint8_t *payload, uint64_t now_ns);
+
+/**
+ * @brief Returns the message completed by the last gs_sar_input() that reported GS_SAR_IN_MESSAGE.
+ * 
+ * @param sar 
+ * @param len Output, message length.
+ * @param compressed Output, whether it came compressed (GS_SAR_DATA_LZ) and needs gs_lz_decompress().
+ * @return const uint8_t* Valid until the next gs_sar_input().
+ */
+const uint8_t *gs_sar_message(gs_sar_t *sar, size_t *len, bool *compressed = nullptr);
+
+/**
+ * @brief Takes the ACK the receive side wants sent, if any.
+ * 
+ * @param sar 
+ * @param payload Output, GST_MAX_PAYLOAD_SIZE bytes to send in a GST_SAR_GUID frame.
+ * @return int 1 if payload holds an ACK, 0 if none is waiting.
+ */
+int gs_sar_take_ack(gs_sar_t *sar, uint8_t *payload);
+
+/**
+ * @brief Starts sending a message.
+ * 
+ * @param sar 
+ * @param msg Must stay valid until gs_sar_send_poll() returns GS_SAR_DONE or GS_SAR_FAILED.
+ * @param len 1 to GS_SAR_MAX_MESSAGE.
+ * @param compressed msg is gs_lz_pack() output, which the segments say so the far end decompresses it.
+ * @return int 1 on success, 0 if a message is already being sent or len is out of range.
+ */
+int gs_sar_send_start(gs_sar_t *sar, const void *msg, size_t len, bool compressed = false);
+
+/**
+ * @brief Abandons the message being sent.
+ * 
+ * @param sar 
+ */
+void gs_sar_send_abort(gs_sar_t *sar);
+
+/**
+ * @brief Decides what the send side does next.
+ * 
+ * Retransmissions that are due go first, oldest segment first, then new segments while the window is open.
+ * 
+ * @param sar 
+ * @param now_ns CLOCK_MONOTONIC.
+ * @param payload Output on GS_SAR_SEND, GST_MAX_PAYLOAD_SIZE bytes to send in a GST_SAR_GUID frame.
+ * @param wake_ns Output on GS_SAR_WAIT, when the next retransmission falls due.
+ * @return gs_sar_status_t 
+ */
+gs_sar_status_t gs_sar_send_poll(gs_sar_t *sar, uint64_t now_ns, uint8_t *payload, uint64_t *wake_ns);
+
+/**
+ * @brief Sleeps until the next gs_sar_input() or until_ns, whichever is first.
+ * 
+ * @param sar 
+ * @param until_ns CLOCK_MONOTONIC.
+ */
+void gs_sar_wait(gs_sar_t *sar, uint64_t until_ns);
+
+/**
+ * @brief Snapshot of the endpoint's statistics.
+ * 
+ * @param sar 
+ * @param stats 
+ */
+void gs_sar_get_stats(gs_sar_t *sar, gs_sar_stats_t *stats);
+
+/**
+ * @brief Prints the endpoint's statistics.
+ * 
+ * @param name 
+ * @param sar 
+ */
+void gs_sar_print_stats(const char *name, gs_sar_t *sar);
+
+#endif // GS_SAR_HPP
@@ -0,0 +1,141 @@
+/**
+ * @file gs_sgp4.hpp
+ * @author agent (agent@local)
+ * @brief Two-line element sets, the SGP4 propagator, and where a satellite is as seen from the station.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * A port of the near-earth part of SGP4 as published by Vallado et al., "Revisiting Spacetrack Report #3"
+ * (AIAA 2006-6753), with the WGS-72 constants the element sets are fitted with. Deep-space (SDP4) orbits,
+ * periods of 225 minutes or more, are refused: everything we talk to on UHF is in LEO.
+ * 
+ * Positions come out in TEME (km, km/s) and are turned into look angles from the station by rotating through
+ * Greenwich mean sidereal time; polar motion and UT1 - UTC are ignored, which is well under a kilometer.
+ * Times are Unix seconds (UTC) throughout.
+ * 
+ */
+
+#ifndef GS_SGP4_HPP
+#define GS_SGP4_HPP
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define GS_TLE_NAME_MAX 25
+#define GS_TLE_LINE_MAX 80
+
+/**
+ * @brief One element set, as read from a TLE. Angles in radians, mean motion in radians per minute.
+ * 
+ */
+typedef struct
+{
+    char name[GS_TLE_NAME_MAX]; // Line 0, if there was one.
+    int catnum;                 // NORAD catalog number.
+    double epoch;               // Unix seconds.
+    double bstar;               // Drag term, 1/earth radii.
+    double inclo;
+    double nodeo;
+    double ecco;
+    double argpo;
+    double mo;
+    double no_kozai;
+} gs_tle_t;
+
+/**
+ * @brief A satellite ready to propagate, see gs_sgp4_init().
+ * 
+ */
+typedef struct
+{
+    gs_tle_t tle;
+    bool isimp; // Perigee below 220 km: the simplified drag model.
+    double no;  // Un-Kozai'd mean motion.
+    double ao, con41, con42, x1mth2, x7thm1, cosio, sinio, eta, cc1, cc4, cc5, d2, d3, d4;
+    double delmo, sinmao, mdot, argpdot, nodedot, omgcof, xmcof, nodecf, t2cof, t3cof, t4cof, t5cof, xlcof, aycof;
+} gs_sgp4_t;
+
+/**
+ * @brief A ground station, geodetic on WGS-84.
+ * 
+ */
+typedef struct
+{
+    double lat;     // Radians, north positive.
+    double lon;     // Radians, east positive.
+    double alt;     // km above the ellipsoid.
+    double ecef[3]; // km, filled in by gs_sgp4_station().
+} gs_station_t;
+
+/**
+ * @brief Where the satellite is from the station.
+ * 
+ */
+typedef struct
+{
+    double az;         // Radians from north, clockwise.
+    double el;         // Radians above the horizon.
+    double range;      // km.
+    double range_rate; // km/s, positive while the satellite moves away.
+} gs_look_t;
+
+/**
+ * @brief Parses an element set.
+ * 
+ * @param name Line 0, may be nullptr.
+ * @param line1 
+ * @param line2 
+ * @param tle 
+ * @return int 1 on success, 0 if a line is malformed or fails its checksum.
+ */
+int gs_tle_parse(const char *name, const char *line1, const char *line2, gs_tle_t *tle);
+
+/**
+ * @brief Initializes the propagator for an element set.
+ * 
+ * @param sat 
+ * @param tle 
+ * @return int 1 on success, 0 for a deep-space orbit or elements SGP4 cannot use.
+ */
+int gs_sgp4_init(gs_sgp4_t *sat, const gs_tle_t *tle);
+
+/**
+ * @brief Propagates to some minutes after the element set's epoch.
+ * 
+ * @param sat 
+ * @param tsince Minutes from the epoch, may be negative.
+ * @param r TEME position, km.
+ * @param v TEME velocity, km/s.
+ * @return int 1 on success, 0 if the orbit has decayed or the elements have stopped making sense.
+ */
+int gs_sgp4_propagate(const gs_sgp4_t *sat, double tsince, double r[3], double v[3]);
+
+/**
+ * @brief Greenwich mean sidereal time.
+ * 
+ * @param t Unix seconds.
+ * @return double Radians, 0 to 2 pi.
+ */
+double gs_sgp4_gmst(double t);
+
+/**
+ * @brief Fills in the station's earth-fixed position from its geodetic one.
+ * 
+ * @param station 
+ */
+void gs_sgp4_station(gs_station_t *station);
+
+/**
+ * @brief Looks at the satellite from the station.
+ * 
+ * @param sat 
+ * @param station Set up with gs_sgp4_station().
+ * @param t Unix seconds.
+ * @param look 
+ * @return int 1 on success, 0 if the satellite could not be propagated to t.
+ */
+int gs_sgp4_look(const gs_sgp4_t *sat, const gs_station_t *station, double t, gs_look_t *look);
+
+#endif // GS_SGP4_HPP
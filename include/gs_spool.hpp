@@ -0,0 +1,149 @@
+/**
+ * @file gs_spool.hpp
+ * @author agent (agent@local)
+ * @brief Store-and-forward spool: downlinked frames kept on disk while the server is unreachable.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * The spool is a directory of append-only segment files, <seq>.spool, each a gs_spool_header_t followed by
+ * gs_spool_record_t records and their payloads. Frames are appended to the newest segment until it reaches
+ * segment_bytes, and read back in order from the oldest. As frames are delivered the oldest segment's header
+ * records how far it has been drained, and once nothing is left in it the file is deleted. Only the position
+ * of each segment's head and tail, and the frames between them, are kept in memory.
+ * 
+ * Appends are flushed to disk (fdatasync) at most every GS_SPOOL_SYNC_MS and by gs_spool_sync(), and the
+ * drained offsets are written without a sync, so after a crash the last moments of the outage may be lost
+ * or delivered twice: the spool is at-least-once, like the server connection it stands in for. On opening,
+ * every segment left in the directory is scanned and a record torn by the crash is cut off.
+ * 
+ * Not thread-safe, except gs_spool_get_stats(): one thread (the event loop) appends and drains.
+ * 
+ */
+
+#ifndef GS_SPOOL_HPP
+#define GS_SPOOL_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#define GS_SPOOL_MAGIC "GSSPL001"
+#define GS_SPOOL_RECORD_MAGIC 0x5352
+#define GS_SPOOL_MAX_RECORD 0xffff // Largest frame one record holds.
+#define GS_SPOOL_MAX_SEGMENTS 4096 // Segment files one spool can hold, whatever max_bytes allows.
+#define GS_SPOOL_SYNC_MS 1000 // Longest appended frames wait to be flushed to disk.
+#define GS_SPOOL_PATH_MAX 256
+
+typedef struct
+{
+    char magic[8];
+    uint64_t seq;     // Matches the file name.
+    uint64_t drained; // Offset of the first record not yet delivered.
+    uint64_t reserved;
+} gs_spool_header_t;
+
+typedef struct __attribute__((packed))
+{
+    uint16_t magic;      // GS_SPOOL_RECORD_MAGIC, so a torn or zeroed tail is recognized.
+    uint16_t len;        // Payload bytes that follow.
+    uint16_t crc;        // gs_crc16() of the payload.
+    int16_t rssi;
+    uint64_t spooled_ns; // CLOCK_REALTIME when it was spooled, so the age survives a restart.
+} gs_spool_record_t;
+
+/**
+ * @brief How much the spool holds and has handled, see gs_spool_get_stats().
+ * 
+ */
+typedef struct
+{
+    uint64_t frames;   //!< Frames waiting to be delivered.
+    uint64_t bytes;    //!< Disk they take, record headers included.
+    uint32_t segments; //!< Segment files.
+    uint64_t spooled;  //!< Frames appended since the spool was opened.
+    uint64_t drained;  //!< Frames delivered since the spool was opened.
+    uint64_t refused;  //!< Appends turned away because the spool was full (or the disk failed).
+    uint64_t corrupt;  //!< Records cut off or skipped because they failed their checks.
+} gs_spool_stats_t;
+
+typedef struct gs_spool gs_spool_t;
+
+/**
+ * @brief Opens a spool directory, creating it if needed, and recovers the frames left in it.
+ * 
+ * @param dir 
+ * @param segment_bytes Size at which a segment is closed and the next one started.
+ * @param max_bytes Disk the undelivered frames may use; appends beyond it are refused.
+ * @return gs_spool_t* nullptr on failure.
+ */
+gs_spool_t *gs_spool_open(const char *dir, size_t segment_bytes, size_t max_bytes);
+
+/**
+ * @brief Flushes the spool to disk and closes it. Frames not yet delivered stay in the directory.
+ * 
+ * @param spool 
+ */
+void gs_spool_close(gs_spool_t *spool);
+
+/**
+ * @brief Appends a frame.
+ * 
+ * @param spool 
+ * @param data 
+ * @param len At most GS_SPOOL_MAX_RECORD.
+ * @param rssi 
+ * @return int 1 on success, 0 if the spool is full or the write failed (nothing is appended).
+ */
+int gs_spool_append(gs_spool_t *spool, const void *data, size_t len, int16_t rssi);
+
+/**
+ * @brief Reads the oldest frame not yet delivered, without removing it; gs_spool_pop() does once it has been.
+ * 
+ * @param spool 
+ * @param buf 
+ * @param size At least the largest frame appended.
+ * @param rssi Set to the frame's RSSI, may be nullptr.
+ * @return ssize_t The frame's length, 0 if the spool is empty, negative on failure.
+ */
+ssize_t gs_spool_peek(gs_spool_t *spool, void *buf, size_t size, int16_t *rssi);
+
+/**
+ * @brief Marks the frame gs_spool_peek() returned as delivered, deleting its segment if it was the last in it.
+ * 
+ * @param spool 
+ */
+void gs_spool_pop(gs_spool_t *spool);
+
+/**
+ * @brief Flushes appended frames and drained offsets to disk now.
+ * 
+ * @param spool 
+ */
+void gs_spool_sync(gs_spool_t *spool);
+
+/**
+ * @brief Frames waiting to be delivered.
+ * 
+ * @param spool 
+ * @return uint64_t 
+ */
+uint64_t gs_spool_depth(gs_spool_t *spool);
+
+/**
+ * @brief Gets the spool's statistics. Safe from any thread.
+ * 
+ * @param spool 
+ * @param stats 
+ */
+void gs_spool_get_stats(gs_spool_t *spool, gs_spool_stats_t *stats);
+
+/**
+ * @brief Prints the spool's statistics.
+ * 
+ * @param spool 
+ */
+void gs_spool_print_stats(gs_spool_t *spool);
+
+#endif // GS_SPOOL_HPP
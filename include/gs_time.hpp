@@ -0,0 +1,49 @@
+/**
+ * @file gs_time.hpp
+ * @author agent (agent@local)
+ * @brief Monotonic clock helpers shared by the radio and network code.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#ifndef GS_TIME_HPP
+#define GS_TIME_HPP
+
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+
+#define NSEC_PER_SEC 1000000000ULL
+#define NSEC_PER_MSEC 1000000ULL
+#define NSEC_PER_USEC 1000ULL
+
+/**
+ * @brief Returns CLOCK_MONOTONIC in nanoseconds.
+ * 
+ * @return uint64_t 
+ */
+static inline uint64_t gs_time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+/**
+ * @brief Sleeps until the given CLOCK_MONOTONIC time, in nanoseconds.
+ * 
+ * @param deadline_ns 
+ */
+static inline void gs_sleep_until_ns(uint64_t deadline_ns)
+{
+    struct timespec ts;
+    ts.tv_sec = deadline_ns / NSEC_PER_SEC;
+    ts.tv_nsec = deadline_ns % NSEC_PER_SEC;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+}
+
+#endif // GS_TIME_HPP
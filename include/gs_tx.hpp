@@ -0,0 +1,217 @@
+/**
+ * @file gs_tx.hpp
+ * @author agent (agent@local)
+ * @brief Uplink scheduler: prioritized, deadline-bounded queue of commands waiting for the radio.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * The event loop submits commands and returns to the socket immediately; the UHF TX thread
+ * takes them in priority order. Each priority class is FIFO, so commands of one class are never reordered,
+ * including across retries. An item that outlives its deadline, runs out of retries, or does not fit in
+ * the queue is NACKed back to the server rather than silently stalled.
+ * 
+ */
+
+#ifndef GS_TX_HPP
+#define GS_TX_HPP
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include "gs_uhf.hpp"
+
+typedef enum
+{
+    GS_TX_PRIO_SAFE = 0, //!< Safe-mode and other spacecraft-protecting commands.
+    GS_TX_PRIO_COMMAND,  //!< Ordinary commands.
+    GS_TX_PRIO_BULK,     //!< Large data uploads.
+    GS_TX_PRIO_NUM,
+} gs_tx_prio_t;
+
+/**
+ * @brief Result of gs_tx_next().
+ * 
+ */
+typedef enum
+{
+    GS_TX_NONE = 0, //!< Timed out or stopped, nothing to do.
+    GS_TX_SEND,     //!< Transmit the item, then report with gs_tx_retry() on failure.
+    GS_TX_EXPIRED,  //!< The item passed its deadline and was removed; NACK it.
+} gs_tx_next_t;
+
+typedef struct
+{
+    gst_fec_frame_t *frame; // A sealed single frame (payload_pool block), transmitted where it is, owned by the item.
+    uint8_t *message;     // A multi-frame message (payload_pool block) sent with SAR instead, owned by the item.
+    ssize_t len;
+    bool compressed;      // message is gs_lz_pack() output.
+    uint8_t prio;         // gs_tx_prio_t
+    uint8_t attempts;     // Transmissions tried so far.
+    uint32_t seq;         // Submission order, for the logs.
+    uint64_t recv_ns;     // When the command arrived from the server, CLOCK_MONOTONIC.
+    uint64_t enqueue_ns;
+    uint64_t deadline_ns; // Dropped with a NACK if not on the air by then.
+    uint64_t next_ns;     // Earliest time of the next attempt (backoff).
+} gs_tx_item_t;
+
+typedef struct
+{
+    uint32_t depth[GS_TX_PRIO_NUM];
+    uint64_t submitted;
+    uint64_t rejected; //!< Refused because the queue was full.
+    uint64_t expired;  //!< Dropped at their deadline.
+    uint64_t retries;
+    uint64_t failed;   //!< Dropped after UHF_TX_MAX_RETRIES.
+} gs_tx_stats_t;
+
+struct gs_tx_queue
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond; // CLOCK_MONOTONIC.
+    uint32_t capacity;   // Across all classes.
+    uint32_t count;
+    struct
+    {
+        gs_tx_item_t *items; // capacity + 1, the spare takes a retry while the queue is full.
+        uint32_t head;
+        uint32_t count;
+    } cls[GS_TX_PRIO_NUM];
+    uint32_t seq;
+    bool stop;
+    bool wake;
+    bool safe_mods[256]; // cmd_input_t.mod values that get GS_TX_PRIO_SAFE.
+    gs_tx_stats_t stats;
+};
+
+/**
+ * @brief Creates an uplink queue.
+ * 
+ * @param capacity Items waiting, across every class.
+ * @return gs_tx_queue_t* nullptr on failure.
+ */
+gs_tx_queue_t *gs_tx_queue_create(uint32_t capacity);
+
+/**
+ * @brief Destroys a queue; nothing may be waiting on it.
+ * 
+ * @param queue 
+ */
+void gs_tx_queue_destroy(gs_tx_queue_t *queue);
+
+/**
+ * @brief Marks a cmd_input_t.mod value as safe-mode priority.
+ * 
+ * @param queue 
+ * @param mod 
+ */
+void gs_tx_set_safe_mod(gs_tx_queue_t *queue, uint8_t mod);
+
+/**
+ * @brief Picks the priority class of a command.
+ * 
+ * Messages longer than one frame are always GS_TX_PRIO_BULK, so only that class ever holds the radio for
+ * a multi-frame transfer. Otherwise commands to a safe-mode module are GS_TX_PRIO_SAFE, and commands
+ * carrying more than UHF_TX_BULK_BYTES of data are GS_TX_PRIO_BULK.
+ * 
+ * @param queue 
+ * @param payload A cmd_input_t.
+ * @param len 
+ * @return gs_tx_prio_t 
+ */
+gs_tx_prio_t gs_tx_classify(gs_tx_queue_t *queue, const void *payload, ssize_t len);
+
+/**
+ * @brief Queues a command for the radio. Never blocks on the radio.
+ * 
+ * @param queue 
+ * @param frame A frame sealed around the command (gs_uhf_frame_seal()) in a payload_pool block; the queue
+ * owns it on success. Never copied: the TX thread transmits it from the block.
+ * @param len Bytes of command in the frame.
+ * @param prio 
+ * @param recv_ns When the command arrived, for the end-to-end latency.
+ * @return int 1 if queued, 0 if the queue is full (backpressure: NACK the server; the caller keeps the block),
+ * -1 if len is more than a frame holds (NACK it as well).
+ */
+int gs_tx_submit(gs_tx_queue_t *queue, gst_fec_frame_t *frame, ssize_t len, gs_tx_prio_t prio, uint64_t recv_ns);
+
+/**
+ * @brief Queues a message longer than one frame, to be sent with SAR (see gs_sar.hpp).
+ * 
+ * @param queue 
+ * @param message A payload_pool block; the queue owns it on success.
+ * @param len 
+ * @param recv_ns When the message arrived, for the end-to-end latency.
+ * @param compressed The message is gs_lz_pack() output, see gs_sar_send_start().
+ * @return int 1 if queued, 0 if the queue is full (the caller keeps the block).
+ */
+int gs_tx_submit_message(gs_tx_queue_t *queue, uint8_t *message, ssize_t len, uint64_t recv_ns, bool compressed = false);
+
+/**
+ * @brief Waits for the next item to transmit, or the next expired one to NACK.
+ * 
+ * @param queue 
+ * @param item Output, the item removed from the queue.
+ * @param timeout_ms 
+ * @return gs_tx_next_t 
+ */
+gs_tx_next_t gs_tx_next(gs_tx_queue_t *queue, gs_tx_item_t *item, int timeout_ms);
+
+/**
+ * @brief Puts a failed item back at the head of its class, after a backoff.
+ * 
+ * @param queue 
+ * @param item 
+ * @return int 1 if it will be retried, 0 if it is out of retries or past its deadline (NACK it).
+ */
+int gs_tx_retry(gs_tx_queue_t *queue, gs_tx_item_t *item);
+
+/**
+ * @brief Checks whether a class above prio has an item due or expired, so a long transfer can yield to it.
+ * 
+ * @param queue 
+ * @param prio 
+ * @return int 1 if gs_tx_next() would return a higher-priority item now.
+ */
+int gs_tx_preempt(gs_tx_queue_t *queue, gs_tx_prio_t prio);
+
+/**
+ * @brief Makes the current (or next) gs_tx_next() return GS_TX_NONE at once, e.g. to send a SAR ACK.
+ * 
+ * @param queue 
+ */
+void gs_tx_wake(gs_tx_queue_t *queue);
+
+/**
+ * @brief Wakes and releases every gs_tx_next() caller, for shutdown.
+ * 
+ * @param queue 
+ */
+void gs_tx_stop(gs_tx_queue_t *queue);
+
+/**
+ * @brief Snapshot of the queue's statistics.
+ * 
+ * @param queue 
+ * @param stats 
+ */
+void gs_tx_get_stats(gs_tx_queue_t *queue, gs_tx_stats_t *stats);
+
+/**
+ * @brief Prints the queue's statistics.
+ * 
+ * @param queue 
+ */
+void gs_tx_print_stats(gs_tx_queue_t *queue);
+
+/**
+ * @brief Printable name of a priority class.
+ * 
+ * @param prio 
+ * @return const char*
+ */
+const char *gs_tx_prio_name(int prio);
+
+#endif // GS_TX_HPP
@@ -13,17 +13,76 @@
 #define GS_UHF_HPP
 
 #include <stdint.h>
-#include <si446x.h>
+#include <pthread.h>
 #include "network.hpp"
+#include "gs_radio.hpp"
+#include "gs_pool.hpp"
+#include "gs_fec.hpp"
 
 // #define UHF_NOT_CONNECTED_DEBUG
 
 #define SERVER_POLL_RATE 5 // Once per this many seconds
 #define SEC *1000000
 #define RECV_TIMEOUT 15
+#define UHF_IRQ_SLICE_MS 1000 // Longest single IRQ wait, so gst_done and a stuck nIRQ are rechecked.
+#define UHF_STATS_REPORT_FRAMES 100 // Print receive statistics every this many frames.
+#define UHF_VALIDATE_BATCH 64 // Frames per CRC batch in gs_uhf_validate_batch().
+#define UHF_RX_RING_SIZE 1024 // Downlink frames buffered between the radio and the server connection.
+#define NETWORK_TX_RETRY_MS 100 // Network writer's wait before retrying a frame the server did not take.
+#define NETFRAME_POOL_SIZE 8 // NetFrames in flight at once: network RX, network TX and NACKs, with headroom.
+#define UHF_TX_QUEUE_SIZE 32 // Uplink commands waiting for the radio, across all priority classes.
+// Payload blocks held outside the TX queue at once: the item the TX thread is sending, the payload the event
+// loop is receiving and its compressed copy (or a spool drain batch), and a reassembled downlink.
+#define PAYLOAD_POOL_IN_FLIGHT 4
+// NETFRAME_MAX_PAYLOAD_SIZE buffers. Every queued uplink owns one, so a full queue (and its spare retry
+// slot) must not push the blocks in flight onto the heap.
+#define PAYLOAD_POOL_SIZE 40
+static_assert(PAYLOAD_POOL_SIZE >= UHF_TX_QUEUE_SIZE + 1 + PAYLOAD_POOL_IN_FLIGHT, "a full TX queue must not drain the payload pool");
+#define UHF_TX_BULK_BYTES 32 // Commands carrying more data than this are scheduled as bulk.
+#define UHF_TX_DEADLINE_SAFE_MS 60000 // Longest an uplink command of each class may wait for the air.
+#define UHF_TX_DEADLINE_COMMAND_MS 30000
+#define UHF_TX_DEADLINE_BULK_MS 120000
+#define UHF_TX_MAX_RETRIES 5 // Failed transmissions retried before the command is NACKed.
+#define UHF_TX_BACKOFF_MS 50 // First retry delay, doubled on every further retry.
+#define UHF_TX_BACKOFF_MAX_MS 2000
+#define UHF_TX_WRITE_ATTEMPTS 3 // Back-to-back radio writes within one gs_uhf_write().
+#define UHF_TX_BURST_FRAMES 8 // Most commands sent in one TX burst before the radio listens again, see gs_arbiter.hpp.
+#define UHF_SAR_MAX_MESSAGE NETFRAME_MAX_PAYLOAD_SIZE // Largest multi-frame message in either direction, see gs_sar.hpp.
+#define UHF_SAR_PREEMPT_MS 50 // Longest a multi-frame uplink waits for ACKs before checking for higher-priority commands.
+#define UHF_CAPTURE_RECORDS 65536 // Records per pass capture file (8 MiB), see gs_capture.hpp.
+#define UHF_CAPTURE_PASS_GAP_S 600 // Downlink silence that ends a pass and starts a new capture file.
+#define UHF_MAX_RADIOS 8 // Radios one station can listen on at once, see gs_uhf_radio_rx_thread().
+#define UHF_DIVERSITY_WINDOW_MS 20 // Copies of a frame this close together on different radios are one transmission, see gs_diversity.hpp.
+#define UHF_DIVERSITY_STALE_MS 30000 // A radio that has heard nothing for this long is not picked for the uplink on its RSSI.
+#define UHF_SPOOL_SEGMENT_BYTES (1 << 20) // Spool segment files are closed at this size, see gs_spool.hpp.
+#define UHF_SPOOL_MAX_BYTES (512 << 20) // Disk the spool may fill during an outage; once full, frames wait in the RX ring.
+#define UHF_SPOOL_DRAIN_BATCH 16 // Spooled frames sent per drain tick once the server is back, between live frames.
+#define UHF_SPOOL_DRAIN_MS 20 // Drain tick, so at most 800 spooled frames per second on top of the live downlink.
+#define UHF_RECONNECT_MIN_MS 500 // First wait before reconnecting to the server, doubled on every failed attempt.
+#define UHF_RECONNECT_MAX_MS 60000
+#define UHF_CONNECT_TIMEOUT_MS 2000 // Longest a connection to the server may take to open.
+#ifndef UHF_SERVER_HOST
+#define UHF_SERVER_HOST SERVER_IP // The GS server, where the network library connects; global_data_t::server_addr overrides it.
+#endif
+#define UHF_HEALTH_INTERVAL_MS 1000 // Default time between radio health probes, see gs_health.hpp.
+#define UHF_INIT_RETRY_MIN_MS 100 // First wait before initializing a radio again, doubled on every failed attempt.
+#define UHF_INIT_RETRY_MAX_MS 5000
+#define UHF_PASS_LEAD_S 120 // Default time before AOS the radio is brought up, see gs_pass.hpp.
+#define UHF_PASS_HOLD_S 60 // The radio stays up this long after LOS.
+#define UHF_PASS_MIN_EL_DEG 0 // Elevation a pass begins and ends at.
+#define UHF_PASS_HORIZON_S (48 * 3600) // How far ahead passes are predicted.
+#define UHF_DOPPLER_TOL_HZ 100 // Doppler error let through before the radio is retuned, see gs_doppler.hpp.
+#define UHF_DOPPLER_RECHECK_MS 1000 // Longest between Doppler checks during a pass, so a re-initialized radio is soon retuned.
+#define UHF_PASS_RECHECK_S 600 // Longest the pass scheduler sleeps: the TLE file is checked, and wall clock steps caught up with.
+#define UHF_METRICS_SOCKET "/tmp/roof_uhf_metrics.sock" // Prometheus text endpoint, see gs_metrics.hpp.
 #define RADIO_DEVICE_NAME "my_device"
 
 #define NACK_NO_UHF 0x756866 // Roof UHF says it cannot access UHF communications.
+#define NACK_TX_FULL 0x747866 // Uplink queue is full, resend later.
+#define NACK_TX_LATE 0x74786c // Uplink command was not on the air before its deadline.
+#define NACK_TX_FAILED 0x747865 // Uplink command failed every transmission attempt.
+#define NACK_TX_SIZE 0x74787a // Uplink command longer than the frame it was queued in.
+#define NACK_BAD_CONFIG 0x636667 // UHF_CONFIG frame malformed, or asking for a modem profile the radio cannot take.
 
 #define UHF_RSSI 0
 
@@ -31,6 +90,8 @@
 #define GST_MAX_PAYLOAD_SIZE 56
 #define GST_MAX_PACKET_SIZE 64
 #define GST_GUID 0x6f35
+#define GST_SAR_GUID 0x6f53 // Segments of multi-frame messages, see gs_sar.hpp.
+#define GST_LZ_GUID 0x6f5a // A single frame carrying a compressed payload, see gs_lz.hpp.
 #define GST_TERMINATION 0x0d0a // CRLF
 typedef struct __attribute__((packed))
 {
@@ -42,6 +103,18 @@ typedef struct __attribute__((packed))
 } gst_frame_t;
 #define GST_MAX_FRAME_SIZE sizeof(gst_frame_t)
 
+/**
+ * @brief A GST frame followed by Reed-Solomon parity over all of it, see gs_fec.hpp.
+ * 
+ * Told apart from a legacy frame by its length, so the two can share a link.
+ * 
+ */
+typedef struct __attribute__((packed))
+{
+    gst_frame_t frame;
+    uint8_t parity[GS_FEC_PARITY];
+} gst_fec_frame_t;
+
 enum GST_ERRORS
 {
     GST_ERROR = -1,            //!< General error
@@ -54,14 +127,70 @@ enum GST_ERRORS
 };
 ///////////////////////////////
 
+typedef struct gs_ring gs_ring_t;
+typedef struct gs_tx_queue gs_tx_queue_t;
+typedef struct gs_sar gs_sar_t;
+typedef struct gs_reactor gs_reactor_t;
+typedef struct gs_diversity gs_diversity_t;
+typedef struct gs_spool gs_spool_t;
+typedef struct gs_pass_plan gs_pass_plan_t;
+typedef struct gs_doppler gs_doppler_t;
+typedef struct global_data global_data_t;
+
+/**
+ * @brief One of several radios listening to the same pass, each read on its own thread into its own ring.
+ * 
+ */
 typedef struct
 {
-    // uhf_modem_t modem; // Just an int.
+    global_data_t *global;
+    int index;
+    gs_radio_t *radio;
+    gs_ring_t *rx_ring; // gs_uhf_radio_rx_thread() -> event loop's diversity merge.
+    int initd;
+    bool ready; // Accessed with __atomic builtins, like global_data_t::uhf_ready.
+} gs_uhf_radio_t;
+
+struct global_data
+{
     int uhf_initd;
+    gs_radio_t *radio; // The first radio, set once at start-up.
+    gs_radio_t *uplink_radio; // The radio the uplink last went out on, nullptr for radio. Written by the UHF TX thread with __atomic builtins, see gs_div_uplink().
     NetDataClient *network_data;
-    bool uhf_ready;
+    bool uhf_ready; // Accessed with __atomic builtins, the RX and TX sides run on different threads. With several radios, any of them.
+    bool uhf_done; // Set to abort blocking UHF reads (shutdown).
+    gs_reactor_t *reactor; // See gs_uhf_event_loop().
+    pthread_mutex_t net_lock; // Serializes the server socket: the event loop's sends and reconnects, the TX thread's NACKs.
+    gs_ring_t *uhf_rx_ring; // UHF RX -> event loop's forwarding to the server.
+    gs_tx_queue_t *uhf_tx_queue; // Event loop's server socket -> UHF TX thread.
+    gs_sar_t *uhf_sar; // Multi-frame messages: segments and ACKs arrive on UHF RX, leave on UHF TX.
+    gs_pool_t *netframe_pool; // sizeof(NetFrame) blocks, see gs_pool_netframe().
+    gs_pool_t *payload_pool;  // NETFRAME_MAX_PAYLOAD_SIZE blocks.
+    int num_radios; // More than one: each is read by gs_uhf_radio_rx_thread() and uplink_radio is the one the uplink uses.
+    gs_uhf_radio_t radios[UHF_MAX_RADIOS];
+    gs_diversity_t *diversity; // Merges the radios' downlinks and picks the uplink radio.
+    gs_spool_t *spool; // Downlink kept on disk while the server is unreachable; nullptr to hold it in uhf_rx_ring only.
+    uint32_t health_ms; // Time between radio health probes, 0 for UHF_HEALTH_INTERVAL_MS.
+    uint64_t start_ns; // When the ground station started (gs_time_ns()), to log how long bring-up took; 0 not to.
+    gs_pass_plan_t *passes; // Pass schedule: the radios are only up from pass_lead_s before AOS to UHF_PASS_HOLD_S after LOS; nullptr for around the clock.
+    uint32_t pass_lead_s;
+    gs_doppler_t *doppler; // Doppler correction during passes; nullptr for none.
+    gs_modem_ctl_t *modem; // Modem profile asked for by UHF_CONFIG frames, and the adaptive data rate; nullptr to refuse them.
+    bool compress; // Uplink payloads longer than a frame go compressed when that saves a frame, see gs_lz.hpp.
+    const char *server_addr; // "host[:port]" of a stand-in server (tools/gs_standin.out) to connect to instead of the GS server; nullptr for the GS server.
     uint8_t netstat;
-} global_data_t;
+};
+
+/**
+ * @brief True until shutdown begins, for the worker threads' loops.
+ * 
+ * @param global 
+ * @return bool 
+ */
+static inline bool gs_uhf_running(global_data_t *global)
+{
+    return __atomic_load_n(&global->network_data->thread_status, __ATOMIC_ACQUIRE) > 0 && !__atomic_load_n(&global->uhf_done, __ATOMIC_ACQUIRE);
+}
 
 /**
  * @brief Command structure that SPACE-HAUC receives.
@@ -96,7 +225,7 @@ typedef struct
 } cs_ack_t;      // (N/ACK)
 
 /**
- * @brief Listens for UHF packets from SPACE-HAUC.
+ * @brief Listens for UHF packets from SPACE-HAUC on a dedicated thread, see gs_uhf_event_loop().
  * 
  * @param args 
  * @return void* 
@@ -104,21 +233,82 @@ typedef struct
 void *gs_uhf_rx_thread(void *args);
 
 /**
- * @brief Listens for NetworkFrames from the Ground Station Network.
+ * @brief Listens on one of several radios (args is its gs_uhf_radio_t), queueing every valid frame on its
+ * rx_ring; the event loop merges the rings and drops the copies, see gs_diversity.hpp.
  * 
  * @param args 
  * @return void* 
  */
-void *gs_network_rx_thread(void *args);
+void *gs_uhf_radio_rx_thread(void *args);
+
+/**
+ * @brief Runs the ground station's network side, and its radio receive side unless rx_thread, until stopped.
+ * 
+ * One epoll loop on global->reactor serves the server connection (uplink commands, which a thread of its own
+ * receives so a slow server never stalls the loop), the server poll and reconnect timer, and forwarding
+ * downlinked frames from the RX ring. Inline, it also sleeps on the radio's
+ * IRQ and reads frames as they arrive, so a frame reaches the server without crossing a thread; with
+ * rx_thread, gs_uhf_rx_thread() reads the radio and the loop wakes on the ring instead. Radio transmission
+ * stays on gs_uhf_tx_thread() either way, since a write blocks for the frame's air time.
+ * 
+ * With more than one radio (global->num_radios), each is read by gs_uhf_radio_rx_thread() and rx_thread
+ * must be set: the loop wakes on all of their rings and forwards each frame once, whichever radios heard it.
+ * 
+ * While the server is unreachable, downlinked frames are moved to global->spool if there is one, and drained
+ * from it in UHF_SPOOL_DRAIN_BATCH bursts once the server is back, live frames going first. Reconnection is
+ * retried with exponential backoff and jitter, UHF_RECONNECT_MIN_MS to UHF_RECONNECT_MAX_MS. Connecting runs
+ * on a thread of its own, so the radio is brought up and read while the server is slow to answer.
+ * 
+ * Every global->health_ms the loop probes each ready radio (see gs_health.hpp); the RX and TX paths only read
+ * the result. A radio that fails is taken out of use and re-initialized by its RX thread, or by the loop.
+ * 
+ * @param global 
+ * @param rx_thread Whether gs_uhf_rx_thread(), or gs_uhf_radio_rx_thread() for each radio, is running.
+ * @return int 1 after gs_reactor_stop(), 0 on failure.
+ */
+int gs_uhf_event_loop(global_data_t *global, bool rx_thread);
+
+/**
+ * @brief Transmits queued uplink commands over UHF, see gs_tx.hpp.
+ * 
+ * Owns the radio's transmit side: only this thread calls gs_uhf_write(), so a radio that refuses to
+ * transmit delays the uplink queue but never the event loop. Whatever is due when the thread wakes goes out
+ * in one TX burst of up to UHF_TX_BURST_FRAMES, after which the radio is put straight back into pipe mode;
+ * the receive side waits out the burst, see gs_arbiter.hpp.
+ * 
+ * @param args 
+ * @return void* 
+ */
+void *gs_uhf_tx_thread(void *args);
 
 /**
  * @brief Sends UHF-received data to the Ground Station Network Server.
  * 
- * @param thread_data 
+ * @param global_data 
  * @param buffer 
  * @param buffer_size 
+ * @return ssize_t Result of NetFrame::sendFrame(), negative on failure or while disconnected.
  */
-void gs_network_tx(global_data_t *global_data, uint8_t *buffer, ssize_t buffer_size);
+ssize_t gs_network_tx(global_data_t *global_data, uint8_t *buffer, ssize_t buffer_size);
+
+/**
+ * @brief Sends a NACK carrying code to the Ground Station Network Server.
+ * 
+ * @param global_data 
+ * @param code e.g. NACK_NO_UHF.
+ * @return ssize_t Result of NetFrame::sendFrame(), negative on failure.
+ */
+ssize_t gs_network_nack(global_data_t *global_data, int code);
+
+/**
+ * @brief Acts on a NetFrame received from the server: queues uplink data for the UHF TX thread, NACKing what
+ * cannot be. Called by the event loop for every frame it reads off the server socket.
+ * 
+ * @param global_data 
+ * @param netframe 
+ * @param recv_ns When the frame was read, for the GS_STAGE_NET_RECV latency.
+ */
+void gs_network_rx(global_data_t *global_data, NetFrame *netframe, uint64_t recv_ns);
 
 /**
  * @brief Periodically polls the Ground Station Network Server for its status.
@@ -154,41 +344,161 @@ int gs_connect_to_server(global_data_t *global_data);
 int gs_connect(int socket, const struct sockaddr *address, socklen_t socket_size, int tout_s);
 
 /**
- * @brief Initializes X-Band radio.
+ * @brief Initializes UHF radio, and publishes the outcome as its health (see gs_health_init()).
  * 
  * see: gst_init()
  * https://github.com/SPACE-HAUC/uhf_gst/blob/4a051f511301f1ff8333d3a960d19ce06a463b11/src/uhf_gst.c
  * 
+ * @param radio 
  * @return int 1 on success, 0 on failure.
  */
-int gs_uhf_init(void);
+int gs_uhf_init(gs_radio_t *radio);
 
 /**
- * @brief 
+ * @brief Blocks until a GST frame arrives, the RECV_TIMEOUT expires or gst_done is set.
+ * 
+ * Sleeps on the radio's IRQ (see gs_radio_irq_wait()) rather than spinning on the radio. Frames carrying
+ * Reed-Solomon parity (gst_fec_frame_t) are corrected before they are validated.
  * 
  * see: gst_read()
  * https://github.com/SPACE-HAUC/uhf_gst/blob/4a051f511301f1ff8333d3a960d19ce06a463b11/src/uhf_gst.c
  * 
+ * @param radio 
  * @param buf 
  * @param buffer_size 
  * @param rssi 
  * @param gst_done 
- * @return ssize_t 
+ * @param guid Set to the frame's GUID, GST_GUID or GST_SAR_GUID.
+ * @return ssize_t Bytes read on success, GST_TOUT (0) on timeout, negative GST_ERRORS on failure.
  */
-ssize_t gs_uhf_read(char *buf, ssize_t buffer_size, int16_t *rssi, bool *gst_done);
+ssize_t gs_uhf_read(gs_radio_t *radio, char *buf, ssize_t buffer_size, int16_t *rssi, bool *gst_done, uint16_t *guid = NULL);
 
 /**
- * @brief 
+ * @brief Takes one GST frame from the radio without waiting, for callers that sleep on the IRQ themselves.
+ * 
+ * @param radio 
+ * @param buf 
+ * @param buffer_size 
+ * @param rssi 
+ * @param irq_ns The IRQ that announced the frame, for the latency statistics (0 if unknown).
+ * @param guid Set to the frame's GUID, GST_GUID or GST_SAR_GUID.
+ * @return ssize_t Bytes read on success, GST_TOUT (0) if the radio holds no frame, negative GST_ERRORS on failure.
+ */
+ssize_t gs_uhf_read_frame(gs_radio_t *radio, char *buf, ssize_t buffer_size, int16_t *rssi, uint64_t irq_ns, uint16_t *guid = NULL);
+
+/**
+ * @brief Takes one GST frame from the radio without waiting, straight into the caller's frame, and checks it there.
+ * 
+ * What gs_uhf_read_frame() does without copying the payload out: the frame can be read into the slot it
+ * will be sent from.
+ * 
+ * @param radio 
+ * @param fec Receives the frame, corrected if it carried parity. Its GUID tells single frames from SAR ones.
+ * @param rssi 
+ * @param irq_ns The IRQ that announced the frame, for the latency statistics (0 if unknown).
+ * @return ssize_t Bytes read on success, GST_TOUT (0) if the radio holds no frame, negative GST_ERRORS on failure.
+ */
+ssize_t gs_uhf_recv_frame(gs_radio_t *radio, gst_fec_frame_t *fec, int16_t *rssi, uint64_t irq_ns);
+
+/**
+ * @brief gs_uhf_read() into the caller's frame, see gs_uhf_recv_frame().
+ * 
+ * Also returns early, with GST_TOUT, once the health monitor finds the radio down (gs_health_lost()).
+ * 
+ * @param radio 
+ * @param fec 
+ * @param rssi 
+ * @param gst_done 
+ * @return ssize_t Bytes read on success, GST_TOUT (0) on timeout, negative GST_ERRORS on failure.
+ */
+ssize_t gs_uhf_recv(gs_radio_t *radio, gst_fec_frame_t *fec, int16_t *rssi, bool *gst_done);
+
+/**
+ * @brief Checks a received GST frame's GUID (GST_GUID or GST_SAR_GUID) and CRCs.
+ * 
+ * @param frame 
+ * @return int GST_SUCCESS, or a negative GST_ERRORS value.
+ */
+int gs_uhf_validate(const gst_frame_t *frame);
+
+/**
+ * @brief Validates many contiguous GST frames at once (capture replay, multi-radio ingest).
+ * 
+ * Same checks as gs_uhf_validate() but quiet, with the CRCs computed by gs_crc16_batch().
+ * 
+ * @param frames 
+ * @param count 
+ * @param results Output, count entries of GST_SUCCESS or a negative GST_ERRORS value.
+ */
+void gs_uhf_validate_batch(const gst_frame_t *frames, size_t count, int *results);
+
+/**
+ * @brief Prints the receive IRQ statistics (wakeups, timeouts, arrival-to-handler latency) for a radio.
+ * 
+ * @param radio 
+ */
+void gs_uhf_print_rx_stats(gs_radio_t *radio);
+
+/**
+ * @brief Transmits one GST frame, trying the radio up to UHF_TX_WRITE_ATTEMPTS times.
+ * 
+ * Adds Reed-Solomon parity when gs_uhf_fec_tx() says the link uses it.
  * 
  * see: gst_write()
  * https://github.com/SPACE-HAUC/uhf_gst/blob/4a051f511301f1ff8333d3a960d19ce06a463b11/src/uhf_gst.c
  * 
+ * @param radio 
  * @param buf 
- * @param buffer_size 
- * @param gst_done 
- * @return ssize_t 
+ * @param buffer_size At most GST_MAX_PAYLOAD_SIZE; shorter payloads are zero-padded.
+ * @param gst_done Stops retrying when set.
+ * @param guid GST_SAR_GUID for multi-frame message segments and ACKs.
+ * @return ssize_t The radio's result, 0 or negative if every attempt failed or the payload does not fit a frame.
+ */
+ssize_t gs_uhf_write(gs_radio_t *radio, char *buf, ssize_t buffer_size, bool *gst_done, uint16_t guid = GST_GUID);
+
+/**
+ * @brief Transmits a frame built in place (see gs_uhf_frame_seal()), appending the parity to it if the link uses FEC.
+ * 
+ * @param radio 
+ * @param fec 
+ * @param gst_done Stops retrying when set.
+ * @return ssize_t The radio's result, 0 or negative if every attempt failed.
+ */
+ssize_t gs_uhf_send_frame(gs_radio_t *radio, gst_fec_frame_t *fec, bool *gst_done);
+
+/**
+ * @brief Whether gs_uhf_write() adds Reed-Solomon parity on this link, see gs_radio_t::fec.
+ * 
+ * @param radio 
+ * @return bool 
+ */
+static inline bool gs_uhf_fec_tx(gs_radio_t *radio)
+{
+    return radio->fec == GS_FEC_ON || (radio->fec == GS_FEC_AUTO && __atomic_load_n(&radio->fec_peer, __ATOMIC_RELAXED));
+}
+
+/**
+ * @brief Builds a complete GST frame (GUID, CRCs, termination) around a payload.
+ * 
+ * Payloads shorter than GST_MAX_PAYLOAD_SIZE are zero-padded, longer ones are refused.
+ * 
+ * @param frame 
+ * @param payload 
+ * @param payload_size 
+ * @param guid 
+ * @return int 1 on success, 0 if the payload does not fit a frame (the frame is left as it was).
+ */
+int gs_uhf_frame_build(gst_frame_t *frame, const void *payload, ssize_t payload_size, uint16_t guid = GST_GUID);
+
+/**
+ * @brief Completes a GST frame whose payload was written into it directly: pads the payload and adds the
+ * GUID, CRCs and termination.
+ * 
+ * @param frame 
+ * @param payload_size Bytes of frame->payload already written.
+ * @param guid 
  */
-ssize_t gs_uhf_write(char *buf, ssize_t buffer_size, bool *gst_done);
+void gs_uhf_frame_seal(gst_frame_t *frame, ssize_t payload_size, uint16_t guid = GST_GUID);
 
 // NOTE: Needs to be called every time we want to begin talking to SPACE-HAUC, but haven't had a communication with it for more than a couple minutes.
 // void gs_uhf_enable_pipe(void) __attribute__((alias("si446x_en_pipe")));
@@ -0,0 +1,250 @@
+/**
+ * @file gs_arbiter.cpp
+ * @author agent (agent@local)
+ * @brief Half-duplex radio arbiter: one SPI transaction at a time, and TX bursts the receive side stands back for.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include "gs_arbiter.hpp"
+#include "gs_radio.hpp"
+#include "gs_metrics.hpp"
+#include "gs_time.hpp"
+#include "meb_debug.hpp"
+
+void gs_arbiter_init(gs_arbiter_t *arbiter)
+{
+    memset(arbiter, 0x0, sizeof(gs_arbiter_t));
+    pthread_mutex_init(&arbiter->lock, NULL);
+    pthread_cond_init(&arbiter->cond, NULL);
+    arbiter->efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+}
+
+void gs_arbiter_destroy(gs_arbiter_t *arbiter)
+{
+    if (arbiter->efd >= 0)
+    {
+        close(arbiter->efd);
+    }
+    pthread_cond_destroy(&arbiter->cond);
+    pthread_mutex_destroy(&arbiter->lock);
+}
+
+/**
+ * @brief Takes the receive side for the calling thread. Called with the lock held.
+ */
+static void arbiter_rx_take(gs_arbiter_t *arbiter)
+{
+    arbiter->rx_busy = true;
+    arbiter->rx_owner = pthread_self();
+    arbiter->rx_depth = 1;
+    arbiter->stats.rx_ops++;
+}
+
+/**
+ * @brief True, and one level deeper, if the calling thread is already in a receive-side transaction. Called with the lock held.
+ */
+static bool arbiter_rx_nested(gs_arbiter_t *arbiter)
+{
+    if (arbiter->rx_busy && pthread_equal(arbiter->rx_owner, pthread_self()))
+    {
+        arbiter->rx_depth++;
+        return true;
+    }
+    return false;
+}
+
+void gs_arbiter_rx_begin(gs_radio_t *radio)
+{
+    gs_arbiter_t *arbiter = &radio->arbiter;
+    pthread_mutex_lock(&arbiter->lock);
+    if (!arbiter_rx_nested(arbiter))
+    {
+        while (arbiter->rx_busy || arbiter->tx || arbiter->tx_waiting)
+        {
+            pthread_cond_wait(&arbiter->cond, &arbiter->lock);
+        }
+        arbiter_rx_take(arbiter);
+    }
+    pthread_mutex_unlock(&arbiter->lock);
+}
+
+bool gs_arbiter_rx_try(gs_radio_t *radio)
+{
+    gs_arbiter_t *arbiter = &radio->arbiter;
+    bool retval = true;
+    pthread_mutex_lock(&arbiter->lock);
+    if (!arbiter_rx_nested(arbiter))
+    {
+        // Another receive-side transaction is short, so wait it out; a burst is not.
+        while (arbiter->rx_busy && !arbiter->tx && !arbiter->tx_waiting)
+        {
+            pthread_cond_wait(&arbiter->cond, &arbiter->lock);
+        }
+        if (!arbiter->rx_busy && !arbiter->tx && !arbiter->tx_waiting)
+        {
+            arbiter_rx_take(arbiter);
+        }
+        else
+        {
+            arbiter->stats.rx_refused++;
+            arbiter->rx_deferred = true;
+            retval = false;
+        }
+    }
+    pthread_mutex_unlock(&arbiter->lock);
+    return retval;
+}
+
+int gs_arbiter_fd(gs_radio_t *radio)
+{
+    return radio->arbiter.efd;
+}
+
+void gs_arbiter_rx_end(gs_radio_t *radio)
+{
+    gs_arbiter_t *arbiter = &radio->arbiter;
+    pthread_mutex_lock(&arbiter->lock);
+    if (--arbiter->rx_depth == 0)
+    {
+        arbiter->rx_busy = false;
+        pthread_cond_broadcast(&arbiter->cond);
+    }
+    pthread_mutex_unlock(&arbiter->lock);
+}
+
+void gs_arbiter_tx_begin(gs_radio_t *radio)
+{
+    gs_arbiter_t *arbiter = &radio->arbiter;
+    pthread_mutex_lock(&arbiter->lock);
+    if (arbiter->tx && pthread_equal(arbiter->owner, pthread_self()))
+    {
+        arbiter->depth++;
+        pthread_mutex_unlock(&arbiter->lock);
+        return;
+    }
+
+    uint64_t start = gs_time_ns();
+    arbiter->tx_waiting++;
+    while (arbiter->rx_busy || arbiter->tx)
+    {
+        pthread_cond_wait(&arbiter->cond, &arbiter->lock);
+    }
+    arbiter->tx_waiting--;
+    arbiter->tx = true;
+    arbiter->owner = pthread_self();
+    arbiter->depth = 1;
+    arbiter->frames = 0;
+    arbiter->wait_ns = gs_time_ns() - start;
+    pthread_mutex_unlock(&arbiter->lock);
+}
+
+/**
+ * @brief Hands the radio back at the end of a burst, listening again first if it transmitted.
+ */
+static void arbiter_release(gs_radio_t *radio)
+{
+    gs_arbiter_t *arbiter = &radio->arbiter;
+    bool sent = arbiter->frames > 0;
+    uint64_t turnaround = 0;
+    if (sent)
+    {
+        // Still ours, so no other transaction runs alongside.
+        radio->ops->en_pipe(radio);
+        turnaround = gs_time_ns() - arbiter->last_write_ns;
+    }
+
+    pthread_mutex_lock(&arbiter->lock);
+    uint64_t wait_ns = arbiter->wait_ns;
+    if (sent)
+    {
+        arbiter->stats.bursts++;
+        arbiter->stats.burst_frames += arbiter->frames;
+        arbiter->stats.rx_to_tx_sum_ns += wait_ns;
+        arbiter->stats.rx_to_tx_max_ns = wait_ns > arbiter->stats.rx_to_tx_max_ns ? wait_ns : arbiter->stats.rx_to_tx_max_ns;
+        arbiter->stats.tx_to_rx_sum_ns += turnaround;
+        arbiter->stats.tx_to_rx_max_ns = turnaround > arbiter->stats.tx_to_rx_max_ns ? turnaround : arbiter->stats.tx_to_rx_max_ns;
+    }
+    arbiter->tx = false;
+    arbiter->depth = 0;
+    bool deferred = arbiter->rx_deferred;
+    arbiter->rx_deferred = false;
+    pthread_cond_broadcast(&arbiter->cond);
+    pthread_mutex_unlock(&arbiter->lock);
+
+    uint64_t one = 1;
+    if (deferred && arbiter->efd >= 0 && write(arbiter->efd, &one, sizeof(one)) < 0)
+    {
+        erprintlf(errno);
+    }
+
+    if (sent)
+    {
+        // Bursts that only NACKed expired commands never left RX, so they are not counted.
+        gs_metrics_count(GS_COUNT_UHF_TX_BURSTS);
+        gs_metrics_record(GS_STAGE_RX_TO_TX, wait_ns);
+        gs_metrics_record(GS_STAGE_TX_TO_RX, turnaround);
+    }
+}
+
+void gs_arbiter_tx_end(gs_radio_t *radio)
+{
+    // Only the owner gets here, so depth is stable.
+    if (--radio->arbiter.depth == 0)
+    {
+        arbiter_release(radio);
+    }
+}
+
+int gs_arbiter_tx_suspend(gs_radio_t *radio)
+{
+    int depth = radio->arbiter.depth;
+    arbiter_release(radio);
+    return depth;
+}
+
+void gs_arbiter_tx_resume(gs_radio_t *radio, int depth)
+{
+    gs_arbiter_tx_begin(radio);
+    radio->arbiter.depth = depth;
+}
+
+ssize_t gs_arbiter_write(gs_radio_t *radio, void *buf, ssize_t len)
+{
+    gs_arbiter_tx_begin(radio);
+    ssize_t retval = radio->ops->write(radio, buf, len);
+    radio->arbiter.frames++;
+    radio->arbiter.last_write_ns = gs_time_ns();
+    gs_arbiter_tx_end(radio);
+    return retval;
+}
+
+void gs_arbiter_get_stats(gs_radio_t *radio, gs_arbiter_stats_t *stats)
+{
+    gs_arbiter_t *arbiter = &radio->arbiter;
+    pthread_mutex_lock(&arbiter->lock);
+    *stats = arbiter->stats;
+    pthread_mutex_unlock(&arbiter->lock);
+}
+
+void gs_arbiter_print_stats(const char *name, gs_radio_t *radio)
+{
+    gs_arbiter_stats_t stats[1];
+    gs_arbiter_get_stats(radio, stats);
+    if (stats->bursts == 0)
+    {
+        dbprintlf(CYAN_FG "%s arbiter: %llu receive-side transactions, no bursts.", name, (unsigned long long)stats->rx_ops);
+        return;
+    }
+    dbprintlf(CYAN_FG "%s arbiter: %llu receive-side transactions (%llu turned away), %llu bursts of %.2f frames; RX to TX mean %.1f us, max %.1f us; TX to RX mean %.1f us, max %.1f us.",
+              name, (unsigned long long)stats->rx_ops, (unsigned long long)stats->rx_refused, (unsigned long long)stats->bursts,
+              (double)stats->burst_frames / stats->bursts, stats->rx_to_tx_sum_ns / 1e3 / stats->bursts, stats->rx_to_tx_max_ns / 1e3,
+              stats->tx_to_rx_sum_ns / 1e3 / stats->bursts, stats->tx_to_rx_max_ns / 1e3);
+}
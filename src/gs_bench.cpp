@@ -0,0 +1,115 @@
+/**
+ * @file gs_bench.cpp
+ * @author agent (agent@local)
+ * @brief Machine-readable benchmark results, compared against a baseline by tools/gs_benchcmp.out.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "gs_bench.hpp"
+#include "meb_debug.hpp"
+
+void gs_bench_report(const char *bench, const char *metric, double value, const char *unit, gs_bench_better_t better, double tolerance)
+{
+    const char *path = getenv(GS_BENCH_ENV);
+    if (path == nullptr || path[0] == '\0')
+    {
+        return;
+    }
+
+    // One write per line, so results from benchmarks running side by side do not interleave.
+    char line[GS_BENCH_LINE_MAX];
+    int len = snprintf(line, sizeof(line), "{\"bench\": \"%s\", \"metric\": \"%s\", \"value\": %.6g, \"unit\": \"%s\", \"better\": \"%s\", \"tolerance\": %g}\n",
+                       bench, metric, value, unit, better == GS_BENCH_HIGHER ? "higher" : "lower", tolerance);
+    FILE *fp = fopen(path, "a");
+    if (fp == nullptr)
+    {
+        erprintlf(errno);
+        return;
+    }
+    if (len > 0 && (size_t)len < sizeof(line))
+    {
+        fwrite(line, 1, len, fp);
+    }
+    fclose(fp);
+}
+
+/**
+ * @brief Finds "key": in line and returns what follows it, nullptr if it is not there.
+ */
+static const char *bench_field(const char *line, const char *key)
+{
+    char pattern[GS_BENCH_NAME_MAX];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    const char *at = strstr(line, pattern);
+    if (at == nullptr)
+    {
+        return nullptr;
+    }
+    at += strlen(pattern);
+    while (*at == ' ')
+    {
+        at++;
+    }
+    return at;
+}
+
+/**
+ * @brief Copies the string value of key into out.
+ */
+static int bench_string(const char *line, const char *key, char *out, size_t size)
+{
+    const char *at = bench_field(line, key);
+    if (at == nullptr || *at != '"')
+    {
+        return 0;
+    }
+    const char *end = strchr(++at, '"');
+    if (end == nullptr || (size_t)(end - at) >= size)
+    {
+        return 0;
+    }
+    memcpy(out, at, end - at);
+    out[end - at] = '\0';
+    return 1;
+}
+
+/**
+ * @brief Reads the numeric value of key.
+ */
+static int bench_number(const char *line, const char *key, double *out)
+{
+    const char *at = bench_field(line, key);
+    if (at == nullptr)
+    {
+        return 0;
+    }
+    char *end;
+    *out = strtod(at, &end);
+    return end != at;
+}
+
+int gs_bench_parse(const char *line, gs_bench_result_t *result)
+{
+    char better[GS_BENCH_NAME_MAX];
+    memset(result, 0x0, sizeof(gs_bench_result_t));
+    if (!bench_string(line, "bench", result->bench, sizeof(result->bench)) ||
+        !bench_string(line, "metric", result->metric, sizeof(result->metric)) ||
+        !bench_string(line, "unit", result->unit, sizeof(result->unit)) ||
+        !bench_string(line, "better", better, sizeof(better)) ||
+        !bench_number(line, "value", &result->value))
+    {
+        return 0;
+    }
+    result->better = strcmp(better, "higher") == 0 ? GS_BENCH_HIGHER : GS_BENCH_LOWER;
+    // Optional.
+    bench_number(line, "tolerance", &result->tolerance);
+    return 1;
+}
@@ -0,0 +1,375 @@
+/**
+ * @file gs_capture.cpp
+ * @author agent (agent@local)
+ * @brief Pass capture: every radio frame and NetFrame appended to a memory-mapped file, for replay.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "gs_capture.hpp"
+#include "gs_time.hpp"
+#include "meb_debug.hpp"
+
+typedef struct
+{
+    int fd;
+    gs_capture_header_t *header; // nullptr when no file is open.
+    gs_capture_record_t *records;
+    size_t size;
+    char path[GS_CAPTURE_PATH_MAX];
+} capture_map_t;
+
+struct gs_capture_file
+{
+    capture_map_t map;
+    uint32_t slots; // Records the mapping holds.
+};
+
+static struct
+{
+    pthread_rwlock_t lock; // Appends share it, rotation takes it exclusively.
+    bool active;
+    capture_map_t map;
+    char prefix[GS_CAPTURE_PATH_MAX];
+    uint32_t capacity;
+    uint64_t pass_gap_ns;
+    uint64_t last_rx_ns;
+    gs_capture_stats_t stats;
+} capture = {PTHREAD_RWLOCK_INITIALIZER, false, {-1, nullptr, nullptr, 0, {0}}, {0}, 0, 0, 0, {0, 0, 0}};
+
+/**
+ * @brief Creates, preallocates and maps the next capture file.
+ */
+static int capture_map_create(capture_map_t *map)
+{
+    char stamp[32];
+    struct tm tm;
+    time_t now = time(NULL);
+    strftime(stamp, sizeof(stamp), "%Y%m%dT%H%M%SZ", gmtime_r(&now, &tm));
+    if (snprintf(map->path, sizeof(map->path), "%s-%s-%llu.cap", capture.prefix, stamp, (unsigned long long)capture.stats.files) >= (int)sizeof(map->path))
+    {
+        dbprintlf(RED_FG "Capture file name too long.");
+        return 0;
+    }
+
+    map->size = (size_t)(capture.capacity + 1) * GS_CAPTURE_RECORD_SIZE;
+    map->fd = open(map->path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (map->fd < 0)
+    {
+        dbprintlf(RED_FG "Failed to create capture file %s.", map->path);
+        erprintlf(errno);
+        return 0;
+    }
+    // Allocated up front: a store to a sparse page that the disk cannot back would be a SIGBUS.
+    int err = posix_fallocate(map->fd, 0, map->size);
+    void *addr = err == 0 ? mmap(NULL, map->size, PROT_READ | PROT_WRITE, MAP_SHARED, map->fd, 0) : MAP_FAILED;
+    if (addr == MAP_FAILED)
+    {
+        dbprintlf(RED_FG "Failed to map capture file %s.", map->path);
+        erprintlf(err ? err : errno);
+        close(map->fd);
+        unlink(map->path);
+        map->fd = -1;
+        return 0;
+    }
+
+    map->header = (gs_capture_header_t *)addr;
+    map->records = (gs_capture_record_t *)addr + 1;
+    memcpy(map->header->magic, GS_CAPTURE_MAGIC, sizeof(map->header->magic));
+    map->header->record_size = GS_CAPTURE_RECORD_SIZE;
+    map->header->capacity = capture.capacity;
+    map->header->count = 0;
+    map->header->start_mono_ns = gs_time_ns();
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    map->header->start_real_ns = (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+
+    capture.stats.files++;
+    dbprintlf(GREEN_FG "Capturing to %s (%u records).", map->path, capture.capacity);
+    return 1;
+}
+
+/**
+ * @brief Unmaps a capture file and trims it to the records written.
+ */
+static void capture_map_close(capture_map_t *map)
+{
+    if (map->header == nullptr)
+    {
+        return;
+    }
+    uint32_t count = map->header->count < map->header->capacity ? map->header->count : map->header->capacity;
+    munmap(map->header, map->size);
+    if (ftruncate(map->fd, (off_t)(count + 1) * GS_CAPTURE_RECORD_SIZE) < 0)
+    {
+        erprintlf(errno);
+    }
+    close(map->fd);
+    dbprintlf(GREEN_FG "Closed capture file %s, %u records.", map->path, count);
+    map->header = nullptr;
+    map->records = nullptr;
+    map->fd = -1;
+}
+
+int gs_capture_start(const char *prefix, uint32_t capacity, int pass_gap_s)
+{
+    pthread_rwlock_wrlock(&capture.lock);
+    if (capture.active)
+    {
+        pthread_rwlock_unlock(&capture.lock);
+        return 1;
+    }
+    if (strlen(prefix) >= GS_CAPTURE_PATH_MAX - 32 || capacity == 0)
+    {
+        dbprintlf(RED_FG "Invalid capture prefix or capacity.");
+        pthread_rwlock_unlock(&capture.lock);
+        return 0;
+    }
+    strcpy(capture.prefix, prefix);
+    capture.capacity = capacity;
+    capture.pass_gap_ns = pass_gap_s > 0 ? pass_gap_s * NSEC_PER_SEC : 0;
+    capture.last_rx_ns = 0;
+    int retval = capture_map_create(&capture.map);
+    __atomic_store_n(&capture.active, retval == 1, __ATOMIC_RELEASE);
+    pthread_rwlock_unlock(&capture.lock);
+    return retval;
+}
+
+void gs_capture_stop(void)
+{
+    pthread_rwlock_wrlock(&capture.lock);
+    __atomic_store_n(&capture.active, false, __ATOMIC_RELEASE);
+    capture_map_close(&capture.map);
+    pthread_rwlock_unlock(&capture.lock);
+}
+
+int gs_capture_rotate(void)
+{
+    pthread_rwlock_wrlock(&capture.lock);
+    if (!capture.active)
+    {
+        pthread_rwlock_unlock(&capture.lock);
+        return 0;
+    }
+    capture_map_close(&capture.map);
+    int retval = capture_map_create(&capture.map);
+    if (!retval)
+    {
+        dbprintlf(FATAL "Capture stopped, no file to write to.");
+        __atomic_store_n(&capture.active, false, __ATOMIC_RELEASE);
+    }
+    pthread_rwlock_unlock(&capture.lock);
+    return retval;
+}
+
+bool gs_capture_active(void)
+{
+    return __atomic_load_n(&capture.active, __ATOMIC_ACQUIRE);
+}
+
+void gs_capture_frame(gs_capture_kind_t kind, const void *data, size_t len, int16_t rssi, int16_t result)
+{
+    if (!__atomic_load_n(&capture.active, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+
+    uint64_t now = gs_time_ns();
+    if (kind == GS_CAPTURE_UHF_RX && capture.pass_gap_ns)
+    {
+        // The first frame after a long silence is the start of the next pass.
+        uint64_t last = __atomic_exchange_n(&capture.last_rx_ns, now, __ATOMIC_ACQ_REL);
+        if (last && now - last >= capture.pass_gap_ns)
+        {
+            gs_capture_rotate();
+        }
+    }
+
+    uint32_t n = len > 0 ? (len + GS_CAPTURE_DATA - 1) / GS_CAPTURE_DATA : 1;
+    pthread_rwlock_rdlock(&capture.lock);
+    gs_capture_header_t *header = capture.map.header;
+    if (header == nullptr)
+    {
+        pthread_rwlock_unlock(&capture.lock);
+        return;
+    }
+    uint32_t first = __atomic_fetch_add(&header->count, n, __ATOMIC_RELAXED);
+    if (first + n > header->capacity)
+    {
+        __atomic_fetch_add(&capture.stats.dropped, 1, __ATOMIC_RELAXED);
+        pthread_rwlock_unlock(&capture.lock);
+        return;
+    }
+
+    const uint8_t *bytes = (const uint8_t *)data;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        gs_capture_record_t *record = &capture.map.records[first + i];
+        size_t chunk = len > GS_CAPTURE_DATA ? GS_CAPTURE_DATA : len;
+        record->ts_ns = now;
+        record->flags = i + 1 < n ? GS_CAPTURE_MORE : 0;
+        record->rssi = rssi;
+        record->result = result;
+        record->len = chunk;
+        memcpy(record->data, bytes, chunk);
+        bytes += chunk;
+        len -= chunk;
+        __atomic_store_n(&record->kind, (uint8_t)kind, __ATOMIC_RELEASE);
+    }
+    __atomic_fetch_add(&capture.stats.records, n, __ATOMIC_RELAXED);
+    pthread_rwlock_unlock(&capture.lock);
+}
+
+void gs_capture_get_stats(gs_capture_stats_t *stats)
+{
+    stats->records = __atomic_load_n(&capture.stats.records, __ATOMIC_RELAXED);
+    stats->dropped = __atomic_load_n(&capture.stats.dropped, __ATOMIC_RELAXED);
+    stats->files = __atomic_load_n(&capture.stats.files, __ATOMIC_RELAXED);
+}
+
+void gs_capture_path(char *path)
+{
+    pthread_rwlock_rdlock(&capture.lock);
+    strcpy(path, capture.map.header != nullptr ? capture.map.path : "");
+    pthread_rwlock_unlock(&capture.lock);
+}
+
+gs_capture_file_t *gs_capture_open(const char *path)
+{
+    gs_capture_file_t *file = (gs_capture_file_t *)calloc(1, sizeof(gs_capture_file_t));
+    if (file == nullptr)
+    {
+        return nullptr;
+    }
+    capture_map_t *map = &file->map;
+    snprintf(map->path, sizeof(map->path), "%s", path);
+
+    struct stat st;
+    map->fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (map->fd < 0 || fstat(map->fd, &st) < 0 || (size_t)st.st_size < sizeof(gs_capture_header_t))
+    {
+        dbprintlf(RED_FG "Cannot open capture file %s.", path);
+        if (map->fd >= 0)
+        {
+            close(map->fd);
+        }
+        free(file);
+        return nullptr;
+    }
+    map->size = st.st_size;
+    void *addr = mmap(NULL, map->size, PROT_READ, MAP_SHARED, map->fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        erprintlf(errno);
+        close(map->fd);
+        free(file);
+        return nullptr;
+    }
+    map->header = (gs_capture_header_t *)addr;
+    map->records = (gs_capture_record_t *)addr + 1;
+    if (memcmp(map->header->magic, GS_CAPTURE_MAGIC, sizeof(map->header->magic)) != 0 || map->header->record_size != GS_CAPTURE_RECORD_SIZE)
+    {
+        dbprintlf(RED_FG "%s is not a capture file.", path);
+        munmap(addr, map->size);
+        close(map->fd);
+        free(file);
+        return nullptr;
+    }
+    file->slots = map->size / GS_CAPTURE_RECORD_SIZE - 1;
+    return file;
+}
+
+void gs_capture_close(gs_capture_file_t *file)
+{
+    if (file == nullptr)
+    {
+        return;
+    }
+    munmap(file->map.header, file->map.size);
+    close(file->map.fd);
+    free(file);
+}
+
+const gs_capture_header_t *gs_capture_header(gs_capture_file_t *file)
+{
+    return file->map.header;
+}
+
+int gs_capture_next(gs_capture_file_t *file, uint32_t *index, gs_capture_entry_t *entry, uint8_t *buf, size_t size)
+{
+    // The file may still be growing; only slots that have been claimed and exist in the mapping are read.
+    uint32_t limit = __atomic_load_n(&file->map.header->count, __ATOMIC_ACQUIRE);
+    limit = limit < file->map.header->capacity ? limit : file->map.header->capacity;
+    limit = limit < file->slots ? limit : file->slots;
+
+    while (*index < limit)
+    {
+        const gs_capture_record_t *record = &file->map.records[*index];
+        uint8_t kind = __atomic_load_n(&record->kind, __ATOMIC_ACQUIRE);
+        if (kind == GS_CAPTURE_NONE || kind >= GS_CAPTURE_KIND_NUM)
+        {
+            // Claimed but never written (the writer stopped mid-frame), or a frame that did not fit.
+            (*index)++;
+            continue;
+        }
+
+        entry->ts_ns = record->ts_ns;
+        entry->kind = (gs_capture_kind_t)kind;
+        entry->rssi = record->rssi;
+        entry->result = record->result;
+        entry->len = 0;
+        while (true)
+        {
+            size_t chunk = record->len <= GS_CAPTURE_DATA ? record->len : GS_CAPTURE_DATA;
+            if (entry->len < size)
+            {
+                size_t copy = size - entry->len < chunk ? size - entry->len : chunk;
+                memcpy(buf + entry->len, record->data, copy);
+            }
+            entry->len += chunk;
+            (*index)++;
+            if (!(record->flags & GS_CAPTURE_MORE) || *index >= limit)
+            {
+                break;
+            }
+            record = &file->map.records[*index];
+            if (__atomic_load_n(&record->kind, __ATOMIC_ACQUIRE) != kind)
+            {
+                // Cut short.
+                break;
+            }
+        }
+        return 1;
+    }
+    return 0;
+}
+
+const char *gs_capture_kind_name(gs_capture_kind_t kind)
+{
+    switch (kind)
+    {
+    case GS_CAPTURE_UHF_RX:
+        return "uhf_rx";
+    case GS_CAPTURE_UHF_TX:
+        return "uhf_tx";
+    case GS_CAPTURE_NET_RX:
+        return "net_rx";
+    case GS_CAPTURE_NET_TX:
+        return "net_tx";
+    default:
+        return "?";
+    }
+}
@@ -0,0 +1,442 @@
+/**
+ * @file gs_crc.cpp
+ * @author agent (agent@local)
+ * @brief CRC-16/XMODEM implementations and runtime dispatch.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "gs_crc.hpp"
+#include "meb_debug.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <wmmintrin.h>
+#define GS_CRC_HAVE_CLMUL
+#define CLMUL_TARGET __attribute__((target("pclmul")))
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#define GS_CRC_HAVE_CLMUL
+#define CLMUL_TARGET __attribute__((target("+crypto")))
+#endif
+
+static uint16_t crc_table[8][256];
+
+// Folding constants, see crc16_clmul().
+static uint64_t k64;     // x^64 mod P
+static uint64_t k96;     // x^96 mod P
+static uint64_t k128;    // x^128 mod P
+static uint64_t k160;    // x^160 mod P
+static uint64_t k192;    // x^192 mod P
+static uint64_t k224;    // x^224 mod P
+static uint64_t k256;    // x^256 mod P
+static uint64_t k288;    // x^288 mod P
+static uint64_t mu_low;  // floor(x^80 / P) without its x^64 term
+
+static pthread_once_t crc_init_once = PTHREAD_ONCE_INIT;
+static gs_crc_impl_t crc_active = GS_CRC_TABLE;
+
+static inline uint64_t load_be64(const uint8_t *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return __builtin_bswap64(v);
+}
+
+/**
+ * @brief x^n mod P, by repeated shifting.
+ */
+static uint64_t xpow_mod(int n)
+{
+    uint32_t r = 1;
+    for (int i = 0; i < n; i++)
+    {
+        r <<= 1;
+        if (r & 0x10000)
+        {
+            r ^= 0x10000 | GS_CRC16_POLY;
+        }
+    }
+    return r;
+}
+
+static uint16_t crc16_bitwise(uint16_t crc, const uint8_t *buf, size_t len)
+{
+    while (len--)
+    {
+        crc ^= (uint16_t)(*buf++) << 8;
+        for (int i = 0; i < 8; i++)
+        {
+            crc = (crc & 0x8000) ? (crc << 1) ^ GS_CRC16_POLY : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+static uint16_t crc16_table(uint16_t crc, const uint8_t *buf, size_t len)
+{
+    while (len--)
+    {
+        crc = (crc << 8) ^ crc_table[0][(crc >> 8) ^ *buf++];
+    }
+    return crc;
+}
+
+static uint16_t crc16_slice8(uint16_t crc, const uint8_t *buf, size_t len)
+{
+    while (len >= 8)
+    {
+        crc = crc_table[7][buf[0] ^ (crc >> 8)] ^
+              crc_table[6][buf[1] ^ (crc & 0xff)] ^
+              crc_table[5][buf[2]] ^
+              crc_table[4][buf[3]] ^
+              crc_table[3][buf[4]] ^
+              crc_table[2][buf[5]] ^
+              crc_table[1][buf[6]] ^
+              crc_table[0][buf[7]];
+        buf += 8;
+        len -= 8;
+    }
+    return crc16_table(crc, buf, len);
+}
+
+#ifdef GS_CRC_HAVE_CLMUL
+
+#if defined(__x86_64__) || defined(__i386__)
+CLMUL_TARGET static inline void clmul64(uint64_t a, uint64_t b, uint64_t *lo, uint64_t *hi)
+{
+    __m128i r = _mm_clmulepi64_si128(_mm_cvtsi64_si128(a), _mm_cvtsi64_si128(b), 0x00);
+    *lo = (uint64_t)_mm_cvtsi128_si64(r);
+    *hi = (uint64_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(r, r));
+}
+#else
+CLMUL_TARGET static inline void clmul64(uint64_t a, uint64_t b, uint64_t *lo, uint64_t *hi)
+{
+    uint64x2_t r = vreinterpretq_u64_p128(vmull_p64((poly64_t)a, (poly64_t)b));
+    *lo = vgetq_lane_u64(r, 0);
+    *hi = vgetq_lane_u64(r, 1);
+}
+#endif
+
+CLMUL_TARGET static inline uint64_t clmul64_lo(uint64_t a, uint64_t b)
+{
+    uint64_t lo, hi;
+    clmul64(a, b, &lo, &hi);
+    return lo;
+}
+
+/**
+ * @brief A * x^(n + 64) mod-P-folded back into 64 bits, given khi = x^(n + 32) mod P and klo = x^n mod P.
+ */
+CLMUL_TARGET static inline uint64_t clmul_shift(uint64_t acc, uint64_t khi, uint64_t klo)
+{
+    return clmul64_lo(acc >> 32, khi) ^ clmul64_lo(acc & 0xffffffff, klo);
+}
+
+/**
+ * @brief Folds the next 8 bytes into the accumulator.
+ * 
+ * The accumulator A satisfies (A * x^16) mod P == CRC of the bytes so far. Appending a 64-bit chunk D gives
+ * A' = A * x^64 + D, and A * x^64 == A_hi * (x^96 mod P) + A_lo * (x^64 mod P), which fits back in 64 bits.
+ * The two multiplies are independent, so they overlap in the pipeline.
+ */
+CLMUL_TARGET static inline uint64_t clmul_fold(uint64_t acc, uint64_t chunk)
+{
+    return clmul_shift(acc, k96, k64) ^ chunk;
+}
+
+/**
+ * @brief Barrett reduction: returns (A * x^16) mod P.
+ */
+CLMUL_TARGET static inline uint16_t clmul_reduce(uint64_t acc)
+{
+    uint64_t lo, hi;
+    clmul64(acc, mu_low, &lo, &hi);
+    uint64_t q = acc ^ hi;
+    return (uint16_t)clmul64_lo(q, GS_CRC16_POLY);
+}
+
+CLMUL_TARGET static uint16_t crc16_clmul(uint16_t crc, const uint8_t *buf, size_t len)
+{
+    if (len < 16)
+    {
+        return crc16_slice8(crc, buf, len);
+    }
+
+    uint64_t acc = load_be64(buf) ^ ((uint64_t)crc << 48);
+    buf += 8;
+    len -= 8;
+
+    if (len >= 56)
+    {
+        // Four independent lanes over interleaved chunks, each advanced by x^256 per step, then merged.
+        uint64_t a1 = load_be64(buf);
+        uint64_t a2 = load_be64(buf + 8);
+        uint64_t a3 = load_be64(buf + 16);
+        buf += 24;
+        len -= 24;
+        while (len >= 32)
+        {
+            acc = clmul_shift(acc, k288, k256) ^ load_be64(buf);
+            a1 = clmul_shift(a1, k288, k256) ^ load_be64(buf + 8);
+            a2 = clmul_shift(a2, k288, k256) ^ load_be64(buf + 16);
+            a3 = clmul_shift(a3, k288, k256) ^ load_be64(buf + 24);
+            buf += 32;
+            len -= 32;
+        }
+        acc = clmul_shift(acc, k224, k192) ^ clmul_shift(a1, k160, k128) ^ clmul_shift(a2, k96, k64) ^ a3;
+    }
+
+    while (len >= 8)
+    {
+        acc = clmul_fold(acc, load_be64(buf));
+        buf += 8;
+        len -= 8;
+    }
+    return crc16_table(clmul_reduce(acc), buf, len);
+}
+
+/**
+ * @brief Four buffers in lock-step, so the four fold chains hide each other's multiply latency.
+ */
+CLMUL_TARGET static void crc16_clmul_x4(const uint8_t *buf, size_t stride, size_t len, uint16_t *crcs)
+{
+    const uint8_t *b0 = buf;
+    const uint8_t *b1 = buf + stride;
+    const uint8_t *b2 = buf + 2 * stride;
+    const uint8_t *b3 = buf + 3 * stride;
+
+    uint64_t a0 = load_be64(b0);
+    uint64_t a1 = load_be64(b1);
+    uint64_t a2 = load_be64(b2);
+    uint64_t a3 = load_be64(b3);
+    size_t off = 8;
+    for (; off + 8 <= len; off += 8)
+    {
+        a0 = clmul_fold(a0, load_be64(b0 + off));
+        a1 = clmul_fold(a1, load_be64(b1 + off));
+        a2 = clmul_fold(a2, load_be64(b2 + off));
+        a3 = clmul_fold(a3, load_be64(b3 + off));
+    }
+
+    crcs[0] = crc16_table(clmul_reduce(a0), b0 + off, len - off);
+    crcs[1] = crc16_table(clmul_reduce(a1), b1 + off, len - off);
+    crcs[2] = crc16_table(clmul_reduce(a2), b2 + off, len - off);
+    crcs[3] = crc16_table(clmul_reduce(a3), b3 + off, len - off);
+}
+
+#endif // GS_CRC_HAVE_CLMUL
+
+static bool clmul_supported(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("pclmul");
+#elif defined(__aarch64__)
+    return (getauxval(AT_HWCAP) & HWCAP_PMULL) != 0;
+#else
+    return false;
+#endif
+}
+
+static uint16_t crc16_dispatch(gs_crc_impl_t impl, uint16_t crc, const uint8_t *buf, size_t len)
+{
+    switch (impl)
+    {
+    case GS_CRC_BITWISE:
+        return crc16_bitwise(crc, buf, len);
+    case GS_CRC_SLICE8:
+        return crc16_slice8(crc, buf, len);
+#ifdef GS_CRC_HAVE_CLMUL
+    case GS_CRC_CLMUL:
+        return crc16_clmul(crc, buf, len);
+#endif
+    case GS_CRC_TABLE:
+    default:
+        return crc16_table(crc, buf, len);
+    }
+}
+
+/**
+ * @brief Checks an implementation against the bitwise reference over every length up to a few folds.
+ */
+static bool crc16_selftest(gs_crc_impl_t impl)
+{
+    uint8_t buf[67];
+    for (size_t i = 0; i < sizeof(buf); i++)
+    {
+        buf[i] = (uint8_t)(i * 167 + 13);
+    }
+
+    for (size_t len = 0; len <= sizeof(buf); len++)
+    {
+        if (crc16_dispatch(impl, 0, buf, len) != crc16_bitwise(0, buf, len))
+        {
+            return false;
+        }
+    }
+    // CRC-16/XMODEM check value.
+    return crc16_dispatch(impl, 0, (const uint8_t *)"123456789", 9) == 0x31c3;
+}
+
+static void crc16_init(void)
+{
+    for (int v = 0; v < 256; v++)
+    {
+        uint8_t byte = v;
+        crc_table[0][v] = crc16_bitwise(0, &byte, 1);
+    }
+    for (int k = 1; k < 8; k++)
+    {
+        for (int v = 0; v < 256; v++)
+        {
+            uint16_t prev = crc_table[k - 1][v];
+            crc_table[k][v] = (prev << 8) ^ crc_table[0][prev >> 8];
+        }
+    }
+
+    k64 = xpow_mod(64);
+    k96 = xpow_mod(96);
+    k128 = xpow_mod(128);
+    k160 = xpow_mod(160);
+    k192 = xpow_mod(192);
+    k224 = xpow_mod(224);
+    k256 = xpow_mod(256);
+    k288 = xpow_mod(288);
+
+    // floor(x^80 / P) by long division. The register holds dividend bits [i, i + 16]; whenever its
+    // x^16 term is set the quotient gets x^i. The x^64 term is always set and is applied implicitly.
+    uint64_t quotient = 0;
+    uint32_t rem = 0;
+    for (int i = 80; i >= 0; i--)
+    {
+        rem = (rem << 1) | (i == 80 ? 1 : 0);
+        if (rem & 0x10000)
+        {
+            rem ^= 0x10000 | GS_CRC16_POLY;
+            if (i < 64)
+            {
+                quotient |= 1ULL << i;
+            }
+        }
+    }
+    mu_low = quotient;
+
+    crc_active = GS_CRC_SLICE8;
+    if (clmul_supported())
+    {
+        if (crc16_selftest(GS_CRC_CLMUL))
+        {
+            crc_active = GS_CRC_CLMUL;
+        }
+        else
+        {
+            dbprintlf(RED_FG "Carry-less multiply CRC failed its self-test, using slice-by-8.");
+        }
+    }
+}
+
+uint16_t gs_crc16(const void *buf, size_t len)
+{
+    pthread_once(&crc_init_once, crc16_init);
+    return crc16_dispatch(crc_active, 0, (const uint8_t *)buf, len);
+}
+
+uint16_t gs_crc16_impl(gs_crc_impl_t impl, const void *buf, size_t len)
+{
+    pthread_once(&crc_init_once, crc16_init);
+    if (!gs_crc16_supported(impl))
+    {
+        impl = GS_CRC_TABLE;
+    }
+    return crc16_dispatch(impl, 0, (const uint8_t *)buf, len);
+}
+
+void gs_crc16_batch(const void *first, size_t stride, size_t len, size_t count, uint16_t *crcs)
+{
+    pthread_once(&crc_init_once, crc16_init);
+    const uint8_t *buf = (const uint8_t *)first;
+    size_t i = 0;
+
+#ifdef GS_CRC_HAVE_CLMUL
+    if (crc_active == GS_CRC_CLMUL && len >= 16)
+    {
+        for (; i + 4 <= count; i += 4)
+        {
+            crc16_clmul_x4(buf + i * stride, stride, len, crcs + i);
+        }
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        crcs[i] = crc16_dispatch(crc_active, 0, buf + i * stride, len);
+    }
+}
+
+int gs_crc16_select(gs_crc_impl_t impl)
+{
+    pthread_once(&crc_init_once, crc16_init);
+    if (impl == GS_CRC_AUTO)
+    {
+        crc_active = clmul_supported() && crc16_selftest(GS_CRC_CLMUL) ? GS_CRC_CLMUL : GS_CRC_SLICE8;
+        return 1;
+    }
+    if (!gs_crc16_supported(impl))
+    {
+        return 0;
+    }
+    crc_active = impl;
+    return 1;
+}
+
+gs_crc_impl_t gs_crc16_active(void)
+{
+    pthread_once(&crc_init_once, crc16_init);
+    return crc_active;
+}
+
+bool gs_crc16_supported(gs_crc_impl_t impl)
+{
+    switch (impl)
+    {
+    case GS_CRC_BITWISE:
+    case GS_CRC_TABLE:
+    case GS_CRC_SLICE8:
+        return true;
+    case GS_CRC_CLMUL:
+#ifdef GS_CRC_HAVE_CLMUL
+        return clmul_supported();
+#else
+        return false;
+#endif
+    default:
+        return false;
+    }
+}
+
+const char *gs_crc16_name(gs_crc_impl_t impl)
+{
+    switch (impl)
+    {
+    case GS_CRC_AUTO:
+        return "auto";
+    case GS_CRC_BITWISE:
+        return "bitwise";
+    case GS_CRC_TABLE:
+        return "table";
+    case GS_CRC_SLICE8:
+        return "slice8";
+    case GS_CRC_CLMUL:
+        return "clmul";
+    default:
+        return "unknown";
+    }
+}
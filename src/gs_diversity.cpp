@@ -0,0 +1,201 @@
+/**
+ * @file gs_diversity.cpp
+ * @author agent (agent@local)
+ * @brief Receive diversity across several radios: drops the copies of a frame heard on more than one, and picks the uplink radio.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdlib.h>
+#include "gs_diversity.hpp"
+#include "gs_time.hpp"
+#include "meb_debug.hpp"
+
+#define DIV_FNV_OFFSET 0xcbf29ce484222325ULL
+#define DIV_FNV_PRIME 0x100000001b3ULL
+
+/**
+ * @brief FNV-1a over the GUID and payload, the part of a frame its CRCs cover.
+ */
+static uint64_t div_hash(const gst_frame_t *frame)
+{
+    uint64_t hash = DIV_FNV_OFFSET;
+    hash = (hash ^ (frame->guid & 0xff)) * DIV_FNV_PRIME;
+    hash = (hash ^ (frame->guid >> 8)) * DIV_FNV_PRIME;
+    for (int i = 0; i < GST_MAX_PAYLOAD_SIZE; i++)
+    {
+        hash = (hash ^ frame->payload[i]) * DIV_FNV_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * @brief Credits a frame whose window has passed: to the radio that heard it loudest, and to the only one
+ * that heard it at all.
+ */
+static void div_settle(gs_diversity_t *div, const gs_div_entry_t *entry)
+{
+    gs_div_radio_stats_t *stats = &div->radios[entry->best];
+    stats->best++;
+    if ((entry->radios & (entry->radios - 1)) == 0)
+    {
+        stats->only++;
+    }
+}
+
+gs_diversity_t *gs_div_create(int num_radios, uint32_t window_ms, uint32_t stale_ms)
+{
+    if (num_radios < 1 || num_radios > UHF_MAX_RADIOS)
+    {
+        dbprintlf(RED_FG "Diversity across %d radios is not supported.", num_radios);
+        return nullptr;
+    }
+
+    gs_diversity_t *div = (gs_diversity_t *)calloc(1, sizeof(gs_diversity_t));
+    if (div == nullptr)
+    {
+        dbprintlf(FATAL "Failed to allocate the diversity combiner.");
+        return nullptr;
+    }
+    div->num_radios = num_radios;
+    div->window_ns = window_ms * NSEC_PER_MSEC;
+    div->stale_ns = stale_ms * NSEC_PER_MSEC;
+    return div;
+}
+
+void gs_div_destroy(gs_diversity_t *div)
+{
+    free(div);
+}
+
+int gs_div_offer(gs_diversity_t *div, int radio, const gst_frame_t *frame, int16_t rssi, uint64_t rx_ns)
+{
+    gs_div_radio_stats_t *stats = &div->radios[radio];
+    stats->frames++;
+
+    // The average is what the TX thread chooses on; the first frame seeds it.
+    int32_t avg = __atomic_load_n(&div->rssi_avg[radio], __ATOMIC_RELAXED);
+    avg = stats->last_ns == 0 ? rssi * 16 : avg + ((rssi * 16 - avg) >> GS_DIV_RSSI_SHIFT);
+    __atomic_store_n(&div->rssi_avg[radio], avg, __ATOMIC_RELAXED);
+    __atomic_store_n(&stats->last_ns, rx_ns, __ATOMIC_RELAXED);
+
+    // Newest first. Entries from after rx_ns are passed over, copies can be offered out of order; an entry
+    // a whole window before it ends the search, the rest are older still.
+    uint64_t hash = div_hash(frame);
+    for (uint32_t n = 0; n < div->count; n++)
+    {
+        gs_div_entry_t *entry = &div->history[(div->next - 1 - n) % GS_DIV_HISTORY];
+        if (entry->rx_ns + div->window_ns < rx_ns)
+        {
+            break;
+        }
+        if (entry->hash != hash || rx_ns + div->window_ns < entry->rx_ns)
+        {
+            continue;
+        }
+        entry->radios |= 1 << radio;
+        if (rssi > entry->best_rssi)
+        {
+            entry->best_rssi = rssi;
+            entry->best = radio;
+        }
+        stats->duplicates++;
+        return 0;
+    }
+
+    // A new frame takes the oldest entry. Frames whose window has passed are settled first, and so is the
+    // one about to be overwritten.
+    while (div->unsettled > 0)
+    {
+        gs_div_entry_t *oldest = &div->history[(div->next - div->unsettled) % GS_DIV_HISTORY];
+        if (div->unsettled < GS_DIV_HISTORY && oldest->rx_ns + div->window_ns >= rx_ns)
+        {
+            break;
+        }
+        div_settle(div, oldest);
+        div->unsettled--;
+    }
+    gs_div_entry_t *entry = &div->history[div->next];
+    entry->hash = hash;
+    entry->rx_ns = rx_ns;
+    entry->radios = 1 << radio;
+    entry->best_rssi = rssi;
+    entry->best = radio;
+    div->next = (div->next + 1) % GS_DIV_HISTORY;
+    div->unsettled++;
+    if (div->count < GS_DIV_HISTORY)
+    {
+        div->count++;
+    }
+    stats->first++;
+    return 1;
+}
+
+int gs_div_uplink(gs_diversity_t *div, uint32_t ready, uint64_t now_ns)
+{
+    int current = div->uplink;
+    int loudest = -1;
+    int32_t loudest_avg = 0, current_avg = 0;
+    bool current_heard = false;
+
+    for (int i = 0; i < div->num_radios; i++)
+    {
+        uint64_t last_ns = __atomic_load_n(&div->radios[i].last_ns, __ATOMIC_RELAXED);
+        if (!(ready & (1 << i)) || last_ns == 0 || now_ns - last_ns > div->stale_ns)
+        {
+            continue;
+        }
+        int32_t avg = __atomic_load_n(&div->rssi_avg[i], __ATOMIC_RELAXED);
+        if (loudest < 0 || avg > loudest_avg)
+        {
+            loudest = i;
+            loudest_avg = avg;
+        }
+        if (i == current)
+        {
+            current_heard = true;
+            current_avg = avg;
+        }
+    }
+
+    if (loudest >= 0 && (!current_heard || loudest_avg - current_avg >= GS_DIV_HYSTERESIS_DB * 16))
+    {
+        current = loudest;
+    }
+    else if (loudest < 0 && !(ready & (1 << current)))
+    {
+        // Nothing heard lately to choose on: any radio that is up.
+        current = -1;
+        for (int i = 0; i < div->num_radios && current < 0; i++)
+        {
+            current = ready & (1 << i) ? i : -1;
+        }
+        if (current < 0)
+        {
+            return -1;
+        }
+    }
+    div->uplink = current;
+    return current;
+}
+
+void gs_div_get_stats(gs_diversity_t *div, int radio, gs_div_radio_stats_t *stats)
+{
+    *stats = div->radios[radio];
+    stats->rssi = __atomic_load_n(&div->rssi_avg[radio], __ATOMIC_RELAXED) / 16;
+}
+
+void gs_div_print_stats(gs_diversity_t *div)
+{
+    for (int i = 0; i < div->num_radios; i++)
+    {
+        gs_div_radio_stats_t stats[1];
+        gs_div_get_stats(div, i, stats);
+        dbprintlf(CYAN_FG "Radio %d: %llu frames, %llu first, %llu duplicates, %llu loudest, %llu heard only here, average RSSI %d dBm.",
+                  i, (unsigned long long)stats->frames, (unsigned long long)stats->first, (unsigned long long)stats->duplicates,
+                  (unsigned long long)stats->best, (unsigned long long)stats->only, stats->rssi);
+    }
+}
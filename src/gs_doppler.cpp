@@ -0,0 +1,182 @@
+/**
+ * @file gs_doppler.cpp
+ * @author agent (agent@local)
+ * @brief Doppler pre-compensation: a per-pass table of frequency offsets, and the retunes that follow it.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "gs_doppler.hpp"
+#include "gs_radio.hpp"
+#include "gs_time.hpp"
+#include "meb_debug.hpp"
+
+#define DOPPLER_CAPACITY (GS_DOPPLER_MAX_S * 1000 / GS_DOPPLER_STEP_MS + 1)
+
+gs_doppler_t *gs_doppler_create(double downlink_hz, double uplink_hz, int32_t tol_hz)
+{
+    gs_doppler_t *dop = (gs_doppler_t *)calloc(1, sizeof(gs_doppler_t));
+    if (dop == nullptr)
+    {
+        dbprintlf(FATAL "Failed to allocate the Doppler table.");
+        return nullptr;
+    }
+    // Allocated once, a pass only fills them in.
+    dop->rx_hz = (int32_t *)calloc(DOPPLER_CAPACITY, sizeof(int32_t));
+    dop->tx_hz = (int32_t *)calloc(DOPPLER_CAPACITY, sizeof(int32_t));
+    if (dop->rx_hz == nullptr || dop->tx_hz == nullptr)
+    {
+        dbprintlf(FATAL "Failed to allocate the Doppler table.");
+        gs_doppler_destroy(dop);
+        return nullptr;
+    }
+    dop->downlink_hz = downlink_hz;
+    dop->uplink_hz = uplink_hz;
+    dop->tol_hz = tol_hz;
+    return dop;
+}
+
+void gs_doppler_destroy(gs_doppler_t *dop)
+{
+    if (dop == nullptr)
+    {
+        return;
+    }
+    free(dop->rx_hz);
+    free(dop->tx_hz);
+    free(dop);
+}
+
+void gs_doppler_offsets(const gs_doppler_t *dop, double range_rate, int32_t *rx_hz, int32_t *tx_hz)
+{
+    // The spacecraft is the moving source on the downlink and the moving receiver on the uplink.
+    *rx_hz = (int32_t)lround(dop->downlink_hz * (GS_DOPPLER_C_KM_S / (GS_DOPPLER_C_KM_S + range_rate) - 1));
+    *tx_hz = (int32_t)lround(dop->uplink_hz * (GS_DOPPLER_C_KM_S / (GS_DOPPLER_C_KM_S - range_rate) - 1));
+}
+
+int gs_doppler_build(gs_doppler_t *dop, const gs_sgp4_t *sat, const gs_station_t *station, double from, double to)
+{
+    uint64_t start_ns = gs_time_ns();
+    dop->start = 0;
+    dop->count = 0;
+    double step = GS_DOPPLER_STEP_MS / 1e3;
+    int count = to > from ? (int)((to - from) / step) + 1 : 1;
+    count = count < DOPPLER_CAPACITY ? count : DOPPLER_CAPACITY;
+    for (int i = 0; i < count; i++)
+    {
+        gs_look_t look;
+        if (!gs_sgp4_look(sat, station, from + i * step, &look))
+        {
+            dbprintlf(RED_FG "Cannot propagate the spacecraft to %.0f s into the Doppler table.", i * step);
+            return 0;
+        }
+        gs_doppler_offsets(dop, look.range_rate, &dop->rx_hz[i], &dop->tx_hz[i]);
+    }
+    dop->start = from;
+    dop->count = count;
+    dop->stats.tables++;
+    dop->stats.build_ns += gs_time_ns() - start_ns;
+    return count;
+}
+
+/**
+ * @brief The entry in effect at t, the first one before the table starts; count past its end.
+ */
+static int doppler_index(const gs_doppler_t *dop, double t)
+{
+    if (t <= dop->start)
+    {
+        return 0;
+    }
+    // Nudged up so a time gs_doppler_due() returned lands on its own entry.
+    double i = floor((t - dop->start) * 1e3 / GS_DOPPLER_STEP_MS + 1e-6);
+    return i < dop->count ? (int)i : dop->count;
+}
+
+static inline bool doppler_drifted(const gs_doppler_t *dop, int i, int32_t rx_hz, int32_t tx_hz)
+{
+    return abs(dop->rx_hz[i] - rx_hz) > dop->tol_hz || abs(dop->tx_hz[i] - tx_hz) > dop->tol_hz;
+}
+
+bool gs_doppler_lookup(const gs_doppler_t *dop, double t, int32_t *rx_hz, int32_t *tx_hz)
+{
+    int i = doppler_index(dop, t);
+    if (i >= dop->count)
+    {
+        return false;
+    }
+    *rx_hz = dop->rx_hz[i];
+    *tx_hz = dop->tx_hz[i];
+    return true;
+}
+
+double gs_doppler_due(const gs_doppler_t *dop, double t, int32_t rx_hz, int32_t tx_hz)
+{
+    for (int i = doppler_index(dop, t); i < dop->count; i++)
+    {
+        if (doppler_drifted(dop, i, rx_hz, tx_hz))
+        {
+            double due = dop->start + i * (GS_DOPPLER_STEP_MS / 1e3);
+            return due > t ? due : t;
+        }
+    }
+    return 0;
+}
+
+int gs_doppler_apply(gs_doppler_t *dop, gs_radio_t *radio, double t, double *next)
+{
+    *next = 0;
+    int32_t rx_hz, tx_hz;
+    int32_t rx_was = radio->rx_offset_hz, tx_was = radio->tx_offset_hz;
+    if (!gs_doppler_lookup(dop, t, &rx_hz, &tx_hz))
+    {
+        return 0;
+    }
+    double due = gs_doppler_due(dop, t, rx_was, tx_was);
+    if (due == 0 || due > t)
+    {
+        *next = due;
+        return 0;
+    }
+
+    int retval = gs_radio_try_tune(radio, rx_hz, tx_hz);
+    if (retval < 0)
+    {
+        dop->stats.deferred++;
+        *next = t + GS_DOPPLER_RETRY_MS / 1e3;
+        return -1;
+    }
+    else if (retval == 0)
+    {
+        return -2;
+    }
+
+    // Late by how long the old pair has been out of tolerance, within the table.
+    int i = doppler_index(dop, t);
+    while (i > 0 && doppler_drifted(dop, i - 1, rx_was, tx_was))
+    {
+        i--;
+    }
+    double late = t - (dop->start + i * (GS_DOPPLER_STEP_MS / 1e3));
+    uint64_t late_ns = late > 0 ? (uint64_t)(late * 1e9) : 0;
+    dop->stats.retunes++;
+    dop->stats.late_sum_ns += late_ns;
+    dop->stats.late_max_ns = late_ns > dop->stats.late_max_ns ? late_ns : dop->stats.late_max_ns;
+    *next = gs_doppler_due(dop, t, rx_hz, tx_hz);
+    return 1;
+}
+
+void gs_doppler_print(const gs_doppler_t *dop)
+{
+    const gs_doppler_stats_t *stats = &dop->stats;
+    dbprintlf(CYAN_FG "Doppler: %llu tables (%.1f ms each), %llu retunes (tolerance %d Hz), %llu put off, late by %.1f ms on average, %.1f ms at most.",
+              (unsigned long long)stats->tables, stats->tables ? stats->build_ns / 1e6 / stats->tables : 0.0, (unsigned long long)stats->retunes,
+              dop->tol_hz, (unsigned long long)stats->deferred, stats->retunes ? stats->late_sum_ns / 1e6 / stats->retunes : 0.0, stats->late_max_ns / 1e6);
+}
@@ -0,0 +1,291 @@
+/**
+ * @file gs_fec.cpp
+ * @author agent (agent@local)
+ * @brief Reed-Solomon forward error correction for GST frames.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <string.h>
+#include <strings.h>
+#include <pthread.h>
+#include "gs_fec.hpp"
+
+#define GF_POLY 0x11d
+#define GF_SIZE 255
+
+static uint8_t gf_exp[2 * GF_SIZE]; // Doubled so a sum of two logs needs no modulo.
+static uint8_t gf_log[GF_SIZE + 1];
+static uint8_t gen[GS_FEC_PARITY + 1]; // Generator polynomial, gen[k] is the coefficient of x^k.
+
+// Row fb is fb * gen[15 - k] for k = 0..15, packed like the parity register: byte k in bits 8 * (k % 8) of
+// word k / 8. Packing by shifts rather than memcpy keeps the register the same on either endianness.
+static uint64_t enc_row[256][2];
+
+static pthread_once_t fec_init_once = PTHREAD_ONCE_INIT;
+
+static inline uint8_t gf_mul(uint8_t a, uint8_t b)
+{
+    return (a == 0 || b == 0) ? 0 : gf_exp[gf_log[a] + gf_log[b]];
+}
+
+static inline uint8_t gf_div(uint8_t a, uint8_t b)
+{
+    // b is never 0 here.
+    return a == 0 ? 0 : gf_exp[gf_log[a] + GF_SIZE - gf_log[b]];
+}
+
+/**
+ * @brief a * alpha^power, power in [0, GF_SIZE).
+ */
+static inline uint8_t gf_mul_exp(uint8_t a, int power)
+{
+    return a == 0 ? 0 : gf_exp[gf_log[a] + power];
+}
+
+static void fec_init(void)
+{
+    int x = 1;
+    for (int i = 0; i < GF_SIZE; i++)
+    {
+        gf_exp[i] = x;
+        gf_exp[i + GF_SIZE] = x;
+        gf_log[x] = i;
+        x <<= 1;
+        if (x & 0x100)
+        {
+            x ^= GF_POLY;
+        }
+    }
+    gf_log[0] = 0; // Never used, gf_mul() and friends check for zero.
+
+    // gen(x) = (x + alpha^0)(x + alpha^1)...(x + alpha^15)
+    memset(gen, 0x0, sizeof(gen));
+    gen[0] = 1;
+    for (int i = 0; i < GS_FEC_PARITY; i++)
+    {
+        for (int k = i + 1; k > 0; k--)
+        {
+            gen[k] = gen[k - 1] ^ gf_mul(gen[k], gf_exp[i]);
+        }
+        gen[0] = gf_mul(gen[0], gf_exp[i]);
+    }
+
+    for (int fb = 0; fb < 256; fb++)
+    {
+        enc_row[fb][0] = enc_row[fb][1] = 0;
+        for (int k = 0; k < GS_FEC_PARITY; k++)
+        {
+            enc_row[fb][k / 8] |= (uint64_t)gf_mul(fb, gen[GS_FEC_PARITY - 1 - k]) << (8 * (k % 8));
+        }
+    }
+}
+
+/**
+ * @brief Runs the parity register over data and returns it packed, see enc_row.
+ */
+static inline void fec_remainder(const uint8_t *data, size_t len, uint64_t *lo, uint64_t *hi)
+{
+    uint64_t r0 = 0, r1 = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        const uint64_t *row = enc_row[data[i] ^ (uint8_t)r0];
+        r0 = ((r0 >> 8) | (r1 << 56)) ^ row[0];
+        r1 = (r1 >> 8) ^ row[1];
+    }
+    *lo = r0;
+    *hi = r1;
+}
+
+void gs_fec_encode(const void *data, size_t len, uint8_t *parity)
+{
+    pthread_once(&fec_init_once, fec_init);
+
+    uint64_t r[2];
+    fec_remainder((const uint8_t *)data, len, &r[0], &r[1]);
+    for (int k = 0; k < GS_FEC_PARITY; k++)
+    {
+        parity[k] = r[k / 8] >> (8 * (k % 8));
+    }
+}
+
+int gs_fec_decode(uint8_t *block, size_t len)
+{
+    pthread_once(&fec_init_once, fec_init);
+
+    if (len <= GS_FEC_PARITY || len > GS_FEC_MAX_BLOCK)
+    {
+        return -1;
+    }
+    size_t data_len = len - GS_FEC_PARITY;
+
+    // The received word's remainder mod gen(x) is the re-encoded parity XOR the received parity; zero means
+    // a codeword, which is every clean frame.
+    uint64_t r[2];
+    fec_remainder(block, data_len, &r[0], &r[1]);
+    uint8_t rem[GS_FEC_PARITY];
+    int dirty = 0;
+    for (int k = 0; k < GS_FEC_PARITY; k++)
+    {
+        rem[k] = (uint8_t)(r[k / 8] >> (8 * (k % 8))) ^ block[data_len + k];
+        dirty |= rem[k];
+    }
+    if (!dirty)
+    {
+        return 0;
+    }
+
+    // gen(alpha^i) = 0, so the syndromes of the received word are those of its remainder. rem[k] is the
+    // coefficient of x^(15 - k).
+    uint8_t synd[GS_FEC_PARITY];
+    for (int i = 0; i < GS_FEC_PARITY; i++)
+    {
+        uint8_t s = 0;
+        for (int k = 0; k < GS_FEC_PARITY; k++)
+        {
+            s = gf_mul_exp(s, i) ^ rem[k];
+        }
+        synd[i] = s;
+    }
+
+    // Berlekamp-Massey: the shortest LFSR lambda(x) generating the syndromes is the error locator.
+    uint8_t lambda[GS_FEC_PARITY + 1] = {1};
+    uint8_t prev[GS_FEC_PARITY + 1] = {1};
+    int errors = 0;
+    int shift = 1;
+    uint8_t prev_d = 1;
+    for (int n = 0; n < GS_FEC_PARITY; n++)
+    {
+        uint8_t d = synd[n];
+        for (int i = 1; i <= errors; i++)
+        {
+            d ^= gf_mul(lambda[i], synd[n - i]);
+        }
+
+        if (d == 0)
+        {
+            shift++;
+            continue;
+        }
+
+        uint8_t scale = gf_div(d, prev_d);
+        if (2 * errors <= n)
+        {
+            uint8_t saved[GS_FEC_PARITY + 1];
+            memcpy(saved, lambda, sizeof(lambda));
+            for (int i = 0; i + shift <= GS_FEC_PARITY; i++)
+            {
+                lambda[i + shift] ^= gf_mul(scale, prev[i]);
+            }
+            errors = n + 1 - errors;
+            memcpy(prev, saved, sizeof(prev));
+            prev_d = d;
+            shift = 1;
+        }
+        else
+        {
+            for (int i = 0; i + shift <= GS_FEC_PARITY; i++)
+            {
+                lambda[i + shift] ^= gf_mul(scale, prev[i]);
+            }
+            shift++;
+        }
+    }
+    if (errors > GS_FEC_T)
+    {
+        return -1;
+    }
+
+    // omega(x) = synd(x) * lambda(x) mod x^16, the error evaluator.
+    uint8_t omega[GS_FEC_PARITY] = {0};
+    for (int i = 0; i < GS_FEC_PARITY; i++)
+    {
+        for (int j = 0; j <= errors && j <= i; j++)
+        {
+            omega[i] ^= gf_mul(synd[i - j], lambda[j]);
+        }
+    }
+
+    // Chien search over the positions that exist in the shortened block: byte j is the coefficient of
+    // x^(len - 1 - j), and it is in error if lambda(alpha^-(len - 1 - j)) = 0. Forney gives the value.
+    int positions[GS_FEC_T];
+    uint8_t values[GS_FEC_T];
+    int found = 0;
+    for (size_t j = 0; j < len; j++)
+    {
+        int power = (int)(len - 1 - j);
+        int inv = (GF_SIZE - power) % GF_SIZE; // X^-1 = alpha^inv
+
+        uint8_t eval = 0;
+        uint8_t deriv = 0;
+        for (int i = 0; i <= errors; i++)
+        {
+            uint8_t term = gf_mul_exp(lambda[i], (i * inv) % GF_SIZE);
+            eval ^= term;
+            if (i & 0x1)
+            {
+                // lambda'(x) keeps the odd terms, one power lower.
+                deriv ^= gf_mul_exp(lambda[i], ((i - 1) * inv) % GF_SIZE);
+            }
+        }
+        if (eval != 0)
+        {
+            continue;
+        }
+        if (found == errors || deriv == 0)
+        {
+            return -1;
+        }
+
+        uint8_t num = 0;
+        for (int i = 0; i < GS_FEC_PARITY; i++)
+        {
+            num ^= gf_mul_exp(omega[i], (i * inv) % GF_SIZE);
+        }
+        // e = X * omega(X^-1) / lambda'(X^-1)
+        positions[found] = j;
+        values[found] = gf_mul_exp(gf_div(num, deriv), power);
+        found++;
+    }
+
+    // Fewer roots than the locator's degree means some errors sit in the bytes shortening removed.
+    if (found != errors)
+    {
+        return -1;
+    }
+    for (int i = 0; i < found; i++)
+    {
+        block[positions[i]] ^= values[i];
+    }
+    return found;
+}
+
+int gs_fec_mode_parse(const char *str, gs_fec_mode_t *mode)
+{
+    for (int m = GS_FEC_OFF; m <= GS_FEC_AUTO; m++)
+    {
+        if (strcasecmp(str, gs_fec_mode_name((gs_fec_mode_t)m)) == 0)
+        {
+            *mode = (gs_fec_mode_t)m;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+const char *gs_fec_mode_name(gs_fec_mode_t mode)
+{
+    switch (mode)
+    {
+    case GS_FEC_OFF:
+        return "off";
+    case GS_FEC_ON:
+        return "on";
+    case GS_FEC_AUTO:
+        return "auto";
+    }
+    return "?";
+}
@@ -0,0 +1,156 @@
+/**
+ * @file gs_health.cpp
+ * @author agent (agent@local)
+ * @brief Radio health monitor: the part info is probed in the background and published for the hot paths to read.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <string.h>
+#include "gs_health.hpp"
+#include "gs_radio.hpp"
+#include "gs_metrics.hpp"
+#include "gs_time.hpp"
+#include "meb_debug.hpp"
+
+#define HEALTH_SET(health, field, value) __atomic_store_n(&(health)->snap.field, (value), __ATOMIC_RELAXED)
+
+/**
+ * @brief Takes the snapshot for writing: makes seq odd, once no other writer has it odd.
+ */
+static void health_lock(gs_health_t *health)
+{
+    uint32_t seq;
+    do
+    {
+        seq = __atomic_load_n(&health->seq, __ATOMIC_RELAXED) & ~1u;
+    } while (!__atomic_compare_exchange_n(&health->seq, &seq, seq + 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Publishes the snapshot written since health_lock(), and ready with it.
+ */
+static void health_unlock(gs_health_t *health, bool ready)
+{
+    HEALTH_SET(health, ready, ready);
+    __atomic_store_n(&health->seq, health->seq + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&health->ready, ready, __ATOMIC_RELEASE);
+}
+
+void gs_health_get(const gs_health_t *health, gs_health_snapshot_t *snap)
+{
+    uint32_t before, after;
+    do
+    {
+        before = __atomic_load_n(&health->seq, __ATOMIC_ACQUIRE);
+        snap->ready = __atomic_load_n(&health->snap.ready, __ATOMIC_RELAXED);
+        snap->probe_ns = __atomic_load_n(&health->snap.probe_ns, __ATOMIC_RELAXED);
+        snap->probes = __atomic_load_n(&health->snap.probes, __ATOMIC_RELAXED);
+        snap->failures = __atomic_load_n(&health->snap.failures, __ATOMIC_RELAXED);
+        snap->reinits = __atomic_load_n(&health->snap.reinits, __ATOMIC_RELAXED);
+        snap->part = __atomic_load_n(&health->snap.part, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&health->seq, __ATOMIC_RELAXED);
+    } while ((before & 1) || before != after);
+}
+
+bool gs_health_matches(const gs_health_t *health, const gs_radio_info_t *info)
+{
+    return RADIO_PART_VALID(info->part) && info->part == health->part && info->id == health->id &&
+           info->chip_rev == health->chip_rev && info->rom_id == health->rom_id;
+}
+
+int gs_health_probe(gs_radio_t *radio)
+{
+    gs_health_t *health = &radio->health;
+    if (!gs_health_ready(health))
+    {
+        return 1;
+    }
+
+    gs_radio_info_t info[1];
+    memset(info, 0x0, sizeof(gs_radio_info_t));
+    int answered = gs_radio_try_get_info(radio, info);
+    if (answered < 0)
+    {
+        // Transmitting; the next probe asks.
+        return 1;
+    }
+    uint64_t now = gs_time_ns();
+
+    health_lock(health);
+    if (!health->snap.ready)
+    {
+        // Re-initialized while we were asking; the answer may predate it.
+        health_unlock(health, false);
+        return 1;
+    }
+    bool ok = answered == 1 && gs_health_matches(health, info);
+    HEALTH_SET(health, probe_ns, now);
+    HEALTH_SET(health, probes, health->snap.probes + 1);
+    HEALTH_SET(health, part, info->part);
+    if (!ok)
+    {
+        HEALTH_SET(health, failures, health->snap.failures + 1);
+        __atomic_store_n(&health->lost, true, __ATOMIC_RELEASE);
+    }
+    health_unlock(health, ok);
+
+    if (!ok)
+    {
+        gs_metrics_count(GS_COUNT_RADIO_PROBE_FAILURES);
+        dbprintlf(FATAL "%s radio answered part 0x%x ID 0x%x rev 0x%x ROM 0x%x, expected 0x%x 0x%x 0x%x 0x%x.", radio->ops->name,
+                  info->part, info->id, info->chip_rev, info->rom_id, health->part, health->id, health->chip_rev, health->rom_id);
+    }
+    return ok;
+}
+
+int gs_health_init(gs_radio_t *radio, const gs_radio_info_t *info)
+{
+    gs_health_t *health = &radio->health;
+    bool ok = info != nullptr && RADIO_PART_VALID(info->part);
+    bool reinit = false;
+
+    health_lock(health);
+    HEALTH_SET(health, probe_ns, gs_time_ns());
+    HEALTH_SET(health, part, info != nullptr ? info->part : 0);
+    if (!ok)
+    {
+        HEALTH_SET(health, failures, health->snap.failures + 1);
+    }
+    else
+    {
+        // What the next probes must find. Set once the radio has been up, so a radio that was never
+        // up is not counted as coming back.
+        reinit = health->part != 0;
+        health->part = info->part;
+        health->id = info->id;
+        health->chip_rev = info->chip_rev;
+        health->rom_id = info->rom_id;
+        if (reinit)
+        {
+            HEALTH_SET(health, reinits, health->snap.reinits + 1);
+        }
+        __atomic_store_n(&health->lost, false, __ATOMIC_RELEASE);
+    }
+    health_unlock(health, ok);
+
+    if (reinit)
+    {
+        gs_metrics_count(GS_COUNT_RADIO_REINITS);
+    }
+    return ok;
+}
+
+void gs_health_print(const char *name, gs_radio_t *radio)
+{
+    gs_health_snapshot_t snap[1];
+    gs_health_get(&radio->health, snap);
+    double age = snap->probe_ns ? (gs_time_ns() - snap->probe_ns) / 1e9 : 0;
+    dbprintlf(CYAN_FG "%s health: %s, part 0x%x, %llu probes, %u failures, %u re-inits, last checked %.1f s ago.", name,
+              snap->ready ? "ready" : "down", snap->part, (unsigned long long)snap->probes, snap->failures, snap->reinits, age);
+}
@@ -0,0 +1,705 @@
+/**
+ * @file gs_log.cpp
+ * @author agent (agent@local)
+ * @brief Asynchronous binary logger for the hot paths.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * Each logging thread owns a byte ring; records never straddle the end of the ring, a pad record fills the
+ * gap instead. The in-memory record layout is also the on-disk layout, so the binary sink is a straight copy.
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include "gs_log.hpp"
+#include "gs_time.hpp"
+#include "meb_debug.hpp"
+
+#define LOG_REC_PAD 0
+#define LOG_REC_SITE 1
+#define LOG_REC_EVENT 2
+#define LOG_FILE_BUFFER (256 * 1024)
+#define LOG_MAX_RECORD (sizeof(log_rec_t) + GS_LOG_MAX_ARGS * (3 + GS_LOG_STR_MAX + 1) + 8)
+
+/**
+ * @brief Header shared by every record, in memory and on disk.
+ * 
+ */
+typedef struct
+{
+    uint32_t len; // Whole record, a multiple of 8.
+    uint8_t kind; // len and kind fit in 8 bytes, the smallest pad record.
+    uint8_t nargs;
+    uint16_t reserved;
+    uint32_t site_id;
+    uint32_t tid;
+    uint64_t ts; // CLOCK_MONOTONIC ns.
+} log_rec_t;
+
+typedef struct log_buffer
+{
+    // Producer side.
+    alignas(64) uint64_t head;
+    uint64_t tail_cache;
+    uint64_t dropped;
+    // Consumer side.
+    alignas(64) uint64_t tail;
+    // Read-only after creation.
+    alignas(64) uint32_t tid;
+    struct log_buffer *next;
+    alignas(64) uint8_t data[GS_LOG_BUFFER_SIZE];
+} log_buffer_t;
+
+static struct
+{
+    pthread_mutex_t lock; // Guards buffers, sites and the flush handshake.
+    pthread_cond_t flushed;
+    log_buffer_t *buffers;
+    gs_log_site_t *sites[GS_LOG_MAX_SITES];
+    uint32_t nsites;
+    bool running;
+    bool stop;
+    int efd;
+    pthread_t tid;
+    FILE *out;  // Binary log, or nullptr for text to stderr.
+    bool site_written[GS_LOG_MAX_SITES];
+    uint64_t flush_requested;
+    uint64_t flush_done;
+} logger = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, nullptr, {}, 0, false, false, -1, 0, nullptr, {}, 0, 0};
+
+static thread_local log_buffer_t *thread_buffer = nullptr;
+
+const char *gs_log_level_name(int level)
+{
+    static const char *names[] = {"DEBUG", "INFO", "WARN", "ERROR", "FATAL"};
+    return level >= GS_LOG_DEBUG && level <= GS_LOG_FATAL ? names[level] : "?";
+}
+
+int gs_log_format(char *out, size_t size, const char *format, const gs_log_arg_t *args, int nargs)
+{
+    size_t pos = 0;
+    int next = 0;
+
+#define LOG_PUT(...)                                                        \
+    do                                                                      \
+    {                                                                       \
+        int n_ = snprintf(out + pos, pos < size ? size - pos : 0, __VA_ARGS__); \
+        pos += n_ > 0 ? n_ : 0;                                             \
+    } while (0)
+
+    for (const char *p = format; *p; p++)
+    {
+        if (*p != '%')
+        {
+            if (pos + 1 < size)
+            {
+                out[pos] = *p;
+            }
+            pos++;
+            continue;
+        }
+        if (p[1] == '%')
+        {
+            LOG_PUT("%%");
+            p++;
+            continue;
+        }
+
+        // Collect flags, width and precision; drop the length modifier, the logged argument decides it.
+        char spec[32];
+        size_t slen = 0;
+        spec[slen++] = '%';
+        const char *q = p + 1;
+        while (*q && strchr("-+ #0123456789.", *q) && slen < sizeof(spec) - 4)
+        {
+            spec[slen++] = *q++;
+        }
+        while (*q && strchr("hlLqjzt", *q))
+        {
+            q++;
+        }
+        char conv = *q;
+        if (conv == '\0')
+        {
+            break;
+        }
+        p = q;
+
+        if (next >= nargs)
+        {
+            LOG_PUT("(missing)");
+            continue;
+        }
+        const gs_log_arg_t *arg = &args[next++];
+
+        switch (conv)
+        {
+        case 'd':
+        case 'i':
+            spec[slen++] = 'l', spec[slen++] = 'l', spec[slen++] = conv, spec[slen] = '\0';
+            LOG_PUT(spec, arg->type == GS_LOG_ARG_DOUBLE ? (long long)arg->d : (long long)arg->i);
+            break;
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+            spec[slen++] = 'l', spec[slen++] = 'l', spec[slen++] = conv, spec[slen] = '\0';
+            LOG_PUT(spec, arg->type == GS_LOG_ARG_DOUBLE ? (unsigned long long)arg->d : (unsigned long long)arg->u);
+            break;
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            spec[slen++] = conv, spec[slen] = '\0';
+            LOG_PUT(spec, arg->type == GS_LOG_ARG_DOUBLE ? arg->d : arg->type == GS_LOG_ARG_INT ? (double)arg->i : (double)arg->u);
+            break;
+        case 'c':
+            spec[slen++] = conv, spec[slen] = '\0';
+            LOG_PUT(spec, (int)arg->i);
+            break;
+        case 's':
+            spec[slen++] = conv, spec[slen] = '\0';
+            LOG_PUT(spec, arg->type == GS_LOG_ARG_STR && arg->s != nullptr ? arg->s : "(null)");
+            break;
+        case 'p':
+            spec[slen++] = conv, spec[slen] = '\0';
+            LOG_PUT(spec, (void *)(uintptr_t)arg->u);
+            break;
+        default:
+            LOG_PUT("(%%%c?)", conv);
+            break;
+        }
+    }
+
+#undef LOG_PUT
+
+    if (size > 0)
+    {
+        out[pos < size ? pos : size - 1] = '\0';
+    }
+    return pos;
+}
+
+static void log_print_text(FILE *stream, const gs_log_site_t *site, const gs_log_arg_t *args, int nargs)
+{
+    char message[1024];
+    gs_log_format(message, sizeof(message), site->format, args, nargs);
+    fprintf(stream, "[%s:%d | %s] %s\x1b[0m\n", site->file, site->line, site->func, message);
+}
+
+static uint32_t log_site_id(gs_log_site_t *site)
+{
+    uint32_t id = __atomic_load_n(&site->id, __ATOMIC_ACQUIRE);
+    if (id != 0)
+    {
+        return id;
+    }
+
+    pthread_mutex_lock(&logger.lock);
+    id = site->id;
+    if (id == 0 && logger.nsites + 1 < GS_LOG_MAX_SITES)
+    {
+        id = ++logger.nsites;
+        logger.sites[id] = site;
+        __atomic_store_n(&site->id, id, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&logger.lock);
+    return id;
+}
+
+static log_buffer_t *log_thread_buffer(void)
+{
+    if (thread_buffer != nullptr)
+    {
+        return thread_buffer;
+    }
+
+    log_buffer_t *buffer = nullptr;
+    if (posix_memalign((void **)&buffer, 64, sizeof(log_buffer_t)) != 0)
+    {
+        return nullptr;
+    }
+    memset(buffer, 0x0, sizeof(log_buffer_t));
+    buffer->tid = syscall(SYS_gettid);
+
+    // Buffers are never freed; the logging threads live as long as the process.
+    pthread_mutex_lock(&logger.lock);
+    buffer->next = logger.buffers;
+    logger.buffers = buffer;
+    pthread_mutex_unlock(&logger.lock);
+
+    thread_buffer = buffer;
+    return buffer;
+}
+
+void gs_log_write(gs_log_site_t *site, const gs_log_arg_t *args, int nargs)
+{
+    if (!__atomic_load_n(&logger.running, __ATOMIC_ACQUIRE))
+    {
+        log_print_text(stderr, site, args, nargs);
+        fflush(stderr);
+        return;
+    }
+
+    uint32_t id = log_site_id(site);
+    log_buffer_t *buffer = log_thread_buffer();
+    if (id == 0 || buffer == nullptr)
+    {
+        return;
+    }
+
+    uint32_t len = sizeof(log_rec_t);
+    size_t slens[GS_LOG_MAX_ARGS];
+    for (int i = 0; i < nargs; i++)
+    {
+        if (args[i].type == GS_LOG_ARG_STR)
+        {
+            slens[i] = args[i].s == nullptr ? 0 : strnlen(args[i].s, GS_LOG_STR_MAX);
+            len += 2 + slens[i] + 1;
+        }
+        else
+        {
+            len += 1 + 8;
+        }
+    }
+    len = (len + 7) & ~7u;
+
+    uint64_t head = buffer->head;
+    uint32_t pos = head & (GS_LOG_BUFFER_SIZE - 1);
+    uint32_t pad = pos + len > GS_LOG_BUFFER_SIZE ? GS_LOG_BUFFER_SIZE - pos : 0;
+    if (head + pad + len - buffer->tail_cache > GS_LOG_BUFFER_SIZE)
+    {
+        buffer->tail_cache = __atomic_load_n(&buffer->tail, __ATOMIC_ACQUIRE);
+        if (head + pad + len - buffer->tail_cache > GS_LOG_BUFFER_SIZE)
+        {
+            __atomic_store_n(&buffer->dropped, buffer->dropped + 1, __ATOMIC_RELAXED);
+            return;
+        }
+    }
+
+    if (pad)
+    {
+        log_rec_t *rec = (log_rec_t *)&buffer->data[pos];
+        rec->len = pad;
+        rec->kind = LOG_REC_PAD;
+        head += pad;
+        pos = 0;
+    }
+
+    log_rec_t *rec = (log_rec_t *)&buffer->data[pos];
+    rec->len = len;
+    rec->site_id = id;
+    rec->ts = gs_time_ns();
+    rec->kind = LOG_REC_EVENT;
+    rec->nargs = nargs;
+    rec->reserved = 0;
+    rec->tid = buffer->tid;
+
+    uint8_t *p = (uint8_t *)(rec + 1);
+    for (int i = 0; i < nargs; i++)
+    {
+        *p++ = args[i].type;
+        if (args[i].type == GS_LOG_ARG_STR)
+        {
+            uint16_t slen = slens[i];
+            memcpy(p, &slen, 2);
+            memcpy(p + 2, args[i].s, slen);
+            p[2 + slen] = '\0';
+            p += 2 + slen + 1;
+        }
+        else
+        {
+            memcpy(p, &args[i].u, 8);
+            p += 8;
+        }
+    }
+
+    uint64_t used = head + len - buffer->tail_cache;
+    __atomic_store_n(&buffer->head, head + len, __ATOMIC_RELEASE);
+
+    // Only wake the writer early when the buffer passes half full; otherwise it comes round every GS_LOG_FLUSH_MS.
+    if (used > GS_LOG_BUFFER_SIZE / 2 && used - len <= GS_LOG_BUFFER_SIZE / 2)
+    {
+        uint64_t one = 1;
+        if (write(logger.efd, &one, sizeof(one)) < 0)
+        {
+        }
+    }
+}
+
+/**
+ * @brief Unpacks an event record's arguments. String arguments point into the record.
+ * 
+ * @param rec 
+ * @param args 
+ * @return int Number of arguments.
+ */
+static int log_unpack(const log_rec_t *rec, gs_log_arg_t *args)
+{
+    const uint8_t *p = (const uint8_t *)(rec + 1);
+    int nargs = rec->nargs < GS_LOG_MAX_ARGS ? rec->nargs : GS_LOG_MAX_ARGS;
+    for (int i = 0; i < nargs; i++)
+    {
+        args[i].type = *p++;
+        if (args[i].type == GS_LOG_ARG_STR)
+        {
+            uint16_t slen;
+            memcpy(&slen, p, 2);
+            args[i].s = (const char *)p + 2;
+            p += 2 + slen + 1;
+        }
+        else
+        {
+            memcpy(&args[i].u, p, 8);
+            p += 8;
+        }
+    }
+    return nargs;
+}
+
+static void log_write_site(FILE *out, const gs_log_site_t *site)
+{
+    size_t flen = strlen(site->file) + 1, fnlen = strlen(site->func) + 1, fmtlen = strlen(site->format) + 1;
+    log_rec_t rec[1];
+    memset(rec, 0x0, sizeof(rec));
+    rec->len = (sizeof(log_rec_t) + 8 + flen + fnlen + fmtlen + 7) & ~7u;
+    rec->site_id = site->id;
+    rec->kind = LOG_REC_SITE;
+    uint32_t meta[2] = {(uint32_t)site->level, (uint32_t)site->line};
+    static const uint8_t zeros[8] = {0};
+
+    fwrite(rec, sizeof(log_rec_t), 1, out);
+    fwrite(meta, sizeof(meta), 1, out);
+    fwrite(site->file, flen, 1, out);
+    fwrite(site->func, fnlen, 1, out);
+    fwrite(site->format, fmtlen, 1, out);
+    fwrite(zeros, rec->len - (sizeof(log_rec_t) + 8 + flen + fnlen + fmtlen), 1, out);
+}
+
+/**
+ * @brief Writes out everything queued in every buffer.
+ * 
+ */
+static void log_drain(void)
+{
+    pthread_mutex_lock(&logger.lock);
+    log_buffer_t *buffers = logger.buffers;
+    pthread_mutex_unlock(&logger.lock);
+
+    for (log_buffer_t *buffer = buffers; buffer != nullptr; buffer = buffer->next)
+    {
+        uint64_t head = __atomic_load_n(&buffer->head, __ATOMIC_ACQUIRE);
+        uint64_t tail = buffer->tail;
+        while (tail != head)
+        {
+            const log_rec_t *rec = (const log_rec_t *)&buffer->data[tail & (GS_LOG_BUFFER_SIZE - 1)];
+            if (rec->kind == LOG_REC_EVENT)
+            {
+                gs_log_site_t *site = logger.sites[rec->site_id];
+                if (logger.out != nullptr)
+                {
+                    if (!logger.site_written[rec->site_id])
+                    {
+                        log_write_site(logger.out, site);
+                        logger.site_written[rec->site_id] = true;
+                    }
+                    fwrite(rec, rec->len, 1, logger.out);
+                }
+                else
+                {
+                    gs_log_arg_t args[GS_LOG_MAX_ARGS];
+                    int nargs = log_unpack(rec, args);
+                    log_print_text(stderr, site, args, nargs);
+                }
+            }
+            tail += rec->len;
+        }
+        __atomic_store_n(&buffer->tail, tail, __ATOMIC_RELEASE);
+    }
+
+    fflush(logger.out != nullptr ? logger.out : stderr);
+}
+
+static void *log_thread(void *args)
+{
+    (void)args;
+    while (true)
+    {
+        struct pollfd pfd = {logger.efd, POLLIN, 0};
+        poll(&pfd, 1, GS_LOG_FLUSH_MS);
+        uint64_t count;
+        if (read(logger.efd, &count, sizeof(count)) < 0)
+        {
+            // EAGAIN: timed out.
+        }
+
+        pthread_mutex_lock(&logger.lock);
+        uint64_t requested = logger.flush_requested;
+        bool stop = logger.stop;
+        pthread_mutex_unlock(&logger.lock);
+
+        log_drain();
+
+        pthread_mutex_lock(&logger.lock);
+        logger.flush_done = requested;
+        pthread_cond_broadcast(&logger.flushed);
+        pthread_mutex_unlock(&logger.lock);
+
+        if (stop)
+        {
+            break;
+        }
+    }
+    return nullptr;
+}
+
+int gs_log_start(const char *path)
+{
+    if (logger.running)
+    {
+        return 1;
+    }
+
+    logger.out = nullptr;
+    if (path != nullptr)
+    {
+        logger.out = fopen(path, "wb");
+        if (logger.out == nullptr)
+        {
+            dbprintlf(RED_FG "Failed to open log file %s.", path);
+            erprintlf(errno);
+            return 0;
+        }
+        setvbuf(logger.out, nullptr, _IOFBF, LOG_FILE_BUFFER);
+
+        // Header: magic, then the wall-clock and monotonic times of the same instant, so the decoder can
+        // print wall-clock timestamps.
+        struct timespec rt;
+        clock_gettime(CLOCK_REALTIME, &rt);
+        uint64_t hdr[2] = {(uint64_t)rt.tv_sec * NSEC_PER_SEC + rt.tv_nsec, gs_time_ns()};
+        fwrite(GS_LOG_MAGIC, 8, 1, logger.out);
+        fwrite(hdr, sizeof(hdr), 1, logger.out);
+        memset(logger.site_written, 0x0, sizeof(logger.site_written));
+    }
+
+    // Kept open across restarts: a producer that saw the logger running may still be about to signal it.
+    if (logger.efd < 0)
+    {
+        logger.efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    }
+    if (logger.efd < 0)
+    {
+        dbprintlf(RED_FG "Failed to create logger eventfd.");
+        if (logger.out != nullptr)
+        {
+            fclose(logger.out);
+            logger.out = nullptr;
+        }
+        return 0;
+    }
+
+    logger.stop = false;
+    if (pthread_create(&logger.tid, NULL, log_thread, NULL) != 0)
+    {
+        dbprintlf(RED_FG "Failed to start the logger thread.");
+        if (logger.out != nullptr)
+        {
+            fclose(logger.out);
+            logger.out = nullptr;
+        }
+        return 0;
+    }
+    __atomic_store_n(&logger.running, true, __ATOMIC_RELEASE);
+    return 1;
+}
+
+void gs_log_flush(void)
+{
+    if (!__atomic_load_n(&logger.running, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&logger.lock);
+    uint64_t ticket = ++logger.flush_requested;
+    uint64_t one = 1;
+    if (write(logger.efd, &one, sizeof(one)) < 0)
+    {
+    }
+    while (logger.flush_done < ticket)
+    {
+        pthread_cond_wait(&logger.flushed, &logger.lock);
+    }
+    pthread_mutex_unlock(&logger.lock);
+}
+
+void gs_log_stop(void)
+{
+    if (!logger.running)
+    {
+        return;
+    }
+
+    // New records go straight to stderr from here on; drain what was already queued.
+    __atomic_store_n(&logger.running, false, __ATOMIC_RELEASE);
+    pthread_mutex_lock(&logger.lock);
+    logger.stop = true;
+    pthread_mutex_unlock(&logger.lock);
+    uint64_t one = 1;
+    if (write(logger.efd, &one, sizeof(one)) < 0)
+    {
+    }
+    pthread_join(logger.tid, NULL);
+
+    if (logger.out != nullptr)
+    {
+        fclose(logger.out);
+        logger.out = nullptr;
+    }
+
+    uint64_t dropped = gs_log_dropped();
+    if (dropped)
+    {
+        dbprintlf(YELLOW_FG "Logger dropped %llu records, buffers were full.", (unsigned long long)dropped);
+    }
+}
+
+static void log_strip_escapes(char *text)
+{
+    char *w = text;
+    for (char *r = text; *r; r++)
+    {
+        if (*r == '\x1b' && r[1] == '[')
+        {
+            r += 2;
+            while (*r && *r != 'm')
+            {
+                r++;
+            }
+            if (*r == '\0')
+            {
+                break;
+            }
+            continue;
+        }
+        *w++ = *r;
+    }
+    *w = '\0';
+}
+
+int gs_log_decode(FILE *in, FILE *out, bool plain)
+{
+    char magic[8];
+    uint64_t hdr[2];
+    if (fread(magic, sizeof(magic), 1, in) != 1 || memcmp(magic, GS_LOG_MAGIC, sizeof(magic)) != 0 ||
+        fread(hdr, sizeof(hdr), 1, in) != 1)
+    {
+        return -1;
+    }
+    uint64_t realtime_ns = hdr[0], monotonic_ns = hdr[1];
+
+    // Sites as read from the file; strings point into their own allocations.
+    static gs_log_site_t sites[GS_LOG_MAX_SITES];
+    static char *site_strings[GS_LOG_MAX_SITES];
+    uint8_t record[LOG_MAX_RECORD];
+    int decoded = 0;
+
+    while (true)
+    {
+        log_rec_t *rec = (log_rec_t *)record;
+        if (fread(rec, sizeof(log_rec_t), 1, in) != 1)
+        {
+            break;
+        }
+        if (rec->len < sizeof(log_rec_t) || rec->len > sizeof(record) || rec->site_id >= GS_LOG_MAX_SITES ||
+            (rec->len > sizeof(log_rec_t) && fread(rec + 1, rec->len - sizeof(log_rec_t), 1, in) != 1))
+        {
+            decoded = -1;
+            break;
+        }
+
+        if (rec->kind == LOG_REC_SITE)
+        {
+            uint32_t meta[2];
+            memcpy(meta, rec + 1, sizeof(meta));
+            size_t slen = rec->len - sizeof(log_rec_t) - sizeof(meta);
+            free(site_strings[rec->site_id]);
+            char *strings = (char *)malloc(slen + 1);
+            if (strings == nullptr)
+            {
+                decoded = -1;
+                break;
+            }
+            memcpy(strings, (uint8_t *)(rec + 1) + sizeof(meta), slen);
+            strings[slen] = '\0';
+            site_strings[rec->site_id] = strings;
+
+            gs_log_site_t *site = &sites[rec->site_id];
+            site->level = meta[0];
+            site->line = meta[1];
+            site->file = strings;
+            site->func = site->file + strlen(site->file) + 1;
+            site->format = site->func + strlen(site->func) + 1;
+            site->id = rec->site_id;
+            continue;
+        }
+        if (rec->kind != LOG_REC_EVENT || sites[rec->site_id].id == 0)
+        {
+            continue;
+        }
+
+        gs_log_site_t *site = &sites[rec->site_id];
+        gs_log_arg_t args[GS_LOG_MAX_ARGS];
+        int nargs = log_unpack(rec, args);
+        char message[1024];
+        gs_log_format(message, sizeof(message), site->format, args, nargs);
+        if (plain)
+        {
+            log_strip_escapes(message);
+        }
+
+        uint64_t ns = realtime_ns + (rec->ts - monotonic_ns);
+        time_t secs = ns / NSEC_PER_SEC;
+        struct tm tm;
+        char stamp[32];
+        strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", gmtime_r(&secs, &tm));
+        fprintf(out, "%s.%06llu %6u %-5s [%s:%d | %s] %s%s\n", stamp, (unsigned long long)(ns % NSEC_PER_SEC) / 1000,
+                rec->tid, gs_log_level_name(site->level), site->file, site->line, site->func, message, plain ? "" : "\x1b[0m");
+        decoded++;
+    }
+
+    for (int i = 0; i < GS_LOG_MAX_SITES; i++)
+    {
+        free(site_strings[i]);
+        site_strings[i] = nullptr;
+        sites[i].id = 0;
+    }
+    return decoded;
+}
+
+uint64_t gs_log_dropped(void)
+{
+    uint64_t dropped = 0;
+    pthread_mutex_lock(&logger.lock);
+    for (log_buffer_t *buffer = logger.buffers; buffer != nullptr; buffer = buffer->next)
+    {
+        dropped += __atomic_load_n(&buffer->dropped, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&logger.lock);
+    return dropped;
+}
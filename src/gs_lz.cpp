@@ -0,0 +1,246 @@
+/**
+ * @file gs_lz.cpp
+ * @author agent (agent@local)
+ * @brief Small-window LZSS compression of uplink payloads, with optional shared dictionaries.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <string.h>
+#include "gs_lz.hpp"
+
+// A zeroed cmd_input_t: the unused field, data_size's high bytes and the unused tail of data are what a
+// command is mostly made of.
+static const uint8_t lz_dict_cmd[56] = {0};
+
+// Words and fragments common to the shell scripts, configuration files and element sets uplinked as files.
+static const char lz_dict_text[] =
+    "#!/bin/sh\nset -e\nif [ -f \"$1\" ]; then\n    echo \"\" >> /dev/null 2>&1\nfi\nexport PATH=/usr/bin:/bin\n"
+    "mkdir -p /home/sh/ && chmod +x /etc/systemctl restart \n[config]\nenabled = true\nfalse\n_ms = 0\n"
+    "1 00000U 00000A   .00000000  00000-0  00000-0 0  0000\n2 00000  00.0000 ";
+
+static const struct
+{
+    const char *name;
+    const uint8_t *data;
+    size_t len;
+} lz_dicts[GS_LZ_DICTS] = {
+    {"none", nullptr, 0},
+    {"cmd", lz_dict_cmd, sizeof(lz_dict_cmd)},
+    {"text", (const uint8_t *)lz_dict_text, sizeof(lz_dict_text) - 1},
+};
+
+const uint8_t *gs_lz_dict(int dict, size_t *len)
+{
+    if (dict <= GS_LZ_DICT_NONE || dict >= GS_LZ_DICTS)
+    {
+        *len = 0;
+        return nullptr;
+    }
+    // Only the last window's worth can ever be referred to.
+    *len = lz_dicts[dict].len < GS_LZ_WINDOW ? lz_dicts[dict].len : GS_LZ_WINDOW;
+    return lz_dicts[dict].data + lz_dicts[dict].len - *len;
+}
+
+const char *gs_lz_dict_name(int dict)
+{
+    return dict >= 0 && dict < GS_LZ_DICTS ? lz_dicts[dict].name : "unknown";
+}
+
+/**
+ * @brief The history a payload is coded against: the dictionary, then the payload itself.
+ */
+typedef struct
+{
+    const uint8_t *dict;
+    ssize_t dict_len;
+    const uint8_t *data;
+} lz_history_t;
+
+/**
+ * @brief A byte of the history, p < 0 reaching back into the dictionary.
+ */
+static inline uint8_t lz_at(const lz_history_t *h, ssize_t p)
+{
+    return p < 0 ? h->dict[h->dict_len + p] : h->data[p];
+}
+
+/**
+ * @brief Writes bits MSB first, or only counts them without a buffer; stops counting past cap.
+ */
+typedef struct
+{
+    uint8_t *buf;
+    size_t cap_bits;
+    size_t bits;
+} lz_writer_t;
+
+static inline bool lz_put(lz_writer_t *w, uint32_t value, int count)
+{
+    if (w->bits + count > w->cap_bits)
+    {
+        return false;
+    }
+    for (int i = count - 1; i >= 0; i--, w->bits++)
+    {
+        if (w->buf != nullptr)
+        {
+            uint8_t bit = 0x80 >> (w->bits % 8);
+            w->buf[w->bits / 8] = (value >> i) & 1 ? w->buf[w->bits / 8] | bit : w->buf[w->bits / 8] & ~bit;
+        }
+    }
+    return true;
+}
+
+ssize_t gs_lz_compress(void *dst, size_t cap, const void *src, size_t len, int dict)
+{
+    if (src == nullptr || len == 0 || len > 0xffff || dict < 0 || dict >= GS_LZ_DICTS)
+    {
+        return -1;
+    }
+    if (cap < sizeof(gs_lz_header_t))
+    {
+        return 0;
+    }
+
+    size_t dict_len;
+    lz_history_t h = {gs_lz_dict(dict, &dict_len), 0, (const uint8_t *)src};
+    h.dict_len = (ssize_t)dict_len;
+    uint8_t *out = (uint8_t *)dst;
+    if (out != nullptr)
+    {
+        gs_lz_header_t header = {(uint8_t)dict, (uint16_t)len};
+        memcpy(out, &header, sizeof(gs_lz_header_t));
+    }
+    lz_writer_t w = {out != nullptr ? out + sizeof(gs_lz_header_t) : nullptr, (cap - sizeof(gs_lz_header_t)) * 8, 0};
+
+    ssize_t n = (ssize_t)len;
+    for (ssize_t i = 0; i < n;)
+    {
+        // Greedy: the longest match in the window, the nearest of equals.
+        ssize_t best_len = 0, best_dist = 0;
+        ssize_t limit = n - i < GS_LZ_MAX_MATCH ? n - i : GS_LZ_MAX_MATCH;
+        ssize_t oldest = i - GS_LZ_WINDOW > -h.dict_len ? i - GS_LZ_WINDOW : -h.dict_len;
+        for (ssize_t p = i - 1; p >= oldest && best_len < limit; p--)
+        {
+            if (lz_at(&h, p) != h.data[i])
+            {
+                continue;
+            }
+            // May run on into the bytes being coded, as the decoder copies byte by byte.
+            ssize_t k = 1;
+            while (k < limit && lz_at(&h, p + k) == h.data[i + k])
+            {
+                k++;
+            }
+            if (k > best_len)
+            {
+                best_len = k;
+                best_dist = i - p;
+            }
+        }
+
+        bool fits;
+        if (best_len >= GS_LZ_MIN_MATCH)
+        {
+            fits = lz_put(&w, 0, 1) && lz_put(&w, best_dist - 1, GS_LZ_WINDOW_BITS) &&
+                   lz_put(&w, best_len - GS_LZ_MIN_MATCH, GS_LZ_LENGTH_BITS);
+            i += best_len;
+        }
+        else
+        {
+            fits = lz_put(&w, 1, 1) && lz_put(&w, h.data[i], 8);
+            i++;
+        }
+        if (!fits)
+        {
+            return 0;
+        }
+    }
+    return sizeof(gs_lz_header_t) + (w.bits + 7) / 8;
+}
+
+ssize_t gs_lz_pack(void *dst, size_t cap, const void *src, size_t len)
+{
+    // Sized without writing, each only as far as it could still beat the best so far.
+    int best = -1;
+    size_t best_size = cap;
+    for (int dict = GS_LZ_DICT_NONE; dict < GS_LZ_DICTS; dict++)
+    {
+        ssize_t size = gs_lz_compress(nullptr, best_size, src, len, dict);
+        if (size < 0)
+        {
+            return -1;
+        }
+        if (size > 0 && (best < 0 || (size_t)size < best_size))
+        {
+            best = dict;
+            best_size = size;
+        }
+    }
+    return best < 0 ? 0 : gs_lz_compress(dst, cap, src, len, best);
+}
+
+ssize_t gs_lz_decompress(void *dst, size_t cap, const void *src, size_t len)
+{
+    gs_lz_header_t header;
+    if (dst == nullptr || src == nullptr || len < sizeof(gs_lz_header_t))
+    {
+        return -1;
+    }
+    memcpy(&header, src, sizeof(gs_lz_header_t));
+    if (header.dict >= GS_LZ_DICTS || header.len == 0 || header.len > cap)
+    {
+        return -1;
+    }
+
+    size_t dict_len;
+    uint8_t *out = (uint8_t *)dst;
+    lz_history_t h = {gs_lz_dict(header.dict, &dict_len), 0, out};
+    h.dict_len = (ssize_t)dict_len;
+    const uint8_t *in = (const uint8_t *)src + sizeof(gs_lz_header_t);
+    size_t in_bits = (len - sizeof(gs_lz_header_t)) * 8, bit = 0;
+    ssize_t n = header.len;
+    for (ssize_t o = 0; o < n;)
+    {
+        uint32_t fields[3] = {0, 0, 0};
+        if (bit >= in_bits)
+        {
+            return -1;
+        }
+        bool literal = (in[bit / 8] >> (7 - bit % 8)) & 1;
+        bit++;
+        const int widths[2][2] = {{GS_LZ_WINDOW_BITS, GS_LZ_LENGTH_BITS}, {8, 0}};
+        for (int f = 0; f < 2; f++)
+        {
+            int count = widths[literal][f];
+            if (bit + count > in_bits)
+            {
+                return -1;
+            }
+            for (int i = 0; i < count; i++, bit++)
+            {
+                fields[f] = (fields[f] << 1) | ((in[bit / 8] >> (7 - bit % 8)) & 1);
+            }
+        }
+
+        if (literal)
+        {
+            out[o++] = (uint8_t)fields[0];
+            continue;
+        }
+        ssize_t dist = fields[0] + 1, count = fields[1] + GS_LZ_MIN_MATCH;
+        if (dist > o + h.dict_len || o + count > n)
+        {
+            return -1;
+        }
+        for (ssize_t k = 0; k < count; k++, o++)
+        {
+            out[o] = lz_at(&h, o - dist);
+        }
+    }
+    return n;
+}
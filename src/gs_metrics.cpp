@@ -0,0 +1,483 @@
+/**
+ * @file gs_metrics.cpp
+ * @author agent (agent@local)
+ * @brief Per-stage latency histograms and counters, served in Prometheus text format on a Unix socket.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "gs_metrics.hpp"
+#include "gs_uhf.hpp"
+#include "gs_ring.hpp"
+#include "gs_spool.hpp"
+#include "meb_debug.hpp"
+
+#define METRICS_PREFIX "roofuhf_"
+#define METRICS_REQUEST_TIMEOUT_MS 100 // How long a client gets to send an HTTP request line.
+
+thread_local gs_metrics_shard_t *gs_metrics_tls = nullptr;
+
+static const char *stage_names[GS_STAGE_NUM] = {
+    "radio_read", "validate", "enqueue", "net_send", "downlink", "net_recv", "radio_write", "uplink", "tx_queue_wait",
+    "rx_to_tx_turnaround", "tx_to_rx_turnaround", "modem_switch", "compress"};
+
+static const struct
+{
+    const char *name;
+    const char *labels;
+    const char *help;
+} counter_info[GS_COUNT_NUM] = {
+    {"uhf_rx_frames_total", "", "Valid GST frames received over UHF."},
+    {"uhf_rx_timeouts_total", "", "UHF receive waits that timed out."},
+    {"uhf_rx_errors_total", "code=\"GST_ERROR\"", "UHF receive failures by GST_ERRORS code."},
+    {"uhf_rx_errors_total", "code=\"GST_PACKET_INCOMPLETE\"", nullptr},
+    {"uhf_rx_errors_total", "code=\"GST_GUID_ERROR\"", nullptr},
+    {"uhf_rx_errors_total", "code=\"GST_CRC_MISMATCH\"", nullptr},
+    {"uhf_rx_errors_total", "code=\"GST_CRC_ERROR\"", nullptr},
+    {"uhf_tx_frames_total", "", "GST frames transmitted over UHF."},
+    {"uhf_tx_failures_total", "", "UHF transmissions that failed."},
+    {"net_tx_frames_total", "", "Frames forwarded to the server."},
+    {"net_tx_failures_total", "", "Frames the server connection did not take (retried)."},
+    {"net_rx_frames_total", "", "NetFrames received from the server."},
+    {"uhf_tx_rejected_total", "", "Uplink commands NACKed because the TX queue was full."},
+    {"uhf_tx_expired_total", "", "Uplink commands NACKed at their deadline."},
+    {"uhf_sar_tx_messages_total", "", "Multi-frame uplinks fully acknowledged."},
+    {"uhf_sar_rx_messages_total", "", "Multi-frame downlinks reassembled."},
+    {"uhf_sar_retransmits_total", "", "Uplink segments sent again."},
+    {"uhf_fec_rx_frames_total", "", "Received frames carrying Reed-Solomon parity."},
+    {"uhf_fec_corrected_bytes_total", "", "Bytes repaired by the Reed-Solomon decoder."},
+    {"uhf_fec_uncorrectable_total", "", "Parity frames with more errors than the code corrects."},
+    {"uhf_downlink_copy_bytes_total", "", "Frame bytes copied between the radio and the server socket."},
+    {"uhf_uplink_copy_bytes_total", "", "Frame bytes copied between the server socket and the radio."},
+    {"uhf_diversity_duplicates_total", "", "Copies of a frame already delivered by another radio, dropped."},
+    {"uhf_uplink_switches_total", "", "Times the uplink moved to a different radio."},
+    {"spool_frames_total", "", "Downlinked frames spooled to disk while the server was unreachable."},
+    {"spool_drained_total", "", "Spooled frames delivered to the server."},
+    {"net_connect_failures_total", "", "Attempts to reconnect to the server that failed."},
+    {"uhf_radio_probe_failures_total", "", "Health probes that found a radio no longer answering as it did at init."},
+    {"uhf_radio_reinits_total", "", "Radios brought back up after a failed probe or init."},
+    {"uhf_tx_bursts_total", "", "TX bursts, each one RX to TX and back."},
+    {"uhf_pass_wakes_total", "", "Radios woken ahead of a pass."},
+    {"uhf_pass_sleeps_total", "", "Radios put to sleep after a pass."},
+    {"uhf_doppler_retunes_total", "", "Doppler corrections applied."},
+    {"uhf_doppler_deferred_total", "", "Doppler corrections put off while a radio was transmitting or receiving a frame."},
+    {"uhf_modem_switches_total", "", "Modem profiles applied to a radio."},
+    {"uhf_modem_deferred_total", "", "Modem profile switches put off while a radio was transmitting or receiving a frame."},
+    {"uhf_rate_steps_total", "direction=\"up\"", "Adaptive data rate steps."},
+    {"uhf_rate_steps_total", "direction=\"down\"", nullptr},
+    {"uhf_uplink_compressed_total", "", "Uplink payloads sent compressed."},
+    {"uhf_uplink_compress_skipped_total", "", "Uplink payloads that would not have saved a frame compressed."},
+    {"uhf_uplink_frames_saved_total", "", "Frames compression kept off the air."},
+};
+
+// Upper bounds, in seconds, of the exported latency buckets.
+static const double latency_bounds[] = {1e-6, 2e-6, 5e-6, 1e-5, 2e-5, 5e-5, 1e-4, 2e-4, 5e-4,
+                                        1e-3, 2e-3, 5e-3, 1e-2, 2e-2, 5e-2, 1e-1, 2e-1, 5e-1, 1, 2, 5, 10};
+
+static struct
+{
+    pthread_mutex_t lock; // Guards shards, rings and the spool.
+    gs_metrics_shard_t *shards;
+    const char *ring_names[METRICS_MAX_RINGS];
+    gs_ring_t *rings[METRICS_MAX_RINGS];
+    int nrings;
+    gs_spool_t *spool;
+    int listen_fd;
+    int stop_pipe[2];
+    char path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+    pthread_t tid;
+    bool running;
+} metrics = {PTHREAD_MUTEX_INITIALIZER, nullptr, {}, {}, 0, nullptr, -1, {-1, -1}, {0}, 0, false};
+
+gs_metrics_shard_t *gs_metrics_shard(void)
+{
+    gs_metrics_shard_t *shard = nullptr;
+    if (posix_memalign((void **)&shard, 64, sizeof(gs_metrics_shard_t)) != 0)
+    {
+        return nullptr;
+    }
+    memset(shard, 0x0, sizeof(gs_metrics_shard_t));
+
+    // Shards outlive their threads so their counts keep contributing to the totals.
+    pthread_mutex_lock(&metrics.lock);
+    shard->next = metrics.shards;
+    metrics.shards = shard;
+    pthread_mutex_unlock(&metrics.lock);
+
+    gs_metrics_tls = shard;
+    return shard;
+}
+
+void gs_metrics_count_gst_error(ssize_t retval)
+{
+    switch (retval)
+    {
+    case -GST_PACKET_INCOMPLETE:
+        gs_metrics_count(GS_COUNT_GST_PACKET_INCOMPLETE);
+        break;
+    case -GST_GUID_ERROR:
+        gs_metrics_count(GS_COUNT_GST_GUID_ERROR);
+        break;
+    case -GST_CRC_MISMATCH:
+        gs_metrics_count(GS_COUNT_GST_CRC_MISMATCH);
+        break;
+    case -GST_CRC_ERROR:
+        gs_metrics_count(GS_COUNT_GST_CRC_ERROR);
+        break;
+    default:
+        gs_metrics_count(GS_COUNT_GST_ERROR);
+        break;
+    }
+}
+
+uint64_t gs_metrics_counter(gs_metric_counter_t counter)
+{
+    uint64_t total = 0;
+    pthread_mutex_lock(&metrics.lock);
+    for (gs_metrics_shard_t *shard = metrics.shards; shard != nullptr; shard = shard->next)
+    {
+        total += __atomic_load_n(&shard->counters[counter], __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&metrics.lock);
+    return total;
+}
+
+/**
+ * @brief Sums a stage's histogram over every shard.
+ * 
+ * @param stage 
+ * @param hist Output, METRICS_HIST_BUCKETS entries.
+ * @param sum_ns 
+ * @return uint64_t Number of samples.
+ */
+static uint64_t metrics_merge(gs_metric_stage_t stage, uint64_t *hist, uint64_t *sum_ns)
+{
+    uint64_t count = 0;
+    memset(hist, 0x0, METRICS_HIST_BUCKETS * sizeof(uint64_t));
+    *sum_ns = 0;
+
+    pthread_mutex_lock(&metrics.lock);
+    for (gs_metrics_shard_t *shard = metrics.shards; shard != nullptr; shard = shard->next)
+    {
+        for (int i = 0; i < METRICS_HIST_BUCKETS; i++)
+        {
+            uint64_t n = __atomic_load_n(&shard->hist[stage][i], __ATOMIC_RELAXED);
+            hist[i] += n;
+            count += n;
+        }
+        *sum_ns += __atomic_load_n(&shard->hist_sum_ns[stage], __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&metrics.lock);
+    return count;
+}
+
+static uint64_t metrics_hist_quantile(const uint64_t *hist, uint64_t count, double quantile)
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    uint64_t rank = quantile * count;
+    rank = rank >= count ? count - 1 : rank;
+    uint64_t seen = 0;
+    for (int i = 0; i < METRICS_HIST_BUCKETS; i++)
+    {
+        seen += hist[i];
+        if (seen > rank)
+        {
+            uint64_t low = gs_metrics_bucket_low(i);
+            uint64_t high = i + 1 < METRICS_HIST_BUCKETS ? gs_metrics_bucket_low(i + 1) : low;
+            return low + (high - low) / 2;
+        }
+    }
+    return 0;
+}
+
+uint64_t gs_metrics_quantile(gs_metric_stage_t stage, double quantile, uint64_t *count)
+{
+    static thread_local uint64_t hist[METRICS_HIST_BUCKETS];
+    uint64_t sum_ns, n = metrics_merge(stage, hist, &sum_ns);
+    if (count != nullptr)
+    {
+        *count = n;
+    }
+    return metrics_hist_quantile(hist, n, quantile);
+}
+
+int gs_metrics_watch_ring(const char *name, gs_ring_t *ring)
+{
+    int retval = 0;
+    pthread_mutex_lock(&metrics.lock);
+    if (metrics.nrings < METRICS_MAX_RINGS)
+    {
+        metrics.ring_names[metrics.nrings] = name;
+        metrics.rings[metrics.nrings] = ring;
+        metrics.nrings++;
+        retval = 1;
+    }
+    pthread_mutex_unlock(&metrics.lock);
+    return retval;
+}
+
+void gs_metrics_watch_spool(gs_spool_t *spool)
+{
+    pthread_mutex_lock(&metrics.lock);
+    metrics.spool = spool;
+    pthread_mutex_unlock(&metrics.lock);
+}
+
+void gs_metrics_render(FILE *out)
+{
+    for (int c = 0; c < GS_COUNT_NUM; c++)
+    {
+        if (counter_info[c].help != nullptr)
+        {
+            fprintf(out, "# HELP " METRICS_PREFIX "%s %s\n", counter_info[c].name, counter_info[c].help);
+            fprintf(out, "# TYPE " METRICS_PREFIX "%s counter\n", counter_info[c].name);
+        }
+        fprintf(out, METRICS_PREFIX "%s%s%s%s %llu\n", counter_info[c].name, *counter_info[c].labels ? "{" : "",
+                counter_info[c].labels, *counter_info[c].labels ? "}" : "",
+                (unsigned long long)gs_metrics_counter((gs_metric_counter_t)c));
+    }
+
+    static uint64_t hist[METRICS_HIST_BUCKETS];
+    static const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+    fprintf(out, "# HELP " METRICS_PREFIX "stage_latency_seconds Time spent in each pipeline stage.\n");
+    fprintf(out, "# TYPE " METRICS_PREFIX "stage_latency_seconds histogram\n");
+    for (int s = 0; s < GS_STAGE_NUM; s++)
+    {
+        uint64_t sum_ns, count = metrics_merge((gs_metric_stage_t)s, hist, &sum_ns);
+        uint64_t cumulative = 0;
+        int bucket = 0;
+        for (size_t b = 0; b < sizeof(latency_bounds) / sizeof(latency_bounds[0]); b++)
+        {
+            // A fine bucket counts toward the first bound at or above its lowest value.
+            uint64_t bound_ns = latency_bounds[b] * 1e9;
+            while (bucket < METRICS_HIST_BUCKETS && gs_metrics_bucket_low(bucket) <= bound_ns)
+            {
+                cumulative += hist[bucket++];
+            }
+            fprintf(out, METRICS_PREFIX "stage_latency_seconds_bucket{stage=\"%s\",le=\"%g\"} %llu\n",
+                    stage_names[s], latency_bounds[b], (unsigned long long)cumulative);
+        }
+        fprintf(out, METRICS_PREFIX "stage_latency_seconds_bucket{stage=\"%s\",le=\"+Inf\"} %llu\n", stage_names[s], (unsigned long long)count);
+        fprintf(out, METRICS_PREFIX "stage_latency_seconds_sum{stage=\"%s\"} %.9f\n", stage_names[s], sum_ns / 1e9);
+        fprintf(out, METRICS_PREFIX "stage_latency_seconds_count{stage=\"%s\"} %llu\n", stage_names[s], (unsigned long long)count);
+    }
+
+    fprintf(out, "# HELP " METRICS_PREFIX "stage_latency_quantile_seconds Quantiles from the full-resolution histograms.\n");
+    fprintf(out, "# TYPE " METRICS_PREFIX "stage_latency_quantile_seconds gauge\n");
+    for (int s = 0; s < GS_STAGE_NUM; s++)
+    {
+        uint64_t sum_ns, count = metrics_merge((gs_metric_stage_t)s, hist, &sum_ns);
+        for (size_t q = 0; q < sizeof(quantiles) / sizeof(quantiles[0]); q++)
+        {
+            fprintf(out, METRICS_PREFIX "stage_latency_quantile_seconds{stage=\"%s\",quantile=\"%g\"} %.9f\n",
+                    stage_names[s], quantiles[q], metrics_hist_quantile(hist, count, quantiles[q]) / 1e9);
+        }
+    }
+
+    uint64_t rssi[METRICS_RSSI_BUCKETS] = {0};
+    uint64_t rssi_count = 0;
+    double rssi_sum = 0;
+    pthread_mutex_lock(&metrics.lock);
+    for (gs_metrics_shard_t *shard = metrics.shards; shard != nullptr; shard = shard->next)
+    {
+        for (int i = 0; i < METRICS_RSSI_BUCKETS; i++)
+        {
+            uint64_t n = __atomic_load_n(&shard->rssi[i], __ATOMIC_RELAXED);
+            rssi[i] += n;
+            rssi_count += n;
+            rssi_sum += (double)n * (i + METRICS_RSSI_MIN);
+        }
+    }
+    pthread_mutex_unlock(&metrics.lock);
+
+    fprintf(out, "# HELP " METRICS_PREFIX "uhf_rx_rssi_dbm RSSI of received frames.\n");
+    fprintf(out, "# TYPE " METRICS_PREFIX "uhf_rx_rssi_dbm histogram\n");
+    uint64_t cumulative = 0;
+    for (int i = 0; i < METRICS_RSSI_BUCKETS; i++)
+    {
+        cumulative += rssi[i];
+        int dbm = i + METRICS_RSSI_MIN;
+        if (dbm % 5 == 0 && dbm >= -140)
+        {
+            fprintf(out, METRICS_PREFIX "uhf_rx_rssi_dbm_bucket{le=\"%d\"} %llu\n", dbm, (unsigned long long)cumulative);
+        }
+    }
+    fprintf(out, METRICS_PREFIX "uhf_rx_rssi_dbm_bucket{le=\"+Inf\"} %llu\n", (unsigned long long)rssi_count);
+    fprintf(out, METRICS_PREFIX "uhf_rx_rssi_dbm_sum %.0f\n", rssi_sum);
+    fprintf(out, METRICS_PREFIX "uhf_rx_rssi_dbm_count %llu\n", (unsigned long long)rssi_count);
+
+    pthread_mutex_lock(&metrics.lock);
+    if (metrics.nrings)
+    {
+        fprintf(out, "# HELP " METRICS_PREFIX "ring_depth Frames queued in a ring.\n# TYPE " METRICS_PREFIX "ring_depth gauge\n");
+        fprintf(out, "# HELP " METRICS_PREFIX "ring_high_water Deepest a ring has been.\n# TYPE " METRICS_PREFIX "ring_high_water gauge\n");
+        fprintf(out, "# HELP " METRICS_PREFIX "ring_overflows_total Frames dropped because a ring was full.\n# TYPE " METRICS_PREFIX "ring_overflows_total counter\n");
+    }
+    for (int i = 0; i < metrics.nrings; i++)
+    {
+        gs_ring_stats_t stats[1];
+        gs_ring_get_stats(metrics.rings[i], stats);
+        fprintf(out, METRICS_PREFIX "ring_depth{ring=\"%s\"} %u\n", metrics.ring_names[i], stats->depth);
+        fprintf(out, METRICS_PREFIX "ring_high_water{ring=\"%s\"} %u\n", metrics.ring_names[i], stats->high_water);
+        fprintf(out, METRICS_PREFIX "ring_overflows_total{ring=\"%s\"} %llu\n", metrics.ring_names[i], (unsigned long long)stats->overflows);
+    }
+    if (metrics.spool != nullptr)
+    {
+        gs_spool_stats_t stats[1];
+        gs_spool_get_stats(metrics.spool, stats);
+        fprintf(out, "# HELP " METRICS_PREFIX "spool_depth_frames Frames on disk waiting for the server.\n# TYPE " METRICS_PREFIX "spool_depth_frames gauge\n");
+        fprintf(out, METRICS_PREFIX "spool_depth_frames %llu\n", (unsigned long long)stats->frames);
+        fprintf(out, "# HELP " METRICS_PREFIX "spool_depth_bytes Disk taken by the frames waiting.\n# TYPE " METRICS_PREFIX "spool_depth_bytes gauge\n");
+        fprintf(out, METRICS_PREFIX "spool_depth_bytes %llu\n", (unsigned long long)stats->bytes);
+        fprintf(out, "# HELP " METRICS_PREFIX "spool_segments Spool segment files.\n# TYPE " METRICS_PREFIX "spool_segments gauge\n");
+        fprintf(out, METRICS_PREFIX "spool_segments %u\n", stats->segments);
+        fprintf(out, "# HELP " METRICS_PREFIX "spool_refused_total Frames the spool had no room for, held in memory instead.\n# TYPE " METRICS_PREFIX "spool_refused_total counter\n");
+        fprintf(out, METRICS_PREFIX "spool_refused_total %llu\n", (unsigned long long)stats->refused);
+    }
+    pthread_mutex_unlock(&metrics.lock);
+}
+
+static void metrics_serve(int fd)
+{
+    // curl sends an HTTP request and expects a response header; socat and nc send nothing.
+    char request[1024];
+    bool http = false;
+    struct pollfd pfd = {fd, POLLIN, 0};
+    if (poll(&pfd, 1, METRICS_REQUEST_TIMEOUT_MS) > 0)
+    {
+        ssize_t n = recv(fd, request, sizeof(request) - 1, MSG_DONTWAIT);
+        http = n >= 4 && memcmp(request, "GET ", 4) == 0;
+    }
+
+    FILE *out = fdopen(fd, "w");
+    if (out == nullptr)
+    {
+        close(fd);
+        return;
+    }
+    if (http)
+    {
+        fprintf(out, "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nConnection: close\r\n\r\n");
+    }
+    gs_metrics_render(out);
+    fclose(out);
+}
+
+static void *metrics_thread(void *args)
+{
+    (void)args;
+    while (true)
+    {
+        struct pollfd pfds[2] = {{metrics.listen_fd, POLLIN, 0}, {metrics.stop_pipe[0], POLLIN, 0}};
+        if (poll(pfds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        if (pfds[1].revents)
+        {
+            break;
+        }
+        int fd = accept4(metrics.listen_fd, NULL, NULL, SOCK_CLOEXEC);
+        if (fd >= 0)
+        {
+            metrics_serve(fd);
+        }
+    }
+    return nullptr;
+}
+
+int gs_metrics_start(const char *path)
+{
+    if (metrics.running)
+    {
+        return 1;
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0x0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        dbprintlf(RED_FG "Metrics socket path too long: %s", path);
+        return 0;
+    }
+    strcpy(addr.sun_path, path);
+    strcpy(metrics.path, path);
+
+    metrics.listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (metrics.listen_fd < 0)
+    {
+        dbprintlf(RED_FG "Failed to create the metrics socket.");
+        erprintlf(errno);
+        return 0;
+    }
+    unlink(path);
+    if (bind(metrics.listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(metrics.listen_fd, 4) < 0 ||
+        pipe2(metrics.stop_pipe, O_CLOEXEC) < 0)
+    {
+        dbprintlf(RED_FG "Failed to listen on metrics socket %s.", path);
+        erprintlf(errno);
+        close(metrics.listen_fd);
+        metrics.listen_fd = -1;
+        return 0;
+    }
+
+    if (pthread_create(&metrics.tid, NULL, metrics_thread, NULL) != 0)
+    {
+        dbprintlf(RED_FG "Failed to start the metrics thread.");
+        close(metrics.listen_fd);
+        close(metrics.stop_pipe[0]);
+        close(metrics.stop_pipe[1]);
+        metrics.listen_fd = -1;
+        unlink(path);
+        return 0;
+    }
+
+    metrics.running = true;
+    dbprintlf(GREEN_FG "Serving metrics on %s.", path);
+    return 1;
+}
+
+void gs_metrics_stop(void)
+{
+    if (!metrics.running)
+    {
+        return;
+    }
+
+    char stop = 1;
+    if (write(metrics.stop_pipe[1], &stop, 1) < 0)
+    {
+        dbprintlf(RED_FG "Failed to stop the metrics thread.");
+        return;
+    }
+    pthread_join(metrics.tid, NULL);
+
+    close(metrics.listen_fd);
+    close(metrics.stop_pipe[0]);
+    close(metrics.stop_pipe[1]);
+    metrics.listen_fd = -1;
+    unlink(metrics.path);
+    metrics.running = false;
+}
@@ -0,0 +1,214 @@
+/**
+ * @file gs_modem.cpp
+ * @author agent (agent@local)
+ * @brief Modem profiles switched live between frames, from UHF_CONFIG frames or the adaptive data rate.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "gs_modem.hpp"
+#include "gs_radio.hpp"
+#include "meb_debug.hpp"
+
+static const uint32_t adapt_rates[] = {GS_ADAPT_RATES};
+#define ADAPT_RUNGS (int)(sizeof(adapt_rates) / sizeof(adapt_rates[0]))
+
+gs_modem_ctl_t *gs_modem_create(bool adapt)
+{
+    gs_modem_ctl_t *ctl = (gs_modem_ctl_t *)calloc(1, sizeof(gs_modem_ctl_t));
+    if (ctl == nullptr)
+    {
+        dbprintlf(FATAL "Failed to allocate the modem control.");
+        return nullptr;
+    }
+    ctl->adapt = adapt;
+    ctl->rate.fresh = true;
+    return ctl;
+}
+
+void gs_modem_destroy(gs_modem_ctl_t *ctl)
+{
+    free(ctl);
+}
+
+int gs_modem_parse(const void *buf, ssize_t len, gs_modem_t *modem, int *adapt)
+{
+    gs_modem_config_t config[1];
+    if (buf == nullptr || len != sizeof(gs_modem_config_t))
+    {
+        return 0;
+    }
+    memcpy(config, buf, sizeof(gs_modem_config_t));
+    if ((config->bitrate != 0 && (config->bitrate < GS_MODEM_MIN_BPS || config->bitrate > GS_MODEM_MAX_BPS)) ||
+        config->deviation_hz > GS_MODEM_MAX_DEV_HZ || config->power > GS_MODEM_MAX_POWER || config->adapt > GS_ADAPT_ON)
+    {
+        return 0;
+    }
+    modem->bitrate = config->bitrate;
+    modem->deviation_hz = config->deviation_hz;
+    modem->preamble = config->preamble;
+    modem->power = config->power;
+    *adapt = config->adapt;
+    return 1;
+}
+
+/**
+ * @brief Overlays the nonzero fields of from onto to.
+ */
+static void modem_merge(gs_modem_t *to, const gs_modem_t *from)
+{
+    to->bitrate = from->bitrate ? from->bitrate : to->bitrate;
+    to->deviation_hz = from->deviation_hz ? from->deviation_hz : to->deviation_hz;
+    to->preamble = from->preamble ? from->preamble : to->preamble;
+    to->power = from->power ? from->power : to->power;
+}
+
+static inline bool modem_equal(const gs_modem_t *a, const gs_modem_t *b)
+{
+    return a->bitrate == b->bitrate && a->deviation_hz == b->deviation_hz && a->preamble == b->preamble && a->power == b->power;
+}
+
+void gs_modem_request(gs_modem_ctl_t *ctl, const gs_modem_t *modem, int adapt, uint64_t now_ns)
+{
+    gs_modem_t want = ctl->want;
+    modem_merge(&want, modem);
+    if (!modem_equal(&want, &ctl->want))
+    {
+        // A new data rate starts a new window: the last one was judged at the old rate.
+        ctl->rate.fresh = ctl->rate.fresh || want.bitrate != ctl->want.bitrate;
+        ctl->want = want;
+        ctl->asked_ns = now_ns;
+        ctl->kick = true;
+    }
+    if (adapt != GS_ADAPT_KEEP && ctl->adapt != (adapt == GS_ADAPT_ON))
+    {
+        ctl->adapt = adapt == GS_ADAPT_ON;
+        ctl->rate.fresh = true;
+        ctl->kick = true;
+    }
+}
+
+void gs_modem_forget(gs_modem_ctl_t *ctl)
+{
+    memset(&ctl->want, 0x0, sizeof(gs_modem_t));
+    ctl->asked_ns = 0;
+    ctl->adapt = false;
+    ctl->stats.rejected++;
+}
+
+int gs_modem_apply(gs_modem_ctl_t *ctl, gs_radio_t *radio)
+{
+    gs_modem_t to = radio->modem;
+    modem_merge(&to, &ctl->want);
+    if (modem_equal(&to, &radio->modem))
+    {
+        return 0;
+    }
+    int retval = gs_radio_try_configure(radio, &to);
+    if (retval < 0)
+    {
+        ctl->stats.deferred++;
+        return -1;
+    }
+    else if (retval == 0)
+    {
+        return -2;
+    }
+    ctl->stats.switches++;
+    return 1;
+}
+
+uint64_t gs_modem_settle(gs_modem_ctl_t *ctl, uint64_t now_ns)
+{
+    uint64_t latency = now_ns > ctl->asked_ns ? now_ns - ctl->asked_ns : 0;
+    ctl->asked_ns = 0;
+    ctl->stats.settled++;
+    ctl->stats.switch_sum_ns += latency;
+    ctl->stats.switch_max_ns = latency > ctl->stats.switch_max_ns ? latency : ctl->stats.switch_max_ns;
+    return latency;
+}
+
+double gs_adapt_need_dbm(uint32_t bitrate)
+{
+    return GS_ADAPT_N0_DBM_HZ + 10 * log10((double)bitrate) + GS_ADAPT_EBN0_DB;
+}
+
+uint32_t gs_adapt_window(gs_adapt_t *adapt, uint32_t bitrate, const gs_link_t *link)
+{
+    if (adapt->fresh)
+    {
+        adapt->since = *link;
+        adapt->clean = 0;
+        adapt->silent = 0;
+        adapt->fresh = false;
+        return 0;
+    }
+
+    // The highest rung at or below the rate in effect, -1 below the ladder.
+    int rung = -1;
+    while (rung + 1 < ADAPT_RUNGS && adapt_rates[rung + 1] <= bitrate)
+    {
+        rung++;
+    }
+    uint32_t down = rung < 0 ? 0 : adapt_rates[rung] < bitrate ? adapt_rates[rung] : rung > 0 ? adapt_rates[rung - 1] : 0;
+    uint32_t up = rung + 1 < ADAPT_RUNGS ? adapt_rates[rung + 1] : 0;
+
+    uint64_t good = link->good - adapt->since.good;
+    uint64_t bad = link->bad - adapt->since.bad;
+    uint32_t to = 0;
+    if (good + bad < GS_ADAPT_MIN_FRAMES)
+    {
+        // Too few to judge; carried into the next window. Nothing at all may mean the rate no longer gets through.
+        adapt->silent = good + bad == 0 ? adapt->silent + 1 : 0;
+        if (adapt->silent < GS_ADAPT_SILENT_WINDOWS || down == 0)
+        {
+            return 0;
+        }
+        to = down;
+    }
+    else
+    {
+        double err = (double)bad / (good + bad);
+        double rssi = good ? (double)(link->rssi_sum - adapt->since.rssi_sum) / good : -INFINITY;
+        if ((err > GS_ADAPT_DOWN_ERR || rssi < gs_adapt_need_dbm(bitrate)) && down != 0)
+        {
+            to = down;
+        }
+        else if (err <= GS_ADAPT_UP_ERR && up != 0 && rssi >= gs_adapt_need_dbm(up) + GS_ADAPT_MARGIN_DB)
+        {
+            to = ++adapt->clean >= GS_ADAPT_UP_WINDOWS ? up : 0;
+        }
+        else
+        {
+            adapt->clean = 0;
+        }
+        adapt->silent = 0;
+        adapt->since = *link;
+    }
+
+    if (to != 0)
+    {
+        adapt->ups += to > bitrate;
+        adapt->downs += to < bitrate;
+        adapt->clean = 0;
+        adapt->silent = 0;
+        adapt->since = *link;
+    }
+    return to;
+}
+
+void gs_modem_print(const gs_modem_ctl_t *ctl)
+{
+    const gs_modem_stats_t *stats = &ctl->stats;
+    dbprintlf(CYAN_FG "Modem: %llu UHF_CONFIG (%llu rejected), %llu switches (%llu put off), settled in %.1f ms on average and %.1f ms at most; data rate stepped up %llu and down %llu times.",
+              (unsigned long long)stats->configs, (unsigned long long)stats->rejected, (unsigned long long)stats->switches,
+              (unsigned long long)stats->deferred, stats->settled ? stats->switch_sum_ns / 1e6 / stats->settled : 0.0, stats->switch_max_ns / 1e6,
+              (unsigned long long)ctl->rate.ups, (unsigned long long)ctl->rate.downs);
+}
@@ -0,0 +1,341 @@
+/**
+ * @file gs_pass.cpp
+ * @author agent (agent@local)
+ * @brief Pass prediction from TLEs, cached between element set updates, and the gate that idles the radio threads between passes.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include "gs_pass.hpp"
+#include "meb_debug.hpp"
+
+#define PASS_BACK_MAX_S 3600 // How far back from the start of a search an AOS is looked for.
+#define PASS_GOLDEN 0.6180339887498949
+
+static double pass_el(const gs_sgp4_t *sat, const gs_station_t *station, double t, uint64_t *propagations)
+{
+    gs_look_t look;
+    if (propagations != nullptr)
+    {
+        (*propagations)++;
+    }
+    return gs_sgp4_look(sat, station, t, &look) ? look.el : -M_PI / 2;
+}
+
+/**
+ * @brief Bisects a horizon crossing between two times on either side of it.
+ */
+static double pass_cross(const gs_sgp4_t *sat, const gs_station_t *station, double min_el, double lo, double hi, uint64_t *propagations)
+{
+    bool rising = pass_el(sat, station, lo, propagations) < min_el;
+    while (hi - lo > GS_PASS_TOL_S)
+    {
+        double mid = (lo + hi) / 2;
+        if ((pass_el(sat, station, mid, propagations) >= min_el) == rising)
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid;
+        }
+    }
+    return (lo + hi) / 2;
+}
+
+/**
+ * @brief Fills in a pass's highest point (golden section search, elevation has one peak per pass) and azimuths.
+ */
+static void pass_finish(const gs_sgp4_t *sat, const gs_station_t *station, gs_pass_t *pass, uint64_t *propagations)
+{
+    double a = pass->aos, b = pass->los;
+    double c = b - PASS_GOLDEN * (b - a), d = a + PASS_GOLDEN * (b - a);
+    double fc = pass_el(sat, station, c, propagations), fd = pass_el(sat, station, d, propagations);
+    while (b - a > GS_PASS_TOL_S)
+    {
+        if (fc > fd)
+        {
+            b = d;
+            d = c;
+            fd = fc;
+            c = b - PASS_GOLDEN * (b - a);
+            fc = pass_el(sat, station, c, propagations);
+        }
+        else
+        {
+            a = c;
+            c = d;
+            fc = fd;
+            d = a + PASS_GOLDEN * (b - a);
+            fd = pass_el(sat, station, d, propagations);
+        }
+    }
+    pass->tca = (a + b) / 2;
+    pass->max_el = pass_el(sat, station, pass->tca, propagations);
+
+    gs_look_t look;
+    pass->aos_az = gs_sgp4_look(sat, station, pass->aos, &look) ? look.az : 0;
+    pass->los_az = gs_sgp4_look(sat, station, pass->los, &look) ? look.az : 0;
+}
+
+int gs_pass_find(const gs_sgp4_t *sat, const gs_station_t *station, double min_el, double from, double to, gs_pass_t *passes, int max,
+                 uint64_t *propagations)
+{
+    int count = 0;
+    double t = from;
+    bool in_pass = pass_el(sat, station, t, propagations) >= min_el;
+    double aos = from;
+    if (in_pass)
+    {
+        // Already up: find where the pass began.
+        double back = from;
+        while (back > from - PASS_BACK_MAX_S && pass_el(sat, station, back - GS_PASS_STEP_S, propagations) >= min_el)
+        {
+            back -= GS_PASS_STEP_S;
+        }
+        aos = pass_cross(sat, station, min_el, back - GS_PASS_STEP_S, back, propagations);
+    }
+
+    while (count < max && (in_pass || t <= to))
+    {
+        double next = t + GS_PASS_STEP_S;
+        bool up = pass_el(sat, station, next, propagations) >= min_el;
+        if (!in_pass && up)
+        {
+            aos = pass_cross(sat, station, min_el, t, next, propagations);
+            in_pass = true;
+        }
+        else if (in_pass && !up)
+        {
+            gs_pass_t *pass = &passes[count++];
+            pass->aos = aos;
+            pass->los = pass_cross(sat, station, min_el, t, next, propagations);
+            pass_finish(sat, station, pass, propagations);
+            in_pass = false;
+        }
+        t = next;
+        if (in_pass && t > to + PASS_BACK_MAX_S)
+        {
+            // Never set (a geostationary mistake in the TLE file); not a pass.
+            break;
+        }
+    }
+    return count;
+}
+
+gs_pass_plan_t *gs_pass_plan_create(const gs_station_t *station, double min_el, double horizon_s)
+{
+    gs_pass_plan_t *plan = (gs_pass_plan_t *)calloc(1, sizeof(gs_pass_plan_t));
+    if (plan == nullptr)
+    {
+        dbprintlf(FATAL "Failed to allocate the pass plan.");
+        return nullptr;
+    }
+    plan->station = *station;
+    gs_sgp4_station(&plan->station);
+    plan->min_el = min_el;
+    plan->horizon_s = horizon_s;
+    plan->gate.open = true;
+    pthread_mutex_init(&plan->gate.lock, NULL);
+    pthread_cond_init(&plan->gate.cond, NULL);
+    return plan;
+}
+
+void gs_pass_plan_destroy(gs_pass_plan_t *plan)
+{
+    if (plan == nullptr)
+    {
+        return;
+    }
+    pthread_mutex_destroy(&plan->gate.lock);
+    pthread_cond_destroy(&plan->gate.cond);
+    free(plan);
+}
+
+/**
+ * @brief Predicts the passes from one time to another onto the end of the plan.
+ */
+static void plan_predict(gs_pass_plan_t *plan, double from, double to)
+{
+    gs_pass_t found[GS_PASS_MAX];
+    int n = gs_pass_find(&plan->sat, &plan->station, plan->min_el, from, to, found, GS_PASS_MAX, &plan->stats.propagations);
+    for (int i = 0; i < n && plan->count < GS_PASS_MAX; i++)
+    {
+        // A pass in progress at from was predicted whole by the stretch before.
+        if (plan->count > 0 && found[i].aos < plan->passes[plan->count - 1].los)
+        {
+            continue;
+        }
+        plan->passes[plan->count++] = found[i];
+    }
+    plan->stats.predictions++;
+    plan->stats.predicted_s += to - from;
+    plan->until = to;
+}
+
+int gs_pass_plan_set(gs_pass_plan_t *plan, const gs_tle_t *tle, double now)
+{
+    if (plan->have_sat && plan->sat.tle.catnum == tle->catnum && plan->sat.tle.epoch == tle->epoch)
+    {
+        plan->stats.unchanged++;
+        return 0;
+    }
+    gs_sgp4_t sat[1];
+    if (!gs_sgp4_init(sat, tle))
+    {
+        dbprintlf(RED_FG "Element set for %d (%s) cannot be propagated with SGP4 (deep space or malformed).", tle->catnum, tle->name);
+        return 0;
+    }
+    plan->sat = *sat;
+    plan->have_sat = true;
+    plan->stats.loads++;
+
+    // Passes that are over stay as they were; the rest, the one in progress included, are predicted again.
+    while (plan->count > 0 && plan->passes[plan->count - 1].los > now)
+    {
+        plan->count--;
+    }
+    plan_predict(plan, now, now + plan->horizon_s);
+    dbprintlf(GREEN_FG "Element set for %d %s (epoch %.1f days ago): %d passes in the next %.0f h.", tle->catnum, tle->name, (now - tle->epoch) / 86400,
+              plan->count, plan->horizon_s / 3600);
+    return 1;
+}
+
+int gs_pass_plan_reload(gs_pass_plan_t *plan, const char *path, int catnum, double now)
+{
+    if (path != nullptr)
+    {
+        snprintf(plan->path, sizeof(plan->path), "%s", path);
+        plan->catnum = catnum;
+        memset(&plan->mtime, 0x0, sizeof(plan->mtime));
+    }
+    struct stat st;
+    if (stat(plan->path, &st) < 0)
+    {
+        erprintlf(errno);
+        return -1;
+    }
+    if (plan->have_sat && st.st_mtim.tv_sec == plan->mtime.tv_sec && st.st_mtim.tv_nsec == plan->mtime.tv_nsec)
+    {
+        return 0;
+    }
+    FILE *fp = fopen(plan->path, "r");
+    if (fp == nullptr)
+    {
+        erprintlf(errno);
+        return -1;
+    }
+
+    // Lines are kept three deep: a name, if any, then lines 1 and 2.
+    char lines[3][GS_TLE_LINE_MAX + 8] = {"", "", ""};
+    gs_tle_t tle[1];
+    bool found = false;
+    while (!found && fgets(lines[2], sizeof(lines[2]), fp) != nullptr)
+    {
+        lines[2][strcspn(lines[2], "\r\n")] = '\0';
+        const char *name = lines[0][0] != '\0' && strncmp(lines[0], "1 ", 2) != 0 && strncmp(lines[0], "2 ", 2) != 0 ? lines[0] : nullptr;
+        if (strncmp(lines[1], "1 ", 2) == 0 && strncmp(lines[2], "2 ", 2) == 0 && gs_tle_parse(name, lines[1], lines[2], tle))
+        {
+            found = plan->catnum == 0 || tle->catnum == plan->catnum;
+        }
+        memcpy(lines[0], lines[1], sizeof(lines[0]));
+        memcpy(lines[1], lines[2], sizeof(lines[1]));
+    }
+    fclose(fp);
+    if (!found)
+    {
+        dbprintlf(RED_FG "No usable element set%s in %s.", plan->catnum ? " for the spacecraft" : "", plan->path);
+        return -1;
+    }
+    plan->mtime = st.st_mtim;
+    return gs_pass_plan_set(plan, tle, now);
+}
+
+void gs_pass_plan_update(gs_pass_plan_t *plan, double now)
+{
+    int over = 0;
+    while (over < plan->count && plan->passes[over].los < now)
+    {
+        over++;
+    }
+    if (over > 0)
+    {
+        memmove(plan->passes, plan->passes + over, (plan->count - over) * sizeof(gs_pass_t));
+        plan->count -= over;
+    }
+    if (plan->have_sat && plan->until < now + plan->horizon_s)
+    {
+        plan_predict(plan, plan->until > now ? plan->until : now, now + plan->horizon_s);
+    }
+}
+
+const gs_pass_t *gs_pass_plan_next(const gs_pass_plan_t *plan, double t)
+{
+    for (int i = 0; i < plan->count; i++)
+    {
+        if (plan->passes[i].los > t)
+        {
+            return &plan->passes[i];
+        }
+    }
+    return nullptr;
+}
+
+void gs_pass_plan_print(const gs_pass_plan_t *plan)
+{
+    dbprintlf(CYAN_FG "Passes: %d predicted to %.0f s from now; %llu element sets (%llu unchanged), %llu predictions over %.1f h of orbit, %llu propagations.",
+              plan->count, plan->until - gs_pass_now(), (unsigned long long)plan->stats.loads, (unsigned long long)plan->stats.unchanged,
+              (unsigned long long)plan->stats.predictions, plan->stats.predicted_s / 3600, (unsigned long long)plan->stats.propagations);
+    for (int i = 0; i < plan->count; i++)
+    {
+        const gs_pass_t *pass = &plan->passes[i];
+        char aos[32];
+        time_t t = (time_t)pass->aos;
+        struct tm tm;
+        strftime(aos, sizeof(aos), "%Y-%m-%d %H:%M:%S", gmtime_r(&t, &tm));
+        printf("    AOS %s UTC, %4.0f s, max el %4.1f deg, az %3.0f to %3.0f deg\n", aos, pass->los - pass->aos, pass->max_el * 180 / M_PI,
+               pass->aos_az * 180 / M_PI, pass->los_az * 180 / M_PI);
+    }
+}
+
+double gs_pass_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void gs_pass_gate_set(gs_pass_plan_t *plan, bool open)
+{
+    pthread_mutex_lock(&plan->gate.lock);
+    __atomic_store_n(&plan->gate.open, open, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&plan->gate.cond);
+    pthread_mutex_unlock(&plan->gate.lock);
+}
+
+void gs_pass_gate_wait(gs_pass_plan_t *plan)
+{
+    pthread_mutex_lock(&plan->gate.lock);
+    while (!__atomic_load_n(&plan->gate.open, __ATOMIC_ACQUIRE) && !plan->gate.stopped)
+    {
+        pthread_cond_wait(&plan->gate.cond, &plan->gate.lock);
+    }
+    pthread_mutex_unlock(&plan->gate.lock);
+}
+
+void gs_pass_gate_stop(gs_pass_plan_t *plan)
+{
+    pthread_mutex_lock(&plan->gate.lock);
+    plan->gate.stopped = true;
+    pthread_cond_broadcast(&plan->gate.cond);
+    pthread_mutex_unlock(&plan->gate.lock);
+}
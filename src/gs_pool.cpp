@@ -0,0 +1,179 @@
+/**
+ * @file gs_pool.cpp
+ * @author agent (agent@local)
+ * @brief Fixed-capacity block pools for NetFrames and payload buffers.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include "gs_pool.hpp"
+#include "meb_debug.hpp"
+
+gs_pool_t *gs_pool_create(const char *name, size_t block_size, uint32_t capacity)
+{
+    gs_pool_t *pool = (gs_pool_t *)calloc(1, sizeof(gs_pool_t));
+    if (pool == nullptr)
+    {
+        dbprintlf(FATAL "Failed to allocate %s pool.", name);
+        return nullptr;
+    }
+
+    pool->name = name;
+    pool->block_size = (block_size + POOL_BLOCK_ALIGN - 1) & ~((size_t)POOL_BLOCK_ALIGN - 1);
+    pool->capacity = capacity;
+
+    if (posix_memalign((void **)&pool->blocks, POOL_BLOCK_ALIGN, pool->block_size * capacity) != 0 ||
+        (pool->free_list = (void **)malloc(capacity * sizeof(void *))) == nullptr)
+    {
+        dbprintlf(FATAL "Failed to allocate %u blocks of %zu bytes for %s pool.", capacity, pool->block_size, name);
+        free(pool->blocks);
+        free(pool);
+        return nullptr;
+    }
+    // Touch every block now so borrowing one never page-faults.
+    memset(pool->blocks, 0x0, pool->block_size * capacity);
+
+    for (uint32_t i = 0; i < capacity; i++)
+    {
+        pool->free_list[i] = pool->blocks + (capacity - 1 - i) * pool->block_size;
+    }
+    pool->free_count = capacity;
+    pthread_mutex_init(&pool->lock, NULL);
+
+    return pool;
+}
+
+void gs_pool_destroy(gs_pool_t *pool)
+{
+    if (pool == nullptr)
+    {
+        return;
+    }
+    if (pool->free_count != pool->capacity)
+    {
+        dbprintlf(RED_FG "%s pool destroyed with %u blocks still borrowed.", pool->name, pool->capacity - pool->free_count);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->free_list);
+    free(pool->blocks);
+    free(pool);
+}
+
+static inline bool pool_owns(gs_pool_t *pool, void *block)
+{
+    return (uint8_t *)block >= pool->blocks && (uint8_t *)block < pool->blocks + pool->block_size * pool->capacity;
+}
+
+void *gs_pool_get(gs_pool_t *pool)
+{
+    void *block = nullptr;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->gets++;
+    if (pool->free_count > 0)
+    {
+        block = pool->free_list[--pool->free_count];
+        uint32_t in_use = pool->capacity - pool->free_count;
+        if (in_use > pool->high_water)
+        {
+            pool->high_water = in_use;
+        }
+    }
+    else
+    {
+        pool->misses++;
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    if (block == nullptr)
+    {
+        // Better a heap allocation than a lost frame; the miss counter says the pool needs to grow.
+        if (posix_memalign(&block, POOL_BLOCK_ALIGN, pool->block_size) != 0)
+        {
+            dbprintlf(FATAL "%s pool is empty and the heap is exhausted.", pool->name);
+            return nullptr;
+        }
+    }
+
+    return block;
+}
+
+void gs_pool_put(gs_pool_t *pool, void *block)
+{
+    if (block == nullptr)
+    {
+        return;
+    }
+
+    if (!pool_owns(pool, block))
+    {
+        free(block);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->free_list[pool->free_count++] = block;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+size_t gs_pool_block_size(gs_pool_t *pool)
+{
+    return pool->block_size;
+}
+
+void gs_pool_get_stats(gs_pool_t *pool, gs_pool_stats_t *stats)
+{
+    pthread_mutex_lock(&pool->lock);
+    stats->capacity = pool->capacity;
+    stats->in_use = pool->capacity - pool->free_count;
+    stats->high_water = pool->high_water;
+    stats->gets = pool->gets;
+    stats->misses = pool->misses;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void gs_pool_print_stats(gs_pool_t *pool)
+{
+    gs_pool_stats_t stats[1];
+    gs_pool_get_stats(pool, stats);
+    dbprintlf(CYAN_FG "%s pool: %u/%u in use, high-water %u, %llu gets, %llu misses.",
+              pool->name, stats->in_use, stats->capacity, stats->high_water,
+              (unsigned long long)stats->gets, (unsigned long long)stats->misses);
+}
+
+NetFrame *gs_pool_netframe(gs_pool_t *pool)
+{
+    void *block = gs_pool_get(pool);
+    if (block == nullptr)
+    {
+        return nullptr;
+    }
+    return new (block) NetFrame();
+}
+
+NetFrame *gs_pool_netframe(gs_pool_t *pool, unsigned char *payload, ssize_t size, NetType type, NetVertex destination)
+{
+    void *block = gs_pool_get(pool);
+    if (block == nullptr)
+    {
+        return nullptr;
+    }
+    return new (block) NetFrame(payload, size, type, destination);
+}
+
+void gs_pool_netframe_put(gs_pool_t *pool, NetFrame *frame)
+{
+    if (frame == nullptr)
+    {
+        return;
+    }
+    frame->~NetFrame();
+    gs_pool_put(pool, frame);
+}
@@ -0,0 +1,412 @@
+/**
+ * @file gs_radio.cpp
+ * @author agent (agent@local)
+ * @brief libsi446x backend for the radio abstraction layer.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <limits.h>
+#include <sys/epoll.h>
+#include <sys/wait.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+#include <si446x.h>
+#include "gs_radio.hpp"
+#include "gs_time.hpp"
+#include "meb_debug.hpp"
+
+typedef struct
+{
+    int irq_fd; // GPIO line event descriptor for nIRQ, -1 if unavailable.
+} si446x_radio_t;
+
+static bool si446x_taken; // libsi446x drives one device, see gs_radio_si446x_create().
+
+/**
+ * @brief Claims the si446x nIRQ line as a falling-edge event source through the GPIO character device.
+ * 
+ * @return int The line event descriptor, or -1.
+ */
+static int si446x_irq_open(void)
+{
+    int chip_fd = open(UHF_IRQ_GPIOCHIP, O_RDONLY | O_CLOEXEC);
+    if (chip_fd < 0)
+    {
+        dbprintlf(YELLOW_FG "Cannot open %s, falling back to polled receive.", UHF_IRQ_GPIOCHIP);
+        erprintlf(errno);
+        return -1;
+    }
+
+    struct gpioevent_request req;
+    memset(&req, 0x0, sizeof(req));
+    req.lineoffset = UHF_IRQ_LINE;
+    req.handleflags = GPIOHANDLE_REQUEST_INPUT;
+    req.eventflags = GPIOEVENT_REQUEST_FALLING_EDGE;
+    strncpy(req.consumer_label, "gs_uhf_nirq", sizeof(req.consumer_label) - 1);
+
+    int retval = ioctl(chip_fd, GPIO_GET_LINEEVENT_IOCTL, &req);
+    close(chip_fd);
+    if (retval < 0)
+    {
+        dbprintlf(YELLOW_FG "Cannot claim nIRQ line %d, falling back to polled receive.", UHF_IRQ_LINE);
+        erprintlf(errno);
+        return -1;
+    }
+
+    // Reads must never block the receive path.
+    fcntl(req.fd, F_SETFL, fcntl(req.fd, F_GETFL) | O_NONBLOCK);
+    dbprintlf(GREEN_FG "Waiting on si446x nIRQ (%s line %d).", UHF_IRQ_GPIOCHIP, UHF_IRQ_LINE);
+    return req.fd;
+}
+
+#ifndef UHF_NOT_CONNECTED_DEBUG
+/**
+ * @brief Runs si446x_init() in the UHF_INIT_PROBE_PATH helper first, since it calls exit() on failure.
+ * 
+ * The helper is a process of its own (posix_spawn(), not a fork of this multithreaded one), and its init is
+ * thrown away with it; only whether it survived counts. A failure on the radio's side (SPI, the chip not
+ * answering) then costs an attempt instead of the ground station.
+ * 
+ * @return bool True if the helper's init succeeded, so ours should too.
+ */
+static bool si446x_probe(void)
+{
+    // The helper is installed next to the daemon, wherever it is started from.
+    char path[PATH_MAX];
+    ssize_t len = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    char *slash = len > 0 ? (char *)memrchr(path, '/', len) : nullptr;
+    if (slash == nullptr || (slash - path) + 1 + sizeof(UHF_INIT_PROBE_PATH) > sizeof(path))
+    {
+        dbprintlf(YELLOW_FG "Cannot find the si446x probe helper, initializing without the safety net.");
+        return true;
+    }
+    memcpy(slash + 1, UHF_INIT_PROBE_PATH, sizeof(UHF_INIT_PROBE_PATH));
+
+    char *argv[] = {path, nullptr};
+    pid_t pid;
+    int err = posix_spawn(&pid, path, nullptr, nullptr, argv, environ);
+    if (err != 0)
+    {
+        dbprintlf(YELLOW_FG "Cannot start %s to probe the si446x, initializing without the safety net.", path);
+        erprintlf(err);
+        return true;
+    }
+
+    int status = 0;
+    uint64_t deadline = gs_time_ns() + UHF_INIT_PROBE_TIMEOUT_MS * NSEC_PER_MSEC;
+    pid_t done;
+    while ((done = waitpid(pid, &status, WNOHANG)) == 0 && gs_time_ns() < deadline)
+    {
+        usleep(1000);
+    }
+    if (done == 0)
+    {
+        dbprintlf(RED_FG "si446x_init() hung for %d ms in the probe.", UHF_INIT_PROBE_TIMEOUT_MS);
+        kill(pid, SIGKILL);
+        waitpid(pid, &status, 0);
+        return false;
+    }
+    if (done < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        dbprintlf(RED_FG "si446x_init() failed in the probe (status 0x%x).", status);
+        return false;
+    }
+    return true;
+}
+#endif
+
+static int si446x_backend_init(gs_radio_t *radio)
+{
+    si446x_radio_t *si = (si446x_radio_t *)radio->priv;
+
+    // si446x_init() calls exit() on failure, so it is only called here once it has worked in the probe helper.
+    // TODO: COMMENT OUT FOR DEBUGGING PURPOSES ONLY
+#ifndef UHF_NOT_CONNECTED_DEBUG
+    if (!si446x_probe())
+    {
+        return 0;
+    }
+    si446x_init();
+#endif
+    dbprintlf(GREEN_FG "si446x_init() successful!");
+
+#ifndef UHF_NOT_CONNECTED_DEBUG
+    if (si->irq_fd < 0)
+    {
+        si->irq_fd = si446x_irq_open();
+    }
+#else
+    (void)si;
+#endif
+    return 1;
+}
+
+static int si446x_backend_get_info(gs_radio_t *radio, gs_radio_info_t *info)
+{
+    (void)radio;
+    memset(info, 0x0, sizeof(gs_radio_info_t));
+#ifndef UHF_NOT_CONNECTED_DEBUG
+    si446x_info_t si_info[1];
+    memset(si_info, 0x0, sizeof(si446x_info_t));
+    si446x_getInfo(si_info);
+    info->chip_rev = si_info->chipRev;
+    info->part = si_info->part;
+    info->id = si_info->id;
+    info->rom_id = si_info->romId;
+#else
+    info->part = RADIO_PART_MASK;
+#endif
+    return 1;
+}
+
+static void si446x_backend_en_pipe(gs_radio_t *radio)
+{
+    (void)radio;
+    // TODO: COMMENT OUT FOR DEBUGGING PURPOSES ONLY
+#ifndef UHF_NOT_CONNECTED_DEBUG
+    si446x_en_pipe();
+#endif
+}
+
+static ssize_t si446x_backend_read(gs_radio_t *radio, void *buf, ssize_t len, int16_t *rssi)
+{
+    (void)radio;
+#ifndef UHF_NOT_CONNECTED_DEBUG
+    return si446x_read(buf, len, rssi);
+#else
+    (void)buf;
+    (void)len;
+    (void)rssi;
+    return 0;
+#endif
+}
+
+static ssize_t si446x_backend_write(gs_radio_t *radio, void *buf, ssize_t len)
+{
+    (void)radio;
+#ifndef UHF_NOT_CONNECTED_DEBUG
+    return si446x_write(buf, len);
+#else
+    (void)buf;
+    return len;
+#endif
+}
+
+static int si446x_backend_sleep(gs_radio_t *radio)
+{
+    (void)radio;
+#ifndef UHF_NOT_CONNECTED_DEBUG
+    return si446x_sleep();
+#else
+    return 1;
+#endif
+}
+
+/**
+ * @brief libsi446x only sets the PA level; the data rate, deviation and preamble are compiled into its
+ * radio_config.h, so a profile that changes them is refused. The PA level only matters to the transmitter, so
+ * it is set whatever is arriving.
+ */
+static int si446x_backend_configure(gs_radio_t *radio, const gs_modem_t *modem)
+{
+    if (modem->bitrate != radio->modem.bitrate || modem->deviation_hz != radio->modem.deviation_hz || modem->preamble != radio->modem.preamble)
+    {
+        return 0;
+    }
+#ifndef UHF_NOT_CONNECTED_DEBUG
+    si446x_setTxPower(modem->power);
+#endif
+    return 1;
+}
+
+static void si446x_backend_destroy(gs_radio_t *radio)
+{
+    si446x_radio_t *si = (si446x_radio_t *)radio->priv;
+    if (si->irq_fd >= 0)
+    {
+        close(si->irq_fd);
+    }
+    __atomic_store_n(&si446x_taken, false, __ATOMIC_RELEASE);
+    free(si);
+    free(radio);
+}
+
+static int si446x_backend_irq_fd(gs_radio_t *radio)
+{
+    si446x_radio_t *si = (si446x_radio_t *)radio->priv;
+    return si->irq_fd;
+}
+
+static int si446x_backend_irq_ack(gs_radio_t *radio, uint64_t *irq_ns)
+{
+    si446x_radio_t *si = (si446x_radio_t *)radio->priv;
+    struct gpioevent_data event;
+    int events = 0;
+
+    *irq_ns = 0;
+    while (read(si->irq_fd, &event, sizeof(event)) == sizeof(event))
+    {
+        events++;
+        *irq_ns = event.timestamp;
+    }
+
+    // Older kernels stamp line events with CLOCK_REALTIME; only trust stamps that look monotonic.
+    uint64_t now = gs_time_ns();
+    if (*irq_ns > now || now - *irq_ns > NSEC_PER_SEC)
+    {
+        *irq_ns = now;
+    }
+
+    return events > 0 ? 1 : 0;
+}
+
+static const gs_radio_ops_t si446x_ops = {
+    "si446x",
+    si446x_backend_init,
+    si446x_backend_get_info,
+    si446x_backend_en_pipe,
+    si446x_backend_read,
+    si446x_backend_write,
+    si446x_backend_sleep,
+    si446x_backend_destroy,
+    si446x_backend_irq_fd,
+    si446x_backend_irq_ack,
+    nullptr, // libsi446x resets the chip and uploads its whole configuration in si446x_init(), and offers no way to re-apply it alone.
+    nullptr, // Nor a way to set FREQ_CONTROL on its own, so no Doppler correction.
+    si446x_backend_configure,
+};
+
+gs_radio_t *gs_radio_alloc(const gs_radio_ops_t *ops, void *priv)
+{
+    gs_radio_t *radio = (gs_radio_t *)calloc(1, sizeof(gs_radio_t));
+    if (radio == nullptr)
+    {
+        dbprintlf(FATAL "Failed to allocate radio.");
+        return nullptr;
+    }
+    radio->ops = ops;
+    radio->priv = priv;
+    radio->irq_epfd = -1;
+    radio->irq_epfd_watching = -1;
+    radio->irq_stats.latency_min_ns = UINT64_MAX;
+    gs_arbiter_init(&radio->arbiter);
+    return radio;
+}
+
+gs_radio_t *gs_radio_si446x_create(void)
+{
+    if (__atomic_exchange_n(&si446x_taken, true, __ATOMIC_ACQ_REL))
+    {
+        dbprintlf(FATAL "libsi446x drives a single device, which is already in use.");
+        return nullptr;
+    }
+
+    si446x_radio_t *si = (si446x_radio_t *)calloc(1, sizeof(si446x_radio_t));
+    if (si == nullptr)
+    {
+        dbprintlf(FATAL "Failed to allocate radio.");
+        return nullptr;
+    }
+    si->irq_fd = -1;
+
+    gs_radio_t *radio = gs_radio_alloc(&si446x_ops, si);
+    if (radio == nullptr)
+    {
+        free(si);
+        __atomic_store_n(&si446x_taken, false, __ATOMIC_RELEASE);
+    }
+    return radio;
+}
+
+int gs_radio_irq_wait(gs_radio_t *radio, int timeout_ms, uint64_t *irq_ns)
+{
+    *irq_ns = 0;
+
+    int fd = radio->ops->irq_fd(radio);
+    if (fd < 0)
+    {
+        if (timeout_ms > 0)
+        {
+            usleep(timeout_ms * 1000 < UHF_IRQ_FALLBACK_US ? timeout_ms * 1000 : UHF_IRQ_FALLBACK_US);
+        }
+        return 0;
+    }
+
+    if (radio->irq_epfd < 0 || radio->irq_epfd_watching != fd)
+    {
+        if (radio->irq_epfd < 0)
+        {
+            radio->irq_epfd = epoll_create1(EPOLL_CLOEXEC);
+            if (radio->irq_epfd < 0)
+            {
+                erprintlf(errno);
+                return -1;
+            }
+        }
+        else
+        {
+            epoll_ctl(radio->irq_epfd, EPOLL_CTL_DEL, radio->irq_epfd_watching, NULL);
+        }
+
+        struct epoll_event ev;
+        memset(&ev, 0x0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (epoll_ctl(radio->irq_epfd, EPOLL_CTL_ADD, fd, &ev) < 0)
+        {
+            erprintlf(errno);
+            return -1;
+        }
+        radio->irq_epfd_watching = fd;
+    }
+
+    struct epoll_event ev;
+    int nfds = epoll_wait(radio->irq_epfd, &ev, 1, timeout_ms);
+    if (nfds < 0)
+    {
+        return errno == EINTR ? 0 : -1;
+    }
+    else if (nfds == 0)
+    {
+        return 0;
+    }
+
+    return gs_radio_irq_ack(radio, irq_ns);
+}
+
+int gs_radio_irq_ack(gs_radio_t *radio, uint64_t *irq_ns)
+{
+    radio->irq_stats.wakeups++;
+    int ready = radio->ops->irq_ack(radio, irq_ns);
+    if (!ready)
+    {
+        radio->irq_stats.spurious++;
+    }
+    return ready;
+}
+
+void gs_radio_destroy(gs_radio_t *radio)
+{
+    if (radio == nullptr)
+    {
+        return;
+    }
+    if (radio->irq_epfd >= 0)
+    {
+        close(radio->irq_epfd);
+    }
+    gs_arbiter_destroy(&radio->arbiter);
+    radio->ops->destroy(radio);
+}
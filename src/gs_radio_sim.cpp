@@ -0,0 +1,1164 @@
+/**
+ * @file gs_radio_sim.cpp
+ * @author agent (agent@local)
+ * @brief Simulated radio backend: an in-process socketpair "air" with configurable impairments.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include "gs_radio.hpp"
+#include "gs_time.hpp"
+#include "gs_uhf.hpp"
+#include "gs_sar.hpp"
+#include "gs_crc.hpp"
+#include "gs_lz.hpp"
+#include "meb_debug.hpp"
+
+#define SIM_PART 0x4463
+#define SIM_BEACON_MOD 0xbe // cmd_output_t.mod used by the simulated spacecraft's beacon.
+#define SIM_IDLE_POLL_MS 100
+#define SIM_SAR_MAX_MESSAGE 16384 // Largest multi-frame message the simulated spacecraft reassembles.
+#define SIM_ECHO_QUEUE 4 // Reassembled messages waiting to be echoed while an earlier echo is on the air.
+
+// Only crosses the in-process air socketpair, so it is not packed: the header's fields are in alignment order
+// and the RX thread reads straight into them.
+typedef struct
+{
+    uint64_t deliver_ns; // Receiver must not see the frame before this time.
+    int16_t rssi;
+    uint16_t len;
+    uint8_t data[SIM_MAX_AIR_FRAME];
+} sim_air_frame_t;
+
+#define SIM_AIR_HEADER_SIZE offsetof(sim_air_frame_t, data)
+
+typedef struct
+{
+    sim_air_frame_t frame;
+    bool valid;
+} sim_pending_t;
+
+typedef struct
+{
+    gs_sim_config_t config;
+    int air[2]; // [0] is the ground end, [1] is the far (spacecraft) end.
+    uint64_t rng_ground;
+    uint64_t rng_far;
+    sim_pending_t ground_pending;
+    sim_pending_t far_pending;
+    bool initd;
+    bool asleep;
+    bool spacecraft_running;
+    pthread_t spacecraft_tid;
+    gs_sim_stats_t stats;
+
+    // Simulated modem: takes frames off the air into the RX FIFO and raises the IRQ (eventfd).
+    bool modem_running;
+    pthread_t modem_tid;
+    int irq_efd;
+    pthread_mutex_t fifo_lock;
+    sim_air_frame_t fifo[SIM_RX_FIFO_DEPTH]; // deliver_ns doubles as the arrival time.
+    int fifo_head;
+    int fifo_count;
+    uint32_t spi_active; // Transactions in progress, see sim_spi_begin().
+
+    // When the last frame each way is on the air at the ground end, for tune. Guarded by air_lock.
+    pthread_mutex_t air_lock;
+    uint64_t downlink_start_ns;
+    uint64_t downlink_end_ns;
+    uint64_t uplink_start_ns;
+    uint64_t uplink_end_ns;
+    int32_t rx_offset_hz;
+    int32_t tx_offset_hz;
+
+    // The modem profile in effect on the air, both ends; configure changes it live. Accessed with __atomic builtins.
+    uint32_t bitrate;
+    uint16_t preamble;
+    int16_t rssi;
+} sim_radio_t;
+
+#define SIM_STAT_ADD(sim, field, n) __atomic_fetch_add(&(sim)->stats.field, (n), __ATOMIC_RELAXED)
+
+static inline uint64_t sim_rand(uint64_t *state)
+{
+    // xorshift64*
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static inline double sim_rand_unit(uint64_t *state)
+{
+    // (0, 1]
+    return ((sim_rand(state) >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief Flips bits in buf at the configured bit-error rate. Returns the number of bits flipped.
+ * 
+ * Draws geometric gaps between errors rather than a random number per bit.
+ */
+static uint64_t sim_apply_ber(uint8_t *buf, ssize_t len, double ber, uint64_t *rng)
+{
+    if (ber <= 0)
+    {
+        return 0;
+    }
+
+    uint64_t flipped = 0;
+    uint64_t nbits = (uint64_t)len * 8;
+    double log_keep = log1p(-ber);
+    uint64_t bit = 0;
+    while (1)
+    {
+        double gap = ber >= 1.0 ? 0 : floor(log(sim_rand_unit(rng)) / log_keep);
+        if (gap >= (double)(nbits - bit))
+        {
+            break;
+        }
+        bit += (uint64_t)gap;
+        buf[bit >> 3] ^= (uint8_t)(0x80 >> (bit & 0x7));
+        flipped++;
+        bit++;
+    }
+    return flipped;
+}
+
+/**
+ * @brief The bit-error rate of noncoherent 2FSK at the RSSI and data rate, over SIM_N0_DBM_HZ of noise.
+ */
+static double sim_awgn_ber(int16_t rssi, uint32_t bitrate)
+{
+    double ebn0_db = rssi - SIM_N0_DBM_HZ - 10 * log10((double)(bitrate ? bitrate : 1));
+    return 0.5 * exp(-pow(10, ebn0_db / 10) / 2);
+}
+
+/**
+ * @brief Puts a frame on the air from one end, applying air time, loss, BER and latency.
+ */
+static ssize_t sim_air_send(sim_radio_t *sim, int fd, uint64_t *rng, const void *buf, ssize_t len, uint64_t *lost)
+{
+    if (len <= 0 || len > SIM_MAX_AIR_FRAME)
+    {
+        return -1;
+    }
+
+    const gs_sim_config_t *config = &sim->config;
+    uint64_t now = gs_time_ns();
+    uint32_t bitrate = __atomic_load_n(&sim->bitrate, __ATOMIC_RELAXED);
+    int16_t rssi = __atomic_load_n(&sim->rssi, __ATOMIC_RELAXED);
+    // A preamble longer or shorter than the default adds or takes off air time.
+    int64_t air_bytes = (int64_t)len + __atomic_load_n(&sim->preamble, __ATOMIC_RELAXED) - SIM_DEFAULT_PREAMBLE;
+    uint64_t airtime = bitrate && air_bytes > 0 ? ((uint64_t)air_bytes * 8 * NSEC_PER_SEC) / bitrate : 0;
+
+    // Lost or not, the frame is on the air; the downlink reaches the ground after the latency.
+    pthread_mutex_lock(&sim->air_lock);
+    if (fd == sim->air[0])
+    {
+        sim->uplink_start_ns = now;
+        sim->uplink_end_ns = now + airtime;
+    }
+    else
+    {
+        sim->downlink_start_ns = now + (uint64_t)config->latency_us * NSEC_PER_USEC;
+        sim->downlink_end_ns = sim->downlink_start_ns + airtime;
+    }
+    pthread_mutex_unlock(&sim->air_lock);
+
+    // The transmitter is busy for the air time, same as a real half-duplex radio.
+    if (airtime)
+    {
+        gs_sleep_until_ns(now + airtime);
+    }
+
+    if (config->loss > 0 && sim_rand_unit(rng) <= config->loss)
+    {
+        __atomic_fetch_add(lost, 1, __ATOMIC_RELAXED);
+        return len;
+    }
+
+    sim_air_frame_t frame[1];
+    frame->deliver_ns = now + airtime + (uint64_t)config->latency_us * NSEC_PER_USEC;
+    frame->rssi = rssi;
+    frame->len = len;
+    memcpy(frame->data, buf, len);
+    uint64_t flipped = sim_apply_ber(frame->data, len, config->awgn ? sim_awgn_ber(rssi, bitrate) : config->ber, rng);
+    if (flipped)
+    {
+        SIM_STAT_ADD(sim, bits_flipped, flipped);
+    }
+
+    if (send(fd, frame, SIM_AIR_HEADER_SIZE + len, MSG_DONTWAIT) < 0)
+    {
+        // Receiver overrun, the frame is gone just like an unserviced FIFO.
+        __atomic_fetch_add(lost, 1, __ATOMIC_RELAXED);
+    }
+    return len;
+}
+
+/**
+ * @brief Takes a frame off the air at one end once its delivery time has passed.
+ */
+static ssize_t sim_air_recv(int fd, sim_pending_t *pending, void *buf, ssize_t len, int16_t *rssi, int timeout_ms, uint64_t *arrival_ns = NULL)
+{
+    uint64_t now = gs_time_ns();
+    uint64_t deadline = timeout_ms < 0 ? UINT64_MAX : now + (uint64_t)timeout_ms * NSEC_PER_MSEC;
+
+    if (!pending->valid)
+    {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        int retval = poll(&pfd, 1, timeout_ms);
+        if (retval < 0)
+        {
+            return errno == EINTR ? 0 : -1;
+        }
+        else if (retval == 0)
+        {
+            return 0;
+        }
+
+        ssize_t rd = recv(fd, &pending->frame, sizeof(sim_air_frame_t), MSG_DONTWAIT);
+        if (rd < (ssize_t)SIM_AIR_HEADER_SIZE)
+        {
+            return (rd < 0 && errno != EAGAIN) ? -1 : 0;
+        }
+        pending->valid = true;
+        now = gs_time_ns();
+    }
+
+    if (pending->frame.deliver_ns > now)
+    {
+        if (pending->frame.deliver_ns > deadline)
+        {
+            if (timeout_ms != 0)
+            {
+                gs_sleep_until_ns(deadline);
+            }
+            return 0;
+        }
+        gs_sleep_until_ns(pending->frame.deliver_ns);
+    }
+
+    ssize_t out = pending->frame.len < len ? pending->frame.len : len;
+    memcpy(buf, pending->frame.data, out);
+    if (rssi != nullptr)
+    {
+        *rssi = pending->frame.rssi;
+    }
+    if (arrival_ns != nullptr)
+    {
+        *arrival_ns = pending->frame.deliver_ns;
+    }
+    pending->valid = false;
+    return out;
+}
+
+static void *sim_modem_thread(void *args)
+{
+    sim_radio_t *sim = (sim_radio_t *)args;
+
+    while (__atomic_load_n(&sim->modem_running, __ATOMIC_ACQUIRE))
+    {
+        sim_air_frame_t frame[1];
+        ssize_t rd = sim_air_recv(sim->air[0], &sim->ground_pending, frame->data, sizeof(frame->data), &frame->rssi, SIM_IDLE_POLL_MS, &frame->deliver_ns);
+        if (rd <= 0)
+        {
+            continue;
+        }
+
+        if (__atomic_load_n(&sim->asleep, __ATOMIC_RELAXED))
+        {
+            // A sleeping radio hears nothing.
+            continue;
+        }
+        frame->len = rd;
+
+        bool overrun = false;
+        pthread_mutex_lock(&sim->fifo_lock);
+        if (sim->fifo_count < SIM_RX_FIFO_DEPTH)
+        {
+            sim->fifo[(sim->fifo_head + sim->fifo_count) % SIM_RX_FIFO_DEPTH] = *frame;
+            sim->fifo_count++;
+        }
+        else
+        {
+            overrun = true;
+        }
+        pthread_mutex_unlock(&sim->fifo_lock);
+
+        if (overrun)
+        {
+            // Nobody serviced the FIFO in time, the frame is gone.
+            SIM_STAT_ADD(sim, downlink_lost, 1);
+            continue;
+        }
+
+        uint64_t one = 1;
+        if (write(sim->irq_efd, &one, sizeof(one)) < 0)
+        {
+            dbprintlf(RED_FG "Simulated IRQ failed.");
+        }
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief Sends a built GST frame from the simulated spacecraft, with parity if it is configured to.
+ */
+static void sim_spacecraft_send_frame(sim_radio_t *sim, const gst_frame_t *frame)
+{
+    gst_fec_frame_t fec[1];
+    fec->frame = *frame;
+    ssize_t len = sizeof(gst_frame_t);
+    if (sim->config.fec)
+    {
+        gs_fec_encode(&fec->frame, sizeof(gst_frame_t), fec->parity);
+        len = sizeof(gst_fec_frame_t);
+    }
+    sim_air_send(sim, sim->air[1], &sim->rng_far, fec, len, &sim->stats.downlink_lost);
+    SIM_STAT_ADD(sim, downlink_sent, 1);
+}
+
+/**
+ * @brief Sends a GST frame from the simulated spacecraft.
+ */
+static void sim_spacecraft_send(sim_radio_t *sim, const void *payload, ssize_t len, uint16_t guid)
+{
+    gst_frame_t frame[1];
+    gs_uhf_frame_build(frame, payload, len, guid);
+    sim_spacecraft_send_frame(sim, frame);
+}
+
+/**
+ * @brief Time between beacons: the configured rate, slowed under "duty" so beacons keep the air busy no more
+ * than that fraction of the time at the data rate in effect.
+ */
+static uint64_t sim_beacon_period(sim_radio_t *sim)
+{
+    const gs_sim_config_t *config = &sim->config;
+    uint64_t period_ns = config->beacon_hz > 0 ? (uint64_t)(NSEC_PER_SEC / config->beacon_hz) : 0;
+    uint32_t bitrate = __atomic_load_n(&sim->bitrate, __ATOMIC_RELAXED);
+    if (period_ns && config->duty > 0 && bitrate)
+    {
+        int64_t air_bytes = (int64_t)(config->fec ? sizeof(gst_fec_frame_t) : sizeof(gst_frame_t)) +
+                            __atomic_load_n(&sim->preamble, __ATOMIC_RELAXED) - SIM_DEFAULT_PREAMBLE;
+        uint64_t busy_ns = (uint64_t)(air_bytes * 8 * NSEC_PER_SEC / bitrate / config->duty);
+        period_ns = busy_ns > period_ns ? busy_ns : period_ns;
+    }
+    return period_ns;
+}
+
+static void *sim_spacecraft_thread(void *args)
+{
+    sim_radio_t *sim = (sim_radio_t *)args;
+    const gs_sim_config_t *config = &sim->config;
+    uint64_t period_ns = sim_beacon_period(sim);
+    uint64_t next_beacon = gs_time_ns() + period_ns;
+    int beacon_seq = 0;
+
+    // The spacecraft end of multi-frame messages; with echo on, reassembled uplinks go back down the same way.
+    // One slot past the queue is where compressed uplinks decode when there is no echo to queue them for.
+    gs_sar_t *sar = gs_sar_create(SIM_SAR_MAX_MESSAGE);
+    uint8_t *echo_msg = (uint8_t *)malloc((SIM_ECHO_QUEUE + 1) * SIM_SAR_MAX_MESSAGE);
+    size_t echo_len[SIM_ECHO_QUEUE];
+    int echo_head = 0, echo_count = 0;
+    if (sar == nullptr || echo_msg == nullptr)
+    {
+        dbprintlf(FATAL "Simulated spacecraft failed to allocate its SAR endpoint.");
+        gs_sar_destroy(sar);
+        free(echo_msg);
+        return nullptr;
+    }
+
+    while (__atomic_load_n(&sim->spacecraft_running, __ATOMIC_ACQUIRE))
+    {
+        uint64_t now = gs_time_ns();
+        period_ns = sim_beacon_period(sim);
+        uint8_t payload[GST_MAX_PAYLOAD_SIZE];
+        uint64_t wake_ns = UINT64_MAX;
+        bool sent = false;
+        if (gs_sar_take_ack(sar, payload))
+        {
+            sim_spacecraft_send(sim, payload, GST_MAX_PAYLOAD_SIZE, GST_SAR_GUID);
+            sent = true;
+        }
+        else
+        {
+            gs_sar_status_t status = gs_sar_send_poll(sar, now, payload, &wake_ns);
+            if (status == GS_SAR_SEND)
+            {
+                sim_spacecraft_send(sim, payload, GST_MAX_PAYLOAD_SIZE, GST_SAR_GUID);
+                sent = true;
+            }
+            else if (status == GS_SAR_DONE || status == GS_SAR_FAILED || status == GS_SAR_IDLE)
+            {
+                if (status == GS_SAR_DONE)
+                {
+                    SIM_STAT_ADD(sim, sar_downlinks, 1);
+                }
+                if (status != GS_SAR_IDLE)
+                {
+                    echo_head = (echo_head + 1) % SIM_ECHO_QUEUE;
+                    echo_count--;
+                }
+                if (echo_count)
+                {
+                    gs_sar_send_start(sar, echo_msg + echo_head * SIM_SAR_MAX_MESSAGE, echo_len[echo_head]);
+                    sent = true;
+                }
+            }
+        }
+
+        // Keep segments flowing while there are any to send, otherwise sleep until the next beacon or timer.
+        int timeout_ms = SIM_IDLE_POLL_MS;
+        now = gs_time_ns();
+        if (sent)
+        {
+            timeout_ms = 0;
+        }
+        else
+        {
+            if (period_ns)
+            {
+                timeout_ms = next_beacon > now ? (int)((next_beacon - now) / NSEC_PER_MSEC) : 0;
+            }
+            if (wake_ns != UINT64_MAX)
+            {
+                int wake_ms = wake_ns > now ? (int)((wake_ns - now) / NSEC_PER_MSEC) : 0;
+                timeout_ms = wake_ms < timeout_ms ? wake_ms : timeout_ms;
+            }
+        }
+
+        uint8_t buf[SIM_MAX_AIR_FRAME];
+        ssize_t rd = sim_air_recv(sim->air[1], &sim->far_pending, buf, sizeof(buf), NULL, timeout_ms);
+        gst_frame_t *frame = (gst_frame_t *)buf;
+        if (rd == sizeof(gst_fec_frame_t))
+        {
+            // The spacecraft takes either framing; what the decoder cannot fix the CRC rejects.
+            gs_fec_decode(buf, rd);
+            rd = sizeof(gst_frame_t);
+        }
+        if (rd == sizeof(gst_frame_t) && (frame->guid == GST_SAR_GUID || frame->guid == GST_LZ_GUID))
+        {
+            // Corrupted segments are dropped like any real receiver would; the ground's timers resend them.
+            bool valid = frame->crc == frame->crc1 && frame->crc == gs_crc16(frame->payload, GST_MAX_PAYLOAD_SIZE);
+            const uint8_t *msg = nullptr;
+            size_t msg_len = GST_MAX_PAYLOAD_SIZE;
+            bool compressed = frame->guid == GST_LZ_GUID;
+            if (valid && compressed)
+            {
+                msg = frame->payload;
+            }
+            else if (valid && (gs_sar_input(sar, frame->payload, gs_time_ns()) & GS_SAR_IN_MESSAGE))
+            {
+                SIM_STAT_ADD(sim, sar_uplinks, 1);
+                msg = gs_sar_message(sar, &msg_len, &compressed);
+            }
+
+            // Picked up by gs_sar_send_poll() above once earlier echoes are done.
+            bool queue = msg != nullptr && config->echo && echo_count < SIM_ECHO_QUEUE;
+            int tail = queue ? (echo_head + echo_count) % SIM_ECHO_QUEUE : SIM_ECHO_QUEUE;
+            uint8_t *slot = echo_msg + tail * SIM_SAR_MAX_MESSAGE;
+            ssize_t len = msg_len;
+            if (msg != nullptr && compressed)
+            {
+                len = gs_lz_decompress(slot, SIM_SAR_MAX_MESSAGE, msg, msg_len);
+                SIM_STAT_ADD(sim, lz_uplinks, len > 0);
+                SIM_STAT_ADD(sim, lz_rejected, len <= 0);
+            }
+            else if (queue)
+            {
+                memcpy(slot, msg, msg_len);
+            }
+            if (queue && len > 0)
+            {
+                echo_len[tail] = len;
+                echo_count++;
+            }
+        }
+        else if (rd == sizeof(gst_frame_t) && config->echo)
+        {
+            sim_spacecraft_send_frame(sim, frame);
+        }
+        else if (rd > 0 && config->echo)
+        {
+            sim_air_send(sim, sim->air[1], &sim->rng_far, buf, rd, &sim->stats.downlink_lost);
+            SIM_STAT_ADD(sim, downlink_sent, 1);
+        }
+
+        if (period_ns && gs_time_ns() >= next_beacon)
+        {
+            cmd_output_t beacon[1];
+            memset(beacon, 0x0, sizeof(cmd_output_t));
+            beacon->mod = SIM_BEACON_MOD;
+            beacon->retval = beacon_seq++;
+            sim_spacecraft_send(sim, beacon, sizeof(cmd_output_t), GST_GUID);
+
+            next_beacon += period_ns;
+            now = gs_time_ns();
+            if (next_beacon + 100 * period_ns < now)
+            {
+                // Fell far behind (e.g. rate above what the air can carry), do not try to catch up.
+                next_beacon = now + period_ns;
+            }
+        }
+    }
+
+    gs_sar_destroy(sar);
+    free(echo_msg);
+    return nullptr;
+}
+
+/**
+ * @brief Puts the radio back on its configured frequency and modem profile, as an init or resume does.
+ */
+static void sim_reset_config(gs_radio_t *radio)
+{
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    pthread_mutex_lock(&sim->air_lock);
+    sim->rx_offset_hz = 0;
+    sim->tx_offset_hz = 0;
+    pthread_mutex_unlock(&sim->air_lock);
+    __atomic_store_n(&sim->bitrate, sim->config.bitrate, __ATOMIC_RELAXED);
+    __atomic_store_n(&sim->preamble, (uint16_t)SIM_DEFAULT_PREAMBLE, __ATOMIC_RELAXED);
+    radio->modem = {sim->config.bitrate, sim->config.bitrate / 2, SIM_DEFAULT_PREAMBLE, SIM_DEFAULT_POWER};
+}
+
+static int sim_do_init(gs_radio_t *radio)
+{
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    uint64_t attempt = SIM_STAT_ADD(sim, inits, 1);
+    if (sim->config.boot_ms > 0)
+    {
+        usleep(sim->config.boot_ms * 1000);
+    }
+    if (attempt < sim->config.fail_inits)
+    {
+        dbprintlf(RED_FG "Simulated radio failed to initialize (%llu of %u planned failures).", (unsigned long long)attempt + 1,
+                  sim->config.fail_inits);
+        return 0;
+    }
+
+    if (sim->config.spacecraft && !sim->spacecraft_running)
+    {
+        __atomic_store_n(&sim->spacecraft_running, true, __ATOMIC_RELEASE);
+        if (pthread_create(&sim->spacecraft_tid, NULL, sim_spacecraft_thread, sim) != 0)
+        {
+            dbprintlf(RED_FG "Failed to start simulated spacecraft.");
+            sim->spacecraft_running = false;
+            return 0;
+        }
+    }
+
+    if (!sim->modem_running)
+    {
+        __atomic_store_n(&sim->modem_running, true, __ATOMIC_RELEASE);
+        if (pthread_create(&sim->modem_tid, NULL, sim_modem_thread, sim) != 0)
+        {
+            dbprintlf(RED_FG "Failed to start simulated modem.");
+            sim->modem_running = false;
+            return 0;
+        }
+    }
+
+    sim_reset_config(radio);
+    __atomic_store_n(&sim->initd, true, __ATOMIC_RELEASE);
+    sim->asleep = false;
+    char channel[32];
+    if (sim->config.awgn)
+    {
+        snprintf(channel, sizeof(channel), "awgn at %d dBm", sim->config.rssi);
+    }
+    else
+    {
+        snprintf(channel, sizeof(channel), "ber %g", sim->config.ber);
+    }
+    dbprintlf(GREEN_FG "Simulated radio up (%s, loss %g, latency %u us, %u bps, beacon %g Hz%s%s).",
+              channel, sim->config.loss, sim->config.latency_us, sim->config.bitrate, sim->config.beacon_hz, sim->config.echo ? ", echo" : "", sim->config.fec ? ", fec" : "");
+    return 1;
+}
+
+static int sim_do_resume(gs_radio_t *radio)
+{
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    if (!__atomic_load_n(&sim->modem_running, __ATOMIC_ACQUIRE))
+    {
+        // Never initialized, nothing to re-apply.
+        return 0;
+    }
+    SIM_STAT_ADD(sim, resumes, 1);
+    sim_reset_config(radio);
+    sim->asleep = false;
+    __atomic_store_n(&sim->initd, true, __ATOMIC_RELEASE);
+    return 1;
+}
+
+static int sim_do_get_info(gs_radio_t *radio, gs_radio_info_t *info)
+{
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    SIM_STAT_ADD(sim, info_calls, 1);
+    if (sim->config.spi_us > 0)
+    {
+        // The part info is an SPI command and response; spin rather than sleep so short ones are not overslept.
+        uint64_t until = gs_time_ns() + sim->config.spi_us * 1000ULL;
+        while (gs_time_ns() < until)
+            ;
+    }
+    memset(info, 0x0, sizeof(gs_radio_info_t));
+    if (__atomic_load_n(&sim->initd, __ATOMIC_ACQUIRE))
+    {
+        info->chip_rev = 0x22;
+        info->part = SIM_PART;
+        info->id = 0x8600;
+        info->rom_id = 0x6;
+    }
+    return 1;
+}
+
+static void sim_do_en_pipe(gs_radio_t *radio)
+{
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    sim->asleep = false;
+}
+
+static ssize_t sim_do_read(gs_radio_t *radio, void *buf, ssize_t len, int16_t *rssi)
+{
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    if (!__atomic_load_n(&sim->initd, __ATOMIC_ACQUIRE))
+    {
+        return 0;
+    }
+
+    ssize_t retval = 0;
+    pthread_mutex_lock(&sim->fifo_lock);
+    if (sim->fifo_count > 0)
+    {
+        sim_air_frame_t *frame = &sim->fifo[sim->fifo_head];
+        retval = frame->len < len ? frame->len : len;
+        memcpy(buf, frame->data, retval);
+        if (rssi != nullptr)
+        {
+            *rssi = frame->rssi;
+        }
+        sim->fifo_head = (sim->fifo_head + 1) % SIM_RX_FIFO_DEPTH;
+        sim->fifo_count--;
+    }
+    pthread_mutex_unlock(&sim->fifo_lock);
+
+    if (retval > 0)
+    {
+        SIM_STAT_ADD(sim, downlink_read, 1);
+    }
+    return retval;
+}
+
+static ssize_t sim_do_write(gs_radio_t *radio, void *buf, ssize_t len)
+{
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    if (!__atomic_load_n(&sim->initd, __ATOMIC_ACQUIRE) || sim->asleep)
+    {
+        return 0;
+    }
+
+    ssize_t retval = sim_air_send(sim, sim->air[0], &sim->rng_ground, buf, len, &sim->stats.uplink_lost);
+    if (retval > 0)
+    {
+        SIM_STAT_ADD(sim, uplink_sent, 1);
+    }
+    return retval;
+}
+
+static int sim_do_sleep(gs_radio_t *radio)
+{
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    __atomic_store_n(&sim->asleep, true, __ATOMIC_RELAXED);
+
+    pthread_mutex_lock(&sim->fifo_lock);
+    sim->fifo_count = 0;
+    pthread_mutex_unlock(&sim->fifo_lock);
+    return 1;
+}
+
+/**
+ * @brief Retunes, unless a downlink frame is arriving: the si446x would have seen its sync word by then. A
+ * transmission is not checked for, that is the arbiter's job, but a retune during one is counted.
+ */
+static int sim_do_tune(gs_radio_t *radio, int32_t rx_hz, int32_t tx_hz)
+{
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    if (!__atomic_load_n(&sim->initd, __ATOMIC_ACQUIRE))
+    {
+        return 0;
+    }
+    uint64_t now = gs_time_ns();
+    pthread_mutex_lock(&sim->air_lock);
+    if (now >= sim->downlink_start_ns && now < sim->downlink_end_ns)
+    {
+        pthread_mutex_unlock(&sim->air_lock);
+        SIM_STAT_ADD(sim, retunes_busy, 1);
+        return -1;
+    }
+    if (now >= sim->uplink_start_ns && now < sim->uplink_end_ns)
+    {
+        SIM_STAT_ADD(sim, retunes_mid_frame, 1);
+    }
+    sim->rx_offset_hz = rx_hz;
+    sim->tx_offset_hz = tx_hz;
+    pthread_mutex_unlock(&sim->air_lock);
+    SIM_STAT_ADD(sim, retunes, 1);
+    return 1;
+}
+
+/**
+ * @brief Switches the modem profile on the air, which the simulated spacecraft follows at once. Refused while a
+ * downlink frame is arriving, and counted if it lands on an uplink one, as for sim_do_tune().
+ */
+static int sim_do_configure(gs_radio_t *radio, const gs_modem_t *modem)
+{
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    if (!__atomic_load_n(&sim->initd, __ATOMIC_ACQUIRE) || modem->bitrate == 0)
+    {
+        return 0;
+    }
+    uint64_t now = gs_time_ns();
+    pthread_mutex_lock(&sim->air_lock);
+    if (now >= sim->downlink_start_ns && now < sim->downlink_end_ns)
+    {
+        pthread_mutex_unlock(&sim->air_lock);
+        SIM_STAT_ADD(sim, reconfigs_busy, 1);
+        return -1;
+    }
+    if (now >= sim->uplink_start_ns && now < sim->uplink_end_ns)
+    {
+        SIM_STAT_ADD(sim, reconfigs_mid_frame, 1);
+    }
+    __atomic_store_n(&sim->bitrate, modem->bitrate, __ATOMIC_RELAXED);
+    __atomic_store_n(&sim->preamble, modem->preamble, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&sim->air_lock);
+    SIM_STAT_ADD(sim, reconfigs, 1);
+    return 1;
+}
+
+static int sim_irq_fd(gs_radio_t *radio)
+{
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    return sim->irq_efd;
+}
+
+static int sim_irq_ack(gs_radio_t *radio, uint64_t *irq_ns)
+{
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    uint64_t count;
+    if (read(sim->irq_efd, &count, sizeof(count)) < 0)
+    {
+        count = 0;
+    }
+
+    *irq_ns = 0;
+    pthread_mutex_lock(&sim->fifo_lock);
+    if (sim->fifo_count > 0)
+    {
+        *irq_ns = sim->fifo[sim->fifo_head].deliver_ns;
+    }
+    pthread_mutex_unlock(&sim->fifo_lock);
+
+    return *irq_ns ? 1 : 0;
+}
+
+static void sim_destroy(gs_radio_t *radio)
+{
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    if (sim->spacecraft_running)
+    {
+        __atomic_store_n(&sim->spacecraft_running, false, __ATOMIC_RELEASE);
+        pthread_join(sim->spacecraft_tid, NULL);
+    }
+    if (sim->modem_running)
+    {
+        __atomic_store_n(&sim->modem_running, false, __ATOMIC_RELEASE);
+        pthread_join(sim->modem_tid, NULL);
+    }
+    close(sim->air[0]);
+    close(sim->air[1]);
+    close(sim->irq_efd);
+    pthread_mutex_destroy(&sim->fifo_lock);
+    pthread_mutex_destroy(&sim->air_lock);
+    free(sim);
+    free(radio);
+}
+
+/**
+ * @brief Brackets a transaction with the simulated device, counting those that overlap another; the
+ * si446x's SPI bus would garble both.
+ */
+static void sim_spi_begin(sim_radio_t *sim)
+{
+    if (__atomic_fetch_add(&sim->spi_active, 1, __ATOMIC_ACQ_REL) > 0)
+    {
+        SIM_STAT_ADD(sim, spi_overlaps, 1);
+    }
+}
+
+static void sim_spi_end(sim_radio_t *sim)
+{
+    __atomic_fetch_sub(&sim->spi_active, 1, __ATOMIC_RELEASE);
+}
+
+static int sim_init(gs_radio_t *radio)
+{
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    sim_spi_begin(sim);
+    int retval = sim_do_init(radio);
+    sim_spi_end(sim);
+    return retval;
+}
+
+static int sim_resume(gs_radio_t *radio)
+{
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    sim_spi_begin(sim);
+    int retval = sim_do_resume(radio);
+    sim_spi_end(sim);
+    return retval;
+}
+
+static int sim_get_info(gs_radio_t *radio, gs_radio_info_t *info)
+{
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    sim_spi_begin(sim);
+    int retval = sim_do_get_info(radio, info);
+    sim_spi_end(sim);
+    return retval;
+}
+
+static void sim_en_pipe(gs_radio_t *radio)
+{
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    sim_spi_begin(sim);
+    sim_do_en_pipe(radio);
+    sim_spi_end(sim);
+}
+
+static ssize_t sim_read(gs_radio_t *radio, void *buf, ssize_t len, int16_t *rssi)
+{
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    sim_spi_begin(sim);
+    ssize_t retval = sim_do_read(radio, buf, len, rssi);
+    sim_spi_end(sim);
+    return retval;
+}
+
+static ssize_t sim_write(gs_radio_t *radio, void *buf, ssize_t len)
+{
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    sim_spi_begin(sim);
+    ssize_t retval = sim_do_write(radio, buf, len);
+    sim_spi_end(sim);
+    return retval;
+}
+
+static int sim_sleep(gs_radio_t *radio)
+{
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    sim_spi_begin(sim);
+    int retval = sim_do_sleep(radio);
+    sim_spi_end(sim);
+    return retval;
+}
+
+static int sim_tune(gs_radio_t *radio, int32_t rx_hz, int32_t tx_hz)
+{
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    sim_spi_begin(sim);
+    int retval = sim_do_tune(radio, rx_hz, tx_hz);
+    sim_spi_end(sim);
+    return retval;
+}
+
+static int sim_configure(gs_radio_t *radio, const gs_modem_t *modem)
+{
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    sim_spi_begin(sim);
+    int retval = sim_do_configure(radio, modem);
+    sim_spi_end(sim);
+    return retval;
+}
+
+static const gs_radio_ops_t sim_ops = {
+    "sim",
+    sim_init,
+    sim_get_info,
+    sim_en_pipe,
+    sim_read,
+    sim_write,
+    sim_sleep,
+    sim_destroy,
+    sim_irq_fd,
+    sim_irq_ack,
+    sim_resume,
+    sim_tune,
+    sim_configure,
+};
+
+void gs_radio_sim_defaults(gs_sim_config_t *config)
+{
+    memset(config, 0x0, sizeof(gs_sim_config_t));
+    config->bitrate = SIM_DEFAULT_BITRATE;
+    config->spacecraft = true;
+    config->rssi = SIM_DEFAULT_RSSI;
+    config->seed = 0x5ac3;
+}
+
+int gs_radio_sim_parse(gs_sim_config_t *config, const char *options)
+{
+    if (options == nullptr || options[0] == '\0')
+    {
+        return 1;
+    }
+
+    char *const tokens[] = {
+        (char *)"ber",
+        (char *)"loss",
+        (char *)"latency",
+        (char *)"rate",
+        (char *)"beacon",
+        (char *)"echo",
+        (char *)"external",
+        (char *)"rssi",
+        (char *)"seed",
+        (char *)"fec",
+        (char *)"spi",
+        (char *)"boot",
+        (char *)"fail",
+        (char *)"awgn",
+        (char *)"duty",
+        NULL,
+    };
+
+    char *copy = strdup(options);
+    char *subopts = copy;
+    char *value = NULL;
+    int retval = 1;
+
+    while (*subopts != '\0' && retval)
+    {
+        int idx = getsubopt(&subopts, tokens, &value);
+        if (idx < 0 || (idx != 5 && idx != 6 && idx != 9 && idx != 13 && value == NULL))
+        {
+            dbprintlf(RED_FG "Bad simulated radio option: %s", value ? value : "(missing value)");
+            retval = 0;
+            break;
+        }
+
+        switch (idx)
+        {
+        case 0:
+            config->ber = atof(value);
+            break;
+        case 1:
+            config->loss = atof(value);
+            break;
+        case 2:
+            config->latency_us = strtoul(value, NULL, 0);
+            break;
+        case 3:
+            config->bitrate = strtoul(value, NULL, 0);
+            break;
+        case 4:
+            config->beacon_hz = atof(value);
+            break;
+        case 5:
+            config->echo = true;
+            break;
+        case 6:
+            config->spacecraft = false;
+            break;
+        case 7:
+            config->rssi = atoi(value);
+            break;
+        case 8:
+            config->seed = strtoul(value, NULL, 0);
+            break;
+        case 9:
+            config->fec = true;
+            break;
+        case 10:
+            config->spi_us = strtoul(value, NULL, 0);
+            break;
+        case 11:
+            config->boot_ms = strtoul(value, NULL, 0);
+            break;
+        case 12:
+            config->fail_inits = strtoul(value, NULL, 0);
+            break;
+        case 13:
+            config->awgn = true;
+            break;
+        case 14:
+            config->duty = atof(value);
+            break;
+        }
+    }
+
+    free(copy);
+    return retval;
+}
+
+gs_radio_t *gs_radio_sim_create(const gs_sim_config_t *config)
+{
+    sim_radio_t *sim = (sim_radio_t *)calloc(1, sizeof(sim_radio_t));
+    if (sim == nullptr)
+    {
+        dbprintlf(FATAL "Failed to allocate simulated radio.");
+        return nullptr;
+    }
+
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sim->air) < 0)
+    {
+        dbprintlf(FATAL "Failed to create simulated air.");
+        erprintlf(errno);
+        free(sim);
+        return nullptr;
+    }
+
+    sim->irq_efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (sim->irq_efd < 0)
+    {
+        dbprintlf(FATAL "Failed to create simulated IRQ.");
+        erprintlf(errno);
+        close(sim->air[0]);
+        close(sim->air[1]);
+        free(sim);
+        return nullptr;
+    }
+    pthread_mutex_init(&sim->fifo_lock, NULL);
+    pthread_mutex_init(&sim->air_lock, NULL);
+
+    sim->config = *config;
+    sim->bitrate = config->bitrate;
+    sim->preamble = SIM_DEFAULT_PREAMBLE;
+    sim->rssi = config->rssi;
+    sim->rng_ground = ((uint64_t)config->seed << 1) | 1;
+    sim->rng_far = ((uint64_t)config->seed << 17) ^ 0x9e3779b97f4a7c15ULL;
+
+    gs_radio_t *radio = gs_radio_alloc(&sim_ops, sim);
+    if (radio == nullptr)
+    {
+        close(sim->air[0]);
+        close(sim->air[1]);
+        close(sim->irq_efd);
+        free(sim);
+    }
+    return radio;
+}
+
+int gs_radio_sim_far_fd(gs_radio_t *radio)
+{
+    if (!gs_radio_is_sim(radio))
+    {
+        return -1;
+    }
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    return sim->config.spacecraft ? -1 : sim->air[1];
+}
+
+ssize_t gs_radio_sim_far_send(gs_radio_t *radio, const void *buf, ssize_t len)
+{
+    if (gs_radio_sim_far_fd(radio) < 0)
+    {
+        return -1;
+    }
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    ssize_t retval = sim_air_send(sim, sim->air[1], &sim->rng_far, buf, len, &sim->stats.downlink_lost);
+    if (retval > 0)
+    {
+        SIM_STAT_ADD(sim, downlink_sent, 1);
+    }
+    return retval;
+}
+
+ssize_t gs_radio_sim_far_recv(gs_radio_t *radio, void *buf, ssize_t len, int timeout_ms)
+{
+    if (gs_radio_sim_far_fd(radio) < 0)
+    {
+        return -1;
+    }
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    return sim_air_recv(sim->air[1], &sim->far_pending, buf, len, NULL, timeout_ms);
+}
+
+int gs_radio_sim_stats(gs_radio_t *radio, gs_sim_stats_t *stats)
+{
+    if (!gs_radio_is_sim(radio))
+    {
+        return 0;
+    }
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    stats->uplink_sent = __atomic_load_n(&sim->stats.uplink_sent, __ATOMIC_RELAXED);
+    stats->uplink_lost = __atomic_load_n(&sim->stats.uplink_lost, __ATOMIC_RELAXED);
+    stats->downlink_sent = __atomic_load_n(&sim->stats.downlink_sent, __ATOMIC_RELAXED);
+    stats->downlink_lost = __atomic_load_n(&sim->stats.downlink_lost, __ATOMIC_RELAXED);
+    stats->downlink_read = __atomic_load_n(&sim->stats.downlink_read, __ATOMIC_RELAXED);
+    stats->bits_flipped = __atomic_load_n(&sim->stats.bits_flipped, __ATOMIC_RELAXED);
+    stats->sar_uplinks = __atomic_load_n(&sim->stats.sar_uplinks, __ATOMIC_RELAXED);
+    stats->sar_downlinks = __atomic_load_n(&sim->stats.sar_downlinks, __ATOMIC_RELAXED);
+    stats->info_calls = __atomic_load_n(&sim->stats.info_calls, __ATOMIC_RELAXED);
+    stats->inits = __atomic_load_n(&sim->stats.inits, __ATOMIC_RELAXED);
+    stats->resumes = __atomic_load_n(&sim->stats.resumes, __ATOMIC_RELAXED);
+    stats->spi_overlaps = __atomic_load_n(&sim->stats.spi_overlaps, __ATOMIC_RELAXED);
+    stats->retunes = __atomic_load_n(&sim->stats.retunes, __ATOMIC_RELAXED);
+    stats->retunes_busy = __atomic_load_n(&sim->stats.retunes_busy, __ATOMIC_RELAXED);
+    stats->retunes_mid_frame = __atomic_load_n(&sim->stats.retunes_mid_frame, __ATOMIC_RELAXED);
+    stats->reconfigs = __atomic_load_n(&sim->stats.reconfigs, __ATOMIC_RELAXED);
+    stats->reconfigs_busy = __atomic_load_n(&sim->stats.reconfigs_busy, __ATOMIC_RELAXED);
+    stats->reconfigs_mid_frame = __atomic_load_n(&sim->stats.reconfigs_mid_frame, __ATOMIC_RELAXED);
+    stats->lz_uplinks = __atomic_load_n(&sim->stats.lz_uplinks, __ATOMIC_RELAXED);
+    stats->lz_rejected = __atomic_load_n(&sim->stats.lz_rejected, __ATOMIC_RELAXED);
+    return 1;
+}
+
+int gs_radio_sim_crash(gs_radio_t *radio)
+{
+    if (!gs_radio_is_sim(radio))
+    {
+        return 0;
+    }
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    __atomic_store_n(&sim->initd, false, __ATOMIC_RELEASE);
+    dbprintlf(YELLOW_FG "Simulated radio crashed, it needs to be re-initialized.");
+    return 1;
+}
+
+int gs_radio_sim_set_rssi(gs_radio_t *radio, int16_t rssi)
+{
+    if (!gs_radio_is_sim(radio))
+    {
+        return 0;
+    }
+    sim_radio_t *sim = (sim_radio_t *)radio->priv;
+    __atomic_store_n(&sim->rssi, rssi, __ATOMIC_RELAXED);
+    return 1;
+}
+
+bool gs_radio_is_sim(gs_radio_t *radio)
+{
+    return radio != nullptr && radio->ops == &sim_ops;
+}
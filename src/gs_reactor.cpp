@@ -0,0 +1,282 @@
+/**
+ * @file gs_reactor.cpp
+ * @author agent (agent@local)
+ * @brief Single-threaded epoll event loop: descriptors, timers and signals dispatched to callbacks.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <sys/signalfd.h>
+#include "gs_reactor.hpp"
+#include "gs_time.hpp"
+#include "meb_debug.hpp"
+
+static void reactor_wake_cb(gs_reactor_t *reactor, int fd, uint32_t events, void *arg)
+{
+    (void)reactor;
+    (void)events;
+    (void)arg;
+    uint64_t count;
+    if (read(fd, &count, sizeof(count)) < 0)
+    {
+        // EAGAIN: already drained.
+    }
+}
+
+gs_reactor_t *gs_reactor_create(void)
+{
+    gs_reactor_t *reactor = (gs_reactor_t *)calloc(1, sizeof(gs_reactor_t));
+    if (reactor == nullptr)
+    {
+        dbprintlf(FATAL "Failed to allocate reactor.");
+        return nullptr;
+    }
+    for (int i = 0; i < GS_REACTOR_MAX_HANDLERS; i++)
+    {
+        reactor->handlers[i].fd = -1;
+    }
+    // Numbered from 1 so a slot never used (removed in "batch 0") is free straight away.
+    reactor->batch = 1;
+
+    reactor->epfd = epoll_create1(EPOLL_CLOEXEC);
+    reactor->wake_efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (reactor->epfd < 0 || reactor->wake_efd < 0 || !gs_reactor_add(reactor, reactor->wake_efd, EPOLLIN, reactor_wake_cb, nullptr))
+    {
+        dbprintlf(FATAL "Failed to create reactor.");
+        erprintlf(errno);
+        if (reactor->epfd >= 0)
+        {
+            close(reactor->epfd);
+        }
+        if (reactor->wake_efd >= 0)
+        {
+            close(reactor->wake_efd);
+        }
+        free(reactor);
+        return nullptr;
+    }
+    return reactor;
+}
+
+void gs_reactor_destroy(gs_reactor_t *reactor)
+{
+    if (reactor == nullptr)
+    {
+        return;
+    }
+    for (int i = 0; i < GS_REACTOR_MAX_HANDLERS; i++)
+    {
+        gs_reactor_handler_t *handler = &reactor->handlers[i];
+        if (handler->fd >= 0 && handler->kind != GS_REACTOR_FD)
+        {
+            close(handler->fd);
+        }
+    }
+    close(reactor->wake_efd);
+    close(reactor->epfd);
+    free(reactor);
+}
+
+int gs_reactor_add(gs_reactor_t *reactor, int fd, uint32_t events, gs_reactor_cb_t cb, void *arg)
+{
+    gs_reactor_handler_t *handler = nullptr;
+    for (int i = 0; i < GS_REACTOR_MAX_HANDLERS; i++)
+    {
+        gs_reactor_handler_t *slot = &reactor->handlers[i];
+        if (slot->fd < 0 && slot->removed < reactor->batch)
+        {
+            handler = slot;
+            break;
+        }
+    }
+    if (handler == nullptr)
+    {
+        dbprintlf(RED_FG "Reactor is out of handler slots.");
+        return 0;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0x0, sizeof(ev));
+    ev.events = events;
+    ev.data.ptr = handler;
+    if (epoll_ctl(reactor->epfd, EPOLL_CTL_ADD, fd, &ev) < 0)
+    {
+        erprintlf(errno);
+        return 0;
+    }
+    handler->fd = fd;
+    handler->kind = GS_REACTOR_FD;
+    handler->cb = cb;
+    handler->arg = arg;
+    return 1;
+}
+
+void gs_reactor_del(gs_reactor_t *reactor, int fd)
+{
+    for (int i = 0; i < GS_REACTOR_MAX_HANDLERS; i++)
+    {
+        gs_reactor_handler_t *handler = &reactor->handlers[i];
+        if (handler->fd == fd)
+        {
+            epoll_ctl(reactor->epfd, EPOLL_CTL_DEL, fd, NULL);
+            // Events for it may already be in this batch; the dispatch loop skips them.
+            handler->fd = -1;
+            handler->removed = reactor->batch;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Registers a descriptor the reactor owns, see gs_reactor_kind_t.
+ */
+static int reactor_add_owned(gs_reactor_t *reactor, int fd, gs_reactor_kind_t kind, gs_reactor_cb_t cb, void *arg)
+{
+    if (!gs_reactor_add(reactor, fd, EPOLLIN, cb, arg))
+    {
+        close(fd);
+        return -1;
+    }
+    for (int i = 0; i < GS_REACTOR_MAX_HANDLERS; i++)
+    {
+        if (reactor->handlers[i].fd == fd)
+        {
+            reactor->handlers[i].kind = kind;
+        }
+    }
+    return fd;
+}
+
+int gs_reactor_timer(gs_reactor_t *reactor, gs_reactor_cb_t cb, void *arg)
+{
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0)
+    {
+        erprintlf(errno);
+        return -1;
+    }
+    return reactor_add_owned(reactor, fd, GS_REACTOR_TIMER, cb, arg);
+}
+
+void gs_reactor_timer_set(int fd, uint64_t first_us, uint64_t period_us)
+{
+    struct itimerspec spec;
+    memset(&spec, 0x0, sizeof(spec));
+    spec.it_value.tv_sec = first_us / 1000000;
+    spec.it_value.tv_nsec = (first_us % 1000000) * 1000;
+    spec.it_interval.tv_sec = period_us / 1000000;
+    spec.it_interval.tv_nsec = (period_us % 1000000) * 1000;
+    if (timerfd_settime(fd, 0, &spec, NULL) < 0)
+    {
+        erprintlf(errno);
+    }
+}
+
+int gs_reactor_signals(gs_reactor_t *reactor, const sigset_t *signals, gs_reactor_cb_t cb, void *arg)
+{
+    if (pthread_sigmask(SIG_BLOCK, signals, NULL) != 0)
+    {
+        dbprintlf(RED_FG "Failed to block signals for the reactor.");
+        return -1;
+    }
+    int fd = signalfd(-1, signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (fd < 0)
+    {
+        erprintlf(errno);
+        return -1;
+    }
+    return reactor_add_owned(reactor, fd, GS_REACTOR_SIGNAL, cb, arg);
+}
+
+void gs_reactor_set_idle(gs_reactor_t *reactor, void (*idle)(gs_reactor_t *reactor, void *arg), void *arg)
+{
+    reactor->idle = idle;
+    reactor->idle_arg = arg;
+}
+
+int gs_reactor_run(gs_reactor_t *reactor)
+{
+    struct epoll_event events[GS_REACTOR_MAX_EVENTS];
+
+    while (!__atomic_load_n(&reactor->stop, __ATOMIC_ACQUIRE))
+    {
+        int nfds = epoll_wait(reactor->epfd, events, GS_REACTOR_MAX_EVENTS, -1);
+        if (nfds < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            erprintlf(errno);
+            return 0;
+        }
+
+        uint64_t start = gs_time_ns();
+        __atomic_store_n(&reactor->stats.wakeups, reactor->stats.wakeups + 1, __ATOMIC_RELAXED);
+        for (int i = 0; i < nfds; i++)
+        {
+            gs_reactor_handler_t *handler = (gs_reactor_handler_t *)events[i].data.ptr;
+            if (handler->fd < 0)
+            {
+                // Removed by an earlier callback in this batch.
+                continue;
+            }
+            uint32_t what = events[i].events;
+            if (handler->kind == GS_REACTOR_TIMER)
+            {
+                uint64_t expiries;
+                if (read(handler->fd, &expiries, sizeof(expiries)) < 0)
+                {
+                    // EAGAIN: re-armed or disarmed since it fired.
+                    continue;
+                }
+            }
+            else if (handler->kind == GS_REACTOR_SIGNAL)
+            {
+                struct signalfd_siginfo info;
+                if (read(handler->fd, &info, sizeof(info)) != sizeof(info))
+                {
+                    continue;
+                }
+                what = info.ssi_signo;
+            }
+            handler->cb(reactor, handler->fd, what, handler->arg);
+            __atomic_store_n(&reactor->stats.events, reactor->stats.events + 1, __ATOMIC_RELAXED);
+        }
+        if (reactor->idle != nullptr)
+        {
+            reactor->idle(reactor, reactor->idle_arg);
+        }
+        reactor->batch++;
+        __atomic_store_n(&reactor->stats.busy_ns, reactor->stats.busy_ns + (gs_time_ns() - start), __ATOMIC_RELAXED);
+    }
+    return 1;
+}
+
+void gs_reactor_stop(gs_reactor_t *reactor)
+{
+    __atomic_store_n(&reactor->stop, true, __ATOMIC_RELEASE);
+    uint64_t one = 1;
+    if (write(reactor->wake_efd, &one, sizeof(one)) < 0)
+    {
+        dbprintlf(RED_FG "Failed to wake the reactor.");
+    }
+}
+
+void gs_reactor_get_stats(gs_reactor_t *reactor, gs_reactor_stats_t *stats)
+{
+    stats->wakeups = __atomic_load_n(&reactor->stats.wakeups, __ATOMIC_RELAXED);
+    stats->events = __atomic_load_n(&reactor->stats.events, __ATOMIC_RELAXED);
+    stats->busy_ns = __atomic_load_n(&reactor->stats.busy_ns, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,198 @@
+/**
+ * @file gs_ring.cpp
+ * @author agent (agent@local)
+ * @brief Bounded, lock-free single-producer/single-consumer ring of GST frame slots.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <errno.h>
+#include <sys/eventfd.h>
+#include "gs_ring.hpp"
+#include "meb_debug.hpp"
+
+gs_ring_t *gs_ring_create(uint32_t capacity)
+{
+    uint32_t size = 1;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    gs_ring_t *ring = nullptr;
+    if (posix_memalign((void **)&ring, RING_CACHE_LINE, sizeof(gs_ring_t)) != 0)
+    {
+        dbprintlf(FATAL "Failed to allocate ring.");
+        return nullptr;
+    }
+    memset(ring, 0x0, sizeof(gs_ring_t));
+
+    if (posix_memalign((void **)&ring->slots, RING_CACHE_LINE, size * sizeof(gs_ring_slot_t)) != 0)
+    {
+        dbprintlf(FATAL "Failed to allocate %u ring slots.", size);
+        free(ring);
+        return nullptr;
+    }
+    // Touch every slot now so the RX path never page-faults on a fresh slot.
+    memset(ring->slots, 0x0, size * sizeof(gs_ring_slot_t));
+
+    ring->efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (ring->efd < 0)
+    {
+        dbprintlf(FATAL "Failed to create ring eventfd.");
+        erprintlf(errno);
+        free(ring->slots);
+        free(ring);
+        return nullptr;
+    }
+
+    ring->capacity = size;
+    ring->mask = size - 1;
+    return ring;
+}
+
+void gs_ring_destroy(gs_ring_t *ring)
+{
+    if (ring == nullptr)
+    {
+        return;
+    }
+    close(ring->efd);
+    free(ring->slots);
+    free(ring);
+}
+
+gs_ring_slot_t *gs_ring_reserve(gs_ring_t *ring)
+{
+    uint64_t head = ring->head;
+    if (head - ring->tail_cache >= ring->capacity)
+    {
+        ring->tail_cache = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        if (head - ring->tail_cache >= ring->capacity)
+        {
+            return nullptr;
+        }
+    }
+    return &ring->slots[head & ring->mask];
+}
+
+void gs_ring_commit(gs_ring_t *ring)
+{
+    uint64_t head = ring->head + 1;
+    __atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+
+    uint32_t depth = head - __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    if (depth > ring->high_water)
+    {
+        __atomic_store_n(&ring->high_water, depth, __ATOMIC_RELAXED);
+    }
+
+    // Pairs with the fence in gs_ring_arm(): either the consumer sees the new head, or we see it waiting.
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring->consumer_waiting, __ATOMIC_RELAXED))
+    {
+        uint64_t one = 1;
+        if (write(ring->efd, &one, sizeof(one)) < 0)
+        {
+            dbprintlf(RED_FG "Failed to wake ring consumer.");
+        }
+    }
+}
+
+void gs_ring_overflow(gs_ring_t *ring)
+{
+    __atomic_store_n(&ring->overflows, ring->overflows + 1, __ATOMIC_RELAXED);
+}
+
+gs_ring_slot_t *gs_ring_peek(gs_ring_t *ring)
+{
+    uint64_t tail = ring->tail;
+    if (tail == ring->head_cache)
+    {
+        ring->head_cache = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        if (tail == ring->head_cache)
+        {
+            return nullptr;
+        }
+    }
+    return &ring->slots[tail & ring->mask];
+}
+
+void gs_ring_release(gs_ring_t *ring)
+{
+    __atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_RELEASE);
+}
+
+int gs_ring_fd(gs_ring_t *ring)
+{
+    return ring->efd;
+}
+
+int gs_ring_arm(gs_ring_t *ring)
+{
+    __atomic_store_n(&ring->consumer_waiting, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (gs_ring_peek(ring) != nullptr)
+    {
+        __atomic_store_n(&ring->consumer_waiting, 0, __ATOMIC_RELAXED);
+        return 0;
+    }
+    return 1;
+}
+
+void gs_ring_disarm(gs_ring_t *ring)
+{
+    uint64_t count;
+    __atomic_store_n(&ring->consumer_waiting, 0, __ATOMIC_RELAXED);
+    if (read(ring->efd, &count, sizeof(count)) < 0)
+    {
+        // EAGAIN: woke for another reason.
+    }
+}
+
+int gs_ring_wait(gs_ring_t *ring, int timeout_ms)
+{
+    if (gs_ring_peek(ring) != nullptr)
+    {
+        return 1;
+    }
+
+    if (gs_ring_arm(ring))
+    {
+        struct pollfd pfd = {ring->efd, POLLIN, 0};
+        poll(&pfd, 1, timeout_ms);
+        gs_ring_disarm(ring);
+    }
+
+    return gs_ring_peek(ring) != nullptr ? 1 : 0;
+}
+
+void gs_ring_get_stats(gs_ring_t *ring, gs_ring_stats_t *stats)
+{
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    stats->capacity = ring->capacity;
+    stats->depth = head >= tail ? head - tail : 0;
+    stats->high_water = __atomic_load_n(&ring->high_water, __ATOMIC_RELAXED);
+    stats->pushes = head;
+    stats->pops = tail;
+    stats->overflows = __atomic_load_n(&ring->overflows, __ATOMIC_RELAXED);
+}
+
+void gs_ring_print_stats(const char *name, gs_ring_t *ring)
+{
+    gs_ring_stats_t stats[1];
+    gs_ring_get_stats(ring, stats);
+    dbprintlf(CYAN_FG "%s ring: depth %u/%u, high-water %u, %llu in, %llu out, %llu overflowed.",
+              name, stats->depth, stats->capacity, stats->high_water,
+              (unsigned long long)stats->pushes, (unsigned long long)stats->pops, (unsigned long long)stats->overflows);
+}
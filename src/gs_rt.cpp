@@ -0,0 +1,276 @@
+/**
+ * @file gs_rt.cpp
+ * @author agent (agent@local)
+ * @brief Opt-in real-time profile for the radio threads, and a wakeup latency (jitter) probe to check it with.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <malloc.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "gs_rt.hpp"
+#include "gs_time.hpp"
+#include "meb_debug.hpp"
+
+static bool rt_active;
+
+int gs_rt_parse_cpus(const char *list, cpu_set_t *cpus)
+{
+    CPU_ZERO(cpus);
+    const char *at = list;
+    while (*at != '\0')
+    {
+        char *end;
+        long first = strtol(at, &end, 10);
+        long last = first;
+        if (end == at || first < 0 || first >= CPU_SETSIZE)
+        {
+            return 0;
+        }
+        if (*end == '-')
+        {
+            at = end + 1;
+            last = strtol(at, &end, 10);
+            if (end == at || last < first || last >= CPU_SETSIZE)
+            {
+                return 0;
+            }
+        }
+        for (long cpu = first; cpu <= last; cpu++)
+        {
+            CPU_SET(cpu, cpus);
+        }
+        if (*end == ',')
+        {
+            end++;
+        }
+        else if (*end != '\0')
+        {
+            return 0;
+        }
+        at = end;
+    }
+    return CPU_COUNT(cpus) > 0;
+}
+
+int gs_rt_setup(const gs_rt_config_t *config)
+{
+    if (config->priority <= 0)
+    {
+        return 1;
+    }
+
+    // Small stacks before anything is locked: every thread's stack is locked whole as it is mapped.
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, GS_RT_STACK_BYTES);
+    pthread_setattr_default_np(&attr);
+    pthread_attr_destroy(&attr);
+
+    if (config->isolate && pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &config->housekeeping) != 0)
+    {
+        dbprintlf(RED_FG "Failed to keep the housekeeping threads to their CPUs.");
+    }
+
+    // Freed memory stays in the heap, and large blocks come from it rather than from fresh mappings.
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0)
+    {
+        erprintlf(errno);
+        dbprintlf(RED_FG "Failed to lock the ground station's memory; page faults can still delay the radio.");
+        return 0;
+    }
+    uint8_t *reserve = (uint8_t *)malloc(GS_RT_HEAP_RESERVE);
+    if (reserve != nullptr)
+    {
+        long page = sysconf(_SC_PAGESIZE);
+        for (size_t i = 0; i < GS_RT_HEAP_RESERVE; i += page)
+        {
+            reserve[i] = 0;
+        }
+        free(reserve);
+    }
+
+    rt_active = true;
+    int housekeeping = config->isolate ? CPU_COUNT(&config->housekeeping) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    dbprintlf(GREEN_FG "Real-time profile: memory locked, %d KB stacks, radio threads SCHED_FIFO %d, housekeeping on %d CPU%s.",
+              GS_RT_STACK_BYTES / 1024, config->priority, housekeeping, housekeeping == 1 ? "" : "s");
+    return 1;
+}
+
+bool gs_rt_active(void)
+{
+    return rt_active;
+}
+
+int gs_rt_thread_attr(pthread_attr_t *attr, int priority, int cpu)
+{
+    pthread_attr_init(attr);
+    if (priority > 0)
+    {
+        struct sched_param param;
+        memset(&param, 0x0, sizeof(param));
+        param.sched_priority = priority;
+        if (pthread_attr_setinheritsched(attr, PTHREAD_EXPLICIT_SCHED) != 0 || pthread_attr_setschedpolicy(attr, SCHED_FIFO) != 0 ||
+            pthread_attr_setschedparam(attr, &param) != 0)
+        {
+            pthread_attr_destroy(attr);
+            pthread_attr_init(attr);
+            return 0;
+        }
+    }
+    if (cpu >= 0)
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        if (pthread_attr_setaffinity_np(attr, sizeof(cpus), &cpus) != 0)
+        {
+            pthread_attr_destroy(attr);
+            pthread_attr_init(attr);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+void gs_rt_prefault_stack(void)
+{
+    if (!rt_active)
+    {
+        return;
+    }
+    volatile uint8_t stack[GS_RT_STACK_PREFAULT];
+    long page = sysconf(_SC_PAGESIZE);
+    for (size_t i = 0; i < sizeof(stack); i += page)
+    {
+        stack[i] = 0;
+    }
+}
+
+typedef struct
+{
+    gs_rt_jitter_t *jitter;
+    uint32_t duration_ms;
+    const bool *stop;
+} rt_probe_t;
+
+static void *rt_jitter_thread(void *args)
+{
+    rt_probe_t *probe = (rt_probe_t *)args;
+    gs_rt_jitter_t *jitter = probe->jitter;
+    gs_rt_prefault_stack();
+
+    uint64_t interval = (uint64_t)jitter->interval_us * NSEC_PER_USEC;
+    uint64_t next = gs_time_ns() + interval;
+    uint64_t end = next + (uint64_t)probe->duration_ms * NSEC_PER_MSEC;
+    jitter->min_ns = UINT64_MAX;
+    while (next < end && (probe->stop == nullptr || !__atomic_load_n(probe->stop, __ATOMIC_ACQUIRE)))
+    {
+        gs_sleep_until_ns(next);
+        uint64_t now = gs_time_ns();
+        uint64_t late = now - next;
+        jitter->samples++;
+        jitter->sum_ns += late;
+        jitter->min_ns = late < jitter->min_ns ? late : jitter->min_ns;
+        jitter->max_ns = late > jitter->max_ns ? late : jitter->max_ns;
+        uint64_t us = late / NSEC_PER_USEC;
+        if (us < GS_RT_HIST_US)
+        {
+            jitter->hist[us]++;
+        }
+        else
+        {
+            jitter->overflow++;
+        }
+        // A wakeup later than a whole period skips the deadlines it missed rather than counting each one late.
+        do
+        {
+            next += interval;
+        } while (next <= now);
+    }
+    if (jitter->samples == 0)
+    {
+        jitter->min_ns = 0;
+    }
+    return nullptr;
+}
+
+int gs_rt_jitter_run(gs_rt_jitter_t *jitter, int priority, int cpu, uint32_t interval_us, uint32_t duration_ms, const bool *stop)
+{
+    memset(jitter, 0x0, sizeof(gs_rt_jitter_t));
+    jitter->interval_us = interval_us ? interval_us : GS_RT_JITTER_INTERVAL_US;
+    jitter->priority = priority;
+    jitter->cpu = cpu;
+    rt_probe_t probe[1] = {{jitter, duration_ms, stop}};
+
+    pthread_attr_t attr;
+    pthread_t tid;
+    int retval = gs_rt_thread_attr(&attr, priority, cpu) && pthread_create(&tid, &attr, rt_jitter_thread, probe) == 0;
+    pthread_attr_destroy(&attr);
+    if (!retval)
+    {
+        dbprintlf(RED_FG "Failed to start the jitter probe%s.", priority > 0 ? " with SCHED_FIFO (needs CAP_SYS_NICE)" : "");
+        return 0;
+    }
+    pthread_join(tid, NULL);
+    return 1;
+}
+
+uint64_t gs_rt_jitter_quantile(const gs_rt_jitter_t *jitter, double quantile)
+{
+    if (jitter->samples == 0)
+    {
+        return 0;
+    }
+    uint64_t rank = (uint64_t)(quantile * jitter->samples);
+    rank = rank < jitter->samples ? rank : jitter->samples - 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < GS_RT_HIST_US; i++)
+    {
+        seen += jitter->hist[i];
+        if (seen > rank)
+        {
+            return (uint64_t)(i + 1) * NSEC_PER_USEC;
+        }
+    }
+    return jitter->max_ns;
+}
+
+void gs_rt_jitter_print(const gs_rt_jitter_t *jitter)
+{
+    char policy[32] = "SCHED_OTHER";
+    if (jitter->priority > 0)
+    {
+        snprintf(policy, sizeof(policy), "SCHED_FIFO %d", jitter->priority);
+    }
+    char cpu[16] = "any CPU";
+    if (jitter->cpu >= 0)
+    {
+        snprintf(cpu, sizeof(cpu), "CPU %d", jitter->cpu);
+    }
+    dbprintlf(CYAN_FG "Jitter: %llu wakeups every %u us (%s, %s): min %.1f us, avg %.1f us, p99 %.0f us, p99.99 %.0f us, max %.1f us; %llu over %d us.",
+              (unsigned long long)jitter->samples, jitter->interval_us, policy, cpu, jitter->min_ns / 1e3,
+              jitter->samples ? (double)jitter->sum_ns / jitter->samples / 1e3 : 0.0, gs_rt_jitter_quantile(jitter, 0.99) / 1e3,
+              gs_rt_jitter_quantile(jitter, 0.9999) / 1e3, jitter->max_ns / 1e3, (unsigned long long)jitter->overflow, GS_RT_HIST_US);
+    for (int i = 0; i < GS_RT_HIST_US; i++)
+    {
+        if (jitter->hist[i])
+        {
+            printf("%6d us %12llu\n", i, (unsigned long long)jitter->hist[i]);
+        }
+    }
+    if (jitter->overflow)
+    {
+        printf("%5d+ us %12llu\n", GS_RT_HIST_US, (unsigned long long)jitter->overflow);
+    }
+}
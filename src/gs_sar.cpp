@@ -0,0 +1,455 @@
+/**
+ * @file gs_sar.cpp
+ * @author agent (agent@local)
+ * @brief Segmentation and reassembly of messages larger than one GST frame, with selective-repeat ACKs.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gs_sar.hpp"
+#include "gs_time.hpp"
+#include "meb_debug.hpp"
+
+static inline uint16_t sar_segments(uint32_t len)
+{
+    return (len + GS_SAR_SEGMENT_SIZE - 1) / GS_SAR_SEGMENT_SIZE;
+}
+
+static inline bool sar_have(gs_sar_t *sar, uint16_t seq)
+{
+    return sar->rx_have[seq >> 3] & (1 << (seq & 0x7));
+}
+
+gs_sar_t *gs_sar_create(size_t max_message)
+{
+    if (max_message == 0 || max_message > GS_SAR_MAX_MESSAGE)
+    {
+        dbprintlf(RED_FG "SAR messages of %zu bytes are not supported.", max_message);
+        return nullptr;
+    }
+
+    gs_sar_t *sar = (gs_sar_t *)calloc(1, sizeof(gs_sar_t));
+    if (sar == nullptr)
+    {
+        dbprintlf(FATAL "Failed to allocate SAR endpoint.");
+        return nullptr;
+    }
+    sar->max_message = max_message;
+    sar->rx_buf = (uint8_t *)calloc(1, max_message);
+    sar->rx_have = (uint8_t *)calloc(1, (sar_segments(max_message) + 7) / 8);
+    if (sar->rx_buf == nullptr || sar->rx_have == nullptr)
+    {
+        dbprintlf(FATAL "Failed to allocate SAR reassembly buffer.");
+        gs_sar_destroy(sar);
+        return nullptr;
+    }
+    sar->rto_ns = GS_SAR_RTO_INIT_MS * NSEC_PER_MSEC;
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&sar->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&sar->lock, NULL);
+
+    return sar;
+}
+
+void gs_sar_destroy(gs_sar_t *sar)
+{
+    if (sar == nullptr)
+    {
+        return;
+    }
+    pthread_cond_destroy(&sar->cond);
+    pthread_mutex_destroy(&sar->lock);
+    free(sar->rx_have);
+    free(sar->rx_buf);
+    free(sar);
+}
+
+static void sar_queue_ack(gs_sar_t *sar, uint8_t msg_id, uint16_t cumulative, uint16_t nseg)
+{
+    sar->ack.type = GS_SAR_ACK;
+    sar->ack.msg_id = msg_id;
+    sar->ack.cumulative = cumulative;
+    sar->ack.selective = 0;
+    for (int i = 0; i < 32 && cumulative + 1 + i < nseg; i++)
+    {
+        if (sar_have(sar, cumulative + 1 + i))
+        {
+            sar->ack.selective |= 1U << i;
+        }
+    }
+    sar->ack_pending = true;
+    sar->rx_since_ack = 0;
+}
+
+static int sar_data_input(gs_sar_t *sar, const uint8_t *payload)
+{
+    const gs_sar_header_t *hdr = (const gs_sar_header_t *)payload;
+    uint16_t nseg = sar_segments(hdr->total);
+    if (hdr->total == 0 || hdr->total > sar->max_message || hdr->seq >= nseg)
+    {
+        return -1;
+    }
+
+    // The sender lost our last ACK for a finished message: say again that we have all of it.
+    if (sar->rx_done_valid && hdr->msg_id == sar->rx_done_id && hdr->total == sar->rx_done_total && !(sar->rx_active && hdr->msg_id == sar->rx_id))
+    {
+        sar->stats.duplicates++;
+        sar->ack.type = GS_SAR_ACK;
+        sar->ack.msg_id = hdr->msg_id;
+        sar->ack.cumulative = sar->rx_done_nseg;
+        sar->ack.selective = 0;
+        sar->ack_pending = true;
+        return GS_SAR_IN_ACK;
+    }
+
+    if (!sar->rx_active || hdr->msg_id != sar->rx_id || hdr->total != sar->rx_total)
+    {
+        // A new message; whatever was left of the previous one is abandoned.
+        sar->rx_active = true;
+        sar->rx_id = hdr->msg_id;
+        sar->rx_lz = hdr->type == GS_SAR_DATA_LZ;
+        sar->rx_total = hdr->total;
+        sar->rx_nseg = nseg;
+        sar->rx_count = 0;
+        sar->rx_cumulative = 0;
+        sar->rx_since_ack = 0;
+        memset(sar->rx_have, 0x0, (nseg + 7) / 8);
+    }
+
+    if (sar_have(sar, hdr->seq))
+    {
+        sar->stats.duplicates++;
+        sar_queue_ack(sar, sar->rx_id, sar->rx_cumulative, nseg);
+        return GS_SAR_IN_ACK;
+    }
+
+    size_t offset = (size_t)hdr->seq * GS_SAR_SEGMENT_SIZE;
+    size_t len = hdr->total - offset < GS_SAR_SEGMENT_SIZE ? hdr->total - offset : GS_SAR_SEGMENT_SIZE;
+    memcpy(sar->rx_buf + offset, payload + sizeof(gs_sar_header_t), len);
+    sar->rx_have[hdr->seq >> 3] |= 1 << (hdr->seq & 0x7);
+    sar->rx_count++;
+    sar->rx_since_ack++;
+    sar->stats.segments_received++;
+    while (sar->rx_cumulative < nseg && sar_have(sar, sar->rx_cumulative))
+    {
+        sar->rx_cumulative++;
+    }
+
+    if (sar->rx_count == nseg)
+    {
+        sar->rx_active = false;
+        sar->rx_done_valid = true;
+        sar->rx_done_id = sar->rx_id;
+        sar->rx_done_total = sar->rx_total;
+        sar->rx_done_nseg = nseg;
+        sar->stats.messages_received++;
+        sar_queue_ack(sar, sar->rx_id, nseg, nseg);
+        return GS_SAR_IN_ACK | GS_SAR_IN_MESSAGE;
+    }
+
+    // A gap means something was lost; tell the sender now so it can resend without waiting for its timer.
+    if (sar->rx_cumulative <= hdr->seq || sar->rx_since_ack >= GS_SAR_ACK_EVERY)
+    {
+        sar_queue_ack(sar, sar->rx_id, sar->rx_cumulative, nseg);
+        return GS_SAR_IN_ACK;
+    }
+    return 0;
+}
+
+static void sar_rtt_sample(gs_sar_t *sar, uint64_t rtt_ns)
+{
+    // RFC 6298.
+    if (sar->srtt_ns == 0)
+    {
+        sar->srtt_ns = rtt_ns;
+        sar->rttvar_ns = rtt_ns / 2;
+    }
+    else
+    {
+        uint64_t err = rtt_ns > sar->srtt_ns ? rtt_ns - sar->srtt_ns : sar->srtt_ns - rtt_ns;
+        sar->rttvar_ns = (3 * sar->rttvar_ns + err) / 4;
+        sar->srtt_ns = (7 * sar->srtt_ns + rtt_ns) / 8;
+    }
+
+    uint64_t rto = sar->srtt_ns + 4 * sar->rttvar_ns;
+    rto = rto < GS_SAR_RTO_MIN_MS * NSEC_PER_MSEC ? GS_SAR_RTO_MIN_MS * NSEC_PER_MSEC : rto;
+    rto = rto > GS_SAR_RTO_MAX_MS * NSEC_PER_MSEC ? GS_SAR_RTO_MAX_MS * NSEC_PER_MSEC : rto;
+    sar->rto_ns = rto;
+}
+
+static void sar_ack_input(gs_sar_t *sar, const uint8_t *payload, uint64_t now_ns)
+{
+    const gs_sar_ack_t *ack = (const gs_sar_ack_t *)payload;
+    sar->stats.acks_received++;
+    if (!sar->tx_active || ack->msg_id != sar->tx_id)
+    {
+        // Late ACK for an earlier message.
+        return;
+    }
+
+    uint16_t cumulative = ack->cumulative < sar->tx_nseg ? ack->cumulative : sar->tx_nseg;
+    uint64_t newest_sent = 0;
+    uint64_t sample_sent = 0;
+    for (uint16_t seq = sar->tx_base; seq < sar->tx_next; seq++)
+    {
+        int w = seq % GS_SAR_WINDOW;
+        if (sar->tx_acked[w])
+        {
+            continue;
+        }
+        int bit = seq - cumulative - 1;
+        if (seq < cumulative || (bit >= 0 && bit < 32 && (ack->selective & (1U << bit))))
+        {
+            sar->tx_acked[w] = true;
+            newest_sent = sar->tx_sent_ns[w] > newest_sent ? sar->tx_sent_ns[w] : newest_sent;
+            // Karn: a retransmitted segment's ACK could belong to either copy.
+            if (sar->tx_tries[w] == 1 && sar->tx_sent_ns[w] > sample_sent)
+            {
+                sample_sent = sar->tx_sent_ns[w];
+            }
+        }
+    }
+
+    if (sample_sent && now_ns > sample_sent)
+    {
+        sar_rtt_sample(sar, now_ns - sample_sent);
+    }
+
+    // The air keeps frames in order, so anything sent before a segment that arrived, and still missing, was lost.
+    for (uint16_t seq = sar->tx_base; seq < sar->tx_next; seq++)
+    {
+        int w = seq % GS_SAR_WINDOW;
+        if (!sar->tx_acked[w] && sar->tx_sent_ns[w] < newest_sent)
+        {
+            sar->tx_sent_ns[w] = 0;
+        }
+    }
+
+    while (sar->tx_base < sar->tx_next && sar->tx_acked[sar->tx_base % GS_SAR_WINDOW])
+    {
+        sar->tx_base++;
+    }
+}
+
+int gs_sar_input(gs_sar_t *sar, const uint8_t *payload, uint64_t now_ns)
+{
+    int retval = -1;
+
+    pthread_mutex_lock(&sar->lock);
+    if (payload[0] == GS_SAR_DATA || payload[0] == GS_SAR_DATA_LZ)
+    {
+        retval = sar_data_input(sar, payload);
+    }
+    else if (payload[0] == GS_SAR_ACK)
+    {
+        sar_ack_input(sar, payload, now_ns);
+        retval = 0;
+    }
+    if (retval < 0)
+    {
+        sar->stats.malformed++;
+    }
+    sar->events++;
+    pthread_cond_broadcast(&sar->cond);
+    pthread_mutex_unlock(&sar->lock);
+
+    return retval;
+}
+
+const uint8_t *gs_sar_message(gs_sar_t *sar, size_t *len, bool *compressed)
+{
+    *len = sar->rx_total;
+    if (compressed != nullptr)
+    {
+        *compressed = sar->rx_lz;
+    }
+    return sar->rx_buf;
+}
+
+int gs_sar_take_ack(gs_sar_t *sar, uint8_t *payload)
+{
+    int retval = 0;
+
+    pthread_mutex_lock(&sar->lock);
+    if (sar->ack_pending)
+    {
+        memset(payload, 0x0, GST_MAX_PAYLOAD_SIZE);
+        memcpy(payload, &sar->ack, sizeof(gs_sar_ack_t));
+        sar->ack_pending = false;
+        sar->stats.acks_sent++;
+        retval = 1;
+    }
+    pthread_mutex_unlock(&sar->lock);
+
+    return retval;
+}
+
+int gs_sar_send_start(gs_sar_t *sar, const void *msg, size_t len, bool compressed)
+{
+    if (len == 0 || len > GS_SAR_MAX_MESSAGE)
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock(&sar->lock);
+    if (sar->tx_active)
+    {
+        pthread_mutex_unlock(&sar->lock);
+        return 0;
+    }
+    sar->tx_active = true;
+    sar->tx_msg = (const uint8_t *)msg;
+    sar->tx_len = len;
+    sar->tx_nseg = sar_segments(len);
+    sar->tx_base = 0;
+    sar->tx_next = 0;
+    sar->tx_id++;
+    sar->tx_lz = compressed;
+    pthread_mutex_unlock(&sar->lock);
+
+    return 1;
+}
+
+void gs_sar_send_abort(gs_sar_t *sar)
+{
+    pthread_mutex_lock(&sar->lock);
+    if (sar->tx_active)
+    {
+        sar->tx_active = false;
+        sar->stats.messages_failed++;
+    }
+    pthread_mutex_unlock(&sar->lock);
+}
+
+static void sar_build_segment(gs_sar_t *sar, uint16_t seq, uint8_t *payload)
+{
+    gs_sar_header_t *hdr = (gs_sar_header_t *)payload;
+    size_t offset = (size_t)seq * GS_SAR_SEGMENT_SIZE;
+    size_t len = sar->tx_len - offset < GS_SAR_SEGMENT_SIZE ? sar->tx_len - offset : GS_SAR_SEGMENT_SIZE;
+
+    memset(payload, 0x0, GST_MAX_PAYLOAD_SIZE);
+    hdr->type = sar->tx_lz ? GS_SAR_DATA_LZ : GS_SAR_DATA;
+    hdr->msg_id = sar->tx_id;
+    hdr->seq = seq;
+    hdr->total = sar->tx_len;
+    memcpy(payload + sizeof(gs_sar_header_t), sar->tx_msg + offset, len);
+}
+
+gs_sar_status_t gs_sar_send_poll(gs_sar_t *sar, uint64_t now_ns, uint8_t *payload, uint64_t *wake_ns)
+{
+    gs_sar_status_t retval = GS_SAR_WAIT;
+
+    pthread_mutex_lock(&sar->lock);
+    if (!sar->tx_active)
+    {
+        pthread_mutex_unlock(&sar->lock);
+        return GS_SAR_IDLE;
+    }
+
+    if (sar->tx_base == sar->tx_nseg)
+    {
+        sar->tx_active = false;
+        sar->stats.messages_sent++;
+        pthread_mutex_unlock(&sar->lock);
+        return GS_SAR_DONE;
+    }
+
+    uint64_t wake = UINT64_MAX;
+    for (uint16_t seq = sar->tx_base; seq < sar->tx_next; seq++)
+    {
+        int w = seq % GS_SAR_WINDOW;
+        if (sar->tx_acked[w])
+        {
+            continue;
+        }
+        uint64_t due = sar->tx_sent_ns[w] + sar->rto_ns;
+        if (sar->tx_sent_ns[w] == 0 || due <= now_ns)
+        {
+            if (sar->tx_tries[w] >= GS_SAR_MAX_TRIES)
+            {
+                sar->tx_active = false;
+                sar->stats.messages_failed++;
+                pthread_mutex_unlock(&sar->lock);
+                return GS_SAR_FAILED;
+            }
+            if (sar->tx_sent_ns[w] != 0 && seq == sar->tx_base)
+            {
+                // The oldest segment timed out rather than being inferred lost from an ACK: back off, once per window.
+                sar->rto_ns = sar->rto_ns * 2 > GS_SAR_RTO_MAX_MS * NSEC_PER_MSEC ? GS_SAR_RTO_MAX_MS * NSEC_PER_MSEC : sar->rto_ns * 2;
+            }
+            sar_build_segment(sar, seq, payload);
+            sar->tx_sent_ns[w] = now_ns;
+            sar->tx_tries[w]++;
+            sar->stats.segments_sent++;
+            sar->stats.retransmits++;
+            pthread_mutex_unlock(&sar->lock);
+            return GS_SAR_SEND;
+        }
+        wake = due < wake ? due : wake;
+    }
+
+    if (sar->tx_next < sar->tx_nseg && sar->tx_next < sar->tx_base + GS_SAR_WINDOW)
+    {
+        int w = sar->tx_next % GS_SAR_WINDOW;
+        sar_build_segment(sar, sar->tx_next, payload);
+        sar->tx_sent_ns[w] = now_ns;
+        sar->tx_tries[w] = 1;
+        sar->tx_acked[w] = false;
+        sar->tx_next++;
+        sar->stats.segments_sent++;
+        retval = GS_SAR_SEND;
+    }
+    else
+    {
+        *wake_ns = wake;
+    }
+    pthread_mutex_unlock(&sar->lock);
+
+    return retval;
+}
+
+void gs_sar_wait(gs_sar_t *sar, uint64_t until_ns)
+{
+    struct timespec ts;
+    ts.tv_sec = until_ns / NSEC_PER_SEC;
+    ts.tv_nsec = until_ns % NSEC_PER_SEC;
+
+    pthread_mutex_lock(&sar->lock);
+    uint32_t events = sar->events;
+    while (sar->events == events && !sar->ack_pending && gs_time_ns() < until_ns)
+    {
+        pthread_cond_timedwait(&sar->cond, &sar->lock, &ts);
+    }
+    pthread_mutex_unlock(&sar->lock);
+}
+
+void gs_sar_get_stats(gs_sar_t *sar, gs_sar_stats_t *stats)
+{
+    pthread_mutex_lock(&sar->lock);
+    *stats = sar->stats;
+    stats->rto_ms = sar->rto_ns / NSEC_PER_MSEC;
+    pthread_mutex_unlock(&sar->lock);
+}
+
+void gs_sar_print_stats(const char *name, gs_sar_t *sar)
+{
+    gs_sar_stats_t stats[1];
+    gs_sar_get_stats(sar, stats);
+    dbprintlf(CYAN_FG "%s SAR: sent %llu messages (%llu failed) in %llu segments, %llu retransmitted, %llu ACKs in, RTO %u ms.",
+              name, (unsigned long long)stats->messages_sent, (unsigned long long)stats->messages_failed,
+              (unsigned long long)stats->segments_sent, (unsigned long long)stats->retransmits,
+              (unsigned long long)stats->acks_received, stats->rto_ms);
+    dbprintlf(CYAN_FG "%s SAR: received %llu messages in %llu segments, %llu duplicates, %llu malformed, %llu ACKs out.",
+              name, (unsigned long long)stats->messages_received, (unsigned long long)stats->segments_received,
+              (unsigned long long)stats->duplicates, (unsigned long long)stats->malformed, (unsigned long long)stats->acks_sent);
+}
@@ -0,0 +1,437 @@
+/**
+ * @file gs_sgp4.cpp
+ * @author agent (agent@local)
+ * @brief Two-line element sets, the SGP4 propagator, and where a satellite is as seen from the station.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "gs_sgp4.hpp"
+
+// WGS-72, what the element sets are fitted with.
+#define SGP4_MU 398600.8
+#define SGP4_RE 6378.135
+#define SGP4_J2 0.001082616
+#define SGP4_J3 -0.00000253881
+#define SGP4_J4 -0.00000165597
+#define SGP4_TWOPI (2 * M_PI)
+#define SGP4_MIN_PER_DAY 1440.0
+#define SGP4_DEEP_SPACE_MIN 225.0 // Periods from here on need SDP4.
+
+// WGS-84, what the station's position is given in.
+#define WGS84_A 6378.137
+#define WGS84_F (1 / 298.257223563)
+#define EARTH_ROTATION 7.292115e-5 // rad/s
+
+static const double sgp4_xke = 60.0 / sqrt(SGP4_RE * SGP4_RE * SGP4_RE / SGP4_MU);
+
+/**
+ * @brief Copies columns [start, end] (1-based, as the format is documented) of a TLE line.
+ */
+static void tle_field(const char *line, int start, int end, char *out)
+{
+    int len = end - start + 1;
+    memcpy(out, line + start - 1, len);
+    out[len] = '\0';
+}
+
+/**
+ * @brief Reads a field with an assumed leading decimal point and a power of ten, e.g. " 28098-4" is 0.28098e-4.
+ */
+static double tle_exp(const char *field)
+{
+    char mantissa[16], *at = mantissa;
+    const char *in = field;
+    while (*in == ' ')
+    {
+        in++;
+    }
+    if (*in == '-' || *in == '+')
+    {
+        *at++ = *in++;
+    }
+    *at++ = '0';
+    *at++ = '.';
+    while (*in >= '0' && *in <= '9' && at < mantissa + sizeof(mantissa) - 1)
+    {
+        *at++ = *in++;
+    }
+    *at = '\0';
+    return atof(mantissa) * pow(10.0, atoi(in));
+}
+
+static bool tle_checksum(const char *line)
+{
+    int sum = 0;
+    for (int i = 0; i < 68; i++)
+    {
+        if (line[i] >= '0' && line[i] <= '9')
+        {
+            sum += line[i] - '0';
+        }
+        else if (line[i] == '-')
+        {
+            sum++;
+        }
+    }
+    return line[68] - '0' == sum % 10;
+}
+
+/**
+ * @brief Days from 1970-01-01 to the first of January of a year.
+ */
+static long tle_days_to_year(int year)
+{
+    long days = 0;
+    for (int y = 1970; y < year; y++)
+    {
+        days += (y % 4 == 0 && (y % 100 != 0 || y % 400 == 0)) ? 366 : 365;
+    }
+    for (int y = year; y < 1970; y++)
+    {
+        days -= (y % 4 == 0 && (y % 100 != 0 || y % 400 == 0)) ? 366 : 365;
+    }
+    return days;
+}
+
+int gs_tle_parse(const char *name, const char *line1, const char *line2, gs_tle_t *tle)
+{
+    memset(tle, 0x0, sizeof(gs_tle_t));
+    if (strlen(line1) < 69 || strlen(line2) < 69 || line1[0] != '1' || line2[0] != '2' || !tle_checksum(line1) || !tle_checksum(line2))
+    {
+        return 0;
+    }
+    if (name != nullptr)
+    {
+        // "0 NAME" in the three-line format some sources use.
+        const char *at = strncmp(name, "0 ", 2) == 0 ? name + 2 : name;
+        snprintf(tle->name, sizeof(tle->name), "%s", at);
+        for (int i = strlen(tle->name) - 1; i >= 0 && (tle->name[i] == ' ' || tle->name[i] == '\r' || tle->name[i] == '\n'); i--)
+        {
+            tle->name[i] = '\0';
+        }
+    }
+
+    char field[GS_TLE_LINE_MAX];
+    tle_field(line1, 3, 7, field);
+    tle->catnum = atoi(field);
+    tle_field(line2, 3, 7, field);
+    if (atoi(field) != tle->catnum)
+    {
+        return 0;
+    }
+
+    tle_field(line1, 19, 20, field);
+    int year = atoi(field);
+    year += year < 57 ? 2000 : 1900;
+    tle_field(line1, 21, 32, field);
+    tle->epoch = tle_days_to_year(year) * 86400.0 + (atof(field) - 1) * 86400.0;
+    tle_field(line1, 54, 61, field);
+    tle->bstar = tle_exp(field);
+
+    double deg = M_PI / 180;
+    tle_field(line2, 9, 16, field);
+    tle->inclo = atof(field) * deg;
+    tle_field(line2, 18, 25, field);
+    tle->nodeo = atof(field) * deg;
+    field[0] = '.';
+    tle_field(line2, 27, 33, field + 1);
+    tle->ecco = atof(field);
+    tle_field(line2, 35, 42, field);
+    tle->argpo = atof(field) * deg;
+    tle_field(line2, 44, 51, field);
+    tle->mo = atof(field) * deg;
+    tle_field(line2, 53, 63, field);
+    tle->no_kozai = atof(field) * SGP4_TWOPI / SGP4_MIN_PER_DAY;
+    return tle->no_kozai > 0 && tle->ecco < 1;
+}
+
+int gs_sgp4_init(gs_sgp4_t *sat, const gs_tle_t *tle)
+{
+    memset(sat, 0x0, sizeof(gs_sgp4_t));
+    sat->tle = *tle;
+    double ecco = tle->ecco, inclo = tle->inclo, argpo = tle->argpo, bstar = tle->bstar;
+    double x2o3 = 2.0 / 3.0, j3oj2 = SGP4_J3 / SGP4_J2;
+
+    // Recover the original mean motion and semi-major axis from the Kozai mean motion.
+    double eccsq = ecco * ecco;
+    double omeosq = 1 - eccsq;
+    double rteosq = sqrt(omeosq);
+    sat->cosio = cos(inclo);
+    double cosio2 = sat->cosio * sat->cosio;
+    double ak = pow(sgp4_xke / tle->no_kozai, x2o3);
+    double d1 = 0.75 * SGP4_J2 * (3 * cosio2 - 1) / (rteosq * omeosq);
+    double del = d1 / (ak * ak);
+    double adel = ak * (1 - del * del - del * (1.0 / 3.0 + 134 * del * del / 81));
+    del = d1 / (adel * adel);
+    sat->no = tle->no_kozai / (1 + del);
+    if (SGP4_TWOPI / sat->no >= SGP4_DEEP_SPACE_MIN)
+    {
+        return 0;
+    }
+    sat->ao = pow(sgp4_xke / sat->no, x2o3);
+    sat->sinio = sin(inclo);
+    double po = sat->ao * omeosq;
+    sat->con42 = 1 - 5 * cosio2;
+    sat->con41 = -sat->con42 - cosio2 - cosio2;
+    double posq = po * po;
+    double rp = sat->ao * (1 - ecco);
+    if (omeosq <= 0 || rp < 1)
+    {
+        return 0;
+    }
+
+    // Perigee below 220 km: the drag terms past second order are dropped.
+    sat->isimp = rp < 220 / SGP4_RE + 1;
+    double ss = 78 / SGP4_RE + 1;
+    double qzms2t = pow((120 - 78) / SGP4_RE, 4);
+    double sfour = ss, qzms24 = qzms2t;
+    double perige = (rp - 1) * SGP4_RE;
+    if (perige < 156)
+    {
+        sfour = perige < 98 ? 20 : perige - 78;
+        qzms24 = pow((120 - sfour) / SGP4_RE, 4);
+        sfour = sfour / SGP4_RE + 1;
+    }
+    double pinvsq = 1 / posq;
+    double tsi = 1 / (sat->ao - sfour);
+    sat->eta = sat->ao * ecco * tsi;
+    double etasq = sat->eta * sat->eta;
+    double eeta = ecco * sat->eta;
+    double psisq = fabs(1 - etasq);
+    double coef = qzms24 * pow(tsi, 4);
+    double coef1 = coef / pow(psisq, 3.5);
+    double cc2 = coef1 * sat->no * (sat->ao * (1 + 1.5 * etasq + eeta * (4 + etasq)) + 0.375 * SGP4_J2 * tsi / psisq * sat->con41 * (8 + 3 * etasq * (8 + etasq)));
+    sat->cc1 = bstar * cc2;
+    double cc3 = ecco > 1.0e-4 ? -2 * coef * tsi * j3oj2 * sat->no * sat->sinio / ecco : 0;
+    sat->x1mth2 = 1 - cosio2;
+    sat->cc4 = 2 * sat->no * coef1 * sat->ao * omeosq *
+               (sat->eta * (2 + 0.5 * etasq) + ecco * (0.5 + 2 * etasq) -
+                SGP4_J2 * tsi / (sat->ao * psisq) *
+                    (-3 * sat->con41 * (1 - 2 * eeta + etasq * (1.5 - 0.5 * eeta)) + 0.75 * sat->x1mth2 * (2 * etasq - eeta * (1 + etasq)) * cos(2 * argpo)));
+    sat->cc5 = 2 * coef1 * sat->ao * omeosq * (1 + 2.75 * (etasq + eeta) + eeta * etasq);
+
+    double cosio4 = cosio2 * cosio2;
+    double temp1 = 1.5 * SGP4_J2 * pinvsq * sat->no;
+    double temp2 = 0.5 * temp1 * SGP4_J2 * pinvsq;
+    double temp3 = -0.46875 * SGP4_J4 * pinvsq * pinvsq * sat->no;
+    sat->mdot = sat->no + 0.5 * temp1 * rteosq * sat->con41 + 0.0625 * temp2 * rteosq * (13 - 78 * cosio2 + 137 * cosio4);
+    sat->argpdot = -0.5 * temp1 * sat->con42 + 0.0625 * temp2 * (7 - 114 * cosio2 + 395 * cosio4) + temp3 * (3 - 36 * cosio2 + 49 * cosio4);
+    double xhdot1 = -temp1 * sat->cosio;
+    sat->nodedot = xhdot1 + (0.5 * temp2 * (4 - 19 * cosio2) + 2 * temp3 * (3 - 7 * cosio2)) * sat->cosio;
+    sat->omgcof = bstar * cc3 * cos(argpo);
+    sat->xmcof = ecco > 1.0e-4 ? -x2o3 * coef * bstar / eeta : 0;
+    sat->nodecf = 3.5 * omeosq * xhdot1 * sat->cc1;
+    sat->t2cof = 1.5 * sat->cc1;
+    // Avoids a division by zero at 180 degrees of inclination.
+    double denom = fabs(sat->cosio + 1) > 1.5e-12 ? 1 + sat->cosio : 1.5e-12;
+    sat->xlcof = -0.25 * j3oj2 * sat->sinio * (3 + 5 * sat->cosio) / denom;
+    sat->aycof = -0.5 * j3oj2 * sat->sinio;
+    sat->delmo = pow(1 + sat->eta * cos(tle->mo), 3);
+    sat->sinmao = sin(tle->mo);
+    sat->x7thm1 = 7 * cosio2 - 1;
+
+    if (!sat->isimp)
+    {
+        double cc1sq = sat->cc1 * sat->cc1;
+        sat->d2 = 4 * sat->ao * tsi * cc1sq;
+        double temp = sat->d2 * tsi * sat->cc1 / 3;
+        sat->d3 = (17 * sat->ao + sfour) * temp;
+        sat->d4 = 0.5 * temp * sat->ao * tsi * (221 * sat->ao + 31 * sfour) * sat->cc1;
+        sat->t3cof = sat->d2 + 2 * cc1sq;
+        sat->t4cof = 0.25 * (3 * sat->d3 + sat->cc1 * (12 * sat->d2 + 10 * cc1sq));
+        sat->t5cof = 0.2 * (3 * sat->d4 + 12 * sat->cc1 * sat->d3 + 6 * sat->d2 * sat->d2 + 15 * cc1sq * (2 * sat->d2 + cc1sq));
+    }
+    return 1;
+}
+
+int gs_sgp4_propagate(const gs_sgp4_t *sat, double t, double r[3], double v[3])
+{
+    const gs_tle_t *tle = &sat->tle;
+    double x2o3 = 2.0 / 3.0;
+
+    // Secular gravity and atmospheric drag.
+    double xmdf = tle->mo + sat->mdot * t;
+    double argpdf = tle->argpo + sat->argpdot * t;
+    double nodedf = tle->nodeo + sat->nodedot * t;
+    double argpm = argpdf;
+    double mm = xmdf;
+    double t2 = t * t;
+    double nodem = nodedf + sat->nodecf * t2;
+    double tempa = 1 - sat->cc1 * t;
+    double tempe = tle->bstar * sat->cc4 * t;
+    double templ = sat->t2cof * t2;
+    if (!sat->isimp)
+    {
+        double delomg = sat->omgcof * t;
+        double delmtemp = 1 + sat->eta * cos(xmdf);
+        double delm = sat->xmcof * (delmtemp * delmtemp * delmtemp - sat->delmo);
+        double temp = delomg + delm;
+        mm = xmdf + temp;
+        argpm = argpdf - temp;
+        double t3 = t2 * t;
+        double t4 = t3 * t;
+        tempa = tempa - sat->d2 * t2 - sat->d3 * t3 - sat->d4 * t4;
+        tempe = tempe + tle->bstar * sat->cc5 * (sin(mm) - sat->sinmao);
+        templ = templ + sat->t3cof * t3 + t4 * (sat->t4cof + t * sat->t5cof);
+    }
+
+    double am = pow(sgp4_xke / sat->no, x2o3) * tempa * tempa;
+    double nm = sgp4_xke / pow(am, 1.5);
+    double em = tle->ecco - tempe;
+    if (em >= 1 || em < -0.001 || am < 0.95)
+    {
+        return 0;
+    }
+    if (em < 1.0e-6)
+    {
+        em = 1.0e-6;
+    }
+    mm = mm + sat->no * templ;
+    double xlm = mm + argpm + nodem;
+    nodem = fmod(nodem, SGP4_TWOPI);
+    argpm = fmod(argpm, SGP4_TWOPI);
+    xlm = fmod(xlm, SGP4_TWOPI);
+    mm = fmod(xlm - argpm - nodem, SGP4_TWOPI);
+
+    // Long-period periodics.
+    double axnl = em * cos(argpm);
+    double temp = 1 / (am * (1 - em * em));
+    double aynl = em * sin(argpm) + temp * sat->aycof;
+    double xl = mm + argpm + nodem + temp * sat->xlcof * axnl;
+
+    // Kepler's equation.
+    double u = fmod(xl - nodem, SGP4_TWOPI);
+    double eo1 = u, tem5 = 9999.9, sineo1 = 0, coseo1 = 0;
+    for (int ktr = 1; fabs(tem5) >= 1.0e-12 && ktr <= 10; ktr++)
+    {
+        sineo1 = sin(eo1);
+        coseo1 = cos(eo1);
+        tem5 = 1 - coseo1 * axnl - sineo1 * aynl;
+        tem5 = (u - aynl * coseo1 + axnl * sineo1 - eo1) / tem5;
+        if (fabs(tem5) >= 0.95)
+        {
+            tem5 = tem5 > 0 ? 0.95 : -0.95;
+        }
+        eo1 = eo1 + tem5;
+    }
+
+    // Short-period periodics.
+    double ecose = axnl * coseo1 + aynl * sineo1;
+    double esine = axnl * sineo1 - aynl * coseo1;
+    double el2 = axnl * axnl + aynl * aynl;
+    double pl = am * (1 - el2);
+    if (pl < 0)
+    {
+        return 0;
+    }
+    double rl = am * (1 - ecose);
+    double rdotl = sqrt(am) * esine / rl;
+    double rvdotl = sqrt(pl) / rl;
+    double betal = sqrt(1 - el2);
+    temp = esine / (1 + betal);
+    double sinu = am / rl * (sineo1 - aynl - axnl * temp);
+    double cosu = am / rl * (coseo1 - axnl + aynl * temp);
+    double su = atan2(sinu, cosu);
+    double sin2u = (cosu + cosu) * sinu;
+    double cos2u = 1 - 2 * sinu * sinu;
+    temp = 1 / pl;
+    double temp1 = 0.5 * SGP4_J2 * temp;
+    double temp2 = temp1 * temp;
+
+    double mrt = rl * (1 - 1.5 * temp2 * betal * sat->con41) + 0.5 * temp1 * sat->x1mth2 * cos2u;
+    su = su - 0.25 * temp2 * sat->x7thm1 * sin2u;
+    double xnode = nodem + 1.5 * temp2 * sat->cosio * sin2u;
+    double xinc = tle->inclo + 1.5 * temp2 * sat->cosio * sat->sinio * cos2u;
+    double mvt = rdotl - nm * temp1 * sat->x1mth2 * sin2u / sgp4_xke;
+    double rvdot = rvdotl + nm * temp1 * (sat->x1mth2 * cos2u + 1.5 * sat->con41) / sgp4_xke;
+    if (mrt < 1)
+    {
+        // Below the surface.
+        return 0;
+    }
+
+    // Orientation vectors.
+    double sinsu = sin(su), cossu = cos(su);
+    double snod = sin(xnode), cnod = cos(xnode);
+    double sini = sin(xinc), cosi = cos(xinc);
+    double xmx = -snod * cosi;
+    double xmy = cnod * cosi;
+    double ux = xmx * sinsu + cnod * cossu;
+    double uy = xmy * sinsu + snod * cossu;
+    double uz = sini * sinsu;
+    double vx = xmx * cossu - cnod * sinsu;
+    double vy = xmy * cossu - snod * sinsu;
+    double vz = sini * cossu;
+
+    double vkmpersec = SGP4_RE * sgp4_xke / 60;
+    r[0] = mrt * ux * SGP4_RE;
+    r[1] = mrt * uy * SGP4_RE;
+    r[2] = mrt * uz * SGP4_RE;
+    v[0] = (mvt * ux + rvdot * vx) * vkmpersec;
+    v[1] = (mvt * uy + rvdot * vy) * vkmpersec;
+    v[2] = (mvt * uz + rvdot * vz) * vkmpersec;
+    return 1;
+}
+
+double gs_sgp4_gmst(double t)
+{
+    // IAU-82, in seconds of time, from Julian centuries of UT1 since J2000.
+    double tut1 = (t / 86400.0 + 2440587.5 - 2451545.0) / 36525.0;
+    double temp = -6.2e-6 * tut1 * tut1 * tut1 + 0.093104 * tut1 * tut1 + (876600.0 * 3600 + 8640184.812866) * tut1 + 67310.54841;
+    temp = fmod(temp * (M_PI / 180) / 240.0, SGP4_TWOPI);
+    return temp < 0 ? temp + SGP4_TWOPI : temp;
+}
+
+void gs_sgp4_station(gs_station_t *station)
+{
+    double e2 = WGS84_F * (2 - WGS84_F);
+    double sinlat = sin(station->lat), coslat = cos(station->lat);
+    double n = WGS84_A / sqrt(1 - e2 * sinlat * sinlat);
+    station->ecef[0] = (n + station->alt) * coslat * cos(station->lon);
+    station->ecef[1] = (n + station->alt) * coslat * sin(station->lon);
+    station->ecef[2] = (n * (1 - e2) + station->alt) * sinlat;
+}
+
+int gs_sgp4_look(const gs_sgp4_t *sat, const gs_station_t *station, double t, gs_look_t *look)
+{
+    double r[3], v[3];
+    if (!gs_sgp4_propagate(sat, (t - sat->tle.epoch) / 60.0, r, v))
+    {
+        return 0;
+    }
+
+    // TEME to earth-fixed: a rotation by GMST, and the earth's turning taken out of the velocity.
+    double gmst = gs_sgp4_gmst(t);
+    double cg = cos(gmst), sg = sin(gmst);
+    double x = cg * r[0] + sg * r[1];
+    double y = -sg * r[0] + cg * r[1];
+    double z = r[2];
+    double vx = cg * v[0] + sg * v[1] + EARTH_ROTATION * y;
+    double vy = -sg * v[0] + cg * v[1] - EARTH_ROTATION * x;
+    double vz = v[2];
+
+    double dx = x - station->ecef[0], dy = y - station->ecef[1], dz = z - station->ecef[2];
+    double sinlat = sin(station->lat), coslat = cos(station->lat);
+    double sinlon = sin(station->lon), coslon = cos(station->lon);
+    double east = -sinlon * dx + coslon * dy;
+    double north = -sinlat * coslon * dx - sinlat * sinlon * dy + coslat * dz;
+    double up = coslat * coslon * dx + coslat * sinlon * dy + sinlat * dz;
+
+    look->range = sqrt(dx * dx + dy * dy + dz * dz);
+    look->el = asin(up / look->range);
+    look->az = atan2(east, north);
+    if (look->az < 0)
+    {
+        look->az += SGP4_TWOPI;
+    }
+    look->range_rate = (dx * vx + dy * vy + dz * vz) / look->range;
+    return 1;
+}
@@ -0,0 +1,471 @@
+/**
+ * @file gs_spool.cpp
+ * @author agent (agent@local)
+ * @brief Store-and-forward spool: downlinked frames kept on disk while the server is unreachable.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include "gs_spool.hpp"
+#include "gs_crc.hpp"
+#include "gs_time.hpp"
+#include "meb_debug.hpp"
+
+typedef struct
+{
+    uint64_t seq;
+    int fd;
+    uint64_t size;    // End of the last record, where the next one is appended.
+    uint64_t drained; // Start of the first record not yet delivered.
+    uint64_t frames;  // Records between the two.
+} spool_segment_t;
+
+struct gs_spool
+{
+    char dir[GS_SPOOL_PATH_MAX];
+    size_t segment_bytes;
+    size_t max_bytes;
+    spool_segment_t *segments; // Oldest first.
+    int count;
+    uint64_t next_seq;
+    size_t peeked;      // Record gs_spool_peek() returned, 0 if none.
+    bool dirty;         // Appended or drained since the last sync.
+    bool full;          // Refusing appends, logged once.
+    uint64_t synced_ns; // Last fdatasync().
+    gs_spool_stats_t stats; // Written with __atomic builtins for gs_spool_get_stats().
+};
+
+static void spool_stat(uint64_t *stat, int64_t by)
+{
+    __atomic_store_n(stat, __atomic_load_n(stat, __ATOMIC_RELAXED) + by, __ATOMIC_RELAXED);
+}
+
+static int spool_path(gs_spool_t *spool, uint64_t seq, char *path)
+{
+    int len = snprintf(path, GS_SPOOL_PATH_MAX, "%s/%016llx.spool", spool->dir, (unsigned long long)seq);
+    return len > 0 && len < GS_SPOOL_PATH_MAX;
+}
+
+/**
+ * @brief Checks the record at offset and reads its payload into buf (if not nullptr).
+ * 
+ * @return ssize_t The payload's length, negative if there is no valid record there.
+ */
+static ssize_t spool_record(int fd, uint64_t offset, gs_spool_record_t *record, void *buf, size_t size)
+{
+    uint8_t scratch[GS_SPOOL_MAX_RECORD];
+    if (pread(fd, record, sizeof(gs_spool_record_t), offset) != sizeof(gs_spool_record_t) || record->magic != GS_SPOOL_RECORD_MAGIC)
+    {
+        return -1;
+    }
+    if (buf == nullptr)
+    {
+        buf = scratch;
+        size = sizeof(scratch);
+    }
+    if (record->len > size || pread(fd, buf, record->len, offset + sizeof(gs_spool_record_t)) != record->len ||
+        gs_crc16(buf, record->len) != record->crc)
+    {
+        return -1;
+    }
+    return record->len;
+}
+
+static void spool_remove(gs_spool_t *spool, int i)
+{
+    spool_segment_t *segment = &spool->segments[i];
+    char path[GS_SPOOL_PATH_MAX];
+    close(segment->fd);
+    if (spool_path(spool, segment->seq, path) && unlink(path) < 0)
+    {
+        dbprintlf(RED_FG "Failed to delete spool segment %s.", path);
+        erprintlf(errno);
+    }
+    spool_stat(&spool->stats.frames, -(int64_t)segment->frames);
+    spool_stat(&spool->stats.bytes, -(int64_t)(segment->size - segment->drained));
+    memmove(segment, segment + 1, (spool->count - i - 1) * sizeof(spool_segment_t));
+    spool->count--;
+    __atomic_store_n(&spool->stats.segments, spool->count, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Rebuilds a segment left by an earlier run: counts its undelivered records and cuts off a torn one.
+ */
+static void spool_recover(gs_spool_t *spool, uint64_t seq)
+{
+    char path[GS_SPOOL_PATH_MAX];
+    if (!spool_path(spool, seq, path))
+    {
+        return;
+    }
+    spool_segment_t *segment = &spool->segments[spool->count];
+    segment->seq = seq;
+    segment->frames = 0;
+    segment->fd = open(path, O_RDWR | O_CLOEXEC);
+    if (segment->fd < 0)
+    {
+        dbprintlf(RED_FG "Cannot open spool segment %s.", path);
+        erprintlf(errno);
+        return;
+    }
+    spool->count++;
+    __atomic_store_n(&spool->stats.segments, spool->count, __ATOMIC_RELAXED);
+
+    gs_spool_header_t header[1];
+    struct stat st;
+    if (pread(segment->fd, header, sizeof(header), 0) != sizeof(header) || memcmp(header->magic, GS_SPOOL_MAGIC, sizeof(header->magic)) != 0 ||
+        header->seq != seq || fstat(segment->fd, &st) < 0 || header->drained < sizeof(header) || header->drained > (uint64_t)st.st_size)
+    {
+        // Nothing in it can be trusted, not even where its records start.
+        dbprintlf(RED_FG "%s is not a spool segment, deleting it.", path);
+        segment->size = segment->drained = sizeof(header);
+        spool_stat(&spool->stats.corrupt, 1);
+        spool_remove(spool, spool->count - 1);
+        return;
+    }
+
+    segment->drained = segment->size = header->drained;
+    gs_spool_record_t record[1];
+    ssize_t len;
+    while ((len = spool_record(segment->fd, segment->size, record, nullptr, 0)) >= 0)
+    {
+        segment->size += sizeof(gs_spool_record_t) + len;
+        segment->frames++;
+    }
+    if (segment->size < (uint64_t)st.st_size)
+    {
+        dbprintlf(YELLOW_FG "Cutting %llu bytes that are not a whole record off the end of %s.",
+                  (unsigned long long)(st.st_size - segment->size), path);
+        spool_stat(&spool->stats.corrupt, 1);
+        if (ftruncate(segment->fd, segment->size) < 0)
+        {
+            erprintlf(errno);
+        }
+    }
+    spool_stat(&spool->stats.frames, segment->frames);
+    spool_stat(&spool->stats.bytes, segment->size - segment->drained);
+    if (segment->frames == 0)
+    {
+        spool_remove(spool, spool->count - 1);
+    }
+}
+
+static int spool_seq_cmp(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+gs_spool_t *gs_spool_open(const char *dir, size_t segment_bytes, size_t max_bytes)
+{
+    if (dir == nullptr || strlen(dir) + 24 >= GS_SPOOL_PATH_MAX || segment_bytes < sizeof(gs_spool_header_t) + sizeof(gs_spool_record_t) + GS_SPOOL_MAX_RECORD)
+    {
+        dbprintlf(RED_FG "Invalid spool directory or segment size.");
+        return nullptr;
+    }
+    if (mkdir(dir, 0755) < 0 && errno != EEXIST)
+    {
+        dbprintlf(RED_FG "Cannot create spool directory %s.", dir);
+        erprintlf(errno);
+        return nullptr;
+    }
+    DIR *d = opendir(dir);
+    if (d == nullptr)
+    {
+        dbprintlf(RED_FG "Cannot open spool directory %s.", dir);
+        erprintlf(errno);
+        return nullptr;
+    }
+
+    gs_spool_t *spool = (gs_spool_t *)calloc(1, sizeof(gs_spool_t));
+    uint64_t *seqs = (uint64_t *)malloc(GS_SPOOL_MAX_SEGMENTS * sizeof(uint64_t));
+    if (spool == nullptr || seqs == nullptr || (spool->segments = (spool_segment_t *)calloc(GS_SPOOL_MAX_SEGMENTS, sizeof(spool_segment_t))) == nullptr)
+    {
+        dbprintlf(FATAL "Failed to allocate the spool.");
+        closedir(d);
+        free(seqs);
+        free(spool);
+        return nullptr;
+    }
+    strcpy(spool->dir, dir);
+    spool->segment_bytes = segment_bytes;
+    spool->max_bytes = max_bytes;
+    spool->synced_ns = gs_time_ns();
+
+    // Segments are taken back in the order they were written, which their names sort in.
+    int n = 0;
+    struct dirent *entry;
+    while ((entry = readdir(d)) != nullptr)
+    {
+        unsigned long long seq;
+        int end = 0;
+        if (sscanf(entry->d_name, "%16llx.spool%n", &seq, &end) != 1 || end != 22 || entry->d_name[end] != '\0')
+        {
+            continue;
+        }
+        if (n == GS_SPOOL_MAX_SEGMENTS)
+        {
+            dbprintlf(RED_FG "More than %d segments in %s, ignoring the rest.", GS_SPOOL_MAX_SEGMENTS, dir);
+            break;
+        }
+        seqs[n++] = seq;
+    }
+    closedir(d);
+    qsort(seqs, n, sizeof(uint64_t), spool_seq_cmp);
+    for (int i = 0; i < n; i++)
+    {
+        spool_recover(spool, seqs[i]);
+        spool->next_seq = seqs[i] + 1;
+    }
+    free(seqs);
+
+    if (spool->stats.frames)
+    {
+        dbprintlf(YELLOW_FG "Spool %s holds %llu frames from before (%llu bytes in %d segments).", dir,
+                  (unsigned long long)spool->stats.frames, (unsigned long long)spool->stats.bytes, spool->count);
+    }
+    return spool;
+}
+
+void gs_spool_close(gs_spool_t *spool)
+{
+    if (spool == nullptr)
+    {
+        return;
+    }
+    gs_spool_sync(spool);
+    for (int i = 0; i < spool->count; i++)
+    {
+        close(spool->segments[i].fd);
+    }
+    free(spool->segments);
+    free(spool);
+}
+
+/**
+ * @brief Starts the next segment file for appends.
+ */
+static spool_segment_t *spool_segment_new(gs_spool_t *spool)
+{
+    char path[GS_SPOOL_PATH_MAX];
+    if (spool->count == GS_SPOOL_MAX_SEGMENTS || !spool_path(spool, spool->next_seq, path))
+    {
+        return nullptr;
+    }
+    if (spool->count > 0)
+    {
+        // The segment being closed is not appended to again, so it only needs flushing once.
+        fdatasync(spool->segments[spool->count - 1].fd);
+    }
+
+    spool_segment_t *segment = &spool->segments[spool->count];
+    segment->seq = spool->next_seq;
+    segment->fd = open(path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (segment->fd < 0)
+    {
+        dbprintlf(RED_FG "Failed to create spool segment %s.", path);
+        erprintlf(errno);
+        return nullptr;
+    }
+    gs_spool_header_t header[1];
+    memset(header, 0x0, sizeof(header));
+    memcpy(header->magic, GS_SPOOL_MAGIC, sizeof(header->magic));
+    header->seq = segment->seq;
+    header->drained = sizeof(header);
+    if (pwrite(segment->fd, header, sizeof(header), 0) != sizeof(header))
+    {
+        erprintlf(errno);
+        close(segment->fd);
+        unlink(path);
+        return nullptr;
+    }
+    segment->size = segment->drained = sizeof(header);
+    segment->frames = 0;
+    spool->next_seq++;
+    spool->count++;
+    __atomic_store_n(&spool->stats.segments, spool->count, __ATOMIC_RELAXED);
+    return segment;
+}
+
+static void spool_sync_maybe(gs_spool_t *spool)
+{
+    if (gs_time_ns() - spool->synced_ns >= GS_SPOOL_SYNC_MS * NSEC_PER_MSEC)
+    {
+        gs_spool_sync(spool);
+    }
+}
+
+int gs_spool_append(gs_spool_t *spool, const void *data, size_t len, int16_t rssi)
+{
+    size_t record_size = sizeof(gs_spool_record_t) + len;
+    if (len > GS_SPOOL_MAX_RECORD || spool->stats.bytes + record_size > spool->max_bytes)
+    {
+        if (!spool->full)
+        {
+            dbprintlf(RED_FG "Spool %s is full (%llu frames), holding frames in memory.", spool->dir, (unsigned long long)spool->stats.frames);
+            spool->full = true;
+        }
+        spool_stat(&spool->stats.refused, 1);
+        return 0;
+    }
+
+    spool_segment_t *segment = spool->count > 0 ? &spool->segments[spool->count - 1] : nullptr;
+    if (segment == nullptr || segment->size + record_size > spool->segment_bytes)
+    {
+        segment = spool_segment_new(spool);
+        if (segment == nullptr)
+        {
+            spool_stat(&spool->stats.refused, 1);
+            return 0;
+        }
+    }
+
+    gs_spool_record_t record[1];
+    record->magic = GS_SPOOL_RECORD_MAGIC;
+    record->len = len;
+    record->crc = gs_crc16(data, len);
+    record->rssi = rssi;
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    record->spooled_ns = (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+    struct iovec iov[2] = {{record, sizeof(gs_spool_record_t)}, {(void *)data, len}};
+    if (pwritev(segment->fd, iov, 2, segment->size) != (ssize_t)record_size)
+    {
+        // Cut off whatever part made it, so the next record lands where recovery will look for it.
+        dbprintlf(RED_FG "Failed to append to the spool.");
+        erprintlf(errno);
+        if (ftruncate(segment->fd, segment->size) < 0)
+        {
+            erprintlf(errno);
+        }
+        spool_stat(&spool->stats.refused, 1);
+        return 0;
+    }
+    segment->size += record_size;
+    segment->frames++;
+    spool->dirty = true;
+    spool->full = false;
+    spool_stat(&spool->stats.frames, 1);
+    spool_stat(&spool->stats.bytes, record_size);
+    spool_stat(&spool->stats.spooled, 1);
+    spool_sync_maybe(spool);
+    return 1;
+}
+
+ssize_t gs_spool_peek(gs_spool_t *spool, void *buf, size_t size, int16_t *rssi)
+{
+    while (spool->count > 0)
+    {
+        spool_segment_t *segment = &spool->segments[0];
+        if (segment->frames == 0)
+        {
+            // Only the segment being appended to is ever left empty.
+            return 0;
+        }
+        gs_spool_record_t record[1];
+        ssize_t len = spool_record(segment->fd, segment->drained, record, buf, size);
+        if (len >= 0)
+        {
+            if (rssi != nullptr)
+            {
+                *rssi = record->rssi;
+            }
+            spool->peeked = sizeof(gs_spool_record_t) + len;
+            return len;
+        }
+        if (record->magic == GS_SPOOL_RECORD_MAGIC && record->len > size)
+        {
+            dbprintlf(RED_FG "A %u-byte spooled frame does not fit in %zu bytes.", record->len, size);
+            return -1;
+        }
+        // Damaged since it was written: the rest of the segment cannot be found without its length.
+        dbprintlf(RED_FG "Spool segment %016llx is damaged, dropping its last %llu frames.", (unsigned long long)segment->seq,
+                  (unsigned long long)segment->frames);
+        spool_stat(&spool->stats.corrupt, 1);
+        spool_remove(spool, 0);
+    }
+    return 0;
+}
+
+void gs_spool_pop(gs_spool_t *spool)
+{
+    if (spool->peeked == 0 || spool->count == 0)
+    {
+        return;
+    }
+    spool_segment_t *segment = &spool->segments[0];
+    segment->drained += spool->peeked;
+    segment->frames--;
+    spool_stat(&spool->stats.frames, -1);
+    spool_stat(&spool->stats.bytes, -(int64_t)spool->peeked);
+    spool_stat(&spool->stats.drained, 1);
+    spool->peeked = 0;
+
+    if (segment->frames == 0 && (spool->count > 1 || segment->size >= spool->segment_bytes / 2))
+    {
+        // Delivered in full. The segment being appended to is kept unless it is half full, to save recreating it per frame.
+        spool_remove(spool, 0);
+        return;
+    }
+    if (pwrite(segment->fd, &segment->drained, sizeof(segment->drained), offsetof(gs_spool_header_t, drained)) != sizeof(segment->drained))
+    {
+        erprintlf(errno);
+    }
+    spool->dirty = true;
+    spool_sync_maybe(spool);
+}
+
+void gs_spool_sync(gs_spool_t *spool)
+{
+    if (spool->dirty)
+    {
+        // Appends only touch the newest segment and drains the oldest.
+        if (spool->count > 0)
+        {
+            fdatasync(spool->segments[0].fd);
+        }
+        if (spool->count > 1)
+        {
+            fdatasync(spool->segments[spool->count - 1].fd);
+        }
+        spool->dirty = false;
+    }
+    spool->synced_ns = gs_time_ns();
+}
+
+uint64_t gs_spool_depth(gs_spool_t *spool)
+{
+    return __atomic_load_n(&spool->stats.frames, __ATOMIC_RELAXED);
+}
+
+void gs_spool_get_stats(gs_spool_t *spool, gs_spool_stats_t *stats)
+{
+    stats->frames = __atomic_load_n(&spool->stats.frames, __ATOMIC_RELAXED);
+    stats->bytes = __atomic_load_n(&spool->stats.bytes, __ATOMIC_RELAXED);
+    stats->segments = __atomic_load_n(&spool->stats.segments, __ATOMIC_RELAXED);
+    stats->spooled = __atomic_load_n(&spool->stats.spooled, __ATOMIC_RELAXED);
+    stats->drained = __atomic_load_n(&spool->stats.drained, __ATOMIC_RELAXED);
+    stats->refused = __atomic_load_n(&spool->stats.refused, __ATOMIC_RELAXED);
+    stats->corrupt = __atomic_load_n(&spool->stats.corrupt, __ATOMIC_RELAXED);
+}
+
+void gs_spool_print_stats(gs_spool_t *spool)
+{
+    gs_spool_stats_t stats[1];
+    gs_spool_get_stats(spool, stats);
+    dbprintlf(CYAN_FG "Spool: %llu frames spooled, %llu drained, %llu refused, %llu corrupt; %llu frames (%llu bytes) left in %u segments.",
+              (unsigned long long)stats->spooled, (unsigned long long)stats->drained, (unsigned long long)stats->refused,
+              (unsigned long long)stats->corrupt, (unsigned long long)stats->frames, (unsigned long long)stats->bytes, stats->segments);
+}
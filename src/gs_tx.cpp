@@ -0,0 +1,313 @@
+/**
+ * @file gs_tx.cpp
+ * @author agent (agent@local)
+ * @brief Uplink scheduler: prioritized, deadline-bounded queue of commands waiting for the radio.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gs_tx.hpp"
+#include "gs_time.hpp"
+#include "meb_debug.hpp"
+
+static const uint64_t deadline_ms[GS_TX_PRIO_NUM] = {UHF_TX_DEADLINE_SAFE_MS, UHF_TX_DEADLINE_COMMAND_MS, UHF_TX_DEADLINE_BULK_MS};
+
+const char *gs_tx_prio_name(int prio)
+{
+    static const char *names[GS_TX_PRIO_NUM] = {"safe", "command", "bulk"};
+    return prio >= 0 && prio < GS_TX_PRIO_NUM ? names[prio] : "?";
+}
+
+gs_tx_queue_t *gs_tx_queue_create(uint32_t capacity)
+{
+    gs_tx_queue_t *queue = (gs_tx_queue_t *)calloc(1, sizeof(gs_tx_queue_t));
+    if (queue == nullptr)
+    {
+        dbprintlf(FATAL "Failed to allocate the TX queue.");
+        return nullptr;
+    }
+
+    for (int p = 0; p < GS_TX_PRIO_NUM; p++)
+    {
+        queue->cls[p].items = (gs_tx_item_t *)calloc(capacity + 1, sizeof(gs_tx_item_t));
+        if (queue->cls[p].items == nullptr)
+        {
+            dbprintlf(FATAL "Failed to allocate the TX queue.");
+            gs_tx_queue_destroy(queue);
+            return nullptr;
+        }
+    }
+    queue->capacity = capacity;
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&queue->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&queue->lock, NULL);
+
+    return queue;
+}
+
+void gs_tx_queue_destroy(gs_tx_queue_t *queue)
+{
+    if (queue == nullptr)
+    {
+        return;
+    }
+    for (int p = 0; p < GS_TX_PRIO_NUM; p++)
+    {
+        free(queue->cls[p].items);
+    }
+    pthread_cond_destroy(&queue->cond);
+    pthread_mutex_destroy(&queue->lock);
+    free(queue);
+}
+
+void gs_tx_set_safe_mod(gs_tx_queue_t *queue, uint8_t mod)
+{
+    pthread_mutex_lock(&queue->lock);
+    queue->safe_mods[mod] = true;
+    pthread_mutex_unlock(&queue->lock);
+}
+
+gs_tx_prio_t gs_tx_classify(gs_tx_queue_t *queue, const void *payload, ssize_t len)
+{
+    const cmd_input_t *cmd = (const cmd_input_t *)payload;
+    if (len > GST_MAX_PAYLOAD_SIZE)
+    {
+        return GS_TX_PRIO_BULK;
+    }
+    if (len < (ssize_t)offsetof(cmd_input_t, data))
+    {
+        return GS_TX_PRIO_COMMAND;
+    }
+    if (queue->safe_mods[cmd->mod])
+    {
+        return GS_TX_PRIO_SAFE;
+    }
+    return cmd->data_size > UHF_TX_BULK_BYTES ? GS_TX_PRIO_BULK : GS_TX_PRIO_COMMAND;
+}
+
+static inline gs_tx_item_t *tx_slot(gs_tx_queue_t *queue, int prio, uint32_t index)
+{
+    return &queue->cls[prio].items[(queue->cls[prio].head + index) % (queue->capacity + 1)];
+}
+
+int gs_tx_submit(gs_tx_queue_t *queue, gst_fec_frame_t *frame, ssize_t len, gs_tx_prio_t prio, uint64_t recv_ns)
+{
+    if (len < 0 || len > GST_MAX_PAYLOAD_SIZE)
+    {
+        dbprintlf(RED_FG "Uplink command of %d bytes does not fit a frame, not queued.", (int)len);
+        return -1;
+    }
+
+    pthread_mutex_lock(&queue->lock);
+    if (queue->count >= queue->capacity)
+    {
+        queue->stats.rejected++;
+        pthread_mutex_unlock(&queue->lock);
+        return 0;
+    }
+
+    gs_tx_item_t *item = tx_slot(queue, prio, queue->cls[prio].count);
+    memset(item, 0x0, sizeof(gs_tx_item_t));
+    item->frame = frame;
+    item->len = len;
+    item->prio = prio;
+    item->seq = ++queue->seq;
+    item->recv_ns = recv_ns;
+    item->enqueue_ns = gs_time_ns();
+    item->deadline_ns = item->enqueue_ns + deadline_ms[prio] * NSEC_PER_MSEC;
+    item->next_ns = item->enqueue_ns;
+
+    queue->cls[prio].count++;
+    queue->count++;
+    queue->stats.submitted++;
+    pthread_cond_signal(&queue->cond);
+    pthread_mutex_unlock(&queue->lock);
+    return 1;
+}
+
+int gs_tx_submit_message(gs_tx_queue_t *queue, uint8_t *message, ssize_t len, uint64_t recv_ns, bool compressed)
+{
+    pthread_mutex_lock(&queue->lock);
+    if (queue->count >= queue->capacity)
+    {
+        queue->stats.rejected++;
+        pthread_mutex_unlock(&queue->lock);
+        return 0;
+    }
+
+    gs_tx_item_t *item = tx_slot(queue, GS_TX_PRIO_BULK, queue->cls[GS_TX_PRIO_BULK].count);
+    memset(item, 0x0, sizeof(gs_tx_item_t));
+    item->message = message;
+    item->len = len;
+    item->compressed = compressed;
+    item->prio = GS_TX_PRIO_BULK;
+    item->seq = ++queue->seq;
+    item->recv_ns = recv_ns;
+    item->enqueue_ns = gs_time_ns();
+    item->deadline_ns = item->enqueue_ns + deadline_ms[GS_TX_PRIO_BULK] * NSEC_PER_MSEC;
+    item->next_ns = item->enqueue_ns;
+
+    queue->cls[GS_TX_PRIO_BULK].count++;
+    queue->count++;
+    queue->stats.submitted++;
+    pthread_cond_signal(&queue->cond);
+    pthread_mutex_unlock(&queue->lock);
+    return 1;
+}
+
+static void tx_pop(gs_tx_queue_t *queue, int prio, gs_tx_item_t *item)
+{
+    *item = *tx_slot(queue, prio, 0);
+    queue->cls[prio].head = (queue->cls[prio].head + 1) % (queue->capacity + 1);
+    queue->cls[prio].count--;
+    queue->count--;
+}
+
+gs_tx_next_t gs_tx_next(gs_tx_queue_t *queue, gs_tx_item_t *item, int timeout_ms)
+{
+    uint64_t give_up = gs_time_ns() + (uint64_t)timeout_ms * NSEC_PER_MSEC;
+    gs_tx_next_t retval = GS_TX_NONE;
+
+    pthread_mutex_lock(&queue->lock);
+    while (!queue->stop && !queue->wake)
+    {
+        uint64_t now = gs_time_ns();
+        uint64_t wake = give_up;
+
+        // Classes are FIFO with one deadline each, so only the heads can have expired or be due.
+        for (int p = 0; p < GS_TX_PRIO_NUM && retval == GS_TX_NONE; p++)
+        {
+            if (queue->cls[p].count && tx_slot(queue, p, 0)->deadline_ns <= now)
+            {
+                tx_pop(queue, p, item);
+                queue->stats.expired++;
+                retval = GS_TX_EXPIRED;
+            }
+        }
+        for (int p = 0; p < GS_TX_PRIO_NUM && retval == GS_TX_NONE; p++)
+        {
+            if (queue->cls[p].count == 0)
+            {
+                continue;
+            }
+            gs_tx_item_t *head = tx_slot(queue, p, 0);
+            if (head->next_ns <= now)
+            {
+                tx_pop(queue, p, item);
+                retval = GS_TX_SEND;
+            }
+            else
+            {
+                wake = head->next_ns < wake ? head->next_ns : wake;
+                wake = head->deadline_ns < wake ? head->deadline_ns : wake;
+            }
+        }
+        if (retval != GS_TX_NONE || now >= give_up)
+        {
+            break;
+        }
+
+        struct timespec ts;
+        ts.tv_sec = wake / NSEC_PER_SEC;
+        ts.tv_nsec = wake % NSEC_PER_SEC;
+        pthread_cond_timedwait(&queue->cond, &queue->lock, &ts);
+    }
+    queue->wake = false;
+    pthread_mutex_unlock(&queue->lock);
+
+    return retval;
+}
+
+int gs_tx_retry(gs_tx_queue_t *queue, gs_tx_item_t *item)
+{
+    uint64_t now = gs_time_ns();
+    uint64_t backoff_ms = (uint64_t)UHF_TX_BACKOFF_MS << (item->attempts > 0 ? item->attempts - 1 : 0);
+    backoff_ms = backoff_ms > UHF_TX_BACKOFF_MAX_MS ? UHF_TX_BACKOFF_MAX_MS : backoff_ms;
+
+    pthread_mutex_lock(&queue->lock);
+    if (item->attempts >= UHF_TX_MAX_RETRIES + 1 || now + backoff_ms * NSEC_PER_MSEC >= item->deadline_ns)
+    {
+        queue->stats.failed++;
+        pthread_mutex_unlock(&queue->lock);
+        return 0;
+    }
+
+    // Back at the head, so nothing else in the class overtakes it. The spare slot guarantees room.
+    int p = item->prio;
+    queue->cls[p].head = (queue->cls[p].head + queue->capacity) % (queue->capacity + 1);
+    gs_tx_item_t *slot = tx_slot(queue, p, 0);
+    *slot = *item;
+    slot->next_ns = now + backoff_ms * NSEC_PER_MSEC;
+    queue->cls[p].count++;
+    queue->count++;
+    queue->stats.retries++;
+    pthread_mutex_unlock(&queue->lock);
+    return 1;
+}
+
+int gs_tx_preempt(gs_tx_queue_t *queue, gs_tx_prio_t prio)
+{
+    int retval = 0;
+    uint64_t now = gs_time_ns();
+
+    pthread_mutex_lock(&queue->lock);
+    for (int p = 0; p < prio && !retval; p++)
+    {
+        if (queue->cls[p].count)
+        {
+            gs_tx_item_t *head = tx_slot(queue, p, 0);
+            retval = head->next_ns <= now || head->deadline_ns <= now;
+        }
+    }
+    pthread_mutex_unlock(&queue->lock);
+
+    return retval;
+}
+
+void gs_tx_wake(gs_tx_queue_t *queue)
+{
+    pthread_mutex_lock(&queue->lock);
+    queue->wake = true;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+void gs_tx_stop(gs_tx_queue_t *queue)
+{
+    pthread_mutex_lock(&queue->lock);
+    queue->stop = true;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+void gs_tx_get_stats(gs_tx_queue_t *queue, gs_tx_stats_t *stats)
+{
+    pthread_mutex_lock(&queue->lock);
+    *stats = queue->stats;
+    for (int p = 0; p < GS_TX_PRIO_NUM; p++)
+    {
+        stats->depth[p] = queue->cls[p].count;
+    }
+    pthread_mutex_unlock(&queue->lock);
+}
+
+void gs_tx_print_stats(gs_tx_queue_t *queue)
+{
+    gs_tx_stats_t stats[1];
+    gs_tx_get_stats(queue, stats);
+    dbprintlf(CYAN_FG "UHF TX queue: %u/%u/%u queued (safe/command/bulk), %llu submitted, %llu rejected, %llu expired, %llu retries, %llu failed.",
+              stats->depth[GS_TX_PRIO_SAFE], stats->depth[GS_TX_PRIO_COMMAND], stats->depth[GS_TX_PRIO_BULK],
+              (unsigned long long)stats->submitted, (unsigned long long)stats->rejected, (unsigned long long)stats->expired,
+              (unsigned long long)stats->retries, (unsigned long long)stats->failed);
+}
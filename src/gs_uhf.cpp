@@ -10,266 +10,2192 @@
  */
 
 #include <stdlib.h>
+#include <math.h>
 #include <pthread.h>
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
 #include <fcntl.h>
-#include <si446x.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
 #include "gs_uhf.hpp"
+#include "gs_crc.hpp"
+#include "gs_ring.hpp"
+#include "gs_tx.hpp"
+#include "gs_sar.hpp"
+#include "gs_time.hpp"
+#include "gs_log.hpp"
+#include "gs_metrics.hpp"
+#include "gs_reactor.hpp"
+#include "gs_capture.hpp"
+#include "gs_diversity.hpp"
+#include "gs_spool.hpp"
+#include "gs_health.hpp"
+#include "gs_arbiter.hpp"
+#include "gs_rt.hpp"
+#include "gs_pass.hpp"
+#include "gs_doppler.hpp"
+#include "gs_lz.hpp"
 #include "meb_debug.hpp"
 
+// Uplink commands are built into GST frames in payload_pool blocks, see gs_network_rx().
+static_assert(NETFRAME_MAX_PAYLOAD_SIZE >= sizeof(gst_fec_frame_t), "payload blocks must hold a GST frame");
+
+static int rx_frames_since_report; // Only one context delivers frames, see gs_uhf_event_loop().
+
+/**
+ * @brief Counts a RECV_TIMEOUT without a frame and prints the receive statistics.
+ */
+static void uhf_rx_timeout(gs_radio_t *radio, gs_ring_t *ring)
+{
+    gs_metrics_count(GS_COUNT_UHF_RX_TIMEOUTS);
+    gs_uhf_print_rx_stats(radio);
+    gs_ring_print_stats("UHF RX", ring);
+}
+
+/**
+ * @brief Returns how long to wait before the next init attempt, and doubles it for the one after.
+ * 
+ * @param retry_ms The radio's backoff, 0 after it came up.
+ */
+static uint32_t uhf_init_retry(uint32_t *retry_ms)
+{
+    uint32_t wait_ms = *retry_ms < UHF_INIT_RETRY_MIN_MS ? UHF_INIT_RETRY_MIN_MS : *retry_ms;
+    *retry_ms = wait_ms * 2 < UHF_INIT_RETRY_MAX_MS ? wait_ms * 2 : UHF_INIT_RETRY_MAX_MS;
+    return wait_ms;
+}
+
+/**
+ * @brief Initializes the radio if it is not ready. Only the radio's owner (its RX thread, or the event loop when
+ * it reads the radio inline) calls this; whether it is still up is the health monitor's to find out.
+ * 
+ * @param initd Set to gs_uhf_init()'s result when it is run.
+ * @param ready The radio's ready flag, global_data_t::uhf_ready or gs_uhf_radio_t::ready.
+ * @return bool False if the radio is unusable; retry after uhf_init_retry().
+ */
+static bool uhf_radio_check(global_data_t *global, gs_radio_t *radio, int *initd, bool *ready)
+{
+    if (__atomic_load_n(ready, __ATOMIC_ACQUIRE) && gs_health_ready(&radio->health))
+    {
+        return true;
+    }
+
+    // Init UHF.
+    __atomic_store_n(ready, false, __ATOMIC_RELEASE);
+    *initd = gs_uhf_init(radio);
+    dbprintlf(RED_FG "Init status: %d", *initd);
+    if (*initd != 1)
+    {
+        dbprintlf(RED_FG "UHF Radio initialization failure (%d).", *initd);
+        return false;
+    }
+
+    // TODO: COMMENT OUT FOR DEBUGGING PURPOSES ONLY
+#ifndef UHF_NOT_CONNECTED_DEBUG
+    __atomic_store_n(ready, true, __ATOMIC_RELEASE);
+#endif
+
+    gs_health_snapshot_t health[1];
+    gs_health_get(&radio->health, health);
+    if (health->reinits == 0 && global->start_ns != 0)
+    {
+        dbprintlf(GREEN_FG "%s radio ready to receive %.0f ms after start (%u failed attempts).", radio->ops->name,
+                  (gs_time_ns() - global->start_ns) / 1e6, health->failures);
+    }
+    return true;
+}
+
+/**
+ * @brief Passes a valid frame on: a SAR segment or ACK to the SAR endpoint, anything else (or the message
+ * it completes) to the server through the RX ring.
+ * 
+ * @param slot The uhf_rx_ring slot air was read into, or nullptr to copy air into one.
+ * @param air 
+ * @param rssi 
+ * @param read_ns When the frame came off the radio.
+ */
+static void uhf_rx_deliver(global_data_t *global, gs_ring_slot_t *slot, const gst_fec_frame_t *air, int16_t rssi, uint64_t read_ns)
+{
+    uint8_t *message = nullptr;
+    size_t message_len = 0;
+    if (air->frame.guid == GST_SAR_GUID)
+    {
+        // A segment or ACK of a multi-frame message; only a completed downlink goes on to the server.
+        int sar = gs_sar_input(global->uhf_sar, air->frame.payload, read_ns);
+        if (sar < 0)
+        {
+            logprintlf(GS_LOG_WARN, RED_FG "Malformed SAR frame dropped.");
+            return;
+        }
+        if (sar & GS_SAR_IN_ACK)
+        {
+            gs_tx_wake(global->uhf_tx_queue);
+        }
+        if (!(sar & GS_SAR_IN_MESSAGE))
+        {
+            return;
+        }
+
+        bool compressed;
+        const uint8_t *reassembled = gs_sar_message(global->uhf_sar, &message_len, &compressed);
+        message = (uint8_t *)gs_pool_get(global->payload_pool);
+        if (message == nullptr)
+        {
+            logprintlf(GS_LOG_FATAL, FATAL "Memory for a reassembled downlink failed to allocate, message lost.");
+            return;
+        }
+        ssize_t unpacked = compressed ? gs_lz_decompress(message, gs_pool_block_size(global->payload_pool), reassembled, message_len) : 0;
+        if (unpacked < 0)
+        {
+            logprintlf(GS_LOG_WARN, RED_FG "Compressed %d-byte downlink does not decompress, dropped.", message_len);
+            gs_pool_put(global->payload_pool, message);
+            return;
+        }
+        else if (compressed)
+        {
+            message_len = unpacked;
+        }
+        else
+        {
+            memcpy(message, reassembled, message_len);
+        }
+        gs_metrics_add(GS_COUNT_DOWNLINK_COPY_BYTES, message_len);
+        gs_metrics_count(GS_COUNT_SAR_RX_MESSAGES);
+        logprintlf(GS_LOG_DEBUG, BLUE_FG "Reassembled a %d-byte downlink.", message_len);
+    }
+    else
+    {
+        logprintlf(GS_LOG_DEBUG, BLUE_FG "UHF receive payload has a cmd_output_t.mod value of: %d", ((cmd_output_t *)air->frame.payload)->mod);
+    }
+
+    if (slot == nullptr)
+    {
+        // The writer may have caught up while we were reading.
+        slot = gs_ring_reserve(global->uhf_rx_ring);
+        if (slot == nullptr)
+        {
+            logprintlf(GS_LOG_WARN, RED_FG "UHF RX ring full, frame dropped.");
+            gs_ring_overflow(global->uhf_rx_ring);
+            gs_pool_put(global->payload_pool, message);
+            return;
+        }
+        if (message == nullptr)
+        {
+            slot->frame = air->frame;
+            gs_metrics_add(GS_COUNT_DOWNLINK_COPY_BYTES, GST_MAX_PAYLOAD_SIZE);
+        }
+    }
+    slot->message = message;
+    slot->len = message != nullptr ? message_len : sizeof(cmd_output_t);
+    slot->rssi = rssi;
+    slot->rx_ns = read_ns;
+    gs_ring_commit(global->uhf_rx_ring);
+    gs_metrics_record(GS_STAGE_ENQUEUE, gs_time_ns() - read_ns);
+}
+
+/**
+ * @brief Counts a frame that is going on to uhf_rx_deliver(), and prints the receive statistics now and then.
+ */
+static void uhf_rx_count(global_data_t *global, int16_t rssi)
+{
+    logprintlf(GS_LOG_DEBUG, BLUE_BG "Received from UHF.");
+    gs_metrics_count(GS_COUNT_UHF_RX_FRAMES);
+    gs_metrics_rssi(rssi);
+    if (++rx_frames_since_report >= UHF_STATS_REPORT_FRAMES)
+    {
+        if (global->num_radios > 1)
+        {
+            gs_div_print_stats(global->diversity);
+        }
+        else
+        {
+            gs_uhf_print_rx_stats(global->radio);
+        }
+        gs_ring_print_stats("UHF RX", global->uhf_rx_ring);
+        rx_frames_since_report = 0;
+    }
+}
+
+/**
+ * @brief Takes one frame off the radio and queues it for the server, reassembling multi-frame downlinks.
+ * 
+ * @param wait Block in gs_uhf_read() for up to RECV_TIMEOUT; otherwise only take a frame the radio already holds.
+ * @param irq_ns When not waiting, the IRQ that announced the frame (0 if unknown).
+ * @return ssize_t The read's result: bytes, GST_TOUT if there was no frame, or negative GST_ERRORS.
+ */
+static ssize_t uhf_rx_frame(global_data_t *global, bool wait, uint64_t irq_ns)
+{
+    // Read straight into the next ring slot, which the frame is validated in and sent to the server from; if
+    // the network writer has fallen that far behind, read into scratch so the radio FIFO is still serviced.
+    gst_fec_frame_t scratch[1];
+    gs_ring_slot_t *slot = gs_ring_reserve(global->uhf_rx_ring);
+    gst_fec_frame_t *air = slot != nullptr ? &slot->air : scratch;
+
+    int16_t rssi = 0;
+    ssize_t retval = wait ? gs_uhf_recv(global->radio, air, &rssi, &global->uhf_done)
+                          : gs_uhf_recv_frame(global->radio, air, &rssi, irq_ns);
+    uint64_t read_ns = gs_time_ns();
+
+    if (retval < 0)
+    {
+        logprintlf(GS_LOG_ERROR, RED_FG "UHF read error %d.", retval);
+        gs_metrics_count_gst_error(retval);
+    }
+    else if (retval == 0)
+    {
+        if (wait && gs_health_ready(&global->radio->health))
+        {
+            // Timed-out, rather than cut short because the radio went down.
+            uhf_rx_timeout(global->radio, global->uhf_rx_ring);
+        }
+    }
+    else
+    {
+        uhf_rx_count(global, rssi);
+        uhf_rx_deliver(global, slot, air, rssi, read_ns);
+    }
+    return retval;
+}
+
+/**
+ * @brief Sets global->uhf_ready while any of several radios is ready.
+ */
+static void uhf_radios_ready(global_data_t *global)
+{
+    bool any = false;
+    for (int i = 0; i < global->num_radios; i++)
+    {
+        any = any || __atomic_load_n(&global->radios[i].ready, __ATOMIC_ACQUIRE);
+    }
+    __atomic_store_n(&global->uhf_ready, any, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Between passes, puts the radio an RX thread owns to sleep and parks the thread until the scheduler
+ * wakes it for the next one. The thread notices within RECV_TIMEOUT, its longest wait on the radio.
+ * 
+ * @param ready The radio's ready flag.
+ * @return bool True if the radio may be used, false after a wait (check whether to stop, then bring it up).
+ */
+static bool uhf_pass_wait(global_data_t *global, gs_radio_t *radio, bool *ready)
+{
+    if (global->passes == nullptr || gs_pass_gate_open(global->passes))
+    {
+        return true;
+    }
+    if (__atomic_load_n(ready, __ATOMIC_ACQUIRE))
+    {
+        __atomic_store_n(ready, false, __ATOMIC_RELEASE);
+        if (ready != &global->uhf_ready)
+        {
+            uhf_radios_ready(global);
+        }
+        gs_radio_sleep(radio);
+        gs_metrics_count(GS_COUNT_PASS_SLEEPS);
+        dbprintlf(BLUE_FG "%s radio asleep until the next pass.", radio->ops->name);
+    }
+    gs_pass_gate_wait(global->passes);
+    return false;
+}
+
 void *gs_uhf_rx_thread(void *args)
 {
-    // TODO: As of right now, there is no way to detect if the UHF Radio crashes, which may require a re-init. In this event, global_data->uhf_ready should be set to false and the radio should be re-init'd. However, this feature doesn't exist in the middleware.
-    // TODO: Possibly just assume any uhf_read failure is because of a crash UHF?
     dbprintlf(BLUE_FG "Entered RX Thread");
     global_data_t *global = (global_data_t *)args;
+    gs_rt_prefault_stack();
+
+    uint32_t retry_ms = 0;
+    while (gs_uhf_running(global))
+    {
+        if (!uhf_pass_wait(global, global->radio, &global->uhf_ready))
+        {
+            continue;
+        }
+        if (!uhf_radio_check(global, global->radio, &global->uhf_initd, &global->uhf_ready))
+        {
+            usleep(uhf_init_retry(&retry_ms) * 1000);
+            continue;
+        }
+        retry_ms = 0;
+
+        // Enable pipe mode.
+        // gs_uhf_enable_pipe();
+
+        gs_radio_en_pipe(global->radio);
+        uhf_rx_frame(global, true, 0);
+    }
+
+    dbprintlf(FATAL "gs_uhf_rx_thread exiting!");
+    return nullptr;
+}
+
+void *gs_uhf_radio_rx_thread(void *args)
+{
+    gs_uhf_radio_t *rx = (gs_uhf_radio_t *)args;
+    global_data_t *global = rx->global;
+    dbprintlf(BLUE_FG "Entered RX thread for radio %d", rx->index);
+    gs_rt_prefault_stack();
+
+    uint32_t retry_ms = 0;
+    while (gs_uhf_running(global))
+    {
+        if (!uhf_pass_wait(global, rx->radio, &rx->ready))
+        {
+            continue;
+        }
+        bool up = uhf_radio_check(global, rx->radio, &rx->initd, &rx->ready);
+        uhf_radios_ready(global);
+        if (!up)
+        {
+            usleep(uhf_init_retry(&retry_ms) * 1000);
+            continue;
+        }
+        retry_ms = 0;
+        gs_radio_en_pipe(rx->radio);
+
+        // Only checked here; whether another radio already delivered the frame is the event loop's to decide.
+        gst_fec_frame_t scratch[1];
+        gs_ring_slot_t *slot = gs_ring_reserve(rx->rx_ring);
+        int16_t rssi = 0;
+        ssize_t retval = gs_uhf_recv(rx->radio, slot != nullptr ? &slot->air : scratch, &rssi, &global->uhf_done);
+        if (retval < 0)
+        {
+            logprintlf(GS_LOG_ERROR, RED_FG "UHF read error %d on radio %d.", retval, rx->index);
+            gs_metrics_count_gst_error(retval);
+        }
+        else if (retval == 0)
+        {
+            if (gs_health_ready(&rx->radio->health))
+            {
+                uhf_rx_timeout(rx->radio, rx->rx_ring);
+            }
+        }
+        else if (slot == nullptr)
+        {
+            logprintlf(GS_LOG_WARN, RED_FG "Radio %d RX ring full, frame dropped.", rx->index);
+            gs_ring_overflow(rx->rx_ring);
+        }
+        else
+        {
+            slot->message = nullptr;
+            slot->len = sizeof(cmd_output_t);
+            slot->rssi = rssi;
+            slot->rx_ns = gs_time_ns();
+            gs_ring_commit(rx->rx_ring);
+        }
+    }
+
+    dbprintlf(FATAL "RX thread for radio %d exiting!", rx->index);
+    return nullptr;
+}
+
+/**
+ * @brief Picks the radio the next TX burst goes out on: with several radios, see gs_div_uplink(), and
+ * global->radio otherwise.
+ */
+static gs_radio_t *uhf_tx_select(global_data_t *global)
+{
+    gs_radio_t *current = __atomic_load_n(&global->uplink_radio, __ATOMIC_ACQUIRE);
+    if (current == nullptr)
+    {
+        current = global->radio;
+    }
+    if (global->num_radios < 2)
+    {
+        return current;
+    }
+    uint32_t ready = 0;
+    for (int i = 0; i < global->num_radios; i++)
+    {
+        ready |= __atomic_load_n(&global->radios[i].ready, __ATOMIC_ACQUIRE) ? 1 << i : 0;
+    }
+    int pick = gs_div_uplink(global->diversity, ready, gs_time_ns());
+    if (pick >= 0 && global->radios[pick].radio != current)
+    {
+        logprintlf(GS_LOG_INFO, BLUE_FG "Uplink moves to radio %d.", pick);
+        gs_metrics_count(GS_COUNT_UPLINK_SWITCHES);
+        current = global->radios[pick].radio;
+        __atomic_store_n(&global->uplink_radio, current, __ATOMIC_RELEASE);
+    }
+    return current;
+}
+
+/**
+ * @brief Sends a SAR ACK taken with gs_sar_take_ack().
+ */
+static void uhf_tx_ack_send(global_data_t *global, gs_radio_t *radio, gst_fec_frame_t *air)
+{
+    if (!__atomic_load_n(&global->uhf_ready, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+    gs_uhf_frame_seal(&air->frame, GST_MAX_PAYLOAD_SIZE, GST_SAR_GUID);
+    if (gs_uhf_send_frame(radio, air, &global->uhf_done) <= 0)
+    {
+        // The sender's timer covers it.
+        logprintlf(GS_LOG_WARN, RED_FG "Failed to transmit a SAR ACK.");
+    }
+}
+
+/**
+ * @brief Sends the ACK the SAR receive side is waiting to get out, if any.
+ */
+static void uhf_tx_sar_ack(global_data_t *global, gs_radio_t *radio)
+{
+    gst_fec_frame_t air[1];
+    if (gs_sar_take_ack(global->uhf_sar, air->frame.payload))
+    {
+        uhf_tx_ack_send(global, radio, air);
+    }
+}
+
+/**
+ * @brief Compresses an uplink payload longer than one frame into a block of its own, if that keeps at least
+ * one frame off the air: laid out as a GST frame if it then fits one, as a message otherwise.
+ *
+ * @return uint8_t* The payload_pool block, nullptr to send the payload as it is.
+ */
+static uint8_t *uhf_compress(global_data_t *global, const uint8_t *payload, int payload_size, ssize_t *packed_size)
+{
+    uint64_t start_ns = gs_time_ns();
+    uint8_t *packed = (uint8_t *)gs_pool_get(global->payload_pool);
+    if (packed == nullptr)
+    {
+        return nullptr;
+    }
+    // Written where a frame's payload goes, and moved to the front of the block if it takes more than one.
+    gst_fec_frame_t *air = (gst_fec_frame_t *)packed;
+    int frames = gs_sar_frames(payload_size);
+    size_t cap = frames > 2 ? (frames - 1) * GS_SAR_SEGMENT_SIZE : GST_MAX_PAYLOAD_SIZE;
+    size_t room = gs_pool_block_size(global->payload_pool) - offsetof(gst_frame_t, payload);
+    *packed_size = gs_lz_pack(air->frame.payload, cap < room ? cap : room, payload, payload_size);
+    gs_metrics_record(GS_STAGE_COMPRESS, gs_time_ns() - start_ns);
+    if (*packed_size <= 0)
+    {
+        logprintlf(GS_LOG_DEBUG, BLUE_FG "%d-byte uplink not worth compressing.", payload_size);
+        gs_metrics_count(GS_COUNT_LZ_SKIPPED);
+        gs_pool_put(global->payload_pool, packed);
+        return nullptr;
+    }
+    if (*packed_size > GST_MAX_PAYLOAD_SIZE)
+    {
+        memmove(packed, air->frame.payload, *packed_size);
+    }
+    logprintlf(GS_LOG_DEBUG, BLUE_FG "%d-byte uplink compressed to %d bytes (%s dictionary), %d frames instead of %d.", payload_size,
+               (int)*packed_size, gs_lz_dict_name(((const gs_lz_header_t *)air->frame.payload)->dict), gs_sar_frames(*packed_size), frames);
+    gs_metrics_count(GS_COUNT_LZ_PACKED);
+    gs_metrics_add(GS_COUNT_LZ_SAVED_FRAMES, frames - gs_sar_frames(*packed_size));
+    return packed;
+}
+
+/**
+ * @brief Checks the radio is up, as the health monitor last found it, before a transmission.
+ */
+static bool uhf_tx_ready(global_data_t *global, gs_radio_t *radio)
+{
+    if (__atomic_load_n(&global->uhf_ready, __ATOMIC_ACQUIRE) && gs_health_ready(&radio->health))
+    {
+        return true;
+    }
+    logprintlf(GS_LOG_ERROR, RED_FG "UHF Radio not available");
+    return false;
+}
+
+static void uhf_tx_handle(global_data_t *global, gs_radio_t *radio, gs_tx_next_t next, gs_tx_item_t *item);
+
+/**
+ * @brief Sends a multi-frame message with SAR, yielding to higher-priority commands between segments.
+ */
+static ssize_t uhf_tx_message(global_data_t *global, gs_radio_t *radio, gs_tx_item_t *item)
+{
+    gs_sar_t *sar = global->uhf_sar;
+    if (!uhf_tx_ready(global, radio) || !gs_sar_send_start(sar, item->message, item->len, item->compressed))
+    {
+        return 0;
+    }
+
+    gs_sar_stats_t before[1], after[1];
+    gs_sar_get_stats(sar, before);
+    ssize_t retval = 0;
+    gs_sar_status_t status = GS_SAR_WAIT;
+
+    while (gs_uhf_running(global))
+    {
+        uhf_tx_sar_ack(global, radio);
+
+        gs_tx_item_t other[1];
+        while (gs_tx_preempt(global->uhf_tx_queue, (gs_tx_prio_t)item->prio))
+        {
+            uhf_tx_handle(global, radio, gs_tx_next(global->uhf_tx_queue, other, 0), other);
+        }
+
+        uint64_t now = gs_time_ns();
+        if (now >= item->deadline_ns)
+        {
+            logprintlf(GS_LOG_WARN, RED_FG "Uplink #%u ran out of time mid-transfer.", item->seq);
+            break;
+        }
+
+        // Segments are cut straight into the frame they go on the air in.
+        gst_fec_frame_t air[1];
+        uint64_t wake_ns = 0;
+        status = gs_sar_send_poll(sar, now, air->frame.payload, &wake_ns);
+        if (status == GS_SAR_SEND)
+        {
+            gs_metrics_add(GS_COUNT_UPLINK_COPY_BYTES, GST_MAX_PAYLOAD_SIZE);
+            gs_uhf_frame_seal(&air->frame, GST_MAX_PAYLOAD_SIZE, GST_SAR_GUID);
+            if (gs_uhf_send_frame(radio, air, &global->uhf_done) <= 0)
+            {
+                // Counts as a lost segment; its retransmission timer resends it.
+                gs_metrics_count(GS_COUNT_UHF_TX_FAILURES);
+            }
+            gs_metrics_record(GS_STAGE_RADIO_WRITE, gs_time_ns() - now);
+        }
+        else if (status == GS_SAR_WAIT)
+        {
+            // The window is out; listen for the ACKs.
+            uint64_t limit = now + UHF_SAR_PREEMPT_MS * NSEC_PER_MSEC;
+            int depth = gs_arbiter_tx_suspend(radio);
+            gs_sar_wait(sar, wake_ns < limit ? wake_ns : limit);
+            gs_arbiter_tx_resume(radio, depth);
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if (status == GS_SAR_DONE)
+    {
+        retval = item->len;
+        gs_metrics_count(GS_COUNT_SAR_TX_MESSAGES);
+    }
+    else
+    {
+        gs_sar_send_abort(sar);
+    }
+    gs_sar_get_stats(sar, after);
+    gs_metrics_add(GS_COUNT_SAR_RETRANSMITS, after->retransmits - before->retransmits);
+    logprintlf(GS_LOG_DEBUG, BLUE_FG "Uplink #%u: %d bytes in %llu segments, %llu retransmitted.", item->seq, item->len,
+               (unsigned long long)(after->segments_sent - before->segments_sent), (unsigned long long)(after->retransmits - before->retransmits));
+
+    return retval;
+}
+
+/**
+ * @brief Returns the blocks a finished item owns.
+ */
+static void uhf_tx_release(global_data_t *global, gs_tx_item_t *item)
+{
+    gs_pool_put(global->payload_pool, item->frame);
+    gs_pool_put(global->payload_pool, item->message);
+}
+
+/**
+ * @brief Acts on one gs_tx_next() result: transmits, retries or NACKs the item.
+ */
+static void uhf_tx_handle(global_data_t *global, gs_radio_t *radio, gs_tx_next_t next, gs_tx_item_t *item)
+{
+    gs_tx_queue_t *queue = global->uhf_tx_queue;
+
+    if (next == GS_TX_NONE)
+    {
+        return;
+    }
+    else if (next == GS_TX_EXPIRED)
+    {
+        logprintlf(GS_LOG_WARN, RED_FG "Uplink #%u (%s) missed its deadline after %d attempts, NACKing.", item->seq, gs_tx_prio_name(item->prio), item->attempts);
+        gs_metrics_count(GS_COUNT_TX_EXPIRED);
+        gs_network_nack(global, NACK_TX_LATE);
+        uhf_tx_release(global, item);
+        return;
+    }
+
+    item->attempts++;
+    ssize_t retval = 0;
+    uint64_t start_ns = gs_time_ns();
+    uint64_t done_ns = start_ns;
+
+    if (item->message != nullptr)
+    {
+        logprintlf(GS_LOG_DEBUG, BLUE_FG "Attempting to transmit %d bytes to SPACE-HAUC in segments.", item->len);
+        retval = uhf_tx_message(global, radio, item);
+        done_ns = gs_time_ns();
+    }
+    else if (uhf_tx_ready(global, radio))
+    {
+        logprintlf(GS_LOG_DEBUG, BLUE_FG "Attempting to transmit %d bytes to SPACE-HAUC.", item->len);
+        start_ns = gs_time_ns();
+        retval = gs_uhf_send_frame(radio, item->frame, &global->uhf_done);
+        done_ns = gs_time_ns();
+        gs_metrics_record(GS_STAGE_RADIO_WRITE, done_ns - start_ns);
+    }
+
+    if (retval > 0)
+    {
+        gs_metrics_count(GS_COUNT_UHF_TX_FRAMES);
+        gs_metrics_record(GS_STAGE_TX_QUEUE, start_ns - item->enqueue_ns);
+        gs_metrics_record(GS_STAGE_UPLINK, done_ns - item->recv_ns);
+        logprintlf(GS_LOG_INFO, BLUE_FG "Uplink #%u (%s): queued %.3f ms, on air %.3f ms, %d attempts.", item->seq, gs_tx_prio_name(item->prio),
+                   (start_ns - item->enqueue_ns) / 1e6, (done_ns - start_ns) / 1e6, item->attempts);
+        uhf_tx_release(global, item);
+        return;
+    }
+
+    gs_metrics_count(GS_COUNT_UHF_TX_FAILURES);
+    if (gs_tx_retry(queue, item))
+    {
+        logprintlf(GS_LOG_WARN, RED_FG "Uplink #%u (%s) attempt %d failed (%d), backing off.", item->seq, gs_tx_prio_name(item->prio), item->attempts, retval);
+    }
+    else
+    {
+        logprintlf(GS_LOG_ERROR, RED_FG "Uplink #%u (%s) failed after %d attempts, NACKing.", item->seq, gs_tx_prio_name(item->prio), item->attempts);
+        gs_network_nack(global, NACK_TX_FAILED);
+        uhf_tx_release(global, item);
+    }
+}
+
+/**
+ * @brief Sends a pending SAR ACK and every command that is due, up to UHF_TX_BURST_FRAMES, in one TX burst on
+ * one radio, which is listening again as soon as the last of them is on the air.
+ * 
+ * @param next gs_tx_next()'s result for the first command.
+ * @param item 
+ */
+static void uhf_tx_burst(global_data_t *global, gs_tx_next_t next, gs_tx_item_t *item)
+{
+    gst_fec_frame_t ack[1];
+    bool acking = gs_sar_take_ack(global->uhf_sar, ack->frame.payload);
+    if (!acking && next == GS_TX_NONE)
+    {
+        return;
+    }
+
+    // Picked once per burst, so the whole burst goes out on it.
+    gs_radio_t *radio = uhf_tx_select(global);
+    gs_arbiter_tx_begin(radio);
+
+    // ACKs first: they are what keeps the spacecraft's multi-frame downlinks moving.
+    if (acking)
+    {
+        uhf_tx_ack_send(global, radio, ack);
+    }
+    for (int frames = 1; next != GS_TX_NONE; frames++)
+    {
+        uhf_tx_handle(global, radio, next, item);
+        if (frames == UHF_TX_BURST_FRAMES)
+        {
+            break;
+        }
+        next = gs_tx_next(global->uhf_tx_queue, item, 0);
+    }
+    gs_arbiter_tx_end(radio);
+}
+
+void *gs_uhf_tx_thread(void *args)
+{
+    dbprintlf(BLUE_FG "Entered UHF TX thread");
+    global_data_t *global = (global_data_t *)args;
+    gs_rt_prefault_stack();
+    gs_tx_queue_t *queue = global->uhf_tx_queue;
+
+    while (gs_uhf_running(global))
+    {
+        if (global->passes != nullptr && !gs_pass_gate_open(global->passes))
+        {
+            // Nothing goes out between passes: the server is NACKed while the radio is not ready.
+            gs_pass_gate_wait(global->passes);
+            continue;
+        }
+        gs_tx_item_t item[1];
+        gs_tx_next_t next = gs_tx_next(queue, item, UHF_IRQ_SLICE_MS);
+        uhf_tx_burst(global, next, item);
+    }
+
+    dbprintlf(FATAL "gs_uhf_tx_thread exiting!");
+    gs_tx_print_stats(queue);
+    gs_sar_print_stats("UHF", global->uhf_sar);
+    return nullptr;
+}
+
+/**
+ * @brief Sends one NetFrame to the server. Serialized with the reactor's socket handling by net_lock.
+ */
+static ssize_t uhf_net_send(global_data_t *global, uint8_t *buffer, ssize_t buffer_size, NetType type)
+{
+    NetFrame *network_frame = gs_pool_netframe(global->netframe_pool, (unsigned char *)buffer, buffer_size, type, type == NetType::POLL ? NetVertex::SERVER : NetVertex::CLIENT);
+    if (network_frame == nullptr)
+    {
+        return -1;
+    }
+    ssize_t retval = -1;
+    pthread_mutex_lock(&global->net_lock);
+    if (global->network_data->connection_ready)
+    {
+        retval = network_frame->sendFrame(global->network_data);
+    }
+    pthread_mutex_unlock(&global->net_lock);
+    gs_pool_netframe_put(global->netframe_pool, network_frame);
+    gs_capture_frame(GS_CAPTURE_NET_TX, buffer, buffer_size, 0, retval < 0 ? -(int)type : (int)type);
+    return retval;
+}
+
+ssize_t gs_network_tx(global_data_t *global_data, uint8_t *buffer, ssize_t buffer_size)
+{
+    uint64_t start = gs_time_ns();
+    ssize_t retval = uhf_net_send(global_data, buffer, buffer_size, NetType::DATA);
+    gs_metrics_add(GS_COUNT_DOWNLINK_COPY_BYTES, buffer_size);
+    gs_metrics_record(GS_STAGE_NET_SEND, gs_time_ns() - start);
+    return retval;
+}
+
+ssize_t gs_network_nack(global_data_t *global_data, int code)
+{
+    cs_ack_t nack[1];
+    nack->ack = 0;
+    nack->code = code;
+
+    return uhf_net_send(global_data, (uint8_t *)nack, sizeof(nack), NetType::NACK);
+}
+
+void gs_network_rx(global_data_t *global, NetFrame *netframe, uint64_t recv_ns)
+{
+    // Stands in for NetFrame::print() and printNetstat(), which write to the terminal synchronously.
+    logprintlf(GS_LOG_DEBUG, "Received NetFrame: type 0x%x, origin 0x%x, destination 0x%x, %d bytes, netstat 0x%02x.",
+               (int)netframe->getType(), (int)netframe->getOrigin(), (int)netframe->getDestination(),
+               netframe->getPayloadSize(), netframe->getNetstat());
+
+    // Extract the payload into a buffer.
+    int payload_size = netframe->getPayloadSize();
+    if (payload_size < 0 || (size_t)payload_size > gs_pool_block_size(global->payload_pool))
+    {
+        logprintlf(GS_LOG_ERROR, RED_FG "Payload of %d bytes is too large, packet lost.", payload_size);
+        return;
+    }
+    uint8_t *block = (uint8_t *)gs_pool_get(global->payload_pool);
+    if (block == nullptr)
+    {
+        logprintlf(GS_LOG_FATAL, FATAL "Memory for payload failed to allocate, packet lost.");
+        return;
+    }
+
+    // A payload that fits one frame is taken straight into the payload field of a GST frame laid over the
+    // block, so an uplink command is transmitted from where it lands.
+    gst_fec_frame_t *air = (gst_fec_frame_t *)block;
+    unsigned char *payload = payload_size <= GST_MAX_PAYLOAD_SIZE ? air->frame.payload : block;
+    if (netframe->retrievePayload(payload, payload_size) < 0)
+    {
+        logprintlf(GS_LOG_ERROR, RED_FG "Error retrieving data.");
+        gs_pool_put(global->payload_pool, block);
+        return;
+    }
+    gs_metrics_count(GS_COUNT_NET_RX_FRAMES);
+    gs_metrics_record(GS_STAGE_NET_RECV, gs_time_ns() - recv_ns);
+    gs_capture_frame(GS_CAPTURE_NET_RX, payload, payload_size, 0, (int)netframe->getType());
+
+    switch (netframe->getType())
+    {
+    case NetType::UHF_CONFIG:
+    {
+        // Only asked for here; the event loop switches the radios between frames, see loop_modem_cb().
+        gs_modem_t modem;
+        int adapt;
+        if (global->modem == nullptr || !gs_modem_parse(payload, payload_size, &modem, &adapt))
+        {
+            logprintlf(GS_LOG_WARN, RED_FG "Malformed UHF CONFIG frame (%d bytes), NACKing.", payload_size);
+            if (global->modem != nullptr)
+            {
+                global->modem->stats.rejected++;
+            }
+            gs_network_nack(global, NACK_BAD_CONFIG);
+            break;
+        }
+        logprintlf(GS_LOG_INFO, BLUE_FG "Received an UHF CONFIG frame: %u bps, %u Hz deviation, %u-byte preamble, PA level %u (0 as it is)%s.",
+                   modem.bitrate, modem.deviation_hz, modem.preamble, modem.power,
+                   adapt == GS_ADAPT_ON ? ", adaptive data rate on" : adapt == GS_ADAPT_OFF ? ", adaptive data rate off" : "");
+        global->modem->stats.configs++;
+        gs_modem_request(global->modem, &modem, adapt, recv_ns);
+        break;
+    }
+    case NetType::DATA:
+    {
+        logprintlf(GS_LOG_DEBUG, BLUE_FG "Received a DATA frame!");
+
+        if (__atomic_load_n(&global->uhf_ready, __ATOMIC_ACQUIRE))
+        {
+            // Queue it for the UHF TX thread; the radio never holds up this socket.
+            // Either way the queue takes the block.
+            int queued = 0;
+            gs_metrics_add(GS_COUNT_UPLINK_COPY_BYTES, payload_size);
+            ssize_t packed_size = 0;
+            uint8_t *packed = global->compress && payload_size > GST_MAX_PAYLOAD_SIZE ? uhf_compress(global, payload, payload_size, &packed_size) : nullptr;
+            if (packed != nullptr && packed_size <= GST_MAX_PAYLOAD_SIZE)
+            {
+                // Compressed into one frame, scheduled by what it carries.
+                gs_tx_prio_t prio = gs_tx_classify(global->uhf_tx_queue, payload, payload_size);
+                gst_fec_frame_t *packed_air = (gst_fec_frame_t *)packed;
+                gs_uhf_frame_seal(&packed_air->frame, packed_size, GST_LZ_GUID);
+                queued = gs_tx_submit(global->uhf_tx_queue, packed_air, packed_size, prio, recv_ns);
+            }
+            else if (packed != nullptr)
+            {
+                queued = gs_tx_submit_message(global->uhf_tx_queue, packed, packed_size, recv_ns, true);
+            }
+            else if (payload_size > GST_MAX_PAYLOAD_SIZE)
+            {
+                // Too big for one frame: the TX thread segments it.
+                queued = gs_tx_submit_message(global->uhf_tx_queue, block, payload_size, recv_ns);
+            }
+            else
+            {
+                gs_tx_prio_t prio = gs_tx_classify(global->uhf_tx_queue, payload, payload_size);
+                gs_uhf_frame_seal(&air->frame, payload_size);
+                queued = gs_tx_submit(global->uhf_tx_queue, air, payload_size, prio, recv_ns);
+            }
+            if (queued > 0 && packed != nullptr)
+            {
+                // The queue holds the compressed block; the received one goes back below.
+                packed = nullptr;
+            }
+            else if (queued > 0)
+            {
+                block = nullptr;
+            }
+            gs_pool_put(global->payload_pool, packed);
+            if (queued < 0)
+            {
+                logprintlf(GS_LOG_WARN, RED_FG "Uplink of %d bytes does not fit a frame, NACKing.", payload_size);
+                gs_network_nack(global, NACK_TX_SIZE);
+            }
+            else if (queued == 0)
+            {
+                logprintlf(GS_LOG_WARN, RED_FG "UHF TX queue full, NACKing %d bytes.", payload_size);
+                gs_metrics_count(GS_COUNT_TX_QUEUE_FULL);
+                gs_network_nack(global, NACK_TX_FULL);
+            }
+        }
+        else
+        {
+            logprintlf(GS_LOG_WARN, RED_FG "Cannot send received data, UHF radio is not ready!");
+            gs_network_nack(global, NACK_NO_UHF);
+        }
+        break;
+    }
+    case NetType::ACK:
+    {
+        logprintlf(GS_LOG_DEBUG, BLUE_FG "Received an ACK frame.");
+        break;
+    }
+    case NetType::NACK:
+    {
+        logprintlf(GS_LOG_DEBUG, BLUE_FG "Received a NACK frame.");
+        break;
+    }
+    default:
+    {
+        break;
+    }
+    }
+    gs_pool_put(global->payload_pool, block);
+}
+
+/**
+ * @brief State of gs_uhf_event_loop(), only touched from its callbacks.
+ */
+typedef struct
+{
+    global_data_t *global;
+    bool rx_thread;      // gs_uhf_rx_thread() reads the radio and the loop only drains the ring.
+    bool merge;          // Several radios: the loop drains their rings into uhf_rx_ring, see loop_merge().
+    int server_fd;       // Server socket being read, -1 while disconnected.
+    int radio_fd;        // Registered radio IRQ descriptor, -1 if none.
+    bool radio_up;       // The loop is reading the radio (on radio_fd, or polling on radio_timer).
+    int radio_timer;     // Init retries while the radio is down; UHF_IRQ_FALLBACK_US polling without radio_fd.
+    int flush_timer;     // NETWORK_TX_RETRY_MS one-shot after the server did not take a frame.
+    bool flush_held;     // Waiting on flush_timer.
+    uint64_t last_rx_ns; // Last frame or RECV_TIMEOUT report.
+    int reconnect_timer;   // One-shot, the next attempt to reach the server while disconnected.
+    uint32_t reconnect_ms; // Backoff ceiling for the next attempt, see loop_server_retry().
+    unsigned int jitter;   // rand_r() state for the backoff's jitter.
+    int drain_timer;       // UHF_SPOOL_DRAIN_MS while the server is connected and the spool is not empty.
+    uint64_t drain_start_ns; // When the current drain began, 0 if none.
+    uint64_t drain_frames;   // Spooled frames it has delivered.
+    int health_timer;        // Health probes, every global_data_t::health_ms.
+    uint32_t init_retry_ms;  // Backoff for the next init attempt while the radio is down, see uhf_init_retry().
+    int connect_efd;         // Written by the connect thread when it is done, see loop_server_connect().
+    pthread_t connect_tid;
+    bool connecting;         // The connect thread is running.
+    int connect_result;      // Its uhf_connect() result.
+    int recv_efd;            // Written by the receive thread for each NetFrame it hands over, see loop_recv_thread().
+    pthread_t recv_tid;
+    bool receiving;          // The receive thread is running.
+    pthread_mutex_t recv_lock;
+    pthread_cond_t recv_cond; // Signalled when the loop takes recv_frame, and when it stops the thread.
+    bool recv_pending;       // recv_frame, recv_size, recv_errno and recv_ns are waiting for the loop. Under recv_lock, as are they.
+    bool recv_stop;          // Under recv_lock.
+    NetFrame *recv_frame;    // nullptr if there was none to read into.
+    int recv_size;           // Its recvFrame() result.
+    int recv_errno;
+    uint64_t recv_ns;
+    bool connected_once;     // The time to the first connection has been logged.
+    uint64_t health_us;      // health_timer's period.
+    int pass_timer;          // One-shot, the next pass event, see loop_pass_cb(). 0 without a pass plan.
+    bool pass_awake;         // The radios are up for a pass (or there is no usable element set).
+    double pass_aos;         // AOS of the pass the radios sleep until, to log each once.
+    int doppler_timer;       // One-shot, the next retune, see loop_doppler_cb(). 0 without Doppler correction.
+    double doppler_aos;      // AOS of the pass the Doppler table is for.
+    int modem_timer;         // One-shot, the next modem check, see loop_modem_cb(). 0 without global_data_t::modem.
+    uint64_t adapt_next_ns;  // When the adaptive data rate judges its next window.
+} uhf_loop_t;
+
+static void loop_modem_cb(gs_reactor_t *reactor, int fd, uint32_t events, void *arg);
+static void loop_server_watch(uhf_loop_t *loop);
+
+/**
+ * @brief Schedules the next connection attempt: a random wait between half the backoff and all of it (so a
+ * station restarting with others does not retry in step with them), then doubles the backoff.
+ */
+static void loop_server_retry(uhf_loop_t *loop)
+{
+    uint32_t wait_ms = loop->reconnect_ms / 2 + rand_r(&loop->jitter) % (loop->reconnect_ms / 2 + 1);
+    dbprintlf(YELLOW_FG "Reconnecting to the server in %u ms.", wait_ms);
+    gs_reactor_timer_set(loop->reconnect_timer, (uint64_t)wait_ms * 1000, 0);
+    loop->reconnect_ms = loop->reconnect_ms * 2 > UHF_RECONNECT_MAX_MS ? UHF_RECONNECT_MAX_MS : loop->reconnect_ms * 2;
+}
+
+/**
+ * @brief Stops the receive thread, shutting the server socket down as how (see shutdown()) to wake it, and
+ * drops whatever it received that the loop has not taken.
+ */
+static void loop_recv_stop(uhf_loop_t *loop, int how)
+{
+    if (!loop->receiving)
+    {
+        return;
+    }
+    shutdown(loop->server_fd, how);
+    pthread_mutex_lock(&loop->recv_lock);
+    loop->recv_stop = true;
+    pthread_cond_signal(&loop->recv_cond);
+    pthread_mutex_unlock(&loop->recv_lock);
+    pthread_join(loop->recv_tid, NULL);
+    loop->receiving = false;
+
+    if (loop->recv_pending)
+    {
+        gs_pool_netframe_put(loop->global->netframe_pool, loop->recv_frame);
+        loop->recv_pending = false;
+    }
+    uint64_t count;
+    if (read(loop->recv_efd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+    {
+        erprintlf(errno);
+    }
+}
+
+static void loop_server_close(uhf_loop_t *loop, const char *reason)
+{
+    global_data_t *global = loop->global;
+    NetDataClient *network_data = global->network_data;
+
+    if (loop->server_fd >= 0)
+    {
+        loop_recv_stop(loop, SHUT_RDWR);
+        loop->server_fd = -1;
+    }
+    gs_reactor_timer_set(loop->drain_timer, 0, 0);
+    loop->drain_start_ns = 0;
+    pthread_mutex_lock(&global->net_lock);
+    strcpy(network_data->disconnect_reason, reason);
+    __atomic_store_n(&network_data->connection_ready, false, __ATOMIC_RELEASE);
+    if (network_data->socket >= 0)
+    {
+        close(network_data->socket);
+        network_data->socket = -1;
+    }
+    pthread_mutex_unlock(&global->net_lock);
+    loop_server_retry(loop);
+}
+
+/**
+ * @brief Opens a connection to global->server_addr, or to the GS server (UHF_SERVER_HOST) if it is not set.
+ * 
+ * Touches nothing shared: the socket is only installed in global->network_data, under net_lock, by the caller.
+ * 
+ * @param sock_out Set to the connected socket.
+ * @return int 1 on success, as gs_connect_to_server().
+ */
+static int uhf_connect(global_data_t *global, int *sock_out)
+{
+    const char *addr_str = global->server_addr != nullptr ? global->server_addr : UHF_SERVER_HOST;
+    char host[256], port[16];
+    const char *colon = strrchr(addr_str, ':');
+    size_t host_len = colon != nullptr ? (size_t)(colon - addr_str) : strlen(addr_str);
+    if (host_len >= sizeof(host))
+    {
+        dbprintlf(RED_FG "Server address too long: %s", addr_str);
+        return -1;
+    }
+    memcpy(host, addr_str, host_len);
+    host[host_len] = '\0';
+    snprintf(port, sizeof(port), "%s", colon != nullptr ? colon + 1 : "");
+    if (port[0] == '\0')
+    {
+        snprintf(port, sizeof(port), "%d", (int)NetPort::ROOFUHF);
+    }
+
+    struct addrinfo hints, *addrs = nullptr;
+    memset(&hints, 0x0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    int err = getaddrinfo(host, port, &hints, &addrs);
+    if (err != 0)
+    {
+        dbprintlf(RED_FG "Cannot resolve %s: %s", addr_str, gai_strerror(err));
+        return -1;
+    }
+
+    int sock = -1;
+    for (struct addrinfo *addr = addrs; addr != nullptr && sock < 0; addr = addr->ai_next)
+    {
+        sock = socket(addr->ai_family, addr->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, addr->ai_protocol);
+        if (sock < 0)
+        {
+            continue;
+        }
+        // Non-blocking only to bound the connect; the network library's sends and receives block.
+        struct pollfd pfd = {sock, POLLOUT, 0};
+        int so_error = 0;
+        socklen_t so_len = sizeof(so_error);
+        if ((connect(sock, addr->ai_addr, addr->ai_addrlen) < 0 &&
+             (errno != EINPROGRESS || poll(&pfd, 1, UHF_CONNECT_TIMEOUT_MS) <= 0 ||
+              getsockopt(sock, SOL_SOCKET, SO_ERROR, &so_error, &so_len) < 0 || so_error != 0)) ||
+            fcntl(sock, F_SETFL, fcntl(sock, F_GETFL) & ~O_NONBLOCK) < 0)
+        {
+            close(sock);
+            sock = -1;
+        }
+    }
+    freeaddrinfo(addrs);
+    if (sock < 0)
+    {
+        dbprintlf(RED_FG "Cannot connect to %s.", addr_str);
+        return -1;
+    }
+    *sock_out = sock;
+    return 1;
+}
+
+static void *loop_connect_thread(void *arg)
+{
+    uhf_loop_t *loop = (uhf_loop_t *)arg;
+    global_data_t *global = loop->global;
+
+    // Connected without net_lock, which the TX thread takes for its NACKs in the middle of a TX burst; it is
+    // only held to publish the socket.
+    int connected = 1, sock = -1;
+    if (!__atomic_load_n(&global->network_data->connection_ready, __ATOMIC_ACQUIRE))
+    {
+        connected = uhf_connect(global, &sock);
+    }
+    if (sock >= 0)
+    {
+        pthread_mutex_lock(&global->net_lock);
+        if (connected > 0 && !global->network_data->connection_ready)
+        {
+            global->network_data->socket = sock;
+            __atomic_store_n(&global->network_data->connection_ready, true, __ATOMIC_RELEASE);
+            sock = -1;
+        }
+        pthread_mutex_unlock(&global->net_lock);
+        if (sock >= 0)
+        {
+            close(sock);
+        }
+    }
+    __atomic_store_n(&loop->connect_result, connected, __ATOMIC_RELEASE);
+
+    uint64_t one = 1;
+    if (write(loop->connect_efd, &one, sizeof(one)) < 0)
+    {
+        erprintlf(errno);
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Connects to the server on a thread of its own, so the loop keeps bringing up and reading the radio
+ * however long the connection takes; loop_connect_cb() takes over once it is done.
+ */
+static void loop_server_connect(uhf_loop_t *loop)
+{
+    if (loop->connecting)
+    {
+        return;
+    }
+    loop->connecting = true;
+    if (pthread_create(&loop->connect_tid, NULL, loop_connect_thread, loop) != 0)
+    {
+        dbprintlf(RED_FG "Failed to start connecting to the server.");
+        loop->connecting = false;
+        loop_server_retry(loop);
+    }
+}
+
+static void loop_connect_cb(gs_reactor_t *reactor, int fd, uint32_t events, void *arg)
+{
+    uhf_loop_t *loop = (uhf_loop_t *)arg;
+    global_data_t *global = loop->global;
+    uint64_t count;
+    if (read(fd, &count, sizeof(count)) < 0 || !loop->connecting)
+    {
+        return;
+    }
+    pthread_join(loop->connect_tid, NULL);
+    loop->connecting = false;
+
+    if (__atomic_load_n(&loop->connect_result, __ATOMIC_ACQUIRE) != 1)
+    {
+        dbprintlf(RED_FG "Failed to establish connection to server.");
+        gs_metrics_count(GS_COUNT_NET_CONNECT_FAILURES);
+        loop_server_retry(loop);
+        return;
+    }
+    if (!loop->connected_once && global->start_ns != 0)
+    {
+        dbprintlf(GREEN_FG "Connected to the server %.0f ms after start.", (gs_time_ns() - global->start_ns) / 1e6);
+    }
+    loop->connected_once = true;
+    loop_server_watch(loop);
+}
+
+/**
+ * @brief Receives NetFrames from the server and hands them to loop_server_cb() one at a time, so a slow or
+ * partial frame from the server only ever blocks this thread and never the event loop. Ends after a failed
+ * receive, which the loop acts on, or once loop_recv_stop() is called.
+ */
+static void *loop_recv_thread(void *arg)
+{
+    uhf_loop_t *loop = (uhf_loop_t *)arg;
+    global_data_t *global = loop->global;
+
+    while (true)
+    {
+        // gs_pool_netframe() falls back to the heap, so there is no NetFrame to read into only once that is
+        // exhausted too; the connection is then given up like any failed receive.
+        NetFrame *netframe = gs_pool_netframe(global->netframe_pool);
+        int read_size = netframe != nullptr ? netframe->recvFrame(global->network_data) : -1;
+        int err = netframe != nullptr ? errno : ENOMEM;
+        uint64_t recv_ns = gs_time_ns();
+
+        pthread_mutex_lock(&loop->recv_lock);
+        loop->recv_frame = netframe;
+        loop->recv_size = read_size;
+        loop->recv_errno = err;
+        loop->recv_ns = recv_ns;
+        loop->recv_pending = true;
+        pthread_mutex_unlock(&loop->recv_lock);
+        uint64_t one = 1;
+        if (write(loop->recv_efd, &one, sizeof(one)) < 0)
+        {
+            erprintlf(errno);
+        }
+
+        pthread_mutex_lock(&loop->recv_lock);
+        while (loop->recv_pending && !loop->recv_stop)
+        {
+            pthread_cond_wait(&loop->recv_cond, &loop->recv_lock);
+        }
+        bool stop = loop->recv_stop;
+        pthread_mutex_unlock(&loop->recv_lock);
+        if (stop || read_size < 0)
+        {
+            break;
+        }
+    }
+    return nullptr;
+}
+
+static void loop_server_watch(uhf_loop_t *loop)
+{
+    global_data_t *global = loop->global;
+    NetDataClient *network_data = global->network_data;
+
+    loop->server_fd = network_data->socket;
+    loop->recv_stop = false;
+    if (pthread_create(&loop->recv_tid, NULL, loop_recv_thread, loop) != 0)
+    {
+        loop_server_close(loop, "RECV-THREAD");
+        return;
+    }
+    loop->receiving = true;
+    loop->reconnect_ms = UHF_RECONNECT_MIN_MS;
+    gs_reactor_timer_set(loop->reconnect_timer, 0, 0);
+    dbprintlf(GREEN_FG "Connected to the server.");
+    if (global->spool != nullptr && gs_spool_depth(global->spool) > 0)
+    {
+        dbprintlf(YELLOW_FG "Draining %llu spooled frames.", (unsigned long long)gs_spool_depth(global->spool));
+        gs_reactor_timer_set(loop->drain_timer, UHF_SPOOL_DRAIN_MS * 1000, UHF_SPOOL_DRAIN_MS * 1000);
+    }
+}
+
+/**
+ * @brief Acts on a NetFrame the receive thread handed over, see loop_recv_thread().
+ */
+static void loop_server_cb(gs_reactor_t *reactor, int fd, uint32_t events, void *arg)
+{
+    uhf_loop_t *loop = (uhf_loop_t *)arg;
+    global_data_t *global = loop->global;
+    uint64_t count;
+    if (read(fd, &count, sizeof(count)) < 0 || !loop->receiving)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&loop->recv_lock);
+    if (!loop->recv_pending)
+    {
+        pthread_mutex_unlock(&loop->recv_lock);
+        return;
+    }
+    NetFrame *netframe = loop->recv_frame;
+    int read_size = loop->recv_size;
+    int err = loop->recv_errno;
+    uint64_t recv_ns = loop->recv_ns;
+    // The thread goes on to the next frame while this one is handled.
+    loop->recv_pending = false;
+    pthread_cond_signal(&loop->recv_cond);
+    pthread_mutex_unlock(&loop->recv_lock);
+
+    logprintlf(GS_LOG_DEBUG, "Read %d bytes.", read_size);
+    if (read_size >= 0)
+    {
+        gs_network_rx(global, netframe, recv_ns);
+    }
+    gs_pool_netframe_put(global->netframe_pool, netframe);
+    if (global->modem != nullptr && global->modem->kick)
+    {
+        // A UHF_CONFIG asked for something new, which goes on the air at the first gap between frames.
+        loop_modem_cb(reactor, loop->modem_timer, 0, loop);
+    }
+
+    if (read_size == -404)
+    {
+        dbprintlf(RED_BG "Connection forcibly closed by the server.");
+        loop_server_close(loop, "SERVER-FORCED");
+    }
+    else if (read_size < 0 && err == EAGAIN)
+    {
+        dbprintlf(YELLOW_BG "Active connection timed-out (%d).", read_size);
+        loop_server_close(loop, "TIMED-OUT");
+    }
+    else if (read_size < 0)
+    {
+        erprintlf(err);
+        loop_server_close(loop, "RECV-FAILED");
+    }
+}
+
+/**
+ * @brief Forwards the RX ring to the server until it is empty or the server stops taking frames.
+ */
+static void loop_flush(uhf_loop_t *loop)
+{
+    global_data_t *global = loop->global;
+    gs_ring_t *ring = global->uhf_rx_ring;
+    gs_ring_slot_t *slot;
+
+    while ((slot = gs_ring_peek(ring)) != nullptr)
+    {
+        uint8_t *data = slot->message != nullptr ? slot->message : slot->frame.payload;
+        if (gs_network_tx(global, data, slot->len) < 0)
+        {
+            logprintlf(GS_LOG_WARN, RED_FG "Failed to forward a UHF frame to the server, will retry.");
+            gs_metrics_count(GS_COUNT_NET_TX_FAILURES);
+            loop->flush_held = true;
+            gs_reactor_timer_set(loop->flush_timer, NETWORK_TX_RETRY_MS * 1000, 0);
+            return;
+        }
+        gs_metrics_count(GS_COUNT_NET_TX_FRAMES);
+        gs_metrics_record(GS_STAGE_DOWNLINK, gs_time_ns() - slot->rx_ns);
+        gs_pool_put(global->payload_pool, slot->message);
+        slot->message = nullptr;
+        gs_ring_release(ring);
+    }
+}
+
+/**
+ * @brief Moves the RX ring to the spool while the server is unreachable.
+ * 
+ * @return bool False if the spool refused a frame, which is left in the ring.
+ */
+static bool loop_spool(uhf_loop_t *loop)
+{
+    global_data_t *global = loop->global;
+    gs_ring_t *ring = global->uhf_rx_ring;
+    gs_ring_slot_t *slot;
+
+    while ((slot = gs_ring_peek(ring)) != nullptr)
+    {
+        uint8_t *data = slot->message != nullptr ? slot->message : slot->frame.payload;
+        if (!gs_spool_append(global->spool, data, slot->len, slot->rssi))
+        {
+            return false;
+        }
+        gs_metrics_count(GS_COUNT_SPOOL_FRAMES);
+        gs_pool_put(global->payload_pool, slot->message);
+        slot->message = nullptr;
+        gs_ring_release(ring);
+    }
+    return true;
+}
+
+/**
+ * @brief Sends the server a batch of spooled frames, after whatever live frames are waiting.
+ */
+static void loop_drain_cb(gs_reactor_t *reactor, int fd, uint32_t events, void *arg)
+{
+    uhf_loop_t *loop = (uhf_loop_t *)arg;
+    global_data_t *global = loop->global;
+
+    if (loop->server_fd < 0 || loop->flush_held)
+    {
+        return;
+    }
+    loop_flush(loop);
+    uint8_t *block = (uint8_t *)gs_pool_get(global->payload_pool);
+    if (loop->flush_held || block == nullptr)
+    {
+        gs_pool_put(global->payload_pool, block);
+        return;
+    }
+    if (loop->drain_start_ns == 0)
+    {
+        loop->drain_start_ns = gs_time_ns();
+        loop->drain_frames = 0;
+    }
+
+    ssize_t len = 0;
+    for (int i = 0; i < UHF_SPOOL_DRAIN_BATCH; i++)
+    {
+        len = gs_spool_peek(global->spool, block, gs_pool_block_size(global->payload_pool), nullptr);
+        if (len <= 0)
+        {
+            break;
+        }
+        if (gs_network_tx(global, block, len) < 0)
+        {
+            logprintlf(GS_LOG_WARN, RED_FG "Failed to forward a spooled frame to the server, will retry.");
+            gs_metrics_count(GS_COUNT_NET_TX_FAILURES);
+            loop->flush_held = true;
+            gs_reactor_timer_set(loop->flush_timer, NETWORK_TX_RETRY_MS * 1000, 0);
+            break;
+        }
+        gs_spool_pop(global->spool);
+        gs_metrics_count(GS_COUNT_NET_TX_FRAMES);
+        gs_metrics_count(GS_COUNT_SPOOL_DRAINED);
+        loop->drain_frames++;
+    }
+    gs_pool_put(global->payload_pool, block);
+
+    if (len <= 0)
+    {
+        // Empty, or a frame too large for a payload block that would stop the drain for good.
+        double secs = (gs_time_ns() - loop->drain_start_ns) / 1e9;
+        dbprintlf(GREEN_FG "Spool drained: %llu frames in %.1f s (%.0f frames/s).", (unsigned long long)loop->drain_frames,
+                  secs, secs > 0 ? loop->drain_frames / secs : 0);
+        loop->drain_start_ns = 0;
+        gs_reactor_timer_set(loop->drain_timer, 0, 0);
+        gs_spool_sync(global->spool);
+    }
+}
+
+/**
+ * @brief Moves what the radios' RX threads have queued into uhf_rx_ring, oldest first, dropping the copies
+ * of frames another radio already delivered.
+ */
+static void loop_merge(uhf_loop_t *loop)
+{
+    global_data_t *global = loop->global;
+
+    while (true)
+    {
+        gs_uhf_radio_t *from = nullptr;
+        gs_ring_slot_t *slot = nullptr;
+        for (int i = 0; i < global->num_radios; i++)
+        {
+            gs_ring_slot_t *head = gs_ring_peek(global->radios[i].rx_ring);
+            if (head != nullptr && (slot == nullptr || head->rx_ns < slot->rx_ns))
+            {
+                from = &global->radios[i];
+                slot = head;
+            }
+        }
+        if (slot == nullptr)
+        {
+            return;
+        }
+
+        if (gs_div_offer(global->diversity, from->index, &slot->frame, slot->rssi, slot->rx_ns))
+        {
+            uhf_rx_count(global, slot->rssi);
+            uhf_rx_deliver(global, nullptr, &slot->air, slot->rssi, slot->rx_ns);
+        }
+        else
+        {
+            gs_metrics_count(GS_COUNT_DIVERSITY_DUPLICATES);
+        }
+        gs_ring_release(from->rx_ring);
+    }
+}
+
+/**
+ * @brief How many rings RX threads fill for the loop: none inline, uhf_rx_ring, or one per radio.
+ */
+static int loop_rings(uhf_loop_t *loop)
+{
+    return loop->merge ? loop->global->num_radios : loop->rx_thread ? 1 : 0;
+}
+
+static gs_ring_t *loop_ring(uhf_loop_t *loop, int i)
+{
+    return loop->merge ? loop->global->radios[i].rx_ring : loop->global->uhf_rx_ring;
+}
+
+/**
+ * @brief Arms the rings the RX threads fill, see gs_ring_arm().
+ * 
+ * @return bool True if all of them are armed and empty, so the loop can sleep.
+ */
+static bool loop_arm(uhf_loop_t *loop)
+{
+    bool empty = true;
+    for (int i = 0; i < loop_rings(loop); i++)
+    {
+        empty = gs_ring_arm(loop_ring(loop, i)) && empty;
+    }
+    return empty;
+}
+
+static void loop_idle(gs_reactor_t *reactor, void *arg)
+{
+    uhf_loop_t *loop = (uhf_loop_t *)arg;
+    do
+    {
+        if (loop->merge)
+        {
+            // Even while the server is away, so SAR segments are still acknowledged.
+            loop_merge(loop);
+        }
+        if (loop->server_fd >= 0 && !loop->flush_held)
+        {
+            loop_flush(loop);
+        }
+        else if (loop->server_fd < 0 && loop->global->spool != nullptr && loop_spool(loop))
+        {
+            // Out of the ring and onto disk, the ring is free for the rest of the outage.
+        }
+        else if (!loop->merge)
+        {
+            // Hold the frames until the server takes them again, the ring absorbs the outage.
+            return;
+        }
+        // With RX threads filling the rings, only sleep once they are armed and seen empty.
+    } while (loop->rx_thread && !loop_arm(loop));
+}
+
+static void loop_flush_cb(gs_reactor_t *reactor, int fd, uint32_t events, void *arg)
+{
+    uhf_loop_t *loop = (uhf_loop_t *)arg;
+    loop->flush_held = false; // The idle hook retries.
+}
+
+static void loop_reconnect_cb(gs_reactor_t *reactor, int fd, uint32_t events, void *arg)
+{
+    uhf_loop_t *loop = (uhf_loop_t *)arg;
+    if (loop->server_fd < 0)
+    {
+        loop_server_connect(loop);
+    }
+}
+
+static void loop_ring_cb(gs_reactor_t *reactor, int fd, uint32_t events, void *arg)
+{
+    gs_ring_disarm((gs_ring_t *)arg); // The idle hook drains it.
+}
+
+/**
+ * @brief Reads every frame the radio holds; the IRQ has been acknowledged, so none may be left behind.
+ * 
+ * While the UHF TX thread is in a burst the radio is not waited for, which would hold up the server
+ * connection for the whole burst: the frames are read once the arbiter signals that it is over.
+ */
+static void loop_radio_service(uhf_loop_t *loop, uint64_t irq_ns)
+{
+    global_data_t *global = loop->global;
+    if (!gs_arbiter_rx_try(global->radio))
+    {
+        return;
+    }
+    ssize_t retval;
+    bool any = false;
+    while ((retval = uhf_rx_frame(global, false, irq_ns)) != GST_TOUT)
+    {
+        any = true;
+        irq_ns = 0; // Only the first frame's arrival is known.
+    }
+    if (any)
+    {
+        loop->last_rx_ns = gs_time_ns();
+        gs_radio_en_pipe(global->radio);
+    }
+    gs_arbiter_rx_end(global->radio);
+}
+
+static void loop_arbiter_cb(gs_reactor_t *reactor, int fd, uint32_t events, void *arg)
+{
+    uhf_loop_t *loop = (uhf_loop_t *)arg;
+    uint64_t count;
+    if (read(fd, &count, sizeof(count)) < 0 || !loop->radio_up)
+    {
+        return;
+    }
+    loop_radio_service(loop, 0);
+}
+
+static void loop_radio_irq_cb(gs_reactor_t *reactor, int fd, uint32_t events, void *arg)
+{
+    uhf_loop_t *loop = (uhf_loop_t *)arg;
+    uint64_t irq_ns = 0;
+    if (gs_radio_irq_ack(loop->global->radio, &irq_ns))
+    {
+        loop_radio_service(loop, irq_ns);
+    }
+}
+
+static void loop_radio_up(uhf_loop_t *loop)
+{
+    global_data_t *global = loop->global;
+    int fd = gs_radio_irq_fd(global->radio);
+
+    gs_radio_en_pipe(global->radio);
+    if (fd >= 0 && gs_reactor_add(global->reactor, fd, EPOLLIN, loop_radio_irq_cb, loop))
+    {
+        loop->radio_fd = fd;
+        gs_reactor_timer_set(loop->radio_timer, 0, 0);
+    }
+    else
+    {
+        dbprintlf(YELLOW_FG "No UHF IRQ descriptor, polling the radio every %d us.", UHF_IRQ_FALLBACK_US);
+        gs_reactor_timer_set(loop->radio_timer, UHF_IRQ_FALLBACK_US, UHF_IRQ_FALLBACK_US);
+    }
+    loop->radio_up = true;
+    loop->init_retry_ms = 0;
+    loop->last_rx_ns = gs_time_ns();
+    // Frames that raised their IRQ before we were watching.
+    loop_radio_service(loop, 0);
+}
+
+static void loop_radio_down(uhf_loop_t *loop)
+{
+    if (loop->radio_fd >= 0)
+    {
+        gs_reactor_del(loop->global->reactor, loop->radio_fd);
+        loop->radio_fd = -1;
+    }
+    loop->radio_up = false;
+    gs_reactor_timer_set(loop->radio_timer, uhf_init_retry(&loop->init_retry_ms) * 1000ULL, 0);
+}
+
+static void loop_radio_timer_cb(gs_reactor_t *reactor, int fd, uint32_t events, void *arg)
+{
+    uhf_loop_t *loop = (uhf_loop_t *)arg;
+    if (loop->radio_up)
+    {
+        loop->global->radio->irq_stats.wakeups++;
+        loop_radio_service(loop, 0);
+    }
+    else if (uhf_radio_check(loop->global, loop->global->radio, &loop->global->uhf_initd, &loop->global->uhf_ready))
+    {
+        loop_radio_up(loop);
+    }
+    else
+    {
+        loop_radio_down(loop);
+    }
+}
+
+static void loop_poll_cb(gs_reactor_t *reactor, int fd, uint32_t events, void *arg)
+{
+    uhf_loop_t *loop = (uhf_loop_t *)arg;
+    global_data_t *global = loop->global;
+
+    // Server watch-dog: poll it while connected; reconnect_timer takes over when not.
+    if (loop->server_fd >= 0 && uhf_net_send(global, nullptr, 0, NetType::POLL) < 0)
+    {
+        dbprintlf(RED_FG "Failed to poll the server, reconnecting.");
+        loop_server_close(loop, "POLL-FAILED");
+    }
+    if (global->spool != nullptr)
+    {
+        gs_spool_sync(global->spool);
+    }
+
+    if (loop->rx_thread || !loop->radio_up)
+    {
+        return;
+    }
+    uint64_t now = gs_time_ns();
+    if (now - loop->last_rx_ns >= RECV_TIMEOUT * NSEC_PER_SEC)
+    {
+        global->radio->irq_stats.timeouts++;
+        uhf_rx_timeout(global->radio, global->uhf_rx_ring);
+        loop->last_rx_ns = now;
+    }
+}
+
+/**
+ * @brief Probes every ready radio. One that fails stops being used right away and is handed back to its owner
+ * to re-initialize: its RX thread, or the event loop itself when it reads the radio inline, which tries at once.
+ */
+static void loop_health_cb(gs_reactor_t *reactor, int fd, uint32_t events, void *arg)
+{
+    uhf_loop_t *loop = (uhf_loop_t *)arg;
+    global_data_t *global = loop->global;
+
+    if (!loop->merge)
+    {
+        if (gs_health_probe(global->radio))
+        {
+            return;
+        }
+        dbprintlf(FATAL "UHF radio failed its health probe, re-initializing.");
+        __atomic_store_n(&global->uhf_ready, false, __ATOMIC_RELEASE);
+        if (!loop->rx_thread && loop->radio_up)
+        {
+            loop_radio_down(loop);
+            loop_radio_timer_cb(reactor, loop->radio_timer, 0, loop);
+        }
+        // Otherwise gs_uhf_rx_thread() notices within UHF_IRQ_SLICE_MS, see gs_uhf_recv().
+        return;
+    }
+
+    for (int i = 0; i < global->num_radios; i++)
+    {
+        gs_uhf_radio_t *rx = &global->radios[i];
+        if (!gs_health_probe(rx->radio))
+        {
+            dbprintlf(FATAL "Radio %d failed its health probe, re-initializing.", i);
+            __atomic_store_n(&rx->ready, false, __ATOMIC_RELEASE);
+            uhf_radios_ready(global);
+        }
+    }
+}
+
+/**
+ * @brief Brings every ready radio to the modem profile asked for, and with the adaptive data rate on, judges
+ * the link every GS_ADAPT_WINDOW_MS. Re-arms itself: GS_MODEM_RETRY_MS while a radio was too busy to switch,
+ * otherwise GS_MODEM_RECHECK_MS or the next window; not while the radios sleep between passes.
+ */
+static void loop_modem_cb(gs_reactor_t *reactor, int fd, uint32_t events, void *arg)
+{
+    uhf_loop_t *loop = (uhf_loop_t *)arg;
+    global_data_t *global = loop->global;
+    gs_modem_ctl_t *ctl = global->modem;
+    uint64_t now = gs_time_ns();
+    ctl->kick = false;
+
+    gs_link_t link = {0, 0, 0};
+    gs_radio_t *first = nullptr;
+    for (int i = 0; i < global->num_radios; i++)
+    {
+        gs_radio_t *radio = global->radios[i].radio;
+        bool *ready = loop->merge ? &global->radios[i].ready : &global->uhf_ready;
+        if (!__atomic_load_n(ready, __ATOMIC_ACQUIRE) || !gs_health_ready(&radio->health))
+        {
+            continue;
+        }
+        link.good += __atomic_load_n(&radio->link.good, __ATOMIC_RELAXED);
+        link.bad += __atomic_load_n(&radio->link.bad, __ATOMIC_RELAXED);
+        link.rssi_sum += __atomic_load_n(&radio->link.rssi_sum, __ATOMIC_RELAXED);
+        first = first != nullptr ? first : radio;
+    }
+    if (first == nullptr)
+    {
+        // Judged afresh once a radio is back.
+        ctl->rate.fresh = true;
+    }
+    else if (ctl->adapt && now >= loop->adapt_next_ns && first->modem.bitrate != 0)
+    {
+        loop->adapt_next_ns = now + GS_ADAPT_WINDOW_MS * NSEC_PER_MSEC;
+        uint32_t bitrate = first->modem.bitrate;
+        uint32_t to = gs_adapt_window(&ctl->rate, bitrate, &link);
+        if (to != 0)
+        {
+            // The deviation keeps its ratio to the data rate, so the modulation index does not change.
+            gs_modem_t step = {to, (uint32_t)((uint64_t)first->modem.deviation_hz * to / bitrate), 0, 0};
+            gs_metrics_count(to > bitrate ? GS_COUNT_RATE_UPS : GS_COUNT_RATE_DOWNS);
+            logprintlf(GS_LOG_INFO, YELLOW_FG "Data rate %u -> %u bps.", bitrate, to);
+            gs_modem_request(ctl, &step, GS_ADAPT_KEEP, now);
+        }
+    }
+
+    bool busy = false;
+    for (int i = 0; i < global->num_radios && first != nullptr; i++)
+    {
+        gs_radio_t *radio = global->radios[i].radio;
+        bool *ready = loop->merge ? &global->radios[i].ready : &global->uhf_ready;
+        if (!__atomic_load_n(ready, __ATOMIC_ACQUIRE) || !gs_health_ready(&radio->health))
+        {
+            continue;
+        }
+        int retval = gs_modem_apply(ctl, radio);
+        if (retval == 1)
+        {
+            gs_metrics_count(GS_COUNT_MODEM_SWITCHES);
+        }
+        else if (retval == -1)
+        {
+            busy = true;
+            gs_metrics_count(GS_COUNT_MODEM_DEFERRED);
+        }
+        else if (retval == -2)
+        {
+            logprintlf(GS_LOG_WARN, RED_FG "The %s radio cannot take the modem profile asked for, dropping it.", radio->ops->name);
+            gs_modem_forget(ctl);
+            gs_network_nack(global, NACK_BAD_CONFIG);
+            break;
+        }
+    }
+    if (first != nullptr && !busy && ctl->asked_ns != 0)
+    {
+        uint64_t latency = gs_modem_settle(ctl, gs_time_ns());
+        gs_metrics_record(GS_STAGE_MODEM_SWITCH, latency);
+        logprintlf(GS_LOG_INFO, GREEN_FG "Modem profile in effect %.1f ms after it was asked for: %u bps, %u Hz deviation, %u-byte preamble, PA level %u.",
+                   latency / 1e6, first->modem.bitrate, first->modem.deviation_hz, first->modem.preamble, first->modem.power);
+    }
+
+    uint64_t wait_us = 0;
+    if (busy)
+    {
+        wait_us = GS_MODEM_RETRY_MS * 1000ULL;
+    }
+    else if (gs_modem_active(ctl) && (first != nullptr || loop->pass_awake))
+    {
+        wait_us = GS_MODEM_RECHECK_MS * 1000ULL;
+        if (ctl->adapt && first != nullptr)
+        {
+            uint64_t window_us = loop->adapt_next_ns > now ? (loop->adapt_next_ns - now) / 1000 + 1 : 1;
+            wait_us = window_us < wait_us ? window_us : wait_us;
+        }
+    }
+    gs_reactor_timer_set(loop->modem_timer, wait_us, 0);
+}
+
+/**
+ * @brief Retunes every ready radio that has drifted out of tolerance, and re-arms itself for the next retune,
+ * or UHF_DOPPLER_RECHECK_MS at most while the table lasts.
+ */
+static void loop_doppler_cb(gs_reactor_t *reactor, int fd, uint32_t events, void *arg)
+{
+    uhf_loop_t *loop = (uhf_loop_t *)arg;
+    global_data_t *global = loop->global;
+    double now = gs_pass_now();
+    int32_t rx_hz, tx_hz;
+    if (!gs_doppler_lookup(global->doppler, now, &rx_hz, &tx_hz))
+    {
+        // Past the pass; the next one's table re-arms it.
+        return;
+    }
+
+    double next = now + UHF_DOPPLER_RECHECK_MS / 1e3;
+    for (int i = 0; i < global->num_radios; i++)
+    {
+        gs_radio_t *radio = global->radios[i].radio;
+        bool *ready = loop->merge ? &global->radios[i].ready : &global->uhf_ready;
+        if (!__atomic_load_n(ready, __ATOMIC_ACQUIRE) || !gs_health_ready(&radio->health))
+        {
+            continue;
+        }
+        double due;
+        int retval = gs_doppler_apply(global->doppler, radio, now, &due);
+        if (retval == 1)
+        {
+            gs_metrics_count(GS_COUNT_DOPPLER_RETUNES);
+        }
+        else if (retval == -1)
+        {
+            gs_metrics_count(GS_COUNT_DOPPLER_DEFERRED);
+        }
+        if (due > 0 && due < next)
+        {
+            next = due;
+        }
+    }
+    uint64_t wait_us = next > now ? (uint64_t)((next - now) * 1e6) + 1 : 1;
+    gs_reactor_timer_set(loop->doppler_timer, wait_us, 0);
+}
+
+/**
+ * @brief Fills the Doppler table in for a pass, from now or its wake-up time to when the radios sleep again,
+ * and starts retuning.
+ */
+static void loop_doppler_start(uhf_loop_t *loop, double now, const gs_pass_t *pass)
+{
+    global_data_t *global = loop->global;
+    if (global->doppler == nullptr || pass == nullptr || pass->aos == loop->doppler_aos)
+    {
+        return;
+    }
+    double from = pass->aos - global->pass_lead_s;
+    double to = pass->los + UHF_PASS_HOLD_S;
+    from = from > now ? from : now;
+    from = from > to - GS_DOPPLER_MAX_S ? from : to - GS_DOPPLER_MAX_S;
+    if (gs_doppler_build(global->doppler, &global->passes->sat, &global->passes->station, from, to) == 0)
+    {
+        return;
+    }
+    loop->doppler_aos = pass->aos;
+    int32_t rx_hz, tx_hz;
+    gs_doppler_lookup(global->doppler, pass->aos, &rx_hz, &tx_hz);
+    dbprintlf(BLUE_FG "Doppler table for the pass: %d entries, %+d Hz RX and %+d Hz TX at AOS.", global->doppler->count, rx_hz, tx_hz);
+    loop_doppler_cb(global->reactor, loop->doppler_timer, 0, loop);
+}
 
-    while (global->network_data->thread_status > 0)
+/**
+ * @brief Brings the radios up for a pass: the RX threads are let go, or the radio is brought up inline.
+ */
+static void loop_pass_wake(uhf_loop_t *loop, double now, const gs_pass_t *pass)
+{
+    global_data_t *global = loop->global;
+    loop->pass_awake = true;
+    gs_pass_gate_set(global->passes, true);
+    gs_reactor_timer_set(loop->health_timer, loop->health_us, loop->health_us);
+    gs_metrics_count(GS_COUNT_PASS_WAKES);
+    if (pass != nullptr)
+    {
+        dbprintlf(GREEN_FG "Waking the radio %.0f s before AOS (max elevation %.1f deg).", pass->aos - now, pass->max_el * 180 / M_PI);
+    }
+    else
+    {
+        dbprintlf(YELLOW_FG "No usable element set, keeping the radio up.");
+    }
+    if (!loop->rx_thread)
+    {
+        loop->init_retry_ms = 0;
+        loop_radio_timer_cb(global->reactor, loop->radio_timer, 0, loop);
+    }
+    loop_doppler_start(loop, now, pass);
+    if (loop->modem_timer > 0)
     {
-        si446x_info_t si_info[1];
-        si_info->part = 0;
+        loop_modem_cb(global->reactor, loop->modem_timer, 0, loop);
+    }
+}
 
-        // Init UHF.
-        if (!global->uhf_ready)
+/**
+ * @brief Puts the radios to sleep until the next pass. The RX threads do their own, see uhf_pass_wait().
+ */
+static void loop_pass_sleep(uhf_loop_t *loop, double now, const gs_pass_t *pass)
+{
+    global_data_t *global = loop->global;
+    if (loop->pass_awake)
+    {
+        loop->pass_awake = false;
+        gs_pass_gate_set(global->passes, false);
+        gs_reactor_timer_set(loop->health_timer, 0, 0);
+        if (loop->doppler_timer > 0)
+        {
+            gs_reactor_timer_set(loop->doppler_timer, 0, 0);
+        }
+        if (loop->modem_timer > 0)
+        {
+            gs_reactor_timer_set(loop->modem_timer, 0, 0);
+        }
+        if (!loop->rx_thread)
         {
-            global->uhf_initd = gs_uhf_init();
-            dbprintlf(RED_FG "Init status: %d", global->uhf_initd);
-            if (global->uhf_initd != 1)
+            if (loop->radio_fd >= 0)
             {
-                dbprintlf(RED_FG "UHF Radio initialization failure (%d).", global->uhf_initd);
-                usleep(5 SEC);
-                continue;
+                gs_reactor_del(global->reactor, loop->radio_fd);
+                loop->radio_fd = -1;
             }
-
-            // TODO: COMMENT OUT FOR DEBUGGING PURPOSES ONLY
-#ifndef UHF_NOT_CONNECTED_DEBUG
-            global->uhf_ready = true;
-#endif
+            loop->radio_up = false;
+            gs_reactor_timer_set(loop->radio_timer, 0, 0);
+            if (__atomic_load_n(&global->uhf_ready, __ATOMIC_ACQUIRE))
+            {
+                __atomic_store_n(&global->uhf_ready, false, __ATOMIC_RELEASE);
+                gs_radio_sleep(global->radio);
+                gs_metrics_count(GS_COUNT_PASS_SLEEPS);
+            }
+        }
+    }
+    double aos = pass != nullptr ? pass->aos : 0;
+    if (aos != loop->pass_aos)
+    {
+        loop->pass_aos = aos;
+        if (pass != nullptr)
+        {
+            dbprintlf(BLUE_FG "Radio asleep, next pass in %.0f s (max elevation %.1f deg).", pass->aos - now, pass->max_el * 180 / M_PI);
         }
-        si446x_getInfo(si_info);
-        dbprintlf(BLUE_FG "Read part: 0x%x", si_info->part);
-        if ((si_info->part & 0x4460) != 0x4460)
+        else
         {
-            global->uhf_ready = false;
-            usleep(5 SEC);
-            dbprintlf(FATAL "Part number mismatch: 0x%x, retrying init", si_info->part);
-            continue;
+            dbprintlf(BLUE_FG "Radio asleep, no pass predicted in the next %.0f h.", global->passes->horizon_s / 3600);
         }
+    }
+}
 
-        char buffer[GST_MAX_PACKET_SIZE];
-        memset(buffer, 0x0, sizeof(buffer));
-
-        // Enable pipe mode.
-        // gs_uhf_enable_pipe();
-
-        // TODO: COMMENT OUT FOR DEBUGGING PURPOSES ONLY
-#ifndef UHF_NOT_CONNECTED_DEBUG
-        si446x_en_pipe();
-#endif
-
-        int retval = gs_uhf_read(buffer, sizeof(buffer), UHF_RSSI, &global->uhf_ready);
-
-        if (retval < 0)
+/**
+ * @brief Runs the pass plan: picks up a changed TLE file, keeps the predictions ahead, and wakes the radios
+ * pass_lead_s before each AOS and puts them to sleep UHF_PASS_HOLD_S after its LOS. Re-arms itself for the
+ * next of those, or UHF_PASS_RECHECK_S at most.
+ */
+static void loop_pass_cb(gs_reactor_t *reactor, int fd, uint32_t events, void *arg)
+{
+    uhf_loop_t *loop = (uhf_loop_t *)arg;
+    global_data_t *global = loop->global;
+    gs_pass_plan_t *plan = global->passes;
+    double now = gs_pass_now();
+    if (gs_pass_plan_reload(plan, nullptr, 0, now) > 0)
+    {
+        gs_pass_plan_print(plan);
+    }
+    gs_pass_plan_update(plan, now);
+    const gs_pass_t *pass = gs_pass_plan_next(plan, now - UHF_PASS_HOLD_S);
+    double next = now + UHF_PASS_RECHECK_S;
+    if (!plan->have_sat)
+    {
+        // Better to listen all the time than to miss passes we cannot predict.
+        if (!loop->pass_awake)
         {
-            dbprintlf(RED_FG "UHF read error %d.", retval);
-            continue;
+            loop_pass_wake(loop, now, nullptr);
         }
-        else if (retval == 0)
+    }
+    else if (pass != nullptr && now >= pass->aos - global->pass_lead_s)
+    {
+        if (!loop->pass_awake)
         {
-            // Timed-out.
-            continue;
+            loop_pass_wake(loop, now, pass);
         }
         else
         {
-            dbprintlf(BLUE_BG "Received from UHF.");
+            // Kept up from one pass into the next, or the element set changed.
+            loop_doppler_start(loop, now, pass);
         }
-
-        dbprintlf(BLUE_FG "UHF receive payload has a cmd_output_t.mod value of: %d", ((cmd_output_t *)buffer)->mod);
-        NetFrame *network_frame = new NetFrame((unsigned char *)buffer, sizeof(cmd_output_t), NetType::DATA, NetVertex::CLIENT);
-        network_frame->sendFrame(global->network_data);
-        delete network_frame;
+        next = pass->los + UHF_PASS_HOLD_S;
     }
-
-    dbprintlf(FATAL "gs_uhf_rx_thread exiting!");
-    if (global->network_data->thread_status > 0)
+    else
     {
-        global->network_data->thread_status = 0;
+        loop_pass_sleep(loop, now, pass);
+        if (pass != nullptr)
+        {
+            next = pass->aos - global->pass_lead_s;
+        }
     }
-    return nullptr;
+    if (next > now + UHF_PASS_RECHECK_S)
+    {
+        next = now + UHF_PASS_RECHECK_S;
+    }
+    // A timerfd value of 0 disarms it.
+    uint64_t wait_us = next > now ? (uint64_t)((next - now) * 1e6) + 1 : 1;
+    gs_reactor_timer_set(loop->pass_timer, wait_us, 0);
 }
 
-void *gs_network_rx_thread(void *args)
+int gs_uhf_event_loop(global_data_t *global, bool rx_thread)
 {
-    global_data_t *global = (global_data_t *)args;
-    NetDataClient *network_data = global->network_data;
-
-    // Similar, if not identical, to the network functionality in ground_station.
-    // Roof UHF is a network client to the GS Server, and so should be very similar in socketry to ground_station.
+    gs_reactor_t *reactor = global->reactor;
+    uhf_loop_t loop[1];
+    memset(loop, 0x0, sizeof(uhf_loop_t));
+    loop->global = global;
+    loop->rx_thread = rx_thread;
+    loop->merge = global->num_radios > 1;
+    loop->server_fd = -1;
+    loop->radio_fd = -1;
+    loop->reconnect_ms = UHF_RECONNECT_MIN_MS;
+    loop->jitter = (unsigned int)gs_time_ns() ^ (unsigned int)getpid();
+    loop->connect_efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (loop->connect_efd < 0 || !gs_reactor_add(reactor, loop->connect_efd, EPOLLIN, loop_connect_cb, loop))
+    {
+        dbprintlf(FATAL "Failed to create the event loop's connect event.");
+        return 0;
+    }
+    loop->recv_efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (loop->recv_efd < 0 || !gs_reactor_add(reactor, loop->recv_efd, EPOLLIN, loop_server_cb, loop))
+    {
+        dbprintlf(FATAL "Failed to create the event loop's receive event.");
+        return 0;
+    }
+    pthread_mutex_init(&loop->recv_lock, NULL);
+    pthread_cond_init(&loop->recv_cond, NULL);
 
-    while (network_data->recv_active && network_data->thread_status > 0)
+    int poll_timer = gs_reactor_timer(reactor, loop_poll_cb, loop);
+    loop->flush_timer = gs_reactor_timer(reactor, loop_flush_cb, loop);
+    loop->reconnect_timer = gs_reactor_timer(reactor, loop_reconnect_cb, loop);
+    loop->drain_timer = gs_reactor_timer(reactor, loop_drain_cb, loop);
+    loop->radio_timer = rx_thread ? 0 : gs_reactor_timer(reactor, loop_radio_timer_cb, loop);
+    loop->health_timer = gs_reactor_timer(reactor, loop_health_cb, loop);
+    loop->pass_timer = global->passes != nullptr ? gs_reactor_timer(reactor, loop_pass_cb, loop) : 0;
+    loop->doppler_timer = global->passes != nullptr && global->doppler != nullptr ? gs_reactor_timer(reactor, loop_doppler_cb, loop) : 0;
+    loop->modem_timer = global->modem != nullptr ? gs_reactor_timer(reactor, loop_modem_cb, loop) : 0;
+    if (poll_timer < 0 || loop->flush_timer < 0 || loop->reconnect_timer < 0 || loop->drain_timer < 0 || loop->radio_timer < 0 ||
+        loop->health_timer < 0 || loop->pass_timer < 0 || loop->doppler_timer < 0 || loop->modem_timer < 0)
+    {
+        dbprintlf(FATAL "Failed to create the event loop's timers.");
+        return 0;
+    }
+    if (loop->merge && !rx_thread)
+    {
+        dbprintlf(FATAL "Several radios need their RX threads.");
+        return 0;
+    }
+    for (int i = 0; i < loop_rings(loop); i++)
     {
-        if (!network_data->connection_ready)
+        gs_ring_t *ring = loop_ring(loop, i);
+        if (!gs_reactor_add(reactor, gs_ring_fd(ring), EPOLLIN, loop_ring_cb, ring))
         {
-            usleep(5 SEC);
-            continue;
+            dbprintlf(FATAL "Failed to watch the UHF RX ring.");
+            return 0;
         }
+    }
+    if (!rx_thread && !gs_reactor_add(reactor, gs_arbiter_fd(global->radio), EPOLLIN, loop_arbiter_cb, loop))
+    {
+        dbprintlf(FATAL "Failed to watch the UHF radio's arbiter.");
+        return 0;
+    }
+    gs_reactor_set_idle(reactor, loop_idle, loop);
 
-        int read_size = 0;
-
-        while (read_size >= 0 && network_data->recv_active && network_data->thread_status > 0)
+    // Start connecting (or take over a connection made before) and bring the radio up meanwhile; the timers
+    // take over from there.
+    if (global->network_data->connection_ready)
+    {
+        loop_server_watch(loop);
+    }
+    else
+    {
+        loop_server_connect(loop);
+    }
+    gs_reactor_timer_set(poll_timer, SERVER_POLL_RATE SEC, SERVER_POLL_RATE SEC);
+    loop->health_us = (global->health_ms > 0 ? global->health_ms : UHF_HEALTH_INTERVAL_MS) * 1000ULL;
+    if (global->passes != nullptr)
+    {
+        // The radios start asleep (main() closed the gate); the plan wakes them.
+        loop->pass_awake = gs_pass_gate_open(global->passes);
+        loop_pass_cb(reactor, loop->pass_timer, 0, loop);
+    }
+    else
+    {
+        loop->pass_awake = true;
+        gs_reactor_timer_set(loop->health_timer, loop->health_us, loop->health_us);
+        if (!rx_thread)
         {
-            dbprintlf(BLUE_BG "Waiting to receive...");
-
-            NetFrame *netframe = new NetFrame();
-            read_size = netframe->recvFrame(network_data);
-
-            dbprintlf("Read %d bytes.", read_size);
-
-            if (read_size >= 0)
-            {
-                dbprintlf("Received the following NetFrame:");
-                netframe->print();
-                netframe->printNetstat();
-
-                // Extract the payload into a buffer.
-                int payload_size = netframe->getPayloadSize();
-                unsigned char *payload = (unsigned char *)malloc(payload_size);
-                if (payload == nullptr)
-                {
-                    dbprintlf(FATAL "Memory for payload failed to allocate, packet lost.");
-                    continue;
-                }
-
-                if (netframe->retrievePayload(payload, payload_size) < 0)
-                {
-                    dbprintlf(RED_FG "Error retrieving data.");
-                    if (payload != nullptr)
-                    {
-                        free(payload);
-                        payload = nullptr;
-                    }
-                    continue;
-                }
-
-                switch (netframe->getType())
-                {
-                case NetType::UHF_CONFIG:
-                {
-                    dbprintlf(BLUE_FG "Received an UHF CONFIG frame!");
-                    // TODO: Configure yourself.
-                    break;
-                }
-                case NetType::DATA:
-                {
-                    dbprintlf(BLUE_FG "Received a DATA frame!");
-
-                    if (global->uhf_ready)
-                    {
-                        si446x_info_t si_info[1];
-                        si_info->part = 0;
-                        si446x_getInfo(si_info);
-                        if ((si_info->part & 0x4460) != 0x4460)
-                        {
-                            dbprintlf(RED_FG "UHF Radio not available");
-                            if (payload != nullptr)
-                            {
-                                free(payload);
-                                payload = nullptr;
-                            }
-                            continue;
-                            // TODO: DO we let the client know this failed?
-                        }
-
-                        // Activate pipe mode.
-                        si446x_en_pipe();
-
-                        dbprintlf(BLUE_FG "Attempting to transmit %d bytes to SPACE-HAUC.", payload_size);
-                        ssize_t retval = gs_uhf_write((char *)payload, payload_size, &global->uhf_ready);
-                        dbprintlf(BLUE_FG "Transmitted with value: %d (note: this is not the number of bytes sent).", retval);
-                    }
-                    else
-                    {
-                        dbprintlf(RED_FG "Cannot send received data, UHF radio is not ready!");
-                        cs_ack_t nack[1];
-                        nack->ack = 0;
-                        nack->code = NACK_NO_UHF;
-                        
-                        NetFrame *nack_frame = new NetFrame((unsigned char *)nack, sizeof(nack), NetType::NACK, NetVertex::CLIENT);
-                        nack_frame->sendFrame(network_data);
-                        delete nack_frame;
-                    }
-                    break;
-                }
-                case NetType::ACK:
-                {
-                    dbprintlf(BLUE_FG "Received an ACK frame.");
-                    break;
-                }
-                case NetType::NACK:
-                {
-                    dbprintlf(BLUE_FG "Received a NACK frame.");
-                    break;
-                }
-                default:
-                {
-                    break;
-                }
-                }
-                if (payload != nullptr)
-                {
-                    free(payload);
-                    payload = nullptr;
-                }
-            }
-            else
-            {
-                break;
-            }
+            loop_radio_timer_cb(reactor, loop->radio_timer, 0, loop);
+        }
+    }
+    if (loop->modem_timer > 0)
+    {
+        loop_modem_cb(reactor, loop->modem_timer, 0, loop);
+    }
+    loop_idle(reactor, loop);
 
-            delete netframe;
+    dbprintlf(BLUE_FG "Entered event loop (%s).", loop->merge ? "several radios, each on its own thread" : rx_thread ? "radio on its own thread" : "radio inline");
+    int retval = gs_reactor_run(reactor);
+    dbprintlf(FATAL "Event loop exiting!");
+    if (global->spool != nullptr)
+    {
+        // Whatever the server has not taken yet is kept for the next run.
+        loop_spool(loop);
+    }
 
-        }
-        if (read_size == -404)
-        {
-            dbprintlf(RED_BG "Connection forcibly closed by the server.");
-            strcpy(network_data->disconnect_reason, "SERVER-FORCED");
-            network_data->connection_ready = false;
-            continue;
-        }
-        else if (errno == EAGAIN)
+    gs_reactor_stats_t stats[1];
+    gs_reactor_get_stats(reactor, stats);
+    dbprintlf(CYAN_FG "Event loop: %llu wakeups, %llu events, %.3f s busy.", (unsigned long long)stats->wakeups,
+              (unsigned long long)stats->events, stats->busy_ns / 1e9);
+    if (loop->merge)
+    {
+        gs_div_print_stats(global->diversity);
+    }
+    else
+    {
+        gs_uhf_print_rx_stats(global->radio);
+    }
+    if (loop->merge)
+    {
+        for (int i = 0; i < global->num_radios; i++)
         {
-            dbprintlf(YELLOW_BG "Active connection timed-out (%d).", read_size);
-            strcpy(network_data->disconnect_reason, "TIMED-OUT");
-            network_data->connection_ready = false;
-            continue;
+            char name[16];
+            snprintf(name, sizeof(name), "Radio %d", i);
+            gs_health_print(name, global->radios[i].radio);
+            gs_arbiter_print_stats(name, global->radios[i].radio);
         }
-        erprintlf(errno);
     }
-
-    network_data->recv_active = false;
-
-    dbprintlf(FATAL "DANGER! NETWORK RECEIVE THREAD IS RETURNING!");
-    if (global->network_data->thread_status > 0)
+    else
     {
-        global->network_data->thread_status = 0;
+        gs_health_print("UHF", global->radio);
+        gs_arbiter_print_stats("UHF", global->radio);
     }
-    return nullptr;
+    gs_ring_print_stats("UHF RX", global->uhf_rx_ring);
+    if (global->spool != nullptr)
+    {
+        gs_spool_print_stats(global->spool);
+    }
+    if (loop->radio_fd >= 0)
+    {
+        gs_reactor_del(reactor, loop->radio_fd);
+    }
+    for (int i = 0; i < loop_rings(loop); i++)
+    {
+        gs_reactor_del(reactor, gs_ring_fd(loop_ring(loop, i)));
+    }
+    if (!rx_thread)
+    {
+        gs_reactor_del(reactor, gs_arbiter_fd(global->radio));
+    }
+    // The connection itself is global->network_data's, and outlives the loop; it is only read no more.
+    loop_recv_stop(loop, SHUT_RD);
+    if (loop->connecting)
+    {
+        // Left to finish; the connection it may make is the next loop's to take over.
+        pthread_join(loop->connect_tid, NULL);
+    }
+    gs_reactor_del(reactor, loop->connect_efd);
+    close(loop->connect_efd);
+    gs_reactor_del(reactor, loop->recv_efd);
+    close(loop->recv_efd);
+    pthread_mutex_destroy(&loop->recv_lock);
+    pthread_cond_destroy(&loop->recv_cond);
+    gs_reactor_set_idle(reactor, nullptr, nullptr);
+    return retval;
 }
 
-int gs_uhf_init(void)
+int gs_uhf_init(gs_radio_t *radio)
 {
     // (void) gst_error_str; // suppress unused warning
 
-    // WARNING: This function will call exit() on failure.
-    dbprintlf(RED_BG "WARNING: si446x_init() calls exit() on failure!");
-    // TODO: COMMENT OUT FOR DEBUGGING PURPOSES ONLY
-#ifndef UHF_NOT_CONNECTED_DEBUG
-    si446x_init();
-#endif
+    uint64_t start = gs_time_ns();
+    gs_radio_info_t info[1];
+    memset(info, 0x0, sizeof(gs_radio_info_t));
+
+    // Once the radio has been up, re-apply the configuration that init left instead of starting over from a
+    // reset, if the backend can and the radio answers as it did.
+    if (radio->health.part != 0 && gs_radio_resume(radio) == 1)
+    {
+        gs_radio_get_info(radio, info);
+        if (gs_health_matches(&radio->health, info))
+        {
+            dbprintlf(GREEN_FG "%s radio resumed in %.1f ms.", radio->ops->name, (gs_time_ns() - start) / 1e6);
+            return gs_health_init(radio, info);
+        }
+        dbprintlf(YELLOW_FG "%s radio did not resume as it was (part 0x%x), initializing it from scratch.", radio->ops->name, info->part);
+        memset(info, 0x0, sizeof(gs_radio_info_t));
+    }
+
+    if (gs_radio_init(radio) != 1)
+    {
+        dbprintlf(RED_FG "%s radio failed to initialize.", radio->ops->name);
+        gs_health_init(radio, nullptr);
+        return 0;
+    }
 
-    dbprintlf(GREEN_FG "si446x_init() successful!");
     /*
      * chipRev: 0x22
      * partBuild: 0x0
@@ -282,20 +2208,47 @@ int gs_uhf_init(void)
      * patch: 0x0
      * func: 0x1
      */
-    // TODO: COMMENT OUT FOR DEBUGGING PURPOSES ONLY
-#ifndef UHF_NOT_CONNECTED_DEBUG
-    si446x_info_t info[1];
-    memset(info, 0x0, sizeof(si446x_info_t));
-    si446x_getInfo(info);
-    int cond = (info->part & 0x4460) == 0x4460;
-    return cond ? 1 : 0;
-#endif
-#ifdef UHF_NOT_CONNECTED_DEBUG
-    return 1;
-#endif
+    gs_radio_get_info(radio, info);
+    // Also what the health monitor's probes check the radio against from now on.
+    int retval = gs_health_init(radio, info);
+    if (retval)
+    {
+        dbprintlf(GREEN_FG "%s radio initialized in %.1f ms.", radio->ops->name, (gs_time_ns() - start) / 1e6);
+    }
+    return retval;
+}
+
+/**
+ * @brief Copies a received frame's payload out, for the gs_uhf_read() family.
+ */
+static void uhf_payload_out(const gst_fec_frame_t *fec, char *buf, uint16_t *guid)
+{
+    memcpy(buf, fec->frame.payload, GST_MAX_PAYLOAD_SIZE);
+    gs_metrics_add(GS_COUNT_DOWNLINK_COPY_BYTES, GST_MAX_PAYLOAD_SIZE);
+    if (guid != NULL)
+    {
+        *guid = fec->frame.guid;
+    }
+}
+
+ssize_t gs_uhf_read(gs_radio_t *radio, char *buf, ssize_t buffer_size, int16_t *rssi, bool *gst_done, uint16_t *guid)
+{
+    if (buffer_size < GST_MAX_PAYLOAD_SIZE)
+    {
+        eprintf("Payload size incorrect.");
+        return GST_ERROR;
+    }
+
+    gst_fec_frame_t fec[1];
+    ssize_t retval = gs_uhf_recv(radio, fec, rssi, gst_done);
+    if (retval > 0)
+    {
+        uhf_payload_out(fec, buf, guid);
+    }
+    return retval;
 }
 
-ssize_t gs_uhf_read(char *buf, ssize_t buffer_size, int16_t *rssi, bool *gst_done)
+ssize_t gs_uhf_read_frame(gs_radio_t *radio, char *buf, ssize_t buffer_size, int16_t *rssi, uint64_t irq_ns, uint16_t *guid)
 {
     if (buffer_size < GST_MAX_PAYLOAD_SIZE)
     {
@@ -303,72 +2256,252 @@ ssize_t gs_uhf_read(char *buf, ssize_t buffer_size, int16_t *rssi, bool *gst_don
         return GST_ERROR;
     }
 
-    gst_frame_t frame[1];
-    memset(frame, 0x0, sizeof(gst_frame_t));
+    gst_fec_frame_t fec[1];
+    ssize_t retval = gs_uhf_recv_frame(radio, fec, rssi, irq_ns);
+    if (retval > 0)
+    {
+        uhf_payload_out(fec, buf, guid);
+    }
+    return retval;
+}
 
+ssize_t gs_uhf_recv(gs_radio_t *radio, gst_fec_frame_t *fec, int16_t *rssi, bool *gst_done)
+{
+    // Sleep on the radio's IRQ between read attempts rather than spinning on the radio.
+    uint64_t irq_ns = 0;
+    uint64_t deadline = gs_time_ns() + RECV_TIMEOUT * NSEC_PER_SEC;
     ssize_t retval = 0;
-    while (((retval = si446x_read(frame, sizeof(gst_frame_t), rssi)) <= 0) && (!(*gst_done)))
-        ;
+    while (((retval = gs_uhf_recv_frame(radio, fec, rssi, irq_ns)) == GST_TOUT) && !__atomic_load_n(gst_done, __ATOMIC_ACQUIRE))
+    {
+        if (gs_health_lost(&radio->health))
+        {
+            // Nothing more will arrive until the radio is re-initialized.
+            return GST_TOUT;
+        }
+        uint64_t now = gs_time_ns();
+        if (now >= deadline)
+        {
+            radio->irq_stats.timeouts++;
+            return GST_TOUT;
+        }
 
-    if (retval != sizeof(gst_frame_t))
+        uint64_t remaining_ms = (deadline - now) / NSEC_PER_MSEC;
+        int wait_ms = remaining_ms > UHF_IRQ_SLICE_MS ? UHF_IRQ_SLICE_MS : remaining_ms;
+        if (gs_radio_irq_wait(radio, wait_ms, &irq_ns) < 0)
+        {
+            dbprintlf(RED_FG "Waiting for the UHF IRQ failed.");
+            return GST_ERROR;
+        }
+    }
+    return retval;
+}
+
+ssize_t gs_uhf_recv_frame(gs_radio_t *radio, gst_fec_frame_t *fec, int16_t *rssi, uint64_t irq_ns)
+{
+    gst_frame_t *frame = &fec->frame;
+    uint64_t read_start = gs_time_ns();
+    ssize_t retval = gs_radio_read(radio, fec, sizeof(gst_fec_frame_t), rssi);
+    uint64_t read_end = gs_time_ns();
+    if (retval <= 0)
+    {
+        return GST_TOUT;
+    }
+
+    // Captured as it came off the air, with the outcome of the checks below. Only parity frames are changed
+    // by those checks, so only they are copied aside first.
+    uint8_t raw[sizeof(gst_fec_frame_t)];
+    const void *captured = fec;
+    if (gs_capture_active() && retval == sizeof(gst_fec_frame_t))
+    {
+        memcpy(raw, fec, retval);
+        captured = raw;
+    }
+
+    if (retval == sizeof(gst_fec_frame_t))
+    {
+        // Repair what we can; the CRC below still has the final say.
+        int corrected = gs_fec_decode((uint8_t *)fec, sizeof(gst_fec_frame_t));
+        gs_metrics_count(GS_COUNT_FEC_RX_FRAMES);
+        if (corrected > 0)
+        {
+            logprintlf(GS_LOG_DEBUG, YELLOW_FG "FEC corrected %d bytes.", corrected);
+            gs_metrics_add(GS_COUNT_FEC_CORRECTED_BYTES, corrected);
+        }
+        else if (corrected < 0)
+        {
+            gs_metrics_count(GS_COUNT_FEC_UNCORRECTABLE);
+        }
+        __atomic_store_n(&radio->fec_peer, true, __ATOMIC_RELAXED);
+    }
+    else if (retval == sizeof(gst_frame_t))
+    {
+        __atomic_store_n(&radio->fec_peer, false, __ATOMIC_RELAXED);
+    }
+    else
     {
-        dbprintlf(RED_FG "Read in %d bytes, not a valid packet", retval);
+        logprintlf(GS_LOG_WARN, RED_FG "Read in %d bytes, not a valid packet", retval);
+        __atomic_fetch_add(&radio->link.bad, 1, __ATOMIC_RELAXED);
+        gs_capture_frame(GS_CAPTURE_UHF_RX, captured, retval, rssi != NULL ? *rssi : 0, -GST_PACKET_INCOMPLETE);
         return -GST_PACKET_INCOMPLETE;
     }
 
-    if (frame->guid != GST_GUID)
+    gs_metrics_record(GS_STAGE_RADIO_READ, read_end - read_start);
+
+    int valid = gs_uhf_validate(frame);
+    gs_metrics_record(GS_STAGE_VALIDATE, gs_time_ns() - read_end);
+    gs_capture_frame(GS_CAPTURE_UHF_RX, captured, retval, rssi != NULL ? *rssi : 0, valid);
+    if (valid != GST_SUCCESS)
+    {
+        __atomic_fetch_add(&radio->link.bad, 1, __ATOMIC_RELAXED);
+        return valid;
+    }
+    __atomic_fetch_add(&radio->link.good, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&radio->link.rssi_sum, rssi != NULL ? *rssi : 0, __ATOMIC_RELAXED);
+
+    if (irq_ns)
+    {
+        gs_radio_irq_stats_t *stats = &radio->irq_stats;
+        uint64_t latency = gs_time_ns() - irq_ns;
+        stats->frames++;
+        stats->latency_sum_ns += latency;
+        stats->latency_min_ns = latency < stats->latency_min_ns ? latency : stats->latency_min_ns;
+        stats->latency_max_ns = latency > stats->latency_max_ns ? latency : stats->latency_max_ns;
+    }
+
+    return retval;
+}
+
+int gs_uhf_validate(const gst_frame_t *frame)
+{
+    if (frame->guid != GST_GUID && frame->guid != GST_SAR_GUID)
     {
-        dbprintlf(RED_FG "GUID 0x%04x", frame->guid);
+        logprintlf(GS_LOG_WARN, RED_FG "GUID 0x%04x", frame->guid);
         return -GST_GUID_ERROR;
     }
     else if (frame->crc != frame->crc1)
     {
-        dbprintlf(RED_FG "0x%x != 0x%x", frame->crc, frame->crc1);
+        logprintlf(GS_LOG_WARN, RED_FG "0x%x != 0x%x", frame->crc, frame->crc1);
         return -GST_CRC_MISMATCH;
     }
-    else if (frame->crc != internal_crc16(frame->payload, GST_MAX_PAYLOAD_SIZE))
+    else if (frame->crc != gs_crc16(frame->payload, GST_MAX_PAYLOAD_SIZE))
     {
-        dbprintlf(RED_FG "CRC %d", frame->crc);
+        logprintlf(GS_LOG_WARN, RED_FG "CRC %d", frame->crc);
         return -GST_CRC_ERROR;
     }
     else if (frame->termination != GST_TERMINATION)
     {
-        dbprintlf(RED_FG "TERMINATION 0x%x", frame->termination);
+        logprintlf(GS_LOG_WARN, RED_FG "TERMINATION 0x%x", frame->termination);
     }
 
-    memcpy(buf, frame->payload, GST_MAX_PAYLOAD_SIZE);
+    return GST_SUCCESS;
+}
 
-    return retval;
+void gs_uhf_validate_batch(const gst_frame_t *frames, size_t count, int *results)
+{
+    uint16_t crcs[UHF_VALIDATE_BATCH];
+
+    for (size_t base = 0; base < count; base += UHF_VALIDATE_BATCH)
+    {
+        size_t n = count - base < UHF_VALIDATE_BATCH ? count - base : UHF_VALIDATE_BATCH;
+        gs_crc16_batch(frames[base].payload, sizeof(gst_frame_t), GST_MAX_PAYLOAD_SIZE, n, crcs);
+
+        for (size_t i = 0; i < n; i++)
+        {
+            const gst_frame_t *frame = &frames[base + i];
+            if (frame->guid != GST_GUID && frame->guid != GST_SAR_GUID)
+            {
+                results[base + i] = -GST_GUID_ERROR;
+            }
+            else if (frame->crc != frame->crc1)
+            {
+                results[base + i] = -GST_CRC_MISMATCH;
+            }
+            else if (frame->crc != crcs[i])
+            {
+                results[base + i] = -GST_CRC_ERROR;
+            }
+            else
+            {
+                results[base + i] = GST_SUCCESS;
+            }
+        }
+    }
 }
 
-ssize_t gs_uhf_write(char *buf, ssize_t buffer_size, bool *gst_done)
+void gs_uhf_print_rx_stats(gs_radio_t *radio)
 {
-    if (buffer_size < GST_MAX_PAYLOAD_SIZE)
+    gs_radio_irq_stats_t *stats = &radio->irq_stats;
+    dbprintlf(CYAN_FG "UHF RX: %llu wakeups, %llu spurious, %llu timeouts, %llu frames.",
+              (unsigned long long)stats->wakeups, (unsigned long long)stats->spurious,
+              (unsigned long long)stats->timeouts, (unsigned long long)stats->frames);
+    if (stats->frames)
     {
-        dbprintlf(RED_FG "Payload size incorrect.");
-        return -1;
+        dbprintlf(CYAN_FG "UHF RX arrival-to-handler latency: min %.1f us, mean %.1f us, max %.1f us.",
+                  stats->latency_min_ns / 1e3, stats->latency_sum_ns / 1e3 / stats->frames, stats->latency_max_ns / 1e3);
     }
+}
 
-    gst_frame_t frame[1];
-    memset(frame, 0x0, sizeof(gst_frame_t));
+ssize_t gs_uhf_write(gs_radio_t *radio, char *buf, ssize_t buffer_size, bool *gst_done, uint16_t guid)
+{
+    gst_fec_frame_t fec[1];
+    if (!gs_uhf_frame_build(&fec->frame, buf, buffer_size, guid))
+    {
+        dbprintlf(RED_FG "Payload size incorrect: %d bytes, at most %d fit a frame.", (int)buffer_size, GST_MAX_PAYLOAD_SIZE);
+        return -1;
+    }
+    gs_metrics_add(GS_COUNT_UPLINK_COPY_BYTES, GST_MAX_PAYLOAD_SIZE);
+    return gs_uhf_send_frame(radio, fec, gst_done);
+}
 
-    frame->guid = GST_GUID;
-    memcpy(frame->payload, buf, buffer_size);
-    frame->crc = internal_crc16(frame->payload, GST_MAX_PAYLOAD_SIZE);
-    frame->crc1 = frame->crc;
-    frame->termination = GST_TERMINATION;
+ssize_t gs_uhf_send_frame(gs_radio_t *radio, gst_fec_frame_t *fec, bool *gst_done)
+{
+    ssize_t frame_size = sizeof(gst_frame_t);
+    if (gs_uhf_fec_tx(radio))
+    {
+        gs_fec_encode(&fec->frame, sizeof(gst_frame_t), fec->parity);
+        frame_size = sizeof(gst_fec_frame_t);
+    }
 
     ssize_t retval = 0;
-    while (retval == 0)
+    for (int attempt = 0; attempt < UHF_TX_WRITE_ATTEMPTS && retval == 0 && !__atomic_load_n(gst_done, __ATOMIC_ACQUIRE); attempt++)
     {
-        retval = si446x_write(frame, sizeof(gst_frame_t));
+        retval = gs_radio_write(radio, fec, frame_size);
         if (retval == 0)
         {
-            dbprintlf(RED_FG "Sent zero bytes.");
+            logprintlf(GS_LOG_WARN, RED_FG "Sent zero bytes.");
         }
     }
+    gs_capture_frame(GS_CAPTURE_UHF_TX, fec, frame_size, 0, retval > 0 ? GST_SUCCESS : GST_ERROR);
 
-    dbprintlf(BLUE_FG "Transmitted with value: %d (note: this is not the number of bytes sent).", retval);
+    logprintlf(GS_LOG_DEBUG, BLUE_FG "Transmitted with value: %d (note: this is not the number of bytes sent).", retval);
 
     return retval;
 }
+
+int gs_uhf_frame_build(gst_frame_t *frame, const void *payload, ssize_t payload_size, uint16_t guid)
+{
+    if (payload_size < 0 || payload_size > GST_MAX_PAYLOAD_SIZE)
+    {
+        return 0;
+    }
+
+    if (payload_size > 0)
+    {
+        memcpy(frame->payload, payload, payload_size);
+    }
+    gs_uhf_frame_seal(frame, payload_size, guid);
+    return 1;
+}
+
+void gs_uhf_frame_seal(gst_frame_t *frame, ssize_t payload_size, uint16_t guid)
+{
+    if (payload_size < GST_MAX_PAYLOAD_SIZE)
+    {
+        memset(frame->payload + payload_size, 0x0, GST_MAX_PAYLOAD_SIZE - payload_size);
+    }
+
+    frame->guid = guid;
+    frame->crc = gs_crc16(frame->payload, GST_MAX_PAYLOAD_SIZE);
+    frame->crc1 = frame->crc;
+    frame->termination = GST_TERMINATION;
+}
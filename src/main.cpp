@@ -9,11 +9,82 @@
  * 
  */
 
+#include <stdlib.h>
+#include <string.h>
 #include <pthread.h>
 #include <unistd.h>
 #include <signal.h>
+#include <sched.h>
+#include <math.h>
 #include "meb_debug.hpp"
 #include "gs_uhf.hpp"
+#include "gs_ring.hpp"
+#include "gs_tx.hpp"
+#include "gs_sar.hpp"
+#include "gs_log.hpp"
+#include "gs_metrics.hpp"
+#include "gs_reactor.hpp"
+#include "gs_capture.hpp"
+#include "gs_diversity.hpp"
+#include "gs_spool.hpp"
+#include "gs_rt.hpp"
+#include "gs_pass.hpp"
+#include "gs_doppler.hpp"
+#include "gs_time.hpp"
+
+static void main_signal_cb(gs_reactor_t *reactor, int fd, uint32_t signo, void *arg)
+{
+    if (signo == SIGHUP)
+    {
+        // Start a new capture file, e.g. at the start of a pass.
+        if (gs_capture_active())
+        {
+            gs_capture_rotate();
+        }
+        return;
+    }
+    dbprintlf(YELLOW_FG "Caught signal %u, shutting down.", signo);
+    gs_reactor_stop(reactor);
+}
+
+/**
+ * @brief Starts a thread that touches the radio with its real-time policy and CPU, or as an ordinary thread
+ * if that is refused.
+ */
+static void main_start(pthread_t *tid, void *(*fn)(void *), void *arg, int priority, int cpu, const char *name)
+{
+    pthread_attr_t attr;
+    if (!gs_rt_thread_attr(&attr, priority, cpu) || pthread_create(tid, &attr, fn, arg) != 0)
+    {
+        dbprintlf(RED_FG "Failed to start the %s thread with priority %d on CPU %d, starting it without.", name, priority, cpu);
+        pthread_create(tid, NULL, fn, arg);
+    }
+    pthread_attr_destroy(&attr);
+}
+
+typedef struct
+{
+    global_data_t *global;
+    int priority;
+    int cpu;
+    uint32_t duration_ms;
+    uint32_t interval_us;
+} main_jitter_t;
+
+/**
+ * @brief Runs the jitter probe next to the radio threads, with their policy and CPU, while the ground station runs.
+ */
+static void *main_jitter_thread(void *args)
+{
+    main_jitter_t *probe = (main_jitter_t *)args;
+    gs_rt_jitter_t *jitter = (gs_rt_jitter_t *)malloc(sizeof(gs_rt_jitter_t));
+    if (jitter != nullptr && gs_rt_jitter_run(jitter, probe->priority, probe->cpu, probe->interval_us, probe->duration_ms, &probe->global->uhf_done))
+    {
+        gs_rt_jitter_print(jitter);
+    }
+    free(jitter);
+    return nullptr;
+}
 
 int main(int argc, char **argv)
 {
@@ -24,78 +95,470 @@ int main(int argc, char **argv)
     // Allows manual handling of a broken pipe signal using 'if (errno == EPIPE) {...}'.
     // Broken pipe signal will crash the process, and it caused by sending data to a closed socket.
     signal(SIGPIPE, SIG_IGN);
+    uint64_t start_ns = gs_time_ns();
+
+    // Radio selection.
+    // -s <options> replaces the si446x with a simulated radio, see gs_radio_sim_parse() for the options.
+    // Repeated, it adds a radio each time, and the frames they all hear are forwarded once.
+    // e.g. ./roof_uhf.out -s ber=1e-5,loss=0.01,rate=9600,beacon=10
+    int num_sims = 0;
+    const char *log_path = nullptr;
+    const char *metrics_path = UHF_METRICS_SOCKET;
+    gs_sim_config_t sim_config[UHF_MAX_RADIOS];
+    uint8_t safe_mods[256];
+    int num_safe_mods = 0;
+    gs_fec_mode_t fec_mode = GS_FEC_OFF;
+    bool rx_thread = true;
+    int rx_cpus[UHF_MAX_RADIOS];
+    int num_rx_cpus = 0;
+    const char *capture_prefix = nullptr;
+    const char *spool_dir = nullptr;
+    uint32_t health_ms = UHF_HEALTH_INTERVAL_MS;
+    const char *server_addr = nullptr;
+    gs_rt_config_t rt[1];
+    memset(rt, 0x0, sizeof(gs_rt_config_t));
+    main_jitter_t jitter[1] = {{nullptr, 0, -1, 0, 0}};
+    char *tle_path = nullptr;
+    int tle_catnum = 0;
+    gs_station_t station[1];
+    memset(station, 0x0, sizeof(gs_station_t));
+    bool have_station = false;
+    uint32_t pass_lead_s = UHF_PASS_LEAD_S;
+    double downlink_mhz = 0, uplink_mhz = 0;
+    bool adapt = false;
+    bool compress = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:l:m:p:f:r:Ic:q:i:a:R:k:J:T:g:W:D:AZ")) != -1)
+    {
+        switch (opt)
+        {
+        case 's':
+            if (num_sims == UHF_MAX_RADIOS)
+            {
+                fprintf(stderr, "At most %d radios.\n", UHF_MAX_RADIOS);
+                return -1;
+            }
+            gs_radio_sim_defaults(&sim_config[num_sims]);
+            sim_config[num_sims].seed += num_sims; // Radios lose different frames unless told otherwise.
+            if (!gs_radio_sim_parse(&sim_config[num_sims], optarg))
+            {
+                return -1;
+            }
+            num_sims++;
+            break;
+        case 'l':
+            // Binary hot-path log, read it with tools/gs_logdecode.out.
+            log_path = optarg;
+            break;
+        case 'm':
+            // Metrics socket path, "none" to disable.
+            metrics_path = strcmp(optarg, "none") == 0 ? nullptr : optarg;
+            break;
+        case 'p':
+            // cmd_input_t.mod whose uplink commands jump the TX queue (safe-mode priority), repeatable.
+            if (num_safe_mods < 256)
+            {
+                safe_mods[num_safe_mods++] = strtoul(optarg, NULL, 0);
+            }
+            break;
+        case 'f':
+            // Uplink framing: off (legacy), on (Reed-Solomon parity) or auto (match the spacecraft).
+            if (!gs_fec_mode_parse(optarg, &fec_mode))
+            {
+                fprintf(stderr, "Unknown FEC mode: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 'r':
+            // Pin the radio's RX thread to a CPU, or "any".
+            // With several radios, a comma-separated list is handed out to their threads in turn.
+            rx_thread = true;
+            num_rx_cpus = 0;
+            for (char *cpu = strtok(optarg, ","); cpu != nullptr && num_rx_cpus < UHF_MAX_RADIOS; cpu = strtok(nullptr, ","))
+            {
+                rx_cpus[num_rx_cpus++] = strcmp(cpu, "any") == 0 ? -1 : atoi(cpu);
+            }
+            break;
+        case 'I':
+            // Read the radio inline in the event loop instead of on its own thread. Saves a wakeup per frame, but
+            // the loop also blocks on the server socket, so a stalled server stops the radio being serviced.
+            rx_thread = false;
+            break;
+        case 'c':
+            // Capture every frame to <prefix>-<time>-<n>.cap, replay with tools/gs_replay.out.
+            capture_prefix = optarg;
+            break;
+        case 'q':
+            // Keep the downlink in this directory while the server is unreachable, instead of only in memory.
+            spool_dir = optarg;
+            break;
+        case 'i':
+            // Milliseconds between radio health probes.
+            health_ms = strtoul(optarg, NULL, 0);
+            if (health_ms == 0)
+            {
+                fprintf(stderr, "Bad health probe interval: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 'a':
+            // Connect to a stand-in server at host[:port] instead of the GS server, e.g. tools/gs_standin.out -e.
+            server_addr = optarg;
+            break;
+        case 'R':
+            // Real-time profile: lock memory, and run the radio threads SCHED_FIFO at this priority (1-99).
+            rt->priority = atoi(optarg);
+            if (rt->priority < 1 || rt->priority > 99)
+            {
+                fprintf(stderr, "Bad real-time priority: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 'k':
+            // CPUs for everything but the radio threads under -R, e.g. 0-1.
+            if (!gs_rt_parse_cpus(optarg, &rt->housekeeping))
+            {
+                fprintf(stderr, "Bad CPU list: %s\n", optarg);
+                return -1;
+            }
+            rt->isolate = true;
+            break;
+        case 'J':
+            // Run the jitter probe as a radio thread would for secs[:interval_us], and print its histogram.
+            jitter->duration_ms = (uint32_t)(atof(optarg) * 1000);
+            jitter->interval_us = strchr(optarg, ':') != nullptr ? strtoul(strchr(optarg, ':') + 1, NULL, 0) : 0;
+            if (jitter->duration_ms == 0)
+            {
+                fprintf(stderr, "Bad jitter probe duration: %s\n", optarg);
+                return -1;
+            }
+            break;
+        case 'T':
+        {
+            // Only have the radios up for the spacecraft's passes, predicted from this TLE file (re-read when it
+            // changes). :catnum picks the spacecraft's element set, otherwise the first is used. Needs -g.
+            tle_path = optarg;
+            char *colon = strrchr(optarg, ':');
+            if (colon != nullptr && colon[1] != '\0' && strspn(colon + 1, "0123456789") == strlen(colon + 1))
+            {
+                *colon = '\0';
+                tle_catnum = atoi(colon + 1);
+            }
+            break;
+        }
+        case 'g':
+        {
+            // The station, lat,lon[,alt_m] in degrees (east positive) and meters.
+            double lat, lon, alt_m = 0;
+            if (sscanf(optarg, "%lf,%lf,%lf", &lat, &lon, &alt_m) < 2 || fabs(lat) > 90 || fabs(lon) > 180)
+            {
+                fprintf(stderr, "Bad station position: %s\n", optarg);
+                return -1;
+            }
+            station->lat = lat * M_PI / 180;
+            station->lon = lon * M_PI / 180;
+            station->alt = alt_m / 1000;
+            have_station = true;
+            break;
+        }
+        case 'W':
+            // Seconds before AOS to wake the radios, long enough for an init and the first frames.
+            pass_lead_s = strtoul(optarg, NULL, 0);
+            break;
+        case 'D':
+            // Doppler correction during passes (needs -T), for the spacecraft's downlink[,uplink] frequency in MHz.
+            if (sscanf(optarg, "%lf,%lf", &downlink_mhz, &uplink_mhz) < 1 || downlink_mhz <= 0 || uplink_mhz < 0)
+            {
+                fprintf(stderr, "Bad frequencies: %s\n", optarg);
+                return -1;
+            }
+            uplink_mhz = uplink_mhz > 0 ? uplink_mhz : downlink_mhz;
+            break;
+        case 'A':
+            // Adaptive data rate from the start; the server can also turn it on or off with a UHF_CONFIG frame.
+            adapt = true;
+            break;
+        case 'Z':
+            // Compress uplink payloads longer than a frame; the spacecraft must carry gs_lz and its dictionaries.
+            compress = true;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-s sim_options]... [-l log_file] [-m metrics_socket] [-p safe_mod]... [-f off|on|auto] [-r cpu[,cpu]...|any] [-I] [-c capture_prefix] [-q spool_dir] [-i health_ms] [-a host[:port]] [-R priority] [-k cpu_list] [-J secs[:interval_us]] [-T tle_file[:catnum] -g lat,lon[,alt_m] [-W lead_s] [-D downlink_mhz[,uplink_mhz]]] [-A] [-Z]\n", argv[0]);
+            return -1;
+        }
+    }
 
-    // Spawn UHF-RX thread.
-    // Spawn Network-RX thread.
+    if (tle_path != nullptr && !have_station)
+    {
+        fprintf(stderr, "-T needs the station's position, -g lat,lon[,alt_m].\n");
+        return -1;
+    }
+    if (downlink_mhz > 0 && tle_path == nullptr)
+    {
+        fprintf(stderr, "-D needs the passes, -T tle_file.\n");
+        return -1;
+    }
 
-    // When something is received from the GS Network...
-    // - Parse it.
-    // - TX it (or not).
+    // Before any thread starts: they inherit the stack size and the housekeeping CPUs. The radio's receive
+    // side gets a thread of its own, so it is scheduled apart from the event loop.
+    if (rt->priority > 0)
+    {
+        gs_rt_setup(rt);
+        rx_thread = true;
+    }
+
+    // SIGINT and SIGTERM stop the event loop, SIGHUP rotates the capture file. Blocked before any thread starts, so they all inherit the mask.
+    gs_reactor_t *reactor = gs_reactor_create();
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGHUP);
+    if (reactor == nullptr || gs_reactor_signals(reactor, &signals, main_signal_cb, nullptr) < 0)
+    {
+        dbprintlf(FATAL "Failed to create the event loop.");
+        return -1;
+    }
 
-    // When something is received on UHF...
-    // - Parse it.
-    // - Send it to the server (or not).
+    // Hot-path logging is formatted (or written to log_path) by a background thread from here on.
+    if (!gs_log_start(log_path))
+    {
+        return -1;
+    }
 
     // Set up global data.
     global_data_t global[1] = {0};
     global->network_data = new NetDataClient(NetPort::ROOFUHF, SERVER_POLL_RATE);
     global->network_data->recv_active = true;
-
-    // Create Ground Station Network thread IDs.
-    pthread_t net_polling_tid, net_rx_tid, uhf_rx_tid;
-
-    // Start the RX threads, and restart them should it be necessary.
-    // Only gets-out if a thread declares an unrecoverable emergency and sets its status to -1.
-    while (global->network_data->thread_status > -1)
+    global->reactor = reactor;
+    global->health_ms = health_ms;
+    global->start_ns = start_ns;
+    global->server_addr = server_addr;
+    global->compress = compress;
+    pthread_mutex_init(&global->net_lock, NULL);
+    global->num_radios = num_sims > 0 ? num_sims : 1;
+    for (int i = 0; i < global->num_radios; i++)
     {
-        // 1 = All good, 0 = recoverable failure, -1 = fatal failure (close program)
-        global->network_data->thread_status = 1;
-
-        // Initialize and begin socket communication to the server.
-        if (!global->network_data->connection_ready)
+        gs_uhf_radio_t *rx = &global->radios[i];
+        rx->global = global;
+        rx->index = i;
+        rx->radio = num_sims > 0 ? gs_radio_sim_create(&sim_config[i]) : gs_radio_si446x_create();
+        if (rx->radio == nullptr)
+        {
+            dbprintlf(FATAL "Failed to create radio %d.", i);
+            return -1;
+        }
+        rx->radio->fec = fec_mode;
+    }
+    global->radio = global->radios[0].radio;
+    dbprintlf(GREEN_FG "Using %d %s radio%s, FEC %s.", global->num_radios, global->radio->ops->name, global->num_radios > 1 ? "s" : "", gs_fec_mode_name(fec_mode));
+    global->uhf_rx_ring = gs_ring_create(UHF_RX_RING_SIZE);
+    if (global->uhf_rx_ring == nullptr)
+    {
+        dbprintlf(FATAL "Failed to create the UHF RX ring.");
+        return -1;
+    }
+    gs_metrics_watch_ring("uhf_rx", global->uhf_rx_ring);
+    if (global->num_radios > 1)
+    {
+        // Each radio is read on its own thread into its own ring, see gs_uhf_radio_rx_thread().
+        static const char *ring_names[UHF_MAX_RADIOS] = {"uhf_rx0", "uhf_rx1", "uhf_rx2", "uhf_rx3", "uhf_rx4", "uhf_rx5", "uhf_rx6", "uhf_rx7"};
+        rx_thread = true;
+        global->diversity = gs_div_create(global->num_radios, UHF_DIVERSITY_WINDOW_MS, UHF_DIVERSITY_STALE_MS);
+        if (global->diversity == nullptr)
+        {
+            return -1;
+        }
+        for (int i = 0; i < global->num_radios; i++)
         {
-            // TODO: Check if this is the desired functionality.
-            // Currently, the program will not proceed past this point if it cannot connect to the server.
-            // _polling_thread will handle disconnections from the server.
-            while (gs_connect_to_server(global->network_data) != 1)
+            global->radios[i].rx_ring = gs_ring_create(UHF_RX_RING_SIZE);
+            if (global->radios[i].rx_ring == nullptr)
             {
-                dbprintlf(RED_FG "Failed to establish connection to server.");
-                usleep(5 SEC);
+                dbprintlf(FATAL "Failed to create the RX ring for radio %d.", i);
+                return -1;
             }
+            gs_metrics_watch_ring(ring_names[i], global->radios[i].rx_ring);
         }
+    }
+    if (metrics_path != nullptr)
+    {
+        // Not fatal, the ground station runs fine without its metrics.
+        gs_metrics_start(metrics_path);
+    }
+    global->uhf_tx_queue = gs_tx_queue_create(UHF_TX_QUEUE_SIZE);
+    if (global->uhf_tx_queue == nullptr)
+    {
+        dbprintlf(FATAL "Failed to create the UHF TX queue.");
+        return -1;
+    }
+    for (int i = 0; i < num_safe_mods; i++)
+    {
+        gs_tx_set_safe_mod(global->uhf_tx_queue, safe_mods[i]);
+    }
+    global->uhf_sar = gs_sar_create(UHF_SAR_MAX_MESSAGE);
+    if (global->uhf_sar == nullptr)
+    {
+        dbprintlf(FATAL "Failed to create the UHF SAR endpoint.");
+        return -1;
+    }
+    if (capture_prefix != nullptr && !gs_capture_start(capture_prefix, UHF_CAPTURE_RECORDS, UHF_CAPTURE_PASS_GAP_S))
+    {
+        dbprintlf(FATAL "Failed to start the pass capture.");
+        return -1;
+    }
+    if (spool_dir != nullptr)
+    {
+        global->spool = gs_spool_open(spool_dir, UHF_SPOOL_SEGMENT_BYTES, UHF_SPOOL_MAX_BYTES);
+        if (global->spool == nullptr)
+        {
+            dbprintlf(FATAL "Failed to open the spool.");
+            return -1;
+        }
+        gs_metrics_watch_spool(global->spool);
+    }
+    global->netframe_pool = gs_pool_create("NetFrame", sizeof(NetFrame), NETFRAME_POOL_SIZE);
+    global->payload_pool = gs_pool_create("Payload", NETFRAME_MAX_PAYLOAD_SIZE, PAYLOAD_POOL_SIZE);
+    if (global->netframe_pool == nullptr || global->payload_pool == nullptr)
+    {
+        dbprintlf(FATAL "Failed to create the frame pools.");
+        return -1;
+    }
 
-        // Start the threads.
-        pthread_create(&net_polling_tid, NULL, gs_polling_thread, global->network_data);
-        pthread_create(&net_rx_tid, NULL, gs_network_rx_thread, global);
-        // pthread_create(&uhf_rx_tid, NULL, gs_uhf_rx_thread, global);
-        
-        void *thread_return;
-        pthread_join(net_polling_tid, &thread_return);
-        pthread_join(net_rx_tid, &thread_return);
-        pthread_join(uhf_rx_tid, &thread_return);
+    if (tle_path != nullptr)
+    {
+        global->passes = gs_pass_plan_create(station, UHF_PASS_MIN_EL_DEG * M_PI / 180, UHF_PASS_HORIZON_S);
+        if (global->passes == nullptr)
+        {
+            dbprintlf(FATAL "Failed to create the pass plan.");
+            return -1;
+        }
+        global->pass_lead_s = pass_lead_s;
+        // Not fatal: the file may only appear later, and the radios stay up until it does.
+        if (gs_pass_plan_reload(global->passes, tle_path, tle_catnum, gs_pass_now()) < 0)
+        {
+            dbprintlf(RED_FG "No usable element set in %s yet.", tle_path);
+        }
+        // The radios are first brought up by the event loop, once it knows whether a pass is near.
+        gs_pass_gate_set(global->passes, false);
+    }
+    if (downlink_mhz > 0)
+    {
+        if (global->radio->ops->tune == nullptr)
+        {
+            dbprintlf(YELLOW_FG "The %s radio cannot be retuned, no Doppler correction.", global->radio->ops->name);
+        }
+        else if ((global->doppler = gs_doppler_create(downlink_mhz * 1e6, uplink_mhz * 1e6, UHF_DOPPLER_TOL_HZ)) == nullptr)
+        {
+            return -1;
+        }
+    }
+    // Always there, so UHF_CONFIG frames are answered; a radio that cannot switch NACKs them.
+    if (global->radio->ops->configure == nullptr)
+    {
+        dbprintlf(YELLOW_FG "The %s radio cannot change its modem profile, UHF_CONFIG frames will be NACKed.", global->radio->ops->name);
+    }
+    else if ((global->modem = gs_modem_create(adapt)) == nullptr)
+    {
+        return -1;
+    }
 
-        // Loop will begin, restarting the threads.
+    // The event loop serves the server and, only with -I and a single radio, the radio's receive side. Transmission has its own thread.
+    pthread_t uhf_rx_tids[UHF_MAX_RADIOS], uhf_tx_tid;
+    int num_rx_threads = rx_thread ? global->num_radios : 0;
+    global->network_data->thread_status = 1;
+    // Under -R the TX thread shares the first radio's CPU, one priority below the receive side.
+    int radio_cpu = num_rx_cpus > 0 ? rx_cpus[0] : -1;
+    main_start(&uhf_tx_tid, gs_uhf_tx_thread, global, rt->priority > 1 ? rt->priority - 1 : rt->priority, rt->priority ? radio_cpu : -1, "UHF TX");
+    for (int i = 0; i < num_rx_threads; i++)
+    {
+        int cpu = num_rx_cpus > 0 ? rx_cpus[i % num_rx_cpus] : -1;
+        if (global->num_radios > 1)
+        {
+            main_start(&uhf_rx_tids[i], gs_uhf_radio_rx_thread, &global->radios[i], rt->priority, cpu, "UHF RX");
+        }
+        else
+        {
+            main_start(&uhf_rx_tids[i], gs_uhf_rx_thread, global, rt->priority, cpu, "UHF RX");
+        }
+    }
+    pthread_t jitter_tid;
+    if (jitter->duration_ms)
+    {
+        jitter->global = global;
+        jitter->priority = rt->priority;
+        jitter->cpu = radio_cpu;
+        pthread_create(&jitter_tid, NULL, main_jitter_thread, jitter);
     }
 
+    int retval = gs_uhf_event_loop(global, rx_thread) ? 0 : -1;
+
     // Finished.
-    void *thread_return;
-    pthread_cancel(net_polling_tid);
-    pthread_cancel(net_rx_tid);
-    pthread_cancel(uhf_rx_tid);
-    pthread_join(net_polling_tid, &thread_return);
-    thread_return == PTHREAD_CANCELED ? printf("Good net_polling_tid join.\n") : printf("Bad net_polling_tid join.\n");
-    pthread_join(net_rx_tid, &thread_return);
-    thread_return == PTHREAD_CANCELED ? printf("Good net_rx_tid join.\n") : printf("Bad net_rx_tid join.\n");
-    pthread_join(uhf_rx_tid, &thread_return);
-    thread_return == PTHREAD_CANCELED ? printf("Good uhf_rx_tid join.\n") : printf("Bad uhf_rx_tid join.\n");
-
-    // Put radio to sleep.
-    si446x_sleep();
+    __atomic_store_n(&global->uhf_done, true, __ATOMIC_RELEASE);
+    __atomic_store_n(&global->network_data->thread_status, 0, __ATOMIC_RELEASE);
+    gs_tx_stop(global->uhf_tx_queue);
+    if (global->passes != nullptr)
+    {
+        gs_pass_gate_stop(global->passes);
+    }
+    pthread_join(uhf_tx_tid, NULL);
+    for (int i = 0; i < num_rx_threads; i++)
+    {
+        pthread_join(uhf_rx_tids[i], NULL);
+    }
+    if (jitter->duration_ms)
+    {
+        pthread_join(jitter_tid, NULL);
+    }
+
+    // Put the radios to sleep.
+    for (int i = 0; i < global->num_radios; i++)
+    {
+        if (global->num_radios > 1)
+        {
+            dbprintlf(CYAN_FG "Radio %d:", i);
+            gs_uhf_print_rx_stats(global->radios[i].radio);
+        }
+        gs_radio_sleep(global->radios[i].radio);
+        gs_radio_destroy(global->radios[i].radio);
+        gs_ring_destroy(global->radios[i].rx_ring);
+    }
+    gs_div_destroy(global->diversity);
+    if (global->passes != nullptr)
+    {
+        gs_pass_plan_print(global->passes);
+        gs_pass_plan_destroy(global->passes);
+    }
+    if (global->doppler != nullptr)
+    {
+        gs_doppler_print(global->doppler);
+        gs_doppler_destroy(global->doppler);
+    }
+    if (global->modem != nullptr)
+    {
+        gs_modem_print(global->modem);
+        gs_modem_destroy(global->modem);
+    }
+    gs_metrics_stop();
+    gs_capture_stop();
+    gs_spool_close(global->spool);
+    gs_ring_destroy(global->uhf_rx_ring);
+    gs_tx_queue_destroy(global->uhf_tx_queue);
+    gs_sar_destroy(global->uhf_sar);
+    gs_pool_print_stats(global->netframe_pool);
+    gs_pool_print_stats(global->payload_pool);
+    gs_pool_destroy(global->netframe_pool);
+    gs_pool_destroy(global->payload_pool);
+    gs_log_stop();
 
     // Destroy other things.
-    close(global->network_data->socket);
+    if (global->network_data->socket >= 0)
+    {
+        close(global->network_data->socket);
+    }
+    gs_reactor_destroy(reactor);
+    pthread_mutex_destroy(&global->net_lock);
 
-    int retval = global->network_data->thread_status;
     delete global->network_data;
     return retval;
 }
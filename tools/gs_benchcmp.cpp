@@ -0,0 +1,183 @@
+/**
+ * @file gs_benchcmp.cpp
+ * @author agent (agent@local)
+ * @brief Compares two benchmark result files (make bench BENCH_JSON=<file>) and fails on a regression.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * Usage: gs_benchcmp.out [-t percent] <baseline> <current>
+ *     -t  How much worse than the baseline a metric may get before it counts as a regression, in percent
+ *         (default 10). A metric reported with a larger tolerance of its own gets that instead.
+ * 
+ * Every metric in the baseline is looked up in the current results and printed with its change. Metrics
+ * missing from either side are listed but do not fail the comparison (a CRC path the machine does not
+ * support, a benchmark added since the baseline). Exits non-zero if any metric regressed, or if no metric
+ * could be compared at all.
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "gs_bench.hpp"
+
+#define BENCHCMP_DEFAULT_PCT 10
+
+typedef struct
+{
+    gs_bench_result_t *results;
+    size_t count;
+    size_t capacity;
+} benchcmp_set_t;
+
+/**
+ * @brief Finds a metric in a set, nullptr if it is not there.
+ */
+static gs_bench_result_t *benchcmp_find(benchcmp_set_t *set, const char *bench, const char *metric)
+{
+    for (size_t i = 0; i < set->count; i++)
+    {
+        if (strcmp(set->results[i].bench, bench) == 0 && strcmp(set->results[i].metric, metric) == 0)
+        {
+            return &set->results[i];
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Reads a result file. A metric reported more than once (make bench run several times into the same
+ * file) keeps its best value, which is far steadier from run to run than any single one.
+ * 
+ * @return int 1 on success, 0 on failure.
+ */
+static int benchcmp_load(const char *path, benchcmp_set_t *set)
+{
+    FILE *fp = fopen(path, "r");
+    if (fp == nullptr)
+    {
+        fprintf(stderr, "Cannot open %s: %s\n", path, strerror(errno));
+        return 0;
+    }
+
+    char line[GS_BENCH_LINE_MAX];
+    int lineno = 0;
+    while (fgets(line, sizeof(line), fp) != nullptr)
+    {
+        lineno++;
+        gs_bench_result_t result[1];
+        if (!gs_bench_parse(line, result))
+        {
+            fprintf(stderr, "%s:%d: not a benchmark result, skipped.\n", path, lineno);
+            continue;
+        }
+        gs_bench_result_t *slot = benchcmp_find(set, result->bench, result->metric);
+        if (slot == nullptr)
+        {
+            if (set->count == set->capacity)
+            {
+                size_t capacity = set->capacity ? set->capacity * 2 : 64;
+                gs_bench_result_t *results = (gs_bench_result_t *)realloc(set->results, capacity * sizeof(gs_bench_result_t));
+                if (results == nullptr)
+                {
+                    fclose(fp);
+                    return 0;
+                }
+                set->results = results;
+                set->capacity = capacity;
+            }
+            slot = &set->results[set->count++];
+            *slot = *result;
+        }
+        else if (result->better == GS_BENCH_HIGHER ? result->value > slot->value : result->value < slot->value)
+        {
+            slot->value = result->value;
+        }
+    }
+    fclose(fp);
+    return 1;
+}
+
+int main(int argc, char *argv[])
+{
+    double threshold = BENCHCMP_DEFAULT_PCT;
+    int opt;
+    while ((opt = getopt(argc, argv, "t:")) != -1)
+    {
+        switch (opt)
+        {
+        case 't':
+            threshold = atof(optarg);
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-t percent] <baseline> <current>\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind + 2 > argc)
+    {
+        fprintf(stderr, "Usage: %s [-t percent] <baseline> <current>\n", argv[0]);
+        return 1;
+    }
+
+    benchcmp_set_t baseline[1] = {{nullptr, 0, 0}}, current[1] = {{nullptr, 0, 0}};
+    if (!benchcmp_load(argv[optind], baseline) || !benchcmp_load(argv[optind + 1], current))
+    {
+        return 1;
+    }
+
+    int compared = 0, regressed = 0, improved = 0, missing = 0;
+    printf("%-12s %-32s %14s %14s %9s  %s\n", "bench", "metric", "baseline", "current", "change", "");
+    for (size_t i = 0; i < baseline->count; i++)
+    {
+        gs_bench_result_t *base = &baseline->results[i];
+        gs_bench_result_t *now = benchcmp_find(current, base->bench, base->metric);
+        if (now == nullptr)
+        {
+            printf("%-12s %-32s %14.6g %14s %9s  missing\n", base->bench, base->metric, base->value, "-", "-");
+            missing++;
+            continue;
+        }
+        compared++;
+
+        // Positive when the metric got worse, whichever way it improves.
+        double change = base->value != 0 ? (now->value - base->value) / base->value * 100 : (now->value != 0 ? 100 : 0);
+        double worse = base->better == GS_BENCH_HIGHER ? -change : change;
+        double allowed = base->tolerance > threshold ? base->tolerance : threshold;
+        const char *verdict = "";
+        if (worse > allowed)
+        {
+            verdict = "REGRESSED";
+            regressed++;
+        }
+        else if (worse < -allowed)
+        {
+            verdict = "improved";
+            improved++;
+        }
+        printf("%-12s %-32s %14.6g %14.6g %+8.1f%%  %s %s\n", base->bench, base->metric, base->value, now->value, change, now->unit, verdict);
+    }
+    for (size_t i = 0; i < current->count; i++)
+    {
+        gs_bench_result_t *now = &current->results[i];
+        if (benchcmp_find(baseline, now->bench, now->metric) == nullptr)
+        {
+            printf("%-12s %-32s %14s %14.6g %9s  %s new\n", now->bench, now->metric, "-", now->value, "-", now->unit);
+        }
+    }
+
+    printf("%d metrics compared (threshold %.0f%%): %d regressed, %d improved, %d missing from the current run.\n",
+           compared, threshold, regressed, improved, missing);
+    free(baseline->results);
+    free(current->results);
+    if (compared == 0)
+    {
+        fprintf(stderr, "No metric in common, nothing compared.\n");
+        return 1;
+    }
+    return regressed ? 1 : 0;
+}
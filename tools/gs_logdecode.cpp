@@ -0,0 +1,58 @@
+/**
+ * @file gs_logdecode.cpp
+ * @author agent (agent@local)
+ * @brief Prints a binary log written by roof_uhf.out -l <file> as text.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * Usage: gs_logdecode.out [-p] <log file>
+ *     -p  Plain text, strips the color escapes.
+ * 
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "gs_log.hpp"
+
+int main(int argc, char *argv[])
+{
+    bool plain = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "p")) != -1)
+    {
+        switch (opt)
+        {
+        case 'p':
+            plain = true;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-p] <log file>\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind >= argc)
+    {
+        fprintf(stderr, "Usage: %s [-p] <log file>\n", argv[0]);
+        return 1;
+    }
+
+    FILE *in = fopen(argv[optind], "rb");
+    if (in == nullptr)
+    {
+        fprintf(stderr, "Cannot open %s: %s\n", argv[optind], strerror(errno));
+        return 1;
+    }
+
+    int decoded = gs_log_decode(in, stdout, plain);
+    fclose(in);
+    if (decoded < 0)
+    {
+        fprintf(stderr, "%s is not a log file, or is truncated.\n", argv[optind]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,380 @@
+/**
+ * @file gs_replay.cpp
+ * @author agent (agent@local)
+ * @brief Replays a pass capture (roof_uhf.out -c) through the ground station's receive and uplink paths.
+ * @version See Git tags for version information.
+ * @date 2026.10.16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * Usage: gs_replay.out [-x speed|max] [-l] <capture file>
+ *     -x  Replay at speed times the captured rate (default 1), or as fast as the ground station takes it.
+ *     -l  List the capture instead of replaying it.
+ * 
+ * Captured radio frames are sent from the far end of a simulated radio and captured server frames from a
+ * stand-in server, in their recorded order and spacing, into the same event loop and UHF TX thread the
+ * daemon runs. What the loop forwards to the server is compared against what the daemon forwarded when the
+ * capture was made: the tool exits non-zero unless the DATA frames the daemon forwarded come out again, in
+ * order and byte for byte, so a capture doubles as a regression test. Radio frames are never sent faster
+ * than the radio FIFO is drained.
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include "gs_uhf.hpp"
+#include "gs_capture.hpp"
+#include "gs_reactor.hpp"
+#include "gs_ring.hpp"
+#include "gs_tx.hpp"
+#include "gs_sar.hpp"
+#include "gs_radio.hpp"
+#include "gs_time.hpp"
+#include "gs_log.hpp"
+#include "meb_debug.hpp"
+
+#define REPLAY_SETTLE_MS 2000 // Quiet time after the last frame before the results are taken.
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+typedef struct
+{
+    uint64_t frames;
+    uint64_t bytes;
+    uint64_t hash; // FNV-1a over the frames in order.
+} replay_tally_t;
+
+typedef struct
+{
+    NetDataClient *server;
+    replay_tally_t data;
+    replay_tally_t prefix; // The first limit DATA frames.
+    uint64_t limit;
+    uint64_t nacks;
+    uint64_t last_ns;
+} replay_server_t;
+
+typedef struct
+{
+    gs_radio_t *radio;
+    bool running;
+    uint64_t frames;
+    uint64_t last_ns;
+} replay_far_t;
+
+static void tally_add(replay_tally_t *tally, const uint8_t *data, size_t len)
+{
+    if (tally->frames == 0)
+    {
+        tally->hash = FNV_OFFSET;
+    }
+    for (size_t i = 0; i < len; i++)
+    {
+        tally->hash = (tally->hash ^ data[i]) * FNV_PRIME;
+    }
+    tally->frames++;
+    tally->bytes += len;
+}
+
+static void *replay_server_thread(void *args)
+{
+    replay_server_t *server = (replay_server_t *)args;
+    NetFrame *netframe = new NetFrame();
+    unsigned char payload[NETFRAME_MAX_PAYLOAD_SIZE];
+
+    while (netframe->recvFrame(server->server) >= 0)
+    {
+        int size = netframe->getPayloadSize();
+        if (size < 0 || size > NETFRAME_MAX_PAYLOAD_SIZE || netframe->retrievePayload(payload, size) < 0)
+        {
+            continue;
+        }
+        if (netframe->getType() == NetType::DATA)
+        {
+            tally_add(&server->data, payload, size);
+            if (server->prefix.frames < server->limit)
+            {
+                tally_add(&server->prefix, payload, size);
+            }
+        }
+        else if (netframe->getType() == NetType::NACK)
+        {
+            server->nacks++;
+        }
+        __atomic_store_n(&server->last_ns, gs_time_ns(), __ATOMIC_RELEASE);
+    }
+    delete netframe;
+    return nullptr;
+}
+
+static void *replay_far_thread(void *args)
+{
+    replay_far_t *far = (replay_far_t *)args;
+    uint8_t frame[sizeof(gst_fec_frame_t)];
+    while (__atomic_load_n(&far->running, __ATOMIC_ACQUIRE))
+    {
+        if (gs_radio_sim_far_recv(far->radio, frame, sizeof(frame), 100) > 0)
+        {
+            far->frames++;
+            __atomic_store_n(&far->last_ns, gs_time_ns(), __ATOMIC_RELEASE);
+        }
+    }
+    return nullptr;
+}
+
+typedef struct
+{
+    global_data_t *global;
+    int retval;
+} replay_loop_t;
+
+static void *replay_loop_thread(void *args)
+{
+    replay_loop_t *loop = (replay_loop_t *)args;
+    loop->retval = gs_uhf_event_loop(loop->global, false);
+    return nullptr;
+}
+
+static int replay_list(gs_capture_file_t *file)
+{
+    const gs_capture_header_t *header = gs_capture_header(file);
+    time_t start = header->start_real_ns / NSEC_PER_SEC;
+    char stamp[32];
+    struct tm tm;
+    strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", gmtime_r(&start, &tm));
+    printf("Capture started %s UTC, %u of %u records used.\n", stamp,
+           header->count < header->capacity ? header->count : header->capacity, header->capacity);
+
+    uint8_t buf[NETFRAME_MAX_PAYLOAD_SIZE];
+    gs_capture_entry_t entry;
+    uint32_t index = 0;
+    while (gs_capture_next(file, &index, &entry, buf, sizeof(buf)))
+    {
+        printf("%12.6f %-6s %4u bytes rssi %4d result %4d ", (entry.ts_ns - header->start_mono_ns) / 1e9,
+               gs_capture_kind_name(entry.kind), entry.len, entry.rssi, entry.result);
+        for (uint32_t i = 0; i < entry.len && i < 16; i++)
+        {
+            printf("%02x", buf[i]);
+        }
+        printf(entry.len > 16 ? "...\n" : "\n");
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    double speed = 1;
+    bool list = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "x:l")) != -1)
+    {
+        switch (opt)
+        {
+        case 'x':
+            speed = strcmp(optarg, "max") == 0 ? 0 : atof(optarg);
+            break;
+        case 'l':
+            list = true;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-x speed|max] [-l] <capture file>\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind >= argc || speed < 0)
+    {
+        fprintf(stderr, "Usage: %s [-x speed|max] [-l] <capture file>\n", argv[0]);
+        return 1;
+    }
+
+    gs_capture_file_t *file = gs_capture_open(argv[optind]);
+    if (file == nullptr)
+    {
+        return 1;
+    }
+    if (list)
+    {
+        int retval = replay_list(file);
+        gs_capture_close(file);
+        return retval;
+    }
+
+    // What the daemon did with the capture's inputs.
+    uint8_t buf[NETFRAME_MAX_PAYLOAD_SIZE];
+    gs_capture_entry_t entry;
+    uint32_t index = 0;
+    replay_tally_t expected = {0, 0, 0};
+    uint64_t inputs[GS_CAPTURE_KIND_NUM] = {0};
+    uint64_t uplinks = 0;
+    while (gs_capture_next(file, &index, &entry, buf, sizeof(buf)))
+    {
+        inputs[entry.kind]++;
+        if (entry.kind == GS_CAPTURE_NET_TX && entry.result == (int)NetType::DATA)
+        {
+            tally_add(&expected, buf, entry.len < sizeof(buf) ? entry.len : sizeof(buf));
+        }
+        else if (entry.kind == GS_CAPTURE_UHF_TX && entry.result == GST_SUCCESS)
+        {
+            uplinks++;
+        }
+    }
+
+    // The ground station, as main() sets it up, with a simulated radio and a socketpair for a server.
+    gs_log_start("/dev/null");
+    gs_sim_config_t config[1];
+    gs_radio_sim_defaults(config);
+    gs_radio_sim_parse(config, "external,rate=0");
+    global_data_t global[1];
+    memset(global, 0x0, sizeof(global_data_t));
+    global->radio = gs_radio_sim_create(config);
+    global->uhf_rx_ring = gs_ring_create(UHF_RX_RING_SIZE);
+    global->uhf_tx_queue = gs_tx_queue_create(UHF_TX_QUEUE_SIZE);
+    global->uhf_sar = gs_sar_create(UHF_SAR_MAX_MESSAGE);
+    global->netframe_pool = gs_pool_create("NetFrame", sizeof(NetFrame), NETFRAME_POOL_SIZE);
+    global->payload_pool = gs_pool_create("Payload", NETFRAME_MAX_PAYLOAD_SIZE, PAYLOAD_POOL_SIZE);
+    global->reactor = gs_reactor_create();
+    pthread_mutex_init(&global->net_lock, NULL);
+    int sv[2];
+    if (global->radio == nullptr || global->reactor == nullptr || socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0)
+    {
+        dbprintlf(FATAL "Failed to set up the ground station.");
+        return 1;
+    }
+    global->network_data = new NetDataClient(NetPort::ROOFUHF, SERVER_POLL_RATE);
+    global->network_data->socket = sv[0];
+    global->network_data->connection_ready = true;
+    global->network_data->thread_status = 1;
+
+    replay_server_t server[1];
+    memset(server, 0x0, sizeof(replay_server_t));
+    server->limit = expected.frames;
+    server->server = new NetDataClient(NetPort::ROOFUHF, SERVER_POLL_RATE);
+    server->server->socket = sv[1];
+    server->server->connection_ready = true;
+    replay_far_t far[1] = {{global->radio, true, 0, 0}};
+    replay_loop_t loop[1] = {{global, 0}};
+
+    pthread_t server_tid, far_tid, loop_tid, tx_tid;
+    pthread_create(&server_tid, NULL, replay_server_thread, server);
+    pthread_create(&far_tid, NULL, replay_far_thread, far);
+    pthread_create(&loop_tid, NULL, replay_loop_thread, loop);
+    pthread_create(&tx_tid, NULL, gs_uhf_tx_thread, global);
+    while (!__atomic_load_n(&global->uhf_ready, __ATOMIC_ACQUIRE))
+    {
+        usleep(1000);
+    }
+
+    // Feed the inputs back in the order and, scaled, the spacing they were captured with.
+    uint64_t first_ns = 0;
+    uint64_t start = gs_time_ns();
+    uint64_t radio_sent = 0;
+    index = 0;
+    while (gs_capture_next(file, &index, &entry, buf, sizeof(buf)))
+    {
+        if (entry.kind != GS_CAPTURE_UHF_RX && entry.kind != GS_CAPTURE_NET_RX)
+        {
+            continue;
+        }
+        uint32_t len = entry.len < sizeof(buf) ? entry.len : sizeof(buf);
+        first_ns = first_ns ? first_ns : entry.ts_ns;
+        if (speed > 0)
+        {
+            uint64_t due = start + (uint64_t)((entry.ts_ns - first_ns) / speed);
+            struct timespec ts = {(time_t)(due / NSEC_PER_SEC), (long)(due % NSEC_PER_SEC)};
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        }
+
+        if (entry.kind == GS_CAPTURE_UHF_RX)
+        {
+            gs_sim_stats_t stats[1];
+            gs_radio_sim_stats(global->radio, stats);
+            while (radio_sent - stats->downlink_lost - stats->downlink_read >= SIM_RX_FIFO_DEPTH)
+            {
+                usleep(10);
+                gs_radio_sim_stats(global->radio, stats);
+            }
+            gs_radio_sim_far_send(global->radio, buf, len);
+            radio_sent++;
+        }
+        else
+        {
+            NetFrame netframe(len > 0 ? buf : nullptr, len, (NetType)entry.result, NetVertex::ROOFUHF);
+            netframe.sendFrame(server->server);
+        }
+    }
+    uint64_t fed = gs_time_ns();
+
+    // Done once nothing has come out for a while.
+    while (true)
+    {
+        usleep(100000);
+        uint64_t last = __atomic_load_n(&server->last_ns, __ATOMIC_ACQUIRE);
+        uint64_t far_last = __atomic_load_n(&far->last_ns, __ATOMIC_ACQUIRE);
+        last = far_last > last ? far_last : last;
+        last = last > fed ? last : fed;
+        if (gs_time_ns() - last >= REPLAY_SETTLE_MS * NSEC_PER_MSEC)
+        {
+            break;
+        }
+    }
+
+    gs_reactor_stop(global->reactor);
+    pthread_join(loop_tid, NULL);
+    __atomic_store_n(&global->uhf_done, true, __ATOMIC_RELEASE);
+    __atomic_store_n(&global->network_data->thread_status, 0, __ATOMIC_RELEASE);
+    gs_tx_stop(global->uhf_tx_queue);
+    pthread_join(tx_tid, NULL);
+    __atomic_store_n(&far->running, false, __ATOMIC_RELEASE);
+    pthread_join(far_tid, NULL);
+    shutdown(sv[0], SHUT_RDWR);
+    pthread_join(server_tid, NULL);
+    gs_log_stop();
+
+    double secs = (fed - start) / 1e9;
+    printf("Replayed %llu radio frames and %llu server frames in %.3f s (%.0f frames/s, %s).\n",
+           (unsigned long long)inputs[GS_CAPTURE_UHF_RX], (unsigned long long)inputs[GS_CAPTURE_NET_RX], secs,
+           secs > 0 ? (inputs[GS_CAPTURE_UHF_RX] + inputs[GS_CAPTURE_NET_RX]) / secs : 0.0, speed > 0 ? "timed" : "max");
+    printf("Downlink to server: %llu DATA frames, %llu bytes (captured: %llu, %llu).\n", (unsigned long long)server->data.frames,
+           (unsigned long long)server->data.bytes, (unsigned long long)expected.frames, (unsigned long long)expected.bytes);
+    printf("Uplink to radio: %llu frames (captured: %llu); %llu NACKs.\n", (unsigned long long)far->frames,
+           (unsigned long long)uplinks, (unsigned long long)server->nacks);
+
+    // Frames the daemon received but never got to forward (the server went away, or the capture ended) come
+    // out of the replay too, after everything the capture has.
+    int retval = 0;
+    if (server->prefix.frames != expected.frames || server->prefix.bytes != expected.bytes || server->prefix.hash != expected.hash)
+    {
+        printf("MISMATCH: the downlink forwarded to the server differs from the capture.\n");
+        retval = 1;
+    }
+    else if (server->data.frames > expected.frames)
+    {
+        printf("Downlink matches the capture, plus %llu frames the capture never forwarded.\n",
+               (unsigned long long)(server->data.frames - expected.frames));
+    }
+    else
+    {
+        printf("Downlink matches the capture.\n");
+    }
+
+    close(sv[0]);
+    close(sv[1]);
+    delete server->server;
+    delete global->network_data;
+    gs_reactor_destroy(global->reactor);
+    gs_radio_destroy(global->radio);
+    gs_ring_destroy(global->uhf_rx_ring);
+    gs_tx_queue_destroy(global->uhf_tx_queue);
+    gs_sar_destroy(global->uhf_sar);
+    gs_pool_destroy(global->netframe_pool);
+    gs_pool_destroy(global->payload_pool);
+    pthread_mutex_destroy(&global->net_lock);
+    gs_capture_close(file);
+    return retval;
+}
@@ -0,0 +1,25 @@
+/**
+ * @file gs_si446x_probe.cpp
+ * @author agent (agent@local)
+ * @brief Tries si446x_init() on behalf of the ground station, which cannot survive it failing.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Usage: gs_si446x_probe.out
+ *
+ * libsi446x calls exit() when the radio does not answer its reset. The ground station starts this helper
+ * (posix_spawn(), see si446x_probe() in gs_radio.cpp) before it initializes the si446x itself, and only does
+ * so once the helper has exited with 0. The helper's init is thrown away with it; the ground station still
+ * brings the radio up with its own.
+ *
+ */
+
+#include <si446x.h>
+
+int main(void)
+{
+    si446x_init();
+    return 0;
+}
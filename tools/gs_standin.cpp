@@ -0,0 +1,701 @@
+/**
+ * @file gs_standin.cpp
+ * @author agent (agent@local)
+ * @brief Stand-in GS server and load generator: drives the whole ground station over a localhost NetFrame connection.
+ * @version See Git tags for version information.
+ * @date 2026.10.17
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ * Usage: gs_standin.out [-e] [-p port] [-t seconds] [-d rate] [-z bytes] [-Z] [-k rate] [-s sim_options]
+ *                       [-x close|reset:every_ms] [-w stall_ms:every_ms] [-L max_loss_pct]
+ *     -e  Serve a separately started ground station (roof_uhf.out -a 127.0.0.1:port -s echo,...) instead of
+ *         running one in this process.
+ *     -p  Port to listen on on localhost. Defaults to ROOFUHF with -e, any free port without.
+ *     -t  Seconds of load (default 10).
+ *     -d  DATA commands sent per second (default 5).
+ *     -z  Bytes per DATA command (default sizeof(cmd_input_t)); more than one frame holds goes as a multi-frame message.
+ *     -Z  Compress DATA commands longer than a frame in the in-process ground station, see gs_lz.hpp; their
+ *         filler is zeros instead of a counting pattern, so they compress.
+ *     -k  UHF_CONFIG frames sent per second (default 0).
+ *     -s  Simulated radio options for the in-process ground station, see gs_radio_sim_parse(); echo is always on.
+ *     -x  Drop the connection every every_ms: close is a clean close (the client reads -404, SERVER-FORCED),
+ *         reset a TCP reset.
+ *     -w  Stop reading the connection for stall_ms every every_ms, as a slow server would.
+ *     -L  Loss allowed before exiting non-zero, in percent (default 0).
+ * 
+ * The server end speaks NetFrame over TCP on localhost, so the ground station connects, polls, reconnects and
+ * is disconnected through its real network path. Every DATA command carries a sequence number and its send
+ * time; the simulated spacecraft echoes it back down, and the echo reaching the server is the command's ACK.
+ * A NACK is charged to an unanswered command, see standin_nack(). Commands with neither are lost. Commands due
+ * while the client is disconnected are not sent and not counted.
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "gs_uhf.hpp"
+#include "gs_reactor.hpp"
+#include "gs_ring.hpp"
+#include "gs_tx.hpp"
+#include "gs_sar.hpp"
+#include "gs_radio.hpp"
+#include "gs_metrics.hpp"
+#include "gs_time.hpp"
+#include "gs_log.hpp"
+#include "meb_debug.hpp"
+
+#define STANDIN_MAGIC 0x5354444e
+#define STANDIN_POLL_MS 10 // Longest the reader sleeps before looking at injected disconnects and stalls.
+#define STANDIN_SETTLE_MS 3000 // Time without an answer, after the load, before the outstanding commands are lost.
+#define STANDIN_ACCEPT_S 60 // With -e, how long to wait for the ground station to connect.
+#define STANDIN_MAX_COMMANDS (1 << 20)
+
+/**
+ * @brief Start of every DATA command's payload; the rest is filler.
+ * 
+ */
+typedef struct __attribute__((packed))
+{
+    uint8_t mod; // As cmd_input_t: 0, an ordinary command.
+    uint8_t cmd;
+    uint32_t magic; // STANDIN_MAGIC, to tell echoes from the simulated spacecraft's beacons.
+    uint32_t seq;
+    uint64_t sent_ns;
+} standin_stamp_t;
+
+enum
+{
+    STANDIN_OUTSTANDING = 0,
+    STANDIN_ECHOED,
+    STANDIN_NACKED,
+};
+
+enum
+{
+    STANDIN_INJECT_NONE = 0,
+    STANDIN_INJECT_CLOSE,
+    STANDIN_INJECT_RESET,
+};
+
+typedef struct
+{
+    int listen_fd;
+    pthread_mutex_t lock; // Guards conn->socket: the sender's frames against the reader's closes.
+    NetDataClient *conn;  // The ground station's connection, socket -1 while there is none.
+    int inject;           // A STANDIN_INJECT_* for the reader to carry out.
+    uint64_t stall_until_ns;
+    bool running;
+
+    uint32_t *state; // Per command, STANDIN_OUTSTANDING until answered.
+    uint32_t planned; // Commands there is room for.
+    uint32_t sent;    // Commands sent, and so sequence numbers in use.
+    uint32_t oldest; // No command before it is outstanding, see standin_nack().
+    uint64_t *echo_ns, *nack_ns; // Latency samples.
+    uint32_t echoes, nacks, duplicates;
+    uint64_t frames;         // DATA frames from the ground station, echoes and beacons alike.
+    uint64_t first_frame_ns, last_frame_ns, last_answer_ns;
+    uint64_t nack_codes[4];  // NACK_NO_UHF, NACK_TX_FULL, NACK_TX_LATE, NACK_TX_FAILED.
+    uint64_t polls;
+    uint64_t connections;
+    uint64_t injected, client_drops;
+    uint64_t dropped_ns; // When the connection was last dropped, 0 once the ground station is back.
+    uint64_t reconnect_sum_ns, reconnect_max_ns, reconnects;
+} standin_server_t;
+
+static int standin_nack_index(int code)
+{
+    switch (code)
+    {
+    case NACK_NO_UHF:
+        return 0;
+    case NACK_TX_FULL:
+        return 1;
+    case NACK_TX_LATE:
+        return 2;
+    case NACK_TX_FAILED:
+        return 3;
+    default:
+        return -1;
+    }
+}
+
+/**
+ * @brief Closes the connection, cleanly or with a reset. Called with the lock held.
+ */
+static void standin_drop(standin_server_t *server, bool reset)
+{
+    int sock = server->conn->socket;
+    if (sock < 0)
+    {
+        return;
+    }
+    if (reset)
+    {
+        struct linger linger = {1, 0};
+        setsockopt(sock, SOL_SOCKET, SO_LINGER, &linger, sizeof(linger));
+    }
+    else
+    {
+        shutdown(sock, SHUT_RDWR);
+    }
+    close(sock);
+    server->conn->socket = -1;
+    server->conn->connection_ready = false;
+    server->dropped_ns = gs_time_ns();
+}
+
+static void standin_echo(standin_server_t *server, const uint8_t *payload, int size, uint64_t now)
+{
+    standin_stamp_t stamp;
+    if (size < (int)sizeof(standin_stamp_t))
+    {
+        return;
+    }
+    memcpy(&stamp, payload, sizeof(standin_stamp_t));
+    if (stamp.magic != STANDIN_MAGIC || stamp.seq >= server->planned)
+    {
+        // A beacon.
+        return;
+    }
+    if (server->state[stamp.seq] == STANDIN_ECHOED)
+    {
+        server->duplicates++;
+        return;
+    }
+    // Echoed after all, even if a NACK was charged to it.
+    server->state[stamp.seq] = STANDIN_ECHOED;
+    server->echo_ns[server->echoes++] = now - stamp.sent_ns;
+    server->last_answer_ns = now;
+}
+
+/**
+ * @brief Charges a NACK to a command still unanswered; the NACK does not say which. One refused on receipt
+ * (no UHF, queue full) is the newest, one that gave up on the air (late, failed) the oldest.
+ */
+static void standin_nack(standin_server_t *server, const uint8_t *payload, int size, uint64_t now, const uint64_t *sent_ns)
+{
+    cs_ack_t nack;
+    nack.code = 0;
+    if (size >= (int)sizeof(cs_ack_t))
+    {
+        memcpy(&nack, payload, sizeof(cs_ack_t));
+        int index = standin_nack_index(nack.code);
+        if (index >= 0)
+        {
+            server->nack_codes[index]++;
+        }
+    }
+    uint32_t sent = __atomic_load_n(&server->sent, __ATOMIC_ACQUIRE);
+    while (server->oldest < sent && server->state[server->oldest] != STANDIN_OUTSTANDING)
+    {
+        server->oldest++;
+    }
+    uint32_t seq = server->oldest;
+    if (nack.code == NACK_NO_UHF || nack.code == NACK_TX_FULL)
+    {
+        for (seq = sent; seq > server->oldest && server->state[seq - 1] != STANDIN_OUTSTANDING; seq--)
+            ;
+        seq--;
+    }
+    if (server->oldest < sent)
+    {
+        server->state[seq] = STANDIN_NACKED;
+        server->nack_ns[server->nacks++] = now - __atomic_load_n(&sent_ns[seq], __ATOMIC_ACQUIRE);
+        server->last_answer_ns = now;
+    }
+}
+
+typedef struct
+{
+    standin_server_t *server;
+    uint64_t *sent_ns;
+} standin_reader_t;
+
+/**
+ * @brief Accepts the ground station's connections, reads what it sends, and carries out the injected disconnects and stalls.
+ */
+static void *standin_reader_thread(void *args)
+{
+    standin_reader_t *reader = (standin_reader_t *)args;
+    standin_server_t *server = reader->server;
+    NetFrame *netframe = new NetFrame();
+    unsigned char payload[NETFRAME_MAX_PAYLOAD_SIZE];
+
+    while (__atomic_load_n(&server->running, __ATOMIC_ACQUIRE))
+    {
+        uint64_t now = gs_time_ns();
+        int inject = __atomic_exchange_n(&server->inject, STANDIN_INJECT_NONE, __ATOMIC_ACQ_REL);
+        if (inject != STANDIN_INJECT_NONE && server->conn->socket >= 0)
+        {
+            pthread_mutex_lock(&server->lock);
+            standin_drop(server, inject == STANDIN_INJECT_RESET);
+            pthread_mutex_unlock(&server->lock);
+            server->injected++;
+        }
+
+        struct pollfd pfds[2] = {{server->listen_fd, POLLIN, 0}, {server->conn->socket, POLLIN, 0}};
+        bool stalled = now < __atomic_load_n(&server->stall_until_ns, __ATOMIC_ACQUIRE);
+        int nfds = server->conn->socket >= 0 && !stalled ? 2 : 1;
+        if (poll(pfds, nfds, STANDIN_POLL_MS) <= 0)
+        {
+            continue;
+        }
+
+        if (pfds[0].revents & POLLIN)
+        {
+            int sock = accept4(server->listen_fd, NULL, NULL, SOCK_CLOEXEC);
+            if (sock >= 0)
+            {
+                pthread_mutex_lock(&server->lock);
+                if (server->conn->socket >= 0)
+                {
+                    // The ground station gave up on the old connection before we noticed.
+                    close(server->conn->socket);
+                }
+                server->conn->socket = sock;
+                server->conn->connection_ready = true;
+                pthread_mutex_unlock(&server->lock);
+                server->connections++;
+                if (server->dropped_ns)
+                {
+                    uint64_t gap = gs_time_ns() - server->dropped_ns;
+                    server->reconnect_sum_ns += gap;
+                    server->reconnect_max_ns = gap > server->reconnect_max_ns ? gap : server->reconnect_max_ns;
+                    server->reconnects++;
+                    server->dropped_ns = 0;
+                }
+            }
+        }
+
+        if (nfds < 2 || !(pfds[1].revents & (POLLIN | POLLHUP | POLLERR)))
+        {
+            continue;
+        }
+        if (netframe->recvFrame(server->conn) < 0)
+        {
+            pthread_mutex_lock(&server->lock);
+            standin_drop(server, false);
+            pthread_mutex_unlock(&server->lock);
+            server->client_drops++;
+            continue;
+        }
+        now = gs_time_ns();
+        int size = netframe->getPayloadSize();
+        if (size < 0 || size > NETFRAME_MAX_PAYLOAD_SIZE || netframe->retrievePayload(payload, size) < 0)
+        {
+            continue;
+        }
+        switch (netframe->getType())
+        {
+        case NetType::DATA:
+            server->frames++;
+            server->first_frame_ns = server->first_frame_ns ? server->first_frame_ns : now;
+            server->last_frame_ns = now;
+            standin_echo(server, payload, size, now);
+            break;
+        case NetType::NACK:
+            standin_nack(server, payload, size, now, reader->sent_ns);
+            break;
+        case NetType::POLL:
+            server->polls++;
+            break;
+        default:
+            break;
+        }
+    }
+    delete netframe;
+    return nullptr;
+}
+
+/**
+ * @brief Sends one frame to the ground station, if it is connected.
+ * 
+ * @return bool True if it was sent.
+ */
+static bool standin_send(standin_server_t *server, uint8_t *payload, ssize_t size, NetType type)
+{
+    NetFrame netframe(size > 0 ? payload : nullptr, size, type, NetVertex::ROOFUHF);
+    bool sent = false;
+    pthread_mutex_lock(&server->lock);
+    if (server->conn->socket >= 0)
+    {
+        sent = netframe.sendFrame(server->conn) >= 0;
+    }
+    pthread_mutex_unlock(&server->lock);
+    return sent;
+}
+
+static int standin_cmp(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static double standin_quantile_ms(const uint64_t *sorted, uint32_t n, double q)
+{
+    return n ? sorted[(uint32_t)(q * (n - 1) + 0.5)] / 1e6 : 0;
+}
+
+static void *standin_loop_thread(void *args)
+{
+    gs_uhf_event_loop((global_data_t *)args, true);
+    return nullptr;
+}
+
+int main(int argc, char *argv[])
+{
+    bool external = false;
+    int port = -1;
+    double secs = 10, cmd_rate = 5, config_rate = 0;
+    int cmd_size = sizeof(cmd_input_t);
+    const char *sim_options = nullptr;
+    int inject_kind = STANDIN_INJECT_NONE;
+    uint32_t inject_ms = 0, stall_ms = 0, stall_every_ms = 0;
+    double max_loss = 0;
+    char kind[16];
+
+    bool compress = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "ep:t:d:z:Zk:s:x:w:L:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'e':
+            external = true;
+            break;
+        case 'p':
+            port = atoi(optarg);
+            break;
+        case 't':
+            secs = atof(optarg);
+            break;
+        case 'd':
+            cmd_rate = atof(optarg);
+            break;
+        case 'z':
+            cmd_size = atoi(optarg);
+            break;
+        case 'Z':
+            compress = true;
+            break;
+        case 'k':
+            config_rate = atof(optarg);
+            break;
+        case 's':
+            sim_options = optarg;
+            break;
+        case 'x':
+            if (sscanf(optarg, "%15[a-z]:%u", kind, &inject_ms) != 2 || inject_ms == 0 ||
+                (strcmp(kind, "close") != 0 && strcmp(kind, "reset") != 0))
+            {
+                fprintf(stderr, "Bad disconnect: %s (close:<ms> or reset:<ms>)\n", optarg);
+                return 1;
+            }
+            inject_kind = strcmp(kind, "close") == 0 ? STANDIN_INJECT_CLOSE : STANDIN_INJECT_RESET;
+            break;
+        case 'w':
+            if (sscanf(optarg, "%u:%u", &stall_ms, &stall_every_ms) != 2 || stall_every_ms == 0)
+            {
+                fprintf(stderr, "Bad stall: %s (<stall_ms>:<every_ms>)\n", optarg);
+                return 1;
+            }
+            break;
+        case 'L':
+            max_loss = atof(optarg);
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-e] [-p port] [-t seconds] [-d rate] [-z bytes] [-Z] [-k rate] [-s sim_options] [-x close|reset:every_ms] [-w stall_ms:every_ms] [-L max_loss_pct]\n", argv[0]);
+            return 1;
+        }
+    }
+    uint64_t planned = (uint64_t)(secs * cmd_rate) + 1;
+    if (secs <= 0 || cmd_rate < 0 || config_rate < 0 || planned > STANDIN_MAX_COMMANDS ||
+        cmd_size < (int)sizeof(standin_stamp_t) || cmd_size > NETFRAME_MAX_PAYLOAD_SIZE)
+    {
+        fprintf(stderr, "Bad load: at most %d commands of %d to %d bytes.\n", STANDIN_MAX_COMMANDS,
+                (int)sizeof(standin_stamp_t), NETFRAME_MAX_PAYLOAD_SIZE);
+        return 1;
+    }
+    port = port >= 0 ? port : external ? (int)NetPort::ROOFUHF : 0;
+
+    // The server end.
+    standin_server_t server[1];
+    memset(server, 0x0, sizeof(standin_server_t));
+    pthread_mutex_init(&server->lock, NULL);
+    server->conn = new NetDataClient(NetPort::ROOFUHF, SERVER_POLL_RATE);
+    server->conn->socket = -1;
+    server->planned = planned;
+    server->state = (uint32_t *)calloc(planned, sizeof(uint32_t));
+    server->echo_ns = (uint64_t *)calloc(planned, sizeof(uint64_t));
+    server->nack_ns = (uint64_t *)calloc(planned, sizeof(uint64_t));
+    uint64_t *sent_ns = (uint64_t *)calloc(planned, sizeof(uint64_t));
+    uint8_t *payload = (uint8_t *)calloc(1, NETFRAME_MAX_PAYLOAD_SIZE);
+    struct sockaddr_in addr;
+    memset(&addr, 0x0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(addr);
+    int one = 1;
+    server->listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (server->state == nullptr || server->echo_ns == nullptr || server->nack_ns == nullptr || sent_ns == nullptr ||
+        payload == nullptr || server->listen_fd < 0 || setsockopt(server->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) < 0 ||
+        bind(server->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(server->listen_fd, 4) < 0 ||
+        getsockname(server->listen_fd, (struct sockaddr *)&addr, &addr_len) < 0)
+    {
+        erprintlf(errno);
+        dbprintlf(FATAL "Failed to start the stand-in server.");
+        return 1;
+    }
+    port = ntohs(addr.sin_port);
+    server->running = true;
+    standin_reader_t reader = {server, sent_ns};
+    pthread_t reader_tid;
+    pthread_create(&reader_tid, NULL, standin_reader_thread, &reader);
+
+    // The ground station, as main() sets it up with a simulated radio, connecting to us over localhost.
+    char server_addr[32];
+    snprintf(server_addr, sizeof(server_addr), "127.0.0.1:%d", port);
+    global_data_t global[1];
+    memset(global, 0x0, sizeof(global_data_t));
+    pthread_t loop_tid, rx_tid, tx_tid;
+    if (!external)
+    {
+        gs_log_start("/dev/null");
+        gs_sim_config_t config[1];
+        gs_radio_sim_defaults(config);
+        if (!gs_radio_sim_parse(config, sim_options))
+        {
+            return 1;
+        }
+        config->spacecraft = true;
+        config->echo = true;
+        global->radio = gs_radio_sim_create(config);
+        global->uhf_rx_ring = gs_ring_create(UHF_RX_RING_SIZE);
+        global->uhf_tx_queue = gs_tx_queue_create(UHF_TX_QUEUE_SIZE);
+        global->uhf_sar = gs_sar_create(UHF_SAR_MAX_MESSAGE);
+        global->netframe_pool = gs_pool_create("NetFrame", sizeof(NetFrame), NETFRAME_POOL_SIZE);
+        global->payload_pool = gs_pool_create("Payload", NETFRAME_MAX_PAYLOAD_SIZE, PAYLOAD_POOL_SIZE);
+        global->reactor = gs_reactor_create();
+        global->modem = gs_modem_create(false);
+        global->health_ms = UHF_HEALTH_INTERVAL_MS;
+        global->server_addr = server_addr;
+        global->compress = compress;
+        pthread_mutex_init(&global->net_lock, NULL);
+        if (global->radio == nullptr || global->reactor == nullptr || global->modem == nullptr)
+        {
+            dbprintlf(FATAL "Failed to set up the ground station.");
+            return 1;
+        }
+        global->network_data = new NetDataClient(NetPort::ROOFUHF, SERVER_POLL_RATE);
+        global->network_data->thread_status = 1;
+        // Threaded as roof_uhf.out is by default: the radio is read on its own thread.
+        pthread_create(&loop_tid, NULL, standin_loop_thread, global);
+        pthread_create(&rx_tid, NULL, gs_uhf_rx_thread, global);
+        pthread_create(&tx_tid, NULL, gs_uhf_tx_thread, global);
+    }
+    else
+    {
+        printf("Stand-in server on %s, waiting for: roof_uhf.out -a %s -s echo[,...]\n", server_addr, server_addr);
+    }
+
+    // Ready once connected, and with the radio up when it is ours to see.
+    uint64_t deadline = gs_time_ns() + STANDIN_ACCEPT_S * NSEC_PER_SEC;
+    while ((__atomic_load_n(&server->connections, __ATOMIC_ACQUIRE) == 0 ||
+            (!external && !__atomic_load_n(&global->uhf_ready, __ATOMIC_ACQUIRE))) &&
+           gs_time_ns() < deadline)
+    {
+        usleep(1000);
+    }
+    int retval = 0;
+    if (__atomic_load_n(&server->connections, __ATOMIC_ACQUIRE) == 0)
+    {
+        dbprintlf(FATAL "The ground station never connected.");
+        retval = 1;
+    }
+
+    // The load.
+    uint64_t start = gs_time_ns();
+    uint64_t end = start + (uint64_t)(secs * NSEC_PER_SEC);
+    uint64_t cmd_period = cmd_rate > 0 ? (uint64_t)(NSEC_PER_SEC / cmd_rate) : 0;
+    uint64_t config_period = config_rate > 0 ? (uint64_t)(NSEC_PER_SEC / config_rate) : 0;
+    uint64_t next_cmd = start, next_config = start;
+    uint64_t next_inject = inject_ms ? start + inject_ms * NSEC_PER_MSEC : UINT64_MAX;
+    uint64_t next_stall = stall_every_ms ? start + stall_every_ms * NSEC_PER_MSEC : UINT64_MAX;
+    uint64_t unsent = 0, configs = 0, stalls = 0;
+    // A counting pattern has no repeats to compress; with -Z the filler is zeros, as a command's unused tail is.
+    for (uint32_t i = sizeof(standin_stamp_t); i < (uint32_t)cmd_size; i++)
+    {
+        payload[i] = compress ? 0 : i;
+    }
+    while (retval == 0)
+    {
+        uint64_t due = cmd_period ? next_cmd : UINT64_MAX;
+        due = config_period && next_config < due ? next_config : due;
+        due = next_inject < due ? next_inject : due;
+        due = next_stall < due ? next_stall : due;
+        if (due >= end)
+        {
+            break;
+        }
+        gs_sleep_until_ns(due);
+        uint64_t now = gs_time_ns();
+
+        if (cmd_period && now >= next_cmd)
+        {
+            uint32_t seq = server->sent;
+            standin_stamp_t stamp = {0, 0, STANDIN_MAGIC, seq, now};
+            memcpy(payload, &stamp, sizeof(standin_stamp_t));
+            if (seq < planned)
+            {
+                __atomic_store_n(&sent_ns[seq], now, __ATOMIC_RELEASE);
+            }
+            if (seq < planned && standin_send(server, payload, cmd_size, NetType::DATA))
+            {
+                __atomic_store_n(&server->sent, seq + 1, __ATOMIC_RELEASE);
+            }
+            else
+            {
+                unsent++;
+            }
+            next_cmd += cmd_period;
+        }
+        if (config_period && now >= next_config)
+        {
+            // Alternates the PA level, which any radio can switch between frames.
+            gs_modem_config_t config = {0, 0, 0, (uint8_t)(configs % 2 ? GS_MODEM_MAX_POWER : 100), GS_ADAPT_KEEP};
+            configs += standin_send(server, (uint8_t *)&config, sizeof(config), NetType::UHF_CONFIG);
+            next_config += config_period;
+        }
+        if (now >= next_inject)
+        {
+            __atomic_store_n(&server->inject, inject_kind, __ATOMIC_RELEASE);
+            next_inject += inject_ms * NSEC_PER_MSEC;
+        }
+        if (now >= next_stall)
+        {
+            __atomic_store_n(&server->stall_until_ns, now + stall_ms * NSEC_PER_MSEC, __ATOMIC_RELEASE);
+            stalls++;
+            next_stall += stall_every_ms * NSEC_PER_MSEC;
+        }
+    }
+    uint64_t loaded = gs_time_ns();
+
+    // Answers still on their way, until every command has one or none has come for a while.
+    while (retval == 0)
+    {
+        usleep(100000);
+        uint64_t last = __atomic_load_n(&server->last_answer_ns, __ATOMIC_ACQUIRE);
+        last = last > loaded ? last : loaded;
+        uint32_t answered = __atomic_load_n(&server->echoes, __ATOMIC_ACQUIRE) + __atomic_load_n(&server->nacks, __ATOMIC_ACQUIRE);
+        if (answered >= server->sent || gs_time_ns() - last >= STANDIN_SETTLE_MS * NSEC_PER_MSEC)
+        {
+            break;
+        }
+    }
+
+    if (!external)
+    {
+        gs_reactor_stop(global->reactor);
+        pthread_join(loop_tid, NULL);
+        __atomic_store_n(&global->uhf_done, true, __ATOMIC_RELEASE);
+        __atomic_store_n(&global->network_data->thread_status, 0, __ATOMIC_RELEASE);
+        gs_tx_stop(global->uhf_tx_queue);
+        pthread_join(rx_tid, NULL);
+        pthread_join(tx_tid, NULL);
+        gs_log_stop();
+    }
+    __atomic_store_n(&server->running, false, __ATOMIC_RELEASE);
+    pthread_join(reader_tid, NULL);
+
+    uint32_t lost = 0;
+    for (uint32_t i = 0; i < server->sent; i++)
+    {
+        lost += server->state[i] == STANDIN_OUTSTANDING;
+    }
+    double loss = server->sent ? 100.0 * lost / server->sent : 0;
+    qsort(server->echo_ns, server->echoes, sizeof(uint64_t), standin_cmp);
+    qsort(server->nack_ns, server->nacks, sizeof(uint64_t), standin_cmp);
+    double load_s = (loaded - start) / 1e9;
+    double frame_s = (server->last_frame_ns - server->first_frame_ns) / 1e9;
+
+    printf("Load: %.1f s of %.1f DATA/s of %d bytes%s and %.1f UHF_CONFIG/s; %u commands sent, %llu due while disconnected, %llu UHF_CONFIG.\n",
+           load_s, cmd_rate, cmd_size, cmd_size > GST_MAX_PAYLOAD_SIZE ? " (multi-frame)" : "", config_rate, server->sent,
+           (unsigned long long)unsent, (unsigned long long)configs);
+    printf("Commands: %u echoed (ACK), %u NACKed (%llu no UHF, %llu queue full, %llu late, %llu failed), %u lost (%.2f%%), %u duplicate echoes; %.1f answered/s.\n",
+           server->echoes, server->nacks, (unsigned long long)server->nack_codes[0], (unsigned long long)server->nack_codes[1],
+           (unsigned long long)server->nack_codes[2], (unsigned long long)server->nack_codes[3], lost, loss, server->duplicates,
+           load_s > 0 ? (server->echoes + server->nacks) / load_s : 0.0);
+    printf("ACK latency: p50 %.1f ms, p99 %.1f ms, max %.1f ms. NACK latency: p50 %.1f ms, p99 %.1f ms, max %.1f ms.\n",
+           standin_quantile_ms(server->echo_ns, server->echoes, 0.5), standin_quantile_ms(server->echo_ns, server->echoes, 0.99),
+           standin_quantile_ms(server->echo_ns, server->echoes, 1), standin_quantile_ms(server->nack_ns, server->nacks, 0.5),
+           standin_quantile_ms(server->nack_ns, server->nacks, 0.99), standin_quantile_ms(server->nack_ns, server->nacks, 1));
+    printf("Downlink: %llu DATA frames (echoes and beacons), %.1f frames/s; %llu polls.\n", (unsigned long long)server->frames,
+           frame_s > 0 ? server->frames / frame_s : 0.0, (unsigned long long)server->polls);
+    printf("Connection: %llu connections, %llu dropped by us (%llu stalls of %u ms), %llu by the ground station; back after mean %.0f ms, max %.0f ms.\n",
+           (unsigned long long)server->connections, (unsigned long long)server->injected, (unsigned long long)stalls, stall_ms,
+           (unsigned long long)server->client_drops, server->reconnects ? server->reconnect_sum_ns / 1e6 / server->reconnects : 0.0,
+           server->reconnect_max_ns / 1e6);
+    if (!external)
+    {
+        // Where the time went inside the ground station.
+        static const struct
+        {
+            gs_metric_stage_t stage;
+            const char *name;
+        } stages[] = {{GS_STAGE_NET_RECV, "net recv"}, {GS_STAGE_TX_QUEUE, "TX queue"}, {GS_STAGE_RADIO_WRITE, "radio write"},
+                      {GS_STAGE_UPLINK, "uplink"}, {GS_STAGE_RADIO_READ, "radio read"}, {GS_STAGE_DOWNLINK, "downlink"}};
+        printf("Ground station:");
+        for (size_t i = 0; i < sizeof(stages) / sizeof(stages[0]); i++)
+        {
+            printf("%s %s p50 %.2f ms, p99 %.2f ms", i ? ";" : "", stages[i].name, gs_metrics_quantile(stages[i].stage, 0.5, NULL) / 1e6,
+                   gs_metrics_quantile(stages[i].stage, 0.99, NULL) / 1e6);
+        }
+        printf(".\n");
+    }
+    if (retval == 0 && loss > max_loss)
+    {
+        printf("LOSS: %.2f%% of the commands went unanswered, %.2f%% allowed.\n", loss, max_loss);
+        retval = 1;
+    }
+
+    if (!external)
+    {
+        if (global->network_data->socket >= 0)
+        {
+            close(global->network_data->socket);
+        }
+        delete global->network_data;
+        gs_reactor_destroy(global->reactor);
+        gs_radio_destroy(global->radio);
+        gs_modem_destroy(global->modem);
+        gs_ring_destroy(global->uhf_rx_ring);
+        gs_tx_queue_destroy(global->uhf_tx_queue);
+        gs_sar_destroy(global->uhf_sar);
+        gs_pool_destroy(global->netframe_pool);
+        gs_pool_destroy(global->payload_pool);
+        pthread_mutex_destroy(&global->net_lock);
+    }
+    if (server->conn->socket >= 0)
+    {
+        close(server->conn->socket);
+    }
+    close(server->listen_fd);
+    delete server->conn;
+    pthread_mutex_destroy(&server->lock);
+    free(server->state);
+    free(server->echo_ns);
+    free(server->nack_ns);
+    free(sent_ns);
+    free(payload);
+    return retval;
+}